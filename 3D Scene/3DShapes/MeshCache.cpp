@@ -0,0 +1,517 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// keep generated meshes in a binary file that is memory mapped at startup,
+// so they are uploaded straight from the mapping instead of generated again
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const char g_CacheMagic[4] = { 'M', 'S', 'H', 'C' };
+	// bumped whenever the layout changes, so old files are rebuilt
+	const uint32_t g_CacheVersion = 2;
+	// every array of the file starts on a multiple of this, which
+	// also keeps them aligned in the mapping
+	const uint32_t g_CacheAlignment = 64;
+
+	const uint64_t g_HashPrime = 1099511628211ULL;
+
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  Round an offset up to the alignment of the file.
+	 ***********************************************************/
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return(((offset + g_CacheAlignment - 1) / g_CacheAlignment) * g_CacheAlignment);
+	}
+
+	/***********************************************************
+	 *  ElapsedMilliseconds()
+	 *
+	 *  Get the milliseconds since the passed in time.
+	 ***********************************************************/
+	double ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+	{
+		return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	/***********************************************************
+	 *  MoveOverFile()
+	 *
+	 *  Rename a file to the passed in name, replacing any file
+	 *  already there in one step.
+	 ***********************************************************/
+	bool MoveOverFile(const std::string& from, const std::string& to)
+	{
+#ifdef _WIN32
+		return(MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0);
+#else
+		return(rename(from.c_str(), to.c_str()) == 0);
+#endif
+	}
+}
+
+/***********************************************************
+ *  MeshCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MeshCache()
+{
+	m_pMapped = NULL;
+	m_mappedBytes = 0;
+	m_bDirty = false;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/***********************************************************
+ *  ~MeshCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshCache::~MeshCache()
+{
+	Close();
+}
+
+/***********************************************************
+ *  HashBytes()
+ *
+ *  64-bit FNV-1a hash of a run of bytes.  Passing the hash
+ *  of earlier bytes continues it, so a hash can be built
+ *  from several runs.
+ ***********************************************************/
+uint64_t MeshCache::HashBytes(const void* data, size_t bytes, uint64_t hash)
+{
+	const unsigned char* byte = (const unsigned char*)data;
+	for (size_t i = 0; i < bytes; i++)
+	{
+		hash ^= byte[i];
+		hash *= g_HashPrime;
+	}
+	return(hash);
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  Map the cache file with the passed in name and read its
+ *  table.  A file that is missing, from another version or
+ *  whose table does not match its hash is unmapped again
+ *  and returns false - the meshes are then generated and
+ *  added, and Save() replaces the file.
+ ***********************************************************/
+bool MeshCache::Open(const std::string& filename)
+{
+	Close();
+	m_filename = filename;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool bMapped = MapFile();
+	m_stats.mapMilliseconds = ElapsedMilliseconds(start);
+	if (bMapped == false)
+	{
+		return(false);
+	}
+
+	start = std::chrono::steady_clock::now();
+	bool bValid = ReadTable();
+	m_stats.validateMilliseconds = ElapsedMilliseconds(start);
+	if (bValid == false)
+	{
+		m_known.clear();
+		UnmapFile();
+		return(false);
+	}
+
+	m_stats.bMapped = true;
+	m_stats.meshes = (int)m_known.size();
+	m_stats.fileBytes = m_mappedBytes;
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  Unmap the file and forget every mesh, without saving.
+ ***********************************************************/
+void MeshCache::Close()
+{
+	UnmapFile();
+	m_filename.clear();
+	m_known.clear();
+	m_addedBytes.clear();
+	m_bDirty = false;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/***********************************************************
+ *  Find()
+ *
+ *  Look up the mesh stored under a key.  The data of a
+ *  mapped mesh is read in place, and stays valid until the
+ *  cache is closed or saved.
+ ***********************************************************/
+bool MeshCache::Find(uint64_t key, CACHED_MESH& mesh)
+{
+	for (size_t i = 0; i < m_known.size(); i++)
+	{
+		const KNOWN_MESH& known = m_known[i];
+		if (known.key != key)
+		{
+			continue;
+		}
+
+		GetMeshData(known, mesh);
+		m_stats.hits++;
+		return(true);
+	}
+
+	m_stats.misses++;
+	return(false);
+}
+
+/***********************************************************
+ *  GetMeshData()
+ *
+ *  Get a known mesh with pointers to its data.  Added data
+ *  can move as more is added, so it is found from its
+ *  offset each time.
+ ***********************************************************/
+void MeshCache::GetMeshData(const KNOWN_MESH& known, CACHED_MESH& mesh) const
+{
+	mesh = known.mesh;
+	if (known.bAdded == true)
+	{
+		const unsigned char* data = m_addedBytes.data() + known.addedOffset;
+		mesh.vertexData = data;
+		data += (size_t)mesh.vertexCount * mesh.vertexSize;
+		mesh.indexData = data;
+		data += (size_t)mesh.indexCount * mesh.indexSize;
+		mesh.meshlets = (const MeshletBuilder::MESHLET*)data;
+	}
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  Copy a generated mesh into the cache under a key, for
+ *  the next Save() to write.  A mesh already stored under
+ *  the key is replaced.
+ ***********************************************************/
+void MeshCache::Add(uint64_t key, const CACHED_MESH& mesh)
+{
+	if (IsEnabled() == false)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_known.size(); i++)
+	{
+		if (m_known[i].key == key)
+		{
+			m_known.erase(m_known.begin() + i);
+			break;
+		}
+	}
+
+	size_t vertexBytes = (size_t)mesh.vertexCount * mesh.vertexSize;
+	size_t indexBytes = (size_t)mesh.indexCount * mesh.indexSize;
+	size_t meshletBytes = (size_t)mesh.meshletCount * sizeof(MeshletBuilder::MESHLET);
+
+	KNOWN_MESH known;
+	known.key = key;
+	known.mesh = mesh;
+	known.bAdded = true;
+	known.addedOffset = m_addedBytes.size();
+	m_addedBytes.resize(known.addedOffset + vertexBytes + indexBytes + meshletBytes);
+	unsigned char* data = m_addedBytes.data() + known.addedOffset;
+	memcpy(data, mesh.vertexData, vertexBytes);
+	memcpy(data + vertexBytes, mesh.indexData, indexBytes);
+	if (meshletBytes > 0)
+	{
+		memcpy(data + vertexBytes + indexBytes, mesh.meshlets, meshletBytes);
+	}
+	m_known.push_back(known);
+	m_bDirty = true;
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  Write every known mesh to the file if any was added
+ *  since it was opened.  The whole file is built in memory
+ *  first, since the mapped meshes are copied from the old
+ *  file, then written next to it and renamed over it, and
+ *  the new file is mapped in its place.  If writing fails
+ *  the old file is kept and mapped again.  Returns false if
+ *  the file could not be written.
+ ***********************************************************/
+bool MeshCache::Save()
+{
+	if ((IsEnabled() == false) || (m_bDirty == false))
+	{
+		return(true);
+	}
+
+	// lay out the table and the arrays of each mesh
+	std::vector<CACHE_ENTRY> entries(m_known.size());
+	std::vector<CACHED_MESH> meshes(m_known.size());
+	uint64_t offset = AlignOffset(sizeof(CACHE_HEADER) + (entries.size() * sizeof(CACHE_ENTRY)));
+	for (size_t i = 0; i < m_known.size(); i++)
+	{
+		GetMeshData(m_known[i], meshes[i]);
+		const CACHED_MESH& mesh = meshes[i];
+
+		CACHE_ENTRY& entry = entries[i];
+		memset(&entry, 0, sizeof(entry));
+		entry.key = m_known[i].key;
+		entry.vertexFormat = mesh.vertexFormat;
+		entry.vertexCount = mesh.vertexCount;
+		entry.vertexSize = mesh.vertexSize;
+		entry.indexCount = mesh.indexCount;
+		entry.indexSize = mesh.indexSize;
+		entry.segments = mesh.segments;
+		entry.meshletCount = mesh.meshletCount;
+		entry.meshletSize = sizeof(MeshletBuilder::MESHLET);
+		memcpy(entry.vertexDecode, mesh.vertexDecode, sizeof(entry.vertexDecode));
+
+		entry.vertexOffset = offset;
+		offset = AlignOffset(offset + ((uint64_t)mesh.vertexCount * mesh.vertexSize));
+		entry.indexOffset = offset;
+		offset = AlignOffset(offset + ((uint64_t)mesh.indexCount * mesh.indexSize));
+		entry.meshletOffset = offset;
+		offset = AlignOffset(offset + ((uint64_t)mesh.meshletCount * sizeof(MeshletBuilder::MESHLET)));
+	}
+
+	std::vector<unsigned char> file((size_t)offset, 0);
+	memcpy(file.data() + sizeof(CACHE_HEADER), entries.data(), entries.size() * sizeof(CACHE_ENTRY));
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const CACHE_ENTRY& entry = entries[i];
+		const CACHED_MESH& mesh = meshes[i];
+		memcpy(file.data() + entry.vertexOffset, mesh.vertexData, (size_t)mesh.vertexCount * mesh.vertexSize);
+		memcpy(file.data() + entry.indexOffset, mesh.indexData, (size_t)mesh.indexCount * mesh.indexSize);
+		if (mesh.meshletCount > 0)
+		{
+			memcpy(file.data() + entry.meshletOffset, mesh.meshlets, mesh.meshletCount * sizeof(MeshletBuilder::MESHLET));
+		}
+	}
+
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_CacheMagic, sizeof(header.magic));
+	header.version = g_CacheVersion;
+	header.meshCount = (uint32_t)entries.size();
+	header.dataAlignment = g_CacheAlignment;
+	header.fileBytes = offset;
+	header.tableHash = HashBytes(file.data() + sizeof(CACHE_HEADER), entries.size() * sizeof(CACHE_ENTRY));
+	memcpy(file.data(), &header, sizeof(header));
+
+	// the mapping is of the file about to be replaced
+	m_known.clear();
+	m_addedBytes.clear();
+	UnmapFile();
+	m_bDirty = false;
+
+	std::string tempFilename = m_filename + ".tmp";
+	std::ofstream output(tempFilename.c_str(), std::ios::binary | std::ios::trunc);
+	bool bWritten = output.is_open();
+	if (bWritten == true)
+	{
+		output.write((const char*)file.data(), file.size());
+		output.close();
+		bWritten = (output.fail() == false);
+	}
+	if (bWritten == true)
+	{
+		bWritten = MoveOverFile(tempFilename, m_filename);
+	}
+	if (bWritten == false)
+	{
+		remove(tempFilename.c_str());
+	}
+
+	// keep finding the meshes, now in the new file
+	if ((MapFile() == false) || (ReadTable() == false))
+	{
+		m_known.clear();
+		UnmapFile();
+		return(false);
+	}
+	return(bWritten);
+}
+
+/***********************************************************
+ *  ReadTable()
+ *
+ *  Check the header of the mapped file, the hash of its
+ *  table and that every array of the table lies in the
+ *  file, then add its meshes, pointing into the mapping.
+ *  Only the header and table are read, so checking a file
+ *  takes the same time however large its meshes are.
+ ***********************************************************/
+bool MeshCache::ReadTable()
+{
+	if (m_mappedBytes < sizeof(CACHE_HEADER))
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	memcpy(&header, m_pMapped, sizeof(header));
+	if ((memcmp(header.magic, g_CacheMagic, sizeof(header.magic)) != 0) ||
+		(header.version != g_CacheVersion) ||
+		(header.dataAlignment != g_CacheAlignment) ||
+		(header.fileBytes != m_mappedBytes) ||
+		(sizeof(CACHE_HEADER) + ((uint64_t)header.meshCount * sizeof(CACHE_ENTRY)) > m_mappedBytes))
+	{
+		return(false);
+	}
+	if (HashBytes(m_pMapped + sizeof(CACHE_HEADER), (size_t)header.meshCount * sizeof(CACHE_ENTRY)) != header.tableHash)
+	{
+		return(false);
+	}
+
+	const CACHE_ENTRY* entries = (const CACHE_ENTRY*)(m_pMapped + sizeof(CACHE_HEADER));
+	for (uint32_t i = 0; i < header.meshCount; i++)
+	{
+		const CACHE_ENTRY& entry = entries[i];
+		uint64_t vertexEnd = entry.vertexOffset + ((uint64_t)entry.vertexCount * entry.vertexSize);
+		uint64_t indexEnd = entry.indexOffset + ((uint64_t)entry.indexCount * entry.indexSize);
+		uint64_t meshletEnd = entry.meshletOffset + ((uint64_t)entry.meshletCount * entry.meshletSize);
+		if ((entry.meshletSize != sizeof(MeshletBuilder::MESHLET)) ||
+			((entry.vertexOffset % g_CacheAlignment) != 0) ||
+			((entry.indexOffset % g_CacheAlignment) != 0) ||
+			((entry.meshletOffset % g_CacheAlignment) != 0) ||
+			(vertexEnd > m_mappedBytes) ||
+			(indexEnd > m_mappedBytes) ||
+			(meshletEnd > m_mappedBytes))
+		{
+			m_known.clear();
+			return(false);
+		}
+
+		KNOWN_MESH known;
+		known.key = entry.key;
+		known.mesh.vertexFormat = entry.vertexFormat;
+		known.mesh.vertexCount = entry.vertexCount;
+		known.mesh.vertexSize = entry.vertexSize;
+		known.mesh.indexCount = entry.indexCount;
+		known.mesh.indexSize = entry.indexSize;
+		known.mesh.segments = entry.segments;
+		known.mesh.meshletCount = entry.meshletCount;
+		memcpy(known.mesh.vertexDecode, entry.vertexDecode, sizeof(known.mesh.vertexDecode));
+		known.mesh.vertexData = m_pMapped + entry.vertexOffset;
+		known.mesh.indexData = m_pMapped + entry.indexOffset;
+		known.mesh.meshlets = (const MeshletBuilder::MESHLET*)(m_pMapped + entry.meshletOffset);
+		known.bAdded = false;
+		known.addedOffset = 0;
+		m_known.push_back(known);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  MapFile()
+ *
+ *  Map the whole cache file into memory read only.  The
+ *  file itself is closed again, which the mapping outlives.
+ ***********************************************************/
+bool MeshCache::MapFile()
+{
+	UnmapFile();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(m_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+	LARGE_INTEGER size;
+	if ((GetFileSizeEx(file, &size) == FALSE) || (size.QuadPart <= 0))
+	{
+		CloseHandle(file);
+		return(false);
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL)
+	{
+		return(false);
+	}
+	void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (pView == NULL)
+	{
+		return(false);
+	}
+	m_mappedBytes = (size_t)size.QuadPart;
+#else
+	int file = open(m_filename.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+	struct stat info;
+	if ((fstat(file, &info) != 0) || (info.st_size <= 0))
+	{
+		close(file);
+		return(false);
+	}
+	void* pView = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (pView == MAP_FAILED)
+	{
+		return(false);
+	}
+	m_mappedBytes = (size_t)info.st_size;
+#endif
+
+	m_pMapped = (const unsigned char*)pView;
+	return(true);
+}
+
+/***********************************************************
+ *  UnmapFile()
+ *
+ *  Release the mapping of the file, if it is mapped.
+ ***********************************************************/
+void MeshCache::UnmapFile()
+{
+	if (m_pMapped == NULL)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pMapped);
+#else
+	munmap((void*)m_pMapped, m_mappedBytes);
+#endif
+	m_pMapped = NULL;
+	m_mappedBytes = 0;
+}
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// keep generated meshes in a binary file that is memory mapped at startup,
+// so they are uploaded straight from the mapping instead of generated again
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshletBuilder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MeshCache
+ *
+ *  This class reads and writes the mesh cache file.  Each
+ *  mesh is stored as it is uploaded - the vertices packed
+ *  in their vertex format and the indices at their stored
+ *  size - with its clusters, under a key made from
+ *  everything that decides its contents.  The file is:
+ *
+ *  - a header with a version, the file size and a hash of
+ *    the table
+ *  - a table with an entry for each mesh
+ *  - the data of the meshes, each array starting on a
+ *    64 byte boundary
+ *
+ *  Opening the file maps it into memory and checks the
+ *  header, the hash of the table and that every array lies
+ *  in the file, and an outdated or damaged file is ignored.
+ *  The mesh data itself is not read at startup.  Meshes
+ *  found are read from the mapping in place.  Meshes added
+ *  are written with the mapped ones by Save(), to a new
+ *  file that then replaces the old one, so a crash while
+ *  saving never leaves a half written cache.  Nothing here
+ *  uses OpenGL.
+ ***********************************************************/
+class MeshCache
+{
+public:
+	// one mesh as it is uploaded
+	struct CACHED_MESH
+	{
+		uint32_t vertexFormat;
+		uint32_t vertexCount;
+		uint32_t vertexSize;		// bytes per vertex
+		uint32_t indexCount;
+		uint32_t indexSize;			// bytes per index
+		uint32_t segments;
+		uint32_t meshletCount;
+		float vertexDecode[4];
+		const void* vertexData;
+		const void* indexData;
+		const MeshletBuilder::MESHLET* meshlets;
+	};
+
+	// what opening the file found and how long it took
+	struct CACHE_STATS
+	{
+		bool bMapped;				// a valid file was mapped
+		int meshes;					// meshes in the mapped file
+		size_t fileBytes;
+		double mapMilliseconds;
+		double validateMilliseconds;
+		int hits;					// lookups found in the file
+		int misses;
+	};
+
+	// the start of the hash of a new run of bytes
+	static const uint64_t HASH_SEED = 14695981039346656037ULL;
+
+	// constructor
+	MeshCache();
+	// destructor
+	~MeshCache();
+
+	// map the cache file with the passed in name - returns false if
+	// it is missing, outdated or damaged, but meshes can still be
+	// added and saved to it
+	bool Open(const std::string& filename);
+	// unmap the file and drop every added mesh
+	void Close();
+	bool IsEnabled() const { return(m_filename.size() > 0); }
+
+	// look up a mesh, which points into the mapping until Close()
+	bool Find(uint64_t key, CACHED_MESH& mesh);
+	// add a generated mesh, copying its data
+	void Add(uint64_t key, const CACHED_MESH& mesh);
+
+	// write the mapped and the added meshes to the file, if any
+	// was added, and map the new file
+	bool Save();
+
+	CACHE_STATS GetStats() const { return(m_stats); }
+
+	// FNV-1a hash of a run of bytes, continued from a previous hash
+	static uint64_t HashBytes(const void* data, size_t bytes, uint64_t hash = HASH_SEED);
+
+private:
+	// the start of the file
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t meshCount;
+		uint32_t dataAlignment;		// every array starts on a multiple
+		uint64_t fileBytes;
+		uint64_t tableHash;			// of the table after the header
+	};
+
+	// one mesh of the table, with the offsets of its arrays from
+	// the start of the file
+	struct CACHE_ENTRY
+	{
+		uint64_t key;
+		uint32_t vertexFormat;
+		uint32_t vertexCount;
+		uint32_t vertexSize;
+		uint32_t indexCount;
+		uint32_t indexSize;
+		uint32_t segments;
+		uint32_t meshletCount;
+		uint32_t meshletSize;		// to notice a changed MESHLET
+		float vertexDecode[4];
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t meshletOffset;
+	};
+
+	// a mesh read from the mapping or added - the data of an added
+	// mesh is in m_addedBytes, from addedOffset on
+	struct KNOWN_MESH
+	{
+		uint64_t key;
+		CACHED_MESH mesh;
+		bool bAdded;
+		size_t addedOffset;
+	};
+
+	// map and unmap the whole file read only
+	bool MapFile();
+	void UnmapFile();
+	// check the mapped file and read its table
+	bool ReadTable();
+	// a known mesh with pointers to its data
+	void GetMeshData(const KNOWN_MESH& known, CACHED_MESH& mesh) const;
+
+	std::string m_filename;
+	const unsigned char* m_pMapped;
+	size_t m_mappedBytes;
+	std::vector<KNOWN_MESH> m_known;
+	// copies of the data of the added meshes
+	std::vector<unsigned char> m_addedBytes;
+	bool m_bDirty;
+	CACHE_STATS m_stats;
+};
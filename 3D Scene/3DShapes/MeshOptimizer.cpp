@@ -0,0 +1,686 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder the triangles and vertices of indexed meshes for the GPU, and
+// measure how well an order suits the vertex caches and early depth test
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// bytes in a line of the simulated vertex fetch cache, and
+	// lines in the cache
+	const int FETCH_LINE_BYTES = 64;
+	const int FETCH_CACHE_LINES = 64;
+	// pixels across the simulated depth buffer
+	const int OVERDRAW_GRID_SIZE = 256;
+
+	/***********************************************************
+	 *  VERTEX_CACHE
+	 *
+	 *  A FIFO post transform cache.  A vertex is in the cache
+	 *  if fewer than cacheSize vertices were added after it.
+	 ***********************************************************/
+	struct VERTEX_CACHE
+	{
+		std::vector<int> addedTime;
+		int time;
+		int cacheSize;
+
+		VERTEX_CACHE(int vertexCount, int size)
+		{
+			addedTime.assign(vertexCount, 0);
+			cacheSize = size;
+			time = cacheSize + 1;
+		}
+
+		// empty the cache
+		void Flush()
+		{
+			time += cacheSize + 1;
+		}
+
+		// use a vertex, returning 1 if it had to be transformed
+		int Use(GLuint vertex)
+		{
+			if ((time - addedTime[vertex]) > cacheSize)
+			{
+				addedTime[vertex] = time++;
+				return(1);
+			}
+			return(0);
+		}
+
+		int UseTriangle(const GLuint* triangle)
+		{
+			return(Use(triangle[0]) + Use(triangle[1]) + Use(triangle[2]));
+		}
+	};
+
+	/***********************************************************
+	 *  Position()
+	 *
+	 *  Get the position of a vertex.
+	 ***********************************************************/
+	const GLfloat* Position(const GLfloat* vertices, int floatsPerVertex, GLuint vertex)
+	{
+		return(vertices + ((size_t)vertex * floatsPerVertex));
+	}
+
+	/***********************************************************
+	 *  TriangleCross()
+	 *
+	 *  Get the cross product of two edges of a triangle, which
+	 *  points along its normal and is twice its area long.
+	 ***********************************************************/
+	void TriangleCross(const GLfloat* p0, const GLfloat* p1, const GLfloat* p2, double cross[3])
+	{
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		cross[0] = (e1[1] * e2[2]) - (e1[2] * e2[1]);
+		cross[1] = (e1[2] * e2[0]) - (e1[0] * e2[2]);
+		cross[2] = (e1[0] * e2[1]) - (e1[1] * e2[0]);
+	}
+
+	/***********************************************************
+	 *  NextFanningVertex()
+	 *
+	 *  Pick the vertex whose remaining triangles Tipsify emits
+	 *  next - the candidate that has been in the cache longest
+	 *  and will still be there after its triangles are added,
+	 *  or else the latest vertex with triangles left, or else
+	 *  the next such vertex in the array.
+	 ***********************************************************/
+	int NextFanningVertex(
+		const std::vector<GLuint>& candidates,
+		std::vector<GLuint>& deadEnds,
+		const std::vector<int>& liveTriangles,
+		const VERTEX_CACHE& cache,
+		int& cursor)
+	{
+		int best = -1;
+		int bestPriority = -1;
+		for (size_t i = 0; i < candidates.size(); i++)
+		{
+			GLuint vertex = candidates[i];
+			if (liveTriangles[vertex] > 0)
+			{
+				int priority = 0;
+				int age = cache.time - cache.addedTime[vertex];
+				if ((age + (2 * liveTriangles[vertex])) <= cache.cacheSize)
+				{
+					priority = age;
+				}
+				if (priority > bestPriority)
+				{
+					best = (int)vertex;
+					bestPriority = priority;
+				}
+			}
+		}
+		if (best >= 0)
+		{
+			return(best);
+		}
+
+		while (deadEnds.empty() == false)
+		{
+			GLuint vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[vertex] > 0)
+			{
+				return((int)vertex);
+			}
+		}
+
+		while (cursor < (int)liveTriangles.size())
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				return(cursor);
+			}
+			cursor++;
+		}
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  RasterizeTriangle()
+	 *
+	 *  Draw a triangle into a depth buffer with a less than
+	 *  depth test, counting the pixels that pass.  Pixels on a
+	 *  shared edge belong to only one of its triangles.
+	 ***********************************************************/
+	int RasterizeTriangle(const float a[3], const float b[3], const float c[3], std::vector<float>& depth)
+	{
+		const float* v0 = a;
+		const float* v1 = b;
+		const float* v2 = c;
+		float area = ((v1[0] - v0[0]) * (v2[1] - v0[1])) - ((v1[1] - v0[1]) * (v2[0] - v0[0]));
+		if (area == 0.0f)
+		{
+			return(0);
+		}
+		if (area < 0.0f)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+
+		int minX = std::max(0, (int)floor(std::min(v0[0], std::min(v1[0], v2[0]))));
+		int minY = std::max(0, (int)floor(std::min(v0[1], std::min(v1[1], v2[1]))));
+		int maxX = std::min(OVERDRAW_GRID_SIZE - 1, (int)ceil(std::max(v0[0], std::max(v1[0], v2[0]))));
+		int maxY = std::min(OVERDRAW_GRID_SIZE - 1, (int)ceil(std::max(v0[1], std::max(v1[1], v2[1]))));
+
+		// an edge owns the pixel centers on it if it is a top or
+		// left edge of the counter clockwise triangle
+		const float* edges[3][2] = { { v1, v2 }, { v2, v0 }, { v0, v1 } };
+		bool bOwnsEdge[3];
+		for (int e = 0; e < 3; e++)
+		{
+			float dx = edges[e][1][0] - edges[e][0][0];
+			float dy = edges[e][1][1] - edges[e][0][1];
+			bOwnsEdge[e] = (dy < 0.0f) || ((dy == 0.0f) && (dx > 0.0f));
+		}
+
+		int shaded = 0;
+		for (int y = minY; y <= maxY; y++)
+		{
+			float py = y + 0.5f;
+			for (int x = minX; x <= maxX; x++)
+			{
+				float px = x + 0.5f;
+				float weights[3];
+				bool bInside = true;
+				for (int e = 0; e < 3; e++)
+				{
+					const float* p0 = edges[e][0];
+					const float* p1 = edges[e][1];
+					weights[e] = ((p1[0] - p0[0]) * (py - p0[1])) - ((p1[1] - p0[1]) * (px - p0[0]));
+					if ((weights[e] < 0.0f) || ((weights[e] == 0.0f) && (bOwnsEdge[e] == false)))
+					{
+						bInside = false;
+						break;
+					}
+				}
+				if (bInside == false)
+				{
+					continue;
+				}
+
+				float z = ((weights[0] * v0[2]) + (weights[1] * v1[2]) + (weights[2] * v2[2])) / area;
+				float& stored = depth[(y * OVERDRAW_GRID_SIZE) + x];
+				if (z < stored)
+				{
+					stored = z;
+					shaded++;
+				}
+			}
+		}
+		return(shaded);
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  Reorder the triangles with Tipsify.  Starting from one
+ *  vertex, all of its triangles not yet written are written,
+ *  then the next vertex is picked among the ones just used,
+ *  preferring one that will stay in the cache.  It runs in
+ *  time linear in the size of the mesh.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(
+	GLuint* indices,
+	int indexCount,
+	int vertexCount,
+	int cacheSize)
+{
+	int triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// the triangles around each vertex
+	std::vector<int> liveTriangles(vertexCount, 0);
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		liveTriangles[indices[i]]++;
+	}
+	std::vector<int> firstTriangle(vertexCount + 1, 0);
+	for (int v = 0; v < vertexCount; v++)
+	{
+		firstTriangle[v + 1] = firstTriangle[v] + liveTriangles[v];
+	}
+	std::vector<int> adjacency(triangleCount * 3);
+	std::vector<int> filled(firstTriangle.begin(), firstTriangle.end() - 1);
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[filled[indices[i]]++] = i / 3;
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<GLuint> output;
+	output.reserve(triangleCount * 3);
+	std::vector<GLuint> candidates;
+	std::vector<GLuint> deadEnds;
+	VERTEX_CACHE cache(vertexCount, cacheSize);
+	int cursor = 0;
+
+	int fanning = (int)indices[0];
+	while (fanning >= 0)
+	{
+		candidates.clear();
+		for (int a = firstTriangle[fanning]; a < firstTriangle[fanning + 1]; a++)
+		{
+			int triangle = adjacency[a];
+			if (emitted[triangle] == true)
+			{
+				continue;
+			}
+			for (int corner = 0; corner < 3; corner++)
+			{
+				GLuint vertex = indices[(triangle * 3) + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				cache.Use(vertex);
+			}
+			emitted[triangle] = true;
+		}
+		fanning = NextFanningVertex(candidates, deadEnds, liveTriangles, cache, cursor);
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(GLuint));
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  Split the triangles into clusters and sort the clusters.
+ *  A cluster ends wherever the cache order starts a new
+ *  patch, with all three vertices missing the cache, and
+ *  also wherever the cache misses so far in it have dropped
+ *  to the threshold times the patch's average, so splitting
+ *  there costs little reuse.  The clusters are then sorted
+ *  by how far they face away from the middle of the mesh,
+ *  outermost first.
+ ***********************************************************/
+void MeshOptimizer::OptimizeOverdraw(
+	GLuint* indices,
+	int indexCount,
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	int cacheSize,
+	float threshold)
+{
+	int triangleCount = indexCount / 3;
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	// the patches the cache order starts
+	VERTEX_CACHE cache(vertexCount, cacheSize);
+	std::vector<int> patches;
+	for (int t = 0; t < triangleCount; t++)
+	{
+		int misses = cache.UseTriangle(indices + (t * 3));
+		if ((t == 0) || (misses == 3))
+		{
+			patches.push_back(t);
+		}
+	}
+	patches.push_back(triangleCount);
+
+	// the clusters within each patch
+	std::vector<int> clusters;
+	for (size_t p = 0; p + 1 < patches.size(); p++)
+	{
+		int start = patches[p];
+		int end = patches[p + 1];
+
+		cache.Flush();
+		int patchMisses = 0;
+		for (int t = start; t < end; t++)
+		{
+			patchMisses += cache.UseTriangle(indices + (t * 3));
+		}
+		float clusterThreshold = threshold * ((float)patchMisses / (end - start));
+
+		clusters.push_back(start);
+		cache.Flush();
+		int runningMisses = 0;
+		int runningTriangles = 0;
+		for (int t = start; t < end; t++)
+		{
+			runningMisses += cache.UseTriangle(indices + (t * 3));
+			runningTriangles++;
+			if ((t + 1 < end) && (((float)runningMisses / runningTriangles) <= clusterThreshold))
+			{
+				clusters.push_back(t + 1);
+				cache.Flush();
+				runningMisses = 0;
+				runningTriangles = 0;
+			}
+		}
+	}
+	clusters.push_back(triangleCount);
+	int clusterCount = (int)clusters.size() - 1;
+
+	// area weighted middle of the mesh, and the area weighted
+	// middle and facing of each cluster
+	std::vector<double> clusterData(clusterCount * 6, 0.0);
+	std::vector<double> clusterArea(clusterCount, 0.0);
+	double meshCenter[3] = { 0.0, 0.0, 0.0 };
+	double meshArea = 0.0;
+	for (int c = 0; c < clusterCount; c++)
+	{
+		double* center = &clusterData[c * 6];
+		double* normal = center + 3;
+		for (int t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const GLfloat* p0 = Position(vertices, floatsPerVertex, indices[(t * 3) + 0]);
+			const GLfloat* p1 = Position(vertices, floatsPerVertex, indices[(t * 3) + 1]);
+			const GLfloat* p2 = Position(vertices, floatsPerVertex, indices[(t * 3) + 2]);
+			double cross[3];
+			TriangleCross(p0, p1, p2, cross);
+			double area = sqrt((cross[0] * cross[0]) + (cross[1] * cross[1]) + (cross[2] * cross[2]));
+			for (int axis = 0; axis < 3; axis++)
+			{
+				double middle = (p0[axis] + p1[axis] + p2[axis]) / 3.0;
+				center[axis] += middle * area;
+				normal[axis] += cross[axis];
+				meshCenter[axis] += middle * area;
+			}
+			clusterArea[c] += area;
+			meshArea += area;
+		}
+	}
+	if (meshArea > 0.0)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshCenter[axis] /= meshArea;
+		}
+	}
+
+	std::vector<double> sortKeys(clusterCount, 0.0);
+	std::vector<int> order(clusterCount);
+	for (int c = 0; c < clusterCount; c++)
+	{
+		double* center = &clusterData[c * 6];
+		double* normal = center + 3;
+		double normalLength = sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+		if ((clusterArea[c] > 0.0) && (normalLength > 0.0))
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				sortKeys[c] += ((center[axis] / clusterArea[c]) - meshCenter[axis]) * (normal[axis] / normalLength);
+			}
+		}
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return(sortKeys[a] > sortKeys[b]); });
+
+	std::vector<GLuint> output;
+	output.reserve(triangleCount * 3);
+	for (int i = 0; i < clusterCount; i++)
+	{
+		int c = order[i];
+		output.insert(output.end(), indices + (clusters[c] * 3), indices + (clusters[c + 1] * 3));
+	}
+	memcpy(indices, output.data(), output.size() * sizeof(GLuint));
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  Move the vertices into the order the triangles first use
+ *  them, and renumber the indices to match.  Vertices that
+ *  no triangle uses are kept, after all the others.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexFetch(
+	GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	GLuint* indices,
+	int indexCount)
+{
+	const GLuint UNUSED = 0xffffffff;
+	std::vector<GLuint> remap(vertexCount, UNUSED);
+	GLuint next = 0;
+	for (int i = 0; i < indexCount; i++)
+	{
+		if (remap[indices[i]] == UNUSED)
+		{
+			remap[indices[i]] = next++;
+		}
+	}
+	for (int v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] == UNUSED)
+		{
+			remap[v] = next++;
+		}
+	}
+
+	std::vector<GLfloat> reordered((size_t)vertexCount * floatsPerVertex);
+	for (int v = 0; v < vertexCount; v++)
+	{
+		memcpy(&reordered[(size_t)remap[v] * floatsPerVertex],
+			Position(vertices, floatsPerVertex, v),
+			floatsPerVertex * sizeof(GLfloat));
+	}
+	memcpy(vertices, reordered.data(), reordered.size() * sizeof(GLfloat));
+	for (int i = 0; i < indexCount; i++)
+	{
+		indices[i] = remap[indices[i]];
+	}
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  Reorder the triangles of each range for the transform
+ *  cache and overdraw, then the vertices of the whole mesh
+ *  for fetching.  The generated shapes often come close to
+ *  the best order already, so a pass that measures worse
+ *  than the order it was given is undone.
+ ***********************************************************/
+void MeshOptimizer::OptimizeMesh(
+	GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	GLuint* indices,
+	int indexCount,
+	const GLuint* rangeStarts,
+	int rangeCount)
+{
+	for (int r = 0; r < rangeCount; r++)
+	{
+		int start = (int)rangeStarts[r];
+		int end = (r + 1 < rangeCount) ? (int)rangeStarts[r + 1] : indexCount;
+		std::vector<GLuint> original(indices + start, indices + end);
+		CACHE_METRICS before = AnalyzeVertexCache(indices + start, end - start, vertexCount);
+		OptimizeVertexCache(indices + start, end - start, vertexCount);
+		OptimizeOverdraw(indices + start, end - start, vertices, vertexCount, floatsPerVertex);
+		if (AnalyzeVertexCache(indices + start, end - start, vertexCount).acmr > before.acmr)
+		{
+			std::copy(original.begin(), original.end(), indices + start);
+		}
+	}
+
+	int vertexBytes = floatsPerVertex * sizeof(GLfloat);
+	std::vector<GLfloat> originalVertices(vertices, vertices + (vertexCount * floatsPerVertex));
+	std::vector<GLuint> originalIndices(indices, indices + indexCount);
+	FETCH_METRICS before = AnalyzeVertexFetch(indices, indexCount, vertexCount, vertexBytes);
+	OptimizeVertexFetch(vertices, vertexCount, floatsPerVertex, indices, indexCount);
+	if (AnalyzeVertexFetch(indices, indexCount, vertexCount, vertexBytes).overfetch > before.overfetch)
+	{
+		std::copy(originalVertices.begin(), originalVertices.end(), vertices);
+		std::copy(originalIndices.begin(), originalIndices.end(), indices);
+	}
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  Count the vertices a FIFO transform cache has to
+ *  transform to draw the triangles in order.
+ ***********************************************************/
+MeshOptimizer::CACHE_METRICS MeshOptimizer::AnalyzeVertexCache(
+	const GLuint* indices,
+	int indexCount,
+	int vertexCount,
+	int cacheSize)
+{
+	CACHE_METRICS metrics = {};
+	int triangleCount = indexCount / 3;
+	VERTEX_CACHE cache(vertexCount, cacheSize);
+	for (int t = 0; t < triangleCount; t++)
+	{
+		metrics.transformedVertices += cache.UseTriangle(indices + (t * 3));
+	}
+
+	if (triangleCount > 0)
+	{
+		metrics.acmr = (float)metrics.transformedVertices / triangleCount;
+	}
+	if (vertexCount > 0)
+	{
+		metrics.atvr = (float)metrics.transformedVertices / vertexCount;
+	}
+	return(metrics);
+}
+
+/***********************************************************
+ *  AnalyzeVertexFetch()
+ *
+ *  Count the bytes read to fetch the vertices of the
+ *  triangles in order, a whole cache line at a time through
+ *  a small FIFO cache of lines, against the bytes of the
+ *  vertices that are used.
+ ***********************************************************/
+MeshOptimizer::FETCH_METRICS MeshOptimizer::AnalyzeVertexFetch(
+	const GLuint* indices,
+	int indexCount,
+	int vertexCount,
+	int vertexBytes)
+{
+	FETCH_METRICS metrics = {};
+	int lineCount = (((vertexCount * vertexBytes) + FETCH_LINE_BYTES - 1) / FETCH_LINE_BYTES) + 1;
+	VERTEX_CACHE lines(lineCount, FETCH_CACHE_LINES);
+	std::vector<bool> used(vertexCount, false);
+	int usedVertices = 0;
+	for (int i = 0; i < indexCount; i++)
+	{
+		GLuint vertex = indices[i];
+		if (used[vertex] == false)
+		{
+			used[vertex] = true;
+			usedVertices++;
+		}
+
+		int firstLine = (vertex * vertexBytes) / FETCH_LINE_BYTES;
+		int lastLine = (((vertex + 1) * vertexBytes) - 1) / FETCH_LINE_BYTES;
+		for (int line = firstLine; line <= lastLine; line++)
+		{
+			metrics.fetchedBytes += lines.Use(line) * FETCH_LINE_BYTES;
+		}
+	}
+
+	if (usedVertices > 0)
+	{
+		metrics.overfetch = (float)metrics.fetchedBytes / (usedVertices * vertexBytes);
+	}
+	return(metrics);
+}
+
+/***********************************************************
+ *  AnalyzeOverdraw()
+ *
+ *  Draw the triangles in order into a depth buffer from
+ *  each of the six axis directions, with the mesh scaled to
+ *  fill it and nothing culled, and count the pixels covered
+ *  and the pixels that passed the depth test.
+ ***********************************************************/
+MeshOptimizer::OVERDRAW_METRICS MeshOptimizer::AnalyzeOverdraw(
+	const GLuint* indices,
+	int indexCount,
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex)
+{
+	OVERDRAW_METRICS metrics = {};
+	int triangleCount = indexCount / 3;
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return(metrics);
+	}
+
+	float minimum[3];
+	float maximum[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		minimum[axis] = maximum[axis] = vertices[axis];
+	}
+	for (int v = 1; v < vertexCount; v++)
+	{
+		const GLfloat* position = Position(vertices, floatsPerVertex, v);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			minimum[axis] = std::min(minimum[axis], position[axis]);
+			maximum[axis] = std::max(maximum[axis], position[axis]);
+		}
+	}
+	float extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+	float scale = (extent > 0.0f) ? (1.0f / extent) : 0.0f;
+
+	std::vector<float> depth(OVERDRAW_GRID_SIZE * OVERDRAW_GRID_SIZE);
+	for (int view = 0; view < 6; view++)
+	{
+		// looking down one axis, from either end
+		int depthAxis = view % 3;
+		int xAxis = (depthAxis + 1) % 3;
+		int yAxis = (depthAxis + 2) % 3;
+		bool bReversed = (view >= 3);
+
+		std::fill(depth.begin(), depth.end(), 2.0f);
+		for (int t = 0; t < triangleCount; t++)
+		{
+			float corners[3][3];
+			for (int corner = 0; corner < 3; corner++)
+			{
+				const GLfloat* position = Position(vertices, floatsPerVertex, indices[(t * 3) + corner]);
+				float z = (position[depthAxis] - minimum[depthAxis]) * scale;
+				corners[corner][0] = (position[xAxis] - minimum[xAxis]) * scale * OVERDRAW_GRID_SIZE;
+				corners[corner][1] = (position[yAxis] - minimum[yAxis]) * scale * OVERDRAW_GRID_SIZE;
+				corners[corner][2] = bReversed ? (1.0f - z) : z;
+			}
+			metrics.shadedPixels += RasterizeTriangle(corners[0], corners[1], corners[2], depth);
+		}
+		for (size_t p = 0; p < depth.size(); p++)
+		{
+			if (depth[p] < 2.0f)
+			{
+				metrics.coveredPixels++;
+			}
+		}
+	}
+
+	if (metrics.coveredPixels > 0)
+	{
+		metrics.overdraw = (float)metrics.shadedPixels / metrics.coveredPixels;
+	}
+	return(metrics);
+}
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder the triangles and vertices of indexed meshes for the GPU, and
+// measure how well an order suits the vertex caches and early depth test
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class works on an interleaved vertex array and a
+ *  triangle list that indexes it, in three passes:
+ *
+ *  - OptimizeVertexCache() reorders the triangles so that
+ *    vertices are reused while they are still in the post
+ *    transform cache (Tipsify, Sander et al. 2007).
+ *  - OptimizeOverdraw() splits that order into clusters
+ *    and draws the clusters that face away from the middle
+ *    of the mesh first, so that from most views the front
+ *    surfaces are drawn before the ones behind them.
+ *  - OptimizeVertexFetch() stores the vertices in the order
+ *    the triangles first use them.
+ *
+ *  The analyze functions simulate a FIFO transform cache, a
+ *  cache of vertex fetch lines and a depth buffer seen from
+ *  the six axis directions.  Nothing here uses OpenGL, so
+ *  any mesh can be optimized or measured at any time.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+	// entries in the simulated post transform cache
+	static const int DEFAULT_CACHE_SIZE = 16;
+
+	// how well the triangle order reuses transformed vertices
+	struct CACHE_METRICS
+	{
+		int transformedVertices;	// cache misses
+		float acmr;					// misses per triangle, 0.5 at best
+		float atvr;					// misses per vertex, 1.0 at best
+	};
+
+	// how well the vertex order suits fetching whole cache lines
+	struct FETCH_METRICS
+	{
+		int fetchedBytes;
+		float overfetch;			// bytes fetched per vertex byte, 1.0 at best
+	};
+
+	// how many pixels are shaded more than once with depth testing
+	struct OVERDRAW_METRICS
+	{
+		int coveredPixels;
+		int shadedPixels;
+		float overdraw;				// shaded per covered pixel, 1.0 at best
+	};
+
+	// reorder the triangles of a list for vertex reuse
+	static void OptimizeVertexCache(
+		GLuint* indices,
+		int indexCount,
+		int vertexCount,
+		int cacheSize = DEFAULT_CACHE_SIZE);
+	// reorder clusters of an already cache optimized list so the
+	// outer surfaces come first - a larger threshold makes smaller
+	// clusters, trading vertex reuse for less overdraw
+	static void OptimizeOverdraw(
+		GLuint* indices,
+		int indexCount,
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		int cacheSize = DEFAULT_CACHE_SIZE,
+		float threshold = 1.05f);
+	// reorder the vertices in the order the triangles use them
+	static void OptimizeVertexFetch(
+		GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		GLuint* indices,
+		int indexCount);
+
+	// run all three passes, keeping the old order wherever a pass
+	// measures worse - the triangles never move between the ranges
+	// of indices starting at rangeStarts, so every range can still
+	// be drawn on its own
+	static void OptimizeMesh(
+		GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		GLuint* indices,
+		int indexCount,
+		const GLuint* rangeStarts,
+		int rangeCount);
+
+	// measure an order - the position is the first three floats
+	// of each vertex
+	static CACHE_METRICS AnalyzeVertexCache(
+		const GLuint* indices,
+		int indexCount,
+		int vertexCount,
+		int cacheSize = DEFAULT_CACHE_SIZE);
+	static FETCH_METRICS AnalyzeVertexFetch(
+		const GLuint* indices,
+		int indexCount,
+		int vertexCount,
+		int vertexBytes);
+	static OVERDRAW_METRICS AnalyzeOverdraw(
+		const GLuint* indices,
+		int indexCount,
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex);
+};
@@ -0,0 +1,537 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshletbuilder.cpp
+// ============
+// split indexed meshes into small clusters of triangles with bounds for
+// culling each cluster against the view on its own
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+namespace
+{
+	// positions closer than this are the same point when the
+	// triangles are joined up, to bridge the seams the
+	// generators leave with duplicated vertices
+	const float WELD_PRECISION = 1.0e5f;
+	// a normal cone whose widest normal is at least this close to
+	// 90 degrees from the axis can never face away as a whole
+	const float MIN_CONE_DOT = 0.05f;
+	// how much the distance of a triangle from the middle of a
+	// growing meshlet counts, in mesh sizes, against how far its
+	// normal turns from the meshlet's - curved shapes get meshlets
+	// stretched along their flattest direction
+	const float GROW_DISTANCE_WEIGHT = 0.5f;
+
+	// one side of a triangle, between two welded positions
+	struct TRIANGLE_EDGE
+	{
+		int low;
+		int high;
+		int triangle;
+		bool bForward;		// runs from low to high in the winding
+	};
+
+	/***********************************************************
+	 *  Position()
+	 *
+	 *  Get the position of a vertex.
+	 ***********************************************************/
+	glm::vec3 Position(const GLfloat* vertices, int floatsPerVertex, GLuint vertex)
+	{
+		const GLfloat* position = vertices + ((size_t)vertex * floatsPerVertex);
+		return(glm::vec3(position[0], position[1], position[2]));
+	}
+
+	/***********************************************************
+	 *  WeldPositions()
+	 *
+	 *  Give every vertex the id of its position, the same for
+	 *  all vertices at the same point.
+	 ***********************************************************/
+	std::vector<int> WeldPositions(const GLfloat* vertices, int vertexCount, int floatsPerVertex)
+	{
+		std::map<std::tuple<long, long, long>, int> positionIds;
+		std::vector<int> welded(vertexCount);
+		for (int v = 0; v < vertexCount; v++)
+		{
+			glm::vec3 position = Position(vertices, floatsPerVertex, v);
+			std::tuple<long, long, long> key(
+				std::lround(position.x * WELD_PRECISION),
+				std::lround(position.y * WELD_PRECISION),
+				std::lround(position.z * WELD_PRECISION));
+			welded[v] = positionIds.insert(std::make_pair(key, (int)positionIds.size())).first->second;
+		}
+		return(welded);
+	}
+
+	/***********************************************************
+	 *  OutwardNormals()
+	 *
+	 *  Get the unit normal of each triangle, turned to face
+	 *  out of the mesh.  Starting from any triangle, the turn
+	 *  of each neighbour follows from whether it runs along
+	 *  their shared edge the same way, so every connected
+	 *  part gets one consistent winding.  A part that then
+	 *  encloses a negative volume is inside out and is turned
+	 *  around.  Degenerate triangles get a zero normal.
+	 ***********************************************************/
+	std::vector<glm::vec3> OutwardNormals(
+		const GLfloat* vertices,
+		int floatsPerVertex,
+		const GLuint* indices,
+		int indexCount,
+		const std::vector<int>& welded)
+	{
+		int triangleCount = indexCount / 3;
+
+		// find the triangles on either side of each edge
+		std::vector<TRIANGLE_EDGE> edges;
+		edges.reserve(indexCount);
+		for (int t = 0; t < triangleCount; t++)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				int from = welded[indices[(t * 3) + corner]];
+				int to = welded[indices[(t * 3) + ((corner + 1) % 3)]];
+				if (from != to)
+				{
+					TRIANGLE_EDGE edge;
+					edge.low = std::min(from, to);
+					edge.high = std::max(from, to);
+					edge.triangle = t;
+					edge.bForward = (from < to);
+					edges.push_back(edge);
+				}
+			}
+		}
+		std::sort(edges.begin(), edges.end(), [&](const TRIANGLE_EDGE& a, const TRIANGLE_EDGE& b) {
+			return((a.low < b.low) || ((a.low == b.low) && (a.high < b.high)));
+		});
+
+		// neighbours, and whether a neighbour has to be turned the
+		// other way to agree
+		std::vector<std::vector<std::pair<int, bool>>> neighbours(triangleCount);
+		size_t first = 0;
+		for (size_t i = 1; i <= edges.size(); i++)
+		{
+			if ((i < edges.size()) && (edges[i].low == edges[first].low) && (edges[i].high == edges[first].high))
+			{
+				continue;
+			}
+			for (size_t a = first; a < i; a++)
+			{
+				for (size_t b = a + 1; b < i; b++)
+				{
+					bool bFlip = (edges[a].bForward == edges[b].bForward);
+					neighbours[edges[a].triangle].push_back(std::make_pair(edges[b].triangle, bFlip));
+					neighbours[edges[b].triangle].push_back(std::make_pair(edges[a].triangle, bFlip));
+				}
+			}
+			first = i;
+		}
+
+		std::vector<glm::vec3> normals(triangleCount);
+		std::vector<float> sides(triangleCount, 0.0f);
+		std::vector<int> part;
+		for (int seed = 0; seed < triangleCount; seed++)
+		{
+			if (sides[seed] != 0.0f)
+			{
+				continue;
+			}
+
+			// spread the seed's winding over its connected part,
+			// adding up the volume the part encloses
+			part.clear();
+			part.push_back(seed);
+			sides[seed] = 1.0f;
+			float volume = 0.0f;
+			for (size_t next = 0; next < part.size(); next++)
+			{
+				int t = part[next];
+				glm::vec3 p0 = Position(vertices, floatsPerVertex, indices[t * 3]);
+				glm::vec3 p1 = Position(vertices, floatsPerVertex, indices[(t * 3) + 1]);
+				glm::vec3 p2 = Position(vertices, floatsPerVertex, indices[(t * 3) + 2]);
+				volume += sides[t] * glm::dot(p0, glm::cross(p1, p2));
+				normals[t] = sides[t] * glm::cross(p1 - p0, p2 - p0);
+
+				for (const std::pair<int, bool>& neighbour : neighbours[t])
+				{
+					if (sides[neighbour.first] == 0.0f)
+					{
+						sides[neighbour.first] = neighbour.second ? -sides[t] : sides[t];
+						part.push_back(neighbour.first);
+					}
+				}
+			}
+
+			float outward = (volume < 0.0f) ? -1.0f : 1.0f;
+			for (int t : part)
+			{
+				float length = glm::length(normals[t]);
+				normals[t] = (length > 0.0f) ? (normals[t] * (outward / length)) : glm::vec3(0.0f);
+			}
+		}
+		return(normals);
+	}
+
+	/***********************************************************
+	 *  SetMeshletBounds()
+	 *
+	 *  Fit a sphere around the corners of a meshlet's
+	 *  triangles and a cone around their outward normals.
+	 ***********************************************************/
+	void SetMeshletBounds(
+		MeshletBuilder::MESHLET& meshlet,
+		const GLfloat* vertices,
+		int floatsPerVertex,
+		const GLuint* indices,
+		const std::vector<int>& triangles,
+		const std::vector<glm::vec3>& normals)
+	{
+		glm::vec3 low = Position(vertices, floatsPerVertex, indices[triangles[0] * 3]);
+		glm::vec3 high = low;
+		for (int t : triangles)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				glm::vec3 position = Position(vertices, floatsPerVertex, indices[(t * 3) + corner]);
+				low = glm::min(low, position);
+				high = glm::max(high, position);
+			}
+		}
+		meshlet.center = (low + high) * 0.5f;
+		meshlet.radius = 0.0f;
+		for (int t : triangles)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				glm::vec3 position = Position(vertices, floatsPerVertex, indices[(t * 3) + corner]);
+				meshlet.radius = std::max(meshlet.radius, glm::length(position - meshlet.center));
+			}
+		}
+
+		glm::vec3 sum(0.0f);
+		for (int t : triangles)
+		{
+			sum += normals[t];
+		}
+		meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+		meshlet.coneCutoff = 1.0f;
+		if (glm::length(sum) == 0.0f)
+		{
+			return;
+		}
+		meshlet.coneAxis = glm::normalize(sum);
+
+		float minDot = 1.0f;
+		for (int t : triangles)
+		{
+			if (normals[t] != glm::vec3(0.0f))
+			{
+				minDot = std::min(minDot, glm::dot(meshlet.coneAxis, normals[t]));
+			}
+		}
+		if (minDot >= MIN_CONE_DOT)
+		{
+			meshlet.coneCutoff = std::sqrt(1.0f - (minDot * minDot));
+		}
+	}
+
+	/***********************************************************
+	 *  NewVertices()
+	 *
+	 *  Count the corners of a triangle that are not in the
+	 *  meshlet yet, each repeated index once.
+	 ***********************************************************/
+	int NewVertices(const GLuint* triangle, const std::vector<int>& usedBy, int meshlet)
+	{
+		int newVertices = 0;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			bool bRepeated = (corner > 0) && (triangle[0] == triangle[corner]);
+			bRepeated = bRepeated || ((corner > 1) && (triangle[1] == triangle[corner]));
+			if ((usedBy[triangle[corner]] != meshlet) && (bRepeated == false))
+			{
+				newVertices++;
+			}
+		}
+		return(newVertices);
+	}
+}
+
+/***********************************************************
+ *  BuildMeshlets()
+ *
+ *  Grow each meshlet from the first triangle of its range
+ *  not taken yet, adding one neighbouring triangle at a
+ *  time - the one needing the fewest new vertices, and of
+ *  those the one whose normal and position are closest to
+ *  the meshlet's, which keeps the meshlet compact and its
+ *  normal cone narrow.  Triangles
+ *  are neighbours when they share a position, so seams of
+ *  duplicated vertices are crossed.  A meshlet is done when
+ *  it is full or nothing next to it fits.
+ *
+ *  The triangles of each meshlet keep their order from the
+ *  list, so the vertex reuse of a cache optimized mesh
+ *  mostly survives, and the meshlets follow in the order
+ *  they were grown.
+ ***********************************************************/
+void MeshletBuilder::BuildMeshlets(
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	GLuint* indices,
+	int indexCount,
+	const GLuint* rangeStarts,
+	int rangeCount,
+	std::vector<MESHLET>& meshlets,
+	int maxVertices,
+	int maxTriangles)
+{
+	meshlets.clear();
+	int triangleCount = indexCount / 3;
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	std::vector<int> welded = WeldPositions(vertices, vertexCount, floatsPerVertex);
+	std::vector<glm::vec3> normals = OutwardNormals(vertices, floatsPerVertex, indices, indexCount, welded);
+
+	// the triangles around each position, and the middle of each
+	// triangle
+	int positionCount = 0;
+	for (int id : welded)
+	{
+		positionCount = std::max(positionCount, id + 1);
+	}
+	std::vector<int> firstAround(positionCount + 1, 0);
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		firstAround[welded[indices[i]] + 1]++;
+	}
+	for (int p = 0; p < positionCount; p++)
+	{
+		firstAround[p + 1] += firstAround[p];
+	}
+	std::vector<int> around(triangleCount * 3);
+	std::vector<int> filled(firstAround.begin(), firstAround.end() - 1);
+	std::vector<glm::vec3> middles(triangleCount);
+	for (int t = 0; t < triangleCount; t++)
+	{
+		middles[t] = glm::vec3(0.0f);
+		for (int corner = 0; corner < 3; corner++)
+		{
+			GLuint vertex = indices[(t * 3) + corner];
+			around[filled[welded[vertex]]++] = t;
+			middles[t] += Position(vertices, floatsPerVertex, vertex) / 3.0f;
+		}
+	}
+
+	// the size of the mesh, for weighing distances
+	glm::vec3 low = Position(vertices, floatsPerVertex, 0);
+	glm::vec3 high = low;
+	for (int v = 1; v < vertexCount; v++)
+	{
+		low = glm::min(low, Position(vertices, floatsPerVertex, v));
+		high = glm::max(high, Position(vertices, floatsPerVertex, v));
+	}
+	float meshSize = std::max(glm::length(high - low), 1.0e-6f);
+
+	std::vector<bool> bTaken(triangleCount, false);
+	std::vector<int> usedBy(vertexCount, -1);
+	std::vector<int> candidateOf(triangleCount, -1);
+	std::vector<GLuint> ordered;
+	std::vector<int> members;
+	std::vector<int> candidates;
+	for (int r = 0; r < rangeCount; r++)
+	{
+		int startTriangle = (int)rangeStarts[r] / 3;
+		int endTriangle = (r + 1 < rangeCount) ? (int)rangeStarts[r + 1] / 3 : triangleCount;
+		ordered.clear();
+
+		int seed = startTriangle;
+		while (true)
+		{
+			while ((seed < endTriangle) && (bTaken[seed] == true))
+			{
+				seed++;
+			}
+			if (seed == endTriangle)
+			{
+				break;
+			}
+
+			int id = (int)meshlets.size();
+			int meshletVertices = 0;
+			glm::vec3 middleSum(0.0f);
+			glm::vec3 normalSum(0.0f);
+			members.clear();
+			candidates.clear();
+
+			int next = seed;
+			while (next >= 0)
+			{
+				const GLuint* triangle = indices + (next * 3);
+				meshletVertices += NewVertices(triangle, usedBy, id);
+				for (int corner = 0; corner < 3; corner++)
+				{
+					usedBy[triangle[corner]] = id;
+				}
+				bTaken[next] = true;
+				members.push_back(next);
+				middleSum += middles[next];
+				if ((int)members.size() >= maxTriangles)
+				{
+					break;
+				}
+
+				// the triangles touching the new one can be added next
+				for (int corner = 0; corner < 3; corner++)
+				{
+					int position = welded[triangle[corner]];
+					for (int a = firstAround[position]; a < firstAround[position + 1]; a++)
+					{
+						int t = around[a];
+						if ((t >= startTriangle) && (t < endTriangle) && (bTaken[t] == false) && (candidateOf[t] != id))
+						{
+							candidateOf[t] = id;
+							candidates.push_back(t);
+						}
+					}
+				}
+
+				glm::vec3 middle = middleSum / (float)members.size();
+				normalSum += normals[next];
+				glm::vec3 axis = (glm::length(normalSum) > 0.0f) ? glm::normalize(normalSum) : glm::vec3(0.0f);
+				next = -1;
+				int bestNew = 4;
+				float bestSpread = 0.0f;
+				for (size_t c = 0; c < candidates.size(); c++)
+				{
+					int t = candidates[c];
+					if (bTaken[t] == true)
+					{
+						candidates[c--] = candidates.back();
+						candidates.pop_back();
+						continue;
+					}
+					int newVertices = NewVertices(indices + (t * 3), usedBy, id);
+					float spread = (1.0f - glm::dot(normals[t], axis)) +
+						(GROW_DISTANCE_WEIGHT * glm::length(middles[t] - middle) / meshSize);
+					if ((meshletVertices + newVertices <= maxVertices) &&
+						((newVertices < bestNew) || ((newVertices == bestNew) && (spread < bestSpread))))
+					{
+						next = t;
+						bestNew = newVertices;
+						bestSpread = spread;
+					}
+				}
+			}
+
+			std::sort(members.begin(), members.end());
+			MESHLET meshlet = {};
+			meshlet.firstIndex = (startTriangle * 3) + (GLuint)ordered.size();
+			meshlet.indexCount = (GLuint)members.size() * 3;
+			SetMeshletBounds(meshlet, vertices, floatsPerVertex, indices, members, normals);
+			meshlets.push_back(meshlet);
+			for (int t : members)
+			{
+				ordered.insert(ordered.end(), indices + (t * 3), indices + (t * 3) + 3);
+			}
+		}
+
+		std::copy(ordered.begin(), ordered.end(), indices + (startTriangle * 3));
+	}
+}
+
+/***********************************************************
+ *  ExtractFrustumPlanes()
+ *
+ *  Get the planes of the view volume from the rows of the
+ *  matrix (Gribb and Hartmann), scaled so the distance of
+ *  a point from each is in the units of the matrix's
+ *  source space.
+ ***********************************************************/
+void MeshletBuilder::ExtractFrustumPlanes(const glm::mat4& matrix, glm::vec4 planes[6])
+{
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]);
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		planes[axis * 2] = rows[3] + rows[axis];
+		planes[(axis * 2) + 1] = rows[3] - rows[axis];
+	}
+	for (int plane = 0; plane < 6; plane++)
+	{
+		float length = glm::length(glm::vec3(planes[plane]));
+		if (length > 0.0f)
+		{
+			planes[plane] /= length;
+		}
+	}
+}
+
+/***********************************************************
+ *  IsOutsideFrustum()
+ *
+ *  Check if the bounding sphere of a meshlet is wholly on
+ *  the outside of any of the frustum planes.
+ ***********************************************************/
+bool MeshletBuilder::IsOutsideFrustum(const MESHLET& meshlet, const glm::vec4 planes[6])
+{
+	for (int plane = 0; plane < 6; plane++)
+	{
+		if (glm::dot(glm::vec3(planes[plane]), meshlet.center) + planes[plane].w < -meshlet.radius)
+		{
+			return(true);
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  IsBackFacing()
+ *
+ *  Check if the normal cone of a meshlet faces away from
+ *  every point of its bounding sphere as seen from the
+ *  camera, which is the conservative form of the test.
+ ***********************************************************/
+bool MeshletBuilder::IsBackFacing(const MESHLET& meshlet, const glm::vec3& cameraPosition)
+{
+	if (meshlet.coneCutoff >= 1.0f)
+	{
+		return(false);
+	}
+
+	glm::vec3 toCenter = meshlet.center - cameraPosition;
+	return(glm::dot(toCenter, meshlet.coneAxis) >=
+		(meshlet.coneCutoff * glm::length(toCenter)) + meshlet.radius);
+}
+
+/***********************************************************
+ *  IsBackFacingDirection()
+ *
+ *  Check if the normal cone of a meshlet faces away from a
+ *  camera that looks along one direction everywhere.
+ ***********************************************************/
+bool MeshletBuilder::IsBackFacingDirection(const MESHLET& meshlet, const glm::vec3& viewDirection)
+{
+	if (meshlet.coneCutoff >= 1.0f)
+	{
+		return(false);
+	}
+
+	return(glm::dot(glm::normalize(viewDirection), meshlet.coneAxis) >= meshlet.coneCutoff);
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshletbuilder.h
+// ============
+// split indexed meshes into small clusters of triangles with bounds for
+// culling each cluster against the view on its own
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  MeshletBuilder
+ *
+ *  This class groups the triangles of a mesh into
+ *  meshlets - patches of neighbouring triangles using at
+ *  most 64 vertices and 124 triangles, the sizes mesh
+ *  shading hardware is built around.  The triangles of
+ *  each meshlet are moved together in the triangle list,
+ *  so each meshlet is a range of the indices that can be
+ *  drawn on its own.
+ *
+ *  Each meshlet gets a bounding sphere and a cone holding
+ *  the outward normals of its triangles.  The outward side
+ *  is found from the mesh itself - the windings are made
+ *  consistent across shared edges and each connected part
+ *  is turned to enclose a positive volume - so neither the
+ *  winding nor the vertex normals of the generated shapes
+ *  need to be right.  Nothing here uses OpenGL.
+ ***********************************************************/
+class MeshletBuilder
+{
+public:
+	// the most vertices and triangles of a meshlet
+	static const int DEFAULT_MAX_VERTICES = 64;
+	static const int DEFAULT_MAX_TRIANGLES = 124;
+
+	// a range of a mesh's indices and its bounds in mesh space
+	struct MESHLET
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+		glm::vec3 center;		// bounding sphere
+		float radius;
+		glm::vec3 coneAxis;		// average outward normal
+		float coneCutoff;		// sine of the widest normal's angle
+								// from the axis, 1 if it cannot cull
+	};
+
+	// group the triangles of a list into meshlets, reordering them
+	// so each meshlet is a range of the list - the triangles never
+	// move between the ranges of indices starting at rangeStarts,
+	// so every range is a run of whole meshlets.  The position is
+	// the first three floats of each vertex
+	static void BuildMeshlets(
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		GLuint* indices,
+		int indexCount,
+		const GLuint* rangeStarts,
+		int rangeCount,
+		std::vector<MESHLET>& meshlets,
+		int maxVertices = DEFAULT_MAX_VERTICES,
+		int maxTriangles = DEFAULT_MAX_TRIANGLES);
+
+	// the six planes of the view volume of a model view projection
+	// matrix, in the space that matrix transforms from, with the
+	// inside on the positive side
+	static void ExtractFrustumPlanes(const glm::mat4& matrix, glm::vec4 planes[6]);
+
+	// true if the meshlet is outside one of the frustum planes
+	static bool IsOutsideFrustum(const MESHLET& meshlet, const glm::vec4 planes[6]);
+	// true if every triangle of the meshlet faces away from a
+	// camera at the passed in position in mesh space
+	static bool IsBackFacing(const MESHLET& meshlet, const glm::vec3& cameraPosition);
+	// true if every triangle of the meshlet faces away from a
+	// camera looking along the passed in direction, for
+	// orthographic views
+	static bool IsBackFacingDirection(const MESHLET& meshlet, const glm::vec3& viewDirection);
+};
@@ -0,0 +1,684 @@
+///////////////////////////////////////////////////////////////////////////////
+// normalgenerator.cpp
+// ============
+// compute smooth vertex normals and tangents for whole indexed meshes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "NormalGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// x64 always has SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define NORMAL_USE_SSE2
+#endif
+
+#if defined(NORMAL_USE_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// meshes with fewer triangles than this for each thread are
+	// not worth splitting
+	const int MIN_TRIANGLES_PER_THREAD = 16384;
+
+	// the direction of increasing u across a triangle, unit
+	// length, and whether its texture is mirrored (-1) or not
+	// (1) - zero for a triangle without texture area
+	struct FACE_TANGENT
+	{
+		float direction[3];
+		float sign;
+	};
+
+	// run a function over ranges of a count split between threads
+	void ParallelRanges(int count, int threads, const std::function<void(int, int)>& function)
+	{
+		if (threads <= 1)
+		{
+			function(0, count);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; i++)
+		{
+			int first = (int)(((long long)count * i) / threads);
+			int last = (int)(((long long)count * (i + 1)) / threads);
+			workers.push_back(std::thread(function, first, last));
+		}
+		for (int i = 0; i < (int)workers.size(); i++)
+		{
+			workers[i].join();
+		}
+	}
+
+	// the threads a mesh is split between, one if it is small
+	int ThreadsFor(int triangleCount, int threadCount)
+	{
+		if (threadCount <= 0)
+		{
+			threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+		}
+		return(std::max(1, std::min(threadCount, triangleCount / MIN_TRIANGLES_PER_THREAD)));
+	}
+
+	// scale a vector to unit length, returning false and leaving
+	// it alone if it has none
+	bool Normalize(float* vector)
+	{
+		float length = sqrtf(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+		if (length > 0.0f)
+		{
+			vector[0] /= length;
+			vector[1] /= length;
+			vector[2] /= length;
+			return(true);
+		}
+		return(false);
+	}
+
+	// remove the part of a vector along a unit normal
+	void ProjectOntoPlane(const float* vector, const float* normal, float* projected)
+	{
+		float along = vector[0] * normal[0] + vector[1] * normal[1] + vector[2] * normal[2];
+		projected[0] = vector[0] - normal[0] * along;
+		projected[1] = vector[1] - normal[1] * along;
+		projected[2] = vector[2] - normal[2] * along;
+	}
+
+	/***********************************************************
+	 *  FaceNormal()
+	 *
+	 *  The cross product of two edges of a triangle, twice
+	 *  its area long.
+	 ***********************************************************/
+	void FaceNormal(const GLfloat* vertices, int floatsPerVertex, const GLuint* triangle, float* normal)
+	{
+		const GLfloat* p0 = vertices + ((size_t)triangle[0] * floatsPerVertex);
+		const GLfloat* p1 = vertices + ((size_t)triangle[1] * floatsPerVertex);
+		const GLfloat* p2 = vertices + ((size_t)triangle[2] * floatsPerVertex);
+		float e1x = p1[0] - p0[0];
+		float e1y = p1[1] - p0[1];
+		float e1z = p1[2] - p0[2];
+		float e2x = p2[0] - p0[0];
+		float e2y = p2[1] - p0[1];
+		float e2z = p2[2] - p0[2];
+		normal[0] = e1y * e2z - e1z * e2y;
+		normal[1] = e1z * e2x - e1x * e2z;
+		normal[2] = e1x * e2y - e1y * e2x;
+	}
+
+	/***********************************************************
+	 *  FaceTangent()
+	 *
+	 *  The direction of increasing u across a triangle, the
+	 *  way MikkTSpace finds it - scaled to unit length and
+	 *  turned around for triangles whose texture is mirrored.
+	 ***********************************************************/
+	void FaceTangent(const GLfloat* vertices, int floatsPerVertex, const GLuint* triangle, FACE_TANGENT& face)
+	{
+		const GLfloat* p0 = vertices + ((size_t)triangle[0] * floatsPerVertex);
+		const GLfloat* p1 = vertices + ((size_t)triangle[1] * floatsPerVertex);
+		const GLfloat* p2 = vertices + ((size_t)triangle[2] * floatsPerVertex);
+		const int UV = NormalGenerator::UV_OFFSET;
+
+		float t21x = p1[UV] - p0[UV];
+		float t21y = p1[UV + 1] - p0[UV + 1];
+		float t31x = p2[UV] - p0[UV];
+		float t31y = p2[UV + 1] - p0[UV + 1];
+		float area = t21x * t31y - t21y * t31x;
+
+		float direction[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			direction[axis] = t31y * (p1[axis] - p0[axis]) - t21y * (p2[axis] - p0[axis]);
+		}
+		float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+
+		if ((area == 0.0f) || (length == 0.0f))
+		{
+			face.direction[0] = 0.0f;
+			face.direction[1] = 0.0f;
+			face.direction[2] = 0.0f;
+			face.sign = 0.0f;
+			return;
+		}
+		face.sign = (area > 0.0f) ? 1.0f : -1.0f;
+		float scale = face.sign / length;
+		face.direction[0] = direction[0] * scale;
+		face.direction[1] = direction[1] * scale;
+		face.direction[2] = direction[2] * scale;
+	}
+
+#if defined(NORMAL_USE_SSE2)
+	// the x, y and z of a vector, with zero in the fourth lane
+	__m128 Load3(const float* values)
+	{
+		return(_mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)values), _mm_load_ss(values + 2)));
+	}
+
+	// write the x, y and z of a vector, leaving what follows alone
+	void Store3(float* values, __m128 vector)
+	{
+		_mm_storel_pi((__m64*)values, vector);
+		_mm_store_ss(values + 2, _mm_movehl_ps(vector, vector));
+	}
+
+	// the dot product in every lane, added in the same order as
+	// the scalar functions add it
+	__m128 Dot3(__m128 a, __m128 b)
+	{
+		__m128 products = _mm_mul_ps(a, b);
+		__m128 sum = _mm_add_ss(
+			_mm_add_ss(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 1, 1, 1))),
+			_mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 2, 2, 2)));
+		return(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0)));
+	}
+
+	__m128 Cross(__m128 a, __m128 b)
+	{
+		__m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 aZXY = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+		__m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 bZXY = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+		return(_mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX)));
+	}
+
+	bool Normalize(__m128& vector)
+	{
+		__m128 length = _mm_sqrt_ps(Dot3(vector, vector));
+		if (_mm_cvtss_f32(length) > 0.0f)
+		{
+			vector = _mm_div_ps(vector, length);
+			return(true);
+		}
+		return(false);
+	}
+
+	__m128 ProjectOntoPlane(__m128 vector, __m128 normal)
+	{
+		return(_mm_sub_ps(vector, _mm_mul_ps(normal, Dot3(vector, normal))));
+	}
+#endif
+
+	/***********************************************************
+	 *  KernelFaceNormal()
+	 *
+	 *  FaceNormal() with a whole vector per operation where
+	 *  SSE2 is available.  Every lane does the operations of
+	 *  the scalar function in the same order, so the results
+	 *  are the same to the bit.
+	 ***********************************************************/
+	void KernelFaceNormal(const GLfloat* vertices, int floatsPerVertex, const GLuint* triangle, float* normal)
+	{
+#if defined(NORMAL_USE_SSE2)
+		__m128 p0 = Load3(vertices + ((size_t)triangle[0] * floatsPerVertex));
+		__m128 p1 = Load3(vertices + ((size_t)triangle[1] * floatsPerVertex));
+		__m128 p2 = Load3(vertices + ((size_t)triangle[2] * floatsPerVertex));
+		Store3(normal, Cross(_mm_sub_ps(p1, p0), _mm_sub_ps(p2, p0)));
+#else
+		FaceNormal(vertices, floatsPerVertex, triangle, normal);
+#endif
+	}
+
+	// add a face normal to a vertex normal - three scalar adds
+	// beat loading and storing a vector here
+	void KernelAddNormal(float* normal, const float* face)
+	{
+		normal[0] += face[0];
+		normal[1] += face[1];
+		normal[2] += face[2];
+	}
+
+	// scale the normals of a range of vertices to unit length,
+	// leaving a zero normal zero
+	void KernelNormalizeNormals(GLfloat* vertices, int floatsPerVertex, int first, int last)
+	{
+		for (int v = first; v < last; v++)
+		{
+			GLfloat* normal = vertices + ((size_t)v * floatsPerVertex) + NormalGenerator::NORMAL_OFFSET;
+#if defined(NORMAL_USE_SSE2)
+			__m128 vector = Load3(normal);
+			if (Normalize(vector) == true)
+			{
+				Store3(normal, vector);
+			}
+#else
+			Normalize(normal);
+#endif
+		}
+	}
+
+	/***********************************************************
+	 *  KernelFaceTangent()
+	 *
+	 *  FaceTangent() with a whole vector per operation where
+	 *  SSE2 is available, the same to the bit.
+	 ***********************************************************/
+	void KernelFaceTangent(const GLfloat* vertices, int floatsPerVertex, const GLuint* triangle, FACE_TANGENT& face)
+	{
+#if defined(NORMAL_USE_SSE2)
+		const GLfloat* p0 = vertices + ((size_t)triangle[0] * floatsPerVertex);
+		const GLfloat* p1 = vertices + ((size_t)triangle[1] * floatsPerVertex);
+		const GLfloat* p2 = vertices + ((size_t)triangle[2] * floatsPerVertex);
+		const int UV = NormalGenerator::UV_OFFSET;
+
+		float t21x = p1[UV] - p0[UV];
+		float t21y = p1[UV + 1] - p0[UV + 1];
+		float t31x = p2[UV] - p0[UV];
+		float t31y = p2[UV + 1] - p0[UV + 1];
+		float area = t21x * t31y - t21y * t31x;
+
+		__m128 position = Load3(p0);
+		__m128 direction = _mm_sub_ps(
+			_mm_mul_ps(_mm_set1_ps(t31y), _mm_sub_ps(Load3(p1), position)),
+			_mm_mul_ps(_mm_set1_ps(t21y), _mm_sub_ps(Load3(p2), position)));
+		float length = _mm_cvtss_f32(_mm_sqrt_ps(Dot3(direction, direction)));
+
+		if ((area == 0.0f) || (length == 0.0f))
+		{
+			Store3(face.direction, _mm_setzero_ps());
+			face.sign = 0.0f;
+			return;
+		}
+		face.sign = (area > 0.0f) ? 1.0f : -1.0f;
+		Store3(face.direction, _mm_mul_ps(direction, _mm_set1_ps(face.sign / length)));
+#else
+		FaceTangent(vertices, floatsPerVertex, triangle, face);
+#endif
+	}
+
+	/***********************************************************
+	 *  AddCornerTangent()
+	 *
+	 *  Add a triangle's tangent to the sum of one of its
+	 *  vertices, projected onto the plane of the vertex normal
+	 *  and weighted by the angle of the triangle at the vertex,
+	 *  as MikkTSpace does.  The fourth value sums the weighted
+	 *  handedness.
+	 ***********************************************************/
+	void AddCornerTangent(
+		const GLfloat* vertices,
+		int floatsPerVertex,
+		const GLuint* triangle,
+		int corner,
+		const FACE_TANGENT& face,
+		float* sum)
+	{
+		if (face.sign == 0.0f)
+		{
+			return;
+		}
+
+		const GLfloat* p = vertices + ((size_t)triangle[corner] * floatsPerVertex);
+		const GLfloat* next = vertices + ((size_t)triangle[(corner + 1) % 3] * floatsPerVertex);
+		const GLfloat* previous = vertices + ((size_t)triangle[(corner + 2) % 3] * floatsPerVertex);
+		const GLfloat* normal = p + NormalGenerator::NORMAL_OFFSET;
+
+		float tangent[3];
+		ProjectOntoPlane(face.direction, normal, tangent);
+		float edge1[3] = { next[0] - p[0], next[1] - p[1], next[2] - p[2] };
+		float edge2[3] = { previous[0] - p[0], previous[1] - p[1], previous[2] - p[2] };
+		ProjectOntoPlane(edge1, normal, edge1);
+		ProjectOntoPlane(edge2, normal, edge2);
+		if ((Normalize(tangent) == false) || (Normalize(edge1) == false) || (Normalize(edge2) == false))
+		{
+			return;
+		}
+
+		float cosine = edge1[0] * edge2[0] + edge1[1] * edge2[1] + edge1[2] * edge2[2];
+		float angle = acosf(std::max(-1.0f, std::min(1.0f, cosine)));
+		sum[0] += tangent[0] * angle;
+		sum[1] += tangent[1] * angle;
+		sum[2] += tangent[2] * angle;
+		sum[3] += face.sign * angle;
+	}
+
+	/***********************************************************
+	 *  KernelAddCornerTangent()
+	 *
+	 *  AddCornerTangent() with a whole vector per operation
+	 *  where SSE2 is available, the same to the bit.
+	 ***********************************************************/
+	void KernelAddCornerTangent(
+		const GLfloat* vertices,
+		int floatsPerVertex,
+		const GLuint* triangle,
+		int corner,
+		const FACE_TANGENT& face,
+		float* sum)
+	{
+#if defined(NORMAL_USE_SSE2)
+		if (face.sign == 0.0f)
+		{
+			return;
+		}
+
+		const GLfloat* p = vertices + ((size_t)triangle[corner] * floatsPerVertex);
+		__m128 position = Load3(p);
+		__m128 next = Load3(vertices + ((size_t)triangle[(corner + 1) % 3] * floatsPerVertex));
+		__m128 previous = Load3(vertices + ((size_t)triangle[(corner + 2) % 3] * floatsPerVertex));
+		__m128 normal = Load3(p + NormalGenerator::NORMAL_OFFSET);
+
+		__m128 tangent = ProjectOntoPlane(Load3(face.direction), normal);
+		__m128 edge1 = ProjectOntoPlane(_mm_sub_ps(next, position), normal);
+		__m128 edge2 = ProjectOntoPlane(_mm_sub_ps(previous, position), normal);
+		if ((Normalize(tangent) == false) || (Normalize(edge1) == false) || (Normalize(edge2) == false))
+		{
+			return;
+		}
+
+		float cosine = _mm_cvtss_f32(Dot3(edge1, edge2));
+		float angle = acosf(std::max(-1.0f, std::min(1.0f, cosine)));
+		Store3(sum, _mm_add_ps(Load3(sum), _mm_mul_ps(tangent, _mm_set1_ps(angle))));
+		sum[3] += face.sign * angle;
+#else
+		AddCornerTangent(vertices, floatsPerVertex, triangle, corner, face, sum);
+#endif
+	}
+
+	/***********************************************************
+	 *  FinishTangent()
+	 *
+	 *  Turn the summed corner tangents of a vertex into a unit
+	 *  tangent in the plane of its normal and its handedness.
+	 *  A vertex without texture area around it gets any
+	 *  direction in the plane.
+	 ***********************************************************/
+	void FinishTangent(const GLfloat* vertex, const float* sum, GLfloat* tangent)
+	{
+		const GLfloat* normal = vertex + NormalGenerator::NORMAL_OFFSET;
+		float direction[3];
+		ProjectOntoPlane(sum, normal, direction);
+		if (Normalize(direction) == false)
+		{
+			// the cross product with the axis least along the normal
+			float axis[3] = { 0.0f, 0.0f, 0.0f };
+			axis[(fabsf(normal[0]) < 0.9f) ? 0 : 1] = 1.0f;
+			direction[0] = normal[1] * axis[2] - normal[2] * axis[1];
+			direction[1] = normal[2] * axis[0] - normal[0] * axis[2];
+			direction[2] = normal[0] * axis[1] - normal[1] * axis[0];
+			if (Normalize(direction) == false)
+			{
+				direction[0] = 1.0f;
+			}
+		}
+		tangent[0] = direction[0];
+		tangent[1] = direction[1];
+		tangent[2] = direction[2];
+		tangent[3] = (sum[3] < 0.0f) ? -1.0f : 1.0f;
+	}
+
+	/***********************************************************
+	 *  BuildCornerLists()
+	 *
+	 *  List the corners of the triangles at each vertex, in
+	 *  the order of the triangle list - corner c of triangle t
+	 *  is t * 3 + c.  The corners of vertex v run from
+	 *  offsets[v] to offsets[v + 1].
+	 ***********************************************************/
+	void BuildCornerLists(
+		const GLuint* indices,
+		int indexCount,
+		int vertexCount,
+		std::vector<int>& offsets,
+		std::vector<int>& corners)
+	{
+		offsets.assign((size_t)vertexCount + 1, 0);
+		for (int i = 0; i < indexCount; i++)
+		{
+			offsets[indices[i] + 1]++;
+		}
+		for (int v = 0; v < vertexCount; v++)
+		{
+			offsets[v + 1] += offsets[v];
+		}
+
+		std::vector<int> next(offsets.begin(), offsets.end() - 1);
+		corners.resize(indexCount);
+		for (int i = 0; i < indexCount; i++)
+		{
+			corners[next[indices[i]]++] = i;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetInstructionSet()
+ *
+ *  Get the name of the instruction set the kernels use.
+ ***********************************************************/
+const char* NormalGenerator::GetInstructionSet()
+{
+#if defined(NORMAL_USE_SSE2)
+	return("SSE2");
+#else
+	return("scalar");
+#endif
+}
+
+/***********************************************************
+ *  GenerateNormals()
+ *
+ *  On one thread the triangle normals are added straight
+ *  into the vertex normals.  On
+ *  more, the triangle normals are computed in parallel, and
+ *  then each thread sums them for its range of vertices
+ *  from the lists of corners at each vertex.
+ ***********************************************************/
+void NormalGenerator::GenerateNormals(
+	GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	const GLuint* indices,
+	int indexCount,
+	int threadCount)
+{
+	int triangleCount = indexCount / 3;
+	int threads = ThreadsFor(triangleCount, threadCount);
+
+	if (threads <= 1)
+	{
+		for (int v = 0; v < vertexCount; v++)
+		{
+			GLfloat* normal = vertices + ((size_t)v * floatsPerVertex) + NORMAL_OFFSET;
+			normal[0] = 0.0f;
+			normal[1] = 0.0f;
+			normal[2] = 0.0f;
+		}
+
+		for (int t = 0; t < triangleCount; t++)
+		{
+			float face[3];
+			KernelFaceNormal(vertices, floatsPerVertex, indices + (t * 3), face);
+			for (int corner = 0; corner < 3; corner++)
+			{
+				KernelAddNormal(vertices + ((size_t)indices[(t * 3) + corner] * floatsPerVertex) + NORMAL_OFFSET, face);
+			}
+		}
+
+		KernelNormalizeNormals(vertices, floatsPerVertex, 0, vertexCount);
+		return;
+	}
+
+	std::vector<float> faces((size_t)triangleCount * 3);
+	ParallelRanges(triangleCount, threads, [&](int first, int last) {
+		for (int t = first; t < last; t++)
+		{
+			KernelFaceNormal(vertices, floatsPerVertex, indices + (t * 3), &faces[(size_t)t * 3]);
+		}
+	});
+
+	std::vector<int> offsets;
+	std::vector<int> corners;
+	BuildCornerLists(indices, triangleCount * 3, vertexCount, offsets, corners);
+
+	ParallelRanges(vertexCount, threads, [&](int first, int last) {
+		for (int v = first; v < last; v++)
+		{
+			GLfloat* normal = vertices + ((size_t)v * floatsPerVertex) + NORMAL_OFFSET;
+			normal[0] = 0.0f;
+			normal[1] = 0.0f;
+			normal[2] = 0.0f;
+			for (int c = offsets[v]; c < offsets[v + 1]; c++)
+			{
+				const float* face = &faces[(size_t)(corners[c] / 3) * 3];
+				normal[0] += face[0];
+				normal[1] += face[1];
+				normal[2] += face[2];
+			}
+		}
+		KernelNormalizeNormals(vertices, floatsPerVertex, first, last);
+	});
+}
+
+/***********************************************************
+ *  GenerateTangents()
+ *
+ *  Split like GenerateNormals() - on one thread the corner
+ *  tangents are added straight into the output, and on
+ *  more each thread sums the corners of its own vertices.
+ *  The normals must be set first.
+ ***********************************************************/
+void NormalGenerator::GenerateTangents(
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	const GLuint* indices,
+	int indexCount,
+	GLfloat* tangents,
+	int threadCount)
+{
+	int triangleCount = indexCount / 3;
+	int threads = ThreadsFor(triangleCount, threadCount);
+
+	if (threads <= 1)
+	{
+		std::fill(tangents, tangents + ((size_t)vertexCount * FLOATS_PER_TANGENT), 0.0f);
+
+		for (int t = 0; t < triangleCount; t++)
+		{
+			FACE_TANGENT face;
+			const GLuint* triangle = indices + (t * 3);
+			KernelFaceTangent(vertices, floatsPerVertex, triangle, face);
+			for (int corner = 0; corner < 3; corner++)
+			{
+				KernelAddCornerTangent(vertices, floatsPerVertex, triangle, corner, face,
+					tangents + ((size_t)triangle[corner] * FLOATS_PER_TANGENT));
+			}
+		}
+
+		for (int v = 0; v < vertexCount; v++)
+		{
+			GLfloat* tangent = tangents + ((size_t)v * FLOATS_PER_TANGENT);
+			float sum[4] = { tangent[0], tangent[1], tangent[2], tangent[3] };
+			FinishTangent(vertices + ((size_t)v * floatsPerVertex), sum, tangent);
+		}
+		return;
+	}
+
+	std::vector<FACE_TANGENT> faces(triangleCount);
+	ParallelRanges(triangleCount, threads, [&](int first, int last) {
+		for (int t = first; t < last; t++)
+		{
+			KernelFaceTangent(vertices, floatsPerVertex, indices + (t * 3), faces[t]);
+		}
+	});
+
+	std::vector<int> offsets;
+	std::vector<int> corners;
+	BuildCornerLists(indices, triangleCount * 3, vertexCount, offsets, corners);
+
+	ParallelRanges(vertexCount, threads, [&](int first, int last) {
+		for (int v = first; v < last; v++)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int c = offsets[v]; c < offsets[v + 1]; c++)
+			{
+				int t = corners[c] / 3;
+				KernelAddCornerTangent(vertices, floatsPerVertex, indices + (t * 3), corners[c] % 3, faces[t], sum);
+			}
+			FinishTangent(vertices + ((size_t)v * floatsPerVertex), sum, tangents + ((size_t)v * FLOATS_PER_TANGENT));
+		}
+	});
+}
+
+/***********************************************************
+ *  GenerateNormalsReference()
+ *
+ *  Add each triangle's normal to its vertices, then scale
+ *  them to unit length, one value at a time.
+ ***********************************************************/
+void NormalGenerator::GenerateNormalsReference(
+	GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	const GLuint* indices,
+	int indexCount)
+{
+	for (int v = 0; v < vertexCount; v++)
+	{
+		GLfloat* normal = vertices + ((size_t)v * floatsPerVertex) + NORMAL_OFFSET;
+		normal[0] = 0.0f;
+		normal[1] = 0.0f;
+		normal[2] = 0.0f;
+	}
+
+	for (int t = 0; t < indexCount / 3; t++)
+	{
+		float face[3];
+		FaceNormal(vertices, floatsPerVertex, indices + (t * 3), face);
+		for (int corner = 0; corner < 3; corner++)
+		{
+			GLfloat* normal = vertices + ((size_t)indices[(t * 3) + corner] * floatsPerVertex) + NORMAL_OFFSET;
+			normal[0] += face[0];
+			normal[1] += face[1];
+			normal[2] += face[2];
+		}
+	}
+
+	for (int v = 0; v < vertexCount; v++)
+	{
+		Normalize(vertices + ((size_t)v * floatsPerVertex) + NORMAL_OFFSET);
+	}
+}
+
+/***********************************************************
+ *  GenerateTangentsReference()
+ *
+ *  Add each triangle's tangent to its vertices' sums, then
+ *  finish each sum, one triangle at a time.
+ ***********************************************************/
+void NormalGenerator::GenerateTangentsReference(
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	const GLuint* indices,
+	int indexCount,
+	GLfloat* tangents)
+{
+	std::vector<float> sums((size_t)vertexCount * FLOATS_PER_TANGENT, 0.0f);
+	for (int t = 0; t < indexCount / 3; t++)
+	{
+		FACE_TANGENT face;
+		const GLuint* triangle = indices + (t * 3);
+		FaceTangent(vertices, floatsPerVertex, triangle, face);
+		for (int corner = 0; corner < 3; corner++)
+		{
+			AddCornerTangent(vertices, floatsPerVertex, triangle, corner, face,
+				&sums[(size_t)triangle[corner] * FLOATS_PER_TANGENT]);
+		}
+	}
+
+	for (int v = 0; v < vertexCount; v++)
+	{
+		FinishTangent(vertices + ((size_t)v * floatsPerVertex), &sums[(size_t)v * FLOATS_PER_TANGENT],
+			tangents + ((size_t)v * FLOATS_PER_TANGENT));
+	}
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// normalgenerator.h
+// ============
+// compute smooth vertex normals and tangents for whole indexed meshes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  NormalGenerator
+ *
+ *  This class computes the normals and tangents of an
+ *  interleaved vertex array with the layout ShapeGenerator
+ *  writes - position, then normal, then texture coords -
+ *  from the triangle list that indexes it:
+ *
+ *  - the normal of a vertex is the sum of the cross
+ *    products of the triangles around it, so each triangle
+ *    counts by its area
+ *  - the tangent follows MikkTSpace: each triangle's
+ *    direction of increasing u is projected onto the plane
+ *    of the vertex normal and weighted by the angle of the
+ *    triangle at the vertex, and the fourth value is the
+ *    sign of the bitangent, cross(normal, tangent) * w
+ *
+ *  With SSE2 each vector is worked on whole, a vertex at a
+ *  time, and large meshes are split between threads, each
+ *  summing the triangles around its own vertices.  Every
+ *  sum adds the triangles in the order of the list, so the
+ *  results match the scalar reference functions exactly,
+ *  whatever the number of threads.  Small meshes on one
+ *  thread allocate nothing.  Nothing here uses OpenGL.
+ ***********************************************************/
+class NormalGenerator
+{
+public:
+	// where the normal and texture coords start in a vertex
+	static const int NORMAL_OFFSET = 3;
+	static const int UV_OFFSET = 6;
+	// values in one tangent - the direction and its handedness
+	static const int FLOATS_PER_TANGENT = 4;
+
+	// the instruction set the kernels were built with
+	static const char* GetInstructionSet();
+
+	// replace the normals of the vertices with the area weighted
+	// normals of the triangles around them - a thread count of
+	// zero uses every core
+	static void GenerateNormals(
+		GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		const GLuint* indices,
+		int indexCount,
+		int threadCount = 0);
+
+	// write a tangent for each vertex from its normal and the
+	// texture coords of the triangles around it
+	static void GenerateTangents(
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		const GLuint* indices,
+		int indexCount,
+		GLfloat* tangents,
+		int threadCount = 0);
+
+	// the same results one triangle at a time, without SIMD or
+	// threads, for checking the kernels against
+	static void GenerateNormalsReference(
+		GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		const GLuint* indices,
+		int indexCount);
+	static void GenerateTangentsReference(
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		const GLuint* indices,
+		int indexCount,
+		GLfloat* tangents);
+};
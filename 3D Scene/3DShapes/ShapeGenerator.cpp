@@ -0,0 +1,1204 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapegenerator.cpp
+// ============
+// generate the vertex and index data of the 3D primitives at any
+// tessellation:
+//     box, cone, cylinder, plane, prism, pyramid, sphere, tapered cylinder, torus
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShapeGenerator.h"
+#include "NormalGenerator.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const double g_Pi = 3.14159265358979323846;
+
+	/***********************************************************
+	 *  FIXED_FACE
+	 *
+	 *  One flat face of a shape with a fixed layout - a
+	 *  triangle or a quad whose corners index the shape's
+	 *  table of corner positions, with the normal of the
+	 *  face and the texture coords of each corner.  Every
+	 *  face gets its own vertices, so its normal and texture
+	 *  coords are not shared with its neighbours.
+	 ***********************************************************/
+	struct FIXED_FACE
+	{
+		int cornerCount;
+		int corners[4];
+		GLfloat normal[3];
+		GLfloat uv[4][2];
+	};
+
+	// the interleaved vertices and the triangle list of a shape
+	// with a fixed layout
+	template <int VERTEX_COUNT, int INDEX_COUNT>
+	struct FIXED_SHAPE
+	{
+		GLfloat vertices[VERTEX_COUNT * ShapeGenerator::FLOATS_PER_VERTEX];
+		GLuint indices[INDEX_COUNT];
+	};
+
+	/***********************************************************
+	 *  FixedVertexCount() / FixedIndexCount()
+	 *
+	 *  Count the vertices and indices written for a table of
+	 *  faces, while compiling.
+	 ***********************************************************/
+	template <size_t FACE_COUNT>
+	constexpr int FixedVertexCount(const FIXED_FACE (&faces)[FACE_COUNT])
+	{
+		int count = 0;
+		for (const FIXED_FACE& face : faces)
+		{
+			count += face.cornerCount;
+		}
+		return(count);
+	}
+
+	template <size_t FACE_COUNT>
+	constexpr int FixedIndexCount(const FIXED_FACE (&faces)[FACE_COUNT])
+	{
+		int count = 0;
+		for (const FIXED_FACE& face : faces)
+		{
+			count += (face.cornerCount - 2) * 3;
+		}
+		return(count);
+	}
+
+	/***********************************************************
+	 *  FixedFacesValid()
+	 *
+	 *  Check a table of faces while compiling - every face
+	 *  is a triangle or a quad, its corners are in the table
+	 *  of corner positions, and its normal is unit length.
+	 ***********************************************************/
+	template <size_t FACE_COUNT>
+	constexpr bool FixedFacesValid(const FIXED_FACE (&faces)[FACE_COUNT], int cornerCount)
+	{
+		for (const FIXED_FACE& face : faces)
+		{
+			if ((face.cornerCount != 3) && (face.cornerCount != 4))
+			{
+				return(false);
+			}
+			for (int c = 0; c < face.cornerCount; c++)
+			{
+				if ((face.corners[c] < 0) || (face.corners[c] >= cornerCount))
+				{
+					return(false);
+				}
+			}
+			GLfloat length = (face.normal[0] * face.normal[0]) +
+				(face.normal[1] * face.normal[1]) +
+				(face.normal[2] * face.normal[2]);
+			if ((length < 0.9999f) || (length > 1.0001f))
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  BuildFixedShape()
+	 *
+	 *  Write the vertices of each face in corner order, and
+	 *  its triangles - a quad is split along the diagonal
+	 *  from its first corner, as (0,1,2) and (0,3,2).  This
+	 *  runs while compiling, so the result is a constant.
+	 ***********************************************************/
+	template <int VERTEX_COUNT, int INDEX_COUNT, size_t CORNER_COUNT, size_t FACE_COUNT>
+	constexpr FIXED_SHAPE<VERTEX_COUNT, INDEX_COUNT> BuildFixedShape(
+		const GLfloat (&corners)[CORNER_COUNT][3],
+		const FIXED_FACE (&faces)[FACE_COUNT])
+	{
+		FIXED_SHAPE<VERTEX_COUNT, INDEX_COUNT> shape = {};
+		int vertex = 0;
+		int index = 0;
+		for (const FIXED_FACE& face : faces)
+		{
+			GLuint first = (GLuint)vertex;
+			for (int c = 0; c < face.cornerCount; c++)
+			{
+				GLfloat* written = shape.vertices + (vertex * ShapeGenerator::FLOATS_PER_VERTEX);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					written[axis] = corners[face.corners[c]][axis];
+					written[3 + axis] = face.normal[axis];
+				}
+				written[6] = face.uv[c][0];
+				written[7] = face.uv[c][1];
+				vertex++;
+			}
+
+			shape.indices[index++] = first;
+			shape.indices[index++] = first + 1;
+			shape.indices[index++] = first + 2;
+			if (face.cornerCount == 4)
+			{
+				shape.indices[index++] = first;
+				shape.indices[index++] = first + 3;
+				shape.indices[index++] = first + 2;
+			}
+		}
+		return(shape);
+	}
+
+	/***********************************************************
+	 *  AppendSideFans()
+	 *
+	 *  Copy a built shape of quads and add every face again
+	 *  after its triangles, split as the fan (0,1,2) and
+	 *  (0,2,3).  A side drawn alone over the whole shape then
+	 *  keeps the vertex order it was always drawn in, and with
+	 *  it the depth rounding the scene's decals were set up on.
+	 ***********************************************************/
+	template <int VERTEX_COUNT, int INDEX_COUNT>
+	constexpr FIXED_SHAPE<VERTEX_COUNT, INDEX_COUNT * 2> AppendSideFans(
+		const FIXED_SHAPE<VERTEX_COUNT, INDEX_COUNT>& built)
+	{
+		FIXED_SHAPE<VERTEX_COUNT, INDEX_COUNT * 2> shape = {};
+		for (int i = 0; i < VERTEX_COUNT * ShapeGenerator::FLOATS_PER_VERTEX; i++)
+		{
+			shape.vertices[i] = built.vertices[i];
+		}
+		for (int i = 0; i < INDEX_COUNT; i++)
+		{
+			shape.indices[i] = built.indices[i];
+		}
+		for (int face = 0; face < INDEX_COUNT / 6; face++)
+		{
+			GLuint first = built.indices[face * 6];
+			GLuint* fan = shape.indices + INDEX_COUNT + (face * 6);
+			fan[0] = first;
+			fan[1] = first + 1;
+			fan[2] = first + 2;
+			fan[3] = first;
+			fan[4] = first + 2;
+			fan[5] = first + 3;
+		}
+		return(shape);
+	}
+
+	// builds the constant data of a shape from its corner and face
+	// tables, sized by the tables
+#define BUILD_FIXED_SHAPE(corners, faces) \
+	BuildFixedShape<FixedVertexCount(faces), FixedIndexCount(faces)>(corners, faces)
+
+	// the texture coords of a box face, whose corners run from the
+	// top left down, across and up again
+#define BOX_FACE_UV { { 0.0f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f } }
+	// the texture coords of a triangle side of a pyramid, from the
+	// top point down to the bottom left and right
+#define PYRAMID_SIDE_UV { { 0.5f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 0.0f } }
+
+	// the normal of the slanted sides of the prism and 3-sided pyramid
+	constexpr GLfloat g_SlantX = 0.894427180f;
+	constexpr GLfloat g_SlantZ = 0.447213590f;
+
+	// unit box - the corners are numbered by their sides, +x
+	// adding 1, +y adding 2 and +z adding 4.  The normals are the
+	// ones the scene's lighting was set up with, which point into
+	// the box on every face but the left.
+	constexpr GLfloat g_BoxCorners[8][3] = {
+		{ -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f },
+		{ -0.5f,  0.5f, -0.5f }, { 0.5f,  0.5f, -0.5f },
+		{ -0.5f, -0.5f,  0.5f }, { 0.5f, -0.5f,  0.5f },
+		{ -0.5f,  0.5f,  0.5f }, { 0.5f,  0.5f,  0.5f },
+	};
+	constexpr FIXED_FACE g_BoxFaces[] = {
+		{ 4, { 3, 1, 0, 2 }, {  0.0f,  0.0f,  1.0f }, BOX_FACE_UV },		// back
+		{ 4, { 4, 0, 1, 5 }, {  0.0f,  1.0f,  0.0f }, BOX_FACE_UV },		// bottom
+		{ 4, { 2, 0, 4, 6 }, { -1.0f,  0.0f,  0.0f }, BOX_FACE_UV },		// left
+		{ 4, { 7, 5, 1, 3 }, { -1.0f,  0.0f,  0.0f }, BOX_FACE_UV },		// right
+		{ 4, { 2, 6, 7, 3 }, {  0.0f, -1.0f,  0.0f }, BOX_FACE_UV },		// top
+		{ 4, { 6, 4, 5, 7 }, {  0.0f,  0.0f, -1.0f }, BOX_FACE_UV },		// front
+	};
+
+	// 2x2 plane facing up
+	constexpr GLfloat g_PlaneCorners[4][3] = {
+		{ -1.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, -1.0f }, { -1.0f, 0.0f, -1.0f },
+	};
+	constexpr FIXED_FACE g_PlaneFaces[] = {
+		{ 4, { 0, 1, 2, 3 }, { 0.0f, 1.0f, 0.0f }, { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } } },
+	};
+
+	// triangular prism - the bottom corners back right, back
+	// left and front, then the same three on top.  The faces of
+	// the prism and pyramids are listed in the order the mesh
+	// optimizer draws them in, sides before the bottom, so the
+	// built data needs no reordering when it is loaded.
+	constexpr GLfloat g_PrismCorners[6][3] = {
+		{ 0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, -0.5f }, { 0.0f, -0.5f, 0.5f },
+		{ 0.5f,  0.5f, -0.5f }, { -0.5f,  0.5f, -0.5f }, { 0.0f,  0.5f, 0.5f },
+	};
+	constexpr FIXED_FACE g_PrismFaces[] = {
+		{ 4, { 3, 0, 1, 4 }, { 0.0f, 0.0f, -1.0f }, BOX_FACE_UV },										// back
+		{ 4, { 1, 4, 5, 2 }, { g_SlantX, 0.0f, -g_SlantZ },
+			{ { 0.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f } } },							// left
+		{ 4, { 5, 3, 0, 2 }, { -g_SlantX, 0.0f, -g_SlantZ },
+			{ { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, 0.0f } } },							// right
+		{ 3, { 0, 1, 2 }, { 0.0f, -1.0f, 0.0f }, { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.5f, 1.0f } } },	// bottom
+		{ 3, { 3, 5, 4 }, { 0.0f, 1.0f, 0.0f }, { { 0.0f, 0.0f }, { 0.5f, 1.0f }, { 1.0f, 0.0f } } },		// top
+	};
+
+	// 3-sided pyramid - the top point, then the bottom corners
+	// back center, front left and front right
+	constexpr GLfloat g_Pyramid3Corners[4][3] = {
+		{ 0.0f, 0.5f, 0.0f }, { 0.0f, -0.5f, -0.5f }, { -0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f },
+	};
+	constexpr FIXED_FACE g_Pyramid3Faces[] = {
+		{ 3, { 0, 2, 3 }, { 0.0f, 0.0f, 1.0f }, PYRAMID_SIDE_UV },										// front
+		{ 3, { 0, 1, 2 }, { -g_SlantX, 0.0f, -g_SlantZ }, PYRAMID_SIDE_UV },							// left
+		{ 3, { 0, 3, 1 }, { g_SlantX, 0.0f, -g_SlantZ }, PYRAMID_SIDE_UV },								// right
+		{ 3, { 2, 3, 1 }, { 0.0f, -1.0f, 0.0f }, { { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 0.5f, 0.0f } } },	// bottom
+	};
+
+	// 4-sided pyramid - the top point, then the bottom corners
+	// back left, back right, front left and front right
+	constexpr GLfloat g_Pyramid4Corners[5][3] = {
+		{ 0.0f, 0.5f, 0.0f },
+		{ -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f },
+	};
+	constexpr FIXED_FACE g_Pyramid4Faces[] = {
+		{ 3, { 0, 2, 1 }, { 0.0f, 0.0f, -1.0f }, PYRAMID_SIDE_UV },		// back
+		{ 3, { 0, 1, 3 }, { -1.0f, 0.0f, 0.0f }, PYRAMID_SIDE_UV },		// left
+		{ 3, { 0, 4, 2 }, { 1.0f, 0.0f, 0.0f }, PYRAMID_SIDE_UV },		// right
+		{ 3, { 0, 3, 4 }, { 0.0f, 0.0f, 1.0f }, PYRAMID_SIDE_UV },		// front
+		{ 4, { 3, 1, 2, 4 }, { 0.0f, -1.0f, 0.0f }, BOX_FACE_UV },		// bottom
+	};
+
+	static_assert(FixedFacesValid(g_BoxFaces, 8), "bad box face");
+	static_assert(FixedFacesValid(g_PlaneFaces, 4), "bad plane face");
+	static_assert(FixedFacesValid(g_PrismFaces, 6), "bad prism face");
+	static_assert(FixedFacesValid(g_Pyramid3Faces, 4), "bad 3-sided pyramid face");
+	static_assert(FixedFacesValid(g_Pyramid4Faces, 5), "bad 4-sided pyramid face");
+
+	// the built shapes are constants, kept in read only storage
+	constexpr auto g_Box = AppendSideFans(BUILD_FIXED_SHAPE(g_BoxCorners, g_BoxFaces));
+	constexpr auto g_Plane = BUILD_FIXED_SHAPE(g_PlaneCorners, g_PlaneFaces);
+	constexpr auto g_Prism = BUILD_FIXED_SHAPE(g_PrismCorners, g_PrismFaces);
+	constexpr auto g_Pyramid3 = BUILD_FIXED_SHAPE(g_Pyramid3Corners, g_Pyramid3Faces);
+	constexpr auto g_Pyramid4 = BUILD_FIXED_SHAPE(g_Pyramid4Corners, g_Pyramid4Faces);
+
+	// the box has six indices per face, and six more per face for
+	// DrawBoxMeshSide(), and the others keep their counts
+	static_assert(FixedVertexCount(g_BoxFaces) == 24 && FixedIndexCount(g_BoxFaces) == ShapeGenerator::BOX_INDEX_COUNT, "the box must have 24 vertices and 36 indices");
+	static_assert(sizeof(g_Box.indices) / sizeof(GLuint) == ShapeGenerator::BOX_SIDE_FIRST_INDEX + 36, "the box side fans must follow its triangles");
+	static_assert(FixedVertexCount(g_PlaneFaces) == 4 && FixedIndexCount(g_PlaneFaces) == 6, "the plane must have 4 vertices and 6 indices");
+	static_assert(FixedVertexCount(g_PrismFaces) == 18 && FixedIndexCount(g_PrismFaces) == 24, "the prism must have 18 vertices and 24 indices");
+	static_assert(FixedVertexCount(g_Pyramid3Faces) == 12 && FixedIndexCount(g_Pyramid3Faces) == 12, "the 3-sided pyramid must have 12 vertices and 12 indices");
+	static_assert(FixedVertexCount(g_Pyramid4Faces) == 16 && FixedIndexCount(g_Pyramid4Faces) == 18, "the 4-sided pyramid must have 16 vertices and 18 indices");
+
+#undef BUILD_FIXED_SHAPE
+#undef BOX_FACE_UV
+#undef PYRAMID_SIDE_UV
+
+	/***********************************************************
+	 *  FixedShapeData()
+	 *
+	 *  Point at the data of a built shape.
+	 ***********************************************************/
+	template <int VERTEX_COUNT, int INDEX_COUNT>
+	ShapeGenerator::SHAPE_DATA FixedShapeData(const FIXED_SHAPE<VERTEX_COUNT, INDEX_COUNT>& shape)
+	{
+		ShapeGenerator::SHAPE_DATA data;
+		data.vertices = shape.vertices;
+		data.indices = shape.indices;
+		data.size.vertexCount = VERTEX_COUNT;
+		data.size.indexCount = INDEX_COUNT;
+		return(data);
+	}
+
+	/***********************************************************
+	 *  WriteVertex()
+	 *
+	 *  Write one interleaved vertex and step past it.
+	 ***********************************************************/
+	GLfloat* WriteVertex(
+		GLfloat* vertex,
+		double x, double y, double z,
+		double nx, double ny, double nz,
+		double u, double v)
+	{
+		vertex[0] = (GLfloat)x;
+		vertex[1] = (GLfloat)y;
+		vertex[2] = (GLfloat)z;
+		vertex[3] = (GLfloat)nx;
+		vertex[4] = (GLfloat)ny;
+		vertex[5] = (GLfloat)nz;
+		vertex[6] = (GLfloat)u;
+		vertex[7] = (GLfloat)v;
+		return(vertex + ShapeGenerator::FLOATS_PER_VERTEX);
+	}
+
+	/***********************************************************
+	 *  WriteTriangle()
+	 *
+	 *  Write the indices of one triangle and step past them.
+	 ***********************************************************/
+	GLuint* WriteTriangle(GLuint* index, GLuint i0, GLuint i1, GLuint i2)
+	{
+		index[0] = i0;
+		index[1] = i1;
+		index[2] = i2;
+		return(index + 3);
+	}
+
+	/***********************************************************
+	 *  RimDirection()
+	 *
+	 *  Get the unit direction of a rim vertex, which wraps
+	 *  around after the last segment.
+	 ***********************************************************/
+	void RimDirection(int segments, int i, double& x, double& z)
+	{
+		double angle = (2.0 * g_Pi * (i % segments)) / segments;
+		x = cos(angle);
+		z = -sin(angle);
+	}
+
+	/***********************************************************
+	 *  WritePatchGrid()
+	 *
+	 *  Write a grid of patches over a rectangle of surface
+	 *  coords a and b, with the corner of column i and row j
+	 *  put on the surface by the passed in function.  The
+	 *  patches run along a, and each lists its corners at
+	 *  (a0, b0), (a1, b0), (a1, b1) and (a0, b1).
+	 ***********************************************************/
+	template <typename SURFACE>
+	void WritePatchGrid(
+		GLfloat*& vertex,
+		GLuint*& index,
+		GLuint& vertexCount,
+		int columns,
+		int rows,
+		double aFirst,
+		double aLast,
+		double bFirst,
+		double bLast,
+		ShapeGenerator::PatchPart part,
+		SURFACE surface)
+	{
+		GLuint first = vertexCount;
+		for (int i = 0; i <= columns; i++)
+		{
+			double a = aFirst + (((aLast - aFirst) * i) / columns);
+			for (int j = 0; j <= rows; j++)
+			{
+				double x, y, z;
+				surface(i, j, x, y, z);
+				double b = bFirst + (((bLast - bFirst) * j) / rows);
+				vertex = WriteVertex(vertex, a, b, (double)part, x, y, z, 0.0, 0.0);
+			}
+		}
+		for (int i = 0; i < columns; i++)
+		{
+			for (int j = 0; j < rows; j++)
+			{
+				GLuint corner = first + (i * (rows + 1)) + j;
+				index[0] = corner;
+				index[1] = corner + rows + 1;
+				index[2] = corner + rows + 2;
+				index[3] = corner + 1;
+				index += ShapeGenerator::PATCH_VERTICES;
+			}
+		}
+		vertexCount += (columns + 1) * (rows + 1);
+	}
+
+	/***********************************************************
+	 *  WriteCap()
+	 *
+	 *  Write the rim of a round cap and the triangles that
+	 *  fan out from its first vertex.  The rim starts on the
+	 *  +x axis and turns toward -z, and the texture is mapped
+	 *  flat across the unit circle.
+	 ***********************************************************/
+	void WriteCap(
+		GLfloat*& vertex,
+		GLuint*& index,
+		GLuint& vertexCount,
+		int segments,
+		double radius,
+		double height,
+		double normalY)
+	{
+		GLuint first = vertexCount;
+		for (int i = 0; i < segments; i++)
+		{
+			double x, z;
+			RimDirection(segments, i, x, z);
+			vertex = WriteVertex(vertex,
+				radius * x, height, radius * z,
+				0.0, normalY, 0.0,
+				0.5 + (0.5 * z), 0.5 + (0.5 * x));
+		}
+		for (int i = 1; i < segments - 1; i++)
+		{
+			index = WriteTriangle(index, first, first + i, first + i + 1);
+		}
+		vertexCount += segments;
+	}
+
+	/***********************************************************
+	 *  WriteSides()
+	 *
+	 *  Write the sides of a cylinder of unit height that may
+	 *  narrow toward the top, as a band of quads.  The band
+	 *  repeats its first column at the end so the texture
+	 *  wraps around once.
+	 ***********************************************************/
+	void WriteSides(
+		GLfloat*& vertex,
+		GLuint*& index,
+		GLuint& vertexCount,
+		int segments,
+		double topRadius)
+	{
+		// the sides lean in by the change in radius over the
+		// unit height
+		double lean = 1.0 - topRadius;
+		double length = sqrt(1.0 + (lean * lean));
+		double normalXZ = 1.0 / length;
+		double normalY = lean / length;
+
+		GLuint first = vertexCount;
+		for (int i = 0; i <= segments; i++)
+		{
+			double x, z;
+			RimDirection(segments, i, x, z);
+			double u = (double)i / segments;
+			vertex = WriteVertex(vertex, x * topRadius, 1.0, z * topRadius, x * normalXZ, normalY, z * normalXZ, u, 1.0);
+			vertex = WriteVertex(vertex, x, 0.0, z, x * normalXZ, normalY, z * normalXZ, u, 0.0);
+		}
+		for (int i = 0; i < segments; i++)
+		{
+			GLuint top = first + (i * 2);
+			GLuint bottom = top + 1;
+			index = WriteTriangle(index, top, bottom, bottom + 2);
+			index = WriteTriangle(index, top, top + 2, bottom + 2);
+		}
+		vertexCount += (segments + 1) * 2;
+	}
+}
+
+///////////////////////////////////////////////////
+//	ValidRoundSegments()
+//
+//	Get the number of segments used around a cone or
+//  cylinder for a requested number.
+///////////////////////////////////////////////////
+int ShapeGenerator::ValidRoundSegments(int segments)
+{
+	return((segments < 3) ? 3 : segments);
+}
+
+///////////////////////////////////////////////////
+//	ValidSphereSlices()
+//
+//	Get the number of slices used around a sphere for
+//  a requested number.  The texture seam is at the
+//  middle slice, so the number must be even.
+///////////////////////////////////////////////////
+int ShapeGenerator::ValidSphereSlices(int slices)
+{
+	if (slices < 4)
+	{
+		return(4);
+	}
+	return(slices + (slices % 2));
+}
+
+///////////////////////////////////////////////////
+//	ValidSphereStacks()
+//
+//	Get the number of stacks used from pole to pole of
+//  a sphere for a requested number.  The half sphere
+//  ends at the equator, so the number must be even.
+///////////////////////////////////////////////////
+int ShapeGenerator::ValidSphereStacks(int stacks)
+{
+	if (stacks < 2)
+	{
+		return(2);
+	}
+	return(stacks + (stacks % 2));
+}
+
+///////////////////////////////////////////////////
+//	ValidTorusSegments()
+//
+//	Get the number of segments used around the main
+//  ring or the tube of a torus for a requested number.
+///////////////////////////////////////////////////
+int ShapeGenerator::ValidTorusSegments(int segments)
+{
+	return((segments < 3) ? 3 : segments);
+}
+
+///////////////////////////////////////////////////
+//	CapIndexCount()
+//
+//	Get the number of indices in the bottom or top of
+//  a cone or cylinder.
+///////////////////////////////////////////////////
+int ShapeGenerator::CapIndexCount(int segments)
+{
+	return((ValidRoundSegments(segments) - 2) * 3);
+}
+
+///////////////////////////////////////////////////
+//	RoundError() / SphereError() / TorusError()
+//
+//	A circle of radius r drawn with n straight segments
+//  is at most r * (1 - cos(pi / n)) inside the circle,
+//  halfway along each segment.  The sphere and torus
+//  are curved in two directions, so the errors of their
+//  two circles are added, which bounds the error in
+//  the middle of each quad.
+///////////////////////////////////////////////////
+float ShapeGenerator::RoundError(int segments)
+{
+	segments = ValidRoundSegments(segments);
+	return((float)(1.0 - cos(g_Pi / segments)));
+}
+
+float ShapeGenerator::SphereError(int slices, int stacks)
+{
+	slices = ValidSphereSlices(slices);
+	stacks = ValidSphereStacks(stacks);
+
+	// the stacks only go half way around, pole to pole
+	return((float)((1.0 - cos(g_Pi / slices)) + (1.0 - cos(g_Pi / (2.0 * stacks)))));
+}
+
+float ShapeGenerator::TorusError(int mainSegments, int tubeSegments, float tubeRadius)
+{
+	mainSegments = ValidTorusSegments(mainSegments);
+	tubeSegments = ValidTorusSegments(tubeSegments);
+
+	// the outside of the tube is furthest from the center
+	double mainError = (1.0 + tubeRadius) * (1.0 - cos(g_Pi / mainSegments));
+	double tubeError = tubeRadius * (1.0 - cos(g_Pi / tubeSegments));
+	return((float)(mainError + tubeError));
+}
+
+///////////////////////////////////////////////////
+//	ShapeBytes() / AllocateShape()
+//
+//	The vertex and index arrays of a shape, taken from
+//  a linear arena one after the other.
+///////////////////////////////////////////////////
+size_t ShapeGenerator::ShapeBytes(SHAPE_SIZE size)
+{
+	return(LinearArena::BytesFor<GLfloat>((size_t)size.vertexCount * FLOATS_PER_VERTEX) +
+		LinearArena::BytesFor<GLuint>(size.indexCount));
+}
+
+bool ShapeGenerator::AllocateShape(
+	LinearArena& arena,
+	SHAPE_SIZE size,
+	GLfloat*& vertices,
+	GLuint*& indices)
+{
+	size_t mark = arena.GetMark();
+	vertices = arena.Allocate<GLfloat>((size_t)size.vertexCount * FLOATS_PER_VERTEX);
+	indices = arena.Allocate<GLuint>(size.indexCount);
+	if ((vertices == NULL) || (indices == NULL))
+	{
+		arena.Rewind(mark);
+		vertices = NULL;
+		indices = NULL;
+		return(false);
+	}
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	BoxData() / BoxSize() / GenerateBox()
+//
+//	A unit box with four vertices and six indices per
+//  face, so each face can be drawn on its own.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_DATA ShapeGenerator::BoxData()
+{
+	return(FixedShapeData(g_Box));
+}
+
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::BoxSize()
+{
+	return(BoxData().size);
+}
+
+void ShapeGenerator::GenerateBox(GLfloat* vertices, GLuint* indices)
+{
+	memcpy(vertices, g_Box.vertices, sizeof(g_Box.vertices));
+	memcpy(indices, g_Box.indices, sizeof(g_Box.indices));
+}
+
+///////////////////////////////////////////////////
+//	PlaneData() / PlaneSize() / GeneratePlane()
+//
+//	A 2x2 plane facing up.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_DATA ShapeGenerator::PlaneData()
+{
+	return(FixedShapeData(g_Plane));
+}
+
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::PlaneSize()
+{
+	return(PlaneData().size);
+}
+
+void ShapeGenerator::GeneratePlane(GLfloat* vertices, GLuint* indices)
+{
+	memcpy(vertices, g_Plane.vertices, sizeof(g_Plane.vertices));
+	memcpy(indices, g_Plane.indices, sizeof(g_Plane.indices));
+}
+
+///////////////////////////////////////////////////
+//	PrismData() / PrismSize() / GeneratePrism()
+//
+//	A triangular prism.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_DATA ShapeGenerator::PrismData()
+{
+	return(FixedShapeData(g_Prism));
+}
+
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::PrismSize()
+{
+	return(PrismData().size);
+}
+
+void ShapeGenerator::GeneratePrism(GLfloat* vertices, GLuint* indices)
+{
+	memcpy(vertices, g_Prism.vertices, sizeof(g_Prism.vertices));
+	memcpy(indices, g_Prism.indices, sizeof(g_Prism.indices));
+}
+
+///////////////////////////////////////////////////
+//	Pyramid3Data() / Pyramid3Size() / GeneratePyramid3()
+//
+//	A 3-sided pyramid.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_DATA ShapeGenerator::Pyramid3Data()
+{
+	return(FixedShapeData(g_Pyramid3));
+}
+
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::Pyramid3Size()
+{
+	return(Pyramid3Data().size);
+}
+
+void ShapeGenerator::GeneratePyramid3(GLfloat* vertices, GLuint* indices)
+{
+	memcpy(vertices, g_Pyramid3.vertices, sizeof(g_Pyramid3.vertices));
+	memcpy(indices, g_Pyramid3.indices, sizeof(g_Pyramid3.indices));
+}
+
+///////////////////////////////////////////////////
+//	Pyramid4Data() / Pyramid4Size() / GeneratePyramid4()
+//
+//	A 4-sided pyramid.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_DATA ShapeGenerator::Pyramid4Data()
+{
+	return(FixedShapeData(g_Pyramid4));
+}
+
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::Pyramid4Size()
+{
+	return(Pyramid4Data().size);
+}
+
+void ShapeGenerator::GeneratePyramid4(GLfloat* vertices, GLuint* indices)
+{
+	memcpy(vertices, g_Pyramid4.vertices, sizeof(g_Pyramid4.vertices));
+	memcpy(indices, g_Pyramid4.indices, sizeof(g_Pyramid4.indices));
+}
+
+///////////////////////////////////////////////////
+//	ConeSize() / GenerateCone()
+//
+//	A cone of radius 1 and height 1 standing on the
+//  origin.  The bottom comes first, then one triangle
+//  per segment from the rim up to the tip.  Each
+//  segment has its own tip vertex, whose normal
+//  points out through the middle of the segment.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::ConeSize(int segments)
+{
+	segments = ValidRoundSegments(segments);
+
+	SHAPE_SIZE size;
+	size.vertexCount = segments * 3;
+	size.indexCount = CapIndexCount(segments) + (segments * 3);
+	return(size);
+}
+
+void ShapeGenerator::GenerateCone(int segments, GLfloat* vertices, GLuint* indices)
+{
+	segments = ValidRoundSegments(segments);
+
+	GLfloat* vertex = vertices;
+	GLuint* index = indices;
+	GLuint vertexCount = 0;
+	WriteCap(vertex, index, vertexCount, segments, 1.0, 0.0, -1.0);
+
+	// the sides lean in by 45 degrees, so their normals
+	// point halfway up
+	double slope = 1.0 / sqrt(2.0);
+	GLuint rim = vertexCount;
+	GLuint tip = rim + segments;
+	for (int i = 0; i < segments; i++)
+	{
+		double x, z;
+		RimDirection(segments, i, x, z);
+		vertex = WriteVertex(vertex,
+			x, 0.0, z,
+			x * slope, slope, z * slope,
+			0.5 + (0.5 * x), 0.5 - (0.5 * z));
+	}
+	for (int i = 0; i < segments; i++)
+	{
+		double tipAngle = (2.0 * g_Pi * (i + 0.5)) / segments;
+		vertex = WriteVertex(vertex,
+			0.0, 1.0, 0.0,
+			cos(tipAngle) * slope, slope, -sin(tipAngle) * slope,
+			0.5, 0.5);
+		index = WriteTriangle(index, rim + i, tip + i, rim + ((i + 1) % segments));
+	}
+}
+
+///////////////////////////////////////////////////
+//	CylinderSize() / GenerateCylinder()
+//
+//	A cylinder of radius 1 and height 1 standing on the
+//  origin.  The bottom comes first, then the top, then
+//  the sides, which wrap the texture once around.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::CylinderSize(int segments)
+{
+	segments = ValidRoundSegments(segments);
+
+	SHAPE_SIZE size;
+	size.vertexCount = (segments * 4) + 2;
+	size.indexCount = (CapIndexCount(segments) * 2) + (segments * 6);
+	return(size);
+}
+
+void ShapeGenerator::GenerateCylinder(int segments, GLfloat* vertices, GLuint* indices)
+{
+	GenerateTaperedCylinder(segments, 1.0f, vertices, indices);
+}
+
+///////////////////////////////////////////////////
+//	TaperedCylinderSize() / GenerateTaperedCylinder()
+//
+//	A cylinder of height 1 standing on the origin that
+//  narrows from radius 1 at the bottom to topRadius at
+//  the top, laid out like the cylinder.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::TaperedCylinderSize(int segments)
+{
+	return(CylinderSize(segments));
+}
+
+void ShapeGenerator::GenerateTaperedCylinder(int segments, float topRadius, GLfloat* vertices, GLuint* indices)
+{
+	segments = ValidRoundSegments(segments);
+
+	GLfloat* vertex = vertices;
+	GLuint* index = indices;
+	GLuint vertexCount = 0;
+	WriteCap(vertex, index, vertexCount, segments, 1.0, 0.0, -1.0);
+	WriteCap(vertex, index, vertexCount, segments, topRadius, 1.0, 1.0);
+	WriteSides(vertex, index, vertexCount, segments, topRadius);
+}
+
+///////////////////////////////////////////////////
+//	SphereSize() / GenerateSphere()
+//
+//	A unit sphere made of a vertex at each pole and
+//  stacks - 1 rings between them.  Each ring starts on
+//  the +z axis and has slices + 1 vertices, the extra
+//  one closing the texture seam on the -z side.  The
+//  texture is wrapped around each ring in proportion
+//  to the ring's radius, so it is not stretched near
+//  the poles.
+//
+//  The indices run from the top pole down, ring by
+//  ring, so the first half of them draws the top half
+//  of the sphere.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::SphereSize(int slices, int stacks)
+{
+	slices = ValidSphereSlices(slices);
+	stacks = ValidSphereStacks(stacks);
+
+	SHAPE_SIZE size;
+	size.vertexCount = ((stacks - 1) * (slices + 1)) + 2;
+	size.indexCount = 6 * slices * (stacks - 1);
+	return(size);
+}
+
+void ShapeGenerator::GenerateSphere(int slices, int stacks, GLfloat* vertices, GLuint* indices)
+{
+	slices = ValidSphereSlices(slices);
+	stacks = ValidSphereStacks(stacks);
+	int halfSlices = slices / 2;
+	int ringVertices = slices + 1;
+	GLuint bottomPole = (GLuint)((stacks - 1) * ringVertices) + 1;
+
+	GLfloat* vertex = WriteVertex(vertices, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.5, 1.0);
+	for (int ring = 1; ring < stacks; ring++)
+	{
+		double polarAngle = (g_Pi * ring) / stacks;
+		double radius = sin(polarAngle);
+		double y = cos(polarAngle);
+		double v = 1.0 - ((double)ring / stacks);
+
+		// slices 0 to halfSlices run from +z through +x to -z,
+		// the seam vertex repeats the -z one with the texture
+		// wrapped to the other side, then the rest come back
+		// through -x
+		for (int i = 0; i < ringVertices; i++)
+		{
+			int slice = (i <= halfSlices) ? i : i - 1;
+			double angle = (2.0 * g_Pi * slice) / slices;
+			double x = radius * sin(angle);
+			double z = radius * cos(angle);
+			double u = (i <= halfSlices) ?
+				0.5 + ((radius * slice) / slices) :
+				0.5 + ((radius * (slice - slices)) / slices);
+			vertex = WriteVertex(vertex, x, y, z, x, y, z, u, v);
+		}
+	}
+	WriteVertex(vertex, 0.0, -1.0, 0.0, 0.0, -1.0, 0.0, 0.5, 0.0);
+
+	// every ring is walked from the seam vertex around to
+	// the slice before it, skipping the step across the
+	// seam, whose two vertices are in the same place
+	GLuint* index = indices;
+	for (int band = 0; band <= stacks - 1; band++)
+	{
+		int upper = ((band - 1) * ringVertices) + 1;
+		int lower = upper + ringVertices;
+		for (int step = 0; step < slices; step++)
+		{
+			int i = (halfSlices + 1 + step) % ringVertices;
+			int next = (i + 1) % ringVertices;
+
+			if (band == 0)
+			{
+				// top cap
+				index = WriteTriangle(index, 0, lower + i, lower + next);
+			}
+			else if (band == stacks - 1)
+			{
+				// bottom cap
+				index = WriteTriangle(index, upper + i, bottomPole, upper + next);
+			}
+			else
+			{
+				index = WriteTriangle(index, upper + i, lower + i, lower + next);
+				index = WriteTriangle(index, upper + i, upper + next, lower + next);
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////
+//	TorusSize() / GenerateTorus()
+//
+//	A torus around the z axis with a main radius of 1,
+//  as a grid of mainSegments by tubeSegments vertices
+//  that wraps around in both directions.  The normals
+//  are the area weighted normals of the grid, which
+//  point out of the tube on its inner side as well.
+//
+//  The indices run around the main ring, so the first
+//  half of them draws half of the torus when the number
+//  of main segments is even.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::TorusSize(int mainSegments, int tubeSegments)
+{
+	mainSegments = ValidTorusSegments(mainSegments);
+	tubeSegments = ValidTorusSegments(tubeSegments);
+
+	SHAPE_SIZE size;
+	size.vertexCount = mainSegments * tubeSegments;
+	size.indexCount = mainSegments * tubeSegments * 6;
+	return(size);
+}
+
+void ShapeGenerator::GenerateTorus(int mainSegments, int tubeSegments, float tubeRadius, GLfloat* vertices, GLuint* indices)
+{
+	mainSegments = ValidTorusSegments(mainSegments);
+	tubeSegments = ValidTorusSegments(tubeSegments);
+
+	float mainRadius = 1.0f;
+	auto mainSegmentAngleStep = glm::radians(360.0f / float(mainSegments));
+	auto tubeSegmentAngleStep = glm::radians(360.0f / float(tubeSegments));
+	float horizontalStep = 1.0 / mainSegments;
+	float verticalStep = 1.0 / tubeSegments;
+
+	GLfloat* vertex = vertices;
+	auto currentMainSegmentAngle = 0.0f;
+	float u = 0.0;
+	for (int i = 0; i < mainSegments; i++)
+	{
+		// Calculate sine and cosine of main segment angle
+		auto sinMainSegment = sin(currentMainSegmentAngle);
+		auto cosMainSegment = cos(currentMainSegmentAngle);
+		auto currentTubeSegmentAngle = 0.0f;
+		float v = 0.0;
+		for (int j = 0; j < tubeSegments; j++)
+		{
+			// Calculate sine and cosine of tube segment angle
+			auto sinTubeSegment = sin(currentTubeSegmentAngle);
+			auto cosTubeSegment = cos(currentTubeSegmentAngle);
+
+			// Calculate vertex position on the surface of torus
+			glm::vec3 position(
+				(mainRadius + tubeRadius * cosTubeSegment) * cosMainSegment,
+				(mainRadius + tubeRadius * cosTubeSegment) * sinMainSegment,
+				tubeRadius * sinTubeSegment);
+			vertex[0] = position.x;
+			vertex[1] = position.y;
+			vertex[2] = position.z;
+			vertex[6] = u;
+			vertex[7] = v;
+			vertex += FLOATS_PER_VERTEX;
+
+			// Update current tube angle
+			currentTubeSegmentAngle += tubeSegmentAngleStep;
+			v += verticalStep;
+		}
+
+		// Update main segment angle
+		currentMainSegmentAngle += mainSegmentAngleStep;
+		u += horizontalStep;
+	}
+
+	// two triangles for each quad of the grid, the last
+	// row and column joining back to the first.  Both wind
+	// counterclockwise seen from outside the tube, so their
+	// normals add up
+	GLuint* index = indices;
+	for (int i = 0; i < mainSegments; i++)
+	{
+		GLuint row = i * tubeSegments;
+		GLuint nextRow = ((i + 1) % mainSegments) * tubeSegments;
+		for (int j = 0; j < tubeSegments; j++)
+		{
+			GLuint next = (j + 1) % tubeSegments;
+			index = WriteTriangle(index, row + j, nextRow + next, row + next);
+			index = WriteTriangle(index, row + j, nextRow + j, nextRow + next);
+		}
+	}
+
+	// on one thread, the normals are computed without
+	// allocating anything
+	NormalGenerator::GenerateNormals(
+		vertices,
+		mainSegments * tubeSegments,
+		FLOATS_PER_VERTEX,
+		indices,
+		mainSegments * tubeSegments * 6,
+		1);
+}
+
+///////////////////////////////////////////////////
+//	SpherePatchesSize() / GenerateSpherePatches()
+//
+//	The unit sphere as rings of patches from the top
+//  pole down.  The first surface coord runs from the
+//  top pole to the bottom one, and the second around
+//  from -z through +x and +z, the seam of the texture,
+//  and back to -z, from -0.5 to 0.5.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::SpherePatchesSize()
+{
+	SHAPE_SIZE size;
+	size.vertexCount = (PATCH_RINGS + 1) * (PATCH_SEGMENTS + 1);
+	size.indexCount = PATCH_RINGS * PATCH_SEGMENTS * PATCH_VERTICES;
+	return(size);
+}
+
+void ShapeGenerator::GenerateSpherePatches(GLfloat* vertices, GLuint* indices)
+{
+	GLfloat* vertex = vertices;
+	GLuint* index = indices;
+	GLuint vertexCount = 0;
+	WritePatchGrid(vertex, index, vertexCount, PATCH_RINGS, PATCH_SEGMENTS, 0.0, 1.0, -0.5, 0.5, sidePatch,
+		[&](int i, int j, double& x, double& y, double& z) {
+			double polarAngle = (g_Pi * i) / PATCH_RINGS;
+			// both ends of the grid are the -z side, at the same angle
+			double angle = (2.0 * g_Pi * ((j + (PATCH_SEGMENTS / 2)) % PATCH_SEGMENTS)) / PATCH_SEGMENTS;
+			x = sin(polarAngle) * sin(angle);
+			y = cos(polarAngle);
+			z = sin(polarAngle) * cos(angle);
+		});
+}
+
+///////////////////////////////////////////////////
+//	CylinderPatchesSize() / GenerateCylinderPatches()
+//
+//	The cylinder of height 1 narrowing to topRadius,
+//  as a ring of patches for the bottom, one for the top
+//  and one for the sides.  The first surface coord runs
+//  around from +x toward -z, and the second out from the
+//  middle of a cap or up the sides.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::CylinderPatchesSize()
+{
+	SHAPE_SIZE size;
+	size.vertexCount = 3 * (PATCH_SEGMENTS + 1) * 2;
+	size.indexCount = 3 * CapPatchIndexCount();
+	return(size);
+}
+
+int ShapeGenerator::CapPatchIndexCount()
+{
+	return(PATCH_SEGMENTS * PATCH_VERTICES);
+}
+
+void ShapeGenerator::GenerateCylinderPatches(float topRadius, GLfloat* vertices, GLuint* indices)
+{
+	GLfloat* vertex = vertices;
+	GLuint* index = indices;
+	GLuint vertexCount = 0;
+	WritePatchGrid(vertex, index, vertexCount, PATCH_SEGMENTS, 1, 0.0, 1.0, 0.0, 1.0, bottomPatch,
+		[&](int i, int j, double& x, double& y, double& z) {
+			RimDirection(PATCH_SEGMENTS, i, x, z);
+			x *= j;
+			y = 0.0;
+			z *= j;
+		});
+	WritePatchGrid(vertex, index, vertexCount, PATCH_SEGMENTS, 1, 0.0, 1.0, 0.0, 1.0, topPatch,
+		[&](int i, int j, double& x, double& y, double& z) {
+			RimDirection(PATCH_SEGMENTS, i, x, z);
+			x *= topRadius * j;
+			y = 1.0;
+			z *= topRadius * j;
+		});
+	WritePatchGrid(vertex, index, vertexCount, PATCH_SEGMENTS, 1, 0.0, 1.0, 0.0, 1.0, sidePatch,
+		[&](int i, int j, double& x, double& y, double& z) {
+			RimDirection(PATCH_SEGMENTS, i, x, z);
+			double radius = (j == 0) ? 1.0 : topRadius;
+			x *= radius;
+			y = j;
+			z *= radius;
+		});
+}
+
+///////////////////////////////////////////////////
+//	TorusPatchesSize() / GenerateTorusPatches()
+//
+//	The torus around the z axis with a main radius of 1
+//  as a grid of patches.  The first surface coord runs
+//  around the main ring from +x toward +y, and the
+//  second around the tube from its outside toward +z.
+///////////////////////////////////////////////////
+ShapeGenerator::SHAPE_SIZE ShapeGenerator::TorusPatchesSize()
+{
+	SHAPE_SIZE size;
+	size.vertexCount = (PATCH_SEGMENTS + 1) * (PATCH_RINGS + 1);
+	size.indexCount = PATCH_SEGMENTS * PATCH_RINGS * PATCH_VERTICES;
+	return(size);
+}
+
+void ShapeGenerator::GenerateTorusPatches(float tubeRadius, GLfloat* vertices, GLuint* indices)
+{
+	GLfloat* vertex = vertices;
+	GLuint* index = indices;
+	GLuint vertexCount = 0;
+	WritePatchGrid(vertex, index, vertexCount, PATCH_SEGMENTS, PATCH_RINGS, 0.0, 1.0, 0.0, 1.0, sidePatch,
+		[&](int i, int j, double& x, double& y, double& z) {
+			double mainAngle = (2.0 * g_Pi * (i % PATCH_SEGMENTS)) / PATCH_SEGMENTS;
+			double tubeAngle = (2.0 * g_Pi * (j % PATCH_RINGS)) / PATCH_RINGS;
+			double radius = 1.0 + (tubeRadius * cos(tubeAngle));
+			x = radius * cos(mainAngle);
+			y = radius * sin(mainAngle);
+			z = tubeRadius * sin(tubeAngle);
+		});
+}
+
+///////////////////////////////////////////////////
+//	BoxPrimitive() ... TorusPrimitive()
+//
+//	The type and tessellation of a shape drawn with no
+//  vertex data.  The tessellation is made valid here,
+//  so the vertex shader can use it as it is.
+///////////////////////////////////////////////////
+ShapeGenerator::PRIMITIVE ShapeGenerator::BoxPrimitive()
+{
+	PRIMITIVE primitive = { boxPrimitive, 0, 0, 0.0f };
+	return(primitive);
+}
+
+ShapeGenerator::PRIMITIVE ShapeGenerator::PlanePrimitive()
+{
+	PRIMITIVE primitive = { planePrimitive, 0, 0, 0.0f };
+	return(primitive);
+}
+
+ShapeGenerator::PRIMITIVE ShapeGenerator::SpherePrimitive(int slices, int stacks)
+{
+	PRIMITIVE primitive = { spherePrimitive, ValidSphereSlices(slices), ValidSphereStacks(stacks), 0.0f };
+	return(primitive);
+}
+
+ShapeGenerator::PRIMITIVE ShapeGenerator::CylinderPrimitive(int segments, float topRadius)
+{
+	PRIMITIVE primitive = { cylinderPrimitive, ValidRoundSegments(segments), 0, topRadius };
+	return(primitive);
+}
+
+ShapeGenerator::PRIMITIVE ShapeGenerator::ConePrimitive(int segments)
+{
+	PRIMITIVE primitive = { conePrimitive, ValidRoundSegments(segments), 0, 0.0f };
+	return(primitive);
+}
+
+ShapeGenerator::PRIMITIVE ShapeGenerator::TorusPrimitive(int mainSegments, int tubeSegments, float tubeRadius)
+{
+	PRIMITIVE primitive = { torusPrimitive, ValidTorusSegments(mainSegments), ValidTorusSegments(tubeSegments), tubeRadius };
+	return(primitive);
+}
+
+///////////////////////////////////////////////////
+//	PrimitiveVertexCount()
+//
+//	The number of vertices the vertex shader makes for a
+//  shape - the number of indices of its mesh, as every
+//  corner of every triangle is a vertex of its own.
+///////////////////////////////////////////////////
+int ShapeGenerator::PrimitiveVertexCount(const PRIMITIVE& primitive)
+{
+	switch (primitive.type)
+	{
+	case boxPrimitive: return(BOX_INDEX_COUNT);
+	case planePrimitive: return(PlaneSize().indexCount);
+	case spherePrimitive: return(SphereSize(primitive.segmentsA, primitive.segmentsB).indexCount);
+	case cylinderPrimitive: return(CylinderSize(primitive.segmentsA).indexCount);
+	case conePrimitive: return(ConeSize(primitive.segmentsA).indexCount);
+	case torusPrimitive: return(TorusSize(primitive.segmentsA, primitive.segmentsB).indexCount);
+	}
+	return(0);
+}
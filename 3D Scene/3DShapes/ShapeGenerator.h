@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapegenerator.h
+// ============
+// generate the vertex and index data of the 3D primitives at any
+// tessellation:
+//     box, cone, cylinder, plane, prism, pyramid, sphere, tapered cylinder, torus
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "LinearArena.h"
+
+/***********************************************************
+ *  ShapeGenerator
+ *
+ *  This class writes the interleaved position, normal and
+ *  texture coordinate data of the basic 3D shapes into
+ *  storage owned by the caller.  Each shape has a size
+ *  function, which tells how many vertices and indices the
+ *  shape needs for the passed in tessellation, and a
+ *  generate function, which fills arrays of that size.
+ *  Nothing is allocated and no OpenGL calls are made, so
+ *  the data can be written anywhere and at any time - the
+ *  arrays can also be taken from a linear arena over a
+ *  reused buffer or a mapped GPU buffer.
+ *
+ *  Every shape is an indexed triangle list in which each
+ *  vertex is written once and shared by all of the
+ *  triangles around it.
+ ***********************************************************/
+class ShapeGenerator
+{
+public:
+	// floats in one vertex - position, normal, texture coords
+	static const int FLOATS_PER_VERTEX = 8;
+
+	// default tessellations
+	static const int DEFAULT_ROUND_SEGMENTS = 36;		// cone, cylinders
+	static const int DEFAULT_SPHERE_SLICES = 16;
+	static const int DEFAULT_SPHERE_STACKS = 16;
+	static const int DEFAULT_TORUS_MAIN_SEGMENTS = 30;
+	static const int DEFAULT_TORUS_TUBE_SEGMENTS = 30;
+
+	// the top of the tapered cylinder is half as wide as the bottom
+	static constexpr float DEFAULT_TAPERED_TOP_RADIUS = 0.5f;
+
+	// part of the key of every mesh the mesh cache stores.  Bump it
+	// whenever a generate function changes what it writes for the
+	// same parameters, and whenever the mesh optimizer or meshlet
+	// builder change what they make of it - otherwise meshes saved
+	// by an older build are loaded in place of the new ones
+	static const int GENERATOR_VERSION = 2;
+
+	// the numbers of vertices and indices written for a shape
+	struct SHAPE_SIZE
+	{
+		int vertexCount;
+		int indexCount;
+	};
+
+	// the vertices and indices of a shape with a fixed layout
+	struct SHAPE_DATA
+	{
+		const GLfloat* vertices;
+		const GLuint* indices;
+		SHAPE_SIZE size;
+	};
+
+	// the bytes the arrays of a shape of the passed in size take
+	// in a linear arena
+	static size_t ShapeBytes(SHAPE_SIZE size);
+	// take the arrays for a shape of the passed in size from a
+	// linear arena, for a generate function to fill - returns
+	// false, taking nothing, if they do not fit
+	static bool AllocateShape(
+		LinearArena& arena,
+		SHAPE_SIZE size,
+		GLfloat*& vertices,
+		GLuint*& indices);
+
+	// shapes with a fixed layout - the box has six indices per
+	// face in the order back, bottom, left, right, top, front,
+	// then the same faces again split as fans, which its sides
+	// are drawn from alone.
+	// These are built while compiling, so the data functions just
+	// point at read only constants, which can be uploaded as they
+	// are, and the generate functions copy them.
+	static SHAPE_DATA BoxData();
+	static SHAPE_DATA PlaneData();
+	static SHAPE_DATA PrismData();
+	static SHAPE_DATA Pyramid3Data();
+	static SHAPE_DATA Pyramid4Data();
+	static SHAPE_SIZE BoxSize();
+	static void GenerateBox(GLfloat* vertices, GLuint* indices);
+	static SHAPE_SIZE PlaneSize();
+	static void GeneratePlane(GLfloat* vertices, GLuint* indices);
+	static SHAPE_SIZE PrismSize();
+	static void GeneratePrism(GLfloat* vertices, GLuint* indices);
+	static SHAPE_SIZE Pyramid3Size();
+	static void GeneratePyramid3(GLfloat* vertices, GLuint* indices);
+	static SHAPE_SIZE Pyramid4Size();
+	static void GeneratePyramid4(GLfloat* vertices, GLuint* indices);
+	static const int BOX_INDEX_COUNT = 36;			// the whole box
+	static const int BOX_SIDE_FIRST_INDEX = 36;		// the side fans
+
+	// round shapes - the indices of the bottom come first, then
+	// those of the top (if any), each CapIndexCount() long, then
+	// those of the sides
+	static SHAPE_SIZE ConeSize(int segments);
+	static void GenerateCone(int segments, GLfloat* vertices, GLuint* indices);
+	static SHAPE_SIZE CylinderSize(int segments);
+	static void GenerateCylinder(int segments, GLfloat* vertices, GLuint* indices);
+	static SHAPE_SIZE TaperedCylinderSize(int segments);
+	static void GenerateTaperedCylinder(int segments, float topRadius, GLfloat* vertices, GLuint* indices);
+	static int CapIndexCount(int segments);
+
+	// sphere - the first half of the indices is the top half
+	static SHAPE_SIZE SphereSize(int slices, int stacks);
+	static void GenerateSphere(int slices, int stacks, GLfloat* vertices, GLuint* indices);
+
+	// torus - the indices run around the main ring, so the
+	// first half of them is the half torus
+	static SHAPE_SIZE TorusSize(int mainSegments, int tubeSegments);
+	static void GenerateTorus(int mainSegments, int tubeSegments, float tubeRadius, GLfloat* vertices, GLuint* indices);
+
+	// coarse patches of four corners over the sphere, cylinders
+	// and torus, for the tessellation shaders to refine.  Each
+	// vertex holds its surface coords and the part of the shape
+	// it is on in its position, and its point on the surface in
+	// its normal.  The patches come in the order of the meshes'
+	// triangles, so the same shares of the indices draw the half
+	// sphere, the caps and the half torus
+	enum PatchPart
+	{
+		sidePatch,
+		bottomPatch,
+		topPatch
+	};
+	static const int PATCH_VERTICES = 4;
+	static const int PATCH_SEGMENTS = 8;		// around each shape
+	static const int PATCH_RINGS = 4;			// sphere stacks, torus tube segments
+	static SHAPE_SIZE SpherePatchesSize();
+	static void GenerateSpherePatches(GLfloat* vertices, GLuint* indices);
+	static SHAPE_SIZE CylinderPatchesSize();
+	static void GenerateCylinderPatches(float topRadius, GLfloat* vertices, GLuint* indices);
+	static int CapPatchIndexCount();
+	static SHAPE_SIZE TorusPatchesSize();
+	static void GenerateTorusPatches(float tubeRadius, GLfloat* vertices, GLuint* indices);
+
+	// the analytic shapes a vertex shader can make with no vertex
+	// data at all, from a type and a tessellation - see
+	// bufferlessVertexShader.glsl.  Each vertex is one corner of a
+	// triangle, in the order of the shape's indices, so the same
+	// ranges of vertices draw the caps, sides and halves
+	enum PrimitiveType
+	{
+		noPrimitive = -1,
+		boxPrimitive,
+		planePrimitive,
+		spherePrimitive,
+		cylinderPrimitive,		// the tapered cylinder too
+		conePrimitive,
+		torusPrimitive
+	};
+	struct PRIMITIVE
+	{
+		GLint type;
+		GLint segmentsA;		// around a round shape or the torus ring
+		GLint segmentsB;		// sphere stacks, torus tube segments
+		GLfloat parameter;		// cylinder top radius, torus tube radius
+	};
+	static PRIMITIVE BoxPrimitive();
+	static PRIMITIVE PlanePrimitive();
+	static PRIMITIVE SpherePrimitive(int slices, int stacks);
+	static PRIMITIVE CylinderPrimitive(int segments, float topRadius);
+	static PRIMITIVE ConePrimitive(int segments);
+	static PRIMITIVE TorusPrimitive(int mainSegments, int tubeSegments, float tubeRadius);
+	static int PrimitiveVertexCount(const PRIMITIVE& primitive);
+
+	// the tessellation actually used for a requested one
+	static int ValidRoundSegments(int segments);
+	static int ValidSphereSlices(int slices);
+	static int ValidSphereStacks(int stacks);
+	static int ValidTorusSegments(int segments);
+
+	// the largest distance of a round shape's surface from the
+	// true curved surface it stands for, at the shape's unit size
+	static float RoundError(int segments);		// cone, cylinders
+	static float SphereError(int slices, int stacks);
+	static float TorusError(int mainSegments, int tubeSegments, float tubeRadius);
+};
@@ -9,2324 +9,2262 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "shapemeshes.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "VertexQuantizer.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cstring>
 #include <vector>
 
 namespace
 {
-	const double M_PI = 3.14159265358979323846f;
-	const double M_PI_2 = 1.571428571428571;
 	const GLuint g_FloatsPerVertex = 3;	// Number of coordinates per vertex
 	const GLuint g_FloatsPerNormal = 3;	// Number of values per vertex color
 	const GLuint g_FloatsPerUV = 2;		// Number of texture coordinate values
+
+	// meshes with up to this many vertices use 16-bit indices
+	const GLuint g_MaxShortIndexVertices = 65536;
+
+	// starting sizes of the buffers of a mesh arena, which double
+	// whenever they are full - enough for the scene's meshes
+	const GLuint g_InitialArenaVertices = 4096;
+	const GLuint g_InitialArenaIndexBytes = 32768;
+
+	// the vertex attribute the shader reads the decode factors of
+	// a mesh from - it has no array, so it takes the value set for
+	// the draw
+	const GLuint g_VertexDecodeAttribute = 3;
+
+	// the fewest segments the simplified levels of the round
+	// meshes are made with
+	const int g_MinLodRoundSegments = 6;
+	const int g_MinLodSphereSegments = 4;
+	const int g_MinLodTorusSegments = 4;
+
+	const float g_TaperedTopRadius = ShapeGenerator::DEFAULT_TAPERED_TOP_RADIUS;
+
+	// the surfaces the tessellation evaluation shader puts the
+	// patches on, matching its SURFACE_ values
+	const int g_SphereSurface = 0;
+	const int g_CylinderSurface = 1;
+	const int g_TorusSurface = 2;
+
+	// the binding of the records of a draw of several bufferless
+	// shapes, matching the vertex shader
+	const GLuint g_PrimitiveRecordBinding = 0;
+
+	/***********************************************************
+	 *  LodSegments()
+	 *
+	 *  Get the segments of the next simplified level of a
+	 *  round mesh - half as many, but no fewer than the
+	 *  minimum, and even when the mesh is drawn in halves.
+	 ***********************************************************/
+	int LodSegments(int segments, int minSegments, bool bEven)
+	{
+		int next = (segments + 1) / 2;
+		if ((bEven == true) && ((next % 2) != 0))
+		{
+			next++;
+		}
+		return((next < minSegments) ? std::min(segments, minSegments) : next);
+	}
+}
+
+ShapeMeshes::ShapeMeshes()
+{
+	m_bOptimizeMeshes = true;
+	m_vertexFormat = floatVertices;
+	m_scratchGrowths = 0;
+	m_bBatchingDraws = false;
+	m_indirectBuffer = 0;
+	m_lodPixelsPerUnit = 0.0f;
+	m_lodErrorBudget = 0.0f;
+	m_lodStats = LOD_STATS();
+	m_bCountingStats = true;
+	m_bCountingFullDetail = false;
+	m_bDrawingReducedLod = false;
+	m_bClusterCulling = false;
+	m_bClusterViewSet = false;
+	m_bClusterOrthographic = false;
+	m_clusterCamera = glm::vec3(0.0f);
+	m_clusterStats = CLUSTER_STATS();
+	m_bDrawingClosedSurface = false;
+	m_torusTubeRadius = 0.0f;
+	m_tessellationProgram = 0;
+	m_mainProgram = 0;
+	m_surfaceShapeLocation = -1;
+	m_surfaceRadiusLocation = -1;
+	m_viewportHeightLocation = -1;
+	m_edgePixelsLocation = -1;
+
+	ShapeGenerator::PRIMITIVE none = { ShapeGenerator::noPrimitive, 0, 0, 0.0f };
+	m_BoxPrimitive = none;
+	m_ConePrimitive = none;
+	m_CylinderPrimitive = none;
+	m_PlanePrimitive = none;
+	m_SpherePrimitive = none;
+	m_TaperedCylinderPrimitive = none;
+	m_TorusPrimitive = none;
+	m_bufferlessProgram = 0;
+	m_primitiveVao = 0;
+	m_primitiveBuffer = 0;
+	m_primitiveCountLocation = -1;
+	m_primitiveShapeLocation = -1;
+	m_primitiveParameterLocation = -1;
+	m_bCapturingMeshes = false;
+	m_bCaptureIncomplete = false;
+}
+
+ShapeMeshes::~ShapeMeshes()
+{
+	DestroyMeshes();
+}
+
+///////////////////////////////////////////////////
+//	StoreMesh()
+//
+//	Upload a newly loaded mesh and store it in the slot
+//  map.  If the same shape was loaded before, its
+//  arena space is freed first, for the new mesh to
+//  reuse, and its old handle becomes stale.
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::StoreMesh(
+	MeshHandle previous,
+	GLMesh& mesh,
+	const GLfloat* vertices,
+	const GLuint* indices,
+	uint64_t cacheKey)
+{
+	FreeMesh(previous);
+
+	UploadMesh(mesh, vertices, indices, cacheKey);
+	return(m_meshes.Insert(mesh));
+}
+
+///////////////////////////////////////////////////
+//	UseMeshCache()
+//
+//	Map the cache file the round meshes are loaded
+//  from.  A missing or outdated file is made again
+//  from the meshes generated while it is in use, once
+//  SaveMeshCache() is called.
+///////////////////////////////////////////////////
+bool ShapeMeshes::UseMeshCache(const std::string& filename)
+{
+	return(m_meshCache.Open(filename));
+}
+
+///////////////////////////////////////////////////
+//	SetTessellation()
+//
+//	Set the program the patches of the round shapes
+//  loaded from now on are drawn with, and the main
+//  program to put back after each of their draws.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetTessellation(GLuint tessellationProgram, GLuint mainProgram)
+{
+	m_tessellationProgram = tessellationProgram;
+	m_mainProgram = mainProgram;
+	m_surfaceShapeLocation = -1;
+	m_surfaceRadiusLocation = -1;
+	m_viewportHeightLocation = -1;
+	m_edgePixelsLocation = -1;
+	if (m_tessellationProgram != 0)
+	{
+		m_surfaceShapeLocation = glGetUniformLocation(m_tessellationProgram, "surfaceShape");
+		m_surfaceRadiusLocation = glGetUniformLocation(m_tessellationProgram, "surfaceRadius");
+		m_viewportHeightLocation = glGetUniformLocation(m_tessellationProgram, "viewportHeight");
+		m_edgePixelsLocation = glGetUniformLocation(m_tessellationProgram, "edgePixels");
+	}
+}
+
+///////////////////////////////////////////////////
+//	SetTessellationView()
+//
+//	Set how finely the patches are refined.  Each edge
+//  is split into pieces covering about the passed in
+//  number of pixels of a viewport that high.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetTessellationView(int viewportHeight, float edgePixels)
+{
+	if (m_tessellationProgram == 0)
+	{
+		return;
+	}
+	glProgramUniform1f(m_tessellationProgram, m_viewportHeightLocation, (float)viewportHeight);
+	glProgramUniform1f(m_tessellationProgram, m_edgePixelsLocation, edgePixels);
+}
+
+///////////////////////////////////////////////////
+//	SetBufferless()
+//
+//	Set the program the shapes loaded from now on are
+//  made by, from their type and tessellation, and the
+//  main program to put back after each of their draws.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetBufferless(GLuint bufferlessProgram, GLuint mainProgram)
+{
+	m_bufferlessProgram = bufferlessProgram;
+	m_mainProgram = mainProgram;
+	m_primitiveCountLocation = -1;
+	m_primitiveShapeLocation = -1;
+	m_primitiveParameterLocation = -1;
+	if (m_bufferlessProgram != 0)
+	{
+		m_primitiveCountLocation = glGetUniformLocation(m_bufferlessProgram, "primitiveCount");
+		m_primitiveShapeLocation = glGetUniformLocation(m_bufferlessProgram, "primitiveShape");
+		m_primitiveParameterLocation = glGetUniformLocation(m_bufferlessProgram, "primitiveParameter");
+	}
+}
+
+///////////////////////////////////////////////////
+//	LoadPrimitive()
+//
+//	Keep the type and tessellation of a shape, which
+//  is all the bufferless program needs to draw it.
+///////////////////////////////////////////////////
+bool ShapeMeshes::LoadPrimitive(ShapeGenerator::PRIMITIVE& loaded, const ShapeGenerator::PRIMITIVE& primitive)
+{
+	if (m_bufferlessProgram == 0)
+	{
+		loaded.type = ShapeGenerator::noPrimitive;
+		return(false);
+	}
+	loaded = primitive;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	LoadPatches()
+//
+//	Generate the patches of a round shape and store
+//  them in the float arena, whose attributes the
+//  tessellation program reads them with, in place of
+//  the shape's previous patches.  Patches are never
+//  optimized, clustered or cached - there are only a
+//  few dozen of them.
+///////////////////////////////////////////////////
+template <typename GENERATE>
+ShapeMeshes::MeshHandle ShapeMeshes::LoadPatches(MeshHandle previous, ShapeGenerator::SHAPE_SIZE size, GENERATE generate)
+{
+	FreeMesh(previous);
+
+	GLfloat* verts = NULL;
+	GLuint* indices = NULL;
+	AllocateScratchShape(size, verts, indices);
+	generate(verts, indices);
+
+	GLMesh mesh;
+	mesh.nVertices = size.vertexCount;
+	mesh.nIndices = size.indexCount;
+	mesh.vertexFormat = floatVertices;
+	mesh.vertexSize = VertexSize(floatVertices);
+	mesh.indexType = GL_UNSIGNED_SHORT;
+	std::vector<unsigned char> indexOverflow;
+	GLushort* shortIndices = (GLushort*)PackingMemory(mesh.nIndices * sizeof(GLushort), indexOverflow);
+	std::copy(indices, indices + mesh.nIndices, shortIndices);
+	UploadMeshData(mesh, verts, shortIndices);
+	return(m_meshes.Insert(mesh));
+}
+
+///////////////////////////////////////////////////
+//	MeshCacheKey()
+//
+//	Get the key a round mesh is cached under.  Besides
+//  the shape and its parameters, it holds every
+//  setting and limit that changes the stored data and
+//  the version of the code that makes it, so a mesh
+//  is never loaded from the cache in the wrong form.
+//  Zero is left for meshes that are not cached.
+///////////////////////////////////////////////////
+uint64_t ShapeMeshes::MeshCacheKey(const char* shape, int segments, int rings, float size) const
+{
+	int settings[] = {
+		segments,
+		rings,
+		(int)m_vertexFormat,
+		(m_bOptimizeMeshes == true) ? 1 : 0,
+		(m_bClusterCulling == true) ? 1 : 0,
+		MeshOptimizer::DEFAULT_CACHE_SIZE,
+		MeshletBuilder::DEFAULT_MAX_VERTICES,
+		MeshletBuilder::DEFAULT_MAX_TRIANGLES,
+		ShapeGenerator::GENERATOR_VERSION };
+
+	uint64_t key = MeshCache::HashBytes(shape, strlen(shape));
+	key = MeshCache::HashBytes(settings, sizeof(settings), key);
+	key = MeshCache::HashBytes(&size, sizeof(size), key);
+	return((key != 0) ? key : 1);
+}
+
+///////////////////////////////////////////////////
+//	LoadCachedMesh()
+//
+//	Replace the previous mesh of a level with the one
+//  the cache has under the passed in key, uploaded
+//  straight from the mapped file.  Returns false, and
+//  keeps the previous mesh, if the cache is not in
+//  use or does not have the mesh.
+///////////////////////////////////////////////////
+bool ShapeMeshes::LoadCachedMesh(MeshHandle previous, uint64_t cacheKey, MeshHandle& handle)
+{
+	MeshCache::CACHED_MESH cached;
+	if ((m_meshCache.IsEnabled() == false) || (m_meshCache.Find(cacheKey, cached) == false))
+	{
+		return(false);
+	}
+	// the key holds the vertex format, but the file may come
+	// from a build with other vertex layouts
+	if ((cached.vertexFormat != (uint32_t)m_vertexFormat) ||
+		(cached.vertexSize != VertexSize(m_vertexFormat)) ||
+		((cached.indexSize != sizeof(GLushort)) && (cached.indexSize != sizeof(GLuint))))
+	{
+		return(false);
+	}
+
+	FreeMesh(previous);
+
+	GLMesh mesh;
+	mesh.nVertices = cached.vertexCount;
+	mesh.nIndices = cached.indexCount;
+	mesh.nSegments = cached.segments;
+	mesh.vertexFormat = m_vertexFormat;
+	mesh.vertexSize = cached.vertexSize;
+	mesh.indexType = (cached.indexSize == sizeof(GLushort)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	mesh.vertexDecode = glm::vec4(cached.vertexDecode[0], cached.vertexDecode[1], cached.vertexDecode[2], cached.vertexDecode[3]);
+	mesh.meshlets.assign(cached.meshlets, cached.meshlets + cached.meshletCount);
+
+	UploadMeshData(mesh, cached.vertexData, cached.indexData);
+	handle = m_meshes.Insert(mesh);
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	FreeMeshRanges()
+//
+//	Give the vertices and indices of a mesh back to
+//  its arena, for later meshes to reuse.
+///////////////////////////////////////////////////
+void ShapeMeshes::FreeMeshRanges(const GLMesh& mesh)
+{
+	RetireCaptureSources(&mesh);
+
+	GEOMETRY_ARENA& arena = m_arenas[mesh.vertexFormat];
+	arena.vertices.Free(mesh.firstVertex, mesh.nVertices);
+	arena.indexBytes.Free(mesh.indexOffset, mesh.nIndices * IndexSize(mesh));
+}
+
+///////////////////////////////////////////////////
+//	FreeMesh()
+//
+//	Free a loaded mesh and give its arena space back.
+//  A stale handle frees nothing.
+///////////////////////////////////////////////////
+void ShapeMeshes::FreeMesh(MeshHandle handle)
+{
+	const GLMesh* mesh = m_meshes.Get(handle);
+	if (mesh != NULL)
+	{
+		FreeMeshRanges(*mesh);
+		m_meshes.Remove(handle);
+	}
+}
+
+///////////////////////////////////////////////////
+//	DestroyMeshes()
+//
+//	Free every loaded mesh and the arenas holding
+//  them.  All mesh handles become stale, so drawing
+//  a destroyed shape does nothing.
+///////////////////////////////////////////////////
+void ShapeMeshes::DestroyMeshes()
+{
+	m_meshes.Clear();
+	RetireCaptureSources(NULL);
+
+	for (int format = 0; format < VERTEX_FORMAT_COUNT; format++)
+	{
+		GEOMETRY_ARENA& arena = m_arenas[format];
+		if (arena.vao != 0)
+		{
+			glDeleteVertexArrays(1, &arena.vao);
+			glDeleteBuffers(2, arena.buffers);
+		}
+		arena = GEOMETRY_ARENA();
+	}
+
+	if (m_indirectBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_indirectBuffer);
+		m_indirectBuffer = 0;
+	}
+
+	if (m_primitiveVao != 0)
+	{
+		glDeleteVertexArrays(1, &m_primitiveVao);
+		m_primitiveVao = 0;
+	}
+	if (m_primitiveBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_primitiveBuffer);
+		m_primitiveBuffer = 0;
+	}
+}
+
+///////////////////////////////////////////////////
+//	OptimizeMesh()
+//
+//	Reorder the generated triangles and vertices of a
+//  mesh for the vertex caches and early depth test,
+//  unless mesh optimization is off.  The triangles of
+//  each range of indices starting at rangeStarts stay
+//  in that range, so the range can still be drawn on
+//  its own.  The vertex and index counts must be set
+//  in the mesh first.
+///////////////////////////////////////////////////
+void ShapeMeshes::OptimizeMesh(
+	const GLMesh& mesh,
+	GLfloat* vertices,
+	GLuint* indices,
+	const GLuint* rangeStarts,
+	int rangeCount)
+{
+	if (m_bOptimizeMeshes == false)
+	{
+		return;
+	}
+
+	MeshOptimizer::OptimizeMesh(
+		vertices,
+		mesh.nVertices,
+		ShapeGenerator::FLOATS_PER_VERTEX,
+		indices,
+		mesh.nIndices,
+		rangeStarts,
+		rangeCount);
+}
+
+///////////////////////////////////////////////////
+//	BuildMeshlets()
+//
+//	Group the generated triangles of a mesh into
+//  clusters with bounds for culling, unless cluster
+//  culling is off, when the mesh keeps its order.  The
+//  ranges are the same as for OptimizeMesh(), so each
+//  range is drawn as a run of whole clusters.  The
+//  bounds of packed vertex formats grow by half a step
+//  of their positions, which can move that far.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildMeshlets(
+	GLMesh& mesh,
+	const GLfloat* vertices,
+	GLuint* indices,
+	const GLuint* rangeStarts,
+	int rangeCount)
+{
+	if (m_bClusterCulling == false)
+	{
+		return;
+	}
+
+	MeshletBuilder::BuildMeshlets(
+		vertices,
+		mesh.nVertices,
+		ShapeGenerator::FLOATS_PER_VERTEX,
+		indices,
+		mesh.nIndices,
+		rangeStarts,
+		rangeCount,
+		mesh.meshlets);
+
+	if (m_vertexFormat != floatVertices)
+	{
+		glm::vec3 positionScale = VertexQuantizer::PositionScale(vertices, mesh.nVertices, ShapeGenerator::FLOATS_PER_VERTEX);
+		float margin = glm::length(positionScale) * 0.5f / VertexQuantizer::POSITION_MAX;
+		for (MeshletBuilder::MESHLET& meshlet : mesh.meshlets)
+		{
+			meshlet.radius += margin;
+		}
+	}
+}
+
+///////////////////////////////////////////////////
+//	CreateArena()
+//
+//	Create the VAO and the empty vertex and index
+//  buffers of an arena, with the attribute layout of
+//  its vertex format.
+///////////////////////////////////////////////////
+void ShapeMeshes::CreateArena(GEOMETRY_ARENA& arena, VertexFormat format)
+{
+	glGenVertexArrays(1, &arena.vao);
+	glGenBuffers(2, arena.buffers);
+
+	glBindVertexArray(arena.vao);
+	glBindBuffer(GL_ARRAY_BUFFER, arena.buffers[0]);
+	glBufferData(GL_ARRAY_BUFFER, g_InitialArenaVertices * VertexSize(format), NULL, GL_STATIC_DRAW);
+	SetShaderMemoryLayout(format);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.buffers[1]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, g_InitialArenaIndexBytes, NULL, GL_STATIC_DRAW);
+	glBindVertexArray(0);
+
+	arena.vertices.Reset(g_InitialArenaVertices);
+	arena.indexBytes.Reset(g_InitialArenaIndexBytes);
+}
+
+///////////////////////////////////////////////////
+//	GrowArenaBuffer()
+//
+//	Replace the vertex (0) or index (1) buffer of an
+//  arena with a bigger one holding the same data, and
+//  point the arena's VAO at it.  Every mesh keeps its
+//  offsets.
+///////////////////////////////////////////////////
+void ShapeMeshes::GrowArenaBuffer(
+	GEOMETRY_ARENA& arena,
+	VertexFormat format,
+	int buffer,
+	GLuint oldBytes,
+	GLuint newBytes)
+{
+	GLuint newBuffer = 0;
+	glGenBuffers(1, &newBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newBytes, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, arena.buffers[buffer]);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes);
+	glDeleteBuffers(1, &arena.buffers[buffer]);
+	arena.buffers[buffer] = newBuffer;
+
+	glBindVertexArray(arena.vao);
+	if (buffer == 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, newBuffer);
+		SetShaderMemoryLayout(format);
+	}
+	else
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newBuffer);
+	}
+	glBindVertexArray(0);
+}
+
+///////////////////////////////////////////////////
+//	AllocateMeshRanges()
+//
+//	Find room for the vertices and indices of a mesh
+//  in an arena, doubling its buffers until they fit.
+//  The index type must be set in the mesh first, and
+//  the indices start at a multiple of their size.
+///////////////////////////////////////////////////
+void ShapeMeshes::AllocateMeshRanges(GEOMETRY_ARENA& arena, GLMesh& mesh)
+{
+	GLuint vertexSize = VertexSize(mesh.vertexFormat);
+	mesh.firstVertex = arena.vertices.Allocate(mesh.nVertices);
+	while (mesh.firstVertex == RangeAllocator::INVALID_OFFSET)
+	{
+		GLuint size = arena.vertices.GetSize();
+		GrowArenaBuffer(arena, mesh.vertexFormat, 0, size * vertexSize, size * 2 * vertexSize);
+		arena.vertices.Grow(size * 2);
+		mesh.firstVertex = arena.vertices.Allocate(mesh.nVertices);
+	}
+
+	GLuint indexBytes = mesh.nIndices * IndexSize(mesh);
+	mesh.indexOffset = arena.indexBytes.Allocate(indexBytes, IndexSize(mesh));
+	while (mesh.indexOffset == RangeAllocator::INVALID_OFFSET)
+	{
+		GLuint size = arena.indexBytes.GetSize();
+		GrowArenaBuffer(arena, mesh.vertexFormat, 1, size, size * 2);
+		arena.indexBytes.Grow(size * 2);
+		mesh.indexOffset = arena.indexBytes.Allocate(indexBytes, IndexSize(mesh));
+	}
+}
+
+///////////////////////////////////////////////////
+//	UploadMesh()
+//
+//	Copy the generated vertex and index data of a mesh
+//  into the arena of the current vertex format.  The
+//  vertex and index counts must be set in the mesh
+//  first.  The vertices are packed into the vertex
+//  format, and the indices, which count from the
+//  mesh's first vertex, are stored as 16-bit values
+//  whenever every vertex can be reached with them.
+//  With a non-zero cache key, the packed data is also
+//  added to the mesh cache.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadMesh(
+	GLMesh& mesh,
+	const GLfloat* vertices,
+	const GLuint* indices,
+	uint64_t cacheKey)
+{
+	mesh.vertexFormat = m_vertexFormat;
+	mesh.vertexSize = VertexSize(mesh.vertexFormat);
+	mesh.indexType = (mesh.nVertices <= g_MaxShortIndexVertices) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	// the shader multiplies the stored integers of the packed
+	// formats by the decode factors, a positive normal scale
+	// meaning octahedral normals
+	// the packed data goes in the scratch arena, where
+	// PackedBytes() of room was reserved for it
+	std::vector<unsigned char> vertexOverflow;
+	std::vector<unsigned char> indexOverflow;
+
+	const void* vertexData = vertices;
+	mesh.vertexDecode = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+	if (mesh.vertexFormat != floatVertices)
+	{
+		glm::vec3 positionScale = VertexQuantizer::PositionScale(vertices, mesh.nVertices, ShapeGenerator::FLOATS_PER_VERTEX);
+		void* packed = PackingMemory(mesh.nVertices * mesh.vertexSize, vertexOverflow);
+		if (mesh.vertexFormat == quantizedVertices)
+		{
+			VertexQuantizer::QuantizeVertices(vertices, mesh.nVertices, ShapeGenerator::FLOATS_PER_VERTEX, positionScale, (VertexQuantizer::QUANTIZED_VERTEX*)packed);
+			mesh.vertexDecode = glm::vec4(positionScale / (float)VertexQuantizer::POSITION_MAX, 1.0f / VertexQuantizer::NORMAL_MAX);
+		}
+		else
+		{
+			VertexQuantizer::QuantizeVertices(vertices, mesh.nVertices, ShapeGenerator::FLOATS_PER_VERTEX, positionScale, (VertexQuantizer::COMPACT_VERTEX*)packed);
+			mesh.vertexDecode = glm::vec4(positionScale / (float)VertexQuantizer::POSITION_MAX, 1.0f / VertexQuantizer::COMPACT_NORMAL_MAX);
+		}
+		vertexData = packed;
+	}
+
+	const void* indexData = indices;
+	if (mesh.indexType == GL_UNSIGNED_SHORT)
+	{
+		GLushort* shortIndices = (GLushort*)PackingMemory(mesh.nIndices * sizeof(GLushort), indexOverflow);
+		std::copy(indices, indices + mesh.nIndices, shortIndices);
+		indexData = shortIndices;
+	}
+
+	UploadMeshData(mesh, vertexData, indexData);
+
+	if ((cacheKey != 0) && (m_meshCache.IsEnabled() == true))
+	{
+		MeshCache::CACHED_MESH cached;
+		cached.vertexFormat = mesh.vertexFormat;
+		cached.vertexCount = mesh.nVertices;
+		cached.vertexSize = mesh.vertexSize;
+		cached.indexCount = mesh.nIndices;
+		cached.indexSize = IndexSize(mesh);
+		cached.segments = mesh.nSegments;
+		cached.meshletCount = (uint32_t)mesh.meshlets.size();
+		memcpy(cached.vertexDecode, &mesh.vertexDecode[0], sizeof(cached.vertexDecode));
+		cached.vertexData = vertexData;
+		cached.indexData = indexData;
+		cached.meshlets = mesh.meshlets.data();
+		m_meshCache.Add(cacheKey, cached);
+	}
+}
+
+///////////////////////////////////////////////////
+//	ReserveScratch()
+//
+//	Empty the scratch arena for the next mesh, first
+//  growing its memory if the mesh needs more than it
+//  has.  The memory is kept from load to load, so it
+//  only grows until the largest mesh has been loaded.
+///////////////////////////////////////////////////
+LinearArena& ShapeMeshes::ReserveScratch(size_t bytes)
+{
+	if (bytes > m_scratchMemory.size())
+	{
+		m_scratchMemory.resize(bytes);
+		m_scratch.Attach(m_scratchMemory.data(), m_scratchMemory.size());
+		m_scratchGrowths++;
+	}
+	m_scratch.Reset();
+	return(m_scratch);
+}
+
+///////////////////////////////////////////////////
+//	PackedBytes()
+//
+//	Get the scratch bytes UploadMesh() takes to pack
+//  a mesh of the passed in size - its vertices in
+//  the current vertex format unless that is floats,
+//  which are uploaded as generated, and its 16-bit
+//  indices when they can be used.
+///////////////////////////////////////////////////
+size_t ShapeMeshes::PackedBytes(GLuint vertexCount, GLuint indexCount) const
+{
+	size_t bytes = 0;
+	if (m_vertexFormat != floatVertices)
+	{
+		bytes += LinearArena::BytesFor<unsigned char>(vertexCount * VertexSize(m_vertexFormat));
+	}
+	if (vertexCount <= g_MaxShortIndexVertices)
+	{
+		bytes += LinearArena::BytesFor<GLushort>(indexCount);
+	}
+	return(bytes);
+}
+
+///////////////////////////////////////////////////
+//	AllocateScratchShape()
+//
+//	Take room for the generated vertices and indices
+//  of a shape from the emptied scratch arena, with
+//  room left after them to pack the shape into.
+///////////////////////////////////////////////////
+void ShapeMeshes::AllocateScratchShape(ShapeGenerator::SHAPE_SIZE size, GLfloat*& vertices, GLuint*& indices)
+{
+	LinearArena& scratch = ReserveScratch(ShapeGenerator::ShapeBytes(size) + PackedBytes(size.vertexCount, size.indexCount));
+	ShapeGenerator::AllocateShape(scratch, size, vertices, indices);
+}
+
+///////////////////////////////////////////////////
+//	PackingMemory()
+//
+//	Take room for packed data from the scratch arena.
+//  If the caller did not reserve enough, the room is
+//  taken from the passed in vector instead, which
+//  must outlive the packed data.
+///////////////////////////////////////////////////
+void* ShapeMeshes::PackingMemory(size_t bytes, std::vector<unsigned char>& overflow)
+{
+	void* memory = m_scratch.Allocate<unsigned char>(bytes);
+	if (memory == NULL)
+	{
+		overflow.resize(bytes);
+		memory = overflow.data();
+	}
+	return(memory);
+}
+
+///////////////////////////////////////////////////
+//	UploadMeshData()
+//
+//	Find room for a mesh in the arena of its vertex
+//  format and copy its packed vertices and indices
+//  there.  The counts, vertex format and index type
+//  must be set in the mesh first.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadMeshData(
+	GLMesh& mesh,
+	const void* vertexData,
+	const void* indexData)
+{
+	GEOMETRY_ARENA& arena = m_arenas[mesh.vertexFormat];
+	if (arena.vao == 0)
+	{
+		CreateArena(arena, mesh.vertexFormat);
+	}
+	AllocateMeshRanges(arena, mesh);
+
+	// the copy target leaves the element buffer of whatever
+	// VAO is bound alone
+	glBindBuffer(GL_COPY_WRITE_BUFFER, arena.buffers[0]);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, mesh.firstVertex * mesh.vertexSize, mesh.nVertices * mesh.vertexSize, vertexData);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, arena.buffers[1]);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, mesh.indexOffset, mesh.nIndices * IndexSize(mesh), indexData);
+}
+
+///////////////////////////////////////////////////
+//	VertexSize()
+//
+//	Get the size in bytes of one vertex of a format.
+///////////////////////////////////////////////////
+GLuint ShapeMeshes::VertexSize(VertexFormat format)
+{
+	if (format == quantizedVertices)
+	{
+		return(sizeof(VertexQuantizer::QUANTIZED_VERTEX));
+	}
+	if (format == compactVertices)
+	{
+		return(sizeof(VertexQuantizer::COMPACT_VERTEX));
+	}
+	return(sizeof(GLfloat) * ShapeGenerator::FLOATS_PER_VERTEX);
+}
+
+///////////////////////////////////////////////////
+//	IndexSize()
+//
+//	Get the size in bytes of one index of a mesh.
+///////////////////////////////////////////////////
+GLuint ShapeMeshes::IndexSize(const GLMesh& mesh)
+{
+	return((mesh.indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint));
+}
+
+///////////////////////////////////////////////////
+//	DrawIndexRange()
+//
+//	Draw a range of the triangles of a mesh, from the
+//  passed in first index for the passed in number of
+//  indices.  The drawn triangles are counted in the
+//  LOD stats.  With cluster culling on, a mesh that
+//  has clusters is drawn one run of visible clusters
+//  at a time.  While capturing, the range is only
+//  recorded.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawIndexRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount)
+{
+	if (m_bCapturingMeshes == true)
+	{
+		CaptureIndexRange(mesh, firstIndex, indexCount);
+		return;
+	}
+
+	// a full detail level is only walked through to count what
+	// the simplified level drawn in its place saves
+	if (m_bCountingFullDetail == true)
+	{
+		m_lodStats.fullDetailTriangles += indexCount / 3;
+		return;
+	}
+	if (m_bCountingStats == true)
+	{
+		m_lodStats.drawnTriangles += indexCount / 3;
+		if (m_bDrawingReducedLod == false)
+		{
+			m_lodStats.fullDetailTriangles += indexCount / 3;
+		}
+	}
+
+	if ((m_bClusterCulling == true) && (m_bClusterViewSet == true) && (mesh.meshlets.size() > 0))
+	{
+		DrawClusters(mesh, firstIndex, indexCount);
+		return;
+	}
+	SubmitIndexRange(mesh, firstIndex, indexCount);
+}
+
+///////////////////////////////////////////////////
+//	DrawClusters()
+//
+//	Test each cluster of a range against the view and
+//  draw the ones that pass, each run of neighbouring
+//  clusters as one draw.  A cluster is left out when
+//  it is outside the frustum, or when the drawn ranges
+//  close a surface and every triangle of the cluster
+//  faces away from the camera - the front of the same
+//  surface then hides it.  The runs are drawn with one
+//  multi-draw call, or join the batch being collected.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawClusters(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount)
+{
+	bool bOwnBatch = (m_bBatchingDraws == false);
+	if (bOwnBatch == true)
+	{
+		BeginDrawBatch();
+	}
+
+	GLuint runFirst = firstIndex;
+	GLuint runCount = 0;
+	for (const MeshletBuilder::MESHLET& meshlet : mesh.meshlets)
+	{
+		if ((meshlet.firstIndex < firstIndex) ||
+			(meshlet.firstIndex + meshlet.indexCount > firstIndex + indexCount))
+		{
+			continue;
+		}
+		if (m_bCountingStats == true)
+		{
+			m_clusterStats.testedClusters++;
+			m_clusterStats.submittedTriangles += meshlet.indexCount / 3;
+		}
+
+		bool bCulled = MeshletBuilder::IsOutsideFrustum(meshlet, m_clusterPlanes);
+		if ((bCulled == false) && (m_bDrawingClosedSurface == true))
+		{
+			bCulled = (m_bClusterOrthographic == true) ?
+				MeshletBuilder::IsBackFacingDirection(meshlet, m_clusterCamera) :
+				MeshletBuilder::IsBackFacing(meshlet, m_clusterCamera);
+		}
+		if (bCulled == true)
+		{
+			continue;
+		}
+		if (m_bCountingStats == true)
+		{
+			m_clusterStats.drawnClusters++;
+			m_clusterStats.drawnTriangles += meshlet.indexCount / 3;
+		}
+
+		if ((runCount > 0) && (runFirst + runCount != meshlet.firstIndex))
+		{
+			SubmitIndexRange(mesh, runFirst, runCount);
+			runCount = 0;
+		}
+		if (runCount == 0)
+		{
+			runFirst = meshlet.firstIndex;
+		}
+		runCount += meshlet.indexCount;
+	}
+	if (runCount > 0)
+	{
+		SubmitIndexRange(mesh, runFirst, runCount);
+	}
+
+	if (bOwnBatch == true)
+	{
+		EndDrawBatch();
+	}
+}
+
+///////////////////////////////////////////////////
+//	SubmitIndexRange()
+//
+//	Draw a range of the triangles of a mesh, or collect
+//  the draw while batching.  The decode factors of the
+//  mesh's vertex format go along as a constant vertex
+//  attribute.
+///////////////////////////////////////////////////
+void ShapeMeshes::SubmitIndexRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount)
+{
+	DRAW_COMMAND command;
+	command.count = indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = (mesh.indexOffset / IndexSize(mesh)) + firstIndex;
+	command.baseVertex = (GLint)mesh.firstVertex;
+	command.baseInstance = 0;
+
+	if (m_bBatchingDraws == true)
+	{
+		BATCH_DRAW draw;
+		draw.vertexFormat = mesh.vertexFormat;
+		draw.indexType = mesh.indexType;
+		draw.vertexDecode = mesh.vertexDecode;
+		m_batchDraws.push_back(draw);
+		m_batchCommands.push_back(command);
+		return;
+	}
+
+	// every mesh of the format shares the VAO, so binding it
+	// again for the next mesh is free
+	glBindVertexArray(m_arenas[mesh.vertexFormat].vao);
+	glVertexAttrib4fv(g_VertexDecodeAttribute, &mesh.vertexDecode[0]);
+	glDrawElementsBaseVertex(GL_TRIANGLES, command.count, mesh.indexType,
+		(void*)(size_t)(command.firstIndex * IndexSize(mesh)), command.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	SetClusterView()
+//
+//	Set the transforms of the object drawn next.  The
+//  frustum planes and the camera are moved into the
+//  space of the object's mesh, where the clusters'
+//  bounds are, so the culling works for any scale.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetClusterView(
+	const glm::mat4& model,
+	const glm::mat4& view,
+	const glm::mat4& projection)
+{
+	glm::mat4 modelView = view * model;
+	MeshletBuilder::ExtractFrustumPlanes(projection * modelView, m_clusterPlanes);
+
+	// an orthographic projection looks along -z everywhere
+	glm::mat4 viewToModel = glm::inverse(modelView);
+	m_bClusterOrthographic = (projection[2][3] == 0.0f);
+	if (m_bClusterOrthographic == true)
+	{
+		m_clusterCamera = glm::vec3(viewToModel * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f));
+	}
+	else
+	{
+		m_clusterCamera = glm::vec3(viewToModel[3]);
+	}
+	m_bClusterViewSet = true;
+}
+
+///////////////////////////////////////////////////
+//	BeginDrawBatch()
+//
+//	Start collecting the draws of the draw methods
+//  instead of drawing them.
+///////////////////////////////////////////////////
+void ShapeMeshes::BeginDrawBatch()
+{
+	m_bBatchingDraws = true;
+	m_batchDraws.clear();
+	m_batchCommands.clear();
+	m_batchPrimitives.clear();
+}
+
+///////////////////////////////////////////////////
+//	EndDrawBatch()
+//
+//	Draw the collected draws, one multi-draw call for
+//  each run of draws with the same vertex format,
+//  index type and decode factors.  The commands go up
+//  in one indirect buffer.  Without multi-draw
+//  indirect support, each is drawn on its own.  The
+//  collected bufferless shapes are all one draw.
+///////////////////////////////////////////////////
+void ShapeMeshes::EndDrawBatch()
+{
+	m_bBatchingDraws = false;
+	if (m_batchPrimitives.size() > 0)
+	{
+		DrawPrimitiveRecords(m_batchPrimitives);
+		m_batchPrimitives.clear();
+	}
+	if (m_batchCommands.size() == 0)
+	{
+		return;
+	}
+
+	if (GLEW_ARB_multi_draw_indirect)
+	{
+		if (m_indirectBuffer == 0)
+		{
+			glGenBuffers(1, &m_indirectBuffer);
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DRAW_COMMAND) * m_batchCommands.size(), m_batchCommands.data(), GL_STREAM_DRAW);
+	}
+
+	int first = 0;
+	for (int i = 1; i <= (int)m_batchDraws.size(); i++)
+	{
+		if ((i == (int)m_batchDraws.size()) ||
+			(m_batchDraws[i].vertexFormat != m_batchDraws[first].vertexFormat) ||
+			(m_batchDraws[i].indexType != m_batchDraws[first].indexType) ||
+			(m_batchDraws[i].vertexDecode != m_batchDraws[first].vertexDecode))
+		{
+			SubmitBatchDraws(first, i - first);
+			first = i;
+		}
+	}
+
+	if (GLEW_ARB_multi_draw_indirect)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	m_batchDraws.clear();
+	m_batchCommands.clear();
+}
+
+///////////////////////////////////////////////////
+//	SubmitBatchDraws()
+//
+//	Draw a run of collected draws that share the same
+//  state.
+///////////////////////////////////////////////////
+void ShapeMeshes::SubmitBatchDraws(int first, int count)
+{
+	const BATCH_DRAW& draw = m_batchDraws[first];
+	GLuint indexSize = (draw.indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+	glBindVertexArray(m_arenas[draw.vertexFormat].vao);
+	glVertexAttrib4fv(g_VertexDecodeAttribute, &draw.vertexDecode[0]);
+
+	if (GLEW_ARB_multi_draw_indirect)
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, draw.indexType,
+			(void*)(sizeof(DRAW_COMMAND) * first), count, 0);
+		return;
+	}
+
+	for (int i = first; i < first + count; i++)
+	{
+		const DRAW_COMMAND& command = m_batchCommands[i];
+		glDrawElementsBaseVertex(GL_TRIANGLES, command.count, draw.indexType,
+			(void*)(size_t)(command.firstIndex * indexSize), command.baseVertex);
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetMeshStats()
+//
+//	Get the number of loaded meshes, the amount of
+//  vertex and index data stored for them and the size
+//  of the arenas holding it.
+///////////////////////////////////////////////////
+ShapeMeshes::MESH_STATS ShapeMeshes::GetMeshStats() const
+{
+	MESH_STATS stats = {};
+	for (int i = 0; i < m_meshes.SlotCount(); i++)
+	{
+		const GLMesh* mesh = m_meshes.GetAt(i);
+		if (mesh != NULL)
+		{
+			stats.meshes++;
+			stats.vertices += mesh->nVertices;
+			stats.indices += mesh->nIndices;
+			stats.vertexBytes += mesh->nVertices * mesh->vertexSize;
+			stats.indexBytes += mesh->nIndices * IndexSize(*mesh);
+		}
+	}
+
+	for (int format = 0; format < VERTEX_FORMAT_COUNT; format++)
+	{
+		const GEOMETRY_ARENA& arena = m_arenas[format];
+		stats.arenaBytes += (arena.vertices.GetSize() * VertexSize((VertexFormat)format)) + arena.indexBytes.GetSize();
+	}
+	return(stats);
+}
+
+///////////////////////////////////////////////////
+//	LoadBoxMesh()
+//
+//	Create a box mesh from the built vertices and
+//  store it in the mesh arena.  The normals and texture
+//  coordinates are also set.
+//
+//	Correct triangle drawing command:
+//
+//	DrawIndexRange(mesh, 0, ShapeGenerator::BOX_INDEX_COUNT);
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadBoxMesh()
+{
+	if (LoadPrimitive(m_BoxPrimitive, ShapeGenerator::BoxPrimitive()) == true)
+	{
+		FreeMesh(m_BoxMesh);
+		m_BoxMesh = MeshHandle();
+		return;
+	}
+
+	GLMesh mesh;
+
+	ShapeGenerator::SHAPE_DATA data = ShapeGenerator::BoxData();
+	mesh.nVertices = data.size.vertexCount;
+	mesh.nIndices = data.size.indexCount;
+
+	// the data was built while compiling, so it is uploaded
+	// as it is
+	ReserveScratch(PackedBytes(mesh.nVertices, mesh.nIndices));
+	m_BoxMesh = StoreMesh(m_BoxMesh, mesh, data.vertices, data.indices);
+}
+
+///////////////////////////////////////////////////
+//	LoadConeLevel()
+//
+//	Create a cone mesh with the passed in number of
+//  segments around it and store it in the mesh arena.
+//  The normals and texture coordinates are also set.
+//
+//  Correct triangle drawing commands:
+//
+//	bottom = ShapeGenerator::CapIndexCount(segments);
+//	DrawIndexRange(mesh, 0, bottom);						//bottom
+//	DrawIndexRange(mesh, bottom, mesh.nIndices - bottom);	//sides
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::LoadConeLevel(MeshHandle previous, int segments)
+{
+	GLMesh mesh;
+
+	segments = ShapeGenerator::ValidRoundSegments(segments);
+	// a mesh made in an earlier run is uploaded from the cache
+	uint64_t cacheKey = MeshCacheKey("cone", segments, 0, 0.0f);
+	MeshHandle cached;
+	if (LoadCachedMesh(previous, cacheKey, cached) == true)
+	{
+		return(cached);
+	}
+
+	ShapeGenerator::SHAPE_SIZE size = ShapeGenerator::ConeSize(segments);
+	GLfloat* verts = NULL;
+	GLuint* indices = NULL;
+	AllocateScratchShape(size, verts, indices);
+	ShapeGenerator::GenerateCone(segments, verts, indices);
+
+	// store vertex and index count
+	mesh.nVertices = size.vertexCount;
+	mesh.nIndices = size.indexCount;
+	mesh.nSegments = segments;
+
+	// the bottom and sides are drawn separately
+	GLuint coneRanges[] = { 0, (GLuint)ShapeGenerator::CapIndexCount(segments) };
+	OptimizeMesh(mesh, verts, indices, coneRanges, 2);
+	BuildMeshlets(mesh, verts, indices, coneRanges, 2);
+	// replace the previous mesh of the level
+	return(StoreMesh(previous, mesh, verts, indices, cacheKey));
+}
+
+///////////////////////////////////////////////////
+//	LoadConeMesh()
+//
+//	Create a cone mesh with the passed in number of
+//  segments around it, and simplified levels of it with
+//  half as many segments each, down to a few.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadConeMesh(int segments)
+{
+	if (LoadPrimitive(m_ConePrimitive, ShapeGenerator::ConePrimitive(segments)) == true)
+	{
+		TrimLodChain(m_ConeLods, 0);
+		return;
+	}
+
+	segments = ShapeGenerator::ValidRoundSegments(segments);
+
+	int level = 0;
+	while (level < MAX_LOD_LEVELS)
+	{
+		m_ConeLods.levels[level] = LoadConeLevel(m_ConeLods.levels[level], segments);
+		m_ConeLods.errors[level] = ShapeGenerator::RoundError(segments);
+		level++;
+
+		int next = LodSegments(segments, g_MinLodRoundSegments, false);
+		if (next == segments)
+		{
+			break;
+		}
+		segments = next;
+	}
+	TrimLodChain(m_ConeLods, level);
+}
+
+///////////////////////////////////////////////////
+//	LoadCylinderLevel()
+//
+//	Create a cylinder mesh with the passed in number
+//  of segments around it and store it in the mesh arena.
+//  The normals and texture coordinates are also set.
+//
+//  Correct triangle drawing commands:
+//
+//	cap = ShapeGenerator::CapIndexCount(segments);
+//	DrawIndexRange(mesh, 0, cap);								//bottom
+//	DrawIndexRange(mesh, cap, cap);								//top
+//	DrawIndexRange(mesh, cap * 2, mesh.nIndices - (cap * 2));	//sides
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::LoadCylinderLevel(MeshHandle previous, int segments)
+{
+	GLMesh mesh;
+
+	segments = ShapeGenerator::ValidRoundSegments(segments);
+	// a mesh made in an earlier run is uploaded from the cache
+	uint64_t cacheKey = MeshCacheKey("cylinder", segments, 0, 0.0f);
+	MeshHandle cached;
+	if (LoadCachedMesh(previous, cacheKey, cached) == true)
+	{
+		return(cached);
+	}
+
+	ShapeGenerator::SHAPE_SIZE size = ShapeGenerator::CylinderSize(segments);
+	GLfloat* verts = NULL;
+	GLuint* indices = NULL;
+	AllocateScratchShape(size, verts, indices);
+	ShapeGenerator::GenerateCylinder(segments, verts, indices);
+
+	// store vertex and index count
+	mesh.nVertices = size.vertexCount;
+	mesh.nIndices = size.indexCount;
+	mesh.nSegments = segments;
+
+	// the bottom, top and sides are drawn separately
+	GLuint cap = ShapeGenerator::CapIndexCount(segments);
+	GLuint cylinderRanges[] = { 0, cap, cap * 2 };
+	OptimizeMesh(mesh, verts, indices, cylinderRanges, 3);
+	BuildMeshlets(mesh, verts, indices, cylinderRanges, 3);
+	// replace the previous mesh of the level
+	return(StoreMesh(previous, mesh, verts, indices, cacheKey));
 }
 
-ShapeMeshes::ShapeMeshes()
+///////////////////////////////////////////////////
+//	LoadCylinderMesh()
+//
+//	Create a cylinder mesh with the passed in number
+//  of segments around it, and simplified levels of it
+//  with half as many segments each, down to a few.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadCylinderMesh(int segments)
 {
-	m_bMemoryLayoutDone = false;
+	if (LoadPrimitive(m_CylinderPrimitive, ShapeGenerator::CylinderPrimitive(segments, 1.0f)) == true)
+	{
+		FreeMesh(m_CylinderPatches);
+		m_CylinderPatches = MeshHandle();
+		TrimLodChain(m_CylinderLods, 0);
+		return;
+	}
+	if (m_tessellationProgram != 0)
+	{
+		// the patches take the place of every level
+		m_CylinderPatches = LoadPatches(m_CylinderPatches, ShapeGenerator::CylinderPatchesSize(), [&](GLfloat* vertices, GLuint* indices) {
+			ShapeGenerator::GenerateCylinderPatches(1.0f, vertices, indices);
+		});
+		TrimLodChain(m_CylinderLods, 0);
+		return;
+	}
+	FreeMesh(m_CylinderPatches);
+	m_CylinderPatches = MeshHandle();
+
+	segments = ShapeGenerator::ValidRoundSegments(segments);
+
+	int level = 0;
+	while (level < MAX_LOD_LEVELS)
+	{
+		m_CylinderLods.levels[level] = LoadCylinderLevel(m_CylinderLods.levels[level], segments);
+		m_CylinderLods.errors[level] = ShapeGenerator::RoundError(segments);
+		level++;
+
+		int next = LodSegments(segments, g_MinLodRoundSegments, false);
+		if (next == segments)
+		{
+			break;
+		}
+		segments = next;
+	}
+	TrimLodChain(m_CylinderLods, level);
 }
 
 ///////////////////////////////////////////////////
-//	LoadBoxMesh()
+//	LoadPlaneMesh()
 //
-//	Create a box mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//	Create a plane mesh from the built vertices and
+//  store it in the mesh arena.  The normals and texture
 //  coordinates are also set.
 //
-//	Correct triangle drawing command:
+//  Correct triangle drawing command:
 //
-//	glDrawElements(GL_TRIANGLES, meshes.gBoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+//	DrawIndexRange(mesh, 0, mesh.nIndices);
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadBoxMesh()
+void ShapeMeshes::LoadPlaneMesh()
 {
-	// Position and Color data
-	GLfloat verts[] = {
-		//Positions				//Normals
-		// ------------------------------------------------------
-
-		//Back Face				//Negative Z Normal  Texture Coords.
-		0.5f, 0.5f, -0.5f,		0.0f,  0.0f, 1.0f,  0.0f, 1.0f,   //0
-		0.5f, -0.5f, -0.5f,		0.0f,  0.0f, 1.0f,  0.0f, 0.0f,   //1
-		-0.5f, -0.5f, -0.5f,	0.0f,  0.0f, 1.0f,  1.0f, 0.0f,   //2
-		-0.5f, 0.5f, -0.5f,		0.0f,  0.0f, 1.0f,  1.0f, 1.0f,   //3
-
-		//Bottom Face			//Negative Y Normal
-		-0.5f, -0.5f, 0.5f,		0.0f, 1.0f,  0.0f,  0.0f, 1.0f,  //4
-		-0.5f, -0.5f, -0.5f,	0.0f, 1.0f,  0.0f,  0.0f, 0.0f,  //5
-		0.5f, -0.5f, -0.5f,		0.0f, 1.0f,  0.0f,  1.0f, 0.0f,  //6
-		0.5f, -0.5f,  0.5f,		0.0f, 1.0f,  0.0f,  1.0f, 1.0f,  //7
-
-		//Left Face				//Negative X Normal
-		-0.5f, 0.5f, -0.5f,		-1.0f,  0.0f,  0.0f,  0.0f, 1.0f,  //8
-		-0.5f, -0.5f,  -0.5f,	-1.0f,  0.0f,  0.0f,  0.0f, 0.0f,  //9
-		-0.5f,  -0.5f,  0.5f,	-1.0f,  0.0f,  0.0f,  1.0f, 0.0f,  //10
-		-0.5f,  0.5f,  0.5f,	-1.0f,  0.0f,  0.0f,  1.0f, 1.0f,  //11
-
-		//Right Face			//Positive X Normal
-		0.5f,  0.5f,  0.5f,		-1.0f,  0.0f,  0.0f,  0.0f, 1.0f,  //12
-		0.5f,  -0.5f, 0.5f,		-1.0f,  0.0f,  0.0f,  0.0f, 0.0f,  //13
-		0.5f, -0.5f, -0.5f,		-1.0f,  0.0f,  0.0f,  1.0f, 0.0f,  //14
-		0.5f, 0.5f, -0.5f,		-1.0f,  0.0f,  0.0f,  1.0f, 1.0f,  //15
-
-		//Top Face				//Positive Y Normal
-		-0.5f,  0.5f, -0.5f,	0.0f,  -1.0f,  0.0f,  0.0f, 1.0f, //16
-		-0.5f,  0.5f, 0.5f,		0.0f,  -1.0f,  0.0f,  0.0f, 0.0f, //17
-		0.5f,  0.5f,  0.5f,		0.0f,  -1.0f,  0.0f,  1.0f, 0.0f, //18
-		0.5f,  0.5f,  -0.5f,	0.0f,  -1.0f,  0.0f,  1.0f, 1.0f, //19
-
-		//Front Face			//Positive Z Normal
-		-0.5f, 0.5f,  0.5f,	    0.0f,  0.0f,  -1.0f,  0.0f, 1.0f, //20
-		-0.5f, -0.5f,  0.5f,	0.0f,  0.0f,  -1.0f,  0.0f, 0.0f, //21
-		0.5f,  -0.5f,  0.5f,	0.0f,  0.0f,  -1.0f,  1.0f, 0.0f, //22
-		0.5f,  0.5f,  0.5f,		0.0f,  0.0f,  -1.0f,  1.0f, 1.0f, //23
-	};
-
-	// Index data
-	GLuint indices[] = {
-		0,1,2,
-		0,3,2,
-		4,5,6,
-		4,7,6,
-		8,9,10,
-		8,11,10,
-		12,13,14,
-		12,15,14,
-		16,17,18,
-		16,19,18,
-		20,21,22,
-		20,23,22
-	};
-
-	m_BoxMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_BoxMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
-
-	glGenVertexArrays(1, &m_BoxMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_BoxMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(2, m_BoxMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_BoxMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
+	if (LoadPrimitive(m_PlanePrimitive, ShapeGenerator::PlanePrimitive()) == true)
+	{
+		FreeMesh(m_PlaneMesh);
+		m_PlaneMesh = MeshHandle();
+		return;
 	}
+
+	GLMesh mesh;
+
+	ShapeGenerator::SHAPE_DATA data = ShapeGenerator::PlaneData();
+	mesh.nVertices = data.size.vertexCount;
+	mesh.nIndices = data.size.indexCount;
+
+	// the data was built while compiling, so it is uploaded
+	// as it is
+	ReserveScratch(PackedBytes(mesh.nVertices, mesh.nIndices));
+	m_PlaneMesh = StoreMesh(m_PlaneMesh, mesh, data.vertices, data.indices);
 }
 
 ///////////////////////////////////////////////////
-//	LoadConeMesh()
+//	LoadPrismMesh()
 //
-//	Create a cole mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//	Create a prism mesh from the built vertices and
+//  store it in the mesh arena.  The normals and texture
 //  coordinates are also set.
 //
-//  Correct triangle drawing commands:
+//	Correct triangle drawing command:
+//
+//	DrawIndexRange(mesh, 0, mesh.nIndices);
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadPrismMesh()
+{
+	GLMesh mesh;
+
+	ShapeGenerator::SHAPE_DATA data = ShapeGenerator::PrismData();
+	mesh.nVertices = data.size.vertexCount;
+	mesh.nIndices = data.size.indexCount;
+
+	// the data was built while compiling, already in optimized
+	// order, so it is uploaded as it is
+	ReserveScratch(PackedBytes(mesh.nVertices, mesh.nIndices));
+	m_PrismMesh = StoreMesh(m_PrismMesh, mesh, data.vertices, data.indices);
+}
+
+///////////////////////////////////////////////////
+//	LoadPyramid3Mesh()
+//
+//	Create a 3-sided pyramid mesh from the built
+//  vertices and store it in the mesh arena.  The normals
+//  and texture coordinates are also set.
+//
+//  Correct triangle drawing command:
+//
+//	DrawIndexRange(mesh, 0, mesh.nIndices);
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadPyramid3Mesh()
+{
+	GLMesh mesh;
+
+	ShapeGenerator::SHAPE_DATA data = ShapeGenerator::Pyramid3Data();
+	mesh.nVertices = data.size.vertexCount;
+	mesh.nIndices = data.size.indexCount;
+
+	// the data was built while compiling, already in optimized
+	// order, so it is uploaded as it is
+	ReserveScratch(PackedBytes(mesh.nVertices, mesh.nIndices));
+	m_Pyramid3Mesh = StoreMesh(m_Pyramid3Mesh, mesh, data.vertices, data.indices);
+}
+
+///////////////////////////////////////////////////
+//	LoadPyramid4Mesh()
+//
+//	Create a 4-sided pyramid mesh from the built
+//  vertices and store it in the mesh arena.  The normals
+//  and texture coordinates are also set.
+//
+//  Correct triangle drawing command:
+//
+//	DrawIndexRange(mesh, 0, mesh.nIndices);
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadPyramid4Mesh()
+{
+	GLMesh mesh;
+
+	ShapeGenerator::SHAPE_DATA data = ShapeGenerator::Pyramid4Data();
+	mesh.nVertices = data.size.vertexCount;
+	mesh.nIndices = data.size.indexCount;
+
+	// the data was built while compiling, already in optimized
+	// order, so it is uploaded as it is
+	ReserveScratch(PackedBytes(mesh.nVertices, mesh.nIndices));
+	m_Pyramid4Mesh = StoreMesh(m_Pyramid4Mesh, mesh, data.vertices, data.indices);
+}
+
+///////////////////////////////////////////////////
+//	LoadSphereLevel()
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
-///////////////////////////////////////////////////
-void ShapeMeshes::LoadConeMesh()
-{
-	GLfloat verts[] = {
-		// cone bottom			// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cone sides		// normals									// texture coords
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		1.0f,0.5f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.0f, -0.116841137f, 		0.983f,0.6f,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f, 		0.983f,0.6f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f, 		0.96f,0.68f,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f, 		0.96f,0.68f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f, 		0.92f,0.77f,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f, 		0.92f,0.77f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f, 		0.87f, 0.83f,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f, 		0.87f, 0.83f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f, 		0.83f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f, 		0.83f, 0.87f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f, 		0.77f, 0.92f,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f, 		0.77f, 0.92f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f, 		0.68f, 0.96f,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f, 		0.68f, 0.96f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f, 		0.6f, 0.983f,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f, 		0.6f, 0.983f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f, 		0.41f, 0.983f,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f, 		0.41f, 0.983f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f, 		0.33f, 0.96f,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f, 		0.33f, 0.96f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f, 		0.25f, 0.92f,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f, 		0.25f, 0.92f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f, 		0.17f, 0.87f,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f, 		0.17f, 0.87f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f, 		0.13f, 0.83f,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f, 		0.13f, 0.83f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f, 		0.08f, 0.77f,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f, 		0.08f, 0.77f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f, 		0.04f, 0.68f,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f, 		0.04f, 0.68f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f, 		0.017f, 0.6f,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f, 		0.017f, 0.6f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f, 		0.5f, 0.5f,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f, 		0.017f, 0.41f,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f, 		0.017f, 0.41f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, 0.229039446f, 		0.5f, 0.5f,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f, 		0.04f, 0.33f,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f, 		0.04f, 0.33f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, 0.400818795f, 		0.5f, 0.5f,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f, 		0.08f, 0.25f,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f, 		0.08f, 0.25f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, 0.581238329f, 		0.5f, 0.5f,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f, 		0.13f, 0.17f,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f, 		0.13f, 0.17f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, 0.707106769f, 		0.5f, 0.5f,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f, 		0.17f, 0.13f,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f, 		0.17f, 0.13f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, 0.813733339f, 		0.5f, 0.5f,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f, 		0.25f, 0.08f,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f, 		0.25f, 0.08f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, 0.916157305f, 		0.5f, 0.5f,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f, 		0.33f, 0.04f,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f, 		0.33f, 0.04f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, 0.973417103f, 		0.5f, 0.5f,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f, 		0.41f, 0.017f,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f, 		0.41f, 0.017f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.0f,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.0f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f, 	0.6f, 0.017f,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f, 	0.6f, 0.017f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, 0.973417103f, 	0.5f, 0.5f,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f, 	0.68f, 0.04f,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f, 	0.68f, 0.04f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, 0.916157305f, 	0.5f, 0.5f,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f, 	0.77f, 0.08f,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f, 	0.77f, 0.08f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, 0.813733339f, 	0.5f, 0.5f,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f, 	0.83f, 0.13f,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f, 	0.83f, 0.13f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, 0.707106769f, 	0.5f, 0.5f,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f, 	0.87f, 0.17f,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f, 	0.87f, 0.17f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, 0.581238329f, 	0.5f, 0.5f,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f, 	0.92f, 0.25f,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f, 	0.92f, 0.25f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, 0.400818795f, 	0.5f, 0.5f,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f, 	0.96f, 0.33f,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f, 	0.96f, 0.33f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, 0.229039446f, 	0.5f, 0.5f,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f, 	0.983f, 0.41f,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f, 	0.983f, 0.41f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	0.5f, 0.5f,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	1.0f, 0.5f
-	};
+//	Create a sphere mesh with the passed in numbers of
+//  slices around it and stacks from pole to pole, and
+//  store it in the mesh arena.  Both numbers are rounded
+//  up to even.  The normals and texture coordinates
+//  are also set.
+//
+//  Correct triangle drawing command:
+//
+//	DrawIndexRange(mesh, 0, mesh.nIndices);
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::LoadSphereLevel(MeshHandle previous, int slices, int stacks)
+{
+	GLMesh mesh;
+
+	// a mesh made in an earlier run is uploaded from the cache
+	uint64_t cacheKey = MeshCacheKey("sphere", slices, stacks, 0.0f);
+	MeshHandle cached;
+	if (LoadCachedMesh(previous, cacheKey, cached) == true)
+	{
+		return(cached);
+	}
+
+	ShapeGenerator::SHAPE_SIZE size = ShapeGenerator::SphereSize(slices, stacks);
+	GLfloat* verts = NULL;
+	GLuint* indices = NULL;
+	AllocateScratchShape(size, verts, indices);
+	ShapeGenerator::GenerateSphere(slices, stacks, verts, indices);
 
 	// store vertex and index count
-	m_ConeMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_ConeMesh.nIndices = 0;
+	mesh.nVertices = size.vertexCount;
+	mesh.nIndices = size.indexCount;
+
+	// the half sphere is the first half of the indices
+	GLuint sphereRanges[] = { 0, mesh.nIndices / 2 };
+	OptimizeMesh(mesh, verts, indices, sphereRanges, 2);
+	BuildMeshlets(mesh, verts, indices, sphereRanges, 2);
+	// replace the previous mesh of the level
+	return(StoreMesh(previous, mesh, verts, indices, cacheKey));
+}
 
-	// Create VAO
-	glGenVertexArrays(1, &m_ConeMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_ConeMesh.vao);
+///////////////////////////////////////////////////
+//	LoadSphereMesh()
+//
+//	Create a sphere mesh with the passed in numbers of
+//  slices and stacks, and simplified levels of it with
+//  half as many of each, down to a few.  The stacks
+//  stay even so each level has a half sphere.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadSphereMesh(int slices, int stacks)
+{
+	if (LoadPrimitive(m_SpherePrimitive, ShapeGenerator::SpherePrimitive(slices, stacks)) == true)
+	{
+		FreeMesh(m_SpherePatches);
+		m_SpherePatches = MeshHandle();
+		TrimLodChain(m_SphereLods, 0);
+		return;
+	}
+	if (m_tessellationProgram != 0)
+	{
+		// the patches take the place of every level
+		m_SpherePatches = LoadPatches(m_SpherePatches, ShapeGenerator::SpherePatchesSize(), [&](GLfloat* vertices, GLuint* indices) {
+			ShapeGenerator::GenerateSpherePatches(vertices, indices);
+		});
+		TrimLodChain(m_SphereLods, 0);
+		return;
+	}
+	FreeMesh(m_SpherePatches);
+	m_SpherePatches = MeshHandle();
 
-	// Create VBO
-	glGenBuffers(1, m_ConeMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_ConeMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	slices = ShapeGenerator::ValidSphereSlices(slices);
+	stacks = ShapeGenerator::ValidSphereStacks(stacks);
 
-	if (m_bMemoryLayoutDone == false)
+	int level = 0;
+	while (level < MAX_LOD_LEVELS)
 	{
-		SetShaderMemoryLayout();
+		m_SphereLods.levels[level] = LoadSphereLevel(m_SphereLods.levels[level], slices, stacks);
+		m_SphereLods.errors[level] = ShapeGenerator::SphereError(slices, stacks);
+		level++;
+
+		int nextSlices = LodSegments(slices, g_MinLodSphereSegments, true);
+		int nextStacks = LodSegments(stacks, g_MinLodSphereSegments, true);
+		if ((nextSlices == slices) && (nextStacks == stacks))
+		{
+			break;
+		}
+		slices = nextSlices;
+		stacks = nextStacks;
 	}
+	TrimLodChain(m_SphereLods, level);
 }
 
 ///////////////////////////////////////////////////
-//	LoadCylinderMesh()
+//	LoadTaperedCylinderLevel()
 //
-//	Create a cylinder mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Create a tapered cylinder mesh with the passed in
+//  number of segments around it and store it in the
+//  mesh arena.  The top is half as wide as the bottom.
+//  The normals and texture coordinates are also set.
 //
 //  Correct triangle drawing commands:
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 36);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
-///////////////////////////////////////////////////
-void ShapeMeshes::LoadCylinderMesh()
-{
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 1.0f, -0.34f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 1.0f, -0.64f,		0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 1.0f, -0.77f,		0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 1.0f, -0.94f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 1.0f, -0.98f,		0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -1.0f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 1.0f, -0.98f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 1.0f, -0.94f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 1.0f, -0.77f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 1.0f, -0.64f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 1.0f, -0.34f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.5f, -0.116841137f,	0.02778,0.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.02778,1.0,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.02778,0.0,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f,	0.05556,0.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f,	0.02778,1.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.05556,1.0,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.05556,0.0,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f,	0.08334,0.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.05556,1.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.08334,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.08334,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f,	0.11112,0.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.08334,1.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.11112,1.0,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.11112,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f,	0.1389,0.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.11112,1.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1389,1.0,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1389,0.0,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f,	0.16668,0.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1389, 1.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.16668, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.16668, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f,	0.19446, 0.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.16668, 1.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.19446, 1.0,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.19446, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f,	0.22224, 0.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.19446, 1.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.22224, 1.0,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.22224, 0.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.25, 0.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.22224, 1.0,
-		0.0f, 1.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.25, 1.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.25, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f,	0.2778, 0.0,
-		0.0f, 1.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f,	0.25, 1.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.2778, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.2778, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f,	0.30558, 0.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.2778, 1.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.30558, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.30558, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f,	0.33336, 0.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.30558, 1.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.33336, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.33336, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f,	0.36114, 0.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.33336, 1.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.36114, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.36114, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f,	0.38892, 0.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.36114, 1.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.38892, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.38892, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f,	0.4167, 0.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.38892, 1.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4167, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4167, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f,	0.44448, 0.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4167, 1.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.44448, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.44448, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f,	0.47226, 0.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.44448, 1.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.47226, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.47226, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.5, 0.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.47226, 1.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.5, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.5, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f,	0.52782, 0.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f,	0.5, 1.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.52782, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.52782, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f,	0.5556, 0.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.52782, 1.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.5556, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.5556, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f,	0.58338, 0.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.5556, 1.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.58338, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.58338, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f,	0.61116, 0.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.58338, 1.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.61116, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.61116, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f,	0.63894, 0.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.61116, 1.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.63894, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.63894, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f,	0.66672, 0.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.63894, 1.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.66672, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.66672, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f,	0.6945, 0.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.66672, 1.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6945, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6945, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f,	0.72228, 0.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6945, 1.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.72228, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.72228, 0.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.75, 0.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.72228, 1.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.75, 1.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.75, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f,	0.77784, 0.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.75, 1.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.77784, 1.0,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.77784, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f,	0.80562, 0.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.77784, 1.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.80562, 1.0,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.80562, 0.0,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f,	0.8334, 0.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.80562, 1.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.8334, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.8334, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f,	0.86118, 0.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.8334, 1.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.86118, 1.0,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.86118, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f,	0.88896, 0.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.86118, 1.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.88896, 1.0,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.88896, 0.0,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f,	0.91674, 0.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.88896, 1.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.91674, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.91674, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f,	0.94452, 0.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.91674, 1.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.94452, 1.0,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.94452, 0.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f,	0.9723, 0.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.94452, 1.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9723, 1.0,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9723, 0.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9723, 1.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0
-	};
-
-	glm::vec3 normal;
-
-	normal = CalculateTriangleNormal(glm::vec3(.98f, 1.0f, 0.17f), glm::vec3(.98f, 0.0f, 0.17f), glm::vec3(1.0f, 0.0f, 0.0f));
+//	cap = ShapeGenerator::CapIndexCount(segments);
+//	DrawIndexRange(mesh, 0, cap);								//bottom
+//	DrawIndexRange(mesh, cap, cap);								//top
+//	DrawIndexRange(mesh, cap * 2, mesh.nIndices - (cap * 2));	//sides
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::LoadTaperedCylinderLevel(MeshHandle previous, int segments)
+{
+	GLMesh mesh;
+
+	segments = ShapeGenerator::ValidRoundSegments(segments);
+	// a mesh made in an earlier run is uploaded from the cache
+	uint64_t cacheKey = MeshCacheKey("tapered cylinder", segments, 0, g_TaperedTopRadius);
+	MeshHandle cached;
+	if (LoadCachedMesh(previous, cacheKey, cached) == true)
+	{
+		return(cached);
+	}
+
+	ShapeGenerator::SHAPE_SIZE size = ShapeGenerator::TaperedCylinderSize(segments);
+	GLfloat* verts = NULL;
+	GLuint* indices = NULL;
+	AllocateScratchShape(size, verts, indices);
+	ShapeGenerator::GenerateTaperedCylinder(segments, g_TaperedTopRadius, verts, indices);
+
+	// store vertex and index count
+	mesh.nVertices = size.vertexCount;
+	mesh.nIndices = size.indexCount;
+	mesh.nSegments = segments;
+
+	// the bottom, top and sides are drawn separately
+	GLuint cap = ShapeGenerator::CapIndexCount(segments);
+	GLuint cylinderRanges[] = { 0, cap, cap * 2 };
+	OptimizeMesh(mesh, verts, indices, cylinderRanges, 3);
+	BuildMeshlets(mesh, verts, indices, cylinderRanges, 3);
+	// replace the previous mesh of the level
+	return(StoreMesh(previous, mesh, verts, indices, cacheKey));
+}
+
+///////////////////////////////////////////////////
+//	LoadTaperedCylinderMesh()
+//
+//	Create a tapered cylinder mesh with the passed in
+//  number of segments around it, and simplified levels
+//  of it with half as many segments each, down to a few.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadTaperedCylinderMesh(int segments)
+{
+	if (LoadPrimitive(m_TaperedCylinderPrimitive, ShapeGenerator::CylinderPrimitive(segments, g_TaperedTopRadius)) == true)
+	{
+		FreeMesh(m_TaperedCylinderPatches);
+		m_TaperedCylinderPatches = MeshHandle();
+		TrimLodChain(m_TaperedCylinderLods, 0);
+		return;
+	}
+	if (m_tessellationProgram != 0)
+	{
+		// the patches take the place of every level
+		m_TaperedCylinderPatches = LoadPatches(m_TaperedCylinderPatches, ShapeGenerator::CylinderPatchesSize(), [&](GLfloat* vertices, GLuint* indices) {
+			ShapeGenerator::GenerateCylinderPatches(g_TaperedTopRadius, vertices, indices);
+		});
+		TrimLodChain(m_TaperedCylinderLods, 0);
+		return;
+	}
+	FreeMesh(m_TaperedCylinderPatches);
+	m_TaperedCylinderPatches = MeshHandle();
+
+	segments = ShapeGenerator::ValidRoundSegments(segments);
+
+	int level = 0;
+	while (level < MAX_LOD_LEVELS)
+	{
+		m_TaperedCylinderLods.levels[level] = LoadTaperedCylinderLevel(m_TaperedCylinderLods.levels[level], segments);
+		m_TaperedCylinderLods.errors[level] = ShapeGenerator::RoundError(segments);
+		level++;
+
+		int next = LodSegments(segments, g_MinLodRoundSegments, false);
+		if (next == segments)
+		{
+			break;
+		}
+		segments = next;
+	}
+	TrimLodChain(m_TaperedCylinderLods, level);
+}
+
+///////////////////////////////////////////////////
+//	LoadTorusLevel()
+//
+//	Create a torus mesh with the passed in tube
+//  thickness and numbers of segments around the ring
+//  and around the tube, and store it in the mesh arena.
+//  The normals and texture coordinates are also set.
+//
+//	Correct triangle drawing command:
+//
+//	DrawIndexRange(mesh, 0, mesh.nIndices);
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::LoadTorusLevel(MeshHandle previous, float tubeRadius, int mainSegments, int tubeSegments)
+{
+	GLMesh mesh;
+
+	mainSegments = ShapeGenerator::ValidTorusSegments(mainSegments);
+	// a mesh made in an earlier run is uploaded from the cache
+	uint64_t cacheKey = MeshCacheKey("torus", mainSegments, tubeSegments, tubeRadius);
+	MeshHandle cached;
+	if (LoadCachedMesh(previous, cacheKey, cached) == true)
+	{
+		return(cached);
+	}
+
+	ShapeGenerator::SHAPE_SIZE size = ShapeGenerator::TorusSize(mainSegments, tubeSegments);
+	GLfloat* verts = NULL;
+	GLuint* indices = NULL;
+	AllocateScratchShape(size, verts, indices);
+	ShapeGenerator::GenerateTorus(mainSegments, tubeSegments, tubeRadius, verts, indices);
 
 	// store vertex and index count
-	m_CylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_CylinderMesh.nIndices = 0;
+	mesh.nVertices = size.vertexCount;
+	mesh.nIndices = size.indexCount;
+	mesh.nSegments = mainSegments;
+
+	// the half torus is the first half of the main segments
+	GLuint torusRanges[] = { 0, (mesh.nIndices / mesh.nSegments) * (mesh.nSegments / 2) };
+	OptimizeMesh(mesh, verts, indices, torusRanges, 2);
+	BuildMeshlets(mesh, verts, indices, torusRanges, 2);
+	// replace the previous mesh of the level
+	return(StoreMesh(previous, mesh, verts, indices, cacheKey));
+}
+
+///////////////////////////////////////////////////
+//	LoadTorusMesh()
+//
+//	Create a torus mesh with the passed in tube
+//  thickness and numbers of segments around the ring
+//  and around the tube, and simplified levels of it
+//  with half as many of each, down to a few.  The ring
+//  segments of the simplified levels stay even so each
+//  has a half torus.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadTorusMesh(float thickness, int mainSegments, int tubeSegments)
+{
+	float tubeRadius = .1f;
+	if (thickness <= 1.0)
+	{
+		tubeRadius = thickness;
+	}
+
+	m_torusTubeRadius = tubeRadius;
+	if (LoadPrimitive(m_TorusPrimitive, ShapeGenerator::TorusPrimitive(mainSegments, tubeSegments, tubeRadius)) == true)
+	{
+		FreeMesh(m_TorusPatches);
+		m_TorusPatches = MeshHandle();
+		TrimLodChain(m_TorusLods, 0);
+		return;
+	}
+	if (m_tessellationProgram != 0)
+	{
+		// the patches take the place of every level
+		m_TorusPatches = LoadPatches(m_TorusPatches, ShapeGenerator::TorusPatchesSize(), [&](GLfloat* vertices, GLuint* indices) {
+			ShapeGenerator::GenerateTorusPatches(tubeRadius, vertices, indices);
+		});
+		TrimLodChain(m_TorusLods, 0);
+		return;
+	}
+	FreeMesh(m_TorusPatches);
+	m_TorusPatches = MeshHandle();
+
+	mainSegments = ShapeGenerator::ValidTorusSegments(mainSegments);
+	tubeSegments = ShapeGenerator::ValidTorusSegments(tubeSegments);
+
+	int level = 0;
+	while (level < MAX_LOD_LEVELS)
+	{
+		m_TorusLods.levels[level] = LoadTorusLevel(m_TorusLods.levels[level], tubeRadius, mainSegments, tubeSegments);
+		m_TorusLods.errors[level] = ShapeGenerator::TorusError(mainSegments, tubeSegments, tubeRadius);
+		level++;
+
+		int nextMain = LodSegments(mainSegments, g_MinLodTorusSegments, true);
+		int nextTube = LodSegments(tubeSegments, g_MinLodTorusSegments, false);
+		if ((nextMain == mainSegments) && (nextTube == tubeSegments))
+		{
+			break;
+		}
+		mainSegments = nextMain;
+		tubeSegments = nextTube;
+	}
+	TrimLodChain(m_TorusLods, level);
+}
+
+///////////////////////////////////////////////////
+//	TrimLodChain()
+//
+//	Free the levels of a chain from the passed in level
+//  count on, which a previous load with more detail
+//  may have left.
+///////////////////////////////////////////////////
+void ShapeMeshes::TrimLodChain(LOD_CHAIN& chain, int levelCount)
+{
+	for (int level = levelCount; level < MAX_LOD_LEVELS; level++)
+	{
+		FreeMesh(chain.levels[level]);
+		chain.levels[level] = MeshHandle();
+		chain.errors[level] = 0.0f;
+	}
+	chain.levelCount = levelCount;
+}
+
+///////////////////////////////////////////////////
+//	SelectLodLevel()
+//
+//	Find the coarsest level of a chain whose error,
+//  projected at the current object's size on screen,
+//  fits the error budget.  The errors grow with each
+//  level, so the search stops at the first that does
+//  not fit.
+///////////////////////////////////////////////////
+int ShapeMeshes::SelectLodLevel(const LOD_CHAIN& chain) const
+{
+	// captured ranges keep full detail
+	int level = 0;
+	if ((m_lodErrorBudget > 0.0f) && (m_bCapturingMeshes == false))
+	{
+		while ((level + 1 < chain.levelCount) &&
+			(chain.errors[level + 1] * m_lodPixelsPerUnit <= m_lodErrorBudget))
+		{
+			level++;
+		}
+	}
+	return(level);
+}
+
+///////////////////////////////////////////////////
+//	DrawLod()
+//
+//	Draw the ranges of a round mesh at the level chosen
+//  for the current object.  When a simplified level is
+//  drawn, the full detail level's ranges are counted
+//  too, for the triangles saved.  Whether the ranges
+//  close the surface decides if its clusters facing
+//  away can be culled.
+///////////////////////////////////////////////////
+template <typename DRAW_RANGES>
+void ShapeMeshes::DrawLod(const LOD_CHAIN& chain, bool bClosed, DRAW_RANGES drawRanges)
+{
+	const GLMesh* fullMesh = m_meshes.Get(chain.levels[0]);
+	if (fullMesh == NULL)
+	{
+		return;
+	}
+
+	m_bDrawingClosedSurface = bClosed;
+	const GLMesh* mesh = m_meshes.Get(chain.levels[SelectLodLevel(chain)]);
+	if ((mesh == NULL) || (mesh == fullMesh))
+	{
+		drawRanges(*fullMesh);
+		m_bDrawingClosedSurface = false;
+		return;
+	}
+
+	if (m_bCountingStats == true)
+	{
+		m_bCountingFullDetail = true;
+		drawRanges(*fullMesh);
+		m_bCountingFullDetail = false;
+		m_lodStats.reducedDraws++;
+	}
+
+	m_bDrawingReducedLod = true;
+	drawRanges(*mesh);
+	m_bDrawingReducedLod = false;
+	m_bDrawingClosedSurface = false;
+}
+
+///////////////////////////////////////////////////
+//	DrawPatches()
+//
+//	Draw the ranges of a round shape's patches with
+//  the tessellation program, set for the passed in
+//  surface, then put the main program back.  The
+//  uniforms the scene sets reach both programs, so
+//  only the surface is set here.  Patches have no
+//  triangles to capture, so a capture drawing them
+//  is incomplete.
+///////////////////////////////////////////////////
+template <typename DRAW_RANGES>
+bool ShapeMeshes::DrawPatches(MeshHandle patches, int surface, float radius, DRAW_RANGES drawRanges)
+{
+	const GLMesh* mesh = m_meshes.Get(patches);
+	if ((mesh == NULL) || (m_tessellationProgram == 0))
+	{
+		return(false);
+	}
+	if (m_bCapturingMeshes == true)
+	{
+		m_bCaptureIncomplete = true;
+		return(true);
+	}
+
+	glProgramUniform1i(m_tessellationProgram, m_surfaceShapeLocation, surface);
+	glProgramUniform1f(m_tessellationProgram, m_surfaceRadiusLocation, radius);
+	glUseProgram(m_tessellationProgram);
+	glPatchParameteri(GL_PATCH_VERTICES, ShapeGenerator::PATCH_VERTICES);
+	glBindVertexArray(m_arenas[floatVertices].vao);
+
+	drawRanges(*mesh);
+
+	glUseProgram(m_mainProgram);
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	DrawPatchRange()
+//
+//	Draw a range of the patches of a mesh, from the
+//  passed in first index for the passed in number of
+//  indices.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPatchRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount)
+{
+	glDrawElementsBaseVertex(GL_PATCHES, indexCount, mesh.indexType,
+		(void*)(size_t)(mesh.indexOffset + (firstIndex * IndexSize(mesh))), (GLint)mesh.firstVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawPrimitive()
+//
+//	Draw the ranges of a shape's vertices with the
+//  bufferless program, which is told the shape in its
+//  uniforms, then put the main program back.  While
+//  batching, the ranges are only collected, and a
+//  capture drawing them is incomplete.
+///////////////////////////////////////////////////
+template <typename DRAW_RANGES>
+bool ShapeMeshes::DrawPrimitive(const ShapeGenerator::PRIMITIVE& primitive, DRAW_RANGES drawRanges)
+{
+	if ((m_bufferlessProgram == 0) || (primitive.type == ShapeGenerator::noPrimitive))
+	{
+		return(false);
+	}
+	if (m_bCapturingMeshes == true)
+	{
+		m_bCaptureIncomplete = true;
+		return(true);
+	}
+	if (m_bBatchingDraws == true)
+	{
+		drawRanges();
+		return(true);
+	}
+
+	if (m_primitiveVao == 0)
+	{
+		glGenVertexArrays(1, &m_primitiveVao);
+	}
+	glProgramUniform1i(m_bufferlessProgram, m_primitiveCountLocation, 0);
+	glProgramUniform4i(m_bufferlessProgram, m_primitiveShapeLocation, primitive.type, primitive.segmentsA, primitive.segmentsB, 0);
+	glProgramUniform1f(m_bufferlessProgram, m_primitiveParameterLocation, primitive.parameter);
+	glUseProgram(m_bufferlessProgram);
+	glBindVertexArray(m_primitiveVao);
+
+	drawRanges();
+
+	glUseProgram(m_mainProgram);
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	DrawPrimitiveRange()
+//
+//	Draw a range of the vertices of a shape, whose
+//  numbers are all the vertex shader needs, or add it
+//  to the batch's draw while batching.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPrimitiveRange(const ShapeGenerator::PRIMITIVE& primitive, GLint firstVertex, GLsizei vertexCount)
+{
+	if (m_bBatchingDraws == true)
+	{
+		AddPrimitiveRecord(m_batchPrimitives, primitive, firstVertex, vertexCount, glm::mat4(1.0f));
+		return;
+	}
+	glDrawArrays(GL_TRIANGLES, firstVertex, vertexCount);
+}
 
-	// Create VAO
-	glGenVertexArrays(1, &m_CylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_CylinderMesh.vao);
+///////////////////////////////////////////////////
+//	AddPrimitiveRecord()
+//
+//	Add a range of a shape to a draw of several, with
+//  its vertices following those of the shape before.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddPrimitiveRecord(
+	std::vector<PRIMITIVE_RECORD>& records,
+	const ShapeGenerator::PRIMITIVE& primitive,
+	GLint firstVertex,
+	GLsizei vertexCount,
+	const glm::mat4& model)
+{
+	PRIMITIVE_RECORD record = {};
+	record.shape[0] = primitive.type;
+	record.shape[1] = primitive.segmentsA;
+	record.shape[2] = primitive.segmentsB;
+	record.range[0] = (records.size() > 0) ? records.back().range[0] + records.back().range[2] : 0;
+	record.range[1] = firstVertex;
+	record.range[2] = vertexCount;
+	record.parameters[0] = primitive.parameter;
+	record.model = model;
+	records.push_back(record);
+}
 
-	// Create VBO
-	glGenBuffers(1, m_CylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_CylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+///////////////////////////////////////////////////
+//	DrawPrimitiveRecords()
+//
+//	Draw every shape of the records with one draw of
+//  all of their vertices.  The records go up in one
+//  storage buffer, and the vertex shader finds the
+//  record each vertex belongs to by its number.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPrimitiveRecords(const std::vector<PRIMITIVE_RECORD>& records)
+{
+	if ((m_bufferlessProgram == 0) || (records.size() == 0))
+	{
+		return;
+	}
 
-	if (m_bMemoryLayoutDone == false)
+	if (m_primitiveVao == 0)
+	{
+		glGenVertexArrays(1, &m_primitiveVao);
+	}
+	if (m_primitiveBuffer == 0)
 	{
-		SetShaderMemoryLayout();
+		glGenBuffers(1, &m_primitiveBuffer);
 	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_primitiveBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(PRIMITIVE_RECORD) * records.size(), records.data(), GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_PrimitiveRecordBinding, m_primitiveBuffer);
+
+	const PRIMITIVE_RECORD& last = records.back();
+	glProgramUniform1i(m_bufferlessProgram, m_primitiveCountLocation, (GLint)records.size());
+	glUseProgram(m_bufferlessProgram);
+	glBindVertexArray(m_primitiveVao);
+	glDrawArrays(GL_TRIANGLES, 0, last.range[0] + last.range[2]);
+	glUseProgram(m_mainProgram);
 }
 
 ///////////////////////////////////////////////////
-//	LoadPlaneMesh()
-//
-//	Create a plane mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-// 
-//  Correct triangle drawing command:
+//	DrawPrimitives()
 //
-//	glDrawElements(GL_TRIANGLES, meshes.gPlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+//	Draw shapes of any types, each placed by its own
+//  transform, with one draw of the bufferless program.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadPlaneMesh()
+void ShapeMeshes::DrawPrimitives(const PRIMITIVE_INSTANCE* instances, int count)
 {
-	// Vertex data
-	GLfloat verts[] = {
-		// Vertex Positions		// Normals			// Texture coords	// Index
-		-1.0f, 0.0f, 1.0f,		0.0f, 1.0f, 0.0f,	0.0f, 0.0f,			//0
-		1.0f, 0.0f, 1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 0.0f,			//1
-		1.0f,  0.0f, -1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 1.0f,			//2
-		-1.0f, 0.0f, -1.0f,		0.0f, 1.0f, 0.0f,	0.0f, 1.0f,			//3
-	};
-
-	// Index data
-	GLuint indices[] = {
-		0,1,2,
-		0,3,2
-	};
-
-	// store vertex and index count
-	m_PlaneMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_PlaneMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
-
-	// Generate the VAO for the mesh
-	glGenVertexArrays(1, &m_PlaneMesh.vao);
-	glBindVertexArray(m_PlaneMesh.vao);	// activate the VAO
-
-	// Create VBOs for the mesh
-	glGenBuffers(2, m_PlaneMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PlaneMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_PlaneMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
+	m_drawPrimitives.clear();
+	for (int i = 0; i < count; i++)
 	{
-		SetShaderMemoryLayout();
+		const ShapeGenerator::PRIMITIVE& shape = instances[i].shape;
+		AddPrimitiveRecord(m_drawPrimitives, shape, 0, ShapeGenerator::PrimitiveVertexCount(shape), instances[i].model);
 	}
+	DrawPrimitiveRecords(m_drawPrimitives);
 }
 
 ///////////////////////////////////////////////////
-//	LoadPrismMesh()
-//
-//	Create a prism mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//	Correct triangle drawing command:
+//	BeginMeshCapture()
 //
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPrismMesh.nVertices);
+//	Start recording the triangle ranges the draw
+//  methods draw instead of drawing them.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadPrismMesh()
+void ShapeMeshes::BeginMeshCapture()
 {
-	// Vertex data
-	GLfloat verts[] = {
-		//Positions				//Normals
-		// ------------------------------------------------------
-
-		//Back Face				//Negative Z Normal  
-		0.5f, 0.5f, -0.5f,		0.0f,  0.0f, -1.0f,		0.0f, 1.0f,
-		0.5f, -0.5f, -0.5f,		0.0f,  0.0f, -1.0f,		0.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f,	0.0f,  0.0f, -1.0f,		1.0f, 0.0f,
-		0.5f, 0.5f, -0.5f,		0.0f,  0.0f, -1.0f,		0.0f, 1.0f,
-		0.5f,  0.5f, -0.5f,		0.0f,  0.0f, -1.0f,		0.0f, 1.0f,
-		-0.5f,  0.5f, -0.5f,	0.0f,  0.0f, -1.0f,		1.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f,	0.0f,  0.0f, -1.0f,		1.0f, 0.0f,
-		0.5f,  0.5f, -0.5f,		0.0f,  0.0f, -1.0f,		0.0f, 1.0f,
-
-		//Bottom Face			//Negative Y Normal
-		0.5f, -0.5f, -0.5f,		0.0f, -1.0f,  0.0f,		0.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f,	0.0f, -1.0f,  0.0f,		1.0f, 0.0f,
-		0.0f, -0.5f,  0.5f,		0.0f, -1.0f,  0.0f,		0.5f, 1.0f,
-		-0.5f, -0.5f,  -0.5f,	0.0f, -1.0f,  0.0f,		0.0f, 0.0f,
-
-		//Left Face/slanted		//Normals
-		-0.5f, -0.5f, -0.5f,	0.894427180f,  0.0f,  -0.447213590f,	0.0f, 0.0f,
-		-0.5f, 0.5f,  -0.5f,	0.894427180f,  0.0f,  -0.447213590f,	0.0f, 1.0f,
-		0.0f, 0.5f,  0.5f,		0.894427180f,  0.0f,  -0.447213590f,	1.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f,	0.894427180f,  0.0f,  -0.447213590f,	0.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f,	0.894427180f,  0.0f,  -0.447213590f,	0.0f, 0.0f,
-		0.0f, -0.5f,  0.5f,		0.894427180f,  0.0f,  -0.447213590f,	1.0f, 0.0f,
-		0.0f, 0.5f,  0.5f,		0.894427180f,  0.0f,  -0.447213590f,	1.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f,	0.894427180f,  0.0f,  -0.447213590f,	0.0f, 0.0f,
-
-		//Right Face/slanted	//Normals
-		0.0f, 0.5f, 0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		0.0f, 1.0f,
-		0.5f, 0.5f, -0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		1.0f, 1.0f,
-		0.5f, -0.5f, -0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		1.0f, 0.0f,
-		0.0f, 0.5f, 0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		0.0f, 1.0f,
-		0.0f, 0.5f, 0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		0.0f, 1.0f,
-		0.0f, -0.5f, 0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		0.0f, 0.0f,
-		0.5f, -0.5f, -0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		1.0f, 0.0f,
-		0.0f, 0.5f, 0.5f,		-0.894427180f,  0.0f,  -0.447213590f,		0.0f, 1.0f,
-
-		//Top Face				//Positive Y Normal		//Texture Coords.
-		0.5f, 0.5f, -0.5f,		0.0f,  1.0f,  0.0f,		0.0f, 0.0f,
-		0.0f,  0.5f,  0.5f,		0.0f,  1.0f,  0.0f,		0.5f, 1.0f,
-		-0.5f,  0.5f, -0.5f,	0.0f,  1.0f,  0.0f,		1.0f, 0.0f,
-		0.5f, 0.5f, -0.5f,		0.0f,  1.0f,  0.0f,		0.0f, 0.0f,
-
-	};
-
-	m_PrismMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_PrismMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_PrismMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(1, m_PrismMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PrismMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	m_bCapturingMeshes = true;
+	m_bCaptureIncomplete = false;
+	m_capturedRanges.clear();
 }
 
 ///////////////////////////////////////////////////
-//	LoadPyramid3Mesh()
-//
-//	Create a 3-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
-//
-//  Correct triangle drawing command:
+//	EndMeshCapture()
 //
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, gPyramid3Mesh.nVertices);
+//	Stop recording.  Returns false if a shape with no
+//  stored triangles was drawn while capturing.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadPyramid3Mesh()
+bool ShapeMeshes::EndMeshCapture()
 {
-	// Vertex data
-	GLfloat verts[] = {
-		// Vertex Positions		// Normals			// Texture coords
-		//left side
-		0.0f, 0.5f, 0.0f,		-0.894427180f, 0.0f, -0.447213590f,	0.5f, 1.0f,		//top point	
-		0.0f, -0.5f, -0.5f,		-0.894427180f, 0.0f, -0.447213590f,	0.0f, 0.0f,		//back center
-		-0.5f, -0.5f, 0.5f,		-0.894427180f, 0.0f, -0.447213590f,	1.0f, 0.0f,     //front bottom left
-		0.0f, 0.5f, 0.0f,		-0.894427180f, 0.0f, -0.447213590f,	0.5f, 1.0f,		//top point	
-		//right side
-		0.0f, 0.5f, 0.0f,		0.894427180f, 0.0f, -0.447213590f,	0.5f, 1.0f,		//top point	
-		0.5f, -0.5f, 0.5f,		0.894427180f, 0.0f, -0.447213590f,	0.0f, 0.0f,     //front bottom right
-		0.0f, -0.5f, -0.5f,		0.894427180f, 0.0f, -0.447213590f,	1.0f, 0.0f,		//back center	
-		0.0f, 0.5f, 0.0f,		0.894427180f, 0.0f, -0.447213590f,	0.5f, 1.0f,		//top point	
-		//front side
-		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,	0.5f, 1.0f,		//top point			
-		-0.5f, -0.5f, 0.5f,		0.0f, 0.0f, 1.0f,	0.0f, 0.0f,     //front bottom left	
-		0.5f, -0.5f, 0.5f,		0.0f, 0.0f, 1.0f,	1.0f, 0.0f,     //front bottom right
-		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,	0.5f, 1.0f,		//top point	
-		//bottom side
-		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
-		0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	1.0f, 1.0f,     //front bottom right
-		0.0f, -0.5f, -0.5f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,		//back center	
-		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
-	};
-
-	// Calculate total defined vertices
-	m_Pyramid3Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid3Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid3Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid3Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid3Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	m_bCapturingMeshes = false;
+	m_capturedRanges.clear();
+	return(m_bCaptureIncomplete == false);
 }
 
 ///////////////////////////////////////////////////
-//	LoadPyramid4Mesh()
-//
-//	Create a 4-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
+//	TakeCapturedRanges()
 //
-//  Correct triangle drawing command:
-//
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPyramid4Mesh.nVertices);
+//	Move the ranges recorded since the last call into
+//  the passed in list, after what it has.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadPyramid4Mesh()
+void ShapeMeshes::TakeCapturedRanges(std::vector<CAPTURED_RANGE>& ranges)
 {
-	// Vertex data
-	GLfloat verts[] = {
-		// Vertex Positions		// Normals			// Texture coords
-		//bottom side
-		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
-		-0.5f, -0.5f, -0.5f,	0.0f, -1.0f, 0.0f,	0.0f, 0.0f,		//back bottom left
-		0.5f, -0.5f, -0.5f,		0.0f, -1.0f, 0.0f,	1.0f, 0.0f,		//back bottom right	
-		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
-		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
-		0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	1.0f, 1.0f,     //front bottom right
-		0.5f, -0.5f, -0.5f,		0.0f, -1.0f, 0.0f,	1.0f, 0.0f,		//back bottom right	
-		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
-		//back side
-		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, -1.0f,	0.5f, 1.0f,		//top point	
-		0.5f, -0.5f, -0.5f,		0.0f, 0.0f, -1.0f,	0.0f, 0.0f,		//back bottom right	
-		-0.5f, -0.5f, -0.5f,	0.0f, 0.0f, -1.0f,	1.0f, 0.0f,		//back bottom left
-		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, -1.0f,	0.5f, 1.0f,		//top point	
-		//left side
-		0.0f, 0.5f, 0.0f,		-1.0f, 0.0f, 0.0f,	0.5f, 1.0f,		//top point	
-		-0.5f, -0.5f, -0.5f,	-1.0f, 0.0f, 0.0f,	0.0f, 0.0f,		//back bottom left	
-		-0.5f, -0.5f, 0.5f,		-1.0f, 0.0f, 0.0f,	1.0f, 0.0f,     //front bottom left
-		0.0f, 0.5f, 0.0f,		-1.0f, 0.0f, 0.0f,	0.5f, 1.0f,		//top point	
-		//right side
-		0.0f, 0.5f, 0.0f,		1.0f, 0.0f, 0.0f,	0.5f, 1.0f,		//top point	
-		0.5f, -0.5f, 0.5f,		1.0f, 0.0f, 0.0f,	0.0f, 0.0f,     //front bottom right
-		0.5f, -0.5f, -0.5f,		1.0f, 0.0f, 0.0f,	1.0f, 0.0f,		//back bottom right	
-		0.0f, 0.5f, 0.0f,		1.0f, 0.0f, 0.0f,	0.5f, 1.0f,		//top point	
-		//front side
-		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,	0.5f, 1.0f,		//top point			
-		-0.5f, -0.5f, 0.5f,		0.0f, 0.0f, 1.0f,	0.0f, 0.0f,     //front bottom left	
-		0.5f, -0.5f, 0.5f,		0.0f, 0.0f, 1.0f,	1.0f, 0.0f,     //front bottom right
-		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,	0.5f, 1.0f,		//top point
-	};
-
-	// Calculate total defined vertices
-	m_Pyramid4Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid4Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid4Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid4Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid4Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	ranges.insert(ranges.end(), m_capturedRanges.begin(), m_capturedRanges.end());
+	m_capturedRanges.clear();
 }
 
 ///////////////////////////////////////////////////
-//	LoadSphereMesh()
-//
-//	Create a sphere mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//  Correct triangle drawing command:
+//	CaptureIndexRange()
 //
-//	glDrawElements(GL_TRIANGLES, meshes.gSphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-///////////////////////////////////////////////////
-void ShapeMeshes::LoadSphereMesh()
-{
-	GLfloat verts[] = {
-		// vertex data					// texture coords			// index
-		// top center point
-		0.0f, 1.0f, 0.0f,				0.5f, 1.0f,					//0
-		// ring 1
-		0.0f, 0.9808f, 0.1951f,			0.5f, 0.9375f,				//1
-		0.0747f, 0.9808f, 0.1802f,		0.51219375f, 0.9375f,		//2
-		0.1379f, 0.9808f, 0.1379f,		0.5243875f, 0.9375f,		//3
-		0.1802f, 0.9808f, 0.0747f,		0.53658125f, 0.9375f,		//4
-		0.1951f, 0.9808, 0.0f,			0.548775f, 0.9375f,			//5
-		0.1802f, 0.9808f, -0.0747f,		0.56096875f, 0.9375f,		//6
-		0.1379f, 0.9808f, -0.1379f,		0.5731625f, 0.9375f,		//7
-		0.0747f, 0.9808f, -0.1802f,		0.58535625f, 0.9375f,		//8
-		0.0f, 0.9808f, -0.1951f,		0.59755f, 0.9375f,			//9 - seam
-		0.0f, 0.9808f, -0.1951f,		0.40245f, 0.9375f,			//10 - seam
-		-0.0747f, 0.9808f, -0.1802f,	0.41464375f, 0.9375f,		//11
-		-0.1379f, 0.9808f, -0.1379f,	0.4268375f, 0.9375f,		//12
-		-0.1802f, 0.9808f, -0.0747f,	0.43903125f, 0.9375f,		//13
-		-0.1951f, 0.9808, 0.0f,			0.451225f, 0.9375f,			//14
-		-0.1802f, 0.9808f, 0.0747f,		0.46341875f, 0.9375f,		//15
-		-0.1379f, 0.9808f, 0.1379f,		0.4756125f, 0.9375f,		//16
-		-0.0747f, 0.9808f, 0.1802f,		0.48780625f, 0.9375f,		//17
-		// ring 2
-		0.0f, 0.9239f, 0.3827f,			0.5f, 0.875f,				//18
-		0.1464f, 0.9239f, 0.3536f,		0.52391875f, 0.875f,		//19
-		0.2706f, 0.9239f, 0.2706f,		0.5478375f, 0.875f,			//20
-		0.3536f, 0.9239f, 0.1464f,		0.57175625f, 0.875f,		//21
-		0.3827f, 0.9239f, 0.0f,			0.5956755f, 0.875f,			//22
-		0.3536f, 0.9239f, -0.1464f,		0.61959425f, 0.875f,		//23
-		0.2706f, 0.9239f, -0.2706f,		0.643513f, 0.875f,			//24
-		0.1464f, 0.9239f, -0.3536f,		0.66743175f, 0.875f,		//25
-		0.0f, 0.9239f, -0.3827f,		0.6913505f, 0.875f,			//26 - seam
-		0.0f, 0.9239f, -0.3827f,		0.3086495f, 0.875f,			//27 - seam
-		-0.1464f, 0.9239f, -0.3536f,	0.33256825f, 0.875f,		//28
-		-0.2706f, 0.9239f, -0.2706f,	0.356487f, 0.875f,			//29
-		-0.3536f, 0.9239f, -0.1464f,	0.38040575f, 0.875f,		//30
-		-0.3827f, 0.9239f, 0.0f,		0.4043245f, 0.875f,			//31
-		-0.3536f, 0.9239f, 0.1464f,		0.42824325f, 0.875f,		//32
-		-0.2706f, 0.9239f, 0.2706f,		0.452162f, 0.875f,			//33
-		-0.1464f, 0.9239f, 0.3536f,		0.47608075f, 0.875f,		//34
-		// ring 3
-		0.0f, 0.8315f, 0.5556f,			0.5f, 0.8125f,				//35
-		0.2126f, 0.8315f, 0.5133f,		0.534725f, 0.8125f,			//36
-		0.3928f, 0.8315f, 0.3928f,		0.56945f, 0.8125f,			//37
-		0.5133f, 0.8315f, 0.2126f,		0.604175f, 0.8125f,			//38
-		0.5556f, 0.8315f, 0.0f,			0.6389f, 0.8125f,			//39
-		0.5133f, 0.8315f, -0.2126f,		0.673625f, 0.8125f,			//40
-		0.3928f, 0.8315f, -0.3928f,		0.70835f, 0.8125f,			//41
-		0.2126f, 0.8315f, -0.5133f,		0.743075f, 0.8125f,			//42
-		0.0f, 0.8315f, -0.5556f,		0.7778f, 0.8125f,			//43 - seam
-		0.0f, 0.8315f, -0.5556f,		0.2222f, 0.8125f,			//44 - seam
-		-0.2126f, 0.8315f, -0.5133f,	0.256925f, 0.8125f,			//45
-		-0.3928f, 0.8315f, -0.3928f,	0.29165f, 0.8125f,			//46
-		-0.5133f, 0.8315f, -0.2126f,	0.326375f, 0.8125f,			//47
-		-0.5556f, 0.8315f, 0.0f,		0.3611f, 0.8125f,			//48
-		-0.5133f, 0.8315f, 0.2126f,		0.395825f, 0.8125f,			//49
-		-0.3928f, 0.8315f, 0.3928f,		0.43055f, 0.8125f,			//50
-		-0.2126f, 0.8315f, 0.5133f,		0.465275f, 0.8125f,			//51
-		// ring 4
-		0.0f, 0.7071f, 0.7071f,			0.5f, 0.75f,				//52
-		0.2706f, 0.7071f, 0.6533f,		0.54419375f, 0.75f,			//53
-		0.5f, 0.7071f, 0.5f,			0.5883875f, 0.75f,			//54
-		0.6533f, 0.7071f, 0.2706f,		0.63258125f, 0.75f,			//55
-		0.7071f, 0.7071f, 0.0f,			0.676775f, 0.75f,			//56
-		0.6533f, 0.7071f, -0.2706f,		0.72096875f, 0.75f,			//57
-		0.5f, 0.7071f, -0.5f,			0.7651625f, 0.75f,			//58
-		0.2706f, 0.7071f, -0.6533f,		0.80935625f, 0.75f,			//59
-		0.0f, 0.7071f, -0.7071f,		0.85355f, 0.75f,			//60 - seam
-		0.0f, 0.7071f, -0.7071f,		0.14645f, 0.75f,			//61 - seam
-		-0.2706f, 0.7071f, -0.6533f,	0.19064375f, 0.75f,			//62
-		-0.5f, 0.7071f, -0.5f,			0.2348375f, 0.75f,			//63
-		-0.6533f, 0.7071f, -0.2706f,	0.27903135f, 0.75f,			//64
-		-0.7071f, 0.7071f, 0.0f,		0.323225f, 0.75f,			//65
-		-0.6533f, 0.7071f, 0.2706f,		0.36741875f, 0.75f,			//66
-		-0.5f, 0.7071f, 0.5f,			0.4116125f, 0.75f,			//67
-		-0.2706f, 0.7071f, 0.6533f,		0.45580625f, 0.75f,			//68
-		// ring 5
-		0.0f, 0.5556f, 0.8315f,			0.5f, 0.6875f,				//69
-		0.3182f, 0.5556f, 0.7682f,		0.55196875f, 0.6875f,		//70
-		0.5879f, 0.5556f, 0.5879f,		0.6039375f, 0.6875f,		//71
-		0.7682f, 0.5556f, 0.3182f,		0.65590625f, 0.6875f,		//72
-		0.8315f, 0.5556f, 0.0f,			0.707875f, 0.6875f,			//73
-		0.7682f, 0.5556f, -0.3182f,		0.75984375f, 0.6875f,		//74
-		0.5879f, 0.5556f, -0.5879f,		0.8118125f, 0.6875f,		//75
-		0.3182f, 0.5556f, -0.7682f,		0.86378125f, 0.6875f,		//76
-		0.0f, 0.5556f, -0.8315f,		0.91575f, 0.6875f,			//77 - seam
-		0.0f, 0.5556f, -0.8315f,		0.08425f, 0.6875f,			//78 - seam
-		-0.3182f, 0.5556f, -0.7682f,	0.13621875f, 0.6875f,		//79
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.6875f,		//80
-		-0.7682f, 0.5556f, -0.3182f,	0.24015625f, 0.6875f,		//81
-		-0.8315f, 0.5556f, 0.0f,		0.292125f, 0.6875f,			//82
-		-0.7682f, 0.5556f, 0.3182f,		0.34409375f, 0.6875f,		//83
-		-0.5879f, 0.5556f, 0.5879f,		0.3960625f, 0.6875f,		//84
-		-0.3182f, 0.5556f, 0.7682f,		0.44803125f, 0.6875f,		//85
-		//ring 6
-		0.0f, 0.3827f, 0.9239f,			0.5f, 0.625f,				//86
-		0.3536f, 0.3827f, 0.8536f,		0.55774375f, 0.625f,		//87
-		0.6533f, 0.3827f, 0.6533f,		0.6154875f, 0.625f,			//88
-		0.8536f, 0.3827f, 0.3536f,		0.67323125f, 0.625f,		//89
-		0.9239f, 0.3827f, 0.0f,			0.730975f, 0.625f,			//90
-		0.8536f, 0.3827f, -0.3536f,		0.78871875f, 0.625f,		//91
-		0.6533f, 0.3827f, -0.6533f,		0.8464625f, 0.625f,			//92
-		0.3536f, 0.3827f, -0.8536f,		0.90420625f, 0.625f,		//93
-		0.0f, 0.3827f, -0.9239f,		0.96195f, 0.625f,			//94 - seam
-		0.0f, 0.3827f, -0.9239f,		0.03805f, 0.625f,			//95 - seam
-		-0.3536f, 0.3827f, -0.8536f,	0.09579375f, 0.625f,		//96
-		-0.6533f, 0.3827f, -0.6533f,	0.1535375f, 0.625f,			//97
-		-0.8536f, 0.3827f, -0.3536f,	0.21128125f, 0.625f,		//98
-		-0.9239f, 0.3827f, 0.0f,		0.269025f, 0.625f,			//99
-		-0.8536f, 0.3827f, 0.3536f,		0.32676875f, 0.625f,		//100
-		-0.6533f, 0.3827f, 0.6533f,		0.3845125f, 0.625f,			//101
-		-0.3536f, 0.3827f, 0.8536f,		0.44225625f, 0.625f,		//102
-		// ring 7
-		0.0f, 0.1951f, 0.9808f,			0.5f, 0.5625f,				//103
-		0.3753f, 0.1915f, 0.9061f,		0.5613f, 0.5625f,			//104
-		0.6935f, 0.1915f, 0.6935f,		0.6226f, 0.5625f,			//105
-		0.9061f, 0.1915f, 0.3753f,		0.6839f, 0.5625f,			//106
-		0.9808f, 0.1915f, 0.0f,			0.7452f, 0.5625f,			//107
-		0.9061f, 0.1915f, -0.3753f,		0.8065f, 0.5625f,			//108
-		0.6935f, 0.1915f, -0.6935f,		0.8678f, 0.5625f,			//109
-		0.3753f, 0.1915f, -0.9061f,		0.9291f, 0.5625f,			//110
-		0.0f, 0.1915f, -0.9808f,		0.9904f, 0.5625f,			//111 - seam
-		0.0f, 0.1915f, -0.9808f,		0.0096f, 0.5625f,			//112 - seam
-		-0.3753f, 0.1915f, -0.9061f,	0.0709f, 0.5625f,			//113
-		-0.6935f, 0.1915f, -0.6935f,	0.1322f, 0.5625f,			//114
-		-0.9061f, 0.1915f, -0.3753f,	0.1935f, 0.5625f,			//115
-		-0.9808f, 0.1915f, 0.0f,		0.2548f, 0.5625f,			//116
-		-0.9061f, 0.1915f, 0.3753f,		0.3161f, 0.5625f,			//117
-		-0.6935f, 0.1915f, 0.6935f,		0.3774f, 0.5625f,			//118
-		-0.3753f, 0.1915f, 0.9061f,		0.4387f, 0.5625f,			//119
-		// ring 8
-		0.0f, 0.0f, 1.0f,				0.5f, 0.5f,					//120
-		0.3827f, 0.0f, 0.9239f,			0.5625f, 0.5f,				//121
-		0.7071f, 0.0f, 0.7071f,			0.625f, 0.5f,				//122
-		0.9239f, 0.0f, 0.3827f,			0.6875f, 0.5f,				//123
-		1.0f, 0.0f, 0.0f,				0.75f, 0.5f,				//124
-		0.9239f, 0.0f, -0.3827f,		0.8125f, 0.5f,				//125
-		0.7071f, 0.0f, -0.7071f,		0.875f, 0.5f,				//126
-		0.3827f, 0.0f, -0.9239f,		0.9375f, 0.5f,				//127
-		0.0f, 0.0f, -1.0f,				1.0f, 0.5f,					//128 - seam
-		0.0f, 0.0f, -1.0f, 				0.0f, 0.5f,					//129 - seam
-		-0.3827f, 0.0f, -0.9239f,		0.0625f, 0.5f,				//130
-		-0.7071f, 0.0f, -0.7071f,		0.125f, 0.5f,				//131
-		-0.9239f, 0.0f, -0.3827f,		0.1875f, 0.5f,				//132
-		-1.0f, 0.0f, 0.0f,				0.25f, 0.5f,				//133
-		-0.9239f, 0.0f, 0.3827f,		0.3125f, 0.5f,				//134
-		-0.7071, 0.0, 0.7071f,			0.375f, 0.5f,				//135
-		-0.3827f, 0.0f, 0.9239f,		0.4375f, 0.5f,				//136
-		// ring 9
-		0.0f, -0.1915f, 0.9808f,		0.5f, 0.4375f,				//137
-		0.3753f, -0.1915f, 0.9061f,		0.5613f, 0.4375f,			//138
-		0.6935f, -0.1915f, 0.6935f,		0.6226f, 0.4375f,			//139
-		0.9061f, -0.1915f, 0.3753f,		0.6839f, 0.4375f,			//140
-		0.9808f, -0.1915f, 0.0f,		0.7452f, 0.4375f,			//141
-		0.9061f, -0.1915f, -0.3753f,	0.8065f, 0.4375f,			//142
-		0.6935f, -0.1915f, -0.6935f,	0.8678f, 0.4375f,			//143
-		0.3753f, -0.1915f, -0.9061f,	0.9261f, 0.4375f,			//144
-		0.0f, -0.1915f, -0.9808f,		0.9904f, 0.4375f,			//145 - seam
-		0.0f, -0.1915f, -0.9808f,		0.0096f, 0.4375f,			//146 - seam
-		-0.3753f, -0.1915f, -0.9061f,	0.0709f, 0.4375f,			//147
-		-0.6935f, -0.1915f, -0.6935f,	0.1322f, 0.4375f,			//148
-		-0.9061f, -0.1915f, -0.3753f,	0.1935f, 0.4375f,			//149
-		-0.9808f, -0.1915f, 0.0f,		0.2548f, 0.4375f,			//150
-		-0.9061f, -0.1915f, 0.3753f,	0.3161f, 0.4375f,			//151
-		-0.6935f, -0.1915f, 0.6935f,	0.3774f, 0.4375f,			//152
-		-0.3753f, -0.1915f, 0.9061f,	0.4387f, 0.4375f,			//153
-		// ring 10
-		0.0f, -0.3827f, 0.9239f,		0.5f, 0.375f,				//154
-		0.3536f, -0.3827f, 0.8536f,		0.55774375f, 0.375f,		//155
-		0.6533f, -0.3827f, 0.6533f,		0.6154875f, 0.375f,			//156
-		0.8536f, -0.3827f, 0.3536f,		0.67323125f, 0.375f,		//157
-		0.9239f, -0.3827f, 0.0f,		0.730975f, 0.375f,			//158
-		0.8536f, -0.3827f, -0.3536f,	0.78871875f, 0.375f,		//159
-		0.6533f, -0.3827f, -0.6533f,	0.8464625f, 0.375f,			//160
-		0.3536f, -0.3827f, -0.8536f,	0.90420625f, 0.375f,		//161
-		0.0f, -0.3827f, -0.9239f,		0.96195f, 0.375f,			//162 - seam
-		0.0f, -0.3827f, -0.9239f,		0.03805f, 0.375f,			//163 - seam
-		-0.3536f, -0.3827f, -0.8536f,	0.09579375f, 0.375f,		//164
-		-0.6533f, -0.3827f, -0.6533f,	0.1535375f, 0.375f,			//165
-		-0.8536f, -0.3827f, -0.3536f,	0.21128125f, 0.375f,		//166
-		-0.9239f, -0.3827f, 0.0f,		0.269025f, 0.375f,			//167
-		-0.8536f, -0.3827f, 0.3536f,	0.32676875f, 0.375f,		//168
-		-0.6533f, -0.3827f, 0.6533f,	0.3845125f, 0.375f,			//169
-		-0.3536f, -0.3827f, 0.8536f,	0.44225625f, 0.375f,		//170
-		// ring 11
-		0.0f, -0.5556f, 0.8315f,		0.5f, 0.3125f,				//171
-		0.3182f, -0.5556f, 0.7682f,		0.55196875f, 0.3125f,		//172
-		0.5879f, -0.5556f, 0.5879f,		0.6039375f, 0.3125f,		//173
-		0.7682f, -0.5556f, 0.3182f,		0.65590625f, 0.3125f,		//174
-		0.8315f, -0.5556f, 0.0f,		0.707875f, 0.3125f,			//175
-		0.7682f, -0.5556f, -0.3182f,	0.75984375f, 0.3125f,		//176
-		0.5879f, -0.5556f, -0.5879f,	0.8118125f, 0.3125f,		//177
-		0.3182f, -0.5556f, -0.7682f,	0.86378125f, 0.3125f,		//178
-		0.0f, -0.5556f, -0.8315f,		0.91575f, 0.3125f,			//179 - seam
-		0.0f, -0.5556f, -0.8315f,		0.08425f, 0.3125f,			//180 - seam
-		-0.3182f, -0.5556f, -0.7682f,	0.13621875f, 0.3125f,		//181
-		-0.5879f, -0.5556f, -0.5879f,	0.1881875f, 0.3125f,		//182
-		-0.7682f, -0.5556f, -0.3182f,	0.24015625f, 0.3125f,		//183
-		-0.8315f, -0.5556f, 0.0f,		0.292125f, 0.3125f,			//184
-		-0.7682f, -0.5556f, 0.3182f,	0.34409375f, 0.3125f,		//185
-		-0.5879f, -0.5556f, 0.5879f,	0.3960625f, 0.3125f,		//186
-		-0.3182f, -0.5556f, 0.7682f,	0.44803125f, 0.3125f,		//187
-		// ring 12
-		0.0f, -0.7071f, 0.7071f,		0.5f, 0.25f,				//188
-		0.2706f, -0.7071f, 0.6533f,		0.54419375f, 0.25f,			//189
-		0.5f, -0.7071f, 0.5f,			0.5883875f, 0.25f,			//190
-		0.6533f, -0.7071f, 0.2706f,		0.63258125f, 0.25f,			//191
-		0.7071f, -0.7071f, 0.0f,		0.676775f, 0.25f,			//192
-		0.6533f, -0.7071f, -0.2706f,	0.72096875f, 0.25f,			//193
-		0.5f, -0.7071f, -0.5f,			0.7651625f, 0.25f,			//194
-		0.2706f, -0.7071f, -0.6533f,	0.80935625f, 0.25f,			//195
-		0.0f, -0.7071f, -0.7071f,		0.85355f, 0.25f,			//196 - seam
-		0.0f, -0.7071f, -0.7071f,		0.14645f, 0.25f,			//197 - seam
-		-0.2706f, -0.7071f, -0.6533f,	0.19064375f, 0.25f,			//198
-		-0.5f, -0.7071f, -0.5f,			0.2348375f, 0.25f,			//199
-		-0.6533f, -0.7071f, -0.2706f,	0.27903135f, 0.25f,			//200
-		-0.7071f, -0.7071f, 0.0f,		0.323225f, 0.25f,			//201
-		-0.6533f, -0.7071f, 0.2706f,	0.36741875f, 0.25f,			//202
-		-0.5f, -0.7071f, 0.5f,			0.4116125f, 0.25f,			//203
-		-0.2706f, -0.7071f, 0.6533f,	0.45580625f, 0.25f,			//204
-		// ring 13
-		0.0f, -0.8315f, 0.5556f,		0.5f, 0.1875f,				//205
-		0.2126f, -0.8315f, 0.5133f,		0.534725f, 0.1875f,			//206
-		0.3928f, -0.8315f, 0.3928f,		0.56945f, 0.1875f,			//207
-		0.5133f, -0.8315f, 0.2126f,		0.604175f, 0.1875f,			//208
-		0.5556f, -0.8315f, 0.0f,		0.6389f, 0.1875f,			//209
-		0.5133f, -0.8315f, -0.2126f,	0.673625f, 0.1875f,			//210
-		0.3928f, -0.8315f, -0.3928f,	0.70835f, 0.1875f,			//211
-		0.2126f, -0.8315f, -0.5133f,	0.743075f, 0.1875f,			//212
-		0.0f, -0.8315f, -0.5556f,		0.7778f, 0.1875f,			//213 - seam
-		0.0f, -0.8315f, -0.5556f,		0.2222f, 0.1875f,			//214 - seam
-		-0.2126f, -0.8315f, -0.5133f,	0.256925f, 0.1875f,			//215
-		-0.3928f, -0.8315f, -0.3928f,	0.29165f, 0.1875f,			//216
-		-0.5133f, -0.8315f, -0.2126f,	0.326375f, 0.1875f,			//217
-		-0.5556f, -0.8315f, 0.0f,		0.3611f, 0.1875f,			//218
-		-0.5133f, -0.8315f, 0.2126f,	0.395825f, 0.1875f,			//219
-		-0.3928f, -0.8315f, 0.3928f,	0.43055f, 0.1875f,			//220
-		-0.2126f, -0.8315f, 0.5133f,	0.465275f, 0.1875f,			//221
-		// ring 14
-		0.0f, -0.9239f, 0.3827f,		0.5f, 0.125f,				//222
-		0.1464f, -0.9239f, 0.3536f,		0.52391875f, 0.125f,		//223
-		0.2706f, -0.9239f, 0.2706f,		0.5478375f, 0.125f,			//224
-		0.3536f, -0.9239f, 0.1464f,		0.57175625f, 0.125f,		//225
-		0.3827f, -0.9239f, 0.0f,		0.5956755f, 0.125f,			//226
-		0.3536f, -0.9239f, -0.1464f,	0.61959425f, 0.125f,		//227
-		0.2706f, -0.9239f, -0.2706f,	0.643513f, 0.125f,			//228
-		0.1464f, -0.9239f, -0.3536f,	0.66743175f, 0.125f,		//229
-		0.0f, -0.9239f, -0.3827f,		0.6913505f, 0.125f,			//230 - seam
-		0.0f, -0.9239f, -0.3827f,		0.3086495f, 0.125f,			//231 - seam
-		-0.1464f, -0.9239f, -0.3536f,	0.33256825f, 0.125f,		//232
-		-0.2706f, -0.9239f, -0.2706f,	0.356487f, 0.125f,			//233
-		-0.3536f, -0.9239f, -0.1464f,	0.38040575f, 0.125f,		//234
-		-0.3827f, -0.9239f, 0.0f,		0.4043245f, 0.125f,			//235
-		-0.3536f, -0.9239f, 0.1464f,	0.42824325f, 0.125f,		//236
-		-0.2706f, -0.9239f, 0.2706f,	0.452162f, 0.125f,			//237
-		-0.1464f, -0.9239f, 0.3536f,	0.47608075f, 0.125f,		//238
-		// ring 15
-		0.0f, -0.9808f, 0.1951f,		0.5f, 0.0625f,				//239
-		0.0747f, -0.9808f, 0.1802f,		0.51219375f, 0.0625f,		//240
-		0.1379f, -0.9808f, 0.1379f,		0.5243875f, 0.0625f,		//241
-		0.1802f, -0.9808f, 0.0747f,		0.53658125f, 0.0625f,		//242
-		0.1951f, -0.9808, 0.0f,			0.548775f, 0.0625f,			//243
-		0.1802f, -0.9808f, -0.0747f,	0.56096875f, 0.0625f,		//244
-		0.1379f, -0.9808f, -0.1379f,	0.5731625f, 0.0625f,		//245
-		0.0747f, -0.9808f, -0.1802f,	0.58535625f, 0.0625f,		//246
-		0.0f, -0.9808f, -0.1951f,		0.59755f, 0.0625f,			//247 - seam
-		0.0f, -0.9808f, -0.1951f,		0.40245f, 0.0625f,			//248 - seam
-		-0.0747f, -0.9808f, -0.1802f,	0.41464375f, 0.0625f,		//249
-		-0.1379f, -0.9808f, -0.1379f,	0.4268375f, 0.0625f,		//250
-		-0.1802f, -0.9808f, -0.0747f,	0.43903125f, 0.0625f,		//251
-		-0.1951f, -0.9808, 0.0f,		0.451225f, 0.0625f,			//252
-		-0.1802f, -0.9808f, 0.0747f,	0.46341875f, 0.0625f,		//253
-		-0.1379f, -0.9808f, 0.1379f,	0.4756125f, 0.0625f,		//254
-		-0.0747f, -0.9808f, 0.1802f,	0.48780625f, 0.0625f,		//255
-		// bottom center point
-		0.0f, -1.0f, 0.0f,				0.5f, 0.0f					//256
-	};
-
-	// index data
-	GLuint indices[] = {
-		//ring 1 - top
-		0,10,11,
-		0,11,12,
-		0,12,13,
-		0,13,14,
-		0,14,15,
-		0,15,16,
-		0,16,17,
-		0,17,1,
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,9,
-		0,9,10,
-
-		// ring 1 to ring 2
-		10,27,28,
-		10,11,28,
-		11,28,29,
-		11,12,29,
-		12,29,30,
-		12,13,30,
-		13,30,31,
-		13,14,31,
-		14,31,32,
-		14,15,32,
-		15,32,33,
-		15,16,33,
-		16,33,34,
-		16,17,34,
-		17,34,18,
-		17,1,18,
-		1,18,19,
-		1,2,19,
-		2,19,20,
-		2,3,20,
-		3,20,21,
-		3,4,21,
-		4,21,22,
-		4,5,22,
-		5,22,23,
-		5,6,23,
-		6,23,24,
-		6,7,24,
-		7,24,25,
-		7,8,25,
-		8,25,26,
-		8,9,26,
-		9,26,27,
-		9,10,27,
-
-		// ring 2 to ring 3
-		27,44,45,
-		27,28,45,
-		28,45,46,
-		28,29,46,
-		29,46,47,
-		29,30,47,
-		30,47,48,
-		30,31,48,
-		31,48,49,
-		31,32,49,
-		32,49,50,
-		32,33,50,
-		33,50,51,
-		33,34,51,
-		34,51,35,
-		34,18,35,
-		18,35,36,
-		18,19,36,
-		19,36,37,
-		19,20,37,
-		20,37,38,
-		20,21,38,
-		21,38,39,
-		21,22,39,
-		22,39,40,
-		22,23,40,
-		23,40,41,
-		23,24,41,
-		24,41,42,
-		24,25,42,
-		25,42,43,
-		25,26,43,
-		26,43,44,
-		26,27,44,
-
-		// ring 3 to ring 4
-		44,61,62,
-		44,45,62,
-		45,62,63,
-		45,46,63,
-		46,63,64,
-		46,47,64,
-		47,64,65,
-		47,48,65,
-		48,65,66,
-		48,49,66,
-		49,66,67,
-		49,50,67,
-		50,67,68,
-		50,51,68,
-		51,68,52,
-		51,35,52,
-		35,52,53,
-		35,36,53,
-		36,53,54,
-		36,37,54,
-		37,54,55,
-		37,38,55,
-		38,55,56,
-		38,39,56,
-		39,56,57,
-		39,40,57,
-		40,57,58,
-		40,41,58,
-		41,58,59,
-		41,42,59,
-		42,59,60,
-		42,43,60,
-		43,60,61,
-		43,44,61,
-
-		// ring 4 to ring 5
-		61,78,79,
-		61,62,79,
-		62,79,80,
-		62,63,80,
-		63,80,81,
-		63,64,81,
-		64,81,82,
-		64,65,82,
-		65,82,83,
-		65,66,83,
-		66,83,84,
-		66,67,84,
-		67,84,85,
-		67,68,85,
-		68,85,69,
-		68,52,69,
-		52,69,70,
-		52,53,70,
-		53,70,71,
-		53,54,71,
-		54,71,72,
-		54,55,72,
-		55,72,73,
-		55,56,73,
-		56,73,74,
-		56,57,74,
-		57,74,75,
-		57,58,75,
-		58,75,76,
-		58,59,76,
-		59,76,77,
-		59,60,77,
-		60,77,78,
-		60,61,78,
-
-		// ring 5 to ring 6
-		78,95,96,
-		78,79,96,
-		79,96,97,
-		79,80,97,
-		80,97,98,
-		80,81,98,
-		81,98,99,
-		81,82,99,
-		82,99,100,
-		82,83,100,
-		83,100,101,
-		83,84,101,
-		84,101,102,
-		84,85,102,
-		85,102,86,
-		85,69,86,
-		69,86,87,
-		69,70,87,
-		70,87,88,
-		70,71,88,
-		71,88,89,
-		71,72,89,
-		72,89,90,
-		72,73,90,
-		73,90,91,
-		73,74,91,
-		74,91,92,
-		74,75,92,
-		75,92,93,
-		75,76,93,
-		76,93,94,
-		76,77,94,
-		77,94,95,
-		77,78,95,
-
-		// ring 6 to ring 7
-		95,112,113,
-		95,96,113,
-		96,113,114,
-		96,97,114,
-		97,114,115,
-		97,98,115,
-		98,115,116,
-		98,99,116,
-		99,116,117,
-		99,100,117,
-		100,117,118,
-		100,101,118,
-		101,118,119,
-		101,102,119,
-		102,119,103,
-		102,86,103,
-		86,103,104,
-		86,87,104,
-		87,104,105,
-		87,88,105,
-		88,105,106,
-		88,89,106,
-		89,106,107,
-		89,90,107,
-		90,107,108,
-		90,91,108,
-		91,108,109,
-		91,92,109,
-		92,109,110,
-		92,93,110,
-		93,110,111,
-		93,94,111,
-		94,111,112,
-		94,95,112,
-
-		// ring 7 to ring 8
-		112,129,130,
-		112,113,130,
-		113,130,131,
-		113,114,131,
-		114,131,132,
-		114,115,132,
-		115,132,133,
-		115,116,133,
-		116,133,134,
-		116,117,134,
-		117,134,135,
-		117,118,135,
-		118,135,136,
-		118,119,136,
-		119,136,120,
-		119,103,120,
-		103,120,121,
-		103,104,121,
-		104,121,122,
-		104,105,122,
-		105,122,123,
-		105,106,123,
-		106,123,124,
-		106,107,124,
-		107,124,125,
-		107,108,125,
-		108,125,126,
-		108,109,126,
-		109,126,127,
-		109,110,127,
-		110,127,128,
-		110,111,128,
-		111,128,129,
-		111,112,129,
-
-		// ring 8 to ring 9
-		129,146,147,
-		129,130,147,
-		130,147,148,
-		130,131,148,
-		131,148,149,
-		131,132,149,
-		132,149,150,
-		132,133,150,
-		133,150,151,
-		133,134,151,
-		134,151,152,
-		134,135,152,
-		135,152,153,
-		135,136,153,
-		136,153,137,
-		136,120,137,
-		120,137,138,
-		120,121,138,
-		121,138,139,
-		121,122,139,
-		122,139,140,
-		122,123,140,
-		123,140,141,
-		123,124,141,
-		124,141,142,
-		124,125,142,
-		125,142,143,
-		125,126,143,
-		126,143,144,
-		126,127,144,
-		127,144,145,
-		127,128,145,
-		128,145,146,
-		128,129,146,
-
-		// ring 9 to ring 10
-		146,163,164,
-		146,147,164,
-		147,164,165,
-		147,148,165,
-		148,165,166,
-		148,149,166,
-		149,166,167,
-		149,150,167,
-		150,167,168,
-		150,151,168,
-		151,168,169,
-		151,152,169,
-		152,169,170,
-		152,153,170,
-		153,170,154,
-		153,137,154,
-		137,154,155,
-		137,138,155,
-		138,155,156,
-		138,139,156,
-		139,156,157,
-		139,140,157,
-		140,157,158,
-		140,141,158,
-		141,158,159,
-		141,142,159,
-		142,159,160,
-		142,143,160,
-		143,160,161,
-		143,144,161,
-		144,161,162,
-		144,145,162,
-		145,162,163,
-		145,146,163,
-
-		// ring 10 to ring 11
-		163,180,181,
-		163,164,181,
-		164,181,182,
-		164,165,182,
-		165,182,183,
-		165,166,183,
-		166,183,184,
-		166,167,184,
-		167,184,185,
-		167,168,185,
-		168,185,186,
-		168,169,186,
-		169,186,187,
-		169,170,187,
-		170,187,171,
-		170,154,171,
-		154,171,172,
-		154,155,172,
-		155,172,173,
-		155,156,173,
-		156,173,174,
-		156,157,174,
-		157,174,175,
-		157,158,175,
-		158,175,176,
-		158,159,176,
-		159,176,177,
-		159,160,177,
-		160,177,178,
-		160,161,178,
-		161,178,179,
-		161,162,179,
-		162,179,180,
-		162,163,180,
-
-		// ring 11 to ring 12
-		180,197,198,
-		180,181,198,
-		181,198,199,
-		181,182,199,
-		182,199,200,
-		182,183,200,
-		183,200,201,
-		183,184,201,
-		184,201,202,
-		184,185,202,
-		185,202,203,
-		185,186,203,
-		186,203,204,
-		186,187,204,
-		187,204,188,
-		187,171,188,
-		171,188,189,
-		171,172,189,
-		172,189,190,
-		172,173,190,
-		173,190,191,
-		173,174,191,
-		174,191,192,
-		174,175,192,
-		175,192,193,
-		175,176,193,
-		176,193,194,
-		176,177,194,
-		177,194,195,
-		177,178,195,
-		178,195,196,
-		178,179,196,
-		179,196,197,
-		179,180,197,
-
-		// ring 12 to ring 13
-		197,214,215,
-		197,198,215,
-		198,215,216,
-		198,199,216,
-		199,216,217,
-		199,200,217,
-		200,217,218,
-		200,201,218,
-		201,218,219,
-		201,202,219,
-		202,219,220,
-		202,203,220,
-		203,220,221,
-		203,204,221,
-		204,221,205,
-		204,188,205,
-		188,205,206,
-		188,189,206,
-		189,206,207,
-		189,190,207,
-		190,207,208,
-		190,191,208,
-		191,208,209,
-		191,192,209,
-		192,209,210,
-		192,193,210,
-		193,210,211,
-		193,194,211,
-		194,211,212,
-		194,195,212,
-		195,212,213,
-		195,196,213,
-		196,213,214,
-		196,197,214,
-
-		// ring 13 to ring 14
-		214,231,232,
-		214,215,232,
-		215,232,233,
-		215,216,233,
-		216,233,234,
-		216,217,234,
-		217,234,235,
-		217,218,235,
-		218,235,236,
-		218,219,236,
-		219,236,237,
-		219,220,237,
-		220,237,238,
-		220,221,238,
-		221,238,222,
-		221,205,222,
-		205,222,223,
-		205,206,223,
-		206,223,224,
-		206,207,224,
-		207,224,225,
-		207,208,225,
-		208,225,226,
-		208,209,226,
-		209,226,227,
-		209,210,227,
-		210,227,228,
-		210,211,228,
-		211,228,229,
-		211,212,229,
-		212,229,230,
-		212,213,230,
-		213,230,231,
-		213,214,231,
-
-		// ring 14 to ring 15
-		231,248,249,
-		231,232,249,
-		232,249,250,
-		232,233,250,
-		233,250,251,
-		233,234,251,
-		234,251,252,
-		234,235,252,
-		235,252,253,
-		235,236,253,
-		236,253,254,
-		236,237,254,
-		237,254,255,
-		237,238,255,
-		238,255,239,
-		238,222,239,
-		222,239,240,
-		222,223,240,
-		223,240,241,
-		223,224,241,
-		224,241,242,
-		224,225,242,
-		225,242,243,
-		225,226,243,
-		226,243,244,
-		226,227,244,
-		227,244,245,
-		227,228,245,
-		228,245,246,
-		228,229,246,
-		229,246,247,
-		229,230,247,
-		230,247,248,
-		230,231,248,
-
-		// ring 15 - bottom
-		248,256,249,
-		249,256,250,
-		250,256,251,
-		251,256,252,
-		252,256,253,
-		253,256,254,
-		254,256,255,
-		255,256,239,
-		239,256,240,
-		240,256,241,
-		241,256,242,
-		242,256,243,
-		243,256,244,
-		244,256,245,
-		245,256,246,
-		246,256,247,
-		247,256,248
-	};
-
-	// total float values per each type
-	const GLuint floatsPerVertex = 3;
-	const GLuint floatsPerNormal = 3;
-	const GLuint floatsPerUV = 2;
-
-	// store vertex and index count
-	m_SphereMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (floatsPerVertex));
-	m_SphereMesh.nIndices = sizeof(indices) / (sizeof(indices[0]));
-
-	glm::vec3 normal;
-	glm::vec3 vert;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	float u, v;
-	std::vector<GLfloat> combined_values;
+//	Record a range of the triangles of a mesh, which
+//  would have been one draw.
+///////////////////////////////////////////////////
+void ShapeMeshes::CaptureIndexRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount)
+{
+	CAPTURED_RANGE range;
+	range.source = FindCaptureSource(mesh);
+	range.firstIndex = firstIndex;
+	range.indexCount = indexCount;
+	m_capturedRanges.push_back(range);
+}
 
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < sizeof(verts) / (sizeof(verts[0])); i += 5)
+///////////////////////////////////////////////////
+//	FindCaptureSource()
+//
+//	Find the copy of a mesh read back for capturing.
+//  The first time a mesh is captured, its vertices
+//  are read back from its arena and unpacked to the
+//  float layout the way the vertex shader unpacks
+//  them, and its indices are widened to 32 bits.
+///////////////////////////////////////////////////
+int ShapeMeshes::FindCaptureSource(const GLMesh& mesh)
+{
+	for (int i = 0; i < (int)m_captureSources.size(); i++)
 	{
-		vert = glm::vec3(verts[i], verts[i + 1], verts[i + 2]);
-		normal = normalize(vert - center);
-		//u = atan2(normal.x, normal.z) / (2 * M_PI) + 0.5;
-		//v = normal.y * 0.5 + 0.5;
-		combined_values.push_back(vert.x);
-		combined_values.push_back(vert.y);
-		combined_values.push_back(vert.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(verts[i + 3]);
-		combined_values.push_back(verts[i + 4]);
+		const CAPTURE_SOURCE& known = m_captureSources[i];
+		if ((known.bRetired == false) && (known.vertexFormat == mesh.vertexFormat) &&
+			(known.firstVertex == mesh.firstVertex) && (known.indexOffset == mesh.indexOffset))
+		{
+			return(i);
+		}
 	}
 
-	// Create VAO
-	glGenVertexArrays(1, &m_SphereMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_SphereMesh.vao);
+	CAPTURE_SOURCE source;
+	source.vertexFormat = mesh.vertexFormat;
+	source.firstVertex = mesh.firstVertex;
+	source.indexOffset = mesh.indexOffset;
+	source.bRetired = false;
+
+	const GEOMETRY_ARENA& arena = m_arenas[mesh.vertexFormat];
+	std::vector<unsigned char> packed(mesh.nVertices * mesh.vertexSize);
+	glBindBuffer(GL_COPY_READ_BUFFER, arena.buffers[0]);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, mesh.firstVertex * mesh.vertexSize, packed.size(), packed.data());
 
-	// Create VBOs
-	glGenBuffers(2, m_SphereMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_SphereMesh.vbos[0]); // Activates the vertex buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	source.vertices.resize(mesh.nVertices * ShapeGenerator::FLOATS_PER_VERTEX);
+	glm::vec3 positionDecode = glm::vec3(mesh.vertexDecode);
+	for (GLuint i = 0; i < mesh.nVertices; i++)
+	{
+		GLfloat* vertex = &source.vertices[i * ShapeGenerator::FLOATS_PER_VERTEX];
+		const unsigned char* stored = &packed[i * mesh.vertexSize];
+		if (mesh.vertexFormat == floatVertices)
+		{
+			memcpy(vertex, stored, mesh.vertexSize);
+			continue;
+		}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_SphereMesh.vbos[1]); // Activates the index buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+		if (mesh.vertexFormat == quantizedVertices)
+		{
+			const VertexQuantizer::QUANTIZED_VERTEX* quantized = (const VertexQuantizer::QUANTIZED_VERTEX*)stored;
+			position = glm::vec3(quantized->position[0], quantized->position[1], quantized->position[2]) * positionDecode;
+			normal = VertexQuantizer::DecodeNormal(quantized->normal);
+			uv = VertexQuantizer::DecodeUV(quantized->uv);
+		}
+		else
+		{
+			const VertexQuantizer::COMPACT_VERTEX* compact = (const VertexQuantizer::COMPACT_VERTEX*)stored;
+			position = glm::vec3(compact->position[0], compact->position[1], compact->position[2]) * positionDecode;
+			normal = VertexQuantizer::DecodeNormal(compact->normal);
+			uv = VertexQuantizer::DecodeUV(compact->uv);
+		}
+		memcpy(vertex, &position[0], sizeof(GLfloat) * 3);
+		memcpy(vertex + 3, &normal[0], sizeof(GLfloat) * 3);
+		memcpy(vertex + 6, &uv[0], sizeof(GLfloat) * 2);
+	}
 
-	if (m_bMemoryLayoutDone == false)
+	source.indices.resize(mesh.nIndices);
+	glBindBuffer(GL_COPY_READ_BUFFER, arena.buffers[1]);
+	if (mesh.indexType == GL_UNSIGNED_SHORT)
+	{
+		std::vector<GLushort> shortIndices(mesh.nIndices);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, mesh.indexOffset, mesh.nIndices * sizeof(GLushort), shortIndices.data());
+		source.indices.assign(shortIndices.begin(), shortIndices.end());
+	}
+	else
 	{
-		SetShaderMemoryLayout();
+		glGetBufferSubData(GL_COPY_READ_BUFFER, mesh.indexOffset, mesh.nIndices * sizeof(GLuint), source.indices.data());
 	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	m_captureSources.push_back(source);
+	return((int)m_captureSources.size() - 1);
 }
 
 ///////////////////////////////////////////////////
-//	LoadTaperedCylinderMesh()
-//
-//	Create a tapered cylinder mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
-//
-//  Correct triangle drawing commands:
+//	RetireCaptureSources()
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 72);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
-///////////////////////////////////////////////////
-void ShapeMeshes::LoadTaperedCylinderMesh()
-{
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.47f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.17f, 1.0f, -0.47f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.17f, 1.0f, -0.47f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.47f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.49f, 1.0f, 0.085f,	0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.435f, 1.0f, 0.25f,	0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.385f, 1.0f, 0.32f,	0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.32f, 1.0f, 0.385f,	0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.25f, 1.0f, 0.435f,	0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.085f, 1.0f, 0.49f,	0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.085f, 1.0f, 0.49f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.25f, 1.0f, 0.435f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.32f, 1.0f, 0.385f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.385f, 1.0f, 0.32f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.435f, 1.0f, 0.25f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.49f, 1.0f, 0.085f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		.5f, 1.0f, 0.0f, 0.993150651f, 0.5f, -0.116841137f, 0.0, 1.0,
-		1.0f, 0.0f, 0.0f, 0.993150651f, 0.5f, -0.116841137f, 0.0, 0.0,
-		.98f, 0.0f, -0.17f, 0.993150651f, 0.5f, -0.116841137f, 0.02778, 0.0,
-		.5f, 1.0f, 0.0f, 0.993150651f, 0.5f, -0.116841137f, 0.0, 1.0,
-		.5f, 1.0f, 0.0f, 0.993150651f, 0.5f, -0.116841137f, 0.0, 1.0,
-		.49f, 1.0f, -0.085f, 0.973417103f, 0.5f, -0.229039446f, 0.02778, 1.0,
-		.98f, 0.0f, -0.17f, 0.973417103f, 0.5f, -0.229039446f, 0.02778, 0.0,
-		.5f, 1.0f, 0.0f, 0.993150651f, 0.5f, -0.116841137f, 0.0, 1.0,
-		.49f, 1.0f, -0.085f, 0.973417103f, 0.5f, -0.229039446f, 0.02778, 1.0,
-		.98f, 0.0f, -0.17f, 0.973417103f, 0.5f, -0.229039446f, 0.02778, 0.0,
-		.94f, 0.0f, -0.34f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 0.0,
-		.49f, 1.0f, -0.085f, 0.973417103f, 0.5f, -0.229039446f, 0.02778, 1.0,
-		.49f, 1.0f, -0.085f, 0.973417103f, 0.5f, -0.229039446f, 0.02778, 1.0,
-		.47f, 1.0f, -0.17f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 1.0,
-		.94f, 0.0f, -0.34f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 0.0,
-		.49f, 1.0f, -0.085f, 0.973417103f, 0.5f, -0.229039446f, 0.02778, 1.0,
-		.47f, 1.0f, -0.17f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 1.0,
-		.94f, 0.0f, -0.34f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 0.0,
-		.87f, 0.0f, -0.5f, 0.916157305f, 0.0f, -0.400818795f, 0.08334, 0.0,
-		.47f, 1.0f, -0.17f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 1.0,
-		.47f, 1.0f, -0.17f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 1.0,
-		.435f, 1.0f, -0.25f, 0.813733339f, 0.0f, -0.581238329f, 0.08334, 1.0,
-		.87f, 0.0f, -0.5f, 0.813733339f, 0.0f, -0.581238329f, 0.08334, 0.0,
-		.47f, 1.0f, -0.17f, 0.916157305f, 0.0f, -0.400818795f, 0.05556, 1.0,
-		.435f, 1.0f, -0.25f, 0.813733339f, 0.0f, -0.581238329f, 0.08334, 1.0,
-		.87f, 0.0f, -0.5f, 0.916157305f, 0.0f, -0.400818795f, 0.08334, 0.0,
-		.77f, 0.0f, -0.64f, 0.813733339f, 0.0f, -0.581238329f, 0.11112, 0.0,
-		.435f, 1.0f, -0.25f, 0.813733339f, 0.0f, -0.581238329f, 0.08334, 1.0,
-		.435f, 1.0f, -0.25f, 0.813733339f, 0.0f, -0.581238329f, 0.08334, 1.0,
-		.385f, 1.0f, -0.32f, 0.707106769f, 0.0f, -0.707106769f, 0.11112, 1.0,
-		.77f, 0.0f, -0.64f, 0.707106769f, 0.0f, -0.707106769f, 0.11112, 0.0,
-		.435f, 1.0f, -0.25f, 0.813733339f, 0.0f, -0.581238329f, 0.08334, 1.0,
-		.385f, 1.0f, -0.32f, 0.707106769f, 0.0f, -0.707106769f, 0.11112, 1.0,
-		.77f, 0.0f, -0.64f, 0.707106769f, 0.0f, -0.707106769f, 0.11112, 0.0,
-		.64f, 0.0f, -0.77f, 0.707106769f, 0.0f, -0.707106769f, 0.1389, 0.0,
-		.385f, 1.0f, -0.32f, 0.707106769f, 0.0f, -0.707106769f, 0.11112, 1.0,
-		.385f, 1.0f, -0.32f, 0.707106769f, 0.0f, -0.707106769f, 0.11112, 1.0,
-		.32f, 1.0f, -0.385f, 0.581238329f, 0.0f, -0.813733339f, 0.1389, 1.0,
-		.64f, 0.0f, -0.77f, 0.581238329f, 0.0f, -0.813733339f, 0.1389, 0.0,
-		.385f, 1.0f, -0.32f, 0.707106769f, 0.0f, -0.707106769f, 0.11112, 1.0,
-		.32f, 1.0f, -0.385f, 0.581238329f, 0.0f, -0.813733339f, 0.1389, 1.0,
-		.64f, 0.0f, -0.77f, 0.581238329f, 0.0f, -0.813733339f, 0.1389, 0.0,
-		.5f, 0.0f, -0.87f, 0.581238329f, 0.0f, -0.813733339f, 0.16668, 0.0,
-		.32f, 1.0f, -0.385f, 0.581238329f, 0.0f, -0.813733339f, 0.1389, 1.0,
-		.32f, 1.0f, -0.385f, 0.581238329f, 0.0f, -0.813733339f, 0.1389, 1.0,
-		.25f, 1.0f, -0.435f, 0.400818795f, 0.0f, -0.916157305f, 0.16668, 1.0,
-		.5f, 0.0f, -0.87f, 0.400818795f, 0.0f, -0.916157305f, 0.16668, 0.0,
-		.32f, 1.0f, -0.385f, 0.581238329f, 0.0f, -0.813733339f, 0.1389, 1.0,
-		.25f, 1.0f, -0.435f, 0.400818795f, 0.0f, -0.916157305f, 0.16668, 1.0,
-		.5f, 0.0f, -0.87f, 0.400818795f, 0.0f, -0.916157305f, 0.16668, 0.0,
-		.34f, 0.0f, -0.94f, 0.400818795f, 0.0f, -0.916157305f, 0.19446, 0.0,
-		.25f, 1.0f, -0.435f, 0.400818795f, 0.0f, -0.916157305f, 0.16668, 1.0,
-		.25f, 1.0f, -0.435f, 0.400818795f, 0.0f, -0.916157305f, 0.16668, 1.0,
-		.17f, 1.0f, -0.47f, 0.229039446f, 0.0f, -0.973417103f, 0.19446, 1.0,
-		.34f, 0.0f, -0.94f, 0.229039446f, 0.0f, -0.973417103f, 0.19446, 0.0,
-		.25f, 1.0f, -0.435f, 0.400818795f, 0.0f, -0.916157305f, 0.16668, 1.0,
-		.17f, 1.0f, -0.47f, 0.229039446f, 0.0f, -0.973417103f, 0.19446, 1.0,
-		.34f, 0.0f, -0.94f, 0.229039446f, 0.0f, -0.973417103f, 0.19446, 0.0,
-		.17f, 0.0f, -0.98f, 0.229039446f, 0.0f, -0.973417103f, 0.22224, 0.0,
-		.17f, 1.0f, -0.47f, 0.229039446f, 0.0f, -0.973417103f, 0.19446, 1.0,
-		.17f, 1.0f, -0.47f, 0.229039446f, 0.0f, -0.973417103f, 0.19446, 1.0,
-		.085f, 1.0f, -0.49f, 0.116841137f, 0.0f, -0.993150651f, 0.22224, 1.0,
-		.17f, 0.0f, -0.98f, 0.116841137f, 0.0f, -0.993150651f, 0.22224, 0.0,
-		.17f, 1.0f, -0.47f, 0.229039446f, 0.0f, -0.973417103f, 0.19446, 1.0,
-		.085f, 1.0f, -0.49f, 0.116841137f, 0.0f, -0.993150651f, 0.22224, 1.0,
-		.17f, 0.0f, -0.98f, 0.116841137f, 0.0f, -0.993150651f, 0.22224, 0.0,
-		0.0f, 0.0f, -1.0f, 0.116841137f, 0.0f, -0.993150651f, 0.25, 0.0,
-		.085f, 1.0f, -0.49f, 0.116841137f, 0.0f, -0.993150651f, 0.22224, 1.0,
-		.085f, 1.0f, -0.49f, 0.116841137f, 0.0f, -0.993150651f, 0.22224, 1.0,
-		0.0f, 1.0f, -.5f, 0.116841137f, 0.0f, -0.993150651f, 0.25, 1.0,
-		0.0f, 0.0f, -1.0f, 0.116841137f, 0.0f, -0.993150651f, 0.25, 0.0,
-		.085f, 1.0f, -0.49f, 0.116841137f, 0.0f, -0.993150651f, 0.22224, 1.0,
-		0.0f, 1.0f, -.5f, 0.116841137f, 0.0f, -0.993150651f, 0.25, 1.0,
-		0.0f, 0.0f, -1.0f, 0.116841137f, 0.0f, -0.993150651f, 0.25, 0.0,
-		-.17f, 0.0f, -0.98f, -0.116841137f, 0.0f, -0.993150651f, 0.2778, 0.0,
-		0.0f, 1.0f, -.5f, -0.116841137f, 0.0f, -0.993150651f, 0.25, 1.0,
-		0.0f, 1.0f, -.5f, -0.116841137f, 0.0f, -0.993150651f, 0.25, 1.0,
-		-.085f, 1.0f, -0.49f, -0.229039446f, 0.0f, -0.973417103f, 0.2778, 1.0,
-		-.17f, 0.0f, -0.98f, -0.229039446f, 0.0f, -0.973417103f, 0.2778, 0.0,
-		0.0f, 1.0f, -.5f, -0.116841137f, 0.0f, -0.993150651f, 0.25, 1.0,
-		-.085f, 1.0f, -0.49f, -0.229039446f, 0.0f, -0.973417103f, 0.2778, 1.0,
-		-.17f, 0.0f, -0.98f, -0.229039446f, 0.0f, -0.973417103f, 0.2778, 0.0,
-		-.34f, 0.0f, -0.94f, -0.229039446f, 0.0f, -0.973417103f, 0.30558, 0.0,
-		-.085f, 1.0f, -0.49f, -0.229039446f, 0.0f, -0.973417103f, 0.2778, 1.0,
-		-.085f, 1.0f, -0.49f, -0.229039446f, 0.0f, -0.973417103f, 0.2778, 1.0,
-		-.17f, 1.0f, -0.47f, -0.400818795f, 0.0f, -0.916157305f, 0.30558, 1.0,
-		-.34f, 0.0f, -0.94f, -0.400818795f, 0.0f, -0.916157305f, 0.30558, 0.0,
-		-.085f, 1.0f, -0.49f, -0.229039446f, 0.0f, -0.973417103f, 0.2778, 1.0,
-		-.17f, 1.0f, -0.47f, -0.400818795f, 0.0f, -0.916157305f, 0.30558, 1.0,
-		-.34f, 0.0f, -0.94f, -0.400818795f, 0.0f, -0.916157305f, 0.30558, 0.0,
-		-.5f, 0.0f, -0.87f, -0.400818795f, 0.0f, -0.916157305f, 0.33336, 0.0,
-		-.17f, 1.0f, -0.47f, -0.400818795f, 0.0f, -0.916157305f, 0.30558, 1.0,
-		-.17f, 1.0f, -0.47f, -0.400818795f, 0.0f, -0.916157305f, 0.30558, 1.0,
-		-.25f, 1.0f, -0.435f, -0.581238329f, 0.0f, -0.813733339f, 0.33336, 1.0,
-		-.5f, 0.0f, -0.87f, -0.581238329f, 0.0f, -0.813733339f, 0.33336, 0.0,
-		-.17f, 1.0f, -0.47f, -0.400818795f, 0.0f, -0.916157305f, 0.30558, 1.0,
-		-.25f, 1.0f, -0.435f, -0.581238329f, 0.0f, -0.813733339f, 0.33336, 1.0,
-		-.5f, 0.0f, -0.87f, -0.581238329f, 0.0f, -0.813733339f, 0.33336, 0.0,
-		-.64f, 0.0f, -0.77f, -0.581238329f, 0.0f, -0.813733339f, 0.36114, 0.0,
-		-.25f, 1.0f, -0.435f, -0.581238329f, 0.0f, -0.813733339f, 0.33336, 1.0,
-		-.25f, 1.0f, -0.435f, -0.581238329f, 0.0f, -0.813733339f, 0.33336, 1.0,
-		-.32f, 1.0f, -0.385f, -0.707106769f, 0.0f, -0.707106769f, 0.36114, 1.0,
-		-.64f, 0.0f, -0.77f, -0.707106769f, 0.0f, -0.707106769f, 0.36114, 0.0,
-		-.25f, 1.0f, -0.435f, -0.581238329f, 0.0f, -0.813733339f, 0.33336, 1.0,
-		-.32f, 1.0f, -0.385f, -0.707106769f, 0.0f, -0.707106769f, 0.36114, 1.0,
-		-.64f, 0.0f, -0.77f, -0.707106769f, 0.0f, -0.707106769f, 0.36114, 0.0,
-		-.77f, 0.0f, -0.64f, -0.707106769f, 0.0f, -0.707106769f, 0.38892, 0.0,
-		-.32f, 1.0f, -0.385f, -0.707106769f, 0.0f, -0.707106769f, 0.36114, 1.0,
-		-.32f, 1.0f, -0.385f, -0.707106769f, 0.0f, -0.707106769f, 0.36114, 1.0,
-		-.385f, 1.0f, -0.32f, -0.813733339f, 0.0f, -0.581238329f, 0.38892, 1.0,
-		-.77f, 0.0f, -0.64f, -0.813733339f, 0.0f, -0.581238329f, 0.38892, 0.0,
-		-.32f, 1.0f, -0.385f, -0.707106769f, 0.0f, -0.707106769f, 0.36114, 1.0,
-		-.385f, 1.0f, -0.32f, -0.813733339f, 0.0f, -0.581238329f, 0.38892, 1.0,
-		-.77f, 0.0f, -0.64f, -0.813733339f, 0.0f, -0.581238329f, 0.38892, 0.0,
-		-.87f, 0.0f, -0.5f, -0.813733339f, 0.0f, -0.581238329f, 0.4167, 0.0,
-		-.385f, 1.0f, -0.32f, -0.813733339f, 0.0f, -0.581238329f, 0.38892, 1.0,
-		-.385f, 1.0f, -0.32f, -0.813733339f, 0.0f, -0.581238329f, 0.38892, 1.0,
-		-.435f, 1.0f, -0.25f, -0.916157305f, 0.0f, -0.400818795f, 0.4167, 1.0,
-		-.87f, 0.0f, -0.5f, -0.916157305f, 0.0f, -0.400818795f, 0.4167, 0.0,
-		-.385f, 1.0f, -0.32f, -0.813733339f, 0.0f, -0.581238329f, 0.38892, 1.0,
-		-.435f, 1.0f, -0.25f, -0.916157305f, 0.0f, -0.400818795f, 0.4167, 1.0,
-		-.87f, 0.0f, -0.5f, -0.916157305f, 0.0f, -0.400818795f, 0.4167, 0.0,
-		-.94f, 0.0f, -0.34f, -0.916157305f, 0.0f, -0.400818795f, 0.44448, 0.0,
-		-.435f, 1.0f, -0.25f, -0.916157305f, 0.0f, -0.400818795f, 0.4167, 1.0,
-		-.435f, 1.0f, -0.25f, -0.916157305f, 0.0f, -0.400818795f, 0.4167, 1.0,
-		-.47f, 1.0f, -0.17f, -0.973417103f, 0.0f, -0.229039446f, 0.44448, 1.0,
-		-.94f, 0.0f, -0.34f, -0.973417103f, 0.0f, -0.229039446f, 0.44448, 0.0,
-		-.435f, 1.0f, -0.25f, -0.916157305f, 0.0f, -0.400818795f, 0.4167, 1.0,
-		-.47f, 1.0f, -0.17f, -0.973417103f, 0.0f, -0.229039446f, 0.44448, 1.0,
-		-.94f, 0.0f, -0.34f, -0.973417103f, 0.0f, -0.229039446f, 0.44448, 0.0,
-		-.98f, 0.0f, -0.17f, -0.973417103f, 0.0f, -0.229039446f, 0.47226, 0.0,
-		-.47f, 1.0f, -0.17f, -0.973417103f, 0.0f, -0.229039446f, 0.44448, 1.0,
-		-.47f, 1.0f, -0.17f, -0.973417103f, 0.0f, -0.229039446f, 0.44448, 1.0,
-		-.49f, 1.0f, -0.085f, -0.993150651f, 0.0f, -0.116841137f, 0.47226, 1.0,
-		-.98f, 0.0f, -0.17f, -0.993150651f, 0.0f, -0.116841137f, 0.47226, 0.0,
-		-.47f, 1.0f, -0.17f, -0.973417103f, 0.0f, -0.229039446f, 0.44448, 1.0,
-		-.49f, 1.0f, -0.085f, -0.993150651f, 0.0f, -0.116841137f, 0.47226, 1.0,
-		-.98f, 0.0f, -0.17f, -0.993150651f, 0.0f, -0.116841137f, 0.47226, 0.0,
-		-1.0f, 0.0f, 0.0f, -0.993150651f, 0.0f, -0.116841137f, 0.5, 0.0,
-		-.49f, 1.0f, -0.085f, -0.993150651f, 0.0f, -0.116841137f, 0.47226, 1.0,
-		-.49f, 1.0f, -0.085f, -0.993150651f, 0.0f, -0.116841137f, 0.47226, 1.0,
-		-.5f, 1.0f, 0.0f, -0.993150651f, 0.0f, -0.116841137f, 0.5, 1.0,
-		-1.0f, 0.0f, 0.0f, -0.993150651f, 0.0f, -0.116841137f, 0.5, 0.0,
-		-.49f, 1.0f, -0.085f, -0.993150651f, 0.0f, -0.116841137f, 0.47226, 1.0,
-		-.5f, 1.0f, 0.0f, -0.993150651f, 0.0f, -0.116841137f, 0.5, 1.0,
-		-1.0f, 0.0f, 0.0f, -0.993150651f, 0.0f, -0.116841137f, 0.5, 0.0,
-		-.98f, 0.0f, 0.17f, -0.993150651f, 0.0f, 0.116841137f, 0.52782, 0.0,
-		-.5f, 1.0f, 0.0f, -0.993150651f, 0.0f, 0.116841137f, 0.5, 1.0,
-		-.5f, 1.0f, 0.0f, -0.993150651f, 0.0f, 0.116841137f, 0.5, 1.0,
-		-.49f, 1.0f, 0.085f, -0.973417103f, 0.0f, 0.229039446f, 0.52782, 1.0,
-		-.98f, 0.0f, 0.17f, -0.973417103f, 0.0f, 0.229039446f, 0.52782, 0.0,
-		-.5f, 1.0f, 0.0f, -0.993150651f, 0.0f, 0.116841137f, 0.5, 1.0,
-		-.49f, 1.0f, 0.085f, -0.973417103f, 0.0f, 0.229039446f, 0.52782, 1.0,
-		-.98f, 0.0f, 0.17f, -0.973417103f, 0.0f, 0.229039446f, 0.52782, 0.0,
-		-.94f, 0.0f, 0.34f, -0.973417103f, 0.0f, 0.229039446f, 0.5556, 0.0,
-		-.49f, 1.0f, 0.085f, -0.973417103f, 0.0f, 0.229039446f, 0.52782, 1.0,
-		-.49f, 1.0f, 0.085f, -0.973417103f, 0.0f, 0.229039446f, 0.52782, 1.0,
-		-.47f, 1.0f, 0.17f, -0.916157305f, 0.0f, 0.400818795f, 0.5556, 1.0,
-		-.94f, 0.0f, 0.34f, -0.916157305f, 0.0f, 0.400818795f, 0.5556, 0.0,
-		-.49f, 1.0f, 0.085f, -0.973417103f, 0.0f, 0.229039446f, 0.52782, 1.0,
-		-.47f, 1.0f, 0.17f, -0.916157305f, 0.0f, 0.400818795f, 0.5556, 1.0,
-		-.94f, 0.0f, 0.34f, -0.916157305f, 0.0f, 0.400818795f, 0.5556, 0.0,
-		-.87f, 0.0f, 0.5f, -0.916157305f, 0.0f, 0.400818795f, 0.58338, 0.0,
-		-.47f, 1.0f, 0.17f, -0.916157305f, 0.0f, 0.400818795f, 0.5556, 1.0,
-		-.47f, 1.0f, 0.17f, -0.916157305f, 0.0f, 0.400818795f, 0.5556, 1.0,
-		-.435f, 1.0f, 0.25f, -0.813733339f, 0.0f, 0.581238329f, 0.58338, 1.0,
-		-.87f, 0.0f, 0.5f, -0.813733339f, 0.0f, 0.581238329f, 0.58338, 0.0,
-		-.47f, 1.0f, 0.17f, -0.916157305f, 0.0f, 0.400818795f, 0.5556, 1.0,
-		-.435f, 1.0f, 0.25f, -0.813733339f, 0.0f, 0.581238329f, 0.58338, 1.0,
-		-.87f, 0.0f, 0.5f, -0.813733339f, 0.0f, 0.581238329f, 0.58338, 0.0,
-		-.77f, 0.0f, 0.64f, -0.813733339f, 0.0f, 0.581238329f, 0.61116, 0.0,
-		-.435f, 1.0f, 0.25f, -0.813733339f, 0.0f, 0.581238329f, 0.58338, 1.0,
-		-.435f, 1.0f, 0.25f, -0.813733339f, 0.0f, 0.581238329f, 0.58338, 1.0,
-		-.385f, 1.0f, 0.32f, -0.707106769f, 0.0f, 0.707106769f, 0.61116, 1.0,
-		-.77f, 0.0f, 0.64f, -0.707106769f, 0.0f, 0.707106769f, 0.61116, 0.0,
-		-.435f, 1.0f, 0.25f, -0.813733339f, 0.0f, 0.581238329f, 0.58338, 1.0,
-		-.385f, 1.0f, 0.32f, -0.707106769f, 0.0f, 0.707106769f, 0.61116, 1.0,
-		-.77f, 0.0f, 0.64f, -0.707106769f, 0.0f, 0.707106769f, 0.61116, 0.0,
-		-.64f, 0.0f, 0.77f, -0.707106769f, 0.0f, 0.707106769f, 0.63894, 0.0,
-		-.385f, 1.0f, 0.32f, -0.707106769f, 0.0f, 0.707106769f, 0.61116, 1.0,
-		-.385f, 1.0f, 0.32f, -0.707106769f, 0.0f, 0.707106769f, 0.61116, 1.0,
-		-.32f, 1.0f, 0.385f, -0.581238329f, 0.0f, 0.813733339f, 0.63894, 1.0,
-		-.64f, 0.0f, 0.77f, -0.581238329f, 0.0f, 0.813733339f, 0.63894, 0.0,
-		-.385f, 1.0f, 0.32f, -0.707106769f, 0.0f, 0.707106769f, 0.61116, 1.0,
-		-.32f, 1.0f, 0.385f, -0.581238329f, 0.0f, 0.813733339f, 0.63894, 1.0,
-		-.64f, 0.0f, 0.77f, -0.581238329f, 0.0f, 0.813733339f, 0.63894, 0.0,
-		-.5f, 0.0f, 0.87f, -0.581238329f, 0.0f, 0.813733339f, 0.66672, 0.0,
-		-.32f, 1.0f, 0.385f, -0.581238329f, 0.0f, 0.813733339f, 0.63894, 1.0,
-		-.32f, 1.0f, 0.385f, -0.581238329f, 0.0f, 0.813733339f, 0.63894, 1.0,
-		-.25f, 1.0f, 0.435f, -0.400818795f, 0.0f, 0.916157305f, 0.66672, 1.0,
-		-.5f, 0.0f, 0.87f, -0.400818795f, 0.0f, 0.916157305f, 0.66672, 0.0,
-		-.32f, 1.0f, 0.385f, -0.581238329f, 0.0f, 0.813733339f, 0.63894, 1.0,
-		-.25f, 1.0f, 0.435f, -0.400818795f, 0.0f, 0.916157305f, 0.66672, 1.0,
-		-.5f, 0.0f, 0.87f, -0.400818795f, 0.0f, 0.916157305f, 0.66672, 0.0,
-		-.34f, 0.0f, 0.94f, -0.400818795f, 0.0f, 0.916157305f, 0.6945, 0.0,
-		-.25f, 1.0f, 0.435f, -0.400818795f, 0.0f, 0.916157305f, 0.66672, 1.0,
-		-.25f, 1.0f, 0.435f, -0.400818795f, 0.0f, 0.916157305f, 0.66672, 1.0,
-		-.17f, 1.0f, 0.47f, -0.229039446f, 0.0f, 0.973417103f, 0.6945, 1.0,
-		-.34f, 0.0f, 0.94f, -0.229039446f, 0.0f, 0.973417103f, 0.6945, 0.0,
-		-.25f, 1.0f, 0.435f, -0.400818795f, 0.0f, 0.916157305f, 0.66672, 1.0,
-		-.17f, 1.0f, 0.47f, -0.229039446f, 0.0f, 0.973417103f, 0.6945, 1.0,
-		-.34f, 0.0f, 0.94f, -0.229039446f, 0.0f, 0.973417103f, 0.6945, 0.0,
-		-.17f, 0.0f, 0.98f, -0.229039446f, 0.0f, 0.973417103f, 0.72228, 0.0,
-		-.17f, 1.0f, 0.47f, -0.229039446f, 0.0f, 0.973417103f, 0.6945, 1.0,
-		-.17f, 1.0f, 0.47f, -0.229039446f, 0.0f, 0.973417103f, 0.6945, 1.0,
-		-.085f, 1.0f, 0.49f, -0.116841137f, 0.0f, 0.993150651f, 0.72228, 1.0,
-		-.17f, 0.0f, 0.98f, -0.116841137f, 0.0f, 0.993150651f, 0.72228, 0.0,
-		-.17f, 1.0f, 0.47f, -0.229039446f, 0.0f, 0.973417103f, 0.6945, 1.0,
-		-.085f, 1.0f, 0.49f, -0.116841137f, 0.0f, 0.993150651f, 0.72228, 1.0,
-		-.17f, 0.0f, 0.98f, -0.116841137f, 0.0f, 0.993150651f, 0.72228, 0.0,
-		0.0f, 0.0f, 1.0f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 0.0,
-		-.085f, 1.0f, 0.49f, -0.116841137f, 0.0f, 0.993150651f, 0.72228, 1.0,
-		-.085f, 1.0f, 0.49f, -0.116841137f, 0.0f, 0.993150651f, 0.72228, 1.0,
-		0.0f, 1.0f, .5f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 1.0,
-		0.0f, 0.0f, 1.0f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 0.0,
-		-.085f, 1.0f, 0.49f, -0.116841137f, 0.0f, 0.993150651f, 0.72228, 1.0,
-		0.0f, 1.0f, .5f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 1.0,
-		0.0f, 0.0f, 1.0f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 0.0,
-		.17f, 0.0f, 0.98f, 0.116841137f, 0.0f, 0.993150651f, 0.77784, 0.0,
-		0.0f, 1.0f, .5f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 1.0,
-		0.0f, 1.0f, .5f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 1.0,
-		.085f, 1.0f, 0.49f, 0.229039446f, 0.0f, 0.973417103f, 0.77784, 1.0,
-		.17f, 0.0f, 0.98f, 0.229039446f, 0.0f, 0.973417103f, 0.77784, 0.0,
-		0.0f, 1.0f, .5f, 0.116841137f, 0.0f, 0.993150651f, 0.75, 1.0,
-		.085f, 1.0f, 0.49f, 0.229039446f, 0.0f, 0.973417103f, 0.77784, 1.0,
-		.17f, 0.0f, 0.98f, 0.229039446f, 0.0f, 0.973417103f, 0.77784, 0.0,
-		.34f, 0.0f, 0.94f, 0.229039446f, 0.0f, 0.973417103f, 0.80562, 0.0,
-		.085f, 1.0f, 0.49f, 0.229039446f, 0.0f, 0.973417103f, 0.77784, 1.0,
-		.085f, 1.0f, 0.49f, 0.229039446f, 0.0f, 0.973417103f, 0.77784, 1.0,
-		.17f, 1.0f, 0.47f, 0.400818795f, 0.0f, 0.916157305f, 0.80562, 1.0,
-		.34f, 0.0f, 0.94f, 0.400818795f, 0.0f, 0.916157305f, 0.80562, 0.0,
-		.085f, 1.0f, 0.49f, 0.229039446f, 0.0f, 0.973417103f, 0.77784, 1.0,
-		.17f, 1.0f, 0.47f, 0.400818795f, 0.0f, 0.916157305f, 0.80562, 1.0,
-		.34f, 0.0f, 0.94f, 0.400818795f, 0.0f, 0.916157305f, 0.80562, 0.0,
-		.5f, 0.0f, 0.87f, 0.400818795f, 0.0f, 0.916157305f, 0.8334, 0.0,
-		.17f, 1.0f, 0.47f, 0.400818795f, 0.0f, 0.916157305f, 0.80562, 1.0,
-		.17f, 1.0f, 0.47f, 0.400818795f, 0.0f, 0.916157305f, 0.80562, 1.0,
-		.25f, 1.0f, 0.435f, 0.581238329f, 0.0f, 0.813733339f, 0.8334, 1.0,
-		.5f, 0.0f, 0.87f, 0.581238329f, 0.0f, 0.813733339f, 0.8334, 0.0,
-		.17f, 1.0f, 0.47f, 0.400818795f, 0.0f, 0.916157305f, 0.80562, 1.0,
-		.25f, 1.0f, 0.435f, 0.581238329f, 0.0f, 0.813733339f, 0.8334, 1.0,
-		.5f, 0.0f, 0.87f, 0.581238329f, 0.0f, 0.813733339f, 0.8334, 0.0,
-		.64f, 0.0f, 0.77f, 0.581238329f, 0.0f, 0.813733339f, 0.86118, 0.0,
-		.25f, 1.0f, 0.435f, 0.581238329f, 0.0f, 0.813733339f, 0.8334, 1.0,
-		.25f, 1.0f, 0.435f, 0.581238329f, 0.0f, 0.813733339f, 0.8334, 1.0,
-		.32f, 1.0f, 0.385f, 0.707106769f, 0.0f, 0.707106769f, 0.86118, 1.0,
-		.64f, 0.0f, 0.77f, 0.707106769f, 0.0f, 0.707106769f, 0.86118, 0.0,
-		.25f, 1.0f, 0.435f, 0.581238329f, 0.0f, 0.813733339f, 0.8334, 1.0,
-		.32f, 1.0f, 0.385f, 0.707106769f, 0.0f, 0.707106769f, 0.86118, 1.0,
-		.64f, 0.0f, 0.77f, 0.707106769f, 0.0f, 0.707106769f, 0.86118, 0.0,
-		.77f, 0.0f, 0.64f, 0.707106769f, 0.0f, 0.707106769f, 0.88896, 0.0,
-		.32f, 1.0f, 0.385f, 0.707106769f, 0.0f, 0.707106769f, 0.86118, 1.0,
-		.32f, 1.0f, 0.385f, 0.707106769f, 0.0f, 0.707106769f, 0.86118, 1.0,
-		.385f, 1.0f, 0.32f, 0.813733339f, 0.0f, 0.581238329f, 0.88896, 1.0,
-		.77f, 0.0f, 0.64f, 0.813733339f, 0.0f, 0.581238329f, 0.88896, 0.0,
-		.32f, 1.0f, 0.385f, 0.707106769f, 0.0f, 0.707106769f, 0.86118, 1.0,
-		.385f, 1.0f, 0.32f, 0.813733339f, 0.0f, 0.581238329f, 0.88896, 1.0,
-		.77f, 0.0f, 0.64f, 0.813733339f, 0.0f, 0.581238329f, 0.88896, 0.0,
-		.87f, 0.0f, 0.5f, 0.813733339f, 0.0f, 0.581238329f, 0.91674, 0.0,
-		.385f, 1.0f, 0.32f, 0.813733339f, 0.0f, 0.581238329f, 0.88896, 1.0,
-		.385f, 1.0f, 0.32f, 0.813733339f, 0.0f, 0.581238329f, 0.88896, 1.0,
-		.435f, 1.0f, 0.25f, 0.916157305f, 0.0f, 0.400818795f, 0.91674, 1.0,
-		.87f, 0.0f, 0.5f, 0.916157305f, 0.0f, 0.400818795f, 0.91674, 0.0,
-		.385f, 1.0f, 0.32f, 0.813733339f, 0.0f, 0.581238329f, 0.88896, 1.0,
-		.435f, 1.0f, 0.25f, 0.916157305f, 0.0f, 0.400818795f, 0.91674, 1.0,
-		.87f, 0.0f, 0.5f, 0.916157305f, 0.0f, 0.400818795f, 0.91674, 0.0,
-		.94f, 0.0f, 0.34f, 0.916157305f, 0.0f, 0.400818795f, 0.94452, 0.0,
-		.435f, 1.0f, 0.25f, 0.916157305f, 0.0f, 0.400818795f, 0.91674, 1.0,
-		.435f, 1.0f, 0.25f, 0.916157305f, 0.0f, 0.400818795f, 0.91674, 1.0,
-		.47f, 1.0f, 0.17f, 0.973417103f, 0.0f, 0.229039446f, 0.94452, 1.0,
-		.94f, 0.0f, 0.34f, 0.973417103f, 0.0f, 0.229039446f, 0.94452, 0.0,
-		.435f, 1.0f, 0.25f, 0.916157305f, 0.0f, 0.400818795f, 0.91674, 1.0,
-		.47f, 1.0f, 0.17f, 0.973417103f, 0.0f, 0.229039446f, 0.94452, 1.0,
-		.94f, 0.0f, 0.34f, 0.973417103f, 0.0f, 0.229039446f, 0.94452, 0.0,
-		.98f, 0.0f, 0.17f, 0.973417103f, 0.0f, 0.229039446f, 0.9723, 0.0,
-		.47f, 1.0f, 0.17f, 0.973417103f, 0.0f, 0.229039446f, 0.94452, 1.0,
-		.47f, 1.0f, 0.17f, 0.973417103f, 0.0f, 0.229039446f, 0.94452, 1.0,
-		.49f, 1.0f, 0.085f, 0.993150651f, 0.0f, 0.116841137f, 0.9723, 1.0,
-		.98f, 0.0f, 0.17f, 0.993150651f, 0.0f, 0.116841137f, 0.9723, 0.0,
-		.47f, 1.0f, 0.17f, 0.973417103f, 0.0f, 0.229039446f, 0.94452, 1.0,
-		.49f, 1.0f, 0.085f, 0.993150651f, 0.0f, 0.116841137f, 0.9723, 1.0,
-		.98f, 0.0f, 0.17f, 0.993150651f, 0.0f, 0.116841137f, 0.9723, 0.0,
-		1.0f, 0.0f, 0.0f, 0.993150651f, 0.0f, 0.116841137f, 1.0, 0.0,
-		.49f, 1.0f, 0.085f, 0.993150651f, 0.0f, 0.116841137f, 0.9723, 1.0,
-		.49f, 1.0f, 0.085f, 0.993150651f, 0.0f, 0.116841137f, 0.9723, 1.0,
-		.5f, 1.0f, 0.0f, 0.993150651f, 0.0f, 0.116841137f, 1.0, 1.0,
-		1.0f, 0.0f, 0.0f, 0.993150651f, 0.0f, 0.116841137f, 1.0, 0.0,
-		.49f, 1.0f, 0.085f, 0.993150651f, 0.0f, 0.116841137f, 0.9723, 1.0
-	};
-
-	// store vertex and index count
-	m_TaperedCylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_TaperedCylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TaperedCylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_TaperedCylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TaperedCylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
+//	Stop finding the read back copy of a freed mesh,
+//  whose arena space a later mesh may take.  The copy
+//  is kept for the ranges already captured from it.
+///////////////////////////////////////////////////
+void ShapeMeshes::RetireCaptureSources(const GLMesh* mesh)
+{
+	for (CAPTURE_SOURCE& source : m_captureSources)
 	{
-		SetShaderMemoryLayout();
+		if ((mesh == NULL) ||
+			((source.vertexFormat == mesh->vertexFormat) && (source.firstVertex == mesh->firstVertex) &&
+			(source.indexOffset == mesh->indexOffset)))
+		{
+			source.bRetired = true;
+		}
 	}
 }
 
 ///////////////////////////////////////////////////
-//	LoadTorusMesh()
-//
-//	Create a torus mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//	Correct triangle drawing command:
+//	SubtractRanges()
 //
-//	glDrawArrays(GL_TRIANGLES, 0, meshes.gTorusMesh.nVertices);
+//	Leave out of the ranges every index the covered
+//  ranges of the same source also have, splitting a
+//  range whose middle is covered.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTorusMesh(float thickness)
+void ShapeMeshes::SubtractRanges(
+	std::vector<CAPTURED_RANGE>& ranges,
+	const std::vector<CAPTURED_RANGE>& covered)
 {
-	int _mainSegments = 30;
-	int _tubeSegments = 30;
-	float _mainRadius = 1.0f;
-	float _tubeRadius = .1f;
-
-	if (thickness <= 1.0)
-	{
-		_tubeRadius = thickness;
-	}
-
-	auto mainSegmentAngleStep = glm::radians(360.0f / float(_mainSegments));
-	auto tubeSegmentAngleStep = glm::radians(360.0f / float(_tubeSegments));
-
-	std::vector<glm::vec3> vertex_list;
-	std::vector<std::vector<glm::vec3>> segments_list;
-	std::vector<glm::vec2> texture_coords;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	glm::vec3 normal;
-	glm::vec3 vertex;
-	glm::vec2 text_coord;
-
-	// generate the torus vertices
-	auto currentMainSegmentAngle = 0.0f;
-	for (auto i = 0; i < _mainSegments; i++)
+	for (const CAPTURED_RANGE& cover : covered)
 	{
-		// Calculate sine and cosine of main segment angle
-		auto sinMainSegment = sin(currentMainSegmentAngle);
-		auto cosMainSegment = cos(currentMainSegmentAngle);
-		auto currentTubeSegmentAngle = 0.0f;
-		std::vector<glm::vec3> segment_points;
-		for (auto j = 0; j < _tubeSegments; j++)
+		GLuint coverEnd = cover.firstIndex + cover.indexCount;
+		std::vector<CAPTURED_RANGE> remaining;
+		for (const CAPTURED_RANGE& range : ranges)
 		{
-			// Calculate sine and cosine of tube segment angle
-			auto sinTubeSegment = sin(currentTubeSegmentAngle);
-			auto cosTubeSegment = cos(currentTubeSegmentAngle);
-
-			// Calculate vertex position on the surface of torus
-			auto surfacePosition = glm::vec3(
-				(_mainRadius + _tubeRadius * cosTubeSegment) * cosMainSegment,
-				(_mainRadius + _tubeRadius * cosTubeSegment) * sinMainSegment,
-				_tubeRadius * sinTubeSegment);
-
-			//vertex_list.push_back(surfacePosition);
-			segment_points.push_back(surfacePosition);
+			GLuint rangeEnd = range.firstIndex + range.indexCount;
+			if ((range.source != cover.source) || (rangeEnd <= cover.firstIndex) || (coverEnd <= range.firstIndex))
+			{
+				remaining.push_back(range);
+				continue;
+			}
 
-			// Update current tube angle
-			currentTubeSegmentAngle += tubeSegmentAngleStep;
+			CAPTURED_RANGE piece = range;
+			if (range.firstIndex < cover.firstIndex)
+			{
+				piece.indexCount = cover.firstIndex - range.firstIndex;
+				remaining.push_back(piece);
+			}
+			if (coverEnd < rangeEnd)
+			{
+				piece.firstIndex = coverEnd;
+				piece.indexCount = rangeEnd - coverEnd;
+				remaining.push_back(piece);
+			}
 		}
-		segments_list.push_back(segment_points);
-		segment_points.clear();
-
-		// Update main segment angle
-		currentMainSegmentAngle += mainSegmentAngleStep;
+		ranges.swap(remaining);
 	}
+}
 
-	float horizontalStep = 1.0 / _mainSegments;
-	float verticalStep = 1.0 / _tubeSegments;
-	float u = 0.0;
-	float v = 0.0;
+///////////////////////////////////////////////////
+//	MergeMeshParts()
+//
+//	Bake the ranges of the parts into one mesh, with
+//  the positions moved by each part's transform.
+//  Each range brings only the vertices its triangles
+//  use.  The triangles keep the order the parts drew
+//  them in, so where touching parts have faces in the
+//  same place, the same face is in front as before,
+//  and since each range was already reordered for the
+//  vertex caches, the mesh is not optimized again.
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::MergeMeshParts(
+	MeshHandle previous,
+	const MERGE_PART* parts,
+	int partCount,
+	glm::vec4& bounds)
+{
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	std::vector<GLint> remap;
+	glm::vec3 lowest = glm::vec3(FLT_MAX);
+	glm::vec3 highest = glm::vec3(-FLT_MAX);
 
-	// connect the various segments together, forming triangles
-	for (int i = 0; i < _mainSegments; i++)
+	for (int part = 0; part < partCount; part++)
 	{
-		for (int j = 0; j < _tubeSegments; j++)
+		const glm::mat4& model = parts[part].model;
+		for (int i = 0; i < parts[part].rangeCount; i++)
 		{
-			if (((i + 1) < _mainSegments) && ((j + 1) < _tubeSegments))
-			{
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i][j + 1]);
-				texture_coords.push_back(glm::vec2(u, v + verticalStep));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v + verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i + 1][j]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v - verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-			}
-			else
+			const CAPTURED_RANGE& range = parts[part].ranges[i];
+			const CAPTURE_SOURCE& source = m_captureSources[range.source];
+			remap.assign(source.vertices.size() / ShapeGenerator::FLOATS_PER_VERTEX, -1);
+
+			for (GLuint index = range.firstIndex; index < range.firstIndex + range.indexCount; index++)
 			{
-				if (((i + 1) == _mainSegments) && ((j + 1) == _tubeSegments))
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((i + 1) == _mainSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][j + 1]);
-					texture_coords.push_back(glm::vec2(u, v + verticalStep));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((j + 1) == _tubeSegments)
+				GLuint sourceVertex = source.indices[index];
+				if (remap[sourceVertex] < 0)
 				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i + 1][j]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
+					remap[sourceVertex] = (GLint)(vertices.size() / ShapeGenerator::FLOATS_PER_VERTEX);
+
+					const GLfloat* vertex = &source.vertices[sourceVertex * ShapeGenerator::FLOATS_PER_VERTEX];
+					glm::vec3 position = glm::vec3(model * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+					lowest = glm::min(lowest, position);
+					highest = glm::max(highest, position);
+					vertices.insert(vertices.end(), &position[0], &position[0] + 3);
+					vertices.insert(vertices.end(), vertex + 3, vertex + ShapeGenerator::FLOATS_PER_VERTEX);
 				}
-
+				indices.push_back((GLuint)remap[sourceVertex]);
 			}
-			v += verticalStep;
 		}
-		v = 0.0;
-		u += horizontalStep;
 	}
 
-	std::vector<GLfloat> combined_values;
-
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < vertex_list.size(); i++)
+	FreeMesh(previous);
+	if (indices.size() == 0)
 	{
-		vertex = vertex_list[i];
-		normal = normalize(vertex);
-		if (vertex.x < 0)
-		{
-			if (normal.x > 0)
-				normal.x *= -1;
-		}
-		else if (vertex.x > 0)
-		{
-			if (normal.x < 0)
-				normal.x *= -1;
-		}
-		if (vertex.y < 0)
-		{
-			if (normal.y > 0)
-				normal.y *= -1;
-		}
-		else if (vertex.y > 0)
-		{
-			if (normal.y < 0)
-				normal.y *= -1;
-		}
-		if (vertex.z < 0)
-		{
-			if (normal.z > 0)
-				normal.z *= -1;
-		}
-		else if (vertex.z > 0)
-		{
-			if (normal.z < 0)
-				normal.z *= -1;
-		}
-		text_coord = texture_coords[i];
-		combined_values.push_back(vertex.x);
-		combined_values.push_back(vertex.y);
-		combined_values.push_back(vertex.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(text_coord.x);
-		combined_values.push_back(text_coord.y);
+		bounds = glm::vec4(0.0f);
+		return(MeshHandle());
 	}
+	bounds = glm::vec4((lowest + highest) * 0.5f, glm::length(highest - lowest) * 0.5f);
 
-	// store vertex and index count
-	m_TorusMesh.nVertices = vertex_list.size();
-	m_TorusMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TorusMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TorusMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(1, m_TorusMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TorusMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	GLMesh mesh;
+	mesh.nVertices = (GLuint)(vertices.size() / ShapeGenerator::FLOATS_PER_VERTEX);
+	mesh.nIndices = (GLuint)indices.size();
+	ReserveScratch(PackedBytes(mesh.nVertices, mesh.nIndices));
+	return(StoreMesh(MeshHandle(), mesh, vertices.data(), indices.data()));
+}
 
-	if (m_bMemoryLayoutDone == false)
+///////////////////////////////////////////////////
+//	DrawMergedMesh()
+//
+//	Draw all the triangles of a merged mesh, with an
+//  identity model.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMergedMesh(MeshHandle mesh)
+{
+	const GLMesh* merged = m_meshes.Get(mesh);
+	if (merged == NULL)
 	{
-		SetShaderMemoryLayout();
+		return;
 	}
-}
-
 
+	DrawIndexRange(*merged, 0, merged->nIndices);
+}
 
 ///////////////////////////////////////////////////
 //	DrawBoxMesh()
@@ -2336,11 +2274,21 @@ void ShapeMeshes::LoadTorusMesh(float thickness)
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMesh()
 {
-	glBindVertexArray(m_BoxMesh.vao);
+	bool bBufferless = DrawPrimitive(m_BoxPrimitive, [&]() {
+		DrawPrimitiveRange(m_BoxPrimitive, 0, ShapeGenerator::PrimitiveVertexCount(m_BoxPrimitive));
+	});
+	if (bBufferless == true)
+	{
+		return;
+	}
 
-	glDrawElements(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	const GLMesh* mesh = m_meshes.Get(m_BoxMesh);
+	if (mesh == NULL)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawIndexRange(*mesh, 0, ShapeGenerator::BOX_INDEX_COUNT);
 }
 
 ///////////////////////////////////////////////////
@@ -2351,33 +2299,51 @@ void ShapeMeshes::DrawBoxMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMeshSide(BoxSide side)
 {
-	glBindVertexArray(m_BoxMesh.vao);
-
+	// each side is two triangles, drawn from the fans after the
+	// whole box's triangles
+	GLuint first = ShapeGenerator::BOX_SIDE_FIRST_INDEX;
 	switch (side)
 	{
 	case back:
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 		break;
 	case bottom:
-		glDrawArrays(GL_TRIANGLE_FAN, 4, 4);
+		first += 6;
 		break;
 	case left:
-		glDrawArrays(GL_TRIANGLE_FAN, 8, 4);
+		first += 12;
 		break;
 	case right:
-		glDrawArrays(GL_TRIANGLE_FAN, 12, 4);
+		first += 18;
 		break;
 	case top:
-		glDrawArrays(GL_TRIANGLE_FAN, 16, 4);
+		first += 24;
 		break;
 	case front:
-		glDrawArrays(GL_TRIANGLE_FAN, 20, 4);
+		first += 30;
 		break;
 	}
 
-	
+	bool bBufferless = DrawPrimitive(m_BoxPrimitive, [&]() {
+		DrawPrimitiveRange(m_BoxPrimitive, first, 6);
+	});
+	if (bBufferless == true)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	const GLMesh* mesh = m_meshes.Get(m_BoxMesh);
+	if (mesh == NULL)
+	{
+		return;
+	}
+
+	// a merged mesh is baked from the box's own triangles of the
+	// face, so a later whole box leaves the face out for the side
+	if (m_bCapturingMeshes == true)
+	{
+		first -= ShapeGenerator::BOX_SIDE_FIRST_INDEX;
+	}
+	DrawIndexRange(*mesh, first, 6);
 }
 
 ///////////////////////////////////////////////////
@@ -2389,15 +2355,24 @@ void ShapeMeshes::DrawBoxMeshSide(BoxSide side)
 void ShapeMeshes::DrawConeMesh(
 	bool bDrawBottom)
 {
-	glBindVertexArray(m_ConeMesh.vao);
-
-	if (bDrawBottom == true)
+	bool bBufferless = DrawPrimitive(m_ConePrimitive, [&]() {
+		GLsizei count = ShapeGenerator::PrimitiveVertexCount(m_ConePrimitive);
+		GLint bottom = (bDrawBottom == true) ? 0 : ShapeGenerator::CapIndexCount(m_ConePrimitive.segmentsA);
+		DrawPrimitiveRange(m_ConePrimitive, bottom, count - bottom);	//bottom and sides
+	});
+	if (bBufferless == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
+		return;
 	}
-	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
 
-	glBindVertexArray(0);
+	DrawLod(m_ConeLods, bDrawBottom, [&](const GLMesh& mesh) {
+		GLuint bottom = ShapeGenerator::CapIndexCount(mesh.nSegments);
+		if (bDrawBottom == true)
+		{
+			DrawIndexRange(mesh, 0, bottom);		//bottom
+		}
+		DrawIndexRange(mesh, bottom, mesh.nIndices - bottom);	//sides
+	});
 }
 
 ///////////////////////////////////////////////////
@@ -2411,22 +2386,62 @@ void ShapeMeshes::DrawCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_CylinderMesh.vao);
-
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
-	}
-	if (bDrawTop == true)
+	bool bBufferless = DrawPrimitive(m_CylinderPrimitive, [&]() {
+		GLsizei count = ShapeGenerator::PrimitiveVertexCount(m_CylinderPrimitive);
+		GLint cap = ShapeGenerator::CapIndexCount(m_CylinderPrimitive.segmentsA);
+		if (bDrawBottom == true)
+		{
+			DrawPrimitiveRange(m_CylinderPrimitive, 0, cap);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawPrimitiveRange(m_CylinderPrimitive, cap, cap);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawPrimitiveRange(m_CylinderPrimitive, cap * 2, count - (cap * 2));	//sides
+		}
+	});
+	if (bBufferless == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
+		return;
 	}
-	if (bDrawSides == true)
+
+	bool bTessellated = DrawPatches(m_CylinderPatches, g_CylinderSurface, 1.0f, [&](const GLMesh& mesh) {
+		GLuint cap = ShapeGenerator::CapPatchIndexCount();
+		if (bDrawBottom == true)
+		{
+			DrawPatchRange(mesh, 0, cap);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawPatchRange(mesh, cap, cap);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawPatchRange(mesh, cap * 2, mesh.nIndices - (cap * 2));	//sides
+		}
+	});
+	if (bTessellated == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		return;
 	}
 
-	glBindVertexArray(0);
+	DrawLod(m_CylinderLods, (bDrawTop && bDrawBottom && bDrawSides), [&](const GLMesh& mesh) {
+		GLuint cap = ShapeGenerator::CapIndexCount(mesh.nSegments);
+		if (bDrawBottom == true)
+		{
+			DrawIndexRange(mesh, 0, cap);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawIndexRange(mesh, cap, cap);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawIndexRange(mesh, cap * 2, mesh.nIndices - (cap * 2));	//sides
+		}
+	});
 }
 
 ///////////////////////////////////////////////////
@@ -2437,11 +2452,21 @@ void ShapeMeshes::DrawCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMesh()
 {
-	glBindVertexArray(m_PlaneMesh.vao);
+	bool bBufferless = DrawPrimitive(m_PlanePrimitive, [&]() {
+		DrawPrimitiveRange(m_PlanePrimitive, 0, ShapeGenerator::PrimitiveVertexCount(m_PlanePrimitive));
+	});
+	if (bBufferless == true)
+	{
+		return;
+	}
 
-	glDrawElements(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-	
-	glBindVertexArray(0);
+	const GLMesh* mesh = m_meshes.Get(m_PlaneMesh);
+	if (mesh == NULL)
+	{
+		return;
+	}
+
+	DrawIndexRange(*mesh, 0, mesh->nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2452,11 +2477,13 @@ void ShapeMeshes::DrawPlaneMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMesh()
 {
-	glBindVertexArray(m_PrismMesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
+	const GLMesh* mesh = m_meshes.Get(m_PrismMesh);
+	if (mesh == NULL)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawIndexRange(*mesh, 0, mesh->nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2467,11 +2494,13 @@ void ShapeMeshes::DrawPrismMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3Mesh()
 {
-	glBindVertexArray(m_Pyramid3Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
+	const GLMesh* mesh = m_meshes.Get(m_Pyramid3Mesh);
+	if (mesh == NULL)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawIndexRange(*mesh, 0, mesh->nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2482,11 +2511,13 @@ void ShapeMeshes::DrawPyramid3Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4Mesh()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
+	const GLMesh* mesh = m_meshes.Get(m_Pyramid4Mesh);
+	if (mesh == NULL)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawIndexRange(*mesh, 0, mesh->nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2497,11 +2528,25 @@ void ShapeMeshes::DrawPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
+	bool bBufferless = DrawPrimitive(m_SpherePrimitive, [&]() {
+		DrawPrimitiveRange(m_SpherePrimitive, 0, ShapeGenerator::PrimitiveVertexCount(m_SpherePrimitive));
+	});
+	if (bBufferless == true)
+	{
+		return;
+	}
 
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	bool bTessellated = DrawPatches(m_SpherePatches, g_SphereSurface, 0.0f, [&](const GLMesh& mesh) {
+		DrawPatchRange(mesh, 0, mesh.nIndices);
+	});
+	if (bTessellated == true)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawLod(m_SphereLods, true, [&](const GLMesh& mesh) {
+		DrawIndexRange(mesh, 0, mesh.nIndices);
+	});
 }
 
 ///////////////////////////////////////////////////
@@ -2512,11 +2557,26 @@ void ShapeMeshes::DrawSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
+	bool bBufferless = DrawPrimitive(m_SpherePrimitive, [&]() {
+		DrawPrimitiveRange(m_SpherePrimitive, 0, ShapeGenerator::PrimitiveVertexCount(m_SpherePrimitive) / 2);
+	});
+	if (bBufferless == true)
+	{
+		return;
+	}
 
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices/2, GL_UNSIGNED_INT, (void*)0);
+	// the top rings of patches, as with the triangles
+	bool bTessellated = DrawPatches(m_SpherePatches, g_SphereSurface, 0.0f, [&](const GLMesh& mesh) {
+		DrawPatchRange(mesh, 0, mesh.nIndices / 2);
+	});
+	if (bTessellated == true)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawLod(m_SphereLods, false, [&](const GLMesh& mesh) {
+		DrawIndexRange(mesh, 0, mesh.nIndices/2);
+	});
 }
 
 ///////////////////////////////////////////////////
@@ -2530,22 +2590,62 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
-
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
-	}
-	if (bDrawTop == true)
+	bool bBufferless = DrawPrimitive(m_TaperedCylinderPrimitive, [&]() {
+		GLsizei count = ShapeGenerator::PrimitiveVertexCount(m_TaperedCylinderPrimitive);
+		GLint cap = ShapeGenerator::CapIndexCount(m_TaperedCylinderPrimitive.segmentsA);
+		if (bDrawBottom == true)
+		{
+			DrawPrimitiveRange(m_TaperedCylinderPrimitive, 0, cap);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawPrimitiveRange(m_TaperedCylinderPrimitive, cap, cap);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawPrimitiveRange(m_TaperedCylinderPrimitive, cap * 2, count - (cap * 2));	//sides
+		}
+	});
+	if (bBufferless == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
+		return;
 	}
-	if (bDrawSides == true)
+
+	bool bTessellated = DrawPatches(m_TaperedCylinderPatches, g_CylinderSurface, g_TaperedTopRadius, [&](const GLMesh& mesh) {
+		GLuint cap = ShapeGenerator::CapPatchIndexCount();
+		if (bDrawBottom == true)
+		{
+			DrawPatchRange(mesh, 0, cap);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawPatchRange(mesh, cap, cap);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawPatchRange(mesh, cap * 2, mesh.nIndices - (cap * 2));	//sides
+		}
+	});
+	if (bTessellated == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 288);
+		return;
 	}
 
-	glBindVertexArray(0);
+	DrawLod(m_TaperedCylinderLods, (bDrawTop && bDrawBottom && bDrawSides), [&](const GLMesh& mesh) {
+		GLuint cap = ShapeGenerator::CapIndexCount(mesh.nSegments);
+		if (bDrawBottom == true)
+		{
+			DrawIndexRange(mesh, 0, cap);	//bottom
+		}
+		if (bDrawTop == true)
+		{
+			DrawIndexRange(mesh, cap, cap);	//top
+		}
+		if (bDrawSides == true)
+		{
+			DrawIndexRange(mesh, cap * 2, mesh.nIndices - (cap * 2));	//sides
+		}
+	});
 }
 
 ///////////////////////////////////////////////////
@@ -2556,11 +2656,25 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	bool bBufferless = DrawPrimitive(m_TorusPrimitive, [&]() {
+		DrawPrimitiveRange(m_TorusPrimitive, 0, ShapeGenerator::PrimitiveVertexCount(m_TorusPrimitive));
+	});
+	if (bBufferless == true)
+	{
+		return;
+	}
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices);
+	bool bTessellated = DrawPatches(m_TorusPatches, g_TorusSurface, m_torusTubeRadius, [&](const GLMesh& mesh) {
+		DrawPatchRange(mesh, 0, mesh.nIndices);
+	});
+	if (bTessellated == true)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawLod(m_TorusLods, true, [&](const GLMesh& mesh) {
+		DrawIndexRange(mesh, 0, mesh.nIndices);
+	});
 }
 
 ///////////////////////////////////////////////////
@@ -2571,11 +2685,30 @@ void ShapeMeshes::DrawTorusMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	// the vertices run segment by segment around the ring
+	bool bBufferless = DrawPrimitive(m_TorusPrimitive, [&]() {
+		GLsizei segmentVertices = m_TorusPrimitive.segmentsB * 6;
+		DrawPrimitiveRange(m_TorusPrimitive, 0, segmentVertices * (m_TorusPrimitive.segmentsA / 2));
+	});
+	if (bBufferless == true)
+	{
+		return;
+	}
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
+	// the patches also run around the ring
+	bool bTessellated = DrawPatches(m_TorusPatches, g_TorusSurface, m_torusTubeRadius, [&](const GLMesh& mesh) {
+		DrawPatchRange(mesh, 0, mesh.nIndices / 2);
+	});
+	if (bTessellated == true)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawLod(m_TorusLods, false, [&](const GLMesh& mesh) {
+		// the indices run segment by segment around the ring
+		GLuint segmentIndices = mesh.nIndices / mesh.nSegments;
+		DrawIndexRange(mesh, 0, segmentIndices * (mesh.nSegments / 2));
+	});
 }
 
 glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
@@ -2589,7 +2722,7 @@ glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::
 	float v2z = p2.z - p1.z;
 	Normal.x = v1y * v2z - v1z * v2y;
 	Normal.y = v1z * v2x - v1x * v2z;
-	Normal.y = v1x * v2y - v1y * v2x;
+	Normal.z = v1x * v2y - v1y * v2x;
 	float len = (float)sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
 	if (len == 0)
 	{
@@ -2606,8 +2739,38 @@ glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::
 
 
 
-void ShapeMeshes::SetShaderMemoryLayout()
+///////////////////////////////////////////////////
+//	SetShaderMemoryLayout()
+//
+//	Set the attribute pointers of the bound VAO for a
+//  vertex format.  The integers of the packed formats
+//  are read unnormalized - the shader scales them.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetShaderMemoryLayout(VertexFormat format)
 {
+	if (format == quantizedVertices)
+	{
+		GLint stride = sizeof(VertexQuantizer::QUANTIZED_VERTEX);
+		glVertexAttribPointer(0, g_FloatsPerVertex, GL_SHORT, GL_FALSE, stride, (void*)offsetof(VertexQuantizer::QUANTIZED_VERTEX, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_FALSE, stride, (void*)offsetof(VertexQuantizer::QUANTIZED_VERTEX, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, g_FloatsPerUV, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(VertexQuantizer::QUANTIZED_VERTEX, uv));
+		glEnableVertexAttribArray(2);
+		return;
+	}
+	if (format == compactVertices)
+	{
+		GLint stride = sizeof(VertexQuantizer::COMPACT_VERTEX);
+		glVertexAttribPointer(0, g_FloatsPerVertex, GL_SHORT, GL_FALSE, stride, (void*)offsetof(VertexQuantizer::COMPACT_VERTEX, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_BYTE, GL_FALSE, stride, (void*)offsetof(VertexQuantizer::COMPACT_VERTEX, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, g_FloatsPerUV, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(VertexQuantizer::COMPACT_VERTEX, uv));
+		glEnableVertexAttribArray(2);
+		return;
+	}
+
 	// The following code defines the layout of the mesh data in memory - each mesh needs
 	// to have the same memory layout so that the data is retrieved properly by the shaders
 
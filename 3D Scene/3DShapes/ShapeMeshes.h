@@ -14,42 +14,274 @@
 
 #include <glm/glm.hpp>
 
+#include "ShapeGenerator.h"
+#include "MeshCache.h"
+#include "MeshletBuilder.h"
+#include "RangeAllocator.h"
+#include "SlotMap.h"
+
+#include <string>
+#include <vector>
+
 /***********************************************************
  *  ShapeMeshes
  *
  *  This class contains the code for defining the various
- *  basic 3D shapes, loading into memory, and drawing
+ *  basic 3D shapes, loading into memory, and drawing.  The
+ *  meshes of each vertex format share one vertex buffer,
+ *  one index buffer and one VAO, so drawing a different
+ *  mesh changes no GL state.
  ***********************************************************/
 class ShapeMeshes
 {
 public:
+	// the ways the vertices of a mesh can be stored
+	enum VertexFormat
+	{
+		floatVertices,		// 32 bytes - float position, normal, texture coords
+		quantizedVertices,	// 16 bytes - 16-bit position and normal, half texture coords
+		compactVertices		// 12 bytes - as quantized, with an 8-bit normal
+	};
+
 	// constructor
 	ShapeMeshes();
+	// destructor
+	~ShapeMeshes();
 
 private:
 
-	// stores the GL data relative to a given mesh
+	// stores where a given mesh is in the arena of its vertex format
 	struct GLMesh
 	{
-		GLuint vao;         // Handle for the vertex array object
-		GLuint vbos[2];     // Handles for the vertex buffer objects
-		GLuint nVertices;	// Number of vertices for the mesh
-		GLuint nIndices;    // Number of indices for the mesh
+		GLuint firstVertex = 0;	// First vertex of the mesh in the vertex buffer
+		GLuint indexOffset = 0;	// Byte offset of the mesh's indices in the index buffer
+		GLuint nVertices = 0;	// Number of vertices for the mesh
+		GLuint nIndices = 0;    // Number of indices for the mesh
+		GLuint nSegments = 0;	// Number of segments around a round mesh
+		GLenum indexType = GL_UNSIGNED_INT;	// Type of the stored indices
+		VertexFormat vertexFormat = floatVertices;	// How the vertices are stored
+		GLuint vertexSize = 0;	// Bytes in one stored vertex
+		glm::vec4 vertexDecode = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);	// Position scale and normal scale for the shader
+		std::vector<MeshletBuilder::MESHLET> meshlets;	// Clusters of the triangles for culling, if loaded with it on
+	};
+
+public:
+	// handle to a loaded mesh - stale once the mesh is destroyed
+	typedef SlotMap<GLMesh>::Handle MeshHandle;
+
+	// the amount of geometry stored for the loaded meshes
+	struct MESH_STATS
+	{
+		int meshes;
+		int vertices;
+		int indices;
+		int vertexBytes;
+		int indexBytes;
+		int arenaBytes;		// size of the shared buffers holding them
+	};
+
+	// one indexed draw from a mesh arena, laid out as the
+	// commands of glMultiDrawElementsIndirect
+	struct DRAW_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// a range of the triangles of a shape, as a draw method drew it
+	// while capturing - the source is a copy of the shape's mesh,
+	// read back when it was first captured, so the range stays
+	// usable after the mesh is freed
+	struct CAPTURED_RANGE
+	{
+		int source;
+		GLuint firstIndex;
+		GLuint indexCount;
+	};
+
+	// one part of a merged mesh - the ranges it drew and the
+	// transform placing them
+	struct MERGE_PART
+	{
+		const CAPTURED_RANGE* ranges;
+		int rangeCount;
+		glm::mat4 model;
+	};
+
+	// the most detail levels kept for a round mesh
+	static const int MAX_LOD_LEVELS = 4;
+
+	// the triangles drawn since the stats were last reset, and
+	// how many the same draws have at full detail
+	struct LOD_STATS
+	{
+		int drawnTriangles;
+		int fullDetailTriangles;
+		int reducedDraws;		// draws that used a simplified level
 	};
 
+	// the clusters of the round meshes tested against the view
+	// since the stats were last reset, and the triangles of the
+	// ones drawn
+	struct CLUSTER_STATS
+	{
+		int testedClusters;
+		int drawnClusters;
+		int submittedTriangles;
+		int drawnTriangles;
+	};
+
+private:
+	static const int VERTEX_FORMAT_COUNT = 3;
+
+	// a round mesh at decreasing tessellations, each with the
+	// largest distance of its surface from the true shape at
+	// unit size - the first level has full detail
+	struct LOD_CHAIN
+	{
+		MeshHandle levels[MAX_LOD_LEVELS];
+		float errors[MAX_LOD_LEVELS] = {};
+		int levelCount = 0;
+	};
+
+	// the shared buffers all meshes of one vertex format are
+	// suballocated from
+	struct GEOMETRY_ARENA
+	{
+		GLuint vao = 0;				// Vertex array object reading the buffers
+		GLuint buffers[2] = {};		// Vertex buffer and index buffer
+		RangeAllocator vertices;	// Free space of the vertex buffer, in vertices
+		RangeAllocator indexBytes;	// Free space of the index buffer, in bytes
+	};
+
+	// a collected draw, and the state it is drawn with
+	struct BATCH_DRAW
+	{
+		VertexFormat vertexFormat;
+		GLenum indexType;
+		glm::vec4 vertexDecode;
+	};
+
+	// storage for all the loaded meshes
+	SlotMap<GLMesh> m_meshes;
+	GEOMETRY_ARENA m_arenas[VERTEX_FORMAT_COUNT];
+
+	// draws collected between BeginDrawBatch() and EndDrawBatch()
+	bool m_bBatchingDraws;
+	std::vector<BATCH_DRAW> m_batchDraws;
+	std::vector<DRAW_COMMAND> m_batchCommands;
+	GLuint m_indirectBuffer;
+
 	// the available 3D shapes
-	GLMesh m_BoxMesh;
-	GLMesh m_ConeMesh;
-	GLMesh m_CylinderMesh;
-	GLMesh m_PlaneMesh;
-	GLMesh m_PrismMesh;
-	GLMesh m_Pyramid3Mesh;
-	GLMesh m_Pyramid4Mesh;
-	GLMesh m_SphereMesh;
-	GLMesh m_TaperedCylinderMesh;
-	GLMesh m_TorusMesh;
-
-	bool m_bMemoryLayoutDone;
+	MeshHandle m_BoxMesh;
+	LOD_CHAIN m_ConeLods;
+	LOD_CHAIN m_CylinderLods;
+	MeshHandle m_PlaneMesh;
+	MeshHandle m_PrismMesh;
+	MeshHandle m_Pyramid3Mesh;
+	MeshHandle m_Pyramid4Mesh;
+	LOD_CHAIN m_SphereLods;
+	LOD_CHAIN m_TaperedCylinderLods;
+	LOD_CHAIN m_TorusLods;
+
+	bool m_bOptimizeMeshes;
+	VertexFormat m_vertexFormat;
+
+	// the memory meshes are generated and packed in before they
+	// are uploaded, kept between loads and only ever grown
+	std::vector<unsigned char> m_scratchMemory;
+	LinearArena m_scratch;
+	int m_scratchGrowths;
+
+	// how the detail level of the round meshes is chosen, and
+	// what it saved
+	float m_lodPixelsPerUnit;
+	float m_lodErrorBudget;
+	LOD_STATS m_lodStats;
+	bool m_bCountingStats;
+	bool m_bCountingFullDetail;
+	bool m_bDrawingReducedLod;
+
+	// the view the clusters of the round meshes are culled
+	// against, in the space of the current object's mesh
+	bool m_bClusterCulling;
+	bool m_bClusterViewSet;
+	bool m_bClusterOrthographic;
+	glm::vec4 m_clusterPlanes[6];
+	glm::vec3 m_clusterCamera;		// position, or view direction when orthographic
+	CLUSTER_STATS m_clusterStats;
+	bool m_bDrawingClosedSurface;
+
+	// the file the round meshes are kept in between runs
+	MeshCache m_meshCache;
+
+	// the coarse patches the round shapes are drawn from with
+	// tessellation on, and the programs drawing them
+	MeshHandle m_CylinderPatches;
+	MeshHandle m_SpherePatches;
+	MeshHandle m_TaperedCylinderPatches;
+	MeshHandle m_TorusPatches;
+	float m_torusTubeRadius;
+	GLuint m_tessellationProgram;
+	GLuint m_mainProgram;
+	GLint m_surfaceShapeLocation;
+	GLint m_surfaceRadiusLocation;
+	GLint m_viewportHeightLocation;
+	GLint m_edgePixelsLocation;
+
+	// one shape of a draw of several bufferless shapes, laid out
+	// as the vertex shader reads it - the type and tessellation,
+	// where its vertices start in the draw and in the shape, and
+	// its parameter and transform
+	struct PRIMITIVE_RECORD
+	{
+		GLint shape[4];
+		GLint range[4];
+		GLfloat parameters[4];
+		glm::mat4 model;
+	};
+
+	// the shapes drawn with no vertex data with bufferless drawing
+	// on, the program making their vertices, and the records of
+	// the draws of several shapes
+	ShapeGenerator::PRIMITIVE m_BoxPrimitive;
+	ShapeGenerator::PRIMITIVE m_ConePrimitive;
+	ShapeGenerator::PRIMITIVE m_CylinderPrimitive;
+	ShapeGenerator::PRIMITIVE m_PlanePrimitive;
+	ShapeGenerator::PRIMITIVE m_SpherePrimitive;
+	ShapeGenerator::PRIMITIVE m_TaperedCylinderPrimitive;
+	ShapeGenerator::PRIMITIVE m_TorusPrimitive;
+	GLuint m_bufferlessProgram;
+	GLuint m_primitiveVao;			// has no attributes at all
+	GLuint m_primitiveBuffer;		// records of the draw of several
+	GLint m_primitiveCountLocation;
+	GLint m_primitiveShapeLocation;
+	GLint m_primitiveParameterLocation;
+	std::vector<PRIMITIVE_RECORD> m_batchPrimitives;
+	std::vector<PRIMITIVE_RECORD> m_drawPrimitives;
+
+	// a mesh read back from its arena while capturing, as float
+	// vertices and 32-bit indices - retired once the mesh is freed,
+	// but kept for the ranges captured from it
+	struct CAPTURE_SOURCE
+	{
+		VertexFormat vertexFormat;
+		GLuint firstVertex;
+		GLuint indexOffset;
+		bool bRetired;
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+	};
+
+	// the ranges recorded while capturing, and the meshes they
+	// were read back from
+	bool m_bCapturingMeshes;
+	bool m_bCaptureIncomplete;
+	std::vector<CAPTURED_RANGE> m_capturedRanges;
+	std::vector<CAPTURE_SOURCE> m_captureSources;
 
 public:
         enum BoxSide
@@ -63,17 +295,28 @@ public:
 	}; 
 
 	// methods for loading the shape mesh data 
-	// into memory
+	// into memory - the round shapes can be loaded
+	// with more or fewer segments for more or less
+	// detail, and keep simplified levels of it for
+	// objects that are small on screen
 	void LoadBoxMesh();
-	void LoadConeMesh();
-	void LoadCylinderMesh();
+	void LoadConeMesh(
+		int segments = ShapeGenerator::DEFAULT_ROUND_SEGMENTS);
+	void LoadCylinderMesh(
+		int segments = ShapeGenerator::DEFAULT_ROUND_SEGMENTS);
 	void LoadPlaneMesh();
 	void LoadPrismMesh();
 	void LoadPyramid3Mesh();
 	void LoadPyramid4Mesh();
-	void LoadSphereMesh();
-	void LoadTaperedCylinderMesh();
-	void LoadTorusMesh(float thickness = 0.2);
+	void LoadSphereMesh(
+		int slices = ShapeGenerator::DEFAULT_SPHERE_SLICES,
+		int stacks = ShapeGenerator::DEFAULT_SPHERE_STACKS);
+	void LoadTaperedCylinderMesh(
+		int segments = ShapeGenerator::DEFAULT_ROUND_SEGMENTS);
+	void LoadTorusMesh(
+		float thickness = 0.2,
+		int mainSegments = ShapeGenerator::DEFAULT_TORUS_MAIN_SEGMENTS,
+		int tubeSegments = ShapeGenerator::DEFAULT_TORUS_TUBE_SEGMENTS);
 
 	// methods for drawing the shape mesh in the
 	// display window
@@ -98,6 +341,145 @@ public:
 	void DrawTorusMesh();
 	void DrawHalfTorusMesh();
 
+	// free the GL objects of every loaded mesh - the handles
+	// of destroyed meshes no longer draw anything
+	void DestroyMeshes();
+
+	// get the amount of geometry stored for the loaded meshes
+	MESH_STATS GetMeshStats() const;
+
+	// reorder the triangles and vertices of the meshes loaded
+	// from now on for the vertex caches and early depth test -
+	// on by default
+	void SetMeshOptimization(bool bOptimize) { m_bOptimizeMeshes = bOptimize; }
+
+	// store the meshes loaded from now on in the passed in
+	// vertex format - float by default
+	void SetVertexFormat(VertexFormat format) { m_vertexFormat = format; }
+
+	// collect the draws of the draw methods called from now on
+	// instead of drawing them, then draw them all with as few
+	// multi-draw calls as possible - the collected draws must
+	// not need different uniforms
+	void BeginDrawBatch();
+	void EndDrawBatch();
+
+	// the on-screen size of the object drawn next, in pixels per
+	// unit of its mesh - each round mesh is drawn at its coarsest
+	// level whose error, at that size, fits the error budget
+	void SetLodScale(float pixelsPerUnit) { m_lodPixelsPerUnit = pixelsPerUnit; }
+	// the largest error allowed on screen, in pixels - zero, the
+	// default, always draws full detail
+	void SetLodErrorBudget(float pixels) { m_lodErrorBudget = pixels; }
+	float GetLodErrorBudget() const { return(m_lodErrorBudget); }
+
+	// the triangles drawn and saved since the last reset
+	LOD_STATS GetLodStats() const { return(m_lodStats); }
+	void ResetLodStats() { m_lodStats = LOD_STATS(); }
+	// count the draws from now on in the detail level and cluster
+	// stats - on by default.  A frame that draws its objects more
+	// than once counts only one of its passes
+	void SetCountingStats(bool bCounting) { m_bCountingStats = bCounting; }
+
+	// group the triangles of the round meshes loaded from now on
+	// into clusters, and draw the meshes that have them one cluster
+	// at a time, leaving out the clusters outside the view and, for
+	// closed surfaces, the ones facing away from the camera - off
+	// by default
+	void SetClusterCulling(bool bCull) { m_bClusterCulling = bCull; }
+	bool GetClusterCulling() const { return(m_bClusterCulling); }
+	// the transforms of the object drawn next, for culling its
+	// clusters - until it is set, no cluster is culled
+	void SetClusterView(
+		const glm::mat4& model,
+		const glm::mat4& view,
+		const glm::mat4& projection);
+	void ClearClusterView() { m_bClusterViewSet = false; }
+
+	// the clusters tested and drawn since the last reset
+	CLUSTER_STATS GetClusterStats() const { return(m_clusterStats); }
+	void ResetClusterStats() { m_clusterStats = CLUSTER_STATS(); }
+
+	// keep the round meshes loaded from now on in the passed in
+	// cache file - meshes it has are uploaded from the mapped file
+	// instead of generated, and the rest are added to it.  Returns
+	// false if the file has to be made again
+	bool UseMeshCache(const std::string& filename);
+	// write the meshes generated since the cache was opened to it
+	bool SaveMeshCache() { return(m_meshCache.Save()); }
+	// what the cache file held and how many loads it served
+	MeshCache::CACHE_STATS GetMeshCacheStats() const { return(m_meshCache.GetStats()); }
+
+	// the size of the scratch memory meshes are generated and packed
+	// in, and how many times it had to grow - once the largest mesh
+	// was loaded, loads take no memory of their own
+	size_t GetScratchBytes() const { return(m_scratch.GetCapacity()); }
+	int GetScratchGrowths() const { return(m_scratchGrowths); }
+
+	// draw the sphere, cylinders and torus loaded from now on from
+	// coarse patches, which the passed in tessellation program
+	// refines by the length of their edges on screen and puts on
+	// the true surface - they then keep no detail levels.  Their
+	// draws are not batched, and put the main program back after.
+	// A program of zero loads stored triangles again
+	void SetTessellation(GLuint tessellationProgram, GLuint mainProgram);
+	bool GetTessellation() const { return(m_tessellationProgram != 0); }
+	// the viewport height the patch edges are measured against, and
+	// the pixels each refined edge should cover on screen
+	void SetTessellationView(int viewportHeight, float edgePixels);
+
+	// one shape of a draw of several bufferless shapes, placed in
+	// the model of the draw by its own transform
+	struct PRIMITIVE_INSTANCE
+	{
+		ShapeGenerator::PRIMITIVE shape;
+		glm::mat4 model;
+	};
+
+	// draw the box, plane, sphere, cylinders, cone and torus loaded
+	// from now on with the passed in bufferless program, which makes
+	// their vertices from their type and tessellation alone - they
+	// then keep no vertex data, detail levels or patches.  Their
+	// draws put the main program back after, and the draws of a
+	// batch become one draw.  A program of zero loads stored
+	// triangles again
+	void SetBufferless(GLuint bufferlessProgram, GLuint mainProgram);
+	bool GetBufferless() const { return(m_bufferlessProgram != 0); }
+	// draw shapes of any types with the bufferless program in one
+	// draw, each placed by its own transform
+	void DrawPrimitives(const PRIMITIVE_INSTANCE* instances, int count);
+	// the program the tessellated and bufferless draws put back
+	// after, for a pass that draws the stored meshes with a program
+	// of its own
+	void SetMainProgram(GLuint mainProgram) { m_mainProgram = mainProgram; }
+
+	// record the full detail triangle ranges the draw methods called
+	// from now on draw, instead of drawing them.  Shapes drawn with
+	// no stored triangles, bufferless or from patches, cannot be
+	// captured, and EndMeshCapture() then returns false
+	void BeginMeshCapture();
+	bool EndMeshCapture();
+	// move the ranges captured since the last call into the passed
+	// in list
+	void TakeCapturedRanges(std::vector<CAPTURED_RANGE>& ranges);
+	// leave out of the ranges the triangles the covered ranges also
+	// draw
+	static void SubtractRanges(
+		std::vector<CAPTURED_RANGE>& ranges,
+		const std::vector<CAPTURED_RANGE>& covered);
+
+	// bake the ranges of the parts, each moved by its transform, into
+	// one mesh drawn with an identity model, replacing the previous
+	// merged mesh.  The normals are copied as they are, since the
+	// shaders light the untransformed normals.  bounds gets the
+	// center and radius of a sphere around the merged mesh
+	MeshHandle MergeMeshParts(
+		MeshHandle previous,
+		const MERGE_PART* parts,
+		int partCount,
+		glm::vec4& bounds);
+	void DrawMergedMesh(MeshHandle mesh);
+	void FreeMergedMesh(MeshHandle mesh) { FreeMesh(mesh); }
 
 private:
 
@@ -108,5 +490,173 @@ private:
 
 	// called to set the memory layout 
 	// template for shader data
-	void SetShaderMemoryLayout();
+	void SetShaderMemoryLayout(VertexFormat format);
+
+	// called to reorder the generated data of a mesh for the
+	// GPU, keeping each of its draw ranges drawable on its own
+	void OptimizeMesh(
+		const GLMesh& mesh,
+		GLfloat* vertices,
+		GLuint* indices,
+		const GLuint* rangeStarts,
+		int rangeCount);
+
+	// called to pack the generated data of a mesh and copy
+	// it into the arena of the current vertex format, adding
+	// it to the mesh cache under a non-zero key
+	void UploadMesh(
+		GLMesh& mesh,
+		const GLfloat* vertices,
+		const GLuint* indices,
+		uint64_t cacheKey);
+	// called to copy packed data into the arena of the mesh's
+	// vertex format
+	void UploadMeshData(
+		GLMesh& mesh,
+		const void* vertexData,
+		const void* indexData);
+
+	// called to get the key a round mesh is cached under, made
+	// from its shape, its parameters and the load settings
+	uint64_t MeshCacheKey(const char* shape, int segments, int rings, float size) const;
+	// called to upload a round mesh from the cache in place of
+	// the previous mesh of its level - returns false if the
+	// cache does not have it
+	bool LoadCachedMesh(MeshHandle previous, uint64_t cacheKey, MeshHandle& handle);
+
+	// called to find room in an arena for a mesh, growing
+	// the arena's buffers when they are full
+	void AllocateMeshRanges(GEOMETRY_ARENA& arena, GLMesh& mesh);
+
+	// called to create the VAO and buffers of an arena
+	void CreateArena(GEOMETRY_ARENA& arena, VertexFormat format);
+
+	// called to move one of an arena's buffers into a
+	// bigger one
+	void GrowArenaBuffer(
+		GEOMETRY_ARENA& arena,
+		VertexFormat format,
+		int buffer,
+		GLuint oldBytes,
+		GLuint newBytes);
+
+	// called to get the size in bytes of one vertex or index
+	static GLuint VertexSize(VertexFormat format);
+	static GLuint IndexSize(const GLMesh& mesh);
+
+	// called to group the triangles of a newly generated mesh into
+	// clusters when cluster culling is on, none of them crossing
+	// one of its draw ranges
+	void BuildMeshlets(
+		GLMesh& mesh,
+		const GLfloat* vertices,
+		GLuint* indices,
+		const GLuint* rangeStarts,
+		int rangeCount);
+
+	// called to draw a range of the triangles of a mesh
+	void DrawIndexRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount);
+	// called to draw the clusters of a range that are in view
+	void DrawClusters(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount);
+	// called to draw or collect one indexed draw
+	void SubmitIndexRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount);
+
+	// called to draw collected draws sharing the same state
+	void SubmitBatchDraws(int first, int count);
+
+	// called to upload and store a newly loaded mesh,
+	// freeing the mesh previously loaded for the same
+	// shape first
+	MeshHandle StoreMesh(
+		MeshHandle previous,
+		GLMesh& mesh,
+		const GLfloat* vertices,
+		const GLuint* indices,
+		uint64_t cacheKey = 0);
+
+	// called to give the arena space of a mesh back
+	void FreeMeshRanges(const GLMesh& mesh);
+	// called to free a loaded mesh and its arena space
+	void FreeMesh(MeshHandle handle);
+
+	// called to generate and store one detail level of a round
+	// mesh, replacing the previous mesh of that level
+	MeshHandle LoadConeLevel(MeshHandle previous, int segments);
+	MeshHandle LoadCylinderLevel(MeshHandle previous, int segments);
+	MeshHandle LoadSphereLevel(MeshHandle previous, int slices, int stacks);
+	MeshHandle LoadTaperedCylinderLevel(MeshHandle previous, int segments);
+	MeshHandle LoadTorusLevel(MeshHandle previous, float tubeRadius, int mainSegments, int tubeSegments);
+
+	// called to generate and store the patches of a round shape
+	// with tessellation on, replacing its previous patches
+	template <typename GENERATE>
+	MeshHandle LoadPatches(MeshHandle previous, ShapeGenerator::SHAPE_SIZE size, GENERATE generate);
+
+	// called to draw the ranges of a round shape's patches with the
+	// tessellation program, on the passed in surface - returns false
+	// if the shape has no patches
+	template <typename DRAW_RANGES>
+	bool DrawPatches(MeshHandle patches, int surface, float radius, DRAW_RANGES drawRanges);
+	// called to draw a range of the patches of a mesh
+	void DrawPatchRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount);
+
+	// called to keep the type and tessellation of a shape in place
+	// of its vertex data with bufferless drawing on - returns false,
+	// and forgets the shape, if it is off
+	bool LoadPrimitive(ShapeGenerator::PRIMITIVE& loaded, const ShapeGenerator::PRIMITIVE& primitive);
+
+	// called to draw the ranges of a shape's vertices with the
+	// bufferless program - returns false if the shape is stored
+	template <typename DRAW_RANGES>
+	bool DrawPrimitive(const ShapeGenerator::PRIMITIVE& primitive, DRAW_RANGES drawRanges);
+	// called to draw a range of the vertices of a shape, or collect
+	// it while batching
+	void DrawPrimitiveRange(const ShapeGenerator::PRIMITIVE& primitive, GLint firstVertex, GLsizei vertexCount);
+	// called to add a range of a shape to the records of a draw of
+	// several, after the ones before it
+	void AddPrimitiveRecord(
+		std::vector<PRIMITIVE_RECORD>& records,
+		const ShapeGenerator::PRIMITIVE& primitive,
+		GLint firstVertex,
+		GLsizei vertexCount,
+		const glm::mat4& model);
+	// called to draw every shape of the records in one draw
+	void DrawPrimitiveRecords(const std::vector<PRIMITIVE_RECORD>& records);
+
+	// called to record a range of the triangles of a mesh while
+	// capturing
+	void CaptureIndexRange(const GLMesh& mesh, GLuint firstIndex, GLuint indexCount);
+	// called to find the capture source of a mesh, reading the
+	// mesh back from its arena the first time
+	int FindCaptureSource(const GLMesh& mesh);
+	// called to retire the capture source of a freed mesh, or of
+	// every mesh for NULL
+	void RetireCaptureSources(const GLMesh* mesh);
+
+	// called to empty the scratch arena, growing its memory first
+	// if it is smaller than the passed in number of bytes
+	LinearArena& ReserveScratch(size_t bytes);
+	// called to get the scratch bytes UploadMesh() packs a mesh
+	// of the passed in size into with the current settings
+	size_t PackedBytes(GLuint vertexCount, GLuint indexCount) const;
+	// called to take room for the generated data of a shape, and
+	// its packed copy after it, from the emptied scratch arena
+	void AllocateScratchShape(ShapeGenerator::SHAPE_SIZE size, GLfloat*& vertices, GLuint*& indices);
+	// called to take room for packed data from the scratch arena,
+	// or from the passed in vector if it is full
+	void* PackingMemory(size_t bytes, std::vector<unsigned char>& overflow);
+
+	// called to free the levels of a chain from the passed in
+	// level count on, left over from a more detailed load
+	void TrimLodChain(LOD_CHAIN& chain, int levelCount);
+
+	// called to find the coarsest level of a chain within the
+	// error budget for the current object
+	int SelectLodLevel(const LOD_CHAIN& chain) const;
+
+	// called to draw a round mesh at the level chosen for the
+	// current object - drawRanges draws the ranges of a level,
+	// which together are a closed surface if bClosed is true
+	template <typename DRAW_RANGES>
+	void DrawLod(const LOD_CHAIN& chain, bool bClosed, DRAW_RANGES drawRanges);
 };
\ No newline at end of file
@@ -0,0 +1,243 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexquantizer.cpp
+// ============
+// pack interleaved float vertices into compact integer and half float
+// vertex formats, and unpack them again for measuring the error
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VertexQuantizer.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+static_assert(sizeof(VertexQuantizer::QUANTIZED_VERTEX) == 16, "quantized vertices must be 16 bytes");
+static_assert(sizeof(VertexQuantizer::COMPACT_VERTEX) == 12, "compact vertices must be 12 bytes");
+
+namespace
+{
+	/***********************************************************
+	 *  SignNotZero()
+	 *
+	 *  Get 1 for positive values and zero, -1 otherwise, so
+	 *  that the folded half of the octahedron has no seam.
+	 ***********************************************************/
+	float SignNotZero(float value)
+	{
+		return((value >= 0.0f) ? 1.0f : -1.0f);
+	}
+
+	/***********************************************************
+	 *  QuantizeOctahedral()
+	 *
+	 *  Store a normal as two integers up to maxValue.  Of the
+	 *  four integer pairs around the exact encoding, the one
+	 *  whose decoded normal is closest to the normal is used,
+	 *  which matters most for 8-bit normals.
+	 ***********************************************************/
+	template <typename T>
+	void QuantizeOctahedral(const glm::vec3& normal, int maxValue, T* encoded)
+	{
+		glm::vec2 exact = VertexQuantizer::EncodeOctahedral(normal) * (float)maxValue;
+		glm::vec3 unitNormal = glm::normalize(normal);
+
+		float bestDot = -2.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			float x = (i & 1) ? std::ceil(exact.x) : std::floor(exact.x);
+			float y = (i & 2) ? std::ceil(exact.y) : std::floor(exact.y);
+			glm::vec3 decoded = VertexQuantizer::DecodeOctahedral(glm::vec2(x, y) / (float)maxValue);
+			float dot = glm::dot(decoded, unitNormal);
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				encoded[0] = (T)x;
+				encoded[1] = (T)y;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  QuantizePosition()
+	 *
+	 *  Store a position as three 16-bit integers relative to
+	 *  the scale of the mesh.
+	 ***********************************************************/
+	void QuantizePosition(const GLfloat* position, const glm::vec3& positionScale, GLshort* quantized)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float value = glm::clamp(position[axis] / positionScale[axis], -1.0f, 1.0f);
+			quantized[axis] = (GLshort)std::lround(value * VertexQuantizer::POSITION_MAX);
+		}
+	}
+
+	/***********************************************************
+	 *  QuantizeUV()
+	 *
+	 *  Store texture coords as half floats.
+	 ***********************************************************/
+	void QuantizeUV(const GLfloat* uv, GLushort* quantized)
+	{
+		quantized[0] = glm::packHalf1x16(uv[0]);
+		quantized[1] = glm::packHalf1x16(uv[1]);
+	}
+}
+
+/***********************************************************
+ *  PositionScale()
+ *
+ *  Get the largest distance from the origin of the mesh's
+ *  positions along each axis.  An axis every position is
+ *  zero on gets a scale of one.
+ ***********************************************************/
+glm::vec3 VertexQuantizer::PositionScale(
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex)
+{
+	glm::vec3 scale(0.0f);
+	for (int v = 0; v < vertexCount; v++)
+	{
+		const GLfloat* position = vertices + ((size_t)v * floatsPerVertex);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			scale[axis] = std::max(scale[axis], std::fabs(position[axis]));
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (scale[axis] == 0.0f)
+		{
+			scale[axis] = 1.0f;
+		}
+	}
+	return(scale);
+}
+
+/***********************************************************
+ *  QuantizeVertices()
+ *
+ *  Pack vertices with 16-bit octahedral normals.
+ ***********************************************************/
+void VertexQuantizer::QuantizeVertices(
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	const glm::vec3& positionScale,
+	QUANTIZED_VERTEX* quantized)
+{
+	for (int v = 0; v < vertexCount; v++)
+	{
+		const GLfloat* vertex = vertices + ((size_t)v * floatsPerVertex);
+		QuantizePosition(vertex, positionScale, quantized[v].position);
+		quantized[v].position[3] = 0;
+		QuantizeOctahedral(glm::vec3(vertex[3], vertex[4], vertex[5]), NORMAL_MAX, quantized[v].normal);
+		QuantizeUV(vertex + 6, quantized[v].uv);
+	}
+}
+
+/***********************************************************
+ *  QuantizeVertices()
+ *
+ *  Pack vertices with 8-bit octahedral normals.
+ ***********************************************************/
+void VertexQuantizer::QuantizeVertices(
+	const GLfloat* vertices,
+	int vertexCount,
+	int floatsPerVertex,
+	const glm::vec3& positionScale,
+	COMPACT_VERTEX* compact)
+{
+	for (int v = 0; v < vertexCount; v++)
+	{
+		const GLfloat* vertex = vertices + ((size_t)v * floatsPerVertex);
+		QuantizePosition(vertex, positionScale, compact[v].position);
+		QuantizeOctahedral(glm::vec3(vertex[3], vertex[4], vertex[5]), COMPACT_NORMAL_MAX, compact[v].normal);
+		QuantizeUV(vertex + 6, compact[v].uv);
+	}
+}
+
+/***********************************************************
+ *  EncodeOctahedral()
+ *
+ *  Project a normal onto the octahedron |x|+|y|+|z| = 1,
+ *  and fold its lower half over the upper half, giving a
+ *  point in the square [-1, 1].
+ ***********************************************************/
+glm::vec2 VertexQuantizer::EncodeOctahedral(const glm::vec3& normal)
+{
+	float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (length == 0.0f)
+	{
+		return(glm::vec2(0.0f));
+	}
+
+	glm::vec2 encoded(normal.x / length, normal.y / length);
+	if (normal.z < 0.0f)
+	{
+		encoded = glm::vec2(
+			(1.0f - std::fabs(encoded.y)) * SignNotZero(encoded.x),
+			(1.0f - std::fabs(encoded.x)) * SignNotZero(encoded.y));
+	}
+	return(encoded);
+}
+
+/***********************************************************
+ *  DecodeOctahedral()
+ *
+ *  Unfold a point of the square [-1, 1] back into a unit
+ *  normal - the vertex shader does the same.
+ ***********************************************************/
+glm::vec3 VertexQuantizer::DecodeOctahedral(const glm::vec2& encoded)
+{
+	glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+	if (normal.z < 0.0f)
+	{
+		normal.x = (1.0f - std::fabs(encoded.y)) * SignNotZero(encoded.x);
+		normal.y = (1.0f - std::fabs(encoded.x)) * SignNotZero(encoded.y);
+	}
+	return(glm::normalize(normal));
+}
+
+/***********************************************************
+ *  DecodePosition()
+ *
+ *  Unpack a 16-bit position.
+ ***********************************************************/
+glm::vec3 VertexQuantizer::DecodePosition(const GLshort* position, const glm::vec3& positionScale)
+{
+	return(glm::vec3(position[0], position[1], position[2]) * positionScale / (float)POSITION_MAX);
+}
+
+/***********************************************************
+ *  DecodeNormal()
+ *
+ *  Unpack a 16-bit octahedral normal.
+ ***********************************************************/
+glm::vec3 VertexQuantizer::DecodeNormal(const GLshort* normal)
+{
+	return(DecodeOctahedral(glm::vec2(normal[0], normal[1]) / (float)NORMAL_MAX));
+}
+
+/***********************************************************
+ *  DecodeNormal()
+ *
+ *  Unpack an 8-bit octahedral normal.
+ ***********************************************************/
+glm::vec3 VertexQuantizer::DecodeNormal(const GLbyte* normal)
+{
+	return(DecodeOctahedral(glm::vec2(normal[0], normal[1]) / (float)COMPACT_NORMAL_MAX));
+}
+
+/***********************************************************
+ *  DecodeUV()
+ *
+ *  Unpack half float texture coords.
+ ***********************************************************/
+glm::vec2 VertexQuantizer::DecodeUV(const GLushort* uv)
+{
+	return(glm::vec2(glm::unpackHalf1x16(uv[0]), glm::unpackHalf1x16(uv[1])));
+}
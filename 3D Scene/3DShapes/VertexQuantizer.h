@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexquantizer.h
+// ============
+// pack interleaved float vertices into compact integer and half float
+// vertex formats, and unpack them again for measuring the error
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  VertexQuantizer
+ *
+ *  This class packs vertices made of a float position,
+ *  normal and texture coordinate into smaller formats:
+ *
+ *  - positions become 16-bit integers, relative to a scale
+ *    per axis that fits the largest coordinate of the mesh
+ *  - normals are folded onto an octahedron and stored as
+ *    two 16-bit or two 8-bit integers
+ *  - texture coordinates become half floats
+ *
+ *  The integers are read by the shader unnormalized, and
+ *  multiplied by the decode factors of the mesh, so the
+ *  result does not depend on the driver's conversion rules.
+ *  Nothing here uses OpenGL.
+ ***********************************************************/
+class VertexQuantizer
+{
+public:
+	// 16 bytes - 16-bit position, 16-bit octahedral normal,
+	// half float texture coords
+	struct QUANTIZED_VERTEX
+	{
+		GLshort position[4];	// the fourth is padding
+		GLshort normal[2];
+		GLushort uv[2];
+	};
+
+	// 12 bytes - 16-bit position, 8-bit octahedral normal,
+	// half float texture coords
+	struct COMPACT_VERTEX
+	{
+		GLshort position[3];
+		GLbyte normal[2];
+		GLushort uv[2];
+	};
+
+	// the largest stored values of the integer fields
+	static const int POSITION_MAX = 32767;
+	static const int NORMAL_MAX = 32767;
+	static const int COMPACT_NORMAL_MAX = 127;
+
+	// the scale per axis that fits every position of a mesh - the
+	// position is the first three floats of each vertex
+	static glm::vec3 PositionScale(
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex);
+
+	// pack the vertices - the normal follows the position and the
+	// texture coords follow the normal
+	static void QuantizeVertices(
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		const glm::vec3& positionScale,
+		QUANTIZED_VERTEX* quantized);
+	static void QuantizeVertices(
+		const GLfloat* vertices,
+		int vertexCount,
+		int floatsPerVertex,
+		const glm::vec3& positionScale,
+		COMPACT_VERTEX* compact);
+
+	// octahedral normal encoding, with both values in [-1, 1] -
+	// the stored integers are the closest that decode best
+	static glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+	static glm::vec3 DecodeOctahedral(const glm::vec2& encoded);
+
+	// unpack a vertex again, the way the vertex shader does
+	static glm::vec3 DecodePosition(const GLshort* position, const glm::vec3& positionScale);
+	static glm::vec3 DecodeNormal(const GLshort* normal);
+	static glm::vec3 DecodeNormal(const GLbyte* normal);
+	static glm::vec2 DecodeUV(const GLushort* uv);
+};
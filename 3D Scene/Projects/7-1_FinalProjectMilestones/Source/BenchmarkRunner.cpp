@@ -0,0 +1,2932 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkrunner.cpp
+// ============
+// measure the performance of the rendering subsystems on the shipped assets
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BenchmarkRunner.h"
+#include "MipGenerator.h"
+#include "JpegDecoder.h"
+#include "YCbCrConverter.h"
+#include "VirtualTextureSystem.h"
+#include "SceneManager.h"
+#include "ShapeMeshes.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "NormalGenerator.h"
+#include "VertexQuantizer.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+
+#include <glm/gtx/transform.hpp>
+
+// declaration of global variables
+namespace
+{
+#if defined(BENCHMARK_COUNT_ALLOCATIONS)
+	// the heap allocations made by the whole program so far,
+	// counted by the operator new below
+	std::atomic<long long> g_HeapAllocations(0);
+	const bool g_bCountingAllocations = true;
+#else
+	const bool g_bCountingAllocations = false;
+#endif
+
+	// the heap allocations counted so far - always none when the
+	// program keeps the library's operator new
+	long long HeapAllocations()
+	{
+#if defined(BENCHMARK_COUNT_ALLOCATIONS)
+		return(g_HeapAllocations.load(std::memory_order_relaxed));
+#else
+		return(0);
+#endif
+	}
+}
+
+#if defined(BENCHMARK_COUNT_ALLOCATIONS)
+// a build with BENCHMARK_COUNT_ALLOCATIONS defined replaces the
+// program's operator new to count its calls, for the mesh generation
+// benchmark to prove its loads allocate nothing.  Every allocation
+// of the program then pays for an atomic add, so normal builds leave
+// it out.  Nothrow new falls back on these, sized and unsized delete
+// free the same way, and over-aligned allocations keep the library's
+// own pair and are not counted.
+void* operator new(size_t bytes)
+{
+	g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	void* memory = std::malloc((bytes > 0) ? bytes : 1);
+	if (memory == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return(memory);
+}
+
+void* operator new[](size_t bytes)
+{
+	return(operator new(bytes));
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+#endif
+
+namespace
+{
+	// every timing is the best of this many runs
+	const int BENCHMARK_RUNS = 5;
+
+	// milliseconds elapsed since the given time
+	double ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+	{
+		return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	// millions of pixels processed per second
+	double MegapixelsPerSecond(double pixels, double milliseconds)
+	{
+		return((milliseconds > 0.0) ? (pixels / (milliseconds * 1000.0)) : 0.0);
+	}
+
+	// the shapes drawn by the mesh benchmarks - the half torus
+	// draws the torus mesh, so it comes last
+	const char* g_MeshShapeNames[] = { "box", "cone", "cylinder", "plane", "prism", "pyramid3",
+		"pyramid4", "sphere", "tapered", "torus", "half torus" };
+	const int MESH_SHAPE_COUNT = (int)(sizeof(g_MeshShapeNames) / sizeof(g_MeshShapeNames[0]));
+
+	// load a shape of the mesh benchmarks
+	void LoadMeshShape(ShapeMeshes& meshes, int shape)
+	{
+		switch (shape)
+		{
+		case 0: meshes.LoadBoxMesh(); break;
+		case 1: meshes.LoadConeMesh(); break;
+		case 2: meshes.LoadCylinderMesh(); break;
+		case 3: meshes.LoadPlaneMesh(); break;
+		case 4: meshes.LoadPrismMesh(); break;
+		case 5: meshes.LoadPyramid3Mesh(); break;
+		case 6: meshes.LoadPyramid4Mesh(); break;
+		case 7: meshes.LoadSphereMesh(); break;
+		case 8: meshes.LoadTaperedCylinderMesh(); break;
+		default: meshes.LoadTorusMesh(.1); break;
+		}
+	}
+
+	// draw a shape of the mesh benchmarks
+	void DrawMeshShape(ShapeMeshes& meshes, int shape)
+	{
+		switch (shape)
+		{
+		case 0: meshes.DrawBoxMesh(); break;
+		case 1: meshes.DrawConeMesh(); break;
+		case 2: meshes.DrawCylinderMesh(); break;
+		case 3: meshes.DrawPlaneMesh(); break;
+		case 4: meshes.DrawPrismMesh(); break;
+		case 5: meshes.DrawPyramid3Mesh(); break;
+		case 6: meshes.DrawPyramid4Mesh(); break;
+		case 7: meshes.DrawSphereMesh(); break;
+		case 8: meshes.DrawTaperedCylinderMesh(); break;
+		case 9: meshes.DrawTorusMesh(); break;
+		default: meshes.DrawHalfTorusMesh(); break;
+		}
+	}
+
+	// generate the vertices and indices of a shape of the mesh
+	// benchmarks the way ShapeMeshes loads it
+	void GenerateMeshShape(int shape, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+	{
+		ShapeGenerator::SHAPE_SIZE size;
+		switch (shape)
+		{
+		case 0: size = ShapeGenerator::BoxSize(); break;
+		case 1: size = ShapeGenerator::ConeSize(ShapeGenerator::DEFAULT_ROUND_SEGMENTS); break;
+		case 2: size = ShapeGenerator::CylinderSize(ShapeGenerator::DEFAULT_ROUND_SEGMENTS); break;
+		case 3: size = ShapeGenerator::PlaneSize(); break;
+		case 4: size = ShapeGenerator::PrismSize(); break;
+		case 5: size = ShapeGenerator::Pyramid3Size(); break;
+		case 6: size = ShapeGenerator::Pyramid4Size(); break;
+		case 7: size = ShapeGenerator::SphereSize(ShapeGenerator::DEFAULT_SPHERE_SLICES, ShapeGenerator::DEFAULT_SPHERE_STACKS); break;
+		case 8: size = ShapeGenerator::TaperedCylinderSize(ShapeGenerator::DEFAULT_ROUND_SEGMENTS); break;
+		default: size = ShapeGenerator::TorusSize(ShapeGenerator::DEFAULT_TORUS_MAIN_SEGMENTS, ShapeGenerator::DEFAULT_TORUS_TUBE_SEGMENTS); break;
+		}
+		vertices.assign(size.vertexCount * ShapeGenerator::FLOATS_PER_VERTEX, 0.0f);
+		indices.assign(size.indexCount, 0);
+
+		switch (shape)
+		{
+		case 0: ShapeGenerator::GenerateBox(vertices.data(), indices.data()); break;
+		case 1: ShapeGenerator::GenerateCone(ShapeGenerator::DEFAULT_ROUND_SEGMENTS, vertices.data(), indices.data()); break;
+		case 2: ShapeGenerator::GenerateCylinder(ShapeGenerator::DEFAULT_ROUND_SEGMENTS, vertices.data(), indices.data()); break;
+		case 3: ShapeGenerator::GeneratePlane(vertices.data(), indices.data()); break;
+		case 4: ShapeGenerator::GeneratePrism(vertices.data(), indices.data()); break;
+		case 5: ShapeGenerator::GeneratePyramid3(vertices.data(), indices.data()); break;
+		case 6: ShapeGenerator::GeneratePyramid4(vertices.data(), indices.data()); break;
+		case 7: ShapeGenerator::GenerateSphere(ShapeGenerator::DEFAULT_SPHERE_SLICES, ShapeGenerator::DEFAULT_SPHERE_STACKS, vertices.data(), indices.data()); break;
+		case 8: ShapeGenerator::GenerateTaperedCylinder(ShapeGenerator::DEFAULT_ROUND_SEGMENTS, ShapeGenerator::DEFAULT_TAPERED_TOP_RADIUS, vertices.data(), indices.data()); break;
+		default: ShapeGenerator::GenerateTorus(ShapeGenerator::DEFAULT_TORUS_MAIN_SEGMENTS, ShapeGenerator::DEFAULT_TORUS_TUBE_SEGMENTS, .1f, vertices.data(), indices.data()); break;
+		}
+
+		// the box's side fans repeat its faces for the side draws
+		if (shape == 0)
+		{
+			indices.resize(ShapeGenerator::BOX_INDEX_COUNT);
+		}
+	}
+
+	// the type and tessellation of a shape of the mesh benchmarks
+	// as it is loaded, for drawing it with no vertex data - the
+	// prism and pyramids have none
+	ShapeGenerator::PRIMITIVE MeshShapePrimitive(int shape)
+	{
+		switch (shape)
+		{
+		case 0: return(ShapeGenerator::BoxPrimitive());
+		case 1: return(ShapeGenerator::ConePrimitive(ShapeGenerator::DEFAULT_ROUND_SEGMENTS));
+		case 2: return(ShapeGenerator::CylinderPrimitive(ShapeGenerator::DEFAULT_ROUND_SEGMENTS, 1.0f));
+		case 3: return(ShapeGenerator::PlanePrimitive());
+		case 7: return(ShapeGenerator::SpherePrimitive(ShapeGenerator::DEFAULT_SPHERE_SLICES, ShapeGenerator::DEFAULT_SPHERE_STACKS));
+		case 8: return(ShapeGenerator::CylinderPrimitive(ShapeGenerator::DEFAULT_ROUND_SEGMENTS, ShapeGenerator::DEFAULT_TAPERED_TOP_RADIUS));
+		case 9: return(ShapeGenerator::TorusPrimitive(ShapeGenerator::DEFAULT_TORUS_MAIN_SEGMENTS, ShapeGenerator::DEFAULT_TORUS_TUBE_SEGMENTS, .1f));
+		}
+		ShapeGenerator::PRIMITIVE none = { ShapeGenerator::noPrimitive, 0, 0, 0.0f };
+		return(none);
+	}
+
+	// the dense round shapes of the meshlet benchmark, tessellated
+	// finely enough for culling parts of them to pay off
+	const char* g_DenseShapeNames[] = { "sphere", "cylinder", "torus" };
+	const int DENSE_SHAPE_COUNT = (int)(sizeof(g_DenseShapeNames) / sizeof(g_DenseShapeNames[0]));
+	const int DENSE_SPHERE_SLICES = 64;
+	const int DENSE_SPHERE_STACKS = 32;
+	const int DENSE_ROUND_SEGMENTS = 128;
+	const int DENSE_TORUS_MAIN_SEGMENTS = 96;
+	const int DENSE_TORUS_TUBE_SEGMENTS = 32;
+	const float DENSE_TORUS_THICKNESS = 0.25f;
+
+	// load a shape of the meshlet benchmark
+	void LoadDenseShape(ShapeMeshes& meshes, int shape)
+	{
+		switch (shape)
+		{
+		case 0: meshes.LoadSphereMesh(DENSE_SPHERE_SLICES, DENSE_SPHERE_STACKS); break;
+		case 1: meshes.LoadCylinderMesh(DENSE_ROUND_SEGMENTS); break;
+		default: meshes.LoadTorusMesh(DENSE_TORUS_THICKNESS, DENSE_TORUS_MAIN_SEGMENTS, DENSE_TORUS_TUBE_SEGMENTS); break;
+		}
+	}
+
+	// draw a shape of the meshlet benchmark
+	void DrawDenseShape(ShapeMeshes& meshes, int shape)
+	{
+		switch (shape)
+		{
+		case 0: meshes.DrawSphereMesh(); break;
+		case 1: meshes.DrawCylinderMesh(); break;
+		default: meshes.DrawTorusMesh(); break;
+		}
+	}
+
+	// generate the vertices and indices of a shape of the meshlet
+	// benchmark
+	void GenerateDenseShape(int shape, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+	{
+		ShapeGenerator::SHAPE_SIZE size;
+		switch (shape)
+		{
+		case 0: size = ShapeGenerator::SphereSize(DENSE_SPHERE_SLICES, DENSE_SPHERE_STACKS); break;
+		case 1: size = ShapeGenerator::CylinderSize(DENSE_ROUND_SEGMENTS); break;
+		default: size = ShapeGenerator::TorusSize(DENSE_TORUS_MAIN_SEGMENTS, DENSE_TORUS_TUBE_SEGMENTS); break;
+		}
+		vertices.assign(size.vertexCount * ShapeGenerator::FLOATS_PER_VERTEX, 0.0f);
+		indices.assign(size.indexCount, 0);
+
+		switch (shape)
+		{
+		case 0: ShapeGenerator::GenerateSphere(DENSE_SPHERE_SLICES, DENSE_SPHERE_STACKS, vertices.data(), indices.data()); break;
+		case 1: ShapeGenerator::GenerateCylinder(DENSE_ROUND_SEGMENTS, vertices.data(), indices.data()); break;
+		default: ShapeGenerator::GenerateTorus(DENSE_TORUS_MAIN_SEGMENTS, DENSE_TORUS_TUBE_SEGMENTS, DENSE_TORUS_THICKNESS, vertices.data(), indices.data()); break;
+		}
+	}
+
+	// the largest error of packing the vertices of a shape, with
+	// the normal error in degrees
+	struct PACKING_ERROR
+	{
+		float position;
+		float normal;
+		float uv;
+	};
+
+	void AddPackingError(const GLfloat* vertex, const glm::vec3& position, const glm::vec3& normal,
+		const glm::vec2& uv, PACKING_ERROR& error)
+	{
+		glm::vec3 exactNormal = glm::normalize(glm::vec3(vertex[3], vertex[4], vertex[5]));
+		float cosine = glm::clamp(glm::dot(normal, exactNormal), -1.0f, 1.0f);
+		error.position = std::max(error.position, glm::length(position - glm::vec3(vertex[0], vertex[1], vertex[2])));
+		error.normal = std::max(error.normal, glm::degrees(std::acos(cosine)));
+		error.uv = std::max(error.uv, glm::length(uv - glm::vec2(vertex[6], vertex[7])));
+	}
+
+	// the shapes of g_MeshShapeNames, and the tessellations of
+	// the round ones, the mesh generation benchmark makes
+	struct GENERATED_SHAPE
+	{
+		int shape;
+		int segments;
+	};
+	const GENERATED_SHAPE g_GeneratedShapes[] = {
+		{ 0, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 },
+		{ 1, 8 }, { 1, 32 }, { 1, 128 },
+		{ 2, 8 }, { 2, 32 }, { 2, 128 },
+		{ 7, 8 }, { 7, 32 }, { 7, 128 },
+		{ 8, 8 }, { 8, 32 }, { 8, 128 },
+		{ 9, 8 }, { 9, 32 }, { 9, 128 } };
+	const int GENERATED_SHAPE_COUNT = (int)(sizeof(g_GeneratedShapes) / sizeof(g_GeneratedShapes[0]));
+
+	// the size of a shape of the mesh generation benchmark - the
+	// sphere has half as many stacks as slices, and the torus
+	// half as many tube segments as main segments
+	ShapeGenerator::SHAPE_SIZE GeneratedShapeSize(const GENERATED_SHAPE& generated)
+	{
+		switch (generated.shape)
+		{
+		case 0: return(ShapeGenerator::BoxSize());
+		case 1: return(ShapeGenerator::ConeSize(generated.segments));
+		case 2: return(ShapeGenerator::CylinderSize(generated.segments));
+		case 3: return(ShapeGenerator::PlaneSize());
+		case 4: return(ShapeGenerator::PrismSize());
+		case 5: return(ShapeGenerator::Pyramid3Size());
+		case 6: return(ShapeGenerator::Pyramid4Size());
+		case 7: return(ShapeGenerator::SphereSize(generated.segments, generated.segments / 2));
+		case 8: return(ShapeGenerator::TaperedCylinderSize(generated.segments));
+		default: return(ShapeGenerator::TorusSize(generated.segments, generated.segments / 2));
+		}
+	}
+
+	// generate a shape of the mesh generation benchmark into the
+	// passed in arrays, sized by GeneratedShapeSize()
+	void GenerateShape(const GENERATED_SHAPE& generated, GLfloat* vertices, GLuint* indices)
+	{
+		switch (generated.shape)
+		{
+		case 0: ShapeGenerator::GenerateBox(vertices, indices); break;
+		case 1: ShapeGenerator::GenerateCone(generated.segments, vertices, indices); break;
+		case 2: ShapeGenerator::GenerateCylinder(generated.segments, vertices, indices); break;
+		case 3: ShapeGenerator::GeneratePlane(vertices, indices); break;
+		case 4: ShapeGenerator::GeneratePrism(vertices, indices); break;
+		case 5: ShapeGenerator::GeneratePyramid3(vertices, indices); break;
+		case 6: ShapeGenerator::GeneratePyramid4(vertices, indices); break;
+		case 7: ShapeGenerator::GenerateSphere(generated.segments, generated.segments / 2, vertices, indices); break;
+		case 8: ShapeGenerator::GenerateTaperedCylinder(generated.segments, ShapeGenerator::DEFAULT_TAPERED_TOP_RADIUS, vertices, indices); break;
+		default: ShapeGenerator::GenerateTorus(generated.segments, generated.segments / 2, 0.1f, vertices, indices); break;
+		}
+	}
+
+	// count the vertex shader runs of one draw of a shape of the
+	// mesh benchmarks with a pipeline statistics query
+	GLuint CountVertexShaderRuns(ShapeMeshes& meshes, int shape, GLuint query)
+	{
+		GLuint invocations = 0;
+		glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB, query);
+		DrawMeshShape(meshes, shape);
+		glEndQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB);
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &invocations);
+		return(invocations);
+	}
+}
+
+/***********************************************************
+ *  BenchmarkRunner()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BenchmarkRunner::BenchmarkRunner(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+
+	m_textureFiles.push_back("../../Utilities/textures/Ancient Flooring.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/backdrop.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/book.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/CanSide.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/CanTop.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/keyboard.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/Light.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/paperpages.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/stainless.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/stainless_end.jpg");
+	m_textureFiles.push_back("../../Utilities/textures/Wood_Floor.jpg");
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  Run the benchmark with the passed in name.  Returns false
+ *  if there is no such benchmark or it could not run.
+ ***********************************************************/
+bool BenchmarkRunner::Run(const std::string& name)
+{
+	bool bAll = (name.compare("all") == 0);
+	bool bFound = false;
+	bool bSuccess = true;
+
+	if ((bAll == true) || (name.compare("mips") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMipBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("jpeg") == 0))
+	{
+		bFound = true;
+		bSuccess = RunJpegBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("jpegscale") == 0))
+	{
+		bFound = true;
+		bSuccess = RunJpegScaleBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("ycbcr") == 0))
+	{
+		bFound = true;
+		bSuccess = RunYCbCrBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("procedural") == 0))
+	{
+		bFound = true;
+		bSuccess = RunProceduralBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("virtualtexture") == 0))
+	{
+		bFound = true;
+		bSuccess = RunVirtualTextureBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("meshes") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMeshBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("meshopt") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMeshOptimizerBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("vertexformat") == 0))
+	{
+		bFound = true;
+		bSuccess = RunVertexFormatBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("arena") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMeshArenaBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("lod") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMeshLodBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("meshlets") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMeshletBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("meshcache") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMeshCacheBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("normals") == 0))
+	{
+		bFound = true;
+		bSuccess = RunNormalBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("tessellation") == 0))
+	{
+		bFound = true;
+		bSuccess = RunTessellationBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("bufferless") == 0))
+	{
+		bFound = true;
+		bSuccess = RunBufferlessBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("merge") == 0))
+	{
+		bFound = true;
+		bSuccess = RunStaticMergeBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("meshgen") == 0))
+	{
+		bFound = true;
+		bSuccess = RunMeshGenerationBenchmark() && bSuccess;
+	}
+
+	if ((bAll == true) || (name.compare("depthprepass") == 0))
+	{
+		bFound = true;
+		bSuccess = RunDepthPrePassBenchmark() && bSuccess;
+	}
+
+	if (bFound == false)
+	{
+		std::cout << "Unknown benchmark:" << name << ", available: all, mips, jpeg, jpegscale, ycbcr, procedural, virtualtexture, meshes, meshopt, vertexformat, arena, lod, meshlets, meshcache, normals, tessellation, bufferless, merge, meshgen, depthprepass" << std::endl;
+		return(false);
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  RunMipBenchmark()
+ *
+ *  Time building the full mip chain of every shipped texture
+ *  with glGenerateMipmap and with each CPU filter, single
+ *  and multithreaded, reported in source megapixels per
+ *  second.  The CPU box filter is also compared against the
+ *  driver's first mip level.
+ ***********************************************************/
+bool BenchmarkRunner::RunMipBenchmark()
+{
+	struct FILTER_SETUP
+	{
+		const char* name;
+		MipGenerator::MIP_FILTER filter;
+		bool bGammaCorrect;
+	};
+	const FILTER_SETUP setups[] = {
+		{ "box", MipGenerator::MIP_FILTER_BOX, false },
+		{ "box/gamma", MipGenerator::MIP_FILTER_BOX, true },
+		{ "kaiser", MipGenerator::MIP_FILTER_KAISER, false },
+		{ "kaiser/gamma", MipGenerator::MIP_FILTER_KAISER, true } };
+	const int setupCount = sizeof(setups) / sizeof(setups[0]);
+
+	MipGenerator defaultGenerator;
+	int threadCount = defaultGenerator.GetThreadCount();
+
+	std::cout << std::endl << "Mip generation benchmark - " << MipGenerator::GetInstructionSet()
+		<< " kernels, " << threadCount << " threads, MPix/s of source pixels" << std::endl;
+	std::cout << std::left << std::setw(22) << "texture" << std::right << std::setw(11) << "size" << std::setw(9) << "driver";
+	for (int s = 0; s < setupCount; s++)
+	{
+		std::cout << std::setw(14) << setups[s].name << std::setw(5) << "MT";
+	}
+	std::cout << std::setw(14) << "box vs drv" << std::endl;
+
+	std::vector<unsigned char*> images;
+	std::vector<MipGenerator::MIP_IMAGE> batch;
+	double totalPixels = 0.0;
+
+	stbi_set_flip_vertically_on_load(true);
+	for (int i = 0; i < (int)m_textureFiles.size(); i++)
+	{
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		unsigned char* image = stbi_load(m_textureFiles[i].c_str(), &width, &height, &colorChannels, 0);
+		if (image == NULL)
+		{
+			std::cout << "Could not load image:" << m_textureFiles[i] << std::endl;
+			continue;
+		}
+		images.push_back(image);
+		double pixels = (double)width * height;
+		totalPixels += pixels;
+
+		MipGenerator::MIP_IMAGE mipImage;
+		mipImage.pixels = image;
+		mipImage.width = width;
+		mipImage.height = height;
+		mipImage.colorChannels = colorChannels;
+		batch.push_back(mipImage);
+
+		// driver path - the upload itself is not timed
+		GLenum format = (colorChannels == 4) ? GL_RGBA : GL_RGB;
+		GLuint textureID = 0;
+		glGenTextures(1, &textureID);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		double driverTime = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, (colorChannels == 4) ? GL_RGBA8 : GL_RGB8, width, height, 0, format, GL_UNSIGNED_BYTE, image);
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glFinish();
+			driverTime = std::min(driverTime, ElapsedMilliseconds(start));
+		}
+
+		std::string name = m_textureFiles[i].substr(m_textureFiles[i].find_last_of('/') + 1);
+		std::cout << std::left << std::setw(22) << name << std::right
+			<< std::setw(11) << (std::to_string(width) + "x" + std::to_string(height))
+			<< std::setw(9) << std::fixed << std::setprecision(1) << MegapixelsPerSecond(pixels, driverTime);
+
+		for (int s = 0; s < setupCount; s++)
+		{
+			MipGenerator singleThreaded(setups[s].filter, setups[s].bGammaCorrect, 1);
+			MipGenerator multiThreaded(setups[s].filter, setups[s].bGammaCorrect, threadCount);
+			double singleTime = 1.0e30;
+			double multiTime = 1.0e30;
+			for (int run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				singleThreaded.GenerateMipChain(mipImage);
+				singleTime = std::min(singleTime, ElapsedMilliseconds(start));
+
+				start = std::chrono::steady_clock::now();
+				multiThreaded.GenerateMipChain(mipImage);
+				multiTime = std::min(multiTime, ElapsedMilliseconds(start));
+			}
+			std::cout << std::setw(14) << MegapixelsPerSecond(pixels, singleTime)
+				<< std::setw(5) << std::setprecision(0) << MegapixelsPerSecond(pixels, multiTime) << std::setprecision(1);
+		}
+
+		// largest channel difference of the first mip level
+		MipGenerator boxGenerator(MipGenerator::MIP_FILTER_BOX, false);
+		boxGenerator.GenerateMipChain(mipImage);
+		int maxDifference = 0;
+		if (mipImage.levels.size() > 1)
+		{
+			const MipGenerator::MIP_LEVEL& level = mipImage.levels[1];
+			std::vector<unsigned char> driverLevel(level.pixels.size());
+			glGetTexImage(GL_TEXTURE_2D, 1, format, GL_UNSIGNED_BYTE, driverLevel.data());
+			for (size_t p = 0; p < driverLevel.size(); p++)
+			{
+				maxDifference = std::max(maxDifference, std::abs((int)driverLevel[p] - (int)level.pixels[p]));
+			}
+		}
+		std::cout << std::setw(14) << maxDifference << std::endl;
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glDeleteTextures(1, &textureID);
+	}
+
+	// whole set of textures with one image per thread
+	MipGenerator batchGenerator(MipGenerator::MIP_FILTER_KAISER, true, threadCount);
+	double batchTime = 1.0e30;
+	for (int run = 0; run < BENCHMARK_RUNS; run++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		batchGenerator.GenerateMipChains(batch);
+		batchTime = std::min(batchTime, ElapsedMilliseconds(start));
+	}
+	std::cout << "kaiser/gamma over all " << batch.size() << " textures, one image per thread: "
+		<< std::setprecision(1) << MegapixelsPerSecond(totalPixels, batchTime) << " MPix/s ("
+		<< batchTime << " ms)" << std::endl;
+
+	for (int i = 0; i < (int)images.size(); i++)
+	{
+		stbi_image_free(images[i]);
+	}
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(images.size() > 0);
+}
+
+/***********************************************************
+ *  RunJpegBenchmark()
+ *
+ *  Time decoding every shipped texture from memory with
+ *  stb_image and with the SIMD JPEG decoder, single and
+ *  multithreaded, reported in megapixels per second.  Each
+ *  decoded image is compared with stb_image's byte by byte.
+ *  Files the decoder refuses, like progressive JPEGs, are
+ *  reported as left to stb_image.
+ ***********************************************************/
+bool BenchmarkRunner::RunJpegBenchmark()
+{
+	JpegDecoder multiThreaded(true);
+	JpegDecoder singleThreaded(true, 1);
+
+	std::cout << std::endl << "JPEG decoding benchmark - " << JpegDecoder::GetInstructionSet()
+		<< " kernels, " << multiThreaded.GetThreadCount() << " threads, MPix/s" << std::endl;
+	std::cout << std::left << std::setw(22) << "texture" << std::right << std::setw(11) << "size"
+		<< std::setw(9) << "stb" << std::setw(9) << "simd" << std::setw(9) << "MT"
+		<< std::setw(9) << "speedup" << std::setw(14) << "vs stb" << std::endl;
+
+	stbi_set_flip_vertically_on_load(true);
+	double stbTotal = 0.0;
+	double simdTotal = 0.0;
+	bool bAllExact = true;
+	int decodedCount = 0;
+	for (int i = 0; i < (int)m_textureFiles.size(); i++)
+	{
+		// decode from memory so the file system is not timed
+		std::ifstream file(m_textureFiles[i].c_str(), std::ios::binary);
+		std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (data.size() == 0)
+		{
+			std::cout << "Could not load image:" << m_textureFiles[i] << std::endl;
+			continue;
+		}
+
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		double stbTime = 1.0e30;
+		unsigned char* reference = NULL;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			if (reference != NULL)
+			{
+				stbi_image_free(reference);
+			}
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			reference = stbi_load_from_memory(data.data(), (int)data.size(), &width, &height, &colorChannels, 0);
+			stbTime = std::min(stbTime, ElapsedMilliseconds(start));
+		}
+		if (reference == NULL)
+		{
+			std::cout << "Could not load image:" << m_textureFiles[i] << std::endl;
+			continue;
+		}
+
+		double pixels = (double)width * height;
+		std::string name = m_textureFiles[i].substr(m_textureFiles[i].find_last_of('/') + 1);
+		std::cout << std::left << std::setw(22) << name << std::right
+			<< std::setw(11) << (std::to_string(width) + "x" + std::to_string(height))
+			<< std::setw(9) << std::fixed << std::setprecision(1) << MegapixelsPerSecond(pixels, stbTime);
+
+		JpegDecoder::JPEG_IMAGE image;
+		if (singleThreaded.DecodeMemory(data.data(), data.size(), image) == false)
+		{
+			std::cout << std::setw(41) << "left to stb_image" << std::endl;
+			stbi_image_free(reference);
+			continue;
+		}
+
+		double singleTime = 1.0e30;
+		double multiTime = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			singleThreaded.DecodeMemory(data.data(), data.size(), image);
+			singleTime = std::min(singleTime, ElapsedMilliseconds(start));
+
+			start = std::chrono::steady_clock::now();
+			multiThreaded.DecodeMemory(data.data(), data.size(), image);
+			multiTime = std::min(multiTime, ElapsedMilliseconds(start));
+		}
+
+		// largest channel difference from stb_image
+		int maxDifference = 0;
+		if ((image.width != width) || (image.height != height) || (image.colorChannels != colorChannels))
+		{
+			maxDifference = 255;
+		}
+		else
+		{
+			for (size_t p = 0; p < image.pixels.size(); p++)
+			{
+				maxDifference = std::max(maxDifference, std::abs((int)image.pixels[p] - (int)reference[p]));
+			}
+		}
+		bAllExact = bAllExact && (maxDifference == 0);
+		stbTotal += stbTime;
+		simdTotal += std::min(singleTime, multiTime);
+		decodedCount++;
+
+		std::cout << std::setw(9) << MegapixelsPerSecond(pixels, singleTime)
+			<< std::setw(9) << MegapixelsPerSecond(pixels, multiTime)
+			<< std::setw(8) << std::setprecision(2) << (stbTime / std::min(singleTime, multiTime)) << "x"
+			<< std::setw(14) << ((maxDifference == 0) ? std::string("exact") : ("max diff " + std::to_string(maxDifference)))
+			<< std::setprecision(1) << std::endl;
+		stbi_image_free(reference);
+	}
+
+	std::cout << decodedCount << " baseline files: stb_image " << stbTotal << " ms, SIMD decoder " << simdTotal
+		<< " ms, " << (bAllExact ? "bit exact" : "NOT bit exact") << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(decodedCount > 0);
+}
+
+/***********************************************************
+ *  RunJpegScaleBenchmark()
+ *
+ *  Time loading every baseline JPEG texture the way the
+ *  background loader does - decoding and building the mip
+ *  chain - at its full size and decoded at 1/2, 1/4 and 1/8
+ *  of it.  The memory held by each mip chain is reported
+ *  with the time.
+ ***********************************************************/
+bool BenchmarkRunner::RunJpegScaleBenchmark()
+{
+	JpegDecoder decoder(true);
+	MipGenerator mipGenerator(MipGenerator::MIP_FILTER_KAISER, true);
+
+	std::cout << std::endl << "JPEG reduced size decoding benchmark - decode and mip chain, ms and KB" << std::endl;
+	std::cout << std::left << std::setw(22) << "texture" << std::right << std::setw(11) << "size";
+	for (int shift = 0; shift <= 3; shift++)
+	{
+		std::cout << std::setw(9) << ("1/" + std::to_string(1 << shift)) << std::setw(8) << "KB";
+	}
+	std::cout << std::endl;
+
+	double totals[4] = { 0.0, 0.0, 0.0, 0.0 };
+	size_t totalBytes[4] = { 0, 0, 0, 0 };
+	int decodedCount = 0;
+	for (int i = 0; i < (int)m_textureFiles.size(); i++)
+	{
+		std::ifstream file(m_textureFiles[i].c_str(), std::ios::binary);
+		std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		JpegDecoder::JPEG_IMAGE image;
+		if ((data.size() == 0) || (decoder.DecodeMemory(data.data(), data.size(), image) == false))
+		{
+			continue;
+		}
+		int fullSize = std::max(image.width, image.height);
+
+		std::string name = m_textureFiles[i].substr(m_textureFiles[i].find_last_of('/') + 1);
+		std::cout << std::left << std::setw(22) << name << std::right
+			<< std::setw(11) << (std::to_string(image.width) + "x" + std::to_string(image.height))
+			<< std::fixed << std::setprecision(1);
+		for (int shift = 0; shift <= 3; shift++)
+		{
+			// the size limit that selects this reduction
+			int maxSize = (shift == 0) ? 0 : ((fullSize + (1 << shift) - 1) >> shift);
+			double bestTime = 1.0e30;
+			size_t bytes = 0;
+			for (int run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				decoder.DecodeMemory(data.data(), data.size(), image, maxSize);
+				MipGenerator::MIP_IMAGE mipImage;
+				mipImage.pixels = image.pixels.data();
+				mipImage.width = image.width;
+				mipImage.height = image.height;
+				mipImage.colorChannels = image.colorChannels;
+				mipGenerator.GenerateMipChain(mipImage);
+				bestTime = std::min(bestTime, ElapsedMilliseconds(start));
+
+				bytes = 0;
+				for (int level = 0; level < (int)mipImage.levels.size(); level++)
+				{
+					bytes += mipImage.levels[level].pixels.size();
+				}
+			}
+			totals[shift] += bestTime;
+			totalBytes[shift] += bytes;
+			std::cout << std::setw(9) << bestTime << std::setw(8) << (bytes / 1024);
+		}
+		std::cout << std::endl;
+		decodedCount++;
+	}
+
+	std::cout << decodedCount << " baseline files:";
+	for (int shift = 0; shift <= 3; shift++)
+	{
+		std::cout << " 1/" << (1 << shift) << " " << totals[shift] << " ms " << (totalBytes[shift] / 1024) << " KB"
+			<< ((shift < 3) ? "," : "");
+	}
+	std::cout << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(decodedCount > 0);
+}
+
+/***********************************************************
+ *  RunYCbCrBenchmark()
+ *
+ *  Time getting every baseline JPEG texture into an OpenGL
+ *  texture, once decoded to RGB on the CPU and uploaded, and
+ *  once decoded to its color planes that are uploaded and
+ *  converted on the GPU.  Both include waiting for the GPU.
+ *  The upload sizes are reported, and the converted texels
+ *  are read back and compared with the CPU decode.
+ ***********************************************************/
+bool BenchmarkRunner::RunYCbCrBenchmark()
+{
+	YCbCrConverter converter;
+	if (converter.Initialize("../../Utilities/shaders/ycbcrVertexShader.glsl",
+		"../../Utilities/shaders/ycbcrFragmentShader.glsl") == false)
+	{
+		return(false);
+	}
+	JpegDecoder decoder(true);
+
+	std::cout << std::endl << "JPEG color conversion benchmark - decode and upload, ms" << std::endl;
+	std::cout << std::left << std::setw(22) << "texture" << std::right << std::setw(11) << "size"
+		<< std::setw(9) << "CPU" << std::setw(9) << "GPU" << std::setw(9) << "speedup"
+		<< std::setw(11) << "RGB KB" << std::setw(11) << "planes KB" << std::setw(14) << "vs CPU" << std::endl;
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+	double cpuTotal = 0.0;
+	double gpuTotal = 0.0;
+	size_t rgbBytesTotal = 0;
+	size_t planeBytesTotal = 0;
+	bool bAllExact = true;
+	int convertedCount = 0;
+	for (int i = 0; i < (int)m_textureFiles.size(); i++)
+	{
+		std::ifstream file(m_textureFiles[i].c_str(), std::ios::binary);
+		std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		JpegDecoder::JPEG_IMAGE image;
+		JpegDecoder::JPEG_PLANES planes;
+		if ((data.size() == 0) ||
+			(decoder.DecodeMemory(data.data(), data.size(), image) == false) ||
+			(decoder.DecodePlanesMemory(data.data(), data.size(), planes) == false))
+		{
+			continue;
+		}
+		GLenum format = (image.colorChannels == 1) ? GL_RED : GL_RGB;
+
+		double cpuTime = 1.0e30;
+		double gpuTime = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			decoder.DecodeMemory(data.data(), data.size(), image);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glFinish();
+			cpuTime = std::min(cpuTime, ElapsedMilliseconds(start));
+
+			start = std::chrono::steady_clock::now();
+			decoder.DecodePlanesMemory(data.data(), data.size(), planes);
+			converter.Convert(planes, textureID, decoder.IsFlippedVertically());
+			glFinish();
+			gpuTime = std::min(gpuTime, ElapsedMilliseconds(start));
+		}
+
+		// largest channel difference from the CPU decode
+		std::vector<unsigned char> converted((size_t)image.width * image.height * 4);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, converted.data());
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		int maxDifference = 0;
+		for (size_t p = 0; p < (size_t)image.width * image.height; p++)
+		{
+			for (int c = 0; c < image.colorChannels; c++)
+			{
+				maxDifference = std::max(maxDifference,
+					std::abs((int)converted[p * 4 + c] - (int)image.pixels[p * image.colorChannels + c]));
+			}
+		}
+
+		size_t rgbBytes = image.pixels.size();
+		size_t planeBytes = YCbCrConverter::UploadBytes(planes);
+		bAllExact = bAllExact && (maxDifference == 0);
+		cpuTotal += cpuTime;
+		gpuTotal += gpuTime;
+		rgbBytesTotal += rgbBytes;
+		planeBytesTotal += planeBytes;
+		convertedCount++;
+
+		std::string name = m_textureFiles[i].substr(m_textureFiles[i].find_last_of('/') + 1);
+		std::cout << std::left << std::setw(22) << name << std::right
+			<< std::setw(11) << (std::to_string(image.width) + "x" + std::to_string(image.height))
+			<< std::setw(9) << std::fixed << std::setprecision(1) << cpuTime
+			<< std::setw(9) << gpuTime
+			<< std::setw(8) << std::setprecision(2) << (cpuTime / gpuTime) << "x"
+			<< std::setw(11) << (rgbBytes / 1024) << std::setw(11) << (planeBytes / 1024)
+			<< std::setw(14) << ((maxDifference == 0) ? std::string("exact") : ("max diff " + std::to_string(maxDifference)))
+			<< std::setprecision(1) << std::endl;
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDeleteTextures(1, &textureID);
+
+	std::cout << convertedCount << " baseline files: CPU " << cpuTotal << " ms, GPU " << gpuTotal << " ms, uploaded "
+		<< (rgbBytesTotal / 1024) << " KB as RGB and " << (planeBytesTotal / 1024) << " KB as planes, "
+		<< (bAllExact ? "bit exact" : "NOT bit exact") << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(convertedCount > 0);
+}
+
+/***********************************************************
+ *  RunProceduralBenchmark()
+ *
+ *  Time filling the viewport with each procedural pattern,
+ *  at every quality preset, against the photo texture it
+ *  stands in for sampled with trilinear filtering.  The
+ *  time and memory the texture needs to load are reported
+ *  next to it, which the patterns need none of.
+ ***********************************************************/
+bool BenchmarkRunner::RunProceduralBenchmark()
+{
+	struct PATTERN_SETUP
+	{
+		const char* name;
+		SceneManager::PROCEDURAL_PATTERN pattern;
+		const char* textureFile;
+		glm::vec3 color1;
+		glm::vec3 color2;
+	};
+	const PATTERN_SETUP patterns[] = {
+		{ "wood", SceneManager::PATTERN_WOOD, "../../Utilities/textures/Wood_Floor.jpg", glm::vec3(0.62f, 0.42f, 0.24f), glm::vec3(0.34f, 0.20f, 0.10f) },
+		{ "tile", SceneManager::PATTERN_TILE, "../../Utilities/textures/Ancient Flooring.jpg", glm::vec3(0.78f, 0.70f, 0.56f), glm::vec3(0.32f, 0.28f, 0.22f) },
+		{ "metal", SceneManager::PATTERN_METAL, "../../Utilities/textures/stainless.jpg", glm::vec3(1.0f), glm::vec3(0.0f) } };
+	const int FRAMES = 20;
+
+	// a plane rotated to face the camera fills the viewport
+	ShapeMeshes meshes;
+	meshes.LoadPlaneMesh();
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::mat4(1.0f));
+	m_pShaderManager->setIntValue("bUseLighting", false);
+	m_pShaderManager->setIntValue("bUseAtlas", false);
+	m_pShaderManager->setVec2Value("UVscale", glm::vec2(2.0f, 2.0f));
+	m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.627f, 0.627f, 0.627f, 1.0f));
+	m_pShaderManager->setSampler2DValue("objectTexture", 0);
+	glDisable(GL_DEPTH_TEST);
+
+	// best time of drawing the frames, in milliseconds per frame
+	auto timeFrames = [&]() {
+		double bestTime = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int frame = 0; frame < FRAMES; frame++)
+			{
+				glClear(GL_COLOR_BUFFER_BIT);
+				meshes.DrawPlaneMesh();
+			}
+			glFinish();
+			bestTime = std::min(bestTime, ElapsedMilliseconds(start) / FRAMES);
+		}
+		return(bestTime);
+	};
+
+	std::cout << std::endl << "Procedural material benchmark - " << viewport[2] << "x" << viewport[3]
+		<< " pixels, ms per frame" << std::endl;
+	std::cout << std::left << std::setw(8) << "pattern" << std::right << std::setw(10) << "sampled"
+		<< std::setw(10) << "load ms" << std::setw(10) << "tex KB" << std::setw(10) << "fast"
+		<< std::setw(10) << "detailed" << std::endl;
+
+	stbi_set_flip_vertically_on_load(true);
+	bool bSuccess = true;
+	for (int i = 0; i < (int)(sizeof(patterns) / sizeof(patterns[0])); i++)
+	{
+		const PATTERN_SETUP& setup = patterns[i];
+
+		// the photo texture, loaded like the scene would
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		unsigned char* image = stbi_load(setup.textureFile, &width, &height, &colorChannels, 3);
+		if (image == NULL)
+		{
+			std::cout << "Could not load image:" << setup.textureFile << std::endl;
+			bSuccess = false;
+			continue;
+		}
+		GLuint textureID = 0;
+		glGenTextures(1, &textureID);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glFinish();
+		double loadTime = ElapsedMilliseconds(start);
+		stbi_image_free(image);
+		// RGBA8 with its mip chain
+		size_t textureBytes = ((size_t)width * height * 4 * 4) / 3;
+
+		m_pShaderManager->setIntValue("proceduralPattern", SceneManager::PATTERN_NONE);
+		m_pShaderManager->setIntValue("bUseTexture", true);
+		double sampledTime = timeFrames();
+
+		// brushed metal shades the plain color, the others replace it
+		m_pShaderManager->setIntValue("bUseTexture", false);
+		m_pShaderManager->setIntValue("proceduralPattern", setup.pattern);
+		m_pShaderManager->setVec3Value("patternColor1", setup.color1);
+		m_pShaderManager->setVec3Value("patternColor2", setup.color2);
+		m_pShaderManager->setFloatValue("patternScale", 1.0f);
+		m_pShaderManager->setIntValue("patternOctaves", SceneManager::GetPatternOctaves(SceneManager::PROCEDURAL_FAST));
+		double fastTime = timeFrames();
+		m_pShaderManager->setIntValue("patternOctaves", SceneManager::GetPatternOctaves(SceneManager::PROCEDURAL_DETAILED));
+		double detailedTime = timeFrames();
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glDeleteTextures(1, &textureID);
+
+		std::cout << std::left << std::setw(8) << setup.name << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << sampledTime << std::setw(10) << std::setprecision(1) << loadTime
+			<< std::setw(10) << (textureBytes / 1024) << std::setprecision(2) << std::setw(10) << fastTime
+			<< std::setw(10) << detailedTime << std::endl;
+	}
+	m_pShaderManager->setIntValue("proceduralPattern", SceneManager::PATTERN_NONE);
+	glEnable(GL_DEPTH_TEST);
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  RunVirtualTextureBenchmark()
+ *
+ *  Draw every shipped texture in turn across the viewport,
+ *  zooming in from four repeats to half of one, first with
+ *  each texture resident with its whole mip chain and then
+ *  as virtual textures through page caches of a few sizes.
+ *  The virtual frames include the feedback pass and the
+ *  page uploads, and pages stream in while the frames run,
+ *  so the share of requested pages drawn from a coarser page
+ *  shows how well each cache keeps up.  The start time is
+ *  the wait for the coarsest page of every texture, which
+ *  includes building the tiled files the first time.
+ ***********************************************************/
+bool BenchmarkRunner::RunVirtualTextureBenchmark()
+{
+	const int cacheSizes[] = { 4, 8, 16 };
+	const int FRAMES_PER_TEXTURE = 8;
+	const int PAGE_TABLE_UNIT = 14;
+	const int PAGE_CACHE_UNIT = 15;
+
+	// a plane rotated to face the camera fills the viewport
+	ShapeMeshes meshes;
+	meshes.LoadPlaneMesh();
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::mat4(1.0f));
+	m_pShaderManager->setIntValue("bUseLighting", false);
+	m_pShaderManager->setIntValue("bUseAtlas", false);
+	m_pShaderManager->setIntValue("bUseTexture", true);
+	m_pShaderManager->setIntValue("proceduralPattern", SceneManager::PATTERN_NONE);
+	m_pShaderManager->setSampler2DValue("objectTexture", 0);
+	glDisable(GL_DEPTH_TEST);
+
+	// the zoom of a frame, halving the repeats every two frames
+	auto frameUVScale = [&](int frame) {
+		float repeats = 4.0f / (float)(1 << ((frame % FRAMES_PER_TEXTURE) / 2));
+		return(glm::vec2(repeats, repeats));
+	};
+
+	std::vector<std::string> files;
+	std::vector<int> widths;
+	std::vector<int> heights;
+	for (int i = 0; i < (int)m_textureFiles.size(); i++)
+	{
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		if (stbi_info(m_textureFiles[i].c_str(), &width, &height, &colorChannels) == 0)
+		{
+			std::cout << "Could not load image:" << m_textureFiles[i] << std::endl;
+			continue;
+		}
+		files.push_back(m_textureFiles[i]);
+		widths.push_back(width);
+		heights.push_back(height);
+	}
+	if (files.size() == 0)
+	{
+		return(false);
+	}
+	int frames = (int)files.size() * FRAMES_PER_TEXTURE;
+
+	std::cout << std::endl << "Virtual texture benchmark - " << files.size() << " textures, "
+		<< viewport[2] << "x" << viewport[3] << " pixels, " << frames << " frames" << std::endl;
+	std::cout << std::left << std::setw(12) << "textures" << std::right << std::setw(10) << "tex KB"
+		<< std::setw(10) << "start ms" << std::setw(10) << "ms/frame" << std::setw(10) << "loaded"
+		<< std::setw(10) << "evicted" << std::setw(10) << "coarser" << std::endl;
+
+	// every texture resident with the mip chain the driver builds
+	stbi_set_flip_vertically_on_load(true);
+	std::vector<GLuint> textureIDs;
+	size_t residentBytes = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		unsigned char* image = stbi_load(files[i].c_str(), &width, &height, &colorChannels, 4);
+		GLuint textureID = 0;
+		glGenTextures(1, &textureID);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		stbi_image_free(image);
+		textureIDs.push_back(textureID);
+		residentBytes += ((size_t)width * height * 4 * 4) / 3;
+	}
+	glFinish();
+	double residentStart = ElapsedMilliseconds(start);
+
+	double residentTime = 1.0e30;
+	for (int run = 0; run < BENCHMARK_RUNS; run++)
+	{
+		glFinish();
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			glBindTexture(GL_TEXTURE_2D, textureIDs[frame / FRAMES_PER_TEXTURE]);
+			m_pShaderManager->setVec2Value("UVscale", frameUVScale(frame));
+			glClear(GL_COLOR_BUFFER_BIT);
+			meshes.DrawPlaneMesh();
+		}
+		glFinish();
+		residentTime = std::min(residentTime, ElapsedMilliseconds(start) / frames);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDeleteTextures((GLsizei)textureIDs.size(), textureIDs.data());
+
+	std::cout << std::left << std::setw(12) << "resident" << std::right << std::fixed << std::setprecision(1)
+		<< std::setw(10) << (residentBytes / 1024) << std::setw(10) << residentStart
+		<< std::setw(10) << std::setprecision(2) << residentTime << std::setw(10) << "-"
+		<< std::setw(10) << "-" << std::setw(10) << "-" << std::endl;
+
+	MipGenerator mipGenerator(MipGenerator::MIP_FILTER_KAISER, true);
+	JpegDecoder jpegDecoder;
+	bool bSuccess = true;
+	size_t virtualBytes = 0;
+	for (int c = 0; c < (int)(sizeof(cacheSizes) / sizeof(cacheSizes[0])); c++)
+	{
+		VirtualTextureSystem system(&mipGenerator, &jpegDecoder, cacheSizes[c]);
+		if (system.Initialize(PAGE_TABLE_UNIT, PAGE_CACHE_UNIT) == false)
+		{
+			bSuccess = false;
+			break;
+		}
+
+		start = std::chrono::steady_clock::now();
+		std::vector<int> textures;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			textures.push_back(system.AddTexture(files[i], widths[i], heights[i]));
+		}
+		while (system.IsBusy() == true)
+		{
+			system.Update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		double virtualStart = ElapsedMilliseconds(start);
+
+		// each frame finds its pages at the start, like the scene,
+		// and the requests are summed over the whole sequence
+		int requested = 0;
+		int missing = 0;
+		glFinish();
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			system.Update();
+			system.BindTexture(textures[frame / FRAMES_PER_TEXTURE], m_pShaderManager);
+			m_pShaderManager->setVec2Value("UVscale", frameUVScale(frame));
+			system.BeginFeedbackPass(m_pShaderManager);
+			meshes.DrawPlaneMesh();
+			system.EndFeedbackPass(m_pShaderManager);
+			glClear(GL_COLOR_BUFFER_BIT);
+			meshes.DrawPlaneMesh();
+			requested += system.GetStats().requestedPages;
+			missing += system.GetStats().missingPages;
+		}
+		glFinish();
+		double virtualTime = ElapsedMilliseconds(start) / frames;
+
+		const VirtualTextureSystem::VIRTUAL_TEXTURE_STATS& stats = system.GetStats();
+		virtualBytes = stats.virtualBytes;
+		std::string name = "cache " + std::to_string(cacheSizes[c] * cacheSizes[c]);
+		std::cout << std::left << std::setw(12) << name << std::right << std::setprecision(1)
+			<< std::setw(10) << (stats.cacheBytes / 1024) << std::setw(10) << virtualStart
+			<< std::setw(10) << std::setprecision(2) << virtualTime << std::setw(10) << stats.loadedPages
+			<< std::setw(10) << stats.evictedPages << std::setw(9) << std::setprecision(1)
+			<< ((requested > 0) ? (100.0 * missing / requested) : 0.0) << "%" << std::endl;
+	}
+	std::cout << "every page of every texture: " << (virtualBytes / 1024) << " KB in the tiled files" << std::endl;
+
+	m_pShaderManager->setIntValue("bUseVirtualTexture", false);
+	glEnable(GL_DEPTH_TEST);
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  RunMeshBenchmark()
+ *
+ *  Draw each shape the scene uses many times and report the
+ *  vertices and indices stored for it, the vertex shader
+ *  runs of one draw as counted by the driver, and the time
+ *  per draw.  Rasterization is discarded, so the time is
+ *  that of fetching and shading the vertices.  The vertex
+ *  shader runs are only counted when the driver supports
+ *  pipeline statistics queries.
+ ***********************************************************/
+bool BenchmarkRunner::RunMeshBenchmark()
+{
+	const int DRAWS = 500;
+
+	ShapeMeshes meshes;
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::mat4(1.0f));
+	m_pShaderManager->setIntValue("bUseLighting", false);
+	m_pShaderManager->setIntValue("bUseTexture", false);
+	m_pShaderManager->setIntValue("bUseAtlas", false);
+	m_pShaderManager->setIntValue("proceduralPattern", SceneManager::PATTERN_NONE);
+	m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.627f, 0.627f, 0.627f, 1.0f));
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	bool bQueryInvocations = (GLEW_ARB_pipeline_statistics_query != 0);
+	GLuint query = 0;
+	if (bQueryInvocations == true)
+	{
+		glGenQueries(1, &query);
+	}
+
+	std::cout << std::endl << "Mesh benchmark - " << DRAWS << " draws of each shape" << std::endl;
+	std::cout << std::left << std::setw(12) << "shape" << std::right << std::setw(10) << "vertices"
+		<< std::setw(10) << "indices" << std::setw(10) << "VB bytes" << std::setw(10) << "IB bytes"
+		<< std::setw(10) << "VS runs" << std::setw(10) << "us/draw" << std::endl;
+
+	ShapeMeshes::MESH_STATS totals = {};
+	for (int shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+	{
+		meshes.DestroyMeshes();
+		LoadMeshShape(meshes, shape);
+
+		// the half torus shares the torus mesh, so it is left
+		// out of the totals
+		ShapeMeshes::MESH_STATS stats = meshes.GetMeshStats();
+		if (shape < MESH_SHAPE_COUNT - 1)
+		{
+			totals.vertices += stats.vertices;
+			totals.indices += stats.indices;
+			totals.vertexBytes += stats.vertexBytes;
+			totals.indexBytes += stats.indexBytes;
+		}
+
+		// vertex shader runs of a single draw
+		GLuint invocations = 0;
+		if (bQueryInvocations == true)
+		{
+			invocations = CountVertexShaderRuns(meshes, shape, query);
+		}
+
+		double bestTime = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int draw = 0; draw < DRAWS; draw++)
+			{
+				DrawMeshShape(meshes, shape);
+			}
+			glFinish();
+			bestTime = std::min(bestTime, ElapsedMilliseconds(start) * 1000.0 / DRAWS);
+		}
+
+		std::cout << std::left << std::setw(12) << g_MeshShapeNames[shape] << std::right
+			<< std::setw(10) << stats.vertices << std::setw(10) << stats.indices
+			<< std::setw(10) << stats.vertexBytes << std::setw(10) << stats.indexBytes;
+		if (bQueryInvocations == true)
+		{
+			std::cout << std::setw(10) << invocations;
+		}
+		else
+		{
+			std::cout << std::setw(10) << "-";
+		}
+		std::cout << std::fixed << std::setprecision(2) << std::setw(10) << bestTime << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	}
+	std::cout << "all shapes: " << totals.vertices << " vertices, " << totals.indices << " indices, "
+		<< ((totals.vertexBytes + totals.indexBytes) / 1024) << " KB" << std::endl;
+
+	if (bQueryInvocations == true)
+	{
+		glDeleteQueries(1, &query);
+	}
+	meshes.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+	glEnable(GL_DEPTH_TEST);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RunMeshOptimizerBenchmark()
+ *
+ *  Measure each shape as generated and after the mesh
+ *  optimizer reorders it: the vertices transformed per
+ *  triangle and per vertex by a 16 entry FIFO cache, the
+ *  bytes fetched per vertex byte, and the pixels shaded per
+ *  covered pixel from the six axis directions.  Then count
+ *  the vertex shader runs of drawing each shape loaded with
+ *  mesh optimization off and on, when the driver supports
+ *  pipeline statistics queries.
+ ***********************************************************/
+bool BenchmarkRunner::RunMeshOptimizerBenchmark()
+{
+	std::cout << std::endl << "Mesh optimizer benchmark - " << MeshOptimizer::DEFAULT_CACHE_SIZE
+		<< " entry transform cache, as generated / optimized" << std::endl;
+	std::cout << std::left << std::setw(12) << "shape" << std::right << std::setw(14) << "ACMR"
+		<< std::setw(14) << "ATVR" << std::setw(14) << "overfetch" << std::setw(14) << "overdraw"
+		<< std::setw(10) << "opt ms" << std::setw(14) << "VS runs" << std::endl;
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::mat4(1.0f));
+	glEnable(GL_RASTERIZER_DISCARD);
+	bool bQueryInvocations = (GLEW_ARB_pipeline_statistics_query != 0);
+	GLuint query = 0;
+	if (bQueryInvocations == true)
+	{
+		glGenQueries(1, &query);
+	}
+	ShapeMeshes generatedMeshes;
+	generatedMeshes.SetMeshOptimization(false);
+	ShapeMeshes optimizedMeshes;
+
+	const int vertexBytes = ShapeGenerator::FLOATS_PER_VERTEX * sizeof(GLfloat);
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	for (int shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+	{
+		std::cout << std::left << std::setw(12) << g_MeshShapeNames[shape] << std::right << std::fixed;
+
+		// the half torus has no data of its own
+		if (shape < MESH_SHAPE_COUNT - 1)
+		{
+			GenerateMeshShape(shape, vertices, indices);
+			int vertexCount = (int)vertices.size() / ShapeGenerator::FLOATS_PER_VERTEX;
+			int indexCount = (int)indices.size();
+
+			MeshOptimizer::CACHE_METRICS cache[2];
+			MeshOptimizer::FETCH_METRICS fetch[2];
+			MeshOptimizer::OVERDRAW_METRICS overdraw[2];
+			double optimizeTime = 1.0e30;
+			std::vector<GLfloat> optimizedVertices;
+			std::vector<GLuint> optimizedIndices;
+			for (int run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				optimizedVertices = vertices;
+				optimizedIndices = indices;
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				GLuint wholeMesh = 0;
+				MeshOptimizer::OptimizeMesh(optimizedVertices.data(), vertexCount, ShapeGenerator::FLOATS_PER_VERTEX,
+					optimizedIndices.data(), indexCount, &wholeMesh, 1);
+				optimizeTime = std::min(optimizeTime, ElapsedMilliseconds(start));
+			}
+
+			for (int pass = 0; pass < 2; pass++)
+			{
+				const GLfloat* passVertices = (pass == 0) ? vertices.data() : optimizedVertices.data();
+				const GLuint* passIndices = (pass == 0) ? indices.data() : optimizedIndices.data();
+				cache[pass] = MeshOptimizer::AnalyzeVertexCache(passIndices, indexCount, vertexCount);
+				fetch[pass] = MeshOptimizer::AnalyzeVertexFetch(passIndices, indexCount, vertexCount, vertexBytes);
+				overdraw[pass] = MeshOptimizer::AnalyzeOverdraw(passIndices, indexCount, passVertices, vertexCount,
+					ShapeGenerator::FLOATS_PER_VERTEX);
+			}
+
+			std::cout << std::setprecision(3)
+				<< std::setw(8) << cache[0].acmr << std::setw(6) << cache[1].acmr
+				<< std::setw(8) << cache[0].atvr << std::setw(6) << cache[1].atvr
+				<< std::setw(8) << fetch[0].overfetch << std::setw(6) << fetch[1].overfetch
+				<< std::setw(8) << overdraw[0].overdraw << std::setw(6) << overdraw[1].overdraw
+				<< std::setw(10) << optimizeTime;
+		}
+		else
+		{
+			std::cout << std::setw(66) << " ";
+		}
+
+		if (bQueryInvocations == true)
+		{
+			generatedMeshes.DestroyMeshes();
+			optimizedMeshes.DestroyMeshes();
+			LoadMeshShape(generatedMeshes, shape);
+			LoadMeshShape(optimizedMeshes, shape);
+			std::cout << std::setw(8) << CountVertexShaderRuns(generatedMeshes, shape, query)
+				<< std::setw(6) << CountVertexShaderRuns(optimizedMeshes, shape, query);
+		}
+		else
+		{
+			std::cout << std::setw(14) << "-";
+		}
+		std::cout << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+
+	if (bQueryInvocations == true)
+	{
+		glDeleteQueries(1, &query);
+	}
+	generatedMeshes.DestroyMeshes();
+	optimizedMeshes.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RunVertexFormatBenchmark()
+ *
+ *  Compare the vertex formats of the shape meshes: the bytes
+ *  all of the shapes take, the largest error packing them,
+ *  and the rate a dense sphere's vertices are read and
+ *  transformed at, with rasterization turned off so that
+ *  only the vertex work is timed.
+ ***********************************************************/
+bool BenchmarkRunner::RunVertexFormatBenchmark()
+{
+	const int DENSE_SEGMENTS = 256;
+	const int DRAWS = 50;
+	const char* formatNames[] = { "float", "quantized", "compact" };
+	const ShapeMeshes::VertexFormat formats[] = {
+		ShapeMeshes::floatVertices, ShapeMeshes::quantizedVertices, ShapeMeshes::compactVertices };
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::mat4(1.0f));
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	std::cout << std::endl << "Vertex format benchmark - " << DRAWS << " draws of a "
+		<< DENSE_SEGMENTS << "x" << DENSE_SEGMENTS << " sphere" << std::endl;
+	std::cout << std::left << std::setw(12) << "format" << std::right << std::setw(8) << "bytes"
+		<< std::setw(12) << "shapes KB" << std::setw(12) << "pos error" << std::setw(12) << "normal deg"
+		<< std::setw(12) << "uv error" << std::setw(12) << "Mverts/s" << std::endl;
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	for (int f = 0; f < 3; f++)
+	{
+		// every shape but the half torus, which shares the torus
+		ShapeMeshes meshes;
+		meshes.SetVertexFormat(formats[f]);
+		PACKING_ERROR error = {};
+		for (int shape = 0; shape < MESH_SHAPE_COUNT - 1; shape++)
+		{
+			LoadMeshShape(meshes, shape);
+			if (formats[f] == ShapeMeshes::floatVertices)
+			{
+				continue;
+			}
+
+			GenerateMeshShape(shape, vertices, indices);
+			int vertexCount = (int)vertices.size() / ShapeGenerator::FLOATS_PER_VERTEX;
+			glm::vec3 scale = VertexQuantizer::PositionScale(vertices.data(), vertexCount, ShapeGenerator::FLOATS_PER_VERTEX);
+			if (formats[f] == ShapeMeshes::quantizedVertices)
+			{
+				std::vector<VertexQuantizer::QUANTIZED_VERTEX> packed(vertexCount);
+				VertexQuantizer::QuantizeVertices(vertices.data(), vertexCount, ShapeGenerator::FLOATS_PER_VERTEX, scale, packed.data());
+				for (int v = 0; v < vertexCount; v++)
+				{
+					AddPackingError(&vertices[v * ShapeGenerator::FLOATS_PER_VERTEX],
+						VertexQuantizer::DecodePosition(packed[v].position, scale),
+						VertexQuantizer::DecodeNormal(packed[v].normal),
+						VertexQuantizer::DecodeUV(packed[v].uv), error);
+				}
+			}
+			else
+			{
+				std::vector<VertexQuantizer::COMPACT_VERTEX> packed(vertexCount);
+				VertexQuantizer::QuantizeVertices(vertices.data(), vertexCount, ShapeGenerator::FLOATS_PER_VERTEX, scale, packed.data());
+				for (int v = 0; v < vertexCount; v++)
+				{
+					AddPackingError(&vertices[v * ShapeGenerator::FLOATS_PER_VERTEX],
+						VertexQuantizer::DecodePosition(packed[v].position, scale),
+						VertexQuantizer::DecodeNormal(packed[v].normal),
+						VertexQuantizer::DecodeUV(packed[v].uv), error);
+				}
+			}
+		}
+		ShapeMeshes::MESH_STATS stats = meshes.GetMeshStats();
+		meshes.DestroyMeshes();
+
+		// the dense sphere replaces the shapes
+		meshes.LoadSphereMesh(DENSE_SEGMENTS, DENSE_SEGMENTS);
+		ShapeMeshes::MESH_STATS dense = meshes.GetMeshStats();
+		double bestTime = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int draw = 0; draw < DRAWS; draw++)
+			{
+				meshes.DrawSphereMesh();
+			}
+			glFinish();
+			bestTime = std::min(bestTime, ElapsedMilliseconds(start));
+		}
+		meshes.DestroyMeshes();
+
+		std::cout << std::left << std::setw(12) << formatNames[f] << std::right
+			<< std::setw(8) << (dense.vertexBytes / dense.vertices)
+			<< std::setw(12) << (stats.vertexBytes / 1024) << std::scientific << std::setprecision(2)
+			<< std::setw(12) << error.position << std::fixed << std::setw(12) << error.normal
+			<< std::scientific << std::setw(12) << error.uv << std::fixed
+			<< std::setw(12) << ((double)dense.vertices * DRAWS / (bestTime * 1000.0)) << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RunMeshArenaBenchmark()
+ *
+ *  Draw every shape in turn, so that each draw is of a
+ *  different mesh, first as separate draws and then
+ *  collected into multi-draw batches, with rasterization
+ *  turned off so that only the draw overhead and vertex
+ *  work is timed.  Then reload every shape and check that
+ *  the arena reused the space of the replaced meshes.
+ ***********************************************************/
+bool BenchmarkRunner::RunMeshArenaBenchmark()
+{
+	const int ROUNDS = 200;
+
+	ShapeMeshes meshes;
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::mat4(1.0f));
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	for (int shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+	{
+		LoadMeshShape(meshes, shape);
+	}
+	ShapeMeshes::MESH_STATS loaded = meshes.GetMeshStats();
+
+	double separateTime = 1.0e30;
+	double batchedTime = 1.0e30;
+	for (int run = 0; run < BENCHMARK_RUNS; run++)
+	{
+		glFinish();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int round = 0; round < ROUNDS; round++)
+		{
+			for (int shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+			{
+				DrawMeshShape(meshes, shape);
+			}
+		}
+		glFinish();
+		separateTime = std::min(separateTime, ElapsedMilliseconds(start));
+
+		glFinish();
+		start = std::chrono::steady_clock::now();
+		for (int round = 0; round < ROUNDS; round++)
+		{
+			meshes.BeginDrawBatch();
+			for (int shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+			{
+				DrawMeshShape(meshes, shape);
+			}
+			meshes.EndDrawBatch();
+		}
+		glFinish();
+		batchedTime = std::min(batchedTime, ElapsedMilliseconds(start));
+	}
+
+	// loading a shape again replaces its mesh in place
+	for (int shape = 0; shape < MESH_SHAPE_COUNT; shape++)
+	{
+		LoadMeshShape(meshes, shape);
+	}
+	ShapeMeshes::MESH_STATS reloaded = meshes.GetMeshStats();
+	meshes.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	std::cout << std::endl << "Mesh arena benchmark - " << ROUNDS << " rounds of drawing each shape" << std::endl;
+	std::cout << loaded.meshes << " meshes, " << ((loaded.vertexBytes + loaded.indexBytes) / 1024)
+		<< " KB of data in " << (loaded.arenaBytes / 1024) << " KB of arena, "
+		<< (reloaded.arenaBytes / 1024) << " KB after reloading them all" << std::endl;
+	std::cout << std::fixed << std::setprecision(2)
+		<< "separate draws: " << (separateTime * 1000.0 / (ROUNDS * MESH_SHAPE_COUNT)) << " us/draw" << std::endl
+		<< "batched draws:  " << (batchedTime * 1000.0 / (ROUNDS * MESH_SHAPE_COUNT)) << " us/draw"
+		<< (GLEW_ARB_multi_draw_indirect ? "" : " (no multi-draw indirect, drawn one by one)") << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(reloaded.arenaBytes == loaded.arenaBytes);
+}
+
+/***********************************************************
+ *  RunMeshLodBenchmark()
+ *
+ *  Draw each round shape as if it covered fewer and fewer
+ *  pixels on screen, with an error budget of one pixel, and
+ *  report the triangles drawn against those of full detail
+ *  and the time per draw.  Rasterization is discarded, so
+ *  the time is that of the vertex work the levels save.
+ ***********************************************************/
+bool BenchmarkRunner::RunMeshLodBenchmark()
+{
+	const int DRAWS = 500;
+	const float ERROR_BUDGET = 1.0f;
+	// the round shapes of g_MeshShapeNames
+	const int ROUND_SHAPES[] = { 1, 2, 7, 8, 9 };
+	// pixels covered by one unit of the mesh - a unit shape's
+	// radius on screen
+	const float PIXELS_PER_UNIT[] = { 400.0f, 100.0f, 25.0f, 6.0f };
+
+	ShapeMeshes meshes;
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::mat4(1.0f));
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	for (int shape : ROUND_SHAPES)
+	{
+		LoadMeshShape(meshes, shape);
+	}
+	meshes.SetLodErrorBudget(ERROR_BUDGET);
+
+	std::cout << std::endl << "Mesh LOD benchmark - " << DRAWS << " draws of each shape, "
+		<< ERROR_BUDGET << " pixel error budget" << std::endl;
+	std::cout << std::left << std::setw(12) << "shape" << std::right << std::setw(10) << "px/unit"
+		<< std::setw(12) << "triangles" << std::setw(12) << "full" << std::setw(10) << "saved"
+		<< std::setw(10) << "us/draw" << std::setw(10) << "full us" << std::endl;
+
+	ShapeMeshes::LOD_STATS totals = {};
+	for (int shape : ROUND_SHAPES)
+	{
+		for (float pixelsPerUnit : PIXELS_PER_UNIT)
+		{
+			meshes.SetLodScale(pixelsPerUnit);
+			meshes.ResetLodStats();
+			DrawMeshShape(meshes, shape);
+			ShapeMeshes::LOD_STATS stats = meshes.GetLodStats();
+			totals.drawnTriangles += stats.drawnTriangles;
+			totals.fullDetailTriangles += stats.fullDetailTriangles;
+
+			// time the chosen level, then full detail
+			double lodTime = 1.0e30;
+			double fullTime = 1.0e30;
+			for (int run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				meshes.SetLodErrorBudget(ERROR_BUDGET);
+				glFinish();
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (int draw = 0; draw < DRAWS; draw++)
+				{
+					DrawMeshShape(meshes, shape);
+				}
+				glFinish();
+				lodTime = std::min(lodTime, ElapsedMilliseconds(start) * 1000.0 / DRAWS);
+
+				meshes.SetLodErrorBudget(0.0f);
+				glFinish();
+				start = std::chrono::steady_clock::now();
+				for (int draw = 0; draw < DRAWS; draw++)
+				{
+					DrawMeshShape(meshes, shape);
+				}
+				glFinish();
+				fullTime = std::min(fullTime, ElapsedMilliseconds(start) * 1000.0 / DRAWS);
+			}
+			meshes.SetLodErrorBudget(ERROR_BUDGET);
+
+			int saved = stats.fullDetailTriangles - stats.drawnTriangles;
+			std::cout << std::left << std::setw(12) << g_MeshShapeNames[shape] << std::right
+				<< std::setw(10) << (int)pixelsPerUnit << std::setw(12) << stats.drawnTriangles
+				<< std::setw(12) << stats.fullDetailTriangles << std::setw(9)
+				<< ((stats.fullDetailTriangles > 0) ? (100 * saved / stats.fullDetailTriangles) : 0) << "%"
+				<< std::fixed << std::setprecision(2) << std::setw(10) << lodTime << std::setw(10) << fullTime << std::endl;
+			std::cout.unsetf(std::ios::floatfield);
+		}
+	}
+	std::cout << "triangles saved: " << (totals.fullDetailTriangles - totals.drawnTriangles) << " of "
+		<< totals.fullDetailTriangles << std::endl;
+
+	meshes.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	// the smaller sizes must use fewer triangles
+	return(totals.drawnTriangles < totals.fullDetailTriangles);
+}
+
+/***********************************************************
+ *  RunMeshletBenchmark()
+ *
+ *  Draw finely tessellated round shapes from a few views
+ *  with cluster culling, and report the clusters and
+ *  triangles drawn against the triangles submitted, and
+ *  against the triangles that are really visible - found
+ *  by culling every triangle on its own.  Rasterization is
+ *  discarded, so the time per draw is that of the culling
+ *  and the vertex work, with culling on and off.
+ ***********************************************************/
+bool BenchmarkRunner::RunMeshletBenchmark()
+{
+	const int DRAWS = 500;
+	// views of a unit shape: all of it in front of the camera, up
+	// close, and half of it past the edge of the screen
+	struct CLUSTER_VIEW
+	{
+		const char* name;
+		glm::vec3 eye;
+		glm::vec3 target;
+	};
+	const CLUSTER_VIEW VIEWS[] = {
+		{ "whole", glm::vec3(0.0f, 1.0f, 4.0f), glm::vec3(0.0f) },
+		{ "close", glm::vec3(0.3f, 0.4f, 1.6f), glm::vec3(0.0f) },
+		{ "edge", glm::vec3(0.0f, 0.5f, 3.0f), glm::vec3(1.6f, 0.0f, 0.0f) } };
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+	const glm::mat4 model(1.0f);
+
+	ShapeMeshes meshes;
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("model", model);
+	m_pShaderManager->setMat4Value("projection", projection);
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	std::cout << std::endl << "Meshlet benchmark - " << DRAWS << " draws of each shape and view, clusters of up to "
+		<< MeshletBuilder::DEFAULT_MAX_VERTICES << " vertices and " << MeshletBuilder::DEFAULT_MAX_TRIANGLES
+		<< " triangles" << std::endl;
+	std::cout << std::left << std::setw(10) << "shape" << std::setw(8) << "view" << std::right
+		<< std::setw(12) << "clusters" << std::setw(11) << "submitted" << std::setw(9) << "drawn"
+		<< std::setw(9) << "visible" << std::setw(10) << "culled us" << std::setw(10) << "all us" << std::endl;
+
+	ShapeMeshes::CLUSTER_STATS totals = {};
+	int totalVisible = 0;
+	for (int shape = 0; shape < DENSE_SHAPE_COUNT; shape++)
+	{
+		// the clusters are built when a mesh is loaded with
+		// culling on
+		meshes.DestroyMeshes();
+		meshes.SetClusterCulling(true);
+		LoadDenseShape(meshes, shape);
+
+		// every triangle as a cluster of its own, for the triangles
+		// that face the camera inside the view
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+		std::vector<MeshletBuilder::MESHLET> triangles;
+		GenerateDenseShape(shape, vertices, indices);
+		GLuint wholeMesh = 0;
+		MeshletBuilder::BuildMeshlets(vertices.data(), (int)vertices.size() / ShapeGenerator::FLOATS_PER_VERTEX,
+			ShapeGenerator::FLOATS_PER_VERTEX, indices.data(), (int)indices.size(), &wholeMesh, 1, triangles, 3, 1);
+
+		for (const CLUSTER_VIEW& clusterView : VIEWS)
+		{
+			glm::mat4 view = glm::lookAt(clusterView.eye, clusterView.target, glm::vec3(0.0f, 1.0f, 0.0f));
+			m_pShaderManager->setMat4Value("view", view);
+			meshes.SetClusterView(model, view, projection);
+
+			glm::vec4 planes[6];
+			MeshletBuilder::ExtractFrustumPlanes(projection * view, planes);
+			int visible = 0;
+			for (const MeshletBuilder::MESHLET& triangle : triangles)
+			{
+				if ((MeshletBuilder::IsOutsideFrustum(triangle, planes) == false) &&
+					(MeshletBuilder::IsBackFacing(triangle, clusterView.eye) == false))
+				{
+					visible++;
+				}
+			}
+
+			meshes.SetClusterCulling(true);
+			meshes.ResetClusterStats();
+			DrawDenseShape(meshes, shape);
+			ShapeMeshes::CLUSTER_STATS stats = meshes.GetClusterStats();
+			totals.testedClusters += stats.testedClusters;
+			totals.drawnClusters += stats.drawnClusters;
+			totals.submittedTriangles += stats.submittedTriangles;
+			totals.drawnTriangles += stats.drawnTriangles;
+			totalVisible += visible;
+
+			double culledTime = 1.0e30;
+			double allTime = 1.0e30;
+			for (int run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				meshes.SetClusterCulling(true);
+				glFinish();
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (int draw = 0; draw < DRAWS; draw++)
+				{
+					DrawDenseShape(meshes, shape);
+				}
+				glFinish();
+				culledTime = std::min(culledTime, ElapsedMilliseconds(start) * 1000.0 / DRAWS);
+
+				meshes.SetClusterCulling(false);
+				glFinish();
+				start = std::chrono::steady_clock::now();
+				for (int draw = 0; draw < DRAWS; draw++)
+				{
+					DrawDenseShape(meshes, shape);
+				}
+				glFinish();
+				allTime = std::min(allTime, ElapsedMilliseconds(start) * 1000.0 / DRAWS);
+			}
+
+			std::ostringstream clusters;
+			clusters << stats.drawnClusters << "/" << stats.testedClusters;
+			std::cout << std::left << std::setw(10) << g_DenseShapeNames[shape] << std::setw(8) << clusterView.name
+				<< std::right << std::setw(12) << clusters.str() << std::setw(11) << stats.submittedTriangles
+				<< std::setw(9) << stats.drawnTriangles << std::setw(9) << visible
+				<< std::fixed << std::setprecision(2) << std::setw(10) << culledTime << std::setw(10) << allTime << std::endl;
+			std::cout.unsetf(std::ios::floatfield);
+		}
+	}
+	std::cout << "triangles drawn: " << totals.drawnTriangles << " of " << totals.submittedTriangles
+		<< " submitted, " << totalVisible << " visible" << std::endl;
+
+	meshes.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	// culling must leave out some of the triangles
+	return(totals.drawnTriangles < totals.submittedTriangles);
+}
+
+/***********************************************************
+ *  RunMeshCacheBenchmark()
+ *
+ *  Load the round shapes of the scene and the dense shapes
+ *  of the meshlet benchmark, with every level and their
+ *  clusters, once generating them into a new cache file and
+ *  once from the mapped file, and report both times with
+ *  the time spent mapping and checking the file.  The cached
+ *  load must find every mesh and store the same geometry,
+ *  and a file cut short or with a damaged table must be
+ *  turned down.
+ ***********************************************************/
+bool BenchmarkRunner::RunMeshCacheBenchmark()
+{
+	const char* CACHE_FILE = "benchmark.meshcache";
+	// the round shapes of g_MeshShapeNames
+	const int ROUND_SHAPES[] = { 1, 2, 7, 8, 9 };
+
+	// load every shape through a cache file, generating the meshes
+	// it does not have - the time includes opening the file
+	auto loadShapes = [&](ShapeMeshes& meshes) {
+		meshes.SetClusterCulling(true);
+		glFinish();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		meshes.UseMeshCache(CACHE_FILE);
+		for (int shape : ROUND_SHAPES)
+		{
+			LoadMeshShape(meshes, shape);
+		}
+		for (int shape = 0; shape < DENSE_SHAPE_COUNT; shape++)
+		{
+			LoadDenseShape(meshes, shape);
+		}
+		glFinish();
+		return(ElapsedMilliseconds(start));
+	};
+
+	double generateTime = 1.0e30;
+	double cachedTime = 1.0e30;
+	ShapeMeshes::MESH_STATS generated = {};
+	ShapeMeshes::MESH_STATS cached = {};
+	MeshCache::CACHE_STATS generateStats = {};
+	MeshCache::CACHE_STATS cachedStats = {};
+	for (int run = 0; run < BENCHMARK_RUNS; run++)
+	{
+		std::remove(CACHE_FILE);
+		ShapeMeshes generating;
+		generateTime = std::min(generateTime, loadShapes(generating));
+		generated = generating.GetMeshStats();
+		generateStats = generating.GetMeshCacheStats();
+		generating.SaveMeshCache();
+		generating.DestroyMeshes();
+
+		ShapeMeshes loading;
+		cachedTime = std::min(cachedTime, loadShapes(loading));
+		cached = loading.GetMeshStats();
+		cachedStats = loading.GetMeshCacheStats();
+		loading.DestroyMeshes();
+	}
+
+	// a file cut short must fail the size check, and a changed
+	// byte of the table, just past the 32 byte header, must fail
+	// the table hash - the mesh data itself is not hashed
+	bool bDamageFound = false;
+	std::vector<char> file;
+	{
+		std::ifstream input(CACHE_FILE, std::ios::binary);
+		file.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+	}
+	if (file.size() > 64)
+	{
+		auto damagedFileFound = [&](const std::vector<char>& damagedFile) {
+			{
+				std::ofstream output(CACHE_FILE, std::ios::binary | std::ios::trunc);
+				output.write(damagedFile.data(), damagedFile.size());
+			}
+			MeshCache damaged;
+			return(damaged.Open(CACHE_FILE) == false);
+		};
+
+		std::vector<char> shortFile(file.begin(), file.end() - 64);
+		std::vector<char> changedFile = file;
+		changedFile[48] ^= 1;
+		bDamageFound = (damagedFileFound(shortFile) == true) && (damagedFileFound(changedFile) == true);
+	}
+	std::remove(CACHE_FILE);
+
+	std::cout << std::endl << "Mesh cache benchmark - " << generateStats.misses << " round mesh levels with their clusters, "
+		<< (cachedStats.fileBytes / 1024) << " KB cache file" << std::endl;
+	std::cout << std::fixed << std::setprecision(2)
+		<< "generated:   " << generateTime << " ms" << std::endl
+		<< "from cache:  " << cachedTime << " ms (map " << cachedStats.mapMilliseconds << " ms, validate "
+		<< cachedStats.validateMilliseconds << " ms), " << cachedStats.hits << " found, "
+		<< cachedStats.misses << " generated" << std::endl
+		<< "speedup:     " << ((cachedTime > 0.0) ? (generateTime / cachedTime) : 0.0) << "x" << std::endl
+		<< "damaged file " << ((bDamageFound == true) ? "turned down" : "NOT turned down") << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	return((cachedStats.misses == 0) &&
+		(cachedStats.hits == generateStats.misses) &&
+		(cached.vertexBytes == generated.vertexBytes) &&
+		(cached.indexBytes == generated.indexBytes) &&
+		(bDamageFound == true));
+}
+
+/***********************************************************
+ *  RunNormalBenchmark()
+ *
+ *  Compute the normals and tangents of the dense round
+ *  shapes and of a large torus with the scalar reference,
+ *  with the kernels on one thread and with the kernels on
+ *  every core, and report the times and the largest
+ *  difference from the reference, which must be none.  The
+ *  torus normals are also compared with the exact normals of
+ *  its surface, and every tangent must be at right angles to
+ *  its normal.
+ ***********************************************************/
+bool BenchmarkRunner::RunNormalBenchmark()
+{
+	const int LARGE_TORUS_SEGMENTS = 512;
+	const float LARGE_TORUS_THICKNESS = 0.25f;
+	const int FLOATS = ShapeGenerator::FLOATS_PER_VERTEX;
+	// at least two, so the threaded path is always checked
+	int threads = std::max(2, (int)std::thread::hardware_concurrency());
+
+	std::cout << std::endl << "Normal benchmark - " << NormalGenerator::GetInstructionSet() << ", "
+		<< threads << " threads, best of " << BENCHMARK_RUNS << " runs" << std::endl;
+	std::cout << std::left << std::setw(10) << "shape" << std::right << std::setw(10) << "triangles"
+		<< std::setw(11) << "ref ms" << std::setw(11) << "1 thread" << std::setw(11) << "threads"
+		<< std::setw(11) << "tan ref" << std::setw(11) << "1 thread" << std::setw(11) << "threads"
+		<< std::setw(12) << "max diff" << std::endl;
+
+	float largestDifference = 0.0f;
+	float largestSkew = 0.0f;
+	float torusError = 0.0f;
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	for (int shape = 0; shape <= DENSE_SHAPE_COUNT; shape++)
+	{
+		const char* name = "large";
+		if (shape < DENSE_SHAPE_COUNT)
+		{
+			name = g_DenseShapeNames[shape];
+			GenerateDenseShape(shape, vertices, indices);
+		}
+		else
+		{
+			ShapeGenerator::SHAPE_SIZE size = ShapeGenerator::TorusSize(LARGE_TORUS_SEGMENTS, LARGE_TORUS_SEGMENTS);
+			vertices.assign((size_t)size.vertexCount * FLOATS, 0.0f);
+			indices.assign(size.indexCount, 0);
+			ShapeGenerator::GenerateTorus(LARGE_TORUS_SEGMENTS, LARGE_TORUS_SEGMENTS, LARGE_TORUS_THICKNESS, vertices.data(), indices.data());
+		}
+		int vertexCount = (int)(vertices.size() / FLOATS);
+		int indexCount = (int)indices.size();
+
+		// time one way of computing the normals and tangents,
+		// keeping its results
+		auto timeNormals = [&](std::vector<GLfloat>& result, int threadCount) {
+			double best = 1.0e30;
+			for (int run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				result = vertices;
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				if (threadCount == 0)
+				{
+					NormalGenerator::GenerateNormalsReference(result.data(), vertexCount, FLOATS, indices.data(), indexCount);
+				}
+				else
+				{
+					NormalGenerator::GenerateNormals(result.data(), vertexCount, FLOATS, indices.data(), indexCount, threadCount);
+				}
+				best = std::min(best, ElapsedMilliseconds(start));
+			}
+			return(best);
+		};
+		auto timeTangents = [&](const std::vector<GLfloat>& source, std::vector<GLfloat>& result, int threadCount) {
+			double best = 1.0e30;
+			result.assign((size_t)vertexCount * NormalGenerator::FLOATS_PER_TANGENT, 0.0f);
+			for (int run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				if (threadCount == 0)
+				{
+					NormalGenerator::GenerateTangentsReference(source.data(), vertexCount, FLOATS, indices.data(), indexCount, result.data());
+				}
+				else
+				{
+					NormalGenerator::GenerateTangents(source.data(), vertexCount, FLOATS, indices.data(), indexCount, result.data(), threadCount);
+				}
+				best = std::min(best, ElapsedMilliseconds(start));
+			}
+			return(best);
+		};
+		auto largestChange = [](const std::vector<GLfloat>& a, const std::vector<GLfloat>& b) {
+			float largest = 0.0f;
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				largest = std::max(largest, std::fabs(a[i] - b[i]));
+			}
+			return(largest);
+		};
+
+		std::vector<GLfloat> reference;
+		std::vector<GLfloat> single;
+		std::vector<GLfloat> parallel;
+		double referenceTime = timeNormals(reference, 0);
+		double singleTime = timeNormals(single, 1);
+		double parallelTime = timeNormals(parallel, threads);
+		float difference = std::max(largestChange(reference, single), largestChange(reference, parallel));
+
+		std::vector<GLfloat> referenceTangents;
+		std::vector<GLfloat> singleTangents;
+		std::vector<GLfloat> parallelTangents;
+		double referenceTangentTime = timeTangents(reference, referenceTangents, 0);
+		double singleTangentTime = timeTangents(reference, singleTangents, 1);
+		double parallelTangentTime = timeTangents(reference, parallelTangents, threads);
+		difference = std::max(difference, std::max(
+			largestChange(referenceTangents, singleTangents),
+			largestChange(referenceTangents, parallelTangents)));
+		largestDifference = std::max(largestDifference, difference);
+
+		for (int v = 0; v < vertexCount; v++)
+		{
+			const GLfloat* vertex = &reference[(size_t)v * FLOATS];
+			glm::vec3 normal(vertex[3], vertex[4], vertex[5]);
+			glm::vec3 tangent(referenceTangents[(size_t)v * 4], referenceTangents[((size_t)v * 4) + 1], referenceTangents[((size_t)v * 4) + 2]);
+			largestSkew = std::max(largestSkew, std::fabs(glm::dot(normal, tangent)));
+
+			// the exact normal points from the middle of the tube
+			if ((shape == 2) || (shape == DENSE_SHAPE_COUNT))
+			{
+				glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+				glm::vec3 ring = glm::normalize(glm::vec3(position.x, position.y, 0.0f));
+				glm::vec3 exact = glm::normalize(position - ring);
+				float cosine = glm::clamp(glm::dot(normal, exact), -1.0f, 1.0f);
+				torusError = std::max(torusError, glm::degrees(std::acos(cosine)));
+			}
+		}
+
+		std::cout << std::left << std::setw(10) << name << std::right << std::setw(10) << (indexCount / 3)
+			<< std::fixed << std::setprecision(3)
+			<< std::setw(11) << referenceTime << std::setw(11) << singleTime << std::setw(11) << parallelTime
+			<< std::setw(11) << referenceTangentTime << std::setw(11) << singleTangentTime << std::setw(11) << parallelTangentTime
+			<< std::scientific << std::setprecision(1) << std::setw(12) << difference << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	}
+	std::cout << std::fixed << std::setprecision(3) << "torus normals within " << torusError
+		<< " degrees of the exact surface, tangents within " << std::scientific << std::setprecision(1)
+		<< largestSkew << " of right angles to the normals" << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	return((largestDifference == 0.0f) && (largestSkew < 1.0e-4f));
+}
+
+/***********************************************************
+ *  RunTessellationBenchmark()
+ *
+ *  Load the round shapes once as patches refined on the GPU
+ *  and once as detail levels, and report the bytes each
+ *  stores.  Then draw each shape at several distances and
+ *  report the triangles the tessellator made, counted with
+ *  a primitives generated query, against those of the level
+ *  chosen with a one pixel error budget and of full detail,
+ *  with the time per draw of both.
+ ***********************************************************/
+bool BenchmarkRunner::RunTessellationBenchmark()
+{
+	const int DRAWS = 100;
+	const int VIEWPORT_HEIGHT = 800;
+	const float EDGE_PIXELS = 8.0f;
+	const float ERROR_BUDGET = 1.0f;
+	// the round shapes of g_MeshShapeNames
+	const int ROUND_SHAPES[] = { 2, 7, 8, 9 };
+	const float DISTANCES[] = { 2.0f, 8.0f, 32.0f, 128.0f };
+
+	GLuint program = m_pShaderManager->LoadTessellationShaders(
+		"../../Utilities/shaders/tessellationVertexShader.glsl",
+		"../../Utilities/shaders/tessellationControlShader.glsl",
+		"../../Utilities/shaders/tessellationEvaluationShader.glsl",
+		"../../Utilities/shaders/fragmentShader.glsl");
+	if (program == 0)
+	{
+		std::cout << "Tessellation benchmark - the shaders did not build" << std::endl;
+		return(false);
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 1000.0f);
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", projection);
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	ShapeMeshes patches;
+	patches.SetTessellation(program, m_pShaderManager->m_programID);
+	patches.SetTessellationView(VIEWPORT_HEIGHT, EDGE_PIXELS);
+	ShapeMeshes levels;
+	levels.SetLodErrorBudget(ERROR_BUDGET);
+	for (int shape : ROUND_SHAPES)
+	{
+		LoadMeshShape(patches, shape);
+		LoadMeshShape(levels, shape);
+	}
+	ShapeMeshes::MESH_STATS patchStats = patches.GetMeshStats();
+	ShapeMeshes::MESH_STATS levelStats = levels.GetMeshStats();
+
+	std::cout << std::endl << "Tessellation benchmark - " << DRAWS << " draws of each shape, "
+		<< EDGE_PIXELS << " pixel edges against a " << ERROR_BUDGET << " pixel error budget" << std::endl;
+	std::cout << "stored: " << (patchStats.vertexBytes + patchStats.indexBytes) << " bytes of patches, "
+		<< (levelStats.vertexBytes + levelStats.indexBytes) << " bytes of detail levels" << std::endl;
+	std::cout << std::left << std::setw(12) << "shape" << std::right << std::setw(10) << "distance"
+		<< std::setw(12) << "tessellated" << std::setw(10) << "level" << std::setw(10) << "full"
+		<< std::setw(10) << "us/draw" << std::setw(10) << "level us" << std::endl;
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+
+	// the triangles of one draw, and the best time per draw
+	auto countTriangles = [&](ShapeMeshes& meshes, int shape) {
+		GLuint triangles = 0;
+		glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+		DrawMeshShape(meshes, shape);
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &triangles);
+		return((int)triangles);
+	};
+	auto timeDraws = [&](ShapeMeshes& meshes, int shape) {
+		double best = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int draw = 0; draw < DRAWS; draw++)
+			{
+				DrawMeshShape(meshes, shape);
+			}
+			glFinish();
+			best = std::min(best, ElapsedMilliseconds(start) * 1000.0 / DRAWS);
+		}
+		return(best);
+	};
+
+	bool bFewerFar = true;
+	for (int shape : ROUND_SHAPES)
+	{
+		int nearest = 0;
+		int farthest = 0;
+		for (float distance : DISTANCES)
+		{
+			m_pShaderManager->setMat4Value("model", glm::translate(glm::vec3(0.0f, 0.0f, -distance)));
+			// the same pixels per unit the tessellation control
+			// shader measures edges with
+			levels.SetLodScale(projection[1][1] * 0.5f * VIEWPORT_HEIGHT / distance);
+			levels.SetLodErrorBudget(0.0f);
+			int full = countTriangles(levels, shape);
+			levels.SetLodErrorBudget(ERROR_BUDGET);
+			int level = countTriangles(levels, shape);
+			int tessellated = countTriangles(patches, shape);
+			double patchTime = timeDraws(patches, shape);
+			double levelTime = timeDraws(levels, shape);
+
+			if (distance == DISTANCES[0])
+			{
+				nearest = tessellated;
+			}
+			farthest = tessellated;
+
+			std::cout << std::left << std::setw(12) << g_MeshShapeNames[shape] << std::right
+				<< std::setw(10) << (int)distance << std::setw(12) << tessellated << std::setw(10) << level
+				<< std::setw(10) << full << std::fixed << std::setprecision(2)
+				<< std::setw(10) << patchTime << std::setw(10) << levelTime << std::endl;
+			std::cout.unsetf(std::ios::floatfield);
+		}
+		bFewerFar = bFewerFar && (farthest < nearest);
+	}
+
+	glDeleteQueries(1, &query);
+	patches.DestroyMeshes();
+	levels.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	// distant shapes must be refined less than near ones
+	return(bFewerFar);
+}
+
+/***********************************************************
+ *  RunBufferlessBenchmark()
+ *
+ *  Load the shapes the vertex shader can make once as
+ *  stored meshes and once as types and tessellations, and
+ *  report the bytes each keeps.  Then draw a grid of all of
+ *  them, mixed, as one draw per object from the stored
+ *  meshes and as a single draw with no vertex data, and
+ *  report the time of each.  Both must make the same
+ *  number of triangles.
+ ***********************************************************/
+bool BenchmarkRunner::RunBufferlessBenchmark()
+{
+	const int DRAWS = 20;
+	const int INSTANCES_PER_SHAPE = 40;
+	// the shapes of g_MeshShapeNames the vertex shader makes
+	const int PRIMITIVE_SHAPES[] = { 0, 1, 2, 3, 7, 8, 9 };
+
+	GLuint program = m_pShaderManager->LoadBufferlessShaders(
+		"../../Utilities/shaders/bufferlessVertexShader.glsl",
+		"../../Utilities/shaders/fragmentShader.glsl");
+	if (program == 0)
+	{
+		std::cout << "Bufferless benchmark - the shaders did not build" << std::endl;
+		return(false);
+	}
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 1000.0f));
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	ShapeMeshes stored;
+	ShapeMeshes bufferless;
+	bufferless.SetBufferless(program, m_pShaderManager->m_programID);
+	for (int shape : PRIMITIVE_SHAPES)
+	{
+		LoadMeshShape(stored, shape);
+		LoadMeshShape(bufferless, shape);
+	}
+	ShapeMeshes::MESH_STATS storedStats = stored.GetMeshStats();
+	ShapeMeshes::MESH_STATS bufferlessStats = bufferless.GetMeshStats();
+
+	// a grid of every shape, one kind after another
+	std::vector<ShapeMeshes::PRIMITIVE_INSTANCE> instances;
+	std::vector<int> instanceShapes;
+	for (int shape : PRIMITIVE_SHAPES)
+	{
+		for (int i = 0; i < INSTANCES_PER_SHAPE; i++)
+		{
+			ShapeMeshes::PRIMITIVE_INSTANCE instance;
+			instance.shape = MeshShapePrimitive(shape);
+			instance.model = glm::translate(glm::vec3((float)(i % 8) - 3.5f, (float)(instanceShapes.size() / 8) * 0.5f - 10.0f, -25.0f));
+			instances.push_back(instance);
+			instanceShapes.push_back(shape);
+		}
+	}
+
+	auto drawStored = [&]() {
+		for (size_t i = 0; i < instances.size(); i++)
+		{
+			m_pShaderManager->setMat4Value("model", instances[i].model);
+			DrawMeshShape(stored, instanceShapes[i]);
+		}
+	};
+	auto drawBufferless = [&]() {
+		m_pShaderManager->setMat4Value("model", glm::mat4(1.0f));
+		bufferless.DrawPrimitives(instances.data(), (int)instances.size());
+	};
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+	auto countTriangles = [&](auto draw) {
+		GLuint triangles = 0;
+		glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+		draw();
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &triangles);
+		return((int)triangles);
+	};
+	auto timeFrames = [&](auto draw) {
+		double best = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int frame = 0; frame < DRAWS; frame++)
+			{
+				draw();
+			}
+			glFinish();
+			best = std::min(best, ElapsedMilliseconds(start) / DRAWS);
+		}
+		return(best);
+	};
+
+	int storedTriangles = countTriangles(drawStored);
+	int bufferlessTriangles = countTriangles(drawBufferless);
+	double storedTime = timeFrames(drawStored);
+	double bufferlessTime = timeFrames(drawBufferless);
+	glDeleteQueries(1, &query);
+
+	std::cout << std::endl << "Bufferless benchmark - " << instances.size() << " objects of "
+		<< (sizeof(PRIMITIVE_SHAPES) / sizeof(PRIMITIVE_SHAPES[0])) << " shapes, best of " << DRAWS << " frames" << std::endl;
+	std::cout << "stored: " << (storedStats.vertexBytes + storedStats.indexBytes) << " bytes of meshes, "
+		<< (bufferlessStats.vertexBytes + bufferlessStats.indexBytes) << " bytes without vertex data, "
+		<< sizeof(ShapeGenerator::PRIMITIVE) << " bytes per shape and "
+		<< sizeof(ShapeMeshes::PRIMITIVE_INSTANCE) << " per placed object" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< "stored meshes: " << instances.size() << " draws, " << storedTriangles << " triangles, " << storedTime << " ms" << std::endl
+		<< "bufferless:    1 draw, " << bufferlessTriangles << " triangles, " << bufferlessTime << " ms" << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	stored.DestroyMeshes();
+	bufferless.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	return((bufferlessTriangles == storedTriangles) && (bufferlessStats.vertexBytes == 0));
+}
+
+/***********************************************************
+ *  RunStaticMergeBenchmark()
+ *
+ *  Capture the parts of a lamp like the scene's, baked
+ *  into merged meshes for a grid of copies, and report the
+ *  time the baking takes.  Then draw the grid part by part
+ *  and from the merged meshes and report the draws and time
+ *  of each.  Both must make the same number of triangles.
+ ***********************************************************/
+bool BenchmarkRunner::RunStaticMergeBenchmark()
+{
+	const int DRAWS = 20;
+	const int OBJECTS = 64;
+
+	// the shapes of g_MeshShapeNames the lamp is made of, and
+	// where each part is
+	struct LAMP_PART
+	{
+		int shape;
+		glm::mat4 model;
+	};
+	const LAMP_PART PARTS[] = {
+		{ 6, glm::scale(glm::vec3(4.0f, 1.0f, 4.0f)) },
+		{ 2, glm::scale(glm::vec3(0.33f, 8.0f, 0.33f)) },
+		{ 2, glm::translate(glm::vec3(0.0f, 8.0f, 0.0f)) * glm::scale(glm::vec3(0.5f, 0.66f, 0.5f)) },
+		{ 10, glm::translate(glm::vec3(1.05f, 8.5f, 1.0f)) * glm::rotate(glm::radians(135.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(glm::vec3(1.5f)) },
+		{ 2, glm::translate(glm::vec3(2.15f, 8.0f, 2.05f)) * glm::scale(glm::vec3(0.5f, 0.66f, 0.5f)) },
+		{ 6, glm::translate(glm::vec3(2.15f, 7.0f, 2.05f)) * glm::scale(glm::vec3(3.0f)) },
+		{ 0, glm::translate(glm::vec3(2.15f, 5.5f, 2.05f)) * glm::scale(glm::vec3(3.0f, 0.1f, 3.0f)) }
+	};
+	const int PART_COUNT = (int)(sizeof(PARTS) / sizeof(PARTS[0]));
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 1000.0f));
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	ShapeMeshes meshes;
+	meshes.LoadBoxMesh();
+	meshes.LoadCylinderMesh();
+	meshes.LoadPyramid4Mesh();
+	meshes.LoadTorusMesh(.1);
+	ShapeMeshes::MESH_STATS shapeStats = meshes.GetMeshStats();
+
+	// the ranges each part draws
+	std::vector<std::vector<ShapeMeshes::CAPTURED_RANGE>> partRanges(PART_COUNT);
+	meshes.BeginMeshCapture();
+	for (int part = 0; part < PART_COUNT; part++)
+	{
+		DrawMeshShape(meshes, PARTS[part].shape);
+		meshes.TakeCapturedRanges(partRanges[part]);
+	}
+	bool bCaptured = meshes.EndMeshCapture();
+
+	std::vector<glm::mat4> placements;
+	for (int i = 0; i < OBJECTS; i++)
+	{
+		placements.push_back(glm::translate(glm::vec3((float)(i % 8) * 8.0f - 28.0f, (float)(i / 8) * 8.0f - 40.0f, -120.0f)));
+	}
+
+	// bake every copy, as a rebuild after an edit does
+	std::vector<ShapeMeshes::MeshHandle> merged(OBJECTS);
+	std::vector<ShapeMeshes::MERGE_PART> mergeParts(PART_COUNT);
+	double mergeTime = 1.0e30;
+	for (int run = 0; run < BENCHMARK_RUNS; run++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int i = 0; i < OBJECTS; i++)
+		{
+			for (int part = 0; part < PART_COUNT; part++)
+			{
+				mergeParts[part].ranges = partRanges[part].data();
+				mergeParts[part].rangeCount = (int)partRanges[part].size();
+				mergeParts[part].model = placements[i] * PARTS[part].model;
+			}
+			glm::vec4 bounds;
+			merged[i] = meshes.MergeMeshParts(merged[i], mergeParts.data(), PART_COUNT, bounds);
+		}
+		mergeTime = std::min(mergeTime, ElapsedMilliseconds(start));
+	}
+	ShapeMeshes::MESH_STATS mergedStats = meshes.GetMeshStats();
+
+	int partDraws = 0;
+	for (int part = 0; part < PART_COUNT; part++)
+	{
+		partDraws += (int)partRanges[part].size();
+	}
+
+	auto drawParts = [&]() {
+		for (int i = 0; i < OBJECTS; i++)
+		{
+			for (int part = 0; part < PART_COUNT; part++)
+			{
+				m_pShaderManager->setMat4Value("model", placements[i] * PARTS[part].model);
+				DrawMeshShape(meshes, PARTS[part].shape);
+			}
+		}
+	};
+	auto drawMerged = [&]() {
+		m_pShaderManager->setMat4Value("model", glm::mat4(1.0f));
+		for (int i = 0; i < OBJECTS; i++)
+		{
+			meshes.DrawMergedMesh(merged[i]);
+		}
+	};
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+	auto countTriangles = [&](auto draw) {
+		GLuint triangles = 0;
+		glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+		draw();
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &triangles);
+		return((int)triangles);
+	};
+	auto timeFrames = [&](auto draw) {
+		double best = 1.0e30;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int frame = 0; frame < DRAWS; frame++)
+			{
+				draw();
+			}
+			glFinish();
+			best = std::min(best, ElapsedMilliseconds(start) / DRAWS);
+		}
+		return(best);
+	};
+
+	int partTriangles = countTriangles(drawParts);
+	int mergedTriangles = countTriangles(drawMerged);
+	double partTime = timeFrames(drawParts);
+	double mergedTime = timeFrames(drawMerged);
+	glDeleteQueries(1, &query);
+
+	std::cout << std::endl << "Static merge benchmark - " << OBJECTS << " lamps of " << PART_COUNT
+		<< " parts, best of " << DRAWS << " frames" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< "baking: " << (mergeTime / OBJECTS) << " ms per lamp, "
+		<< ((mergedStats.vertexBytes + mergedStats.indexBytes) - (shapeStats.vertexBytes + shapeStats.indexBytes)) / OBJECTS
+		<< " bytes per merged lamp" << std::endl
+		<< "part by part: " << (partDraws * OBJECTS) << " draws, " << partTriangles << " triangles, " << partTime << " ms" << std::endl
+		<< "merged:       " << OBJECTS << " draws, " << mergedTriangles << " triangles, " << mergedTime << " ms" << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	meshes.DestroyMeshes();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	return((bCaptured == true) && (mergedTriangles == partTriangles));
+}
+
+/***********************************************************
+ *  RunMeshGenerationBenchmark()
+ *
+ *  Generate every shape at several tessellations into new
+ *  vectors, as each mesh used to be, into one reused
+ *  linear arena, and into a mapped GPU buffer, and report
+ *  the time and heap allocations per mesh of each.  Then
+ *  reload the scene's shapes, after loading them twice to
+ *  size the scratch memory, and report the allocations per
+ *  mesh with each vertex format and with the mesh
+ *  optimizer.  The arena, mapped and unoptimized loads must
+ *  make no allocations - they are only counted in a build
+ *  with BENCHMARK_COUNT_ALLOCATIONS defined.
+ ***********************************************************/
+bool BenchmarkRunner::RunMeshGenerationBenchmark()
+{
+	const int REPEATS = 20;
+	const int MESHES = GENERATED_SHAPE_COUNT * REPEATS;
+
+	// the bytes of the largest shape, and of all of them, so the
+	// arenas are sized before anything is generated
+	size_t largestBytes = 0;
+	size_t totalBytes = 0;
+	for (int i = 0; i < GENERATED_SHAPE_COUNT; i++)
+	{
+		size_t bytes = ShapeGenerator::ShapeBytes(GeneratedShapeSize(g_GeneratedShapes[i]));
+		largestBytes = std::max(largestBytes, bytes);
+		totalBytes += bytes;
+	}
+
+	struct GENERATION_RESULT
+	{
+		double milliseconds;
+		long long allocations;
+	};
+	// time generating every shape REPEATS times, and count the
+	// allocations made doing it - generate() returns false if a
+	// shape did not fit
+	auto timeGeneration = [&](auto generate) {
+		GENERATION_RESULT result = { 1.0e30, 0 };
+		bool bGenerated = true;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			long long allocations = HeapAllocations();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int repeat = 0; repeat < REPEATS; repeat++)
+			{
+				bGenerated = generate() && bGenerated;
+			}
+			result.milliseconds = std::min(result.milliseconds, ElapsedMilliseconds(start));
+			result.allocations = std::max(result.allocations, HeapAllocations() - allocations);
+		}
+		if (bGenerated == false)
+		{
+			result.allocations = -1;
+		}
+		return(result);
+	};
+
+	GENERATION_RESULT vectorResult = timeGeneration([&]() {
+		for (int i = 0; i < GENERATED_SHAPE_COUNT; i++)
+		{
+			ShapeGenerator::SHAPE_SIZE size = GeneratedShapeSize(g_GeneratedShapes[i]);
+			std::vector<GLfloat> vertices(size.vertexCount * ShapeGenerator::FLOATS_PER_VERTEX);
+			std::vector<GLuint> indices(size.indexCount);
+			GenerateShape(g_GeneratedShapes[i], vertices.data(), indices.data());
+		}
+		return(true);
+	});
+
+	// one block for every mesh, each generated over the last
+	std::vector<unsigned char> block(largestBytes);
+	LinearArena arena(block.data(), block.size());
+	GENERATION_RESULT arenaResult = timeGeneration([&]() {
+		for (int i = 0; i < GENERATED_SHAPE_COUNT; i++)
+		{
+			GLfloat* vertices = NULL;
+			GLuint* indices = NULL;
+			arena.Reset();
+			if (ShapeGenerator::AllocateShape(arena, GeneratedShapeSize(g_GeneratedShapes[i]), vertices, indices) == false)
+			{
+				return(false);
+			}
+			GenerateShape(g_GeneratedShapes[i], vertices, indices);
+		}
+		return(true);
+	});
+
+	// every mesh side by side in a mapped buffer, generated over
+	// again each pass - the driver's mapping is timed on its own,
+	// outside the counted passes
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, totalBytes, NULL, GL_STREAM_DRAW);
+	std::chrono::steady_clock::time_point mapStart = std::chrono::steady_clock::now();
+	void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	double mapTime = ElapsedMilliseconds(mapStart);
+	LinearArena bufferArena(mapped, totalBytes);
+	GENERATION_RESULT mappedResult = timeGeneration([&]() {
+		bufferArena.Reset();
+		for (int i = 0; i < GENERATED_SHAPE_COUNT; i++)
+		{
+			GLfloat* vertices = NULL;
+			GLuint* indices = NULL;
+			if (ShapeGenerator::AllocateShape(bufferArena, GeneratedShapeSize(g_GeneratedShapes[i]), vertices, indices) == false)
+			{
+				return(false);
+			}
+			GenerateShape(g_GeneratedShapes[i], vertices, indices);
+		}
+		return(true);
+	});
+	if (mapped != NULL)
+	{
+		mapStart = std::chrono::steady_clock::now();
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		mapTime += ElapsedMilliseconds(mapStart);
+	}
+	glDeleteBuffers(1, &buffer);
+
+	// reload every shape of the scene after loading them twice,
+	// which sizes the scratch memory and the free lists of the
+	// mesh arenas, counting the allocations per mesh
+	struct RELOAD_SETUP
+	{
+		const char* name;
+		ShapeMeshes::VertexFormat format;
+		bool bOptimize;
+	};
+	const RELOAD_SETUP RELOADS[] = {
+		{ "float vertices", ShapeMeshes::floatVertices, false },
+		{ "packed vertices", ShapeMeshes::compactVertices, false },
+		{ "optimized", ShapeMeshes::floatVertices, true }
+	};
+	const int RELOAD_COUNT = (int)(sizeof(RELOADS) / sizeof(RELOADS[0]));
+	long long reloadAllocations[RELOAD_COUNT] = {};
+	int reloadedMeshes = 0;
+	size_t scratchBytes = 0;
+	int scratchGrowths = 0;
+	for (int setup = 0; setup < RELOAD_COUNT; setup++)
+	{
+		ShapeMeshes meshes;
+		meshes.SetVertexFormat(RELOADS[setup].format);
+		meshes.SetMeshOptimization(RELOADS[setup].bOptimize);
+		for (int warmUp = 0; warmUp < 2; warmUp++)
+		{
+			for (int shape = 0; shape < MESH_SHAPE_COUNT - 1; shape++)
+			{
+				LoadMeshShape(meshes, shape);
+			}
+		}
+		int growths = meshes.GetScratchGrowths();
+
+		long long allocations = HeapAllocations();
+		for (int shape = 0; shape < MESH_SHAPE_COUNT - 1; shape++)
+		{
+			LoadMeshShape(meshes, shape);
+		}
+		reloadAllocations[setup] = HeapAllocations() - allocations;
+		reloadedMeshes = meshes.GetMeshStats().meshes;
+		scratchBytes = std::max(scratchBytes, meshes.GetScratchBytes());
+		scratchGrowths = std::max(scratchGrowths, meshes.GetScratchGrowths() - growths);
+		meshes.DestroyMeshes();
+	}
+
+	// the allocations per mesh, as printed
+	auto perMesh = [](long long allocations, int meshes) {
+		std::ostringstream text;
+		if (g_bCountingAllocations == false)
+		{
+			text << "allocations not counted";
+			return(text.str());
+		}
+		text << std::fixed << std::setprecision(3)
+			<< ((allocations < 0) ? -1.0 : ((double)allocations / (double)meshes)) << " allocations per mesh";
+		return(text.str());
+	};
+
+	std::cout << std::endl << "Mesh generation benchmark - " << GENERATED_SHAPE_COUNT << " shapes and tessellations, "
+		<< REPEATS << " times, " << (largestBytes / 1024) << " KB largest, " << (totalBytes / 1024) << " KB in all" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< "new vectors:   " << vectorResult.milliseconds << " ms, " << perMesh(vectorResult.allocations, MESHES) << std::endl
+		<< "linear arena:  " << arenaResult.milliseconds << " ms, " << perMesh(arenaResult.allocations, MESHES) << std::endl
+		<< "mapped buffer: " << mappedResult.milliseconds << " ms (map and unmap " << mapTime << " ms), "
+		<< perMesh(mappedResult.allocations, MESHES) << std::endl;
+	std::cout << "reloading " << reloadedMeshes << " meshes with " << (scratchBytes / 1024) << " KB of scratch memory, grown "
+		<< scratchGrowths << " times after warming up:" << std::endl;
+	for (int setup = 0; setup < RELOAD_COUNT; setup++)
+	{
+		std::cout << "  " << std::left << std::setw(16) << RELOADS[setup].name << std::right
+			<< perMesh(reloadAllocations[setup], reloadedMeshes) << std::endl;
+	}
+	if (g_bCountingAllocations == false)
+	{
+		std::cout << "(define BENCHMARK_COUNT_ALLOCATIONS in the build to count the heap allocations)" << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+
+	return((arenaResult.allocations == 0) &&
+		(mappedResult.allocations == 0) &&
+		(reloadAllocations[0] == 0) &&
+		(reloadAllocations[1] == 0));
+}
+
+/***********************************************************
+ *  RunDepthPrePassBenchmark()
+ *
+ *  Render the scene from the starting camera, once its
+ *  textures are loaded, with the depth pre-pass off and on,
+ *  and report the fragment shader runs of a frame, counted
+ *  with a pipeline statistics query, and the frame time of
+ *  each.  The pre-pass must make the same image.  Drivers
+ *  that count the fragments they run the depth test for
+ *  inside the fragment shader, as software rasterizers do,
+ *  count each pass in full, so the counts are only
+ *  reported.
+ ***********************************************************/
+bool BenchmarkRunner::RunDepthPrePassBenchmark()
+{
+	const int DRAWS = 20;
+	const int WARM_UP_FRAMES = 10;
+
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	// the starting camera of the view manager
+	glm::vec3 position(0.0f, 24.0f, 12.0f);
+	glm::mat4 view = glm::lookAt(position, position + glm::normalize(glm::vec3(0.0f, -0.5f, -2.0f)), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(80.0f), (float)viewport[2] / (float)viewport[3], 0.1f, 100.0f);
+
+	SceneManager scene(m_pShaderManager);
+	if (scene.EnableDepthPrePass() == false)
+	{
+		return(false);
+	}
+	scene.DisableDepthPrePass();
+	scene.PrepareScene();
+
+	auto renderFrame = [&]() {
+		glEnable(GL_DEPTH_TEST);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		m_pShaderManager->use();
+		m_pShaderManager->setMat4Value("view", view);
+		m_pShaderManager->setMat4Value("projection", projection);
+		m_pShaderManager->setVec3Value("viewPosition", position);
+		scene.SetSceneView(view, projection, viewport[3]);
+		scene.RenderScene();
+	};
+
+	// the textures start loading when first drawn, and their mip
+	// levels stream in over the frames after
+	do
+	{
+		renderFrame();
+		glFinish();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	} while (scene.IsLoadingTextures() == true);
+	for (int frame = 0; frame < WARM_UP_FRAMES; frame++)
+	{
+		renderFrame();
+	}
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+	GLuint fragments[2] = { 0, 0 };
+	double frameTimes[2] = { 1.0e30, 1.0e30 };
+	std::vector<unsigned char> images[2];
+	for (int prePass = 0; prePass < 2; prePass++)
+	{
+		if (prePass == 1)
+		{
+			scene.EnableDepthPrePass();
+		}
+		renderFrame();
+
+		glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, query);
+		renderFrame();
+		glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &fragments[prePass]);
+
+		images[prePass].resize((size_t)viewport[2] * viewport[3] * 4);
+		glReadPixels(viewport[0], viewport[1], viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, images[prePass].data());
+
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			glFinish();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int frame = 0; frame < DRAWS; frame++)
+			{
+				renderFrame();
+			}
+			glFinish();
+			frameTimes[prePass] = std::min(frameTimes[prePass], ElapsedMilliseconds(start) / DRAWS);
+		}
+	}
+	glDeleteQueries(1, &query);
+	scene.DisableDepthPrePass();
+
+	int differentPixels = 0;
+	for (size_t i = 0; i < images[0].size(); i += 4)
+	{
+		if (memcmp(&images[0][i], &images[1][i], 3) != 0)
+		{
+			differentPixels++;
+		}
+	}
+	double pixels = (double)viewport[2] * viewport[3];
+
+	std::cout << std::endl << "Depth pre-pass benchmark - the scene at " << viewport[2] << "x" << viewport[3]
+		<< ", best of " << DRAWS << " frames" << std::endl;
+	std::cout << std::left << std::setw(10) << "pre-pass" << std::right << std::setw(12) << "fragments"
+		<< std::setw(14) << "per pixel" << std::setw(12) << "ms/frame" << std::endl;
+	std::cout << std::fixed;
+	for (int prePass = 0; prePass < 2; prePass++)
+	{
+		std::cout << std::left << std::setw(10) << ((prePass == 1) ? "on" : "off") << std::right
+			<< std::setw(12) << fragments[prePass] << std::setprecision(2) << std::setw(14) << (fragments[prePass] / pixels)
+			<< std::setprecision(3) << std::setw(12) << frameTimes[prePass] << std::endl;
+	}
+	std::cout << "the images differ in " << differentPixels << " pixels" << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+
+	return(differentPixels == 0);
+}
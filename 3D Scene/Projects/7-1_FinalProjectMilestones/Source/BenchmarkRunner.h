@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkrunner.h
+// ============
+// measure the performance of the rendering subsystems on the shipped assets
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  BenchmarkRunner
+ *
+ *  This class runs the benchmarks selected on the command
+ *  line with "-benchmark <name>", in place of the scene.
+ *  Results are written to the console.
+ ***********************************************************/
+class BenchmarkRunner
+{
+public:
+	// constructor
+	BenchmarkRunner(ShaderManager* pShaderManager);
+
+	// run the named benchmark, or every benchmark for "all"
+	bool Run(const std::string& name);
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+
+	// texture images shipped with the project
+	std::vector<std::string> m_textureFiles;
+
+	// CPU mip generation against glGenerateMipmap
+	bool RunMipBenchmark();
+	// SIMD JPEG decoding against stb_image
+	bool RunJpegBenchmark();
+	// JPEG decoding at reduced sizes for the low-spec profile
+	bool RunJpegScaleBenchmark();
+	// JPEG color conversion on the GPU against the CPU
+	bool RunYCbCrBenchmark();
+	// procedural material patterns against sampled textures
+	bool RunProceduralBenchmark();
+	// virtual texture page streaming against resident textures
+	bool RunVirtualTextureBenchmark();
+	// stored geometry and vertex shader work of each shape
+	bool RunMeshBenchmark();
+	// transform cache, fetch and overdraw metrics of each shape as
+	// generated and as reordered by the mesh optimizer
+	bool RunMeshOptimizerBenchmark();
+	// size, packing error and vertex rate of each mesh vertex format
+	bool RunVertexFormatBenchmark();
+	// draw overhead of switching meshes in the shared mesh arena
+	bool RunMeshArenaBenchmark();
+	// triangles and vertex time saved by the round shapes' detail
+	// levels at decreasing sizes on screen
+	bool RunMeshLodBenchmark();
+	// triangles and vertex time saved by culling the clusters of
+	// dense round shapes against the view
+	bool RunMeshletBenchmark();
+	// loading the round shapes from the mapped mesh cache against
+	// generating them
+	bool RunMeshCacheBenchmark();
+	// SIMD and threaded normal and tangent generation against the
+	// scalar reference
+	bool RunNormalBenchmark();
+	// triangles, stored bytes and draw time of the round shapes
+	// refined on the GPU against their detail levels
+	bool RunTessellationBenchmark();
+	// stored bytes and draw time of the shapes made in the vertex
+	// shader, mixed in one draw, against their stored meshes
+	bool RunBufferlessBenchmark();
+	// baking time, draws and draw time of compound objects merged
+	// into one mesh against drawing them part by part
+	bool RunStaticMergeBenchmark();
+	// time and heap allocations of generating meshes into new
+	// vectors, a reused linear arena and a mapped GPU buffer, and
+	// of reloading the scene's shapes
+	bool RunMeshGenerationBenchmark();
+	// fragment shader runs and frame time of the scene with the
+	// depth pre-pass off and on
+	bool RunDepthPrePassBenchmark();
+};
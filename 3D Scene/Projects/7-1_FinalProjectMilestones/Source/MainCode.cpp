@@ -1,5 +1,6 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,12 +14,23 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "BenchmarkRunner.h"
 
 // Namespace for declaring global variables
 namespace
 {
 	// Macro for window title
 	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+	// largest texture size of the "-low-spec" load profile
+	const int LOW_SPEC_TEXTURE_SIZE = 512;
+	// largest on-screen error, in pixels, of the round shapes drawn
+	// at a lower detail level with "-mesh-lod"
+	const float MESH_LOD_ERROR_PIXELS = 1.0f;
+	// the file the round shapes are kept in with "-mesh-cache"
+	const char* const MESH_CACHE_FILE = "../../Utilities/shapes.meshcache";
+	// pixels covered by each edge the GPU splits the round shapes
+	// into with "-tessellation"
+	const float TESSELLATION_EDGE_PIXELS = 8.0f;
 
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
@@ -72,8 +84,114 @@ int main(int argc, char* argv[])
 		"../../Utilities/shaders/fragmentShader.glsl");
 	g_ShaderManager->use();
 
+	// run a benchmark in place of the scene when launched
+	// with "-benchmark <name>"
+	if ((argc > 2) && (strcmp(argv[1], "-benchmark") == 0))
+	{
+		BenchmarkRunner benchmarks(g_ShaderManager);
+		bool bResult = benchmarks.Run(argv[2]);
+
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+		exit(bResult ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
 	// try to create a new scene manager object and prepare the 3D scene
 	g_SceneManager = new SceneManager(g_ShaderManager);
+	// apply the options the scene was launched with
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-gpu-ycbcr") == 0)
+		{
+			// upsample and convert the JPEG textures on the GPU
+			if (g_SceneManager->EnableGpuColorConversion() == false)
+			{
+				std::cout << "GPU color conversion is not available, converting the textures on the CPU" << std::endl;
+			}
+		}
+		else if (strcmp(argv[i], "-low-spec") == 0)
+		{
+			// load the textures at reduced sizes
+			g_SceneManager->SetTextureSizeLimit(LOW_SPEC_TEXTURE_SIZE);
+		}
+		else if (strcmp(argv[i], "-procedural") == 0)
+		{
+			// draw the wood, floor and metal materials procedurally
+			g_SceneManager->SetProceduralPreset(SceneManager::PROCEDURAL_DETAILED);
+		}
+		else if (strcmp(argv[i], "-procedural-fast") == 0)
+		{
+			// the same with fewer noise octaves
+			g_SceneManager->SetProceduralPreset(SceneManager::PROCEDURAL_FAST);
+		}
+		else if (strcmp(argv[i], "-virtual-texturing") == 0)
+		{
+			// stream the large textures as virtual texture pages
+			if (g_SceneManager->EnableVirtualTexturing() == false)
+			{
+				std::cout << "Virtual texturing is not available, loading the textures whole" << std::endl;
+			}
+		}
+		else if (strcmp(argv[i], "-quantized-meshes") == 0)
+		{
+			// pack the mesh vertices into 16 bit values
+			g_SceneManager->SetMeshVertexFormat(ShapeMeshes::quantizedVertices);
+		}
+		else if (strcmp(argv[i], "-compact-meshes") == 0)
+		{
+			// the same with 8 bit normals
+			g_SceneManager->SetMeshVertexFormat(ShapeMeshes::compactVertices);
+		}
+		else if (strcmp(argv[i], "-mesh-lod") == 0)
+		{
+			// draw small round shapes with fewer triangles
+			g_SceneManager->SetMeshErrorBudget(MESH_LOD_ERROR_PIXELS);
+		}
+		else if (strcmp(argv[i], "-cluster-culling") == 0)
+		{
+			// skip the clusters of round shapes that cannot be seen
+			g_SceneManager->SetMeshClusterCulling(true);
+		}
+		else if (strcmp(argv[i], "-mesh-cache") == 0)
+		{
+			// load the round shapes from a mapped cache file
+			if (g_SceneManager->EnableMeshCache(MESH_CACHE_FILE) == false)
+			{
+				std::cout << "Mesh cache " << MESH_CACHE_FILE << " is missing or out of date, making it again" << std::endl;
+			}
+		}
+		else if (strcmp(argv[i], "-tessellation") == 0)
+		{
+			// refine the round shapes on the GPU
+			if (g_SceneManager->EnableTessellation(TESSELLATION_EDGE_PIXELS) == false)
+			{
+				std::cout << "Tessellation shaders did not build, drawing the stored meshes" << std::endl;
+			}
+		}
+		else if (strcmp(argv[i], "-bufferless") == 0)
+		{
+			// make the shapes in the vertex shader with no vertex data
+			if (g_SceneManager->EnableBufferless() == false)
+			{
+				std::cout << "Bufferless shaders did not build, drawing the stored meshes" << std::endl;
+			}
+		}
+		else if (strcmp(argv[i], "-merge-static") == 0)
+		{
+			// draw the laptop, lamp and books as merged meshes
+			g_SceneManager->EnableStaticMerging();
+		}
+		else if (strcmp(argv[i], "-depth-prepass") == 0)
+		{
+			// lay down the depth of the scene before shading it
+			if (g_SceneManager->EnableDepthPrePass() == false)
+			{
+				std::cout << "Depth pre-pass shaders did not build, shading without a pre-pass" << std::endl;
+			}
+		}
+	}
 	g_SceneManager->PrepareScene();
 
 	// loop will keep running until the application is closed 
@@ -89,6 +207,10 @@ int main(int argc, char* argv[])
 
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetSceneView(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetViewportHeight());
 
 		// refresh the 3D scene
 		g_SceneManager->RenderScene();
@@ -16,6 +16,9 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <cfloat>
+#include <chrono>
+
 // declaration of global variables
 namespace
 {
@@ -24,6 +27,21 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UseAtlasName = "bUseAtlas";
+	const char* g_AtlasScaleName = "atlasScale";
+	const char* g_AtlasOffsetName = "atlasOffset";
+	const char* g_UseVirtualTextureName = "bUseVirtualTexture";
+
+	// texture units of the virtual texture page table and page cache,
+	// above the units the loaded textures and atlas pages take - the
+	// texture slots use units 0 to 15
+	const int g_PageTableUnit = 16;
+	const int g_PageCacheUnit = 17;
+
+	// how far the sides drawn over a box, like the laptop keyboard
+	// and screen and the book covers, stand out from its faces, so
+	// they are in front of them whatever order the two are drawn in
+	const float g_BoxSideLift = 0.01f;
 }
 
 /***********************************************************
@@ -35,6 +53,30 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
 	m_basicMeshes = new ShapeMeshes();
+	m_textureAtlas = new TextureAtlas();
+	m_textureResidency = new TextureResidency();
+	m_mipGenerator = new MipGenerator(MipGenerator::MIP_FILTER_KAISER, true);
+	m_jpegDecoder = new JpegDecoder();
+	m_textureLoader = new TextureLoader(m_mipGenerator, m_jpegDecoder);
+	m_ycbcrConverter = new YCbCrConverter();
+	m_bGpuColorConversion = false;
+	m_virtualTextures = new VirtualTextureSystem(m_mipGenerator, m_jpegDecoder);
+	m_bVirtualTexturing = false;
+	m_textureSizeLimit = 0;
+	m_proceduralPreset = PROCEDURAL_OFF;
+	m_loadedTextures = 0;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewportHeight = 0;
+	m_tessellationEdgePixels = 0.0f;
+	m_modelMatrix = glm::mat4(1.0f);
+	m_currentColor = glm::vec4(1.0f);
+	m_currentUVScale = glm::vec2(1.0f, 1.0f);
+	m_bStaticMerging = false;
+	m_pCapturingObject = NULL;
+	m_bDepthPrePass = false;
+	m_depthPass = PASS_SHADING_ONLY;
+	m_bCountingPass = true;
 }
 
 /***********************************************************
@@ -47,17 +89,37 @@ SceneManager::~SceneManager()
 	m_pShaderManager = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	delete m_textureAtlas;
+	m_textureAtlas = NULL;
+	DestroyGLTextures();
+	delete m_textureLoader;
+	m_textureLoader = NULL;
+	delete m_ycbcrConverter;
+	m_ycbcrConverter = NULL;
+	delete m_virtualTextures;
+	m_virtualTextures = NULL;
+	delete m_textureResidency;
+	m_textureResidency = NULL;
+	delete m_mipGenerator;
+	m_mipGenerator = NULL;
+	delete m_jpegDecoder;
+	m_jpegDecoder = NULL;
 }
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for registering textures from image
+ *  files.  Only the image header is read here - the texture
+ *  takes the next available texture slot right away, drawing
+ *  with a tiny placeholder, and the image is decoded in the
+ *  background the first time a visible draw uses it.  Small
+ *  images are decoded now and queued for the texture atlas
+ *  instead of getting their own texture slot.  Images larger
+ *  than maxSize, or than the scene's texture size limit, are
+ *  reduced while they are decoded.
  ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+bool SceneManager::CreateGLTexture(const char* filename, const std::string& tag, int maxSize)
 {
 	int width = 0;
 	int height = 0;
@@ -67,60 +129,587 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 	// indicate to always flip images vertically when loaded
 	stbi_set_flip_vertically_on_load(true);
 
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
+	// try to parse the image header from the specified image file
+	if (stbi_info(filename, &width, &height, &colorChannels) == 0)
+	{
+		std::cout << "Could not load image:" << filename << std::endl;
+		return false;
+	}
 
-	// if the image was successfully read from the image file
-	if (image)
+	// the tighter of the texture's own limit and the scene's
+	if ((m_textureSizeLimit > 0) && ((maxSize <= 0) || (m_textureSizeLimit < maxSize)))
 	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+		maxSize = m_textureSizeLimit;
+	}
 
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+	// small images share an atlas page with other small images,
+	// so they are decoded now and packed together
+	if (m_textureAtlas->CanPackImage(width, height, colorChannels) == true)
+	{
+		// baseline JPEG files use the SIMD decoder, anything it
+		// refuses is decoded by stb_image
+		JpegDecoder::JPEG_IMAGE jpegImage;
+		unsigned char* stbImage = NULL;
+		const unsigned char* image = NULL;
+		if (m_jpegDecoder->DecodeFile(filename, jpegImage, maxSize) == true)
+		{
+			width = jpegImage.width;
+			height = jpegImage.height;
+			colorChannels = jpegImage.colorChannels;
+			image = jpegImage.pixels.data();
+		}
 		else
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+			stbImage = stbi_load(
+				filename,
+				&width,
+				&height,
+				&colorChannels,
+				0);
+			image = stbImage;
+		}
+		if (image == NULL)
+		{
+			std::cout << "Could not load image:" << filename << std::endl;
 			return false;
 		}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+		bool bQueued = m_textureAtlas->AddImage(image, width, height, colorChannels, tag);
+		if (stbImage != NULL)
+		{
+			stbi_image_free(stbImage);
+		}
+		return(bQueued);
+	}
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+	// only RGB and RGBA images are supported - RGBA supports transparency
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+		return false;
+	}
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	// virtual textures take no texture slot, their pages are read
+	// from the tiled file as the feedback pass asks for them - the
+	// size limit does not apply, since only visible pages are loaded
+	if (m_bVirtualTexturing == true)
+	{
+		int virtualTexture = m_virtualTextures->AddTexture(filename, width, height);
+		if (virtualTexture >= 0)
+		{
+			TEXTURE_ENTRY entry;
+			entry.tag = tag;
+			entry.filename = filename;
+			entry.slot = -1;
+			entry.bAtlasRegion = false;
+			entry.uvScale = glm::vec2(1.0f, 1.0f);
+			entry.uvOffset = glm::vec2(0.0f, 0.0f);
+			entry.state = TEXTURE_RESIDENT;
+			entry.residency = -1;
+			entry.maxSize = 0;
+			entry.virtualTexture = virtualTexture;
+			m_textures.Insert(entry);
+			return true;
+		}
+	}
+
+	// every texture slot is already taken
+	if (m_loadedTextures >= MAX_TEXTURE_SLOTS)
+	{
+		std::cout << "No texture slot left for image:" << filename << std::endl;
+		return false;
+	}
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// draw with a neutral grey texel until the image is loaded
+	const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+
+	// register the texture and associate it with the special tag string
+	m_textureIDs[m_loadedTextures].ID = textureID;
+	m_textureIDs[m_loadedTextures].tag = tag;
+
+	TEXTURE_ENTRY entry;
+	entry.tag = tag;
+	entry.filename = filename;
+	entry.slot = m_loadedTextures;
+	entry.bAtlasRegion = false;
+	entry.uvScale = glm::vec2(1.0f, 1.0f);
+	entry.uvOffset = glm::vec2(0.0f, 0.0f);
+	entry.state = TEXTURE_UNLOADED;
+	entry.residency = -1;
+	entry.maxSize = maxSize;
+	entry.virtualTexture = -1;
+	m_textures.Insert(entry);
+
+	m_loadedTextures++;
+
+	return true;
+}
+
+/***********************************************************
+ *  UploadLoadedTextures()
+ *
+ *  This method is used for taking the images the background
+ *  loader has finished and handing their mip chains to the
+ *  residency manager, which replaces the placeholders with
+ *  their coarse mip levels.  JPEG color planes are instead
+ *  converted on the GPU, which also builds the mip chain.
+ ***********************************************************/
+void SceneManager::UploadLoadedTextures()
+{
+	TextureLoader::LOADED_TEXTURE loaded;
+	while (m_textureLoader->PollLoaded(loaded) == true)
+	{
+		TEXTURE_ENTRY* entry = NULL;
+		for (int i = 0; (i < m_textures.SlotCount()) && (entry == NULL); i++)
+		{
+			TEXTURE_ENTRY* candidate = m_textures.GetAt(i);
+			if ((candidate != NULL) && (candidate->bAtlasRegion == false) && (candidate->slot == loaded.id))
+			{
+				entry = candidate;
+			}
+		}
+		if (entry == NULL)
+		{
+			continue;
+		}
+
+		if ((loaded.bLoaded == false) ||
+			((loaded.bColorPlanes == false) && (loaded.colorChannels != 3) && (loaded.colorChannels != 4)))
+		{
+			std::cout << "Could not load image:" << loaded.filename << std::endl;
+			entry->state = TEXTURE_FAILED;
+			continue;
+		}
+
+		std::cout << "Successfully loaded image:" << loaded.filename << ", width:" << loaded.width << ", height:" << loaded.height << ", channels:" << loaded.colorChannels << std::endl;
+
+		// the planes are smaller than the RGB image, and the
+		// whole chain is resident since the finer levels are
+		// never on the CPU to stream from
+		if (loaded.bColorPlanes == true)
+		{
+			GLuint textureID = m_textureIDs[entry->slot].ID;
+			if (m_ycbcrConverter->Convert(loaded.planes, textureID, m_jpegDecoder->IsFlippedVertically()) == false)
+			{
+				entry->state = TEXTURE_FAILED;
+				continue;
+			}
+			GLint previousTexture = 0;
+			glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+			glBindTexture(GL_TEXTURE_2D, textureID);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glBindTexture(GL_TEXTURE_2D, previousTexture);
+			entry->residency = -1;
+			entry->state = TEXTURE_RESIDENT;
+			continue;
+		}
+
+		// only the coarse mip levels are uploaded until a
+		// draw needs the finer ones
+		entry->residency = m_textureResidency->RegisterTexture(m_textureIDs[entry->slot].ID, loaded.colorChannels, loaded.levels);
+		entry->state = (entry->residency >= 0) ? TEXTURE_RESIDENT : TEXTURE_FAILED;
+	}
+}
+
+/***********************************************************
+ *  IsLoadingTextures()
+ *
+ *  This method is used for checking whether any texture
+ *  used by the scene is still being loaded.
+ ***********************************************************/
+bool SceneManager::IsLoadingTextures() const
+{
+	return((m_textureLoader->IsBusy() == true) ||
+		((m_bVirtualTexturing == true) && (m_virtualTextures->IsBusy() == true)));
+}
+
+/***********************************************************
+ *  EnableGpuColorConversion()
+ *
+ *  This method is used for loading the baseline JPEG
+ *  textures as Y, Cb and Cr planes that a fragment pass
+ *  upsamples and converts to RGB, so the CPU skips those
+ *  steps and less data is uploaded.  Textures packed into
+ *  atlas pages and other file formats are not affected.
+ ***********************************************************/
+bool SceneManager::EnableGpuColorConversion()
+{
+	m_bGpuColorConversion = m_ycbcrConverter->Initialize(
+		"../../Utilities/shaders/ycbcrVertexShader.glsl",
+		"../../Utilities/shaders/ycbcrFragmentShader.glsl");
+	return(m_bGpuColorConversion);
+}
+
+/***********************************************************
+ *  EnableVirtualTexturing()
+ *
+ *  This method is used for drawing the textures that would
+ *  get their own texture slot as virtual textures.  Their
+ *  pages share one fixed size cache, filled with the pages a
+ *  low resolution feedback pass finds on screen, so the
+ *  textures can add up to far more than video memory holds.
+ *  The page table and cache take the last two texture units.
+ ***********************************************************/
+bool SceneManager::EnableVirtualTexturing()
+{
+	m_bVirtualTexturing = m_virtualTextures->Initialize(g_PageTableUnit, g_PageCacheUnit);
+	return(m_bVirtualTexturing);
+}
+
+/***********************************************************
+ *  SetTextureSizeLimit()
+ *
+ *  This method is used for capping the size every texture
+ *  is loaded at.  Baseline JPEG files are decoded at 1/2,
+ *  1/4 or 1/8 of their size to fit, which is faster and
+ *  needs proportionally less memory, and other files drop
+ *  their mip levels over the limit.  Zero loads the full
+ *  size images.
+ ***********************************************************/
+void SceneManager::SetTextureSizeLimit(int maxSize)
+{
+	m_textureSizeLimit = (maxSize > 0) ? maxSize : 0;
+}
+
+/***********************************************************
+ *  SetProceduralPreset()
+ *
+ *  This method is used for drawing the patterns of the
+ *  materials in the fragment shader.  Wood and tile patterns
+ *  replace the textures of the objects drawn with them, so
+ *  those textures are never loaded, and brushed metal shades
+ *  the existing textures and colors.
+ ***********************************************************/
+void SceneManager::SetProceduralPreset(PROCEDURAL_PRESET preset)
+{
+	m_proceduralPreset = preset;
+}
+
+/***********************************************************
+ *  SetMeshVertexFormat()
+ *
+ *  This method is used for storing the vertices of the shape
+ *  meshes in 16 or 12 bytes instead of 32, for scenes whose
+ *  speed is limited by reading vertices.  The positions keep
+ *  16 bits relative to the size of each mesh.
+ ***********************************************************/
+void SceneManager::SetMeshVertexFormat(ShapeMeshes::VertexFormat format)
+{
+	m_basicMeshes->SetVertexFormat(format);
+}
 
-		return true;
+/***********************************************************
+ *  SetMeshErrorBudget()
+ *
+ *  This method is used for letting the round shapes be
+ *  drawn from their simplified detail levels when they are
+ *  small on screen.  Each draw uses the coarsest level whose
+ *  distance from the true shape, projected at the object's
+ *  size, is within the passed in number of pixels.
+ ***********************************************************/
+void SceneManager::SetMeshErrorBudget(float pixels)
+{
+	m_basicMeshes->SetLodErrorBudget(pixels);
+}
+
+/***********************************************************
+ *  SetMeshClusterCulling()
+ *
+ *  This method is used for drawing the round shapes one
+ *  cluster of triangles at a time, leaving out the clusters
+ *  outside the view and those on the far side of closed
+ *  shapes.
+ ***********************************************************/
+void SceneManager::SetMeshClusterCulling(bool bCull)
+{
+	m_basicMeshes->SetClusterCulling(bCull);
+}
+
+/***********************************************************
+ *  EnableMeshCache()
+ *
+ *  This method is used for loading the round shapes from a
+ *  cache file mapped into memory, made the first time the
+ *  scene is prepared with it.  Their vertices are uploaded
+ *  from the file as they are stored, so nothing is
+ *  generated, packed or reordered.  Returns false if the
+ *  file is missing or out of date and will be made again.
+ ***********************************************************/
+bool SceneManager::EnableMeshCache(const char* filename)
+{
+	return(m_basicMeshes->UseMeshCache(filename));
+}
+
+/***********************************************************
+ *  EnableTessellation()
+ *
+ *  This method is used for drawing the sphere, cylinders
+ *  and torus from a few dozen patches each instead of
+ *  stored triangles.  The tessellation shaders split each
+ *  patch edge by its length on screen and put the new
+ *  vertices on the true curved surface, so the outlines
+ *  stay smooth up close without storing dense meshes.
+ ***********************************************************/
+bool SceneManager::EnableTessellation(float edgePixels)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(false);
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	GLuint program = m_pShaderManager->LoadTessellationShaders(
+		"../../Utilities/shaders/tessellationVertexShader.glsl",
+		"../../Utilities/shaders/tessellationControlShader.glsl",
+		"../../Utilities/shaders/tessellationEvaluationShader.glsl",
+		"../../Utilities/shaders/fragmentShader.glsl");
+	if (program == 0)
+	{
+		return(false);
+	}
 
-	// Error loading the image
-	return false;
+	m_tessellationEdgePixels = edgePixels;
+	m_basicMeshes->SetTessellation(program, m_pShaderManager->m_programID);
+	return(true);
+}
+
+/***********************************************************
+ *  EnableBufferless()
+ *
+ *  This method is used for drawing the analytic shapes
+ *  with no vertex buffers.  Each draw carries only the
+ *  type and tessellation of its shape, and the vertex
+ *  shader works out every position, normal and texture
+ *  coordinate from the number of the vertex.
+ ***********************************************************/
+bool SceneManager::EnableBufferless()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(false);
+	}
+
+	GLuint program = m_pShaderManager->LoadBufferlessShaders(
+		"../../Utilities/shaders/bufferlessVertexShader.glsl",
+		"../../Utilities/shaders/fragmentShader.glsl");
+	if (program == 0)
+	{
+		return(false);
+	}
+
+	m_basicMeshes->SetBufferless(program, m_pShaderManager->m_programID);
+	return(true);
+}
+
+/***********************************************************
+ *  EnableStaticMerging()
+ *
+ *  This method is used for drawing the laptop, lamp and
+ *  books as merged meshes.  Their parts never move
+ *  relative to each other, so once the shapes are loaded
+ *  the parts sharing a look are baked into one mesh with
+ *  their transforms applied, and each object takes one
+ *  draw per look instead of one per part.
+ ***********************************************************/
+void SceneManager::EnableStaticMerging()
+{
+	m_bStaticMerging = true;
+}
+
+/***********************************************************
+ *  EnableDepthPrePass()
+ *
+ *  This method is used for drawing the scene twice a frame,
+ *  first with a program that only writes depth, and then
+ *  with the full lighting only where a fragment matches the
+ *  depth laid down.  The objects on the table are drawn
+ *  after the room and table behind them, so without it the
+ *  lighting runs for every surface drawn over each pixel.
+ ***********************************************************/
+bool SceneManager::EnableDepthPrePass()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(false);
+	}
+
+	if (m_pShaderManager->m_sharedProgramIDs[ShaderManager::depthProgram] == 0)
+	{
+		GLuint program = m_pShaderManager->LoadDepthShaders(
+			"../../Utilities/shaders/vertexShader.glsl",
+			"../../Utilities/shaders/depthFragmentShader.glsl");
+		if (program == 0)
+		{
+			return(false);
+		}
+	}
+
+	m_bDepthPrePass = true;
+	return(true);
+}
+
+/***********************************************************
+ *  DisableDepthPrePass()
+ *
+ *  This method is used for shading the scene in one pass
+ *  again, as the depth of each surface is tested.
+ ***********************************************************/
+void SceneManager::DisableDepthPrePass()
+{
+	m_bDepthPrePass = false;
+}
+
+/***********************************************************
+ *  GetCompoundPartCount()
+ *
+ *  This method is used for getting the number of parts
+ *  recorded for a compound object.
+ ***********************************************************/
+int SceneManager::GetCompoundPartCount(COMPOUND_OBJECT_ID object) const
+{
+	return((int)m_compoundObjects[object].parts.size());
+}
+
+/***********************************************************
+ *  GetCompoundPartModel()
+ *
+ *  This method is used for getting the transform a part of
+ *  a compound object is drawn with.
+ ***********************************************************/
+glm::mat4 SceneManager::GetCompoundPartModel(COMPOUND_OBJECT_ID object, int part) const
+{
+	const COMPOUND_OBJECT& compound = m_compoundObjects[object];
+	if ((part < 0) || (part >= (int)compound.parts.size()))
+	{
+		return(glm::mat4(1.0f));
+	}
+	return(compound.parts[part].model);
+}
+
+/***********************************************************
+ *  SetCompoundPartModel()
+ *
+ *  This method is used for moving a part of a compound
+ *  object.  The original parts are kept, so the object's
+ *  merged meshes are simply made again from them before
+ *  it is next drawn.
+ ***********************************************************/
+void SceneManager::SetCompoundPartModel(COMPOUND_OBJECT_ID object, int part, const glm::mat4& model)
+{
+	COMPOUND_OBJECT& compound = m_compoundObjects[object];
+	if ((part < 0) || (part >= (int)compound.parts.size()))
+	{
+		return;
+	}
+	compound.parts[part].model = model;
+	compound.bDirty = true;
+}
+
+/***********************************************************
+ *  GetCompoundPartDraws()
+ *
+ *  This method is used for getting the number of draws a
+ *  compound object takes when drawn part by part.
+ ***********************************************************/
+int SceneManager::GetCompoundPartDraws(COMPOUND_OBJECT_ID object) const
+{
+	int draws = 0;
+	for (const COMPOUND_PART& part : m_compoundObjects[object].parts)
+	{
+		draws += (int)part.ranges.size();
+	}
+	return(draws);
+}
+
+/***********************************************************
+ *  GetCompoundMergedDraws()
+ *
+ *  This method is used for getting the number of draws a
+ *  compound object takes from its merged meshes.
+ ***********************************************************/
+int SceneManager::GetCompoundMergedDraws(COMPOUND_OBJECT_ID object) const
+{
+	return((int)m_compoundObjects[object].groups.size());
+}
+
+/***********************************************************
+ *  GetPatternOctaves()
+ *
+ *  This method is used for getting the number of noise
+ *  octaves the fragment shader sums for a preset.
+ ***********************************************************/
+int SceneManager::GetPatternOctaves(PROCEDURAL_PRESET preset)
+{
+	switch (preset)
+	{
+	case PROCEDURAL_FAST:
+		return(2);
+	case PROCEDURAL_DETAILED:
+		return(5);
+	default:
+		return(0);
+	}
+}
+
+/***********************************************************
+ *  CreateGLTextureAtlases()
+ *
+ *  This method is used for packing the small images queued by
+ *  CreateGLTexture() into atlas pages.  Each page takes one
+ *  texture slot, and every packed image keeps the UV scale and
+ *  offset of its region so SetShaderTexture() can remap it.
+ ***********************************************************/
+void SceneManager::CreateGLTextureAtlases()
+{
+	if (m_textureAtlas->PackAndUpload() == false)
+	{
+		return;
+	}
+
+	const std::vector<TextureAtlas::ATLAS_PAGE>& pages = m_textureAtlas->GetPages();
+	const std::vector<TextureAtlas::ATLAS_REGION>& regions = m_textureAtlas->GetRegions();
+	int firstSlot = m_loadedTextures;
+
+	for (int i = 0; (i < (int)pages.size()) && (m_loadedTextures < MAX_TEXTURE_SLOTS); i++)
+	{
+		m_textureIDs[m_loadedTextures].ID = pages[i].ID;
+		m_textureIDs[m_loadedTextures].tag = "atlas" + std::to_string(i);
+		m_loadedTextures++;
+	}
+
+	for (int i = 0; i < (int)regions.size(); i++)
+	{
+		if ((firstSlot + regions[i].page) < m_loadedTextures)
+		{
+			TEXTURE_ENTRY entry;
+			entry.tag = regions[i].tag;
+			entry.slot = firstSlot + regions[i].page;
+			entry.bAtlasRegion = true;
+			entry.uvScale = regions[i].uvScale;
+			entry.uvOffset = regions[i].uvOffset;
+			// atlas pages only hold small images and stay resident
+			entry.state = TEXTURE_RESIDENT;
+			entry.residency = -1;
+			entry.maxSize = 0;
+			entry.virtualTexture = -1;
+			m_textures.Insert(entry);
+		}
+	}
+
+	m_textureAtlas->PrintRegionTable(std::cout);
 }
 
 /***********************************************************
@@ -143,14 +732,22 @@ void SceneManager::BindGLTextures()
  *  DestroyGLTextures()
  *
  *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  used texture memory slots.  All texture handles become
+ *  stale afterwards.
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		glDeleteTextures(1, &m_textureIDs[i].ID);
+		m_textureIDs[i].ID = 0;
+		m_textureIDs[i].tag.clear();
 	}
+	m_loadedTextures = 0;
+	m_textures.Clear();
+	m_textureLoader->CancelAll();
+	m_textureResidency->Clear();
+	m_virtualTextures->Clear();
 }
 
 /***********************************************************
@@ -159,7 +756,7 @@ void SceneManager::DestroyGLTextures()
  *  This method is used for getting an ID for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+int SceneManager::FindTextureID(const std::string& tag)
 {
 	int textureID = -1;
 	int index = 0;
@@ -185,7 +782,7 @@ int SceneManager::FindTextureID(std::string tag)
  *  This method is used for getting a slot index for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureSlot(const std::string& tag)
 {
 	int textureSlot = -1;
 	int index = 0;
@@ -206,38 +803,45 @@ int SceneManager::FindTextureSlot(std::string tag)
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  FindTexture()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for getting the handle of the loaded
+ *  texture associated with the passed in tag.  The returned
+ *  handle is null if no texture has the tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+SceneManager::TextureHandle SceneManager::FindTexture(const std::string& tag)
 {
-	if (m_objectMaterials.size() == 0)
+	for (int i = 0; i < m_textures.SlotCount(); i++)
 	{
-		return(false);
+		const TEXTURE_ENTRY* entry = m_textures.GetAt(i);
+		if ((entry != NULL) && (entry->tag.compare(tag) == 0))
+		{
+			return(m_textures.HandleAt(i));
+		}
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	return(TextureHandle());
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting the handle of the previously
+ *  defined material that is associated with the passed in tag.
+ *  The returned handle is null if no material has the tag.
+ ***********************************************************/
+SceneManager::MaterialHandle SceneManager::FindMaterial(const std::string& tag)
+{
+	for (int i = 0; i < m_objectMaterials.SlotCount(); i++)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
+		const OBJECT_MATERIAL* material = m_objectMaterials.GetAt(i);
+		if ((material != NULL) && (material->tag.compare(tag) == 0))
 		{
-			index++;
+			return(m_objectMaterials.HandleAt(i));
 		}
 	}
 
-	return(true);
+	return(MaterialHandle());
 }
 
 /***********************************************************
@@ -253,6 +857,8 @@ void SceneManager::SetTransformations(
 	float ZrotationDegrees,
 	glm::vec3 positionXYZ)
 {
+	CaptureDrawnPart();
+
 	// variables for this method
 	glm::mat4 modelView;
 	glm::mat4 scale;
@@ -271,97 +877,324 @@ void SceneManager::SetTransformations(
 	translation = glm::translate(positionXYZ);
 
 	modelView = translation * rotationZ * rotationY * rotationX * scale;
+	m_modelMatrix = modelView;
 
 	if (NULL != m_pShaderManager)
 	{
 		m_pShaderManager->setMat4Value(g_ModelName, modelView);
 	}
+
+	UpdateMeshDetail();
+	UpdateMeshClusters();
+}
+
+/***********************************************************
+ *  UpdateMeshDetail()
+ *
+ *  This method is used for telling the shape meshes how
+ *  many pixels one unit of the current object's mesh covers
+ *  on screen.  As for the texture levels, the object's
+ *  largest scale is projected at its nearest distance from
+ *  the camera, so the size is never underestimated.
+ ***********************************************************/
+void SceneManager::UpdateMeshDetail()
+{
+	if (m_basicMeshes->GetLodErrorBudget() <= 0.0f)
+	{
+		return;
+	}
+
+	// without a view every object is drawn at full detail
+	if (m_viewportHeight <= 0)
+	{
+		m_basicMeshes->SetLodScale(FLT_MAX);
+		return;
+	}
+
+	float radius = glm::max(glm::length(glm::vec3(m_modelMatrix[0])),
+		glm::max(glm::length(glm::vec3(m_modelMatrix[1])), glm::length(glm::vec3(m_modelMatrix[2]))));
+	glm::vec4 center = m_projectionMatrix * m_viewMatrix * m_modelMatrix[3];
+
+	// an orthographic projection has no perspective divide
+	float distance = 1.0f;
+	if (m_projectionMatrix[2][3] != 0.0f)
+	{
+		distance = glm::max(center.w - radius, 0.001f);
+	}
+	m_basicMeshes->SetLodScale(radius * m_projectionMatrix[1][1] * 0.5f * (float)m_viewportHeight / distance);
+}
+
+/***********************************************************
+ *  UpdateMeshClusters()
+ *
+ *  This method is used for passing the transforms of the
+ *  current object to the shape meshes, which cull the
+ *  clusters of the round shapes against them.  Without a
+ *  view nothing is culled.
+ ***********************************************************/
+void SceneManager::UpdateMeshClusters()
+{
+	if (m_basicMeshes->GetClusterCulling() == false)
+	{
+		return;
+	}
+
+	if (m_viewportHeight <= 0)
+	{
+		m_basicMeshes->ClearClusterView();
+		return;
+	}
+	m_basicMeshes->SetClusterView(m_modelMatrix, m_viewMatrix, m_projectionMatrix);
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	CaptureDrawnPart();
+
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	m_currentTexture = TextureHandle();
+	m_currentColor = currentColor;
+	SetSeeThrough(alphaValue < 1.0f);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(g_UseTextureName, false);
+		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in tag into the shader.  The
+ *  tag is looked up on every call, so rendering code should
+ *  prefer the handle version.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	const std::string& textureTag)
+{
+	SetShaderTexture(FindTexture(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in handle into the shader.  For
+ *  textures packed into an atlas, the atlas page is bound and
+ *  the region is passed so the shader remaps the UVs.  A
+ *  stale or empty handle turns texturing off.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	TextureHandle texture)
+{
+	CaptureDrawnPart();
+
+	m_currentTexture = texture;
+	SetSeeThrough(false);
+	RequestTextureLevel();
+
+	if (NULL != m_pShaderManager)
+	{
+		// a handle that no longer resolves draws with the
+		// current color rather than whatever texture is bound
+		const TEXTURE_ENTRY* entry = m_textures.Get(texture);
+		m_pShaderManager->setIntValue(g_UseTextureName, entry != NULL);
+		if (entry == NULL)
+		{
+			return;
+		}
+
+		if (m_bVirtualTexturing == true)
+		{
+			m_pShaderManager->setBoolValue(g_UseVirtualTextureName, entry->virtualTexture >= 0);
+			if (entry->virtualTexture >= 0)
+			{
+				m_pShaderManager->setIntValue(g_UseAtlasName, false);
+				m_virtualTextures->BindTexture(entry->virtualTexture, m_pShaderManager);
+				return;
+			}
+		}
+
+		m_pShaderManager->setIntValue(g_UseAtlasName, entry->bAtlasRegion);
+		if (entry->bAtlasRegion == true)
+		{
+			m_pShaderManager->setVec2Value(g_AtlasScaleName, entry->uvScale);
+			m_pShaderManager->setVec2Value(g_AtlasOffsetName, entry->uvOffset);
+		}
+		m_pShaderManager->setSampler2DValue(g_TextureValueName, entry->slot);
+	}
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  SetTextureUVScale()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.  The scale is applied before any
+ *  atlas remapping, so it still tiles packed textures.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+void SceneManager::SetTextureUVScale(float u, float v)
 {
-	// variables for this method
-	glm::vec4 currentColor;
+	CaptureDrawnPart();
 
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
+	m_currentUVScale = glm::vec2(u, v);
+	RequestTextureLevel();
 
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
 	}
 }
 
 /***********************************************************
- *  SetShaderTexture()
+ *  RequestTextureLevel()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for asking for the current texture as
+ *  needed by the current object.  A texture is only loaded
+ *  once an object in view uses it, and the residency manager
+ *  is asked for the mip level matching the object's size on
+ *  screen.  The unit meshes fit in a sphere of about radius
+ *  one, so the object's largest scale is projected with the
+ *  current view.  Only the counting pass of a frame asks.
  ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
+void SceneManager::RequestTextureLevel()
 {
-	if (NULL != m_pShaderManager)
+	if (m_bCountingPass == false)
+	{
+		return;
+	}
+
+	TEXTURE_ENTRY* entry = m_textures.Get(m_currentTexture);
+	if ((entry == NULL) || (entry->bAtlasRegion == true) || (entry->virtualTexture >= 0))
+	{
+		return;
+	}
+
+	// wood and tile patterns are drawn in place of the texture
+	const OBJECT_MATERIAL* material = m_objectMaterials.Get(m_currentMaterial);
+	if ((m_proceduralPreset != PROCEDURAL_OFF) && (material != NULL) &&
+		((material->pattern == PATTERN_WOOD) || (material->pattern == PATTERN_TILE)))
+	{
+		return;
+	}
+
+	float radius = glm::max(glm::length(glm::vec3(m_modelMatrix[0])),
+		glm::max(glm::length(glm::vec3(m_modelMatrix[1])), glm::length(glm::vec3(m_modelMatrix[2]))));
+	glm::vec4 center = m_projectionMatrix * m_viewMatrix * m_modelMatrix[3];
+	bool bPerspective = (m_projectionMatrix[2][3] != 0.0f);
+
+	// without a view every used texture counts as visible
+	if (m_viewportHeight > 0)
+	{
+		// conservative sphere against frustum test in clip space
+		float clipRadiusX = radius * glm::abs(m_projectionMatrix[0][0]);
+		float clipRadiusY = radius * glm::abs(m_projectionMatrix[1][1]);
+		float clipW = bPerspective ? (center.w + radius) : 1.0f;
+		if ((clipW <= 0.0f) ||
+			(center.x - clipRadiusX > clipW) || (center.x + clipRadiusX < -clipW) ||
+			(center.y - clipRadiusY > clipW) || (center.y + clipRadiusY < -clipW))
+		{
+			return;
+		}
+	}
+
+	// first visible use - decode the image in the background
+	if (entry->state == TEXTURE_UNLOADED)
+	{
+		entry->state = TEXTURE_LOADING;
+		m_textureLoader->Request(entry->slot, entry->filename, m_bGpuColorConversion, entry->maxSize);
+		return;
+	}
+
+	if ((entry->residency < 0) || (m_viewportHeight <= 0))
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		return;
+	}
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+	// an orthographic projection has no perspective divide
+	float distance = 1.0f;
+	if (bPerspective == true)
+	{
+		// clip w is the view distance - objects reaching the
+		// camera get the full resolution
+		distance = glm::max(center.w - radius, 0.001f);
 	}
+	float screenPixels = 2.0f * radius * m_projectionMatrix[1][1] * 0.5f * (float)m_viewportHeight / distance;
+	float uvRepeat = glm::max(m_currentUVScale.x, m_currentUVScale.y);
+
+	m_textureResidency->RequestLevel(entry->residency,
+		m_textureResidency->LevelForScreenSize(entry->residency, screenPixels, uvRepeat));
 }
 
 /***********************************************************
- *  SetTextureUVScale()
+ *  SetShaderMaterial()
  *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  This method is used for passing the material values
+ *  associated with the passed in tag into the shader.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::SetShaderMaterial(
+	const std::string& materialTag)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	SetShaderMaterial(FindMaterial(materialTag));
 }
 
 /***********************************************************
  *  SetShaderMaterial()
  *
  *  This method is used for passing the material values
- *  into the shader.
+ *  associated with the passed in handle into the shader.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	MaterialHandle material)
 {
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+	CaptureDrawnPart();
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
+	m_currentMaterial = material;
+
+	const OBJECT_MATERIAL* objectMaterial = m_objectMaterials.Get(material);
+	if ((objectMaterial != NULL) && (NULL != m_pShaderManager))
+	{
+		m_pShaderManager->setVec3Value("material.ambientColor", objectMaterial->ambientColor);
+		m_pShaderManager->setFloatValue("material.ambientStrength", objectMaterial->ambientStrength);
+		m_pShaderManager->setVec3Value("material.diffuseColor", objectMaterial->diffuseColor);
+		m_pShaderManager->setVec3Value("material.specularColor", objectMaterial->specularColor);
+		m_pShaderManager->setFloatValue("material.shininess", objectMaterial->shininess);
+
+		// the patterns are only drawn when a preset enables them
+		PROCEDURAL_PATTERN pattern = (m_proceduralPreset != PROCEDURAL_OFF) ? objectMaterial->pattern : PATTERN_NONE;
+		m_pShaderManager->setIntValue("proceduralPattern", pattern);
+		if (pattern != PATTERN_NONE)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			m_pShaderManager->setVec3Value("patternColor1", objectMaterial->patternColor1);
+			m_pShaderManager->setVec3Value("patternColor2", objectMaterial->patternColor2);
+			m_pShaderManager->setFloatValue("patternScale", objectMaterial->patternScale);
 		}
 	}
+
+	// a texture set before the material was not requested if
+	// the previous material's pattern replaced it
+	if (m_proceduralPreset != PROCEDURAL_OFF)
+	{
+		RequestTextureLevel();
+	}
 }
 
 /***********************************************************
@@ -417,6 +1250,9 @@ void SceneManager::LoadSceneTextures()
 		"../../Utilities/textures/paperpages.jpg",
 		"bookpages");
 	
+	// the small images queued while loading are packed into
+	// shared atlas pages, taking one texture slot per page
+	CreateGLTextureAtlases();
 
 	// after the texture image data is loaded into memory, the
 	// loaded textures need to be bound to texture slots - there
@@ -433,8 +1269,13 @@ void SceneManager::DefineObjectMaterials()
 	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
 	woodMaterial.shininess = 10.0;
 	woodMaterial.tag = "wood";
+	// procedural planks in place of the table texture
+	woodMaterial.pattern = PATTERN_WOOD;
+	woodMaterial.patternColor1 = glm::vec3(0.62f, 0.42f, 0.24f);
+	woodMaterial.patternColor2 = glm::vec3(0.34f, 0.20f, 0.10f);
+	woodMaterial.patternScale = 1.0f;
 
-	m_objectMaterials.push_back(woodMaterial);
+	m_objectMaterials.Insert(woodMaterial);
 
 	//shaders for glass material
 	OBJECT_MATERIAL glassMaterial;
@@ -445,7 +1286,7 @@ void SceneManager::DefineObjectMaterials()
 	glassMaterial.shininess = 85.0;
 	glassMaterial.tag = "glass";
 
-	m_objectMaterials.push_back(glassMaterial);
+	m_objectMaterials.Insert(glassMaterial);
 
 	//shaders for wall
 	OBJECT_MATERIAL wallMaterial;
@@ -456,7 +1297,7 @@ void SceneManager::DefineObjectMaterials()
 	wallMaterial.shininess = 0.0;
 	wallMaterial.tag = "wall";
 
-	m_objectMaterials.push_back(wallMaterial);
+	m_objectMaterials.Insert(wallMaterial);
 
 	//shaders for floor
 	OBJECT_MATERIAL floorMaterial;
@@ -466,8 +1307,13 @@ void SceneManager::DefineObjectMaterials()
 	floorMaterial.specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
 	floorMaterial.shininess = 0.0;
 	floorMaterial.tag = "floor";
+	// procedural stone tiles in place of the floor texture
+	floorMaterial.pattern = PATTERN_TILE;
+	floorMaterial.patternColor1 = glm::vec3(0.78f, 0.70f, 0.56f);
+	floorMaterial.patternColor2 = glm::vec3(0.32f, 0.28f, 0.22f);
+	floorMaterial.patternScale = 2.0f;
 
-	m_objectMaterials.push_back(floorMaterial);
+	m_objectMaterials.Insert(floorMaterial);
 
 	//shaders for metal material
 	OBJECT_MATERIAL metalMaterial;
@@ -477,8 +1323,11 @@ void SceneManager::DefineObjectMaterials()
 	metalMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
 	metalMaterial.shininess = 22.0;
 	metalMaterial.tag = "metal";
+	// brushed streaks over the metal parts' own colors and textures
+	metalMaterial.pattern = PATTERN_METAL;
+	metalMaterial.patternScale = 1.0f;
 
-	m_objectMaterials.push_back(metalMaterial);
+	m_objectMaterials.Insert(metalMaterial);
 
 	//shaders for book material
 	OBJECT_MATERIAL bookMaterial;
@@ -489,7 +1338,7 @@ void SceneManager::DefineObjectMaterials()
 	bookMaterial.shininess = 10.0;
 	bookMaterial.tag = "book";
 
-	m_objectMaterials.push_back(bookMaterial);
+	m_objectMaterials.Insert(bookMaterial);
 
 }
 
@@ -523,6 +1372,33 @@ void SceneManager::SetupSceneLights()
 }
 
 
+/***********************************************************
+ *  FindSceneHandles()
+ *
+ *  This method is used for looking up the handles of the
+ *  textures and materials used by the scene, so that the
+ *  rendering code resolves them without comparing strings.
+ ***********************************************************/
+void SceneManager::FindSceneHandles()
+{
+	m_floorTexture = FindTexture("Floor");
+	m_wallTexture = FindTexture("Wall");
+	m_tableTexture = FindTexture("Table");
+	m_keyboardTexture = FindTexture("keyboard");
+	m_lightTexture = FindTexture("light");
+	m_canTopTexture = FindTexture("cantop");
+	m_canSideTexture = FindTexture("canside");
+	m_bookCoverTexture = FindTexture("bookcover");
+	m_bookPagesTexture = FindTexture("bookpages");
+
+	m_woodMaterial = FindMaterial("wood");
+	m_glassMaterial = FindMaterial("glass");
+	m_wallMaterial = FindMaterial("wall");
+	m_floorMaterial = FindMaterial("floor");
+	m_metalMaterial = FindMaterial("metal");
+	m_bookMaterial = FindMaterial("book");
+}
+
 /**************************************************************/
 /*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
 /*** preparing and rendering their own 3D replicated scenes.***/
@@ -546,13 +1422,21 @@ void SceneManager::PrepareScene()
 	// define the materials that will be used for the objects
 	// in the 3D scene
 	DefineObjectMaterials();
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue("patternOctaves", GetPatternOctaves(m_proceduralPreset));
+	}
 
 	// add and defile the light sources for the 3D scene
 	SetupSceneLights();
 
+	// resolve the texture and material tags used while rendering
+	FindSceneHandles();
+
 	// only one instance of a particular mesh needs to be
 	// loaded in memory no matter how many times it is drawn
 	// in the rendered 3D scene
+	std::chrono::steady_clock::time_point meshStart = std::chrono::steady_clock::now();
 
 	m_basicMeshes->LoadPlaneMesh();
 	m_basicMeshes->LoadBoxMesh();
@@ -563,6 +1447,30 @@ void SceneManager::PrepareScene()
 	m_basicMeshes->LoadTorusMesh(.1);
 	m_basicMeshes->LoadTaperedCylinderMesh();
 
+	// report what the mesh cache saved, and keep the meshes
+	// it did not have for the next run
+	double meshMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - meshStart).count();
+	MeshCache::CACHE_STATS cacheStats = m_basicMeshes->GetMeshCacheStats();
+	if ((cacheStats.hits + cacheStats.misses) > 0)
+	{
+		std::cout << "Loaded meshes in " << meshMilliseconds << " ms, " << cacheStats.hits << " from the cache, "
+			<< cacheStats.misses << " generated, map " << cacheStats.mapMilliseconds << " ms, validate "
+			<< cacheStats.validateMilliseconds << " ms, " << cacheStats.fileBytes << " bytes" << std::endl;
+		if (m_basicMeshes->SaveMeshCache() == false)
+		{
+			std::cout << "Could not write the mesh cache" << std::endl;
+		}
+	}
+
+	// record the parts of the compound objects once their shapes
+	// are loaded
+	if (m_bStaticMerging == true)
+	{
+		for (int object = 0; object < COMPOUND_OBJECT_COUNT; object++)
+		{
+			CaptureCompoundObject((COMPOUND_OBJECT_ID)object);
+		}
+	}
 }
 
 /***********************************************************
@@ -573,13 +1481,354 @@ void SceneManager::PrepareScene()
  ***********************************************************/
 void SceneManager::RenderScene()
 {
+	// swap in the textures finished loading since the last frame
+	UploadLoadedTextures();
+	m_basicMeshes->ResetLodStats();
+	m_basicMeshes->ResetClusterStats();
+	m_textureResidency->BeginFrame();
+
+	if (m_bVirtualTexturing == true)
+	{
+		// map the pages read since the last frame, then find
+		// the pages this view needs with a low resolution pass
+		m_virtualTextures->Update();
+		m_virtualTextures->BeginFeedbackPass(m_pShaderManager);
+		RenderObjects(false);
+		m_virtualTextures->EndFeedbackPass(m_pShaderManager);
+	}
+
+	if (m_bDepthPrePass == true)
+	{
+		// lay down the depth of the opaque surfaces, then shade
+		// only the fragments left on top
+		BeginDepthPass(PASS_DEPTH_ONLY);
+		RenderObjects(false);
+		BeginDepthPass(PASS_SHADING_OVER_DEPTH);
+	}
+
+	RenderObjects(true);
+	BeginDepthPass(PASS_SHADING_ONLY);
+
+	// stream in the mip levels this frame asked for - they
+	// are used from the next frame on
+	m_textureResidency->Update();
+}
+
+/***********************************************************
+ *  RenderObjects()
+ *
+ *  This method is used for drawing every object of the 3D
+ *  scene, once per pass the frame renders.  The passes
+ *  drawn before the shading pass, for the virtual texture
+ *  feedback and the depth pre-pass, leave the detail level
+ *  and cluster stats and the texture level requests to it,
+ *  so they count each object once a frame.
+ ***********************************************************/
+void SceneManager::RenderObjects(bool bCountingPass)
+{
+	m_bCountingPass = bCountingPass;
+	m_basicMeshes->SetCountingStats(bCountingPass);
+
 	RenderRoom();
 	RenderCeilingLight();
 	RenderTable();
-	RenderLaptop();
-	RenderLamp();
+	RenderCompoundObject(COMPOUND_LAPTOP);
+	RenderCompoundObject(COMPOUND_LAMP);
 	RenderCan();
-	RenderBooks();
+	RenderCompoundObject(COMPOUND_BOOKS);
+
+	m_bCountingPass = true;
+	m_basicMeshes->SetCountingStats(true);
+}
+
+/***********************************************************
+ *  BeginDepthPass()
+ *
+ *  This method is used for setting up the next pass of a
+ *  frame.  The depth pass writes only depth, with the depth
+ *  program in place of the main one - the tessellated and
+ *  bufferless shapes keep their own programs, which write
+ *  no color either.  The shading pass that follows it keeps
+ *  the depth and draws only where it is equal.  Shading
+ *  alone puts back the usual depth test.
+ ***********************************************************/
+void SceneManager::BeginDepthPass(DEPTH_PASS pass)
+{
+	if ((pass == m_depthPass) || (NULL == m_pShaderManager))
+	{
+		return;
+	}
+	m_depthPass = pass;
+
+	GLuint program = m_pShaderManager->m_programID;
+	if (pass == PASS_DEPTH_ONLY)
+	{
+		program = m_pShaderManager->m_sharedProgramIDs[ShaderManager::depthProgram];
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	}
+	else
+	{
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
+	glDepthMask((pass == PASS_SHADING_OVER_DEPTH) ? GL_FALSE : GL_TRUE);
+	glDepthFunc((pass == PASS_SHADING_OVER_DEPTH) ? GL_EQUAL : GL_LESS);
+
+	glUseProgram(program);
+	m_basicMeshes->SetMainProgram(program);
+}
+
+/***********************************************************
+ *  SetSeeThrough()
+ *
+ *  This method is used for keeping see-through colors out
+ *  of the depth pre-pass.  They do not hide what is behind
+ *  them, so the depth pass does not write their depth, and
+ *  the shading pass tests them against the depth laid down
+ *  with the usual depth test.
+ ***********************************************************/
+void SceneManager::SetSeeThrough(bool bSeeThrough)
+{
+	if (m_depthPass == PASS_DEPTH_ONLY)
+	{
+		glDepthMask((bSeeThrough == true) ? GL_FALSE : GL_TRUE);
+	}
+	else if (m_depthPass == PASS_SHADING_OVER_DEPTH)
+	{
+		glDepthFunc((bSeeThrough == true) ? GL_LESS : GL_EQUAL);
+	}
+}
+
+/***********************************************************
+ *  RenderCompoundObject()
+ *
+ *  This method is used for drawing a compound object from
+ *  its merged meshes, one draw per look.  The merged
+ *  vertices are already placed in the scene, so they are
+ *  drawn with an identity model, while the sphere around
+ *  each merged mesh stands in for the object when the
+ *  texture levels are chosen.
+ ***********************************************************/
+void SceneManager::RenderCompoundObject(COMPOUND_OBJECT_ID object)
+{
+	COMPOUND_OBJECT& compound = m_compoundObjects[object];
+	if ((m_bStaticMerging == false) || (compound.bMerged == false))
+	{
+		RenderCompoundParts(object);
+		return;
+	}
+
+	if (compound.bDirty == true)
+	{
+		MergeCompoundObject(compound);
+	}
+
+	for (const MERGED_GROUP& group : compound.groups)
+	{
+		m_modelMatrix = glm::translate(glm::vec3(group.bounds)) * glm::scale(glm::vec3(group.bounds.w));
+		if (NULL != m_pShaderManager)
+		{
+			m_pShaderManager->setMat4Value(g_ModelName, glm::mat4(1.0f));
+		}
+
+		if (group.look.texture == TextureHandle())
+		{
+			SetShaderColor(group.look.color.r, group.look.color.g, group.look.color.b, group.look.color.a);
+		}
+		else
+		{
+			SetShaderTexture(group.look.texture);
+		}
+		SetTextureUVScale(group.look.uvScale.x, group.look.uvScale.y);
+		SetShaderMaterial(group.look.material);
+
+		m_basicMeshes->DrawMergedMesh(group.mesh);
+	}
+}
+
+/***********************************************************
+ *  RenderCompoundParts()
+ *
+ *  This method is used for calling the drawing code of a
+ *  compound object, which draws it part by part.
+ ***********************************************************/
+void SceneManager::RenderCompoundParts(COMPOUND_OBJECT_ID object)
+{
+	switch (object)
+	{
+	case COMPOUND_LAPTOP:
+		RenderLaptop();
+		break;
+	case COMPOUND_LAMP:
+		RenderLamp();
+		break;
+	case COMPOUND_BOOKS:
+		RenderBooks();
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  CaptureCompoundObject()
+ *
+ *  This method is used for recording the parts of a
+ *  compound object.  Its drawing code runs with the shape
+ *  meshes capturing, so nothing is drawn, and whenever it
+ *  changes the transform or the look, the ranges drawn
+ *  before become a part.  The parts are then baked.  An
+ *  object with a shape that has no stored triangles keeps
+ *  being drawn part by part.
+ ***********************************************************/
+void SceneManager::CaptureCompoundObject(COMPOUND_OBJECT_ID object)
+{
+	COMPOUND_OBJECT& compound = m_compoundObjects[object];
+	compound.parts.clear();
+
+	m_pCapturingObject = &compound;
+	m_basicMeshes->BeginMeshCapture();
+	RenderCompoundParts(object);
+	CaptureDrawnPart();
+	compound.bMerged = m_basicMeshes->EndMeshCapture();
+	m_pCapturingObject = NULL;
+
+	if (compound.bMerged == true)
+	{
+		MergeCompoundObject(compound);
+	}
+}
+
+/***********************************************************
+ *  CaptureDrawnPart()
+ *
+ *  This method is used for filing the ranges drawn since
+ *  the last call as a part of the object being captured,
+ *  with the transform and look they were drawn with.  It
+ *  is called before each change of either.
+ ***********************************************************/
+void SceneManager::CaptureDrawnPart()
+{
+	if (m_pCapturingObject == NULL)
+	{
+		return;
+	}
+
+	COMPOUND_PART part;
+	m_basicMeshes->TakeCapturedRanges(part.ranges);
+	if (part.ranges.size() == 0)
+	{
+		return;
+	}
+
+	part.model = m_modelMatrix;
+	part.look.texture = m_currentTexture;
+	part.look.color = m_currentColor;
+	part.look.material = m_currentMaterial;
+	part.look.uvScale = m_currentUVScale;
+	m_pCapturingObject->parts.push_back(part);
+}
+
+/***********************************************************
+ *  MergeCompoundObject()
+ *
+ *  This method is used for baking the parts of a compound
+ *  object into one mesh for each look they share, in the
+ *  order the looks were first drawn.  A part drawing a
+ *  face that an earlier part with the same transform
+ *  already drew, like a whole box after one textured
+ *  side, leaves that face out - the depth test hid it.
+ ***********************************************************/
+void SceneManager::MergeCompoundObject(COMPOUND_OBJECT& object)
+{
+	for (MERGED_GROUP& group : object.groups)
+	{
+		m_basicMeshes->FreeMergedMesh(group.mesh);
+	}
+	object.groups.clear();
+
+	std::vector<std::vector<ShapeMeshes::CAPTURED_RANGE>> visible(object.parts.size());
+	std::vector<std::vector<ShapeMeshes::MERGE_PART>> groupParts;
+	for (size_t i = 0; i < object.parts.size(); i++)
+	{
+		const COMPOUND_PART& part = object.parts[i];
+		visible[i] = part.ranges;
+		for (size_t earlier = 0; earlier < i; earlier++)
+		{
+			if (object.parts[earlier].model == part.model)
+			{
+				ShapeMeshes::SubtractRanges(visible[i], object.parts[earlier].ranges);
+			}
+		}
+		if (visible[i].size() == 0)
+		{
+			continue;
+		}
+
+		size_t group = 0;
+		while ((group < object.groups.size()) && (IsSameLook(object.groups[group].look, part.look) == false))
+		{
+			group++;
+		}
+		if (group == object.groups.size())
+		{
+			MERGED_GROUP merged;
+			merged.look = part.look;
+			object.groups.push_back(merged);
+			groupParts.push_back(std::vector<ShapeMeshes::MERGE_PART>());
+		}
+
+		ShapeMeshes::MERGE_PART mergePart;
+		mergePart.ranges = visible[i].data();
+		mergePart.rangeCount = (int)visible[i].size();
+		mergePart.model = part.model;
+		groupParts[group].push_back(mergePart);
+	}
+
+	for (size_t group = 0; group < object.groups.size(); group++)
+	{
+		MERGED_GROUP& merged = object.groups[group];
+		merged.mesh = m_basicMeshes->MergeMeshParts(ShapeMeshes::MeshHandle(),
+			groupParts[group].data(), (int)groupParts[group].size(), merged.bounds);
+	}
+	object.bDirty = false;
+}
+
+/***********************************************************
+ *  IsSameLook()
+ *
+ *  This method is used for checking whether two parts are
+ *  drawn with the same texture or color, material and UV
+ *  scale.
+ ***********************************************************/
+bool SceneManager::IsSameLook(const PART_LOOK& first, const PART_LOOK& second)
+{
+	if ((first.texture == second.texture) == false)
+	{
+		return(false);
+	}
+	if ((first.texture == TextureHandle()) && (first.color != second.color))
+	{
+		return(false);
+	}
+	return((first.material == second.material) && (first.uvScale == second.uvScale));
+}
+
+/***********************************************************
+ *  SetSceneView()
+ *
+ *  This method is used for passing the view and projection
+ *  of the next frame, which decide the mip levels streamed
+ *  in for the textured objects.
+ ***********************************************************/
+void SceneManager::SetSceneView(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportHeight)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewportHeight = viewportHeight;
+	m_basicMeshes->SetTessellationView(viewportHeight, m_tessellationEdgePixels);
 }
 void SceneManager::RenderRoom() {
 	//Floor
@@ -614,11 +1863,11 @@ void SceneManager::RenderRoom() {
 		ZrotationDegrees,
 		positionXYZ);
 
+	//floor material
+	SetShaderMaterial(m_floorMaterial);
 	//sets texture
-	SetShaderTexture("Floor");
+	SetShaderTexture(m_floorTexture);
 	SetTextureUVScale(1.0, 1.0);
-	//floor material
-	SetShaderMaterial("floor");
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawPlaneMesh();
@@ -649,11 +1898,11 @@ void SceneManager::RenderRoom() {
 		ZrotationDegrees,
 		positionXYZ);
 
+	//floor material
+	SetShaderMaterial(m_floorMaterial);
 	//sets texture
-	SetShaderTexture("Floor");
+	SetShaderTexture(m_floorTexture);
 	SetTextureUVScale(1.0, 1.0);
-	//floor material
-	SetShaderMaterial("floor");
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawPlaneMesh();
@@ -685,10 +1934,10 @@ void SceneManager::RenderRoom() {
 		positionXYZ);
 
 	//sets texture
-	SetShaderTexture("Wall");
+	SetShaderTexture(m_wallTexture);
 	SetTextureUVScale(1.0, 1.0);
 	//wall material
-	SetShaderMaterial("wall");
+	SetShaderMaterial(m_wallMaterial);
 
 
 	// draw the mesh with transformation values
@@ -720,10 +1969,10 @@ void SceneManager::RenderRoom() {
 		positionXYZ);
 
 	//sets texture
-	SetShaderTexture("Wall");
+	SetShaderTexture(m_wallTexture);
 	SetTextureUVScale(1.0, 1.0);
 	//wall material
-	SetShaderMaterial("wall");
+	SetShaderMaterial(m_wallMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawPlaneMesh();
@@ -755,10 +2004,10 @@ void SceneManager::RenderRoom() {
 		positionXYZ);
 
 	//sets texture
-	SetShaderTexture("Wall");
+	SetShaderTexture(m_wallTexture);
 	SetTextureUVScale(1.0, 1.0);
 	//wall material
-	SetShaderMaterial("wall");
+	SetShaderMaterial(m_wallMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawPlaneMesh();
@@ -791,11 +2040,11 @@ void SceneManager::RenderRoom() {
 		positionXYZ);
 
 	//wall texture
-	SetShaderTexture("Wall");
+	SetShaderTexture(m_wallTexture);
 	SetTextureUVScale(1.0, 1.0);
 
 	//wall material
-	SetShaderMaterial("wall");
+	SetShaderMaterial(m_wallMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawPlaneMesh();
@@ -839,7 +2088,7 @@ void SceneManager::RenderCeilingLight() {
 	//light source
 	SetShaderColor(1, 1, 1, 1);
 	//material glass
-	SetShaderMaterial("glass");
+	SetShaderMaterial(m_glassMaterial);
 
 
 	// draw the mesh with transformation values
@@ -877,11 +2126,11 @@ void SceneManager::RenderTable() {
 		ZrotationDegrees,
 		positionXYZ);
 
+	//material wood
+	SetShaderMaterial(m_woodMaterial);
 	//sets texture
-	SetShaderTexture("Table");
+	SetShaderTexture(m_tableTexture);
 	SetTextureUVScale(1.0, 1.0);
-	//material wood
-	SetShaderMaterial("wood");
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawBoxMesh();
@@ -907,11 +2156,11 @@ void SceneManager::RenderTable() {
 		ZrotationDegrees,
 		positionXYZ);
 
+	//material wood
+	SetShaderMaterial(m_woodMaterial);
 	//sets texture
-	SetShaderTexture("Table");
+	SetShaderTexture(m_tableTexture);
 	SetTextureUVScale(1.0, 1.0);
-	//material wood
-	SetShaderMaterial("wood");
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawBoxMesh();
@@ -936,11 +2185,11 @@ void SceneManager::RenderTable() {
 		ZrotationDegrees,
 		positionXYZ);
 
+	//material wood
+	SetShaderMaterial(m_woodMaterial);
 	//sets texture
-	SetShaderTexture("Table");
+	SetShaderTexture(m_tableTexture);
 	SetTextureUVScale(1.0, 1.0);
-	//material wood
-	SetShaderMaterial("wood");
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawBoxMesh();
@@ -969,27 +2218,34 @@ void SceneManager::RenderLaptop() {
 	// set the XYZ position for the mesh
 	positionXYZ = glm::vec3(0.0f, 14.5f, -14.0f);
 
-	// set the transformations into memory to be used on the drawn meshes
+	// the keyboard sits just above the top of the body
 	SetTransformations(
-		scaleXYZ,
+		scaleXYZ + glm::vec3(0.0f, 2.0f * g_BoxSideLift, 0.0f),
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
 		positionXYZ);
 
-
 	//keyboard texture
-	SetShaderTexture("keyboard");
+	SetShaderTexture(m_keyboardTexture);
 	SetTextureUVScale(1, 1);
 	//sets material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 	//draws this side to have keyboard
 	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::top);
 
+	// set the transformations into memory to be used on the drawn meshes
+	SetTransformations(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
 	//sets color to grey
 	SetShaderColor(0.627f, 0.627f, 0.627f,1);
 	//shader material metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawBoxMesh();
 
@@ -1008,9 +2264,9 @@ void SceneManager::RenderLaptop() {
 	// set the XYZ position for the mesh
 	positionXYZ = glm::vec3(0.0f, 17.5f, -17.121f);
 
-	// set the transformations into memory to be used on the drawn meshes
+	// the screen sits just in front of the back
 	SetTransformations(
-		scaleXYZ,
+		scaleXYZ + glm::vec3(0.0f, 2.0f * g_BoxSideLift, 0.0f),
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
@@ -1019,15 +2275,23 @@ void SceneManager::RenderLaptop() {
 	//screen color is black
 	SetShaderColor(0, 0, 0, 1);
 	//shader matierial is metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 	//draws just a particular side of the mesh with the color black for the screen
 	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::top);
 
+	// set the transformations into memory to be used on the drawn meshes
+	SetTransformations(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
 	//set color to grey
 	SetShaderColor(0.627f, 0.627f, 0.627f,1);
 
 	//set shader material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawBoxMesh();
 
@@ -1071,7 +2335,7 @@ void SceneManager::RenderLamp() {
 	SetShaderColor(0.031, 0.031, 0.031, 1);
 
 	//set shader material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawPyramid4Mesh();
@@ -1102,7 +2366,7 @@ void SceneManager::RenderLamp() {
 	SetShaderColor(0.031, 0.031, 0.031, 1);
 
 	//set shader material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawCylinderMesh();
@@ -1132,7 +2396,7 @@ void SceneManager::RenderLamp() {
 	SetShaderColor(0.031, 0.031, 0.031, 1);
 
 	//set shader material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawCylinderMesh();
@@ -1162,7 +2426,7 @@ void SceneManager::RenderLamp() {
 	SetShaderColor(0.031, 0.031, 0.031, 1);
 
 	//set shader material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawHalfTorusMesh();
@@ -1192,7 +2456,7 @@ void SceneManager::RenderLamp() {
 	SetShaderColor(0.031, 0.031, 0.031, 1);
 
 	//set shader material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawCylinderMesh();
@@ -1222,7 +2486,7 @@ void SceneManager::RenderLamp() {
 	SetShaderColor(0.031, 0.031, 0.031, 1);
 
 	//set shader material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawPyramid4Mesh();
@@ -1249,17 +2513,17 @@ void SceneManager::RenderLamp() {
 		positionXYZ);
 
 	//lightbulb texture
-	SetShaderTexture("light");
+	SetShaderTexture(m_lightTexture);
 	SetTextureUVScale(1, 1);
 	//sets material to metal
-	SetShaderMaterial("glass");
+	SetShaderMaterial(m_glassMaterial);
 	//draws this side to have keyboard
 	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::bottom);
 
 	//sets color
 	SetShaderColor(0.031, 0.031, 0.031, 1);
 	//shader material metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawBoxMesh();
 }
@@ -1295,19 +2559,19 @@ void SceneManager::RenderCan() {
 		positionXYZ);
 
 	//can texture
-	SetShaderTexture("canside");
+	SetShaderTexture(m_canSideTexture);
 	SetTextureUVScale(1, 1);
 	//sets material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawCylinderMesh(false,false,true);
 
 	//can texture
-	SetShaderTexture("cantop");
+	SetShaderTexture(m_canTopTexture);
 	SetTextureUVScale(1, 1);
 	//sets material to metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawCylinderMesh(true, false, false);
@@ -1336,7 +2600,7 @@ void SceneManager::RenderCan() {
 	//sets color to grey
 	SetShaderColor(0.627f, 0.627f, 0.627f, 1);
 	//shader material metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawTorusMesh();
 
@@ -1364,7 +2628,7 @@ void SceneManager::RenderCan() {
 	//sets color to grey
 	SetShaderColor(0.627f, 0.627f, 0.627f, 1);
 	//shader material metal
-	SetShaderMaterial("metal");
+	SetShaderMaterial(m_metalMaterial);
 	// draw the mesh with transformation values
 	m_basicMeshes->DrawTorusMesh();
 }
@@ -1390,30 +2654,38 @@ void SceneManager::RenderBooks() {
 	// set the XYZ position for the mesh
 	positionXYZ = glm::vec3(9.0f, 15.0f, -16.0f);
 
-	// set the transformations into memory to be used on the drawn meshes
+	// the cover sits just outside the spine and top of the pages
 	SetTransformations(
-		scaleXYZ,
+		scaleXYZ + glm::vec3(2.0f * g_BoxSideLift, 2.0f * g_BoxSideLift, 0.0f),
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
 		positionXYZ);
 
 	//draws just a particular side of the mesh with the book cover texture
-	SetShaderTexture("bookcover");
+	SetShaderTexture(m_bookCoverTexture);
 	SetTextureUVScale(1.0, 1.0);
-	SetShaderMaterial("book");
+	SetShaderMaterial(m_bookMaterial);
 	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::left);
 
 	//draws just a particular side of the mesh with the book cover texture
-	SetShaderTexture("bookcover");
+	SetShaderTexture(m_bookCoverTexture);
 	SetTextureUVScale(1.0, 1.0);
-	SetShaderMaterial("book");
+	SetShaderMaterial(m_bookMaterial);
 	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::top);
 
+	// set the transformations into memory to be used on the drawn meshes
+	SetTransformations(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
 	// draw the mesh with book pages texture
-	SetShaderTexture("bookpages");
+	SetShaderTexture(m_bookPagesTexture);
 	SetTextureUVScale(1.0, 1.0);
-	SetShaderMaterial("book");
+	SetShaderMaterial(m_bookMaterial);
 	m_basicMeshes->DrawBoxMesh();
 	
 }
@@ -11,6 +11,14 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "TextureAtlas.h"
+#include "TextureResidency.h"
+#include "MipGenerator.h"
+#include "JpegDecoder.h"
+#include "TextureLoader.h"
+#include "YCbCrConverter.h"
+#include "VirtualTextureSystem.h"
+#include "SlotMap.h"
 
 #include <string>
 #include <vector>
@@ -35,6 +43,47 @@ public:
 		uint32_t ID;
 	};
 
+	// loading progress of a texture
+	enum TEXTURE_STATE
+	{
+		TEXTURE_UNLOADED,		// drawn with the placeholder, not requested yet
+		TEXTURE_LOADING,		// being decoded in the background
+		TEXTURE_RESIDENT,		// image uploaded
+		TEXTURE_FAILED			// image could not be decoded
+	};
+
+	// a loaded texture - either in its own slot or packed into an atlas page
+	struct TEXTURE_ENTRY
+	{
+		std::string tag;
+		std::string filename;
+		TEXTURE_STATE state;
+		int slot;
+		bool bAtlasRegion;
+		glm::vec2 uvScale;		// region of the atlas page when packed
+		glm::vec2 uvOffset;
+		int residency;			// index in the residency manager, -1 if not streamed
+		int maxSize;			// largest size the image is loaded at, 0 for its own size
+		int virtualTexture;		// index in the virtual texture system, -1 if not virtual
+	};
+
+	// surface patterns the fragment shader can draw instead of a texture
+	enum PROCEDURAL_PATTERN
+	{
+		PATTERN_NONE,
+		PATTERN_WOOD,			// growth rings and fibers, replaces the texture
+		PATTERN_METAL,			// brushed streaks, shades the texture or color
+		PATTERN_TILE			// mottled tiles and grout, replaces the texture
+	};
+
+	// how the procedural patterns are drawn
+	enum PROCEDURAL_PRESET
+	{
+		PROCEDURAL_OFF,			// the materials use their textures
+		PROCEDURAL_FAST,		// few noise octaves
+		PROCEDURAL_DETAILED		// more noise octaves
+	};
+
 	struct OBJECT_MATERIAL
 	{
 		float ambientStrength;
@@ -43,6 +92,25 @@ public:
 		glm::vec3 specularColor;
 		float shininess;
 		std::string tag;
+		// pattern drawn when procedural materials are enabled
+		PROCEDURAL_PATTERN pattern = PATTERN_NONE;
+		glm::vec3 patternColor1 = glm::vec3(1.0f);
+		glm::vec3 patternColor2 = glm::vec3(0.0f);
+		float patternScale = 1.0f;
+	};
+
+	// handles resolving to loaded textures and defined materials
+	typedef SlotMap<TEXTURE_ENTRY>::Handle TextureHandle;
+	typedef SlotMap<OBJECT_MATERIAL>::Handle MaterialHandle;
+
+	// the objects made of several parts that never move relative
+	// to each other
+	enum COMPOUND_OBJECT_ID
+	{
+		COMPOUND_LAPTOP,
+		COMPOUND_LAMP,
+		COMPOUND_BOOKS,
+		COMPOUND_OBJECT_COUNT
 	};
 
 private:
@@ -50,24 +118,149 @@ private:
 	ShaderManager* m_pShaderManager;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
+	// texture slots, slot i is bound to texture unit i
+	static const int MAX_TEXTURE_SLOTS = 16;
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
+	TEXTURE_INFO m_textureIDs[MAX_TEXTURE_SLOTS];
+	// packer for the small textures that share atlas pages
+	TextureAtlas* m_textureAtlas;
+	// streams the mip levels of the loaded textures within a budget
+	TextureResidency* m_textureResidency;
+	// builds the mip chains of the loaded textures
+	MipGenerator* m_mipGenerator;
+	// decodes the baseline JPEG textures, stb_image decodes the rest
+	JpegDecoder* m_jpegDecoder;
+	// decodes the textures in the background once they are used
+	TextureLoader* m_textureLoader;
+	// converts the JPEG color planes to RGB on the GPU when enabled
+	YCbCrConverter* m_ycbcrConverter;
+	bool m_bGpuColorConversion;
+	// draws the large textures through a page table and page cache
+	// when enabled, instead of giving each its own texture
+	VirtualTextureSystem* m_virtualTextures;
+	bool m_bVirtualTexturing;
+	// largest size any texture is loaded at, 0 for no limit
+	int m_textureSizeLimit;
+	// whether and how the material patterns are drawn
+	PROCEDURAL_PRESET m_proceduralPreset;
+	// every loaded texture, including those packed into atlas pages
+	SlotMap<TEXTURE_ENTRY> m_textures;
 	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	SlotMap<OBJECT_MATERIAL> m_objectMaterials;
+
+	// handles of the scene textures and materials, looked up
+	// once by tag so rendering does no string compares
+	TextureHandle m_floorTexture;
+	TextureHandle m_wallTexture;
+	TextureHandle m_tableTexture;
+	TextureHandle m_keyboardTexture;
+	TextureHandle m_lightTexture;
+	TextureHandle m_canTopTexture;
+	TextureHandle m_canSideTexture;
+	TextureHandle m_bookCoverTexture;
+	TextureHandle m_bookPagesTexture;
+	MaterialHandle m_woodMaterial;
+	MaterialHandle m_glassMaterial;
+	MaterialHandle m_wallMaterial;
+	MaterialHandle m_floorMaterial;
+	MaterialHandle m_metalMaterial;
+	MaterialHandle m_bookMaterial;
+
+	// view of the frame being rendered, used to estimate the
+	// on-screen size of textured objects
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	int m_viewportHeight;
+	// pixels each refined patch edge covers with tessellation
+	float m_tessellationEdgePixels;
+	// state of the draw being prepared
+	glm::mat4 m_modelMatrix;
+	TextureHandle m_currentTexture;
+	glm::vec4 m_currentColor;
+	glm::vec2 m_currentUVScale;
+	MaterialHandle m_currentMaterial;
+
+	// how a part of a compound object is drawn - the color is
+	// only used without a texture
+	struct PART_LOOK
+	{
+		TextureHandle texture;
+		glm::vec4 color;
+		MaterialHandle material;
+		glm::vec2 uvScale;
+	};
 
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
+	// one part of a compound object as its drawing code drew it -
+	// the triangle ranges, the transform and the look
+	struct COMPOUND_PART
+	{
+		std::vector<ShapeMeshes::CAPTURED_RANGE> ranges;
+		glm::mat4 model;
+		PART_LOOK look;
+	};
+
+	// the parts of a compound object sharing a look, baked into
+	// one mesh, and the sphere around it
+	struct MERGED_GROUP
+	{
+		PART_LOOK look;
+		ShapeMeshes::MeshHandle mesh;
+		glm::vec4 bounds;
+	};
+
+	// the original parts of a compound object, kept for editing,
+	// and the merged meshes made from them - bMerged is false when
+	// the parts could not be captured, and bDirty when the merged
+	// meshes have to be made again
+	struct COMPOUND_OBJECT
+	{
+		std::vector<COMPOUND_PART> parts;
+		std::vector<MERGED_GROUP> groups;
+		bool bMerged = false;
+		bool bDirty = false;
+	};
+
+	// draw the compound objects as merged meshes when enabled
+	bool m_bStaticMerging;
+	COMPOUND_OBJECT m_compoundObjects[COMPOUND_OBJECT_COUNT];
+	// the object whose parts are being captured, NULL otherwise
+	COMPOUND_OBJECT* m_pCapturingObject;
+
+	// the pass of the frame being drawn - with the depth pre-pass
+	// on, the depth of the opaque surfaces is laid down first, and
+	// then only the fragments matching it are shaded
+	enum DEPTH_PASS
+	{
+		PASS_SHADING_ONLY,
+		PASS_DEPTH_ONLY,
+		PASS_SHADING_OVER_DEPTH
+	};
+	// draw a depth pre-pass before shading when enabled
+	bool m_bDepthPrePass;
+	DEPTH_PASS m_depthPass;
+	// whether the objects drawn now count in the frame's stats and
+	// ask for their texture levels - only one pass of a frame does
+	bool m_bCountingPass;
+
+	// register a texture image file - it is loaded when first drawn,
+	// reduced to at most maxSize texels across when that is positive
+	bool CreateGLTexture(const char* filename, const std::string& tag, int maxSize = 0);
+	// pack the queued small textures into shared atlas pages
+	void CreateGLTextureAtlases();
+	// upload the textures the background loader has finished
+	void UploadLoadedTextures();
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	int FindTextureID(const std::string& tag);
+	int FindTextureSlot(const std::string& tag);
+	TextureHandle FindTexture(const std::string& tag);
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	MaterialHandle FindMaterial(const std::string& tag);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -87,15 +280,30 @@ private:
 
 	// set the texture data into the shader
 	void SetShaderTexture(
-		std::string textureTag);
+		const std::string& textureTag);
+	void SetShaderTexture(
+		TextureHandle texture);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
 		float u, float v);
 
+	// load the current texture if the current object is in
+	// view, and ask for the mip level its on-screen size needs
+	void RequestTextureLevel();
+
+	// pass the on-screen size of the current object to the
+	// shape meshes, for choosing the detail level to draw
+	void UpdateMeshDetail();
+	// pass the transforms of the current object to the shape
+	// meshes, for culling the clusters of the round shapes
+	void UpdateMeshClusters();
+
 	// set the object material into the shader
 	void SetShaderMaterial(
-		std::string materialTag);
+		const std::string& materialTag);
+	void SetShaderMaterial(
+		MaterialHandle material);
 
 	// loads textures from image files
 	void LoadSceneTextures();
@@ -104,6 +312,36 @@ private:
 
 	void SetupSceneLights();
 
+	// look up the handles of the scene textures and materials
+	void FindSceneHandles();
+
+	// draw every object of the scene - only the counting pass adds
+	// to the draw stats and asks for texture levels
+	void RenderObjects(bool bCountingPass);
+
+	// draw a compound object from its merged meshes, making them
+	// again first if its parts changed, or part by part when it
+	// has none
+	void RenderCompoundObject(COMPOUND_OBJECT_ID object);
+	// call the drawing code of a compound object's parts
+	void RenderCompoundParts(COMPOUND_OBJECT_ID object);
+	// record the parts the drawing code of a compound object draws
+	void CaptureCompoundObject(COMPOUND_OBJECT_ID object);
+	// file the ranges drawn since the last call as a part with the
+	// current transform and look, while capturing
+	void CaptureDrawnPart();
+	// bake the parts of a compound object into one mesh per look
+	void MergeCompoundObject(COMPOUND_OBJECT& object);
+	// whether two parts are drawn the same way
+	static bool IsSameLook(const PART_LOOK& first, const PART_LOOK& second);
+
+	// set the program and depth state the next pass of the frame
+	// is drawn with
+	void BeginDepthPass(DEPTH_PASS pass);
+	// set the depth state of the next draws for an opaque or a
+	// see-through look in the current pass
+	void SetSeeThrough(bool bSeeThrough);
+
 public:
 
 	// The following methods are for the students to 
@@ -111,6 +349,90 @@ public:
 	void PrepareScene();
 	void RenderScene();
 
+	// check whether textures used by the scene are still loading
+	bool IsLoadingTextures() const;
+
+	// upsample and convert baseline JPEG textures on the GPU
+	// instead of the CPU, call before PrepareScene()
+	bool EnableGpuColorConversion();
+
+	// draw the large textures as virtual textures, streaming only the
+	// pages the view needs - call before PrepareScene()
+	bool EnableVirtualTexturing();
+	const VirtualTextureSystem* GetVirtualTextures() const { return m_virtualTextures; }
+
+	// load every texture at no more than the passed in size, for a
+	// low-spec profile - call before PrepareScene()
+	void SetTextureSizeLimit(int maxSize);
+
+	// draw the material patterns in the fragment shader in place of
+	// their textures - call before PrepareScene()
+	void SetProceduralPreset(PROCEDURAL_PRESET preset);
+	// number of noise octaves the patterns use for a preset
+	static int GetPatternOctaves(PROCEDURAL_PRESET preset);
+
+	// store the shape meshes with packed positions, normals and
+	// texture coords - call before PrepareScene()
+	void SetMeshVertexFormat(ShapeMeshes::VertexFormat format);
+
+	// draw the round shapes with fewer triangles where that moves
+	// their outline by no more than the passed in number of pixels,
+	// zero for full detail everywhere
+	void SetMeshErrorBudget(float pixels);
+	// triangles drawn and saved by the mesh detail levels in the
+	// last frame
+	ShapeMeshes::LOD_STATS GetMeshLodStats() const { return(m_basicMeshes->GetLodStats()); }
+
+	// cull the clusters of the round shapes that are out of view or
+	// face away from the camera
+	void SetMeshClusterCulling(bool bCull);
+	// clusters and triangles tested and drawn in the last frame
+	ShapeMeshes::CLUSTER_STATS GetMeshClusterStats() const { return(m_basicMeshes->GetClusterStats()); }
+
+	// load the round shapes from a memory mapped cache file, made
+	// on the first run - call before PrepareScene()
+	bool EnableMeshCache(const char* filename);
+
+	// draw the sphere, cylinders and torus from coarse patches that
+	// the GPU refines until each edge covers about the passed in
+	// number of pixels - call before PrepareScene().  Returns false
+	// if the tessellation shaders do not build
+	bool EnableTessellation(float edgePixels);
+
+	// make the box, plane, sphere, cylinders, cone and torus in the
+	// vertex shader from their type and tessellation, with no vertex
+	// data - call before PrepareScene().  Returns false if the
+	// bufferless shaders do not build
+	bool EnableBufferless();
+
+	// bake the parts of the laptop, lamp and books sharing a texture
+	// or color and material into one mesh each, so each object takes
+	// a draw per look instead of one per part - call before
+	// PrepareScene()
+	void EnableStaticMerging();
+	// the original parts of a compound object, for editing - moving
+	// a part makes the object's merged meshes again before it is
+	// next drawn
+	int GetCompoundPartCount(COMPOUND_OBJECT_ID object) const;
+	glm::mat4 GetCompoundPartModel(COMPOUND_OBJECT_ID object, int part) const;
+	void SetCompoundPartModel(COMPOUND_OBJECT_ID object, int part, const glm::mat4& model);
+	// the draws a compound object takes part by part and merged
+	int GetCompoundPartDraws(COMPOUND_OBJECT_ID object) const;
+	int GetCompoundMergedDraws(COMPOUND_OBJECT_ID object) const;
+
+	// lay down the depth of the scene with a trivial program before
+	// shading it, so the lighting runs once for each pixel that is
+	// seen instead of for every surface drawn over it.  Returns false
+	// if the depth shaders do not build
+	bool EnableDepthPrePass();
+	void DisableDepthPrePass();
+
+	// set the view the next frame is rendered with
+	void SetSceneView(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		int viewportHeight);
+
 	//renders room
 	void RenderRoom();
 
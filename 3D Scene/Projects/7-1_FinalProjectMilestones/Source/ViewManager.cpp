@@ -52,6 +52,8 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 24.0f, 12.0f);
@@ -289,4 +291,18 @@ void ViewManager::PrepareSceneView()
 		// set the view position of the camera into the shader for proper rendering
 		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
 	}
+
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+}
+
+/***********************************************************
+ *  GetViewportHeight()
+ *
+ *  This method is used for getting the height in pixels of
+ *  the display window the scene is rendered into.
+ ***********************************************************/
+int ViewManager::GetViewportHeight() const
+{
+	return(WINDOW_HEIGHT);
 }
\ No newline at end of file
@@ -46,4 +46,14 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// view and projection of the latest prepared frame
+	const glm::mat4& GetViewMatrix() const { return m_viewMatrix; }
+	const glm::mat4& GetProjectionMatrix() const { return m_projectionMatrix; }
+	// height of the display window in pixels
+	int GetViewportHeight() const;
+
+private:
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
 };
\ No newline at end of file
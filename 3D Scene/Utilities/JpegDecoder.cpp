@@ -0,0 +1,1894 @@
+///////////////////////////////////////////////////////////////////////////////
+// jpegdecoder.cpp
+// ============
+// decode baseline JPEG images with SIMD kernels and restart interval threads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JpegDecoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+// pick the widest kernels the compiler was allowed to target -
+// x64 always has SSE2, AVX2 needs /arch:AVX2 or -mavx2, which the
+// project sets in every configuration.  MSVC never defines
+// __SSE4_1__, so the SSE4.1 kernels also follow __AVX__, which it
+// defines for /arch:AVX and /arch:AVX2
+#if defined(__AVX2__)
+#define JPEG_USE_AVX2
+#endif
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define JPEG_USE_SSE41
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define JPEG_USE_SSE2
+#endif
+
+#if defined(JPEG_USE_AVX2) || defined(JPEG_USE_SSE41) || defined(JPEG_USE_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// bits looked up at once when decoding Huffman codes
+	const int FAST_BITS = 9;
+	// blocks collected before they are transformed together
+	const int BLOCK_BATCH = 32;
+	// images with fewer rows than this are not worth splitting
+	const int MIN_ROWS_PER_THREAD = 32;
+
+	// natural order index of each zigzag position, with extra
+	// entries so a corrupt run length cannot index past a block
+	const unsigned char DEZIGZAG[64 + 15] = {
+		0, 1, 8, 16, 9, 2, 3, 10,
+		17, 24, 32, 25, 18, 11, 4, 5,
+		12, 19, 26, 33, 40, 48, 41, 34,
+		27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36,
+		29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46,
+		53, 60, 61, 54, 47, 55, 62, 63,
+		63, 63, 63, 63, 63, 63, 63, 63,
+		63, 63, 63, 63, 63, 63, 63 };
+
+	// a Huffman table with a lookup of the short codes
+	struct HUFFMAN_TABLE
+	{
+		bool bDefined;
+		unsigned char fast[1 << FAST_BITS];		// symbol index of short codes, 255 if longer
+		short fastAc[1 << FAST_BITS];			// AC run, length and value of short codes, 0 if none
+		unsigned short code[256];
+		unsigned char values[256];
+		unsigned char size[257];
+		unsigned int maxCode[18];				// largest code of each length, shifted to 16 bits
+		int delta[17];							// symbol index minus code of each length
+	};
+
+	// one color component of the frame
+	struct COMPONENT
+	{
+		int id;
+		int h;
+		int v;
+		int quantTable;
+		int width;			// samples covered by the image, after DCT scaling
+		int height;
+		int blocksX;		// blocks covered by the image
+		int blocksY;
+		int planeWidth;		// samples padded to whole MCUs, after DCT scaling
+		int planeHeight;
+		std::vector<unsigned char> plane;
+	};
+
+	// everything parsed from the markers so far
+	struct FRAME
+	{
+		int width;			// output size, after DCT scaling
+		int height;
+		int maxSize;		// largest output size asked for, 0 for the full size
+		int scaleShift;		// blocks are transformed to 8 >> scaleShift samples
+		int componentCount;
+		int hMax;
+		int vMax;
+		int mcusX;
+		int mcusY;
+		int restartInterval;
+		bool bJfif;
+		int adobeTransform;
+		COMPONENT components[3];
+		unsigned short quant[4][64];			// natural order
+		HUFFMAN_TABLE dcTables[4];
+		HUFFMAN_TABLE acTables[4];
+	};
+
+	// the components and entropy coded data of one scan
+	struct SCAN
+	{
+		int componentCount;
+		int components[3];
+		int dcTables[3];
+		int acTables[3];
+		int mcusX;			// MCUs per row, blocks of the one component if not interleaved
+		int mcusY;
+	};
+
+	// reads bits of entropy coded data, with stuffed zero bytes removed
+	struct BIT_READER
+	{
+		const unsigned char* position;
+		const unsigned char* end;
+		unsigned long long buffer;	// next bits at the top
+		int bits;
+		bool bMarker;
+	};
+
+	// blocks waiting for their inverse DCT
+	struct BLOCK_BATCH_DATA
+	{
+		alignas(32) short coefficients[BLOCK_BATCH][64];
+		unsigned char* outputs[BLOCK_BATCH];
+		int strides[BLOCK_BATCH];
+		int count;
+	};
+
+	// IDCT constants scaled by 4096, like the IJG integer IDCT
+	inline int FixedPoint(float x)
+	{
+		return((int)((x * 4096.0f) + 0.5f));
+	}
+
+	inline unsigned char ClampByte(int x)
+	{
+		return((unsigned char)std::min(255, std::max(0, x)));
+	}
+
+	// samples left of a size after a power of two reduction
+	inline int ScaledSize(int size, int shift)
+	{
+		return((size + (1 << shift) - 1) >> shift);
+	}
+
+	// run a function over row ranges split between threads
+	void ParallelRows(int rows, int threadCount, const std::function<void(int, int)>& function)
+	{
+		int threads = std::min(threadCount, std::max(1, rows / MIN_ROWS_PER_THREAD));
+		if (threads <= 1)
+		{
+			function(0, rows);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; i++)
+		{
+			int firstRow = (rows * i) / threads;
+			int lastRow = (rows * (i + 1)) / threads;
+			workers.push_back(std::thread(function, firstRow, lastRow));
+		}
+		for (int i = 0; i < (int)workers.size(); i++)
+		{
+			workers[i].join();
+		}
+	}
+
+	///////////////////////////////////////////////////////////
+	// marker parsing
+	///////////////////////////////////////////////////////////
+
+	// big endian 16 bit value
+	inline int Read16(const unsigned char* data)
+	{
+		return((data[0] << 8) | data[1]);
+	}
+
+	// build the code and lookup tables of a Huffman table
+	bool BuildHuffmanTable(HUFFMAN_TABLE& table, const unsigned char* counts, bool bAcTable)
+	{
+		int k = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			for (int j = 0; j < counts[i]; j++)
+			{
+				table.size[k++] = (unsigned char)(i + 1);
+			}
+		}
+		table.size[k] = 0;
+
+		// canonical codes, in order of length
+		unsigned int code = 0;
+		k = 0;
+		for (int j = 1; j <= 16; j++)
+		{
+			table.delta[j] = k - (int)code;
+			if (table.size[k] == j)
+			{
+				while (table.size[k] == j)
+				{
+					table.code[k++] = (unsigned short)(code++);
+				}
+				if ((code - 1) >= (1u << j))
+				{
+					return(false);
+				}
+			}
+			table.maxCode[j] = code << (16 - j);
+			code <<= 1;
+		}
+		table.maxCode[17] = 0xffffffff;
+
+		memset(table.fast, 255, sizeof(table.fast));
+		for (int i = 0; i < k; i++)
+		{
+			int size = table.size[i];
+			if (size <= FAST_BITS)
+			{
+				int first = table.code[i] << (FAST_BITS - size);
+				int count = 1 << (FAST_BITS - size);
+				for (int j = 0; j < count; j++)
+				{
+					table.fast[first + j] = (unsigned char)i;
+				}
+			}
+		}
+
+		// AC codes whose value bits also fit in the lookup are
+		// decoded completely by one lookup
+		memset(table.fastAc, 0, sizeof(table.fastAc));
+		if (bAcTable == true)
+		{
+			for (int i = 0; i < (1 << FAST_BITS); i++)
+			{
+				int fast = table.fast[i];
+				if (fast == 255)
+				{
+					continue;
+				}
+				int runSize = table.values[fast];
+				int run = (runSize >> 4) & 15;
+				int magnitudeBits = runSize & 15;
+				int length = table.size[fast];
+				if ((magnitudeBits != 0) && ((length + magnitudeBits) <= FAST_BITS))
+				{
+					int value = ((i << length) & ((1 << FAST_BITS) - 1)) >> (FAST_BITS - magnitudeBits);
+					if (value < (1 << (magnitudeBits - 1)))
+					{
+						value -= (1 << magnitudeBits) - 1;
+					}
+					if ((value >= -128) && (value <= 127))
+					{
+						table.fastAc[i] = (short)((value * 256) + (run * 16) + (length + magnitudeBits));
+					}
+				}
+			}
+		}
+
+		table.bDefined = true;
+		return(true);
+	}
+
+	// DHT - one or more Huffman tables
+	bool ParseHuffmanTables(FRAME& frame, const unsigned char* data, int length)
+	{
+		while (length > 0)
+		{
+			if (length < 17)
+			{
+				return(false);
+			}
+			int tableClass = data[0] >> 4;
+			int tableIndex = data[0] & 15;
+			if ((tableClass > 1) || (tableIndex > 3))
+			{
+				return(false);
+			}
+			const unsigned char* counts = data + 1;
+			int symbolCount = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				symbolCount += counts[i];
+			}
+			if ((symbolCount > 256) || (length < (17 + symbolCount)))
+			{
+				return(false);
+			}
+
+			HUFFMAN_TABLE& table = (tableClass == 0) ? frame.dcTables[tableIndex] : frame.acTables[tableIndex];
+			memcpy(table.values, data + 17, symbolCount);
+			if (BuildHuffmanTable(table, counts, tableClass == 1) == false)
+			{
+				return(false);
+			}
+
+			data += 17 + symbolCount;
+			length -= 17 + symbolCount;
+		}
+		return(true);
+	}
+
+	// DQT - one or more quantization tables, 8 or 16 bit
+	bool ParseQuantTables(FRAME& frame, const unsigned char* data, int length)
+	{
+		while (length > 0)
+		{
+			bool bSixteenBit = (data[0] >> 4) != 0;
+			int tableIndex = data[0] & 15;
+			int tableLength = bSixteenBit ? 129 : 65;
+			if ((tableIndex > 3) || (length < tableLength))
+			{
+				return(false);
+			}
+			for (int i = 0; i < 64; i++)
+			{
+				int value = bSixteenBit ? Read16(data + 1 + (i * 2)) : data[1 + i];
+				frame.quant[tableIndex][DEZIGZAG[i]] = (unsigned short)value;
+			}
+			data += tableLength;
+			length -= tableLength;
+		}
+		return(true);
+	}
+
+	// SOF0/SOF1 - image size and components
+	bool ParseFrameHeader(FRAME& frame, const unsigned char* data, int length)
+	{
+		if ((length < 6) || (data[0] != 8))
+		{
+			return(false);
+		}
+		int fullHeight = Read16(data + 1);
+		int fullWidth = Read16(data + 3);
+		frame.componentCount = data[5];
+		// zero height means a DNL marker, which is not supported
+		if ((fullWidth == 0) || (fullHeight == 0) ||
+			((frame.componentCount != 1) && (frame.componentCount != 3)) ||
+			(length < (6 + (frame.componentCount * 3))))
+		{
+			return(false);
+		}
+
+		frame.hMax = 1;
+		frame.vMax = 1;
+		for (int i = 0; i < frame.componentCount; i++)
+		{
+			COMPONENT& component = frame.components[i];
+			component.id = data[6 + (i * 3)];
+			component.h = data[7 + (i * 3)] >> 4;
+			component.v = data[7 + (i * 3)] & 15;
+			component.quantTable = data[8 + (i * 3)];
+			if ((component.h < 1) || (component.h > 2) || (component.v < 1) || (component.v > 2) || (component.quantTable > 3))
+			{
+				return(false);
+			}
+			frame.hMax = std::max(frame.hMax, component.h);
+			frame.vMax = std::max(frame.vMax, component.v);
+		}
+
+		int mcuWidth = frame.hMax * 8;
+		int mcuHeight = frame.vMax * 8;
+		frame.mcusX = (fullWidth + mcuWidth - 1) / mcuWidth;
+		frame.mcusY = (fullHeight + mcuHeight - 1) / mcuHeight;
+
+		// the smallest power of two reduction that fits the size
+		// asked for, with the 1/8 reduction as the limit
+		int shift = 0;
+		if (frame.maxSize > 0)
+		{
+			while ((shift < 3) && (ScaledSize(std::max(fullWidth, fullHeight), shift) > frame.maxSize))
+			{
+				shift++;
+			}
+		}
+		frame.scaleShift = shift;
+		frame.width = ScaledSize(fullWidth, shift);
+		frame.height = ScaledSize(fullHeight, shift);
+
+		int blockSize = 8 >> shift;
+		for (int i = 0; i < frame.componentCount; i++)
+		{
+			COMPONENT& component = frame.components[i];
+			int componentWidth = ((fullWidth * component.h) + frame.hMax - 1) / frame.hMax;
+			int componentHeight = ((fullHeight * component.v) + frame.vMax - 1) / frame.vMax;
+			component.blocksX = (componentWidth + 7) >> 3;
+			component.blocksY = (componentHeight + 7) >> 3;
+			component.width = ScaledSize(componentWidth, shift);
+			component.height = ScaledSize(componentHeight, shift);
+			component.planeWidth = frame.mcusX * component.h * blockSize;
+			component.planeHeight = frame.mcusY * component.v * blockSize;
+			component.plane.assign((size_t)component.planeWidth * component.planeHeight, 0);
+		}
+		return(true);
+	}
+
+	// SOS - components and tables of a scan
+	bool ParseScanHeader(const FRAME& frame, const unsigned char* data, int length, SCAN& scan)
+	{
+		if ((frame.componentCount == 0) || (length < 1))
+		{
+			return(false);
+		}
+		scan.componentCount = data[0];
+		if ((scan.componentCount < 1) || (scan.componentCount > frame.componentCount) ||
+			(length != (4 + (scan.componentCount * 2))))
+		{
+			return(false);
+		}
+
+		for (int i = 0; i < scan.componentCount; i++)
+		{
+			int id = data[1 + (i * 2)];
+			int tables = data[2 + (i * 2)];
+			int index = -1;
+			for (int c = 0; c < frame.componentCount; c++)
+			{
+				if (frame.components[c].id == id)
+				{
+					index = c;
+				}
+			}
+			scan.components[i] = index;
+			scan.dcTables[i] = tables >> 4;
+			scan.acTables[i] = tables & 15;
+			if ((index < 0) || (scan.dcTables[i] > 3) || (scan.acTables[i] > 3) ||
+				(frame.dcTables[scan.dcTables[i]].bDefined == false) ||
+				(frame.acTables[scan.acTables[i]].bDefined == false))
+			{
+				return(false);
+			}
+		}
+
+		// sequential scans cover every coefficient at full precision
+		const unsigned char* spectral = data + 1 + (scan.componentCount * 2);
+		if ((spectral[0] != 0) || (spectral[2] != 0))
+		{
+			return(false);
+		}
+
+		if (scan.componentCount == 1)
+		{
+			// a single component is stored in its own block order
+			const COMPONENT& component = frame.components[scan.components[0]];
+			scan.mcusX = component.blocksX;
+			scan.mcusY = component.blocksY;
+		}
+		else
+		{
+			scan.mcusX = frame.mcusX;
+			scan.mcusY = frame.mcusY;
+		}
+		return(true);
+	}
+
+	///////////////////////////////////////////////////////////
+	// entropy decoding
+	///////////////////////////////////////////////////////////
+
+	// top up the bit buffer to at least 57 bits, past the end
+	// of the data or at a marker zeros are read
+	inline void RefillBits(BIT_READER& reader)
+	{
+		while (reader.bits <= 56)
+		{
+			unsigned int byte = 0;
+			if ((reader.bMarker == false) && (reader.position < reader.end))
+			{
+				byte = *reader.position++;
+				if (byte == 0xFF)
+				{
+					// a data 0xFF is followed by a stuffed zero
+					if ((reader.position < reader.end) && (*reader.position == 0x00))
+					{
+						reader.position++;
+					}
+					else
+					{
+						reader.bMarker = true;
+						byte = 0;
+					}
+				}
+			}
+			reader.buffer |= (unsigned long long)byte << (56 - reader.bits);
+			reader.bits += 8;
+		}
+	}
+
+	// decode one Huffman coded symbol, -1 for a bad code
+	inline int DecodeSymbol(BIT_READER& reader, const HUFFMAN_TABLE& table)
+	{
+		if (reader.bits < 16)
+		{
+			RefillBits(reader);
+		}
+
+		int k = table.fast[reader.buffer >> (64 - FAST_BITS)];
+		if (k < 255)
+		{
+			int size = table.size[k];
+			reader.buffer <<= size;
+			reader.bits -= size;
+			return(table.values[k]);
+		}
+
+		// longer codes are found by comparing against the largest
+		// code of each length
+		unsigned int top = (unsigned int)(reader.buffer >> 48);
+		for (k = FAST_BITS + 1; top >= table.maxCode[k]; k++)
+		{
+		}
+		if (k == 17)
+		{
+			return(-1);
+		}
+
+		int index = (int)(reader.buffer >> (64 - k)) + table.delta[k];
+		if ((index < 0) || (index >= 256))
+		{
+			return(-1);
+		}
+		reader.buffer <<= k;
+		reader.bits -= k;
+		return(table.values[index]);
+	}
+
+	// read an n bit value and extend its sign
+	inline int ReceiveExtend(BIT_READER& reader, int n)
+	{
+		if (reader.bits < n)
+		{
+			RefillBits(reader);
+		}
+		int value = (int)(reader.buffer >> (64 - n));
+		reader.buffer <<= n;
+		reader.bits -= n;
+		// values with a clear top bit are negative
+		if (value < (1 << (n - 1)))
+		{
+			value -= (1 << n) - 1;
+		}
+		return(value);
+	}
+
+	// decode and dequantize the coefficients of one block
+	bool DecodeBlock(
+		BIT_READER& reader,
+		const HUFFMAN_TABLE& dcTable,
+		const HUFFMAN_TABLE& acTable,
+		const unsigned short* quant,
+		int& dcPrediction,
+		short* coefficients)
+	{
+		memset(coefficients, 0, 64 * sizeof(short));
+
+		int size = DecodeSymbol(reader, dcTable);
+		if ((size < 0) || (size > 15))
+		{
+			return(false);
+		}
+		int difference = (size != 0) ? ReceiveExtend(reader, size) : 0;
+		dcPrediction += difference;
+		coefficients[0] = (short)(dcPrediction * quant[0]);
+
+		int k = 1;
+		do
+		{
+			if (reader.bits < 16)
+			{
+				RefillBits(reader);
+			}
+			int fast = acTable.fastAc[reader.buffer >> (64 - FAST_BITS)];
+			if (fast != 0)
+			{
+				k += (fast >> 4) & 15;
+				int length = fast & 15;
+				reader.buffer <<= length;
+				reader.bits -= length;
+				int zig = DEZIGZAG[k++];
+				coefficients[zig] = (short)((fast >> 8) * quant[zig]);
+			}
+			else
+			{
+				int runSize = DecodeSymbol(reader, acTable);
+				if (runSize < 0)
+				{
+					return(false);
+				}
+				int magnitudeBits = runSize & 15;
+				int run = runSize >> 4;
+				if (magnitudeBits == 0)
+				{
+					// end of block, or a run of 16 zeros
+					if (runSize != 0xF0)
+					{
+						break;
+					}
+					k += 16;
+				}
+				else
+				{
+					k += run;
+					int zig = DEZIGZAG[k++];
+					coefficients[zig] = (short)(ReceiveExtend(reader, magnitudeBits) * quant[zig]);
+				}
+			}
+		} while (k < 64);
+
+		return(true);
+	}
+
+	///////////////////////////////////////////////////////////
+	// inverse DCT - the IJG integer IDCT with 12 bit constants,
+	// every kernel gives the same result as the scalar one
+	///////////////////////////////////////////////////////////
+
+#if !defined(JPEG_USE_SSE2)
+	// one dimensional IDCT of eight values, scaled by 4096
+	inline void Idct1D(
+		int s0, int s1, int s2, int s3, int s4, int s5, int s6, int s7,
+		int& x0, int& x1, int& x2, int& x3, int& t0, int& t1, int& t2, int& t3)
+	{
+		// even part
+		int p2 = s2;
+		int p3 = s6;
+		int p1 = (p2 + p3) * FixedPoint(0.5411961f);
+		t2 = p1 + (p3 * FixedPoint(-1.847759065f));
+		t3 = p1 + (p2 * FixedPoint(0.765366865f));
+		t0 = (s0 + s4) * 4096;
+		t1 = (s0 - s4) * 4096;
+		x0 = t0 + t3;
+		x3 = t0 - t3;
+		x1 = t1 + t2;
+		x2 = t1 - t2;
+
+		// odd part
+		t0 = s7;
+		t1 = s5;
+		t2 = s3;
+		t3 = s1;
+		p3 = t0 + t2;
+		int p4 = t1 + t3;
+		p1 = t0 + t3;
+		p2 = t1 + t2;
+		int p5 = (p3 + p4) * FixedPoint(1.175875602f);
+		t0 = t0 * FixedPoint(0.298631336f);
+		t1 = t1 * FixedPoint(2.053119869f);
+		t2 = t2 * FixedPoint(3.072711026f);
+		t3 = t3 * FixedPoint(1.501321110f);
+		p1 = p5 + (p1 * FixedPoint(-0.899976223f));
+		p2 = p5 + (p2 * FixedPoint(-2.562915447f));
+		p3 = p3 * FixedPoint(-1.961570560f);
+		p4 = p4 * FixedPoint(-0.390180644f);
+		t3 += p1 + p4;
+		t2 += p2 + p3;
+		t1 += p2 + p4;
+		t0 += p1 + p3;
+	}
+
+	// reference IDCT of one block
+	void IdctBlockScalar(const short* coefficients, unsigned char* output, int stride)
+	{
+		int values[64];
+		int x0, x1, x2, x3, t0, t1, t2, t3;
+
+		// columns, keeping 2 extra bits of precision
+		for (int i = 0; i < 8; i++)
+		{
+			const short* d = coefficients + i;
+			int* v = values + i;
+			Idct1D(d[0], d[8], d[16], d[24], d[32], d[40], d[48], d[56], x0, x1, x2, x3, t0, t1, t2, t3);
+			x0 += 512;
+			x1 += 512;
+			x2 += 512;
+			x3 += 512;
+			v[0] = (x0 + t3) >> 10;
+			v[56] = (x0 - t3) >> 10;
+			v[8] = (x1 + t2) >> 10;
+			v[48] = (x1 - t2) >> 10;
+			v[16] = (x2 + t1) >> 10;
+			v[40] = (x2 - t1) >> 10;
+			v[24] = (x3 + t0) >> 10;
+			v[32] = (x3 - t0) >> 10;
+		}
+
+		// rows, removing the 1 << 17 scale with rounding and
+		// moving -128..127 to 0..255
+		for (int i = 0; i < 8; i++)
+		{
+			const int* v = values + (i * 8);
+			unsigned char* o = output + (i * stride);
+			Idct1D(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], x0, x1, x2, x3, t0, t1, t2, t3);
+			x0 += 65536 + (128 << 17);
+			x1 += 65536 + (128 << 17);
+			x2 += 65536 + (128 << 17);
+			x3 += 65536 + (128 << 17);
+			o[0] = ClampByte((x0 + t3) >> 17);
+			o[7] = ClampByte((x0 - t3) >> 17);
+			o[1] = ClampByte((x1 + t2) >> 17);
+			o[6] = ClampByte((x1 - t2) >> 17);
+			o[2] = ClampByte((x2 + t1) >> 17);
+			o[5] = ClampByte((x2 - t1) >> 17);
+			o[3] = ClampByte((x3 + t0) >> 17);
+			o[4] = ClampByte((x3 - t0) >> 17);
+		}
+	}
+#endif
+
+#if defined(JPEG_USE_SSE2)
+	// integer vector operations the IDCT kernel is written with,
+	// the 256 bit ones work on two blocks, one in each 128 bit lane
+	template<int BITS>
+	struct SIMD_VECTOR;
+
+	template<>
+	struct SIMD_VECTOR<128>
+	{
+		typedef __m128i TYPE;
+		static TYPE Zero() { return(_mm_setzero_si128()); }
+		static TYPE Set32(int x) { return(_mm_set1_epi32(x)); }
+		static TYPE SetPair16(int x, int y) { return(_mm_setr_epi16((short)x, (short)y, (short)x, (short)y, (short)x, (short)y, (short)x, (short)y)); }
+		static TYPE Add16(TYPE a, TYPE b) { return(_mm_add_epi16(a, b)); }
+		static TYPE Sub16(TYPE a, TYPE b) { return(_mm_sub_epi16(a, b)); }
+		static TYPE Add32(TYPE a, TYPE b) { return(_mm_add_epi32(a, b)); }
+		static TYPE Sub32(TYPE a, TYPE b) { return(_mm_sub_epi32(a, b)); }
+		static TYPE Shift32(TYPE a, int bits) { return(_mm_sra_epi32(a, _mm_cvtsi32_si128(bits))); }
+		static TYPE Madd16(TYPE a, TYPE b) { return(_mm_madd_epi16(a, b)); }
+		static TYPE Pack32(TYPE a, TYPE b) { return(_mm_packs_epi32(a, b)); }
+		static TYPE PackBytes(TYPE a, TYPE b) { return(_mm_packus_epi16(a, b)); }
+		static TYPE UnpackLow16(TYPE a, TYPE b) { return(_mm_unpacklo_epi16(a, b)); }
+		static TYPE UnpackHigh16(TYPE a, TYPE b) { return(_mm_unpackhi_epi16(a, b)); }
+		static TYPE UnpackLow8(TYPE a, TYPE b) { return(_mm_unpacklo_epi8(a, b)); }
+		static TYPE UnpackHigh8(TYPE a, TYPE b) { return(_mm_unpackhi_epi8(a, b)); }
+		static TYPE SwapHalves(TYPE a) { return(_mm_shuffle_epi32(a, 0x4e)); }
+	};
+
+#if defined(JPEG_USE_AVX2)
+	template<>
+	struct SIMD_VECTOR<256>
+	{
+		typedef __m256i TYPE;
+		static TYPE Zero() { return(_mm256_setzero_si256()); }
+		static TYPE Set32(int x) { return(_mm256_set1_epi32(x)); }
+		static TYPE SetPair16(int x, int y) { return(_mm256_set1_epi32((int)((unsigned short)x | ((unsigned int)(unsigned short)y << 16)))); }
+		static TYPE Add16(TYPE a, TYPE b) { return(_mm256_add_epi16(a, b)); }
+		static TYPE Sub16(TYPE a, TYPE b) { return(_mm256_sub_epi16(a, b)); }
+		static TYPE Add32(TYPE a, TYPE b) { return(_mm256_add_epi32(a, b)); }
+		static TYPE Sub32(TYPE a, TYPE b) { return(_mm256_sub_epi32(a, b)); }
+		static TYPE Shift32(TYPE a, int bits) { return(_mm256_sra_epi32(a, _mm_cvtsi32_si128(bits))); }
+		static TYPE Madd16(TYPE a, TYPE b) { return(_mm256_madd_epi16(a, b)); }
+		static TYPE Pack32(TYPE a, TYPE b) { return(_mm256_packs_epi32(a, b)); }
+		static TYPE PackBytes(TYPE a, TYPE b) { return(_mm256_packus_epi16(a, b)); }
+		static TYPE UnpackLow16(TYPE a, TYPE b) { return(_mm256_unpacklo_epi16(a, b)); }
+		static TYPE UnpackHigh16(TYPE a, TYPE b) { return(_mm256_unpackhi_epi16(a, b)); }
+		static TYPE UnpackLow8(TYPE a, TYPE b) { return(_mm256_unpacklo_epi8(a, b)); }
+		static TYPE UnpackHigh8(TYPE a, TYPE b) { return(_mm256_unpackhi_epi8(a, b)); }
+		static TYPE SwapHalves(TYPE a) { return(_mm256_shuffle_epi32(a, 0x4e)); }
+	};
+#endif
+
+	// 32 bit values of the low and high four 16 bit lanes
+	template<int BITS>
+	struct WIDE
+	{
+		typename SIMD_VECTOR<BITS>::TYPE low;
+		typename SIMD_VECTOR<BITS>::TYPE high;
+	};
+
+	template<int BITS>
+	inline WIDE<BITS> WideAdd(const WIDE<BITS>& a, const WIDE<BITS>& b)
+	{
+		typedef SIMD_VECTOR<BITS> S;
+		WIDE<BITS> result = { S::Add32(a.low, b.low), S::Add32(a.high, b.high) };
+		return(result);
+	}
+
+	template<int BITS>
+	inline WIDE<BITS> WideSub(const WIDE<BITS>& a, const WIDE<BITS>& b)
+	{
+		typedef SIMD_VECTOR<BITS> S;
+		WIDE<BITS> result = { S::Sub32(a.low, b.low), S::Sub32(a.high, b.high) };
+		return(result);
+	}
+
+	// 16 bit values times 4096
+	template<int BITS>
+	inline WIDE<BITS> Widen(typename SIMD_VECTOR<BITS>::TYPE x)
+	{
+		typedef SIMD_VECTOR<BITS> S;
+		WIDE<BITS> result = {
+			S::Shift32(S::UnpackLow16(S::Zero(), x), 4),
+			S::Shift32(S::UnpackHigh16(S::Zero(), x), 4) };
+		return(result);
+	}
+
+	// x * c[even] + y * c[odd] for two constant pairs
+	template<int BITS>
+	inline void Rotate(
+		typename SIMD_VECTOR<BITS>::TYPE x,
+		typename SIMD_VECTOR<BITS>::TYPE y,
+		typename SIMD_VECTOR<BITS>::TYPE c0,
+		typename SIMD_VECTOR<BITS>::TYPE c1,
+		WIDE<BITS>& out0,
+		WIDE<BITS>& out1)
+	{
+		typedef SIMD_VECTOR<BITS> S;
+		typename S::TYPE low = S::UnpackLow16(x, y);
+		typename S::TYPE high = S::UnpackHigh16(x, y);
+		out0.low = S::Madd16(low, c0);
+		out0.high = S::Madd16(high, c0);
+		out1.low = S::Madd16(low, c1);
+		out1.high = S::Madd16(high, c1);
+	}
+
+	// (a + bias +- b) >> shift, packed back to 16 bits
+	template<int BITS>
+	inline void Butterfly(
+		const WIDE<BITS>& a,
+		const WIDE<BITS>& b,
+		typename SIMD_VECTOR<BITS>::TYPE bias,
+		int shift,
+		typename SIMD_VECTOR<BITS>::TYPE& out0,
+		typename SIMD_VECTOR<BITS>::TYPE& out1)
+	{
+		typedef SIMD_VECTOR<BITS> S;
+		WIDE<BITS> biased = { S::Add32(a.low, bias), S::Add32(a.high, bias) };
+		WIDE<BITS> sum = WideAdd<BITS>(biased, b);
+		WIDE<BITS> difference = WideSub<BITS>(biased, b);
+		out0 = S::Pack32(S::Shift32(sum.low, shift), S::Shift32(sum.high, shift));
+		out1 = S::Pack32(S::Shift32(difference.low, shift), S::Shift32(difference.high, shift));
+	}
+
+	// one IDCT pass over the eight rows, in place
+	template<int BITS>
+	inline void IdctPass(typename SIMD_VECTOR<BITS>::TYPE* row, typename SIMD_VECTOR<BITS>::TYPE bias, int shift)
+	{
+		typedef SIMD_VECTOR<BITS> S;
+		const typename S::TYPE rotation0_0 = S::SetPair16(FixedPoint(0.5411961f), FixedPoint(0.5411961f) + FixedPoint(-1.847759065f));
+		const typename S::TYPE rotation0_1 = S::SetPair16(FixedPoint(0.5411961f) + FixedPoint(0.765366865f), FixedPoint(0.5411961f));
+		const typename S::TYPE rotation1_0 = S::SetPair16(FixedPoint(1.175875602f) + FixedPoint(-0.899976223f), FixedPoint(1.175875602f));
+		const typename S::TYPE rotation1_1 = S::SetPair16(FixedPoint(1.175875602f), FixedPoint(1.175875602f) + FixedPoint(-2.562915447f));
+		const typename S::TYPE rotation2_0 = S::SetPair16(FixedPoint(-1.961570560f) + FixedPoint(0.298631336f), FixedPoint(-1.961570560f));
+		const typename S::TYPE rotation2_1 = S::SetPair16(FixedPoint(-1.961570560f), FixedPoint(-1.961570560f) + FixedPoint(3.072711026f));
+		const typename S::TYPE rotation3_0 = S::SetPair16(FixedPoint(-0.390180644f) + FixedPoint(2.053119869f), FixedPoint(-0.390180644f));
+		const typename S::TYPE rotation3_1 = S::SetPair16(FixedPoint(-0.390180644f), FixedPoint(-0.390180644f) + FixedPoint(1.501321110f));
+
+		// even part
+		WIDE<BITS> t2e, t3e;
+		Rotate<BITS>(row[2], row[6], rotation0_0, rotation0_1, t2e, t3e);
+		WIDE<BITS> t0e = Widen<BITS>(S::Add16(row[0], row[4]));
+		WIDE<BITS> t1e = Widen<BITS>(S::Sub16(row[0], row[4]));
+		WIDE<BITS> x0 = WideAdd<BITS>(t0e, t3e);
+		WIDE<BITS> x3 = WideSub<BITS>(t0e, t3e);
+		WIDE<BITS> x1 = WideAdd<BITS>(t1e, t2e);
+		WIDE<BITS> x2 = WideSub<BITS>(t1e, t2e);
+
+		// odd part
+		WIDE<BITS> y0o, y1o, y2o, y3o, y4o, y5o;
+		Rotate<BITS>(row[7], row[3], rotation2_0, rotation2_1, y0o, y2o);
+		Rotate<BITS>(row[5], row[1], rotation3_0, rotation3_1, y1o, y3o);
+		Rotate<BITS>(S::Add16(row[1], row[7]), S::Add16(row[3], row[5]), rotation1_0, rotation1_1, y4o, y5o);
+		WIDE<BITS> x4 = WideAdd<BITS>(y0o, y4o);
+		WIDE<BITS> x5 = WideAdd<BITS>(y1o, y5o);
+		WIDE<BITS> x6 = WideAdd<BITS>(y2o, y5o);
+		WIDE<BITS> x7 = WideAdd<BITS>(y3o, y4o);
+
+		Butterfly<BITS>(x0, x7, bias, shift, row[0], row[7]);
+		Butterfly<BITS>(x1, x6, bias, shift, row[1], row[6]);
+		Butterfly<BITS>(x2, x5, bias, shift, row[2], row[5]);
+		Butterfly<BITS>(x3, x4, bias, shift, row[3], row[4]);
+	}
+
+	// interleave step of the transposes
+	template<int BITS>
+	inline void Interleave16(typename SIMD_VECTOR<BITS>::TYPE& a, typename SIMD_VECTOR<BITS>::TYPE& b)
+	{
+		typename SIMD_VECTOR<BITS>::TYPE first = a;
+		a = SIMD_VECTOR<BITS>::UnpackLow16(first, b);
+		b = SIMD_VECTOR<BITS>::UnpackHigh16(first, b);
+	}
+
+	template<int BITS>
+	inline void Interleave8(typename SIMD_VECTOR<BITS>::TYPE& a, typename SIMD_VECTOR<BITS>::TYPE& b)
+	{
+		typename SIMD_VECTOR<BITS>::TYPE first = a;
+		a = SIMD_VECTOR<BITS>::UnpackLow8(first, b);
+		b = SIMD_VECTOR<BITS>::UnpackHigh8(first, b);
+	}
+
+	// full 2D IDCT of the coefficient rows, the low 8 bytes of
+	// each output hold one row of pixels
+	template<int BITS>
+	inline void IdctRows(typename SIMD_VECTOR<BITS>::TYPE* row, typename SIMD_VECTOR<BITS>::TYPE* output)
+	{
+		typedef SIMD_VECTOR<BITS> S;
+
+		// columns keep 2 extra bits, rows remove the 1 << 17
+		// scale with rounding and move -128..127 to 0..255
+		IdctPass<BITS>(row, S::Set32(512), 10);
+
+		// 16 bit 8x8 transpose
+		Interleave16<BITS>(row[0], row[4]);
+		Interleave16<BITS>(row[1], row[5]);
+		Interleave16<BITS>(row[2], row[6]);
+		Interleave16<BITS>(row[3], row[7]);
+		Interleave16<BITS>(row[0], row[2]);
+		Interleave16<BITS>(row[1], row[3]);
+		Interleave16<BITS>(row[4], row[6]);
+		Interleave16<BITS>(row[5], row[7]);
+		Interleave16<BITS>(row[0], row[1]);
+		Interleave16<BITS>(row[2], row[3]);
+		Interleave16<BITS>(row[4], row[5]);
+		Interleave16<BITS>(row[6], row[7]);
+
+		IdctPass<BITS>(row, S::Set32(65536 + (128 << 17)), 17);
+
+		// pack to bytes and transpose back
+		typename S::TYPE p0 = S::PackBytes(row[0], row[1]);
+		typename S::TYPE p1 = S::PackBytes(row[2], row[3]);
+		typename S::TYPE p2 = S::PackBytes(row[4], row[5]);
+		typename S::TYPE p3 = S::PackBytes(row[6], row[7]);
+		Interleave8<BITS>(p0, p2);
+		Interleave8<BITS>(p1, p3);
+		Interleave8<BITS>(p0, p1);
+		Interleave8<BITS>(p2, p3);
+		Interleave8<BITS>(p0, p2);
+		Interleave8<BITS>(p1, p3);
+
+		output[0] = p0;
+		output[1] = S::SwapHalves(p0);
+		output[2] = p2;
+		output[3] = S::SwapHalves(p2);
+		output[4] = p1;
+		output[5] = S::SwapHalves(p1);
+		output[6] = p3;
+		output[7] = S::SwapHalves(p3);
+	}
+
+	// SSE2 IDCT of one block
+	void IdctBlockSse2(const short* coefficients, unsigned char* output, int stride)
+	{
+		__m128i row[8];
+		__m128i pixels[8];
+		for (int i = 0; i < 8; i++)
+		{
+			row[i] = _mm_loadu_si128((const __m128i*)(coefficients + (i * 8)));
+		}
+		IdctRows<128>(row, pixels);
+		for (int i = 0; i < 8; i++)
+		{
+			_mm_storel_epi64((__m128i*)(output + (i * stride)), pixels[i]);
+		}
+	}
+#endif
+
+#if defined(JPEG_USE_AVX2)
+	// AVX2 IDCT of two blocks at once
+	void IdctBlockPairAvx2(
+		const short* coefficients0,
+		unsigned char* output0,
+		int stride0,
+		const short* coefficients1,
+		unsigned char* output1,
+		int stride1)
+	{
+		__m256i row[8];
+		__m256i pixels[8];
+		for (int i = 0; i < 8; i++)
+		{
+			row[i] = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(coefficients0 + (i * 8)))),
+				_mm_loadu_si128((const __m128i*)(coefficients1 + (i * 8))),
+				1);
+		}
+		IdctRows<256>(row, pixels);
+		for (int i = 0; i < 8; i++)
+		{
+			_mm_storel_epi64((__m128i*)(output0 + (i * stride0)), _mm256_castsi256_si128(pixels[i]));
+			_mm_storel_epi64((__m128i*)(output1 + (i * stride1)), _mm256_extracti128_si256(pixels[i], 1));
+		}
+	}
+#endif
+
+	// cosines of the 4 and 2 point IDCTs used for DCT scaling,
+	// scaled by 4096 and by the square root of 2 past the DC
+	// term so a flat block comes out as with the 8 point IDCT
+	struct SCALED_IDCT_TABLES
+	{
+		int cosines[2][4][4];	// reduction, output sample, frequency
+
+		SCALED_IDCT_TABLES()
+		{
+			for (int shift = 1; shift <= 2; shift++)
+			{
+				int size = 8 >> shift;
+				for (int x = 0; x < 4; x++)
+				{
+					for (int u = 0; u < 4; u++)
+					{
+						float scale = (u == 0) ? 1.0f : 1.414213562f;
+						cosines[shift - 1][x][u] = FixedPoint(scale * std::cos((((2 * x) + 1) * u * 3.14159265f) / (2 * size)));
+					}
+				}
+			}
+		}
+	};
+	const SCALED_IDCT_TABLES SCALED_IDCT;
+
+	// IDCT of the low frequencies of one block to a 4x4, 2x2 or
+	// 1x1 block, the rest of the coefficients are ignored.  The
+	// rounding matches the 8 point IDCT, so a reduced flat block
+	// has the same value as the full one.
+	void IdctBlockScaled(const short* coefficients, unsigned char* output, int stride, int shift)
+	{
+		if (shift == 3)
+		{
+			output[0] = ClampByte(((coefficients[0] + 4) >> 3) + 128);
+			return;
+		}
+
+		int size = 8 >> shift;
+		const int (*cosines)[4] = SCALED_IDCT.cosines[shift - 1];
+		int values[4][4];
+
+		// columns, keeping 2 extra bits of precision
+		for (int u = 0; u < size; u++)
+		{
+			for (int y = 0; y < size; y++)
+			{
+				int sum = 512;
+				for (int k = 0; k < size; k++)
+				{
+					sum += cosines[y][k] * coefficients[(k * 8) + u];
+				}
+				values[y][u] = sum >> 10;
+			}
+		}
+
+		// rows, removing the 1 << 17 scale with rounding and
+		// moving -128..127 to 0..255
+		for (int y = 0; y < size; y++)
+		{
+			unsigned char* o = output + (y * stride);
+			for (int x = 0; x < size; x++)
+			{
+				int sum = 65536 + (128 << 17);
+				for (int u = 0; u < size; u++)
+				{
+					sum += cosines[x][u] * values[y][u];
+				}
+				o[x] = ClampByte(sum >> 17);
+			}
+		}
+	}
+
+	// transform every block of a batch into its component plane
+	void FlushBlocks(BLOCK_BATCH_DATA& batch, int scaleShift)
+	{
+		if (scaleShift > 0)
+		{
+			for (int i = 0; i < batch.count; i++)
+			{
+				IdctBlockScaled(batch.coefficients[i], batch.outputs[i], batch.strides[i], scaleShift);
+			}
+			batch.count = 0;
+			return;
+		}
+
+		int i = 0;
+#if defined(JPEG_USE_AVX2)
+		for (; (i + 2) <= batch.count; i += 2)
+		{
+			IdctBlockPairAvx2(
+				batch.coefficients[i], batch.outputs[i], batch.strides[i],
+				batch.coefficients[i + 1], batch.outputs[i + 1], batch.strides[i + 1]);
+		}
+#endif
+		for (; i < batch.count; i++)
+		{
+#if defined(JPEG_USE_SSE2)
+			IdctBlockSse2(batch.coefficients[i], batch.outputs[i], batch.strides[i]);
+#else
+			IdctBlockScalar(batch.coefficients[i], batch.outputs[i], batch.strides[i]);
+#endif
+		}
+		batch.count = 0;
+	}
+
+	// entropy decode a run of MCUs that starts at a restart
+	// boundary, transforming the blocks in batches
+	bool DecodeMcus(
+		FRAME& frame,
+		const SCAN& scan,
+		const unsigned char* data,
+		const unsigned char* end,
+		int firstMcu,
+		int lastMcu)
+	{
+		BIT_READER reader;
+		reader.position = data;
+		reader.end = end;
+		reader.buffer = 0;
+		reader.bits = 0;
+		reader.bMarker = false;
+
+		int dcPredictions[3] = { 0, 0, 0 };
+		int blockSize = 8 >> frame.scaleShift;
+		BLOCK_BATCH_DATA batch;
+		batch.count = 0;
+
+		for (int mcu = firstMcu; mcu < lastMcu; mcu++)
+		{
+			int mcuX = mcu % scan.mcusX;
+			int mcuY = mcu / scan.mcusX;
+			for (int s = 0; s < scan.componentCount; s++)
+			{
+				COMPONENT& component = frame.components[scan.components[s]];
+				// a non interleaved scan has one block per MCU
+				int blocksX = (scan.componentCount == 1) ? 1 : component.h;
+				int blocksY = (scan.componentCount == 1) ? 1 : component.v;
+				for (int y = 0; y < blocksY; y++)
+				{
+					for (int x = 0; x < blocksX; x++)
+					{
+						int blockX = (mcuX * blocksX) + x;
+						int blockY = (mcuY * blocksY) + y;
+						if (DecodeBlock(
+							reader,
+							frame.dcTables[scan.dcTables[s]],
+							frame.acTables[scan.acTables[s]],
+							frame.quant[component.quantTable],
+							dcPredictions[s],
+							batch.coefficients[batch.count]) == false)
+						{
+							return(false);
+						}
+						batch.outputs[batch.count] = component.plane.data() + ((size_t)blockY * blockSize * component.planeWidth) + (blockX * blockSize);
+						batch.strides[batch.count] = component.planeWidth;
+						batch.count++;
+						if (batch.count == BLOCK_BATCH)
+						{
+							FlushBlocks(batch, frame.scaleShift);
+						}
+					}
+				}
+			}
+		}
+		FlushBlocks(batch, frame.scaleShift);
+		return(true);
+	}
+
+	// find the end of a scan's entropy coded data and where each
+	// restart interval starts, returns the end
+	const unsigned char* FindRestartIntervals(
+		const unsigned char* data,
+		const unsigned char* end,
+		std::vector<const unsigned char*>& intervals)
+	{
+		intervals.push_back(data);
+		const unsigned char* position = data;
+		while (position < end)
+		{
+			position = (const unsigned char*)memchr(position, 0xFF, end - position);
+			if ((position == NULL) || ((position + 1) >= end))
+			{
+				return(end);
+			}
+			unsigned char next = position[1];
+			if (next == 0x00)
+			{
+				// stuffed zero byte
+				position += 2;
+			}
+			else if (next == 0xFF)
+			{
+				// fill byte before a marker
+				position++;
+			}
+			else if ((next >= 0xD0) && (next <= 0xD7))
+			{
+				position += 2;
+				intervals.push_back(position);
+			}
+			else
+			{
+				return(position);
+			}
+		}
+		return(end);
+	}
+
+	// entropy decode a scan, giving each thread a run of restart
+	// intervals, returns the end of the entropy coded data
+	const unsigned char* DecodeScan(
+		FRAME& frame,
+		const SCAN& scan,
+		const unsigned char* data,
+		const unsigned char* end,
+		int threadCount,
+		bool& bSuccess)
+	{
+		std::vector<const unsigned char*> intervals;
+		const unsigned char* scanEnd = FindRestartIntervals(data, end, intervals);
+		intervals.push_back(scanEnd);
+
+		int mcuCount = scan.mcusX * scan.mcusY;
+		int intervalMcus = (frame.restartInterval > 0) ? frame.restartInterval : mcuCount;
+		int intervalCount = (int)intervals.size() - 1;
+		if (frame.restartInterval == 0)
+		{
+			// without restarts the data is one interval, including
+			// anything that looked like a restart marker
+			intervalCount = 1;
+			intervals[1] = scanEnd;
+		}
+
+		std::atomic<bool> bFailed(false);
+		auto decodeIntervals = [&](int first, int last) {
+			for (int i = first; (i < last) && (bFailed == false); i++)
+			{
+				int firstMcu = i * intervalMcus;
+				int lastMcu = std::min(mcuCount, firstMcu + intervalMcus);
+				if ((firstMcu < lastMcu) &&
+					(DecodeMcus(frame, scan, intervals[i], intervals[i + 1], firstMcu, lastMcu) == false))
+				{
+					bFailed = true;
+				}
+			}
+		};
+
+		int threads = std::min(threadCount, intervalCount);
+		if (threads <= 1)
+		{
+			decodeIntervals(0, intervalCount);
+		}
+		else
+		{
+			std::vector<std::thread> workers;
+			for (int i = 0; i < threads; i++)
+			{
+				workers.push_back(std::thread(decodeIntervals, (intervalCount * i) / threads, (intervalCount * (i + 1)) / threads));
+			}
+			for (int i = 0; i < (int)workers.size(); i++)
+			{
+				workers[i].join();
+			}
+		}
+
+		bSuccess = (bFailed == false);
+		return(scanEnd);
+	}
+
+	///////////////////////////////////////////////////////////
+	// upsampling and color conversion - the same rounding as
+	// stb_image's "fancy" upsampling and fixed point YCbCr
+	///////////////////////////////////////////////////////////
+
+	// 2x2 upsampling of one output row from the nearer and the
+	// farther chroma row, sums needs width + 2 entries
+	void UpsampleRowHV2(
+		unsigned char* output,
+		const unsigned char* nearRow,
+		const unsigned char* farRow,
+		int width,
+		short* sums)
+	{
+		// vertical pass, padded with the edge sums
+		short* sum = sums + 1;
+		int i = 0;
+#if defined(JPEG_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		for (; (i + 8) <= width; i += 8)
+		{
+			__m128i nearValues = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(nearRow + i)), zero);
+			__m128i farValues = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(farRow + i)), zero);
+			__m128i tripled = _mm_add_epi16(nearValues, _mm_add_epi16(nearValues, nearValues));
+			_mm_storeu_si128((__m128i*)(sum + i), _mm_add_epi16(tripled, farValues));
+		}
+#endif
+		for (; i < width; i++)
+		{
+			sum[i] = (short)((3 * nearRow[i]) + farRow[i]);
+		}
+		sum[-1] = sum[0];
+		sum[width] = sum[width - 1];
+
+		// horizontal pass, two outputs per input
+		i = 0;
+#if defined(JPEG_USE_AVX2)
+		__m256i rounding256 = _mm256_set1_epi16(8);
+		for (; (i + 16) <= width; i += 16)
+		{
+			__m256i current = _mm256_loadu_si256((const __m256i*)(sum + i));
+			__m256i previous = _mm256_loadu_si256((const __m256i*)(sum + i - 1));
+			__m256i next = _mm256_loadu_si256((const __m256i*)(sum + i + 1));
+			__m256i tripled = _mm256_add_epi16(_mm256_add_epi16(current, _mm256_add_epi16(current, current)), rounding256);
+			__m256i even = _mm256_srli_epi16(_mm256_add_epi16(tripled, previous), 4);
+			__m256i odd = _mm256_srli_epi16(_mm256_add_epi16(tripled, next), 4);
+			// both results fit in a byte, so they interleave in place
+			_mm256_storeu_si256((__m256i*)(output + (i * 2)), _mm256_or_si256(even, _mm256_slli_epi16(odd, 8)));
+		}
+#endif
+#if defined(JPEG_USE_SSE2)
+		__m128i rounding = _mm_set1_epi16(8);
+		for (; (i + 8) <= width; i += 8)
+		{
+			__m128i current = _mm_loadu_si128((const __m128i*)(sum + i));
+			__m128i previous = _mm_loadu_si128((const __m128i*)(sum + i - 1));
+			__m128i next = _mm_loadu_si128((const __m128i*)(sum + i + 1));
+			__m128i tripled = _mm_add_epi16(_mm_add_epi16(current, _mm_add_epi16(current, current)), rounding);
+			__m128i even = _mm_srli_epi16(_mm_add_epi16(tripled, previous), 4);
+			__m128i odd = _mm_srli_epi16(_mm_add_epi16(tripled, next), 4);
+			_mm_storeu_si128((__m128i*)(output + (i * 2)), _mm_or_si128(even, _mm_slli_epi16(odd, 8)));
+		}
+#endif
+		for (; i < width; i++)
+		{
+			int tripled = (3 * sum[i]) + 8;
+			output[i * 2] = (unsigned char)((tripled + sum[i - 1]) >> 4);
+			output[(i * 2) + 1] = (unsigned char)((tripled + sum[i + 1]) >> 4);
+		}
+	}
+
+	// 2x1 upsampling of one row
+	void UpsampleRowH2(unsigned char* output, const unsigned char* input, int width)
+	{
+		if (width == 1)
+		{
+			output[0] = input[0];
+			output[1] = input[0];
+			return;
+		}
+
+		output[0] = input[0];
+		output[1] = (unsigned char)(((input[0] * 3) + input[1] + 2) >> 2);
+		int i = 1;
+		for (; i < (width - 1); i++)
+		{
+			int tripled = (3 * input[i]) + 2;
+			output[i * 2] = (unsigned char)((tripled + input[i - 1]) >> 2);
+			output[(i * 2) + 1] = (unsigned char)((tripled + input[i + 1]) >> 2);
+		}
+		// stb_image weights the last pair this way
+		output[i * 2] = (unsigned char)(((input[width - 2] * 3) + input[width - 1] + 2) >> 2);
+		output[(i * 2) + 1] = input[width - 1];
+	}
+
+	// 1x2 upsampling of one output row
+	void UpsampleRowV2(unsigned char* output, const unsigned char* nearRow, const unsigned char* farRow, int width)
+	{
+		for (int i = 0; i < width; i++)
+		{
+			output[i] = (unsigned char)(((3 * nearRow[i]) + farRow[i] + 2) >> 2);
+		}
+	}
+
+	// fixed point YCbCr to RGB conversion of one pixel
+	inline void ConvertPixel(unsigned char* output, int y, int cb, int cr)
+	{
+		cb -= 128;
+		cr -= 128;
+		int base = (y * 4096) + 2048;
+		// the green Cb term is truncated to 8 fractional bits first
+		output[0] = ClampByte((base + (cr * 5743)) >> 12);
+		output[1] = ClampByte((base - (cr * 2925) + (((cb * -1410) >> 8) << 8)) >> 12);
+		output[2] = ClampByte((base + (cb * 7258)) >> 12);
+	}
+
+#if defined(JPEG_USE_SSE2)
+	// convert 8 pixels to 16 bit R, G and B
+	inline void ConvertPixelsSse2(__m128i y, __m128i cb, __m128i cr, __m128i& r, __m128i& g, __m128i& b)
+	{
+		const __m128i redFactors = _mm_setr_epi16(4096, 5743, 4096, 5743, 4096, 5743, 4096, 5743);
+		const __m128i greenFactors = _mm_setr_epi16(4096, -2925, 4096, -2925, 4096, -2925, 4096, -2925);
+		const __m128i blueFactors = _mm_setr_epi16(4096, 7258, 4096, 7258, 4096, 7258, 4096, 7258);
+		const __m128i cbGreenFactors = _mm_setr_epi16(-1410, 0, -1410, 0, -1410, 0, -1410, 0);
+		const __m128i rounding = _mm_set1_epi32(2048);
+		const __m128i zero = _mm_setzero_si128();
+
+		__m128i yCrLow = _mm_unpacklo_epi16(y, cr);
+		__m128i yCrHigh = _mm_unpackhi_epi16(y, cr);
+		__m128i yCbLow = _mm_unpacklo_epi16(y, cb);
+		__m128i yCbHigh = _mm_unpackhi_epi16(y, cb);
+
+		__m128i redLow = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yCrLow, redFactors), rounding), 12);
+		__m128i redHigh = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yCrHigh, redFactors), rounding), 12);
+		__m128i blueLow = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yCbLow, blueFactors), rounding), 12);
+		__m128i blueHigh = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yCbHigh, blueFactors), rounding), 12);
+
+		__m128i cbLow = _mm_slli_epi32(_mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(cb, zero), cbGreenFactors), 8), 8);
+		__m128i cbHigh = _mm_slli_epi32(_mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(cb, zero), cbGreenFactors), 8), 8);
+		__m128i greenLow = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yCrLow, greenFactors), rounding), cbLow), 12);
+		__m128i greenHigh = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yCrHigh, greenFactors), rounding), cbHigh), 12);
+
+		r = _mm_packs_epi32(redLow, redHigh);
+		g = _mm_packs_epi32(greenLow, greenHigh);
+		b = _mm_packs_epi32(blueLow, blueHigh);
+	}
+#endif
+
+#if defined(JPEG_USE_AVX2)
+	// convert 16 pixels to 16 bit R, G and B
+	inline void ConvertPixelsAvx2(__m256i y, __m256i cb, __m256i cr, __m256i& r, __m256i& g, __m256i& b)
+	{
+		const __m256i redFactors = SIMD_VECTOR<256>::SetPair16(4096, 5743);
+		const __m256i greenFactors = SIMD_VECTOR<256>::SetPair16(4096, -2925);
+		const __m256i blueFactors = SIMD_VECTOR<256>::SetPair16(4096, 7258);
+		const __m256i cbGreenFactors = SIMD_VECTOR<256>::SetPair16(-1410, 0);
+		const __m256i rounding = _mm256_set1_epi32(2048);
+		const __m256i zero = _mm256_setzero_si256();
+
+		__m256i yCrLow = _mm256_unpacklo_epi16(y, cr);
+		__m256i yCrHigh = _mm256_unpackhi_epi16(y, cr);
+		__m256i yCbLow = _mm256_unpacklo_epi16(y, cb);
+		__m256i yCbHigh = _mm256_unpackhi_epi16(y, cb);
+
+		__m256i redLow = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yCrLow, redFactors), rounding), 12);
+		__m256i redHigh = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yCrHigh, redFactors), rounding), 12);
+		__m256i blueLow = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yCbLow, blueFactors), rounding), 12);
+		__m256i blueHigh = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yCbHigh, blueFactors), rounding), 12);
+
+		__m256i cbLow = _mm256_slli_epi32(_mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(cb, zero), cbGreenFactors), 8), 8);
+		__m256i cbHigh = _mm256_slli_epi32(_mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(cb, zero), cbGreenFactors), 8), 8);
+		__m256i greenLow = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(yCrLow, greenFactors), rounding), cbLow), 12);
+		__m256i greenHigh = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(yCrHigh, greenFactors), rounding), cbHigh), 12);
+
+		// the lane wise unpacks and packs cancel out
+		r = _mm256_packs_epi32(redLow, redHigh);
+		g = _mm256_packs_epi32(greenLow, greenHigh);
+		b = _mm256_packs_epi32(blueLow, blueHigh);
+	}
+#endif
+
+#if defined(JPEG_USE_SSE2)
+	// store 16 pixels of R, G and B bytes as packed RGB
+	inline void StoreRgb(unsigned char* output, __m128i r, __m128i g, __m128i b)
+	{
+#if defined(JPEG_USE_SSE41)
+		const char Z = -128;
+		__m128i out0 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(r, _mm_setr_epi8(0, Z, Z, 1, Z, Z, 2, Z, Z, 3, Z, Z, 4, Z, Z, 5)),
+			_mm_shuffle_epi8(g, _mm_setr_epi8(Z, 0, Z, Z, 1, Z, Z, 2, Z, Z, 3, Z, Z, 4, Z, Z))),
+			_mm_shuffle_epi8(b, _mm_setr_epi8(Z, Z, 0, Z, Z, 1, Z, Z, 2, Z, Z, 3, Z, Z, 4, Z)));
+		__m128i out1 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(r, _mm_setr_epi8(Z, Z, 6, Z, Z, 7, Z, Z, 8, Z, Z, 9, Z, Z, 10, Z)),
+			_mm_shuffle_epi8(g, _mm_setr_epi8(5, Z, Z, 6, Z, Z, 7, Z, Z, 8, Z, Z, 9, Z, Z, 10))),
+			_mm_shuffle_epi8(b, _mm_setr_epi8(Z, 5, Z, Z, 6, Z, Z, 7, Z, Z, 8, Z, Z, 9, Z, Z)));
+		__m128i out2 = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(r, _mm_setr_epi8(Z, 11, Z, Z, 12, Z, Z, 13, Z, Z, 14, Z, Z, 15, Z, Z)),
+			_mm_shuffle_epi8(g, _mm_setr_epi8(Z, Z, 11, Z, Z, 12, Z, Z, 13, Z, Z, 14, Z, Z, 15, Z))),
+			_mm_shuffle_epi8(b, _mm_setr_epi8(10, Z, Z, 11, Z, Z, 12, Z, Z, 13, Z, Z, 14, Z, Z, 15)));
+		_mm_storeu_si128((__m128i*)output, out0);
+		_mm_storeu_si128((__m128i*)(output + 16), out1);
+		_mm_storeu_si128((__m128i*)(output + 32), out2);
+#else
+		// without byte shuffles the channels are interleaved one
+		// pixel at a time
+		unsigned char channels[3][16];
+		_mm_storeu_si128((__m128i*)channels[0], r);
+		_mm_storeu_si128((__m128i*)channels[1], g);
+		_mm_storeu_si128((__m128i*)channels[2], b);
+		for (int i = 0; i < 16; i++)
+		{
+			output[i * 3] = channels[0][i];
+			output[(i * 3) + 1] = channels[1][i];
+			output[(i * 3) + 2] = channels[2][i];
+		}
+#endif
+	}
+#endif
+
+	// convert one row of full resolution Y, Cb and Cr to RGB
+	void ConvertRow(unsigned char* output, const unsigned char* y, const unsigned char* cb, const unsigned char* cr, int width)
+	{
+		int i = 0;
+#if defined(JPEG_USE_AVX2)
+		const __m256i bias256 = _mm256_set1_epi16(128);
+		for (; (i + 16) <= width; i += 16)
+		{
+			__m256i yValues = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + i)));
+			__m256i cbValues = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(cb + i))), bias256);
+			__m256i crValues = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(cr + i))), bias256);
+			__m256i r, g, b;
+			ConvertPixelsAvx2(yValues, cbValues, crValues, r, g, b);
+			// saturate to bytes, then gather the low 8 bytes of each lane
+			__m256i rg = _mm256_permute4x64_epi64(_mm256_packus_epi16(r, g), 0xD8);
+			__m256i bb = _mm256_permute4x64_epi64(_mm256_packus_epi16(b, b), 0xD8);
+			StoreRgb(output + (i * 3), _mm256_castsi256_si128(rg), _mm256_extracti128_si256(rg, 1), _mm256_castsi256_si128(bb));
+		}
+#elif defined(JPEG_USE_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(128);
+		for (; (i + 16) <= width; i += 16)
+		{
+			__m128i yBytes = _mm_loadu_si128((const __m128i*)(y + i));
+			__m128i cbBytes = _mm_loadu_si128((const __m128i*)(cb + i));
+			__m128i crBytes = _mm_loadu_si128((const __m128i*)(cr + i));
+			__m128i r0, g0, b0, r1, g1, b1;
+			ConvertPixelsSse2(
+				_mm_unpacklo_epi8(yBytes, zero),
+				_mm_sub_epi16(_mm_unpacklo_epi8(cbBytes, zero), bias),
+				_mm_sub_epi16(_mm_unpacklo_epi8(crBytes, zero), bias),
+				r0, g0, b0);
+			ConvertPixelsSse2(
+				_mm_unpackhi_epi8(yBytes, zero),
+				_mm_sub_epi16(_mm_unpackhi_epi8(cbBytes, zero), bias),
+				_mm_sub_epi16(_mm_unpackhi_epi8(crBytes, zero), bias),
+				r1, g1, b1);
+			StoreRgb(output + (i * 3), _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1));
+		}
+#endif
+		for (; i < width; i++)
+		{
+			ConvertPixel(output + (i * 3), y[i], cb[i], cr[i]);
+		}
+	}
+
+	// upsample and color convert output rows of a decoded frame
+	void OutputRows(const FRAME& frame, unsigned char* pixels, bool bFlipVertically, int firstRow, int lastRow)
+	{
+		int width = frame.width;
+		int channels = (frame.componentCount == 3) ? 3 : 1;
+
+		// full resolution rows of each component, with room for
+		// a vector store past the end
+		std::vector<unsigned char> rowBuffers[3];
+		std::vector<short> sums(width + 2);
+		for (int c = 0; c < frame.componentCount; c++)
+		{
+			rowBuffers[c].resize(width + 64);
+		}
+
+		for (int row = firstRow; row < lastRow; row++)
+		{
+			const unsigned char* rows[3];
+			for (int c = 0; c < frame.componentCount; c++)
+			{
+				const COMPONENT& component = frame.components[c];
+				int horizontalScale = frame.hMax / component.h;
+				int verticalScale = frame.vMax / component.v;
+				int sourceWidth = (width + horizontalScale - 1) / horizontalScale;
+
+				// even rows blend with the row above, odd rows with
+				// the row below
+				int nearY = row / verticalScale;
+				int farY = nearY;
+				if (verticalScale == 2)
+				{
+					farY = ((row & 1) != 0) ? std::min(nearY + 1, component.height - 1) : std::max(nearY - 1, 0);
+				}
+				const unsigned char* nearRow = component.plane.data() + ((size_t)nearY * component.planeWidth);
+				const unsigned char* farRow = component.plane.data() + ((size_t)farY * component.planeWidth);
+
+				if ((horizontalScale == 1) && (verticalScale == 1))
+				{
+					rows[c] = nearRow;
+				}
+				else
+				{
+					if (horizontalScale == 2)
+					{
+						if (verticalScale == 2)
+						{
+							UpsampleRowHV2(rowBuffers[c].data(), nearRow, farRow, sourceWidth, sums.data());
+						}
+						else
+						{
+							UpsampleRowH2(rowBuffers[c].data(), nearRow, sourceWidth);
+						}
+					}
+					else
+					{
+						UpsampleRowV2(rowBuffers[c].data(), nearRow, farRow, sourceWidth);
+					}
+					rows[c] = rowBuffers[c].data();
+				}
+			}
+
+			int outputRow = bFlipVertically ? (frame.height - 1 - row) : row;
+			unsigned char* output = pixels + ((size_t)outputRow * width * channels);
+			if (channels == 3)
+			{
+				ConvertRow(output, rows[0], rows[1], rows[2], width);
+			}
+			else
+			{
+				memcpy(output, rows[0], width);
+			}
+		}
+	}
+
+	// parse the markers in order and decode each scan as soon as
+	// it is found, returns false for anything but a baseline JPEG
+	// with 1 or 3 YCbCr components.  Blocks are transformed
+	// to a reduced size when the frame is larger than maxSize.
+	bool DecodeComponents(const unsigned char* data, size_t size, FRAME& frame, int threadCount, int maxSize)
+	{
+		if ((size < 4) || (data[0] != 0xFF) || (data[1] != 0xD8))
+		{
+			return(false);
+		}
+
+		frame.componentCount = 0;
+		frame.maxSize = maxSize;
+		frame.scaleShift = 0;
+		frame.restartInterval = 0;
+		frame.bJfif = false;
+		frame.adobeTransform = -1;
+
+		const unsigned char* position = data + 2;
+		const unsigned char* end = data + size;
+		bool bScanned = false;
+		bool bSuccess = true;
+		bool bDone = false;
+
+		while ((bSuccess == true) && (bDone == false))
+		{
+			// markers may be preceded by fill bytes
+			if ((position >= end) || (*position != 0xFF))
+			{
+				bSuccess = bScanned;
+				break;
+			}
+			while ((position < end) && (*position == 0xFF))
+			{
+				position++;
+			}
+			if (position >= end)
+			{
+				bSuccess = bScanned;
+				break;
+			}
+
+			int marker = *position++;
+			if (marker == 0xD9)
+			{
+				bDone = true;
+				continue;
+			}
+			if ((marker == 0x01) || ((marker >= 0xD0) && (marker <= 0xD7)))
+			{
+				continue;
+			}
+
+			if ((end - position) < 2)
+			{
+				bSuccess = false;
+				break;
+			}
+			int length = Read16(position);
+			if ((length < 2) || (length > (end - position)))
+			{
+				bSuccess = false;
+				break;
+			}
+			const unsigned char* segment = position + 2;
+			int segmentLength = length - 2;
+			position += length;
+
+			switch (marker)
+			{
+			case 0xC0:
+			case 0xC1:
+				bSuccess = (frame.componentCount == 0) && ParseFrameHeader(frame, segment, segmentLength);
+				break;
+			case 0xC4:
+				bSuccess = ParseHuffmanTables(frame, segment, segmentLength);
+				break;
+			case 0xDB:
+				bSuccess = ParseQuantTables(frame, segment, segmentLength);
+				break;
+			case 0xDD:
+				bSuccess = (segmentLength == 2);
+				if (bSuccess == true)
+				{
+					frame.restartInterval = Read16(segment);
+				}
+				break;
+			case 0xDA:
+			{
+				SCAN scan;
+				bSuccess = ParseScanHeader(frame, segment, segmentLength, scan);
+				if (bSuccess == true)
+				{
+					position = DecodeScan(frame, scan, position, end, threadCount, bSuccess);
+					bScanned = true;
+				}
+				break;
+			}
+			case 0xE0:
+				if ((segmentLength >= 5) && (memcmp(segment, "JFIF", 5) == 0))
+				{
+					frame.bJfif = true;
+				}
+				break;
+			case 0xEE:
+				if ((segmentLength >= 12) && (memcmp(segment, "Adobe", 6) == 0))
+				{
+					frame.adobeTransform = segment[11];
+				}
+				break;
+			default:
+				// other application segments and comments are skipped,
+				// progressive, lossless and arithmetic coded frames are
+				// left to stb_image
+				bSuccess = ((marker >= 0xE1) && (marker <= 0xEF)) || (marker == 0xFE);
+				break;
+			}
+		}
+
+		// components stored as RGB instead of YCbCr
+		if ((bSuccess == true) && (frame.componentCount == 3))
+		{
+			bool bRgbIds = (frame.components[0].id == 'R') && (frame.components[1].id == 'G') && (frame.components[2].id == 'B');
+			if ((bRgbIds == true) || ((frame.adobeTransform == 0) && (frame.bJfif == false)))
+			{
+				bSuccess = false;
+			}
+		}
+
+		return(bSuccess);
+	}
+
+	// read a whole file
+	bool ReadFile(const char* filename, std::vector<unsigned char>& data)
+	{
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
+		if (file.is_open() == false)
+		{
+			return(false);
+		}
+
+		std::streamsize size = file.tellg();
+		if (size < 4)
+		{
+			return(false);
+		}
+		data.resize((size_t)size);
+		file.seekg(0, std::ios::beg);
+		if (!file.read((char*)data.data(), size))
+		{
+			return(false);
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  JpegDecoder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JpegDecoder::JpegDecoder(bool bFlipVertically, int threadCount)
+{
+	m_bFlipVertically = bFlipVertically;
+	m_threadCount = threadCount;
+	if (m_threadCount <= 0)
+	{
+		m_threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+}
+
+/***********************************************************
+ *  GetInstructionSet()
+ *
+ *  Name of the instruction set the decoding kernels were
+ *  compiled for.
+ ***********************************************************/
+const char* JpegDecoder::GetInstructionSet()
+{
+#if defined(JPEG_USE_AVX2)
+	return("AVX2");
+#elif defined(JPEG_USE_SSE41)
+	return("SSE4.1");
+#elif defined(JPEG_USE_SSE2)
+	return("SSE2");
+#else
+	return("scalar");
+#endif
+}
+
+/***********************************************************
+ *  DecodeFile()
+ *
+ *  Read an image file and decode it.  Returns false if the
+ *  file cannot be read or is not a supported JPEG.
+ ***********************************************************/
+bool JpegDecoder::DecodeFile(const char* filename, JPEG_IMAGE& image, int maxSize) const
+{
+	std::vector<unsigned char> data;
+	if (ReadFile(filename, data) == false)
+	{
+		return(false);
+	}
+	return(DecodeMemory(data.data(), data.size(), image, maxSize));
+}
+
+/***********************************************************
+ *  DecodeMemory()
+ *
+ *  Decode a JPEG file held in memory, then upsample the
+ *  chroma and convert the components to RGB.  Returns false
+ *  for anything but a baseline JPEG with 1 or 3 components.
+ *  When the image is larger than a positive maxSize, it is
+ *  decoded at 1/2, 1/4 or 1/8 of its size - the smallest of
+ *  them that fits, or 1/8 if none does - by transforming
+ *  only the low frequencies of each block.
+ ***********************************************************/
+bool JpegDecoder::DecodeMemory(const unsigned char* data, size_t size, JPEG_IMAGE& image, int maxSize) const
+{
+	FRAME* frame = new FRAME();
+	bool bSuccess = DecodeComponents(data, size, *frame, m_threadCount, maxSize);
+
+	if (bSuccess == true)
+	{
+		image.width = frame->width;
+		image.height = frame->height;
+		image.colorChannels = (frame->componentCount == 3) ? 3 : 1;
+		image.pixels.resize((size_t)image.width * image.height * image.colorChannels);
+
+		unsigned char* pixels = image.pixels.data();
+		const FRAME& decoded = *frame;
+		bool bFlip = m_bFlipVertically;
+		ParallelRows(image.height, m_threadCount, [&](int firstRow, int lastRow) {
+			OutputRows(decoded, pixels, bFlip, firstRow, lastRow);
+		});
+	}
+
+	delete frame;
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  DecodePlanesFile()
+ *
+ *  Read an image file and decode its color planes.  Returns
+ *  false if the file cannot be read or is not a supported
+ *  JPEG.
+ ***********************************************************/
+bool JpegDecoder::DecodePlanesFile(const char* filename, JPEG_PLANES& planes, int maxSize) const
+{
+	std::vector<unsigned char> data;
+	if (ReadFile(filename, data) == false)
+	{
+		return(false);
+	}
+	return(DecodePlanesMemory(data.data(), data.size(), planes, maxSize));
+}
+
+/***********************************************************
+ *  DecodePlanesMemory()
+ *
+ *  Decode a JPEG file held in memory up to its Y, Cb and Cr
+ *  planes at their own resolution, skipping the upsampling
+ *  and color conversion.  The planes keep their top row
+ *  first whether or not the decoder flips images, and are
+ *  reduced like DecodeMemory() does for a positive maxSize.
+ ***********************************************************/
+bool JpegDecoder::DecodePlanesMemory(const unsigned char* data, size_t size, JPEG_PLANES& planes, int maxSize) const
+{
+	FRAME* frame = new FRAME();
+	bool bSuccess = DecodeComponents(data, size, *frame, m_threadCount, maxSize);
+
+	if (bSuccess == true)
+	{
+		planes.width = frame->width;
+		planes.height = frame->height;
+		planes.componentCount = frame->componentCount;
+		for (int c = 0; c < frame->componentCount; c++)
+		{
+			COMPONENT& component = frame->components[c];
+			JPEG_PLANE& plane = planes.planes[c];
+			plane.width = component.width;
+			plane.height = component.height;
+			plane.stride = component.planeWidth;
+			plane.horizontalScale = frame->hMax / component.h;
+			plane.verticalScale = frame->vMax / component.v;
+			plane.pixels.swap(component.plane);
+		}
+	}
+
+	delete frame;
+	return(bSuccess);
+}
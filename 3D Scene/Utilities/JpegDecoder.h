@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// jpegdecoder.h
+// ============
+// decode baseline JPEG images with SIMD kernels and restart interval threads
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  JpegDecoder
+ *
+ *  This class decodes baseline (sequential Huffman) JPEG
+ *  files to 8 bit RGB or grey rows that match stb_image bit
+ *  for bit.  The IDCT, chroma upsampling and YCbCr to RGB
+ *  conversion use SSE or AVX2 kernels when the compiler
+ *  targets them.  Scans with restart markers are entropy
+ *  decoded with a run of restart intervals per thread, and
+ *  the color conversion splits rows between threads.  The
+ *  Y, Cb and Cr planes can also be returned before they are
+ *  upsampled, for conversion on the GPU.  Images can be
+ *  decoded at 1/2, 1/4 or 1/8 of their size with reduced
+ *  IDCTs of each block's low frequencies, which skips most
+ *  of the transform, upsampling and conversion work.
+ *
+ *  Progressive, arithmetic coded, 12 bit, RGB and CMYK
+ *  files are refused so the caller can fall back to
+ *  stb_image for them.
+ ***********************************************************/
+class JpegDecoder
+{
+public:
+	// a decoded image
+	struct JPEG_IMAGE
+	{
+		int width;
+		int height;
+		int colorChannels;
+		std::vector<unsigned char> pixels;	// tightly packed rows
+	};
+
+	// one color component at its own resolution
+	struct JPEG_PLANE
+	{
+		int width;
+		int height;
+		int stride;				// bytes per row, padded to whole MCUs
+		int horizontalScale;	// upsampling to the image size, 1 or 2
+		int verticalScale;
+		std::vector<unsigned char> pixels;	// top row first
+	};
+
+	// the components of an image before upsampling and color conversion
+	struct JPEG_PLANES
+	{
+		int width;
+		int height;
+		int componentCount;		// 1 for grey, 3 for Y, Cb and Cr
+		JPEG_PLANE planes[3];
+	};
+
+	// constructor - zero threads uses one per hardware thread
+	JpegDecoder(bool bFlipVertically = true, int threadCount = 0);
+
+	// decode an image file, returns false if it is not a supported JPEG -
+	// a positive maxSize reduces larger images by up to 8 while decoding
+	bool DecodeFile(const char* filename, JPEG_IMAGE& image, int maxSize = 0) const;
+	// decode an image file already read into memory
+	bool DecodeMemory(const unsigned char* data, size_t size, JPEG_IMAGE& image, int maxSize = 0) const;
+	// decode an image file up to its color planes
+	bool DecodePlanesFile(const char* filename, JPEG_PLANES& planes, int maxSize = 0) const;
+	// decode an image file already read into memory up to its color planes
+	bool DecodePlanesMemory(const unsigned char* data, size_t size, JPEG_PLANES& planes, int maxSize = 0) const;
+
+	bool IsFlippedVertically() const { return m_bFlipVertically; }
+	int GetThreadCount() const { return m_threadCount; }
+	// name of the instruction set the kernels were compiled for
+	static const char* GetInstructionSet();
+
+private:
+	// rows are stored bottom up, like stbi_set_flip_vertically_on_load()
+	bool m_bFlipVertically;
+	int m_threadCount;
+};
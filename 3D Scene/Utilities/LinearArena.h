@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// lineararena.h
+// ============
+// bump allocator over one block of memory the caller provides, such as a
+// reused scratch buffer or a mapped GPU buffer, freed all at once
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  LinearArena
+ *
+ *  Hands out consecutive pieces of a block of memory owned
+ *  by the caller, each starting on a multiple of
+ *  PIECE_ALIGNMENT from the start of the block.  Pieces are
+ *  never freed one at a time - the arena is rewound to an
+ *  earlier mark, or reset, and the space after it is handed
+ *  out again.  The arena itself never allocates, so a
+ *  caller that sizes the block from BytesFor() of every
+ *  piece it takes does its work with no heap allocations.
+ ***********************************************************/
+class LinearArena
+{
+public:
+	// every piece starts on a multiple of this, enough for any
+	// vertex or index type - the block should start on one too
+	static const size_t PIECE_ALIGNMENT = 16;
+
+	LinearArena() : m_pBase(NULL), m_capacity(0), m_used(0), m_peak(0) {}
+	LinearArena(void* memory, size_t bytes) : LinearArena() { Attach(memory, bytes); }
+
+	/***********************************************************
+	 *  Attach()
+	 *
+	 *  Hand out the passed in block from its start, forgetting
+	 *  the pieces of the previous block.
+	 ***********************************************************/
+	void Attach(void* memory, size_t bytes)
+	{
+		m_pBase = (unsigned char*)memory;
+		m_capacity = (memory != NULL) ? bytes : 0;
+		m_used = 0;
+		m_peak = 0;
+	}
+
+	/***********************************************************
+	 *  Allocate()
+	 *
+	 *  Take room for the passed in number of values.  Returns
+	 *  NULL, taking nothing, if they do not fit.
+	 ***********************************************************/
+	template <typename T>
+	T* Allocate(size_t count)
+	{
+		size_t offset = AlignUp(m_used);
+		size_t bytes = count * sizeof(T);
+		if ((offset > m_capacity) || (bytes > m_capacity - offset))
+		{
+			return(NULL);
+		}
+
+		m_used = offset + bytes;
+		if (m_used > m_peak)
+		{
+			m_peak = m_used;
+		}
+		return((T*)(m_pBase + offset));
+	}
+
+	/***********************************************************
+	 *  BytesFor()
+	 *
+	 *  Get the bytes a piece of the passed in number of values
+	 *  takes, with the padding after it, for sizing a block
+	 *  before anything is taken from it.
+	 ***********************************************************/
+	template <typename T>
+	static size_t BytesFor(size_t count)
+	{
+		return(AlignUp(count * sizeof(T)));
+	}
+
+	// the bytes taken so far, which Rewind() goes back to
+	size_t GetMark() const { return(m_used); }
+	void Rewind(size_t mark) { m_used = (mark < m_used) ? mark : m_used; }
+	void Reset() { m_used = 0; }
+
+	size_t GetCapacity() const { return(m_capacity); }
+	size_t GetUsed() const { return(m_used); }
+	// the most bytes taken at once since the block was attached
+	size_t GetPeak() const { return(m_peak); }
+
+private:
+	static size_t AlignUp(size_t bytes)
+	{
+		return(((bytes + PIECE_ALIGNMENT - 1) / PIECE_ALIGNMENT) * PIECE_ALIGNMENT);
+	}
+
+	unsigned char* m_pBase;
+	size_t m_capacity;
+	size_t m_used;
+	size_t m_peak;
+};
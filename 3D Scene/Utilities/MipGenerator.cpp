@@ -0,0 +1,531 @@
+///////////////////////////////////////////////////////////////////////////////
+// mipgenerator.cpp
+// ============
+// build texture mip chains on the CPU with selectable downsampling filters
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+// pick the widest kernels the compiler was allowed to target -
+// x64 always has SSE2, AVX2 needs /arch:AVX2 or -mavx2, which the
+// project sets in every configuration
+#if defined(__AVX2__)
+#define MIP_USE_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MIP_USE_SSE2
+#endif
+
+#if defined(MIP_USE_AVX2) || defined(MIP_USE_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// levels with fewer rows than this are not worth splitting
+	const int MIN_ROWS_PER_THREAD = 32;
+	// entries of the linear to sRGB table
+	const int ENCODE_TABLE_SIZE = 4096;
+	// shape of the Kaiser window
+	const double KAISER_ALPHA = 4.0;
+	// padding after each float row so a 4 float pixel can be
+	// loaded or stored at the last 3 channel pixel
+	const int ROW_PADDING = 4;
+
+	// zeroth order modified Bessel function of the first kind
+	double BesselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; k++)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return(sum);
+	}
+
+	// run a function over row ranges split between threads
+	void ParallelRows(int rows, int threadCount, const std::function<void(int, int)>& function)
+	{
+		int threads = std::min(threadCount, std::max(1, rows / MIN_ROWS_PER_THREAD));
+		if (threads <= 1)
+		{
+			function(0, rows);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; i++)
+		{
+			int firstRow = (rows * i) / threads;
+			int lastRow = (rows * (i + 1)) / threads;
+			workers.push_back(std::thread(function, firstRow, lastRow));
+		}
+		for (int i = 0; i < (int)workers.size(); i++)
+		{
+			workers[i].join();
+		}
+	}
+}
+
+/***********************************************************
+ *  MipGenerator()
+ *
+ *  The constructor for the class.  Gamma correct filtering
+ *  treats the images as sRGB and averages in linear light,
+ *  so bright and dark texels keep their perceived balance.
+ ***********************************************************/
+MipGenerator::MipGenerator(
+	MIP_FILTER filter,
+	bool bGammaCorrect,
+	int threadCount)
+{
+	m_filter = filter;
+	m_bGammaCorrect = bGammaCorrect;
+	m_threadCount = threadCount;
+	if (m_threadCount <= 0)
+	{
+		m_threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+
+	if (m_filter == MIP_FILTER_KAISER)
+	{
+		// windowed sinc with its cutoff at the new Nyquist
+		// frequency, sampled at the source pixel centers
+		m_taps.count = 6;
+		m_taps.firstOffset = -2;
+		double total = 0.0;
+		double weights[6];
+		for (int i = 0; i < m_taps.count; i++)
+		{
+			double distance = (double)(i + m_taps.firstOffset) - 0.5;
+			double x = distance * 0.5;
+			double sinc = 1.0;
+			if (x != 0.0)
+			{
+				sinc = std::sin(3.14159265358979323846 * x) / (3.14159265358979323846 * x);
+			}
+			double window = distance / 3.0;
+			double kaiser = BesselI0(KAISER_ALPHA * std::sqrt(std::max(0.0, 1.0 - window * window))) / BesselI0(KAISER_ALPHA);
+			weights[i] = sinc * kaiser;
+			total += weights[i];
+		}
+		for (int i = 0; i < m_taps.count; i++)
+		{
+			m_taps.weights[i] = (float)(weights[i] / total);
+		}
+	}
+	else
+	{
+		m_taps.count = 2;
+		m_taps.firstOffset = 0;
+		m_taps.weights[0] = 0.5f;
+		m_taps.weights[1] = 0.5f;
+	}
+
+	for (int i = 0; i < 256; i++)
+	{
+		double value = i / 255.0;
+		if (m_bGammaCorrect == true)
+		{
+			value = (value <= 0.04045) ? (value / 12.92) : std::pow((value + 0.055) / 1.055, 2.4);
+		}
+		m_decodeTable[i] = (float)value;
+	}
+
+	if (m_bGammaCorrect == true)
+	{
+		m_encodeTable.resize(ENCODE_TABLE_SIZE);
+		for (int i = 0; i < ENCODE_TABLE_SIZE; i++)
+		{
+			double value = (double)i / (ENCODE_TABLE_SIZE - 1);
+			value = (value <= 0.0031308) ? (value * 12.92) : (1.055 * std::pow(value, 1.0 / 2.4) - 0.055);
+			m_encodeTable[i] = (unsigned char)std::min(255.0, std::floor(value * 255.0 + 0.5));
+		}
+	}
+}
+
+/***********************************************************
+ *  GetInstructionSet()
+ *
+ *  Get the name of the instruction set the kernels use.
+ ***********************************************************/
+const char* MipGenerator::GetInstructionSet()
+{
+#if defined(MIP_USE_AVX2)
+	return("AVX2");
+#elif defined(MIP_USE_SSE2)
+	return("SSE2");
+#else
+	return("scalar");
+#endif
+}
+
+/***********************************************************
+ *  GenerateMipChain()
+ *
+ *  Build every level of the image's mip chain down to 1x1.
+ *  Each level is split into row bands filtered in parallel.
+ ***********************************************************/
+bool MipGenerator::GenerateMipChain(MIP_IMAGE& image) const
+{
+	return(BuildChain(image, m_threadCount));
+}
+
+/***********************************************************
+ *  GenerateMipChains()
+ *
+ *  Build the mip chains of a batch of images.  The threads
+ *  take whole images, which scales better than splitting
+ *  the rows of the small levels.
+ ***********************************************************/
+bool MipGenerator::GenerateMipChains(std::vector<MIP_IMAGE>& images) const
+{
+	std::atomic<int> nextImage(0);
+	std::atomic<bool> bSuccess(true);
+
+	auto worker = [&]() {
+		int index = nextImage++;
+		while (index < (int)images.size())
+		{
+			if (BuildChain(images[index], 1) == false)
+			{
+				bSuccess = false;
+			}
+			index = nextImage++;
+		}
+	};
+
+	int threads = std::min(m_threadCount, (int)images.size());
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threads; i++)
+	{
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  BuildChain()
+ *
+ *  Convert the image to floating point once, then filter
+ *  each level from the previous floating point level so the
+ *  8 bit rounding does not add up down the chain.
+ ***********************************************************/
+bool MipGenerator::BuildChain(MIP_IMAGE& image, int threadCount) const
+{
+	int channels = image.colorChannels;
+	if ((image.pixels == NULL) || (image.width <= 0) || (image.height <= 0) ||
+		(channels < 1) || (channels > 4))
+	{
+		return(false);
+	}
+
+	image.levels.clear();
+
+	MIP_LEVEL top;
+	top.width = image.width;
+	top.height = image.height;
+	top.pixels.assign(image.pixels, image.pixels + (size_t)image.width * image.height * channels);
+	image.levels.push_back(top);
+
+	int rowLength = image.width * channels;
+	std::vector<float> previous((size_t)rowLength * image.height + ROW_PADDING);
+	ParallelRows(image.height, threadCount, [&](int firstRow, int lastRow) {
+		DecodeRows(image.pixels, previous.data(), firstRow, lastRow, rowLength);
+	});
+
+	std::vector<float> current;
+	int width = image.width;
+	int height = image.height;
+	while ((width > 1) || (height > 1))
+	{
+		int nextWidth = std::max(1, width / 2);
+		int nextHeight = std::max(1, height / 2);
+		int nextRowLength = nextWidth * channels;
+
+		current.resize((size_t)nextRowLength * nextHeight + ROW_PADDING);
+		MIP_LEVEL level;
+		level.width = nextWidth;
+		level.height = nextHeight;
+		level.pixels.resize((size_t)nextRowLength * nextHeight);
+
+		ParallelRows(nextHeight, threadCount, [&](int firstRow, int lastRow) {
+			DownsampleRows(previous.data(), width, height, current.data(), nextWidth, firstRow, lastRow, channels);
+			EncodeRows(current.data(), level.pixels.data(), firstRow, lastRow, nextRowLength);
+		});
+
+		image.levels.push_back(level);
+		previous.swap(current);
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DecodeRows()
+ *
+ *  Convert rows of 8 bit values to floating point in 0..1,
+ *  going through the sRGB table when gamma correcting.
+ ***********************************************************/
+void MipGenerator::DecodeRows(
+	const unsigned char* source,
+	float* destination,
+	int firstRow,
+	int lastRow,
+	int rowLength) const
+{
+	size_t begin = (size_t)firstRow * rowLength;
+	size_t end = (size_t)lastRow * rowLength;
+	size_t i = begin;
+
+	if (m_bGammaCorrect == false)
+	{
+		const float scale = 1.0f / 255.0f;
+#if defined(MIP_USE_AVX2)
+		const __m256 scale8 = _mm256_set1_ps(scale);
+		for (; i + 8 <= end; i += 8)
+		{
+			__m128i bytes = _mm_loadl_epi64((const __m128i*)(source + i));
+			__m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+			_mm256_storeu_ps(destination + i, _mm256_mul_ps(values, scale8));
+		}
+#elif defined(MIP_USE_SSE2)
+		const __m128 scale4 = _mm_set1_ps(scale);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 8 <= end; i += 8)
+		{
+			__m128i words = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(source + i)), zero);
+			__m128 low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+			__m128 high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+			_mm_storeu_ps(destination + i, _mm_mul_ps(low, scale4));
+			_mm_storeu_ps(destination + i + 4, _mm_mul_ps(high, scale4));
+		}
+#endif
+	}
+
+	for (; i < end; i++)
+	{
+		destination[i] = m_decodeTable[source[i]];
+	}
+}
+
+/***********************************************************
+ *  DownsampleRows()
+ *
+ *  Filter rows of the next level from the previous level.
+ *  Every output row is first filtered vertically over the
+ *  full source width, which is contiguous and vectorizes for
+ *  any channel count, then horizontally one pixel per vector.
+ *  Samples past the edges are clamped to the edge.
+ ***********************************************************/
+void MipGenerator::DownsampleRows(
+	const float* source,
+	int sourceWidth,
+	int sourceHeight,
+	float* destination,
+	int width,
+	int firstRow,
+	int lastRow,
+	int colorChannels) const
+{
+	int sourceRowLength = sourceWidth * colorChannels;
+	int rowLength = width * colorChannels;
+	std::vector<float> column((size_t)sourceRowLength + ROW_PADDING, 0.0f);
+
+#if defined(MIP_USE_AVX2)
+	__m256 weights8[8];
+	for (int k = 0; k < m_taps.count; k++)
+	{
+		weights8[k] = _mm256_set1_ps(m_taps.weights[k]);
+	}
+#endif
+#if defined(MIP_USE_SSE2)
+	__m128 weights4[8];
+	for (int k = 0; k < m_taps.count; k++)
+	{
+		weights4[k] = _mm_set1_ps(m_taps.weights[k]);
+	}
+#endif
+
+	// output pixels whose taps are all inside the source row
+	int firstInterior = std::min(width, std::max(0, (1 - m_taps.firstOffset) / 2));
+	int lastInterior = std::max(firstInterior, std::min(width, (sourceWidth - m_taps.count - m_taps.firstOffset) / 2 + 1));
+
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		// a single source row has nothing to filter vertically
+		if (sourceHeight == 1)
+		{
+			std::memcpy(column.data(), source, sizeof(float) * sourceRowLength);
+		}
+		else
+		{
+			const float* rows[8];
+			for (int k = 0; k < m_taps.count; k++)
+			{
+				int sourceRow = std::min(std::max(2 * y + m_taps.firstOffset + k, 0), sourceHeight - 1);
+				rows[k] = source + (size_t)sourceRow * sourceRowLength;
+			}
+
+			int x = 0;
+#if defined(MIP_USE_AVX2)
+			for (; x + 8 <= sourceRowLength; x += 8)
+			{
+				__m256 sum = _mm256_mul_ps(_mm256_loadu_ps(rows[0] + x), weights8[0]);
+				for (int k = 1; k < m_taps.count; k++)
+				{
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + x), weights8[k]));
+				}
+				_mm256_storeu_ps(column.data() + x, sum);
+			}
+#endif
+#if defined(MIP_USE_SSE2)
+			for (; x + 4 <= sourceRowLength; x += 4)
+			{
+				__m128 sum = _mm_mul_ps(_mm_loadu_ps(rows[0] + x), weights4[0]);
+				for (int k = 1; k < m_taps.count; k++)
+				{
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[k] + x), weights4[k]));
+				}
+				_mm_storeu_ps(column.data() + x, sum);
+			}
+#endif
+			for (; x < sourceRowLength; x++)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < m_taps.count; k++)
+				{
+					sum += rows[k][x] * m_taps.weights[k];
+				}
+				column[x] = sum;
+			}
+		}
+
+		float* output = destination + (size_t)y * rowLength;
+
+		// a single source column has nothing to filter horizontally
+		if (sourceWidth == 1)
+		{
+			std::memcpy(output, column.data(), sizeof(float) * rowLength);
+			continue;
+		}
+
+		int x = 0;
+#if defined(MIP_USE_SSE2)
+		// 3 and 4 channel pixels fit one vector - a 3 channel
+		// store spills one float into the next pixel, which is
+		// written afterwards, so the last pixel is left scalar
+		if ((colorChannels == 3) || (colorChannels == 4))
+		{
+			int vectorPixels = (colorChannels == 4) ? width : (width - 1);
+			for (; x < vectorPixels; x++)
+			{
+				__m128 sum = _mm_setzero_ps();
+				if ((x >= firstInterior) && (x < lastInterior))
+				{
+					const float* taps = column.data() + (2 * x + m_taps.firstOffset) * colorChannels;
+					for (int k = 0; k < m_taps.count; k++)
+					{
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(taps + k * colorChannels), weights4[k]));
+					}
+				}
+				else
+				{
+					for (int k = 0; k < m_taps.count; k++)
+					{
+						int sourceX = std::min(std::max(2 * x + m_taps.firstOffset + k, 0), sourceWidth - 1);
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(column.data() + sourceX * colorChannels), weights4[k]));
+					}
+				}
+				_mm_storeu_ps(output + x * colorChannels, sum);
+			}
+		}
+#endif
+		for (; x < width; x++)
+		{
+			for (int c = 0; c < colorChannels; c++)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < m_taps.count; k++)
+				{
+					int sourceX = std::min(std::max(2 * x + m_taps.firstOffset + k, 0), sourceWidth - 1);
+					sum += column[sourceX * colorChannels + c] * m_taps.weights[k];
+				}
+				output[x * colorChannels + c] = sum;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  EncodeRows()
+ *
+ *  Round floating point rows back to 8 bits, clamping the
+ *  overshoot of the Kaiser filter's negative lobes.
+ ***********************************************************/
+void MipGenerator::EncodeRows(
+	const float* source,
+	unsigned char* destination,
+	int firstRow,
+	int lastRow,
+	int rowLength) const
+{
+	size_t begin = (size_t)firstRow * rowLength;
+	size_t end = (size_t)lastRow * rowLength;
+	size_t i = begin;
+
+	if (m_bGammaCorrect == true)
+	{
+		const float scale = (float)(ENCODE_TABLE_SIZE - 1);
+		for (; i < end; i++)
+		{
+			float value = std::min(std::max(source[i], 0.0f), 1.0f);
+			destination[i] = m_encodeTable[(int)(value * scale + 0.5f)];
+		}
+		return;
+	}
+
+#if defined(MIP_USE_AVX2)
+	const __m256 scale8 = _mm256_set1_ps(255.0f);
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256i values = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(source + i), scale8));
+		// the saturating packs clamp to 0..255
+		__m128i words = _mm_packs_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+		_mm_storel_epi64((__m128i*)(destination + i), _mm_packus_epi16(words, words));
+	}
+#elif defined(MIP_USE_SSE2)
+	const __m128 scale4 = _mm_set1_ps(255.0f);
+	for (; i + 8 <= end; i += 8)
+	{
+		__m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i), scale4));
+		__m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i + 4), scale4));
+		// the saturating packs clamp to 0..255
+		__m128i words = _mm_packs_epi32(low, high);
+		_mm_storel_epi64((__m128i*)(destination + i), _mm_packus_epi16(words, words));
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		float value = std::min(std::max(source[i] * 255.0f, 0.0f), 255.0f);
+		destination[i] = (unsigned char)std::lrint(value);
+	}
+}
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// mipgenerator.h
+// ============
+// build texture mip chains on the CPU with selectable downsampling filters
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+/***********************************************************
+ *  MipGenerator
+ *
+ *  This class builds the full mip chain of 8 bit RGB/RGBA
+ *  images.  Each level is filtered from the previous one in
+ *  floating point, optionally in linear light, with SSE or
+ *  AVX2 kernels when the compiler targets them.  The rows of
+ *  a level are split between threads, and a batch of images
+ *  can be processed with one image per thread instead.
+ ***********************************************************/
+class MipGenerator
+{
+public:
+	// downsampling filters
+	enum MIP_FILTER
+	{
+		MIP_FILTER_BOX,			// 2x2 average, like most drivers
+		MIP_FILTER_KAISER		// 6 tap Kaiser windowed sinc, keeps more detail
+	};
+
+	// one level of a mip chain
+	struct MIP_LEVEL
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> pixels;	// tightly packed rows
+	};
+
+	// an image and the mip chain built for it
+	struct MIP_IMAGE
+	{
+		const unsigned char* pixels;	// tightly packed source rows
+		int width;
+		int height;
+		int colorChannels;
+		std::vector<MIP_LEVEL> levels;	// level zero is a copy of the source
+	};
+
+	// constructor - zero threads uses one per hardware thread
+	MipGenerator(
+		MIP_FILTER filter = MIP_FILTER_BOX,
+		bool bGammaCorrect = false,
+		int threadCount = 0);
+
+	// build the mip chain of one image, splitting rows between threads
+	bool GenerateMipChain(MIP_IMAGE& image) const;
+	// build the mip chains of several images, one image per thread
+	bool GenerateMipChains(std::vector<MIP_IMAGE>& images) const;
+
+	MIP_FILTER GetFilter() const { return m_filter; }
+	bool IsGammaCorrect() const { return m_bGammaCorrect; }
+	int GetThreadCount() const { return m_threadCount; }
+	// name of the instruction set the kernels were compiled for
+	static const char* GetInstructionSet();
+
+private:
+	// weights of a separable 2x decimation filter
+	struct FILTER_TAPS
+	{
+		int count;
+		int firstOffset;		// first source sample relative to 2 * output index
+		float weights[8];
+	};
+
+	MIP_FILTER m_filter;
+	bool m_bGammaCorrect;
+	int m_threadCount;
+	FILTER_TAPS m_taps;
+	// sRGB to linear conversion of every 8 bit value
+	float m_decodeTable[256];
+	// linear to sRGB conversion, indexed by value * (size - 1)
+	std::vector<unsigned char> m_encodeTable;
+
+	// build the chain with the given number of threads
+	bool BuildChain(MIP_IMAGE& image, int threadCount) const;
+
+	// convert 8 bit rows to floating point
+	void DecodeRows(
+		const unsigned char* source,
+		float* destination,
+		int firstRow,
+		int lastRow,
+		int rowLength) const;
+	// filter output rows of the next level from the previous level
+	void DownsampleRows(
+		const float* source,
+		int sourceWidth,
+		int sourceHeight,
+		float* destination,
+		int width,
+		int firstRow,
+		int lastRow,
+		int colorChannels) const;
+	// convert floating point rows back to 8 bits
+	void EncodeRows(
+		const float* source,
+		unsigned char* destination,
+		int firstRow,
+		int lastRow,
+		int rowLength) const;
+};
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// rangeallocator.h
+// ============
+// first fit suballocator - hands out ranges of a larger block, such as a
+// GPU buffer shared by many meshes, and merges them again when freed
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  RangeAllocator
+ *
+ *  Tracks the free ranges of a block of a given size, kept
+ *  sorted by offset with neighbours merged.  Allocations
+ *  take the first free range that fits.  The allocator
+ *  only does the bookkeeping - the units and the storage
+ *  belong to the caller, which can grow the block when an
+ *  allocation fails.
+ ***********************************************************/
+class RangeAllocator
+{
+public:
+	// returned when no free range fits
+	static const uint32_t INVALID_OFFSET = 0xFFFFFFFF;
+
+	RangeAllocator() : m_size(0), m_used(0) {}
+
+	/***********************************************************
+	 *  Reset()
+	 *
+	 *  Make the whole block of the passed in size free.
+	 ***********************************************************/
+	void Reset(uint32_t size)
+	{
+		m_freeRanges.clear();
+		m_size = size;
+		m_used = 0;
+		if (size > 0)
+		{
+			RANGE range;
+			range.offset = 0;
+			range.size = size;
+			m_freeRanges.push_back(range);
+		}
+	}
+
+	/***********************************************************
+	 *  Grow()
+	 *
+	 *  Add free space to the end of the block, which keeps
+	 *  every allocated offset.
+	 ***********************************************************/
+	void Grow(uint32_t newSize)
+	{
+		if (newSize <= m_size)
+		{
+			return;
+		}
+		// the new space is freed like an allocation would be
+		m_used += newSize - m_size;
+		Free(m_size, newSize - m_size);
+		m_size = newSize;
+	}
+
+	/***********************************************************
+	 *  Allocate()
+	 *
+	 *  Take a range of the passed in size, starting at a
+	 *  multiple of the alignment, from the first free range it
+	 *  fits in.  Returns INVALID_OFFSET if none is big enough.
+	 ***********************************************************/
+	uint32_t Allocate(uint32_t size, uint32_t alignment = 1)
+	{
+		for (size_t i = 0; i < m_freeRanges.size(); i++)
+		{
+			RANGE range = m_freeRanges[i];
+			uint32_t offset = ((range.offset + alignment - 1) / alignment) * alignment;
+			uint32_t padding = offset - range.offset;
+			if (range.size < padding + size)
+			{
+				continue;
+			}
+
+			// keep the padding before the allocation and the space
+			// after it as free ranges
+			m_freeRanges.erase(m_freeRanges.begin() + i);
+			if (range.size > padding + size)
+			{
+				RANGE after;
+				after.offset = offset + size;
+				after.size = range.size - padding - size;
+				m_freeRanges.insert(m_freeRanges.begin() + i, after);
+			}
+			if (padding > 0)
+			{
+				RANGE before;
+				before.offset = range.offset;
+				before.size = padding;
+				m_freeRanges.insert(m_freeRanges.begin() + i, before);
+			}
+			m_used += size;
+			return(offset);
+		}
+		return(INVALID_OFFSET);
+	}
+
+	/***********************************************************
+	 *  Free()
+	 *
+	 *  Return an allocated range, merging it with the free
+	 *  ranges on either side.
+	 ***********************************************************/
+	void Free(uint32_t offset, uint32_t size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		size_t i = 0;
+		while ((i < m_freeRanges.size()) && (m_freeRanges[i].offset < offset))
+		{
+			i++;
+		}
+
+		RANGE range;
+		range.offset = offset;
+		range.size = size;
+		m_freeRanges.insert(m_freeRanges.begin() + i, range);
+		m_used -= size;
+
+		if ((i + 1 < m_freeRanges.size()) &&
+			(m_freeRanges[i].offset + m_freeRanges[i].size == m_freeRanges[i + 1].offset))
+		{
+			m_freeRanges[i].size += m_freeRanges[i + 1].size;
+			m_freeRanges.erase(m_freeRanges.begin() + i + 1);
+		}
+		if ((i > 0) &&
+			(m_freeRanges[i - 1].offset + m_freeRanges[i - 1].size == m_freeRanges[i].offset))
+		{
+			m_freeRanges[i - 1].size += m_freeRanges[i].size;
+			m_freeRanges.erase(m_freeRanges.begin() + i);
+		}
+	}
+
+	uint32_t GetSize() const { return(m_size); }
+	uint32_t GetUsed() const { return(m_used); }
+	int GetFreeRangeCount() const { return((int)m_freeRanges.size()); }
+
+private:
+	struct RANGE
+	{
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	std::vector<RANGE> m_freeRanges;
+	uint32_t m_size;
+	uint32_t m_used;
+};
@@ -113,7 +113,264 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 	glDeleteShader(VertexShaderID);
 	glDeleteShader(FragmentShaderID);
 
+	CacheUniformLocations(0, ProgramID);
+
 	return ProgramID;
 }
 
+/***********************************************************
+ *  CacheUniformLocations()
+ *
+ *  This method is called to find the location of every
+ *  active uniform of a program once it links, so setting a
+ *  uniform needs no name lookup in the driver.  Each
+ *  element of an array is listed under its own name, and
+ *  the first one under the array's name as well.
+ ***********************************************************/
+void ShaderManager::CacheUniformLocations(int program, GLuint programID)
+{
+	for (UNIFORM_LOCATIONS& uniform : m_uniforms)
+	{
+		uniform.locations[program] = -1;
+	}
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<char> activeName(maxNameLength + 1);
+
+	auto addLocation = [&](const std::string& name) {
+		GLint location = glGetUniformLocation(programID, name.c_str());
+		if (location < 0)
+		{
+			return;
+		}
+		std::vector<UNIFORM_LOCATIONS>::iterator found = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name,
+			[](const UNIFORM_LOCATIONS& uniform, const std::string& name) { return(uniform.name < name); });
+		if ((found == m_uniforms.end()) || (found->name != name))
+		{
+			UNIFORM_LOCATIONS uniform;
+			uniform.name = name;
+			std::fill(uniform.locations, uniform.locations + 1 + sharedProgramCount, -1);
+			found = m_uniforms.insert(found, uniform);
+		}
+		found->locations[program] = location;
+	};
+
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(programID, (GLuint)i, (GLsizei)activeName.size(), &nameLength, &size, &type, activeName.data());
+		std::string name(activeName.data(), nameLength);
+
+		// arrays are listed as their first element
+		size_t bracket = name.rfind("[0]");
+		if ((bracket == std::string::npos) || (bracket + 3 != name.size()))
+		{
+			addLocation(name);
+			continue;
+		}
+		std::string arrayName = name.substr(0, bracket);
+		addLocation(arrayName);
+		for (GLint element = 0; element < size; element++)
+		{
+			addLocation(arrayName + "[" + std::to_string(element) + "]");
+		}
+	}
+}
+
+/***********************************************************
+ *  FindUniform()
+ *
+ *  This method is called to find the cached locations of a
+ *  uniform by its name, with a binary search of the sorted
+ *  list.
+ ***********************************************************/
+const ShaderManager::UNIFORM_LOCATIONS* ShaderManager::FindUniform(const char* name) const
+{
+	std::vector<UNIFORM_LOCATIONS>::const_iterator found = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name,
+		[](const UNIFORM_LOCATIONS& uniform, const char* name) { return(strcmp(uniform.name.c_str(), name) < 0); });
+	if ((found == m_uniforms.end()) || (strcmp(found->name.c_str(), name) != 0))
+	{
+		return(NULL);
+	}
+	return(&(*found));
+}
+
+/***********************************************************
+ *  CompileShaderFile()
+ *
+ *  This method is called to read a GLSL file and compile
+ *  it as the passed in stage.  The compile log is printed
+ *  when there is one.
+ ***********************************************************/
+GLuint ShaderManager::CompileShaderFile(GLenum type, const char* filePath)
+{
+	std::ifstream stream(filePath, std::ios::in);
+	if (stream.is_open() == false)
+	{
+		printf("Impossible to open %s\n", filePath);
+		return(0);
+	}
+	std::stringstream code;
+	code << stream.rdbuf();
+	std::string source = code.str();
+
+	printf("Compiling shader : %s...", filePath);
+	GLuint shaderID = glCreateShader(type);
+	const char* sourcePointer = source.c_str();
+	glShaderSource(shaderID, 1, &sourcePointer, NULL);
+	glCompileShader(shaderID);
 
+	GLint result = GL_FALSE;
+	int infoLogLength = 0;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &result);
+	glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
+	if (infoLogLength > 1)
+	{
+		std::vector<char> errorMessage(infoLogLength + 1);
+		glGetShaderInfoLog(shaderID, infoLogLength, NULL, &errorMessage[0]);
+		printf("\n%s\n", &errorMessage[0]);
+	}
+	if (result == GL_FALSE)
+	{
+		printf("failed\n");
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	printf("success\n");
+	return(shaderID);
+}
+
+/***********************************************************
+ *  LoadTessellationShaders()
+ *
+ *  This method is called to load the program that draws
+ *  the round shapes from coarse patches, refined by the
+ *  control shader and put on the true surface by the
+ *  evaluation shader.  It shares the fragment shader of
+ *  the main program, and from now on every uniform set
+ *  goes to both programs.
+ ***********************************************************/
+GLuint ShaderManager::LoadTessellationShaders(
+	const char* vertexFilePath,
+	const char* controlFilePath,
+	const char* evaluationFilePath,
+	const char* fragmentFilePath)
+{
+	const GLenum STAGE_TYPES[] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER };
+	const char* filePaths[] = { vertexFilePath, controlFilePath, evaluationFilePath, fragmentFilePath };
+	return(LoadSharedProgram(tessellationProgram, STAGE_TYPES, filePaths, 4));
+}
+
+/***********************************************************
+ *  LoadBufferlessShaders()
+ *
+ *  This method is called to load the program that makes
+ *  the analytic shapes from nothing but the number of
+ *  each vertex.  It shares the fragment shader of the
+ *  main program, and from now on every uniform set goes
+ *  to both programs.
+ ***********************************************************/
+GLuint ShaderManager::LoadBufferlessShaders(
+	const char* vertexFilePath,
+	const char* fragmentFilePath)
+{
+	const GLenum STAGE_TYPES[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	const char* filePaths[] = { vertexFilePath, fragmentFilePath };
+	return(LoadSharedProgram(bufferlessProgram, STAGE_TYPES, filePaths, 2));
+}
+
+/***********************************************************
+ *  LoadDepthShaders()
+ *
+ *  This method is called to load the program the depth
+ *  pre-pass lays down the depth of the scene with.  It runs
+ *  the vertex shader of the main program, so the depth it
+ *  writes matches the main program's exactly, and its
+ *  fragment shader writes nothing.
+ ***********************************************************/
+GLuint ShaderManager::LoadDepthShaders(
+	const char* vertexFilePath,
+	const char* fragmentFilePath)
+{
+	const GLenum STAGE_TYPES[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	const char* filePaths[] = { vertexFilePath, fragmentFilePath };
+	return(LoadSharedProgram(depthProgram, STAGE_TYPES, filePaths, 2));
+}
+
+/***********************************************************
+ *  LoadSharedProgram()
+ *
+ *  This method is called to compile and link the stages
+ *  of one of the shared programs.  The program replaces
+ *  any loaded before in its place only if it builds.
+ ***********************************************************/
+GLuint ShaderManager::LoadSharedProgram(
+	SharedProgram which,
+	const GLenum* stageTypes,
+	const char* const* filePaths,
+	int stageCount)
+{
+	const int MAX_STAGES = 5;
+	const char* PROGRAM_NAMES[sharedProgramCount] = { "tessellation", "bufferless", "depth" };
+
+	GLuint programID = glCreateProgram();
+	GLuint shaderIDs[MAX_STAGES] = {};
+	bool bCompiled = (stageCount <= MAX_STAGES);
+	for (int i = 0; (i < stageCount) && (bCompiled == true); i++)
+	{
+		shaderIDs[i] = CompileShaderFile(stageTypes[i], filePaths[i]);
+		if (shaderIDs[i] == 0)
+		{
+			bCompiled = false;
+			continue;
+		}
+		glAttachShader(programID, shaderIDs[i]);
+	}
+
+	GLint result = GL_FALSE;
+	if (bCompiled == true)
+	{
+		printf("Linking %s program...", PROGRAM_NAMES[which]);
+		glLinkProgram(programID);
+
+		int infoLogLength = 0;
+		glGetProgramiv(programID, GL_LINK_STATUS, &result);
+		glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &infoLogLength);
+		if (infoLogLength > 1)
+		{
+			std::vector<char> errorMessage(infoLogLength + 1);
+			glGetProgramInfoLog(programID, infoLogLength, NULL, &errorMessage[0]);
+			printf("\n%s\n", &errorMessage[0]);
+		}
+		printf((result == GL_TRUE) ? "success\n" : "failed\n");
+	}
+
+	for (int i = 0; (i < stageCount) && (i < MAX_STAGES); i++)
+	{
+		if (shaderIDs[i] != 0)
+		{
+			glDetachShader(programID, shaderIDs[i]);
+			glDeleteShader(shaderIDs[i]);
+		}
+	}
+
+	if (result != GL_TRUE)
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	if (m_sharedProgramIDs[which] != 0)
+	{
+		glDeleteProgram(m_sharedProgramIDs[which]);
+	}
+	m_sharedProgramIDs[which] = programID;
+	CacheUniformLocations(1 + which, programID);
+	return(programID);
+}
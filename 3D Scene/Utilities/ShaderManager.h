@@ -7,6 +7,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -15,11 +16,44 @@ class ShaderManager
 {
 public:
 	unsigned int m_programID;
+	// the programs that draw the shapes another way, sharing the
+	// main fragment shader, and the program of the depth pre-pass -
+	// zero until loaded.  Every uniform set goes to them as well
+	enum SharedProgram
+	{
+		tessellationProgram,
+		bufferlessProgram,
+		depthProgram,
+		sharedProgramCount
+	};
+	unsigned int m_sharedProgramIDs[sharedProgramCount] = {};
 	
 	GLuint LoadShaders(
 		const char* vertex_file_path, 
 		const char* fragment_file_path);
 
+	// load the tessellation program, with the same fragment shader
+	// as the main one - returns 0 if it does not build
+	GLuint LoadTessellationShaders(
+		const char* vertexFilePath,
+		const char* controlFilePath,
+		const char* evaluationFilePath,
+		const char* fragmentFilePath);
+
+	// load the program that makes the analytic shapes in its vertex
+	// shader with no vertex data, with the same fragment shader as
+	// the main one - returns 0 if it does not build
+	GLuint LoadBufferlessShaders(
+		const char* vertexFilePath,
+		const char* fragmentFilePath);
+
+	// load the program of the depth pre-pass, with the vertex shader
+	// of the main one and a fragment shader that does nothing -
+	// returns 0 if it does not build
+	GLuint LoadDepthShaders(
+		const char* vertexFilePath,
+		const char* fragmentFilePath);
+
 	// activate the shader
 	// ------------------------------------------------------------------------
 	inline void use()
@@ -27,77 +61,174 @@ public:
 		glUseProgram(m_programID);
 	}
 
-	// utility uniform functions
+	// utility uniform functions, which set the uniform of the
+	// shared programs too when they are loaded - the main program
+	// is set whichever program is in use.  The locations are found
+	// once, when each program links
 	// ------------------------------------------------------------------------
-	inline void setBoolValue(const std::string &name, bool value) const
+	inline void setBoolValue(const char* name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform1i(programID, location, (int)value);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setIntValue(const std::string &name, int value) const
+	inline void setIntValue(const char* name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform1i(programID, location, value);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setFloatValue(const std::string &name, float value) const
+	inline void setFloatValue(const char* name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform1f(programID, location, value);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
+	inline void setVec2Value(const char* name, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform2fv(programID, location, 1, &value[0]);
+		});
 	}
 
-	inline void setVec2Value(const std::string &name, float x, float y) const
+	inline void setVec2Value(const char* name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform2f(programID, location, x, y);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
+	inline void setIVec2Value(const char* name, int x, int y) const
 	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform2i(programID, location, x, y);
+		});
 	}
-	inline void setVec3Value(const std::string &name, float x, float y, float z) const
+
+	// ------------------------------------------------------------------------
+	inline void setIVec4ArrayValue(const char* name, const int* values, int count) const
 	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform4iv(programID, location, count, values);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
+	inline void setVec3Value(const char* name, const glm::vec3 &value) const
 	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform3fv(programID, location, 1, &value[0]);
+		});
 	}
-	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
+	inline void setVec3Value(const char* name, float x, float y, float z) const
 	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform3f(programID, location, x, y, z);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
+	inline void setVec4Value(const char* name, const glm::vec4 &value) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform4fv(programID, location, 1, &value[0]);
+		});
+	}
+	inline void setVec4Value(const char* name, float x, float y, float z, float w)
+	{
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform4f(programID, location, x, y, z, w);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
+	inline void setMat2Value(const char* name, const glm::mat2 &mat) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniformMatrix2fv(programID, location, 1, GL_FALSE, &mat[0][0]);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
+	inline void setMat3Value(const char* name, const glm::mat3 &mat) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniformMatrix3fv(programID, location, 1, GL_FALSE, &mat[0][0]);
+		});
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setSampler2DValue(const std::string& name, const int &value) const
+	inline void setMat4Value(const char* name, const glm::mat4 &mat) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniformMatrix4fv(programID, location, 1, GL_FALSE, glm::value_ptr(mat));
+		});
 	}
-};
\ No newline at end of file
+
+	// ------------------------------------------------------------------------
+	inline void setSampler2DValue(const char* name, const int &value) const
+	{
+		SetUniform(name, [&](GLuint programID, GLint location) {
+			glProgramUniform1i(programID, location, value);
+		});
+	}
+
+private:
+	// the location of one uniform in the main program, then in
+	// each shared program - -1 where the program does not have it
+	struct UNIFORM_LOCATIONS
+	{
+		std::string name;
+		GLint locations[1 + sharedProgramCount];
+	};
+	// the active uniforms of every loaded program, sorted by name
+	std::vector<UNIFORM_LOCATIONS> m_uniforms;
+
+	// find the location of every active uniform of a program that
+	// just linked, for the main program (0) or a shared one (1 on)
+	void CacheUniformLocations(int program, GLuint programID);
+	// the cached locations of a uniform - NULL if no loaded
+	// program has it
+	const UNIFORM_LOCATIONS* FindUniform(const char* name) const;
+
+	// call set with each loaded program that has the uniform, and
+	// the uniform's location in it
+	template <typename SET>
+	void SetUniform(const char* name, SET set) const
+	{
+		const UNIFORM_LOCATIONS* uniform = FindUniform(name);
+		if (uniform == NULL)
+		{
+			return;
+		}
+		if (uniform->locations[0] >= 0)
+		{
+			set(m_programID, uniform->locations[0]);
+		}
+		for (int i = 0; i < sharedProgramCount; i++)
+		{
+			if ((m_sharedProgramIDs[i] != 0) && (uniform->locations[1 + i] >= 0))
+			{
+				set(m_sharedProgramIDs[i], uniform->locations[1 + i]);
+			}
+		}
+	}
+
+	// compile one stage from a GLSL file - returns 0 if it is
+	// missing or does not compile
+	static GLuint CompileShaderFile(GLenum type, const char* filePath);
+	// compile and link the stages of a shared program in place
+	// of any loaded before - returns 0 if it does not build
+	GLuint LoadSharedProgram(
+		SharedProgram which,
+		const GLenum* stageTypes,
+		const char* const* filePaths,
+		int stageCount);
+};
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// slotmap.h
+// ============
+// generational slot map - stores resources in a flat array and hands out
+// handles that stay O(1) to resolve and detect use after destruction
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SlotMap
+ *
+ *  Entries live in a flat array of slots.  A handle stores
+ *  the slot index plus the generation of the slot when the
+ *  entry was inserted.  Removing an entry bumps the slot's
+ *  generation, so every handle to it resolves to NULL from
+ *  then on, even after the slot is reused.
+ ***********************************************************/
+template<typename T>
+class SlotMap
+{
+public:
+	// reference to an entry in the slot map
+	struct Handle
+	{
+		uint32_t index;
+		uint32_t generation;
+
+		// default handles never resolve to an entry
+		Handle() : index(0xFFFFFFFF), generation(0) {}
+
+		bool IsNull() const { return(index == 0xFFFFFFFF); }
+		bool operator==(const Handle& other) const { return((index == other.index) && (generation == other.generation)); }
+		bool operator!=(const Handle& other) const { return(!(*this == other)); }
+	};
+
+	/***********************************************************
+	 *  Insert()
+	 *
+	 *  Store a copy of the value, reusing a free slot if there
+	 *  is one, and return its handle.
+	 ***********************************************************/
+	Handle Insert(const T& value)
+	{
+		uint32_t index = 0;
+		if (m_freeSlots.size() > 0)
+		{
+			index = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)m_slots.size();
+			SLOT slot;
+			// generation zero is reserved for null handles
+			slot.generation = 1;
+			slot.bAlive = false;
+			m_slots.push_back(slot);
+		}
+
+		m_slots[index].value = value;
+		m_slots[index].bAlive = true;
+
+		Handle handle;
+		handle.index = index;
+		handle.generation = m_slots[index].generation;
+		return(handle);
+	}
+
+	/***********************************************************
+	 *  Remove()
+	 *
+	 *  Free the entry the handle refers to.  Returns false if
+	 *  the handle was already stale.
+	 ***********************************************************/
+	bool Remove(Handle handle)
+	{
+		if (IsValid(handle) == false)
+		{
+			return(false);
+		}
+
+		SLOT& slot = m_slots[handle.index];
+		slot.value = T();
+		slot.bAlive = false;
+		slot.generation++;
+		m_freeSlots.push_back(handle.index);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  Clear()
+	 *
+	 *  Free every entry - all outstanding handles become stale.
+	 ***********************************************************/
+	void Clear()
+	{
+		for (uint32_t i = 0; i < (uint32_t)m_slots.size(); i++)
+		{
+			if (m_slots[i].bAlive == true)
+			{
+				Handle handle;
+				handle.index = i;
+				handle.generation = m_slots[i].generation;
+				Remove(handle);
+			}
+		}
+	}
+
+	bool IsValid(Handle handle) const
+	{
+		return((handle.index < (uint32_t)m_slots.size()) &&
+			(m_slots[handle.index].bAlive == true) &&
+			(m_slots[handle.index].generation == handle.generation));
+	}
+
+	// resolve a handle - NULL when it is null or stale
+	T* Get(Handle handle)
+	{
+		return(IsValid(handle) ? &m_slots[handle.index].value : NULL);
+	}
+	const T* Get(Handle handle) const
+	{
+		return(IsValid(handle) ? &m_slots[handle.index].value : NULL);
+	}
+
+	// slot access for walking all entries - dead slots return NULL
+	int SlotCount() const { return((int)m_slots.size()); }
+	T* GetAt(int index)
+	{
+		return(m_slots[index].bAlive ? &m_slots[index].value : NULL);
+	}
+	const T* GetAt(int index) const
+	{
+		return(m_slots[index].bAlive ? &m_slots[index].value : NULL);
+	}
+	Handle HandleAt(int index) const
+	{
+		Handle handle;
+		if (m_slots[index].bAlive == true)
+		{
+			handle.index = (uint32_t)index;
+			handle.generation = m_slots[index].generation;
+		}
+		return(handle);
+	}
+
+	int Size() const { return((int)(m_slots.size() - m_freeSlots.size())); }
+
+private:
+	struct SLOT
+	{
+		T value;
+		uint32_t generation;
+		bool bAlive;
+	};
+
+	std::vector<SLOT> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+};
@@ -0,0 +1,455 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.cpp
+// ============
+// pack small texture images into shared atlas textures so that draws
+// using them no longer need a texture switch
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+/***********************************************************
+ *  TextureAtlas()
+ *
+ *  The constructor for the class.  Images up to maxImageSize
+ *  in both dimensions are packed into pages of at most
+ *  maxPageSize.  The first mipPadLevels mip levels of every
+ *  page are guaranteed not to bleed between packed images.
+ ***********************************************************/
+TextureAtlas::TextureAtlas(
+	int maxImageSize,
+	int maxPageSize,
+	int mipPadLevels)
+{
+	m_maxImageSize = maxImageSize;
+	m_maxPageSize = maxPageSize;
+	m_mipPadLevels = mipPadLevels;
+}
+
+/***********************************************************
+ *  GutterSize()
+ *
+ *  The gutter around each image is as wide as the alignment
+ *  of the packed cells, which leaves at least one texel of
+ *  gutter at the last padded mip level.
+ ***********************************************************/
+int TextureAtlas::GutterSize() const
+{
+	return(1 << m_mipPadLevels);
+}
+
+/***********************************************************
+ *  PaddedSize()
+ *
+ *  This method returns the size of the atlas cell used for an
+ *  image dimension - the image plus its gutters, rounded up
+ *  so every cell starts on a texel of each padded mip level.
+ ***********************************************************/
+int TextureAtlas::PaddedSize(int size) const
+{
+	int alignment = 1 << m_mipPadLevels;
+	int padded = size + (2 * GutterSize());
+
+	return(((padded + alignment - 1) / alignment) * alignment);
+}
+
+/***********************************************************
+ *  CanPackImage()
+ *
+ *  This method is used for checking whether a decoded image
+ *  is a candidate for the atlas.
+ ***********************************************************/
+bool TextureAtlas::CanPackImage(int width, int height, int colorChannels) const
+{
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		return(false);
+	}
+	if ((width > m_maxImageSize) || (height > m_maxImageSize))
+	{
+		return(false);
+	}
+
+	return((PaddedSize(width) <= m_maxPageSize) && (PaddedSize(height) <= m_maxPageSize));
+}
+
+/***********************************************************
+ *  AddImage()
+ *
+ *  This method is used for queueing a decoded image to be
+ *  packed into an atlas page.  The pixel data is copied so
+ *  the caller can free the image right away.
+ ***********************************************************/
+bool TextureAtlas::AddImage(
+	const unsigned char* image,
+	int width,
+	int height,
+	int colorChannels,
+	std::string tag)
+{
+	if ((image == NULL) || (CanPackImage(width, height, colorChannels) == false))
+	{
+		return(false);
+	}
+
+	PENDING_IMAGE pending;
+	pending.tag = tag;
+	pending.width = width;
+	pending.height = height;
+	pending.channels = colorChannels;
+	pending.pixels.assign(image, image + ((size_t)width * height * colorChannels));
+	m_pending.push_back(pending);
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindSkylinePosition()
+ *
+ *  This method is used for finding the skyline node where a
+ *  rectangle can be placed with the lowest top edge.  The
+ *  index of the node is returned, or -1 if it does not fit.
+ ***********************************************************/
+int TextureAtlas::FindSkylinePosition(
+	const std::vector<SKYLINE_NODE>& skyline,
+	int width,
+	int height,
+	int pageWidth,
+	int pageHeight,
+	int& bestX,
+	int& bestY) const
+{
+	int bestIndex = -1;
+	int bestTop = pageHeight + 1;
+
+	for (int i = 0; i < (int)skyline.size(); i++)
+	{
+		int x = skyline[i].x;
+		if ((x + width) > pageWidth)
+		{
+			break;
+		}
+
+		// the rectangle rests on the highest node it spans
+		int y = 0;
+		int remaining = width;
+		int node = i;
+		while ((remaining > 0) && (node < (int)skyline.size()))
+		{
+			y = std::max(y, skyline[node].y);
+			remaining -= skyline[node].width;
+			node++;
+		}
+
+		if (((y + height) <= pageHeight) && ((y + height) < bestTop))
+		{
+			bestTop = y + height;
+			bestIndex = i;
+			bestX = x;
+			bestY = y;
+		}
+	}
+
+	return(bestIndex);
+}
+
+/***********************************************************
+ *  AddSkylineLevel()
+ *
+ *  This method is used for raising the skyline over a newly
+ *  placed rectangle and merging nodes of equal height.
+ ***********************************************************/
+void TextureAtlas::AddSkylineLevel(
+	std::vector<SKYLINE_NODE>& skyline,
+	int index,
+	int x,
+	int y,
+	int width,
+	int height) const
+{
+	SKYLINE_NODE node;
+	node.x = x;
+	node.y = y + height;
+	node.width = width;
+	skyline.insert(skyline.begin() + index, node);
+
+	// shrink or remove the nodes now covered by the new one
+	int i = index + 1;
+	while (i < (int)skyline.size())
+	{
+		int coveredEnd = skyline[i - 1].x + skyline[i - 1].width;
+		if (skyline[i].x >= coveredEnd)
+		{
+			break;
+		}
+
+		int shrink = coveredEnd - skyline[i].x;
+		skyline[i].x += shrink;
+		skyline[i].width -= shrink;
+		if (skyline[i].width <= 0)
+		{
+			skyline.erase(skyline.begin() + i);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// merge neighbouring nodes at the same height
+	i = 0;
+	while (i < ((int)skyline.size() - 1))
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+/***********************************************************
+ *  PackPage()
+ *
+ *  This method is used for placing as many of the passed in
+ *  images as possible into a page of the given size.
+ ***********************************************************/
+void TextureAtlas::PackPage(
+	const std::vector<int>& images,
+	int pageWidth,
+	int pageHeight,
+	std::vector<PLACEMENT>& placements) const
+{
+	std::vector<SKYLINE_NODE> skyline;
+	SKYLINE_NODE ground;
+	ground.x = 0;
+	ground.y = 0;
+	ground.width = pageWidth;
+	skyline.push_back(ground);
+
+	placements.clear();
+	for (int i = 0; i < (int)images.size(); i++)
+	{
+		const PENDING_IMAGE& image = m_pending[images[i]];
+		int width = PaddedSize(image.width);
+		int height = PaddedSize(image.height);
+		int x = 0;
+		int y = 0;
+
+		int index = FindSkylinePosition(skyline, width, height, pageWidth, pageHeight, x, y);
+		if (index >= 0)
+		{
+			AddSkylineLevel(skyline, index, x, y, width, height);
+
+			PLACEMENT placement;
+			placement.image = images[i];
+			placement.x = x;
+			placement.y = y;
+			placements.push_back(placement);
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildPage()
+ *
+ *  This method is used for copying the placed images into a
+ *  page buffer, filling the gutters by wrapping the image
+ *  around its edges, and uploading the page to OpenGL.
+ ***********************************************************/
+void TextureAtlas::BuildPage(
+	const std::vector<PLACEMENT>& placements,
+	int pageWidth,
+	int pageHeight,
+	int colorChannels)
+{
+	std::vector<unsigned char> pixels((size_t)pageWidth * pageHeight * colorChannels, 0);
+	int gutter = GutterSize();
+	int pageIndex = (int)m_pages.size();
+
+	for (int i = 0; i < (int)placements.size(); i++)
+	{
+		const PENDING_IMAGE& image = m_pending[placements[i].image];
+		int cellWidth = PaddedSize(image.width);
+		int cellHeight = PaddedSize(image.height);
+
+		// the gutters repeat the opposite edge of the image, which
+		// matches how the texture filtered with GL_REPEAT on its own
+		for (int y = 0; y < cellHeight; y++)
+		{
+			int sourceY = (((y - gutter) % image.height) + image.height) % image.height;
+			unsigned char* row = &pixels[(((size_t)(placements[i].y + y) * pageWidth) + placements[i].x) * colorChannels];
+			const unsigned char* sourceRow = &image.pixels[(size_t)sourceY * image.width * colorChannels];
+			for (int x = 0; x < cellWidth; x++)
+			{
+				int sourceX = (((x - gutter) % image.width) + image.width) % image.width;
+				memcpy(&row[x * colorChannels], &sourceRow[sourceX * colorChannels], colorChannels);
+			}
+		}
+
+		ATLAS_REGION region;
+		region.tag = image.tag;
+		region.page = pageIndex;
+		region.uvScale = glm::vec2(
+			(float)image.width / (float)pageWidth,
+			(float)image.height / (float)pageHeight);
+		region.uvOffset = glm::vec2(
+			(float)(placements[i].x + gutter) / (float)pageWidth,
+			(float)(placements[i].y + gutter) / (float)pageHeight);
+		m_regions.push_back(region);
+	}
+
+	ATLAS_PAGE page;
+	page.width = pageWidth;
+	page.height = pageHeight;
+	page.channels = colorChannels;
+	page.ID = 0;
+
+	glGenTextures(1, &page.ID);
+	glBindTexture(GL_TEXTURE_2D, page.ID);
+
+	// the page itself never repeats - tiling is done per region in the shader
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// coarser mips would mix neighbouring images, so they are never sampled
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_mipPadLevels);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (colorChannels == 3)
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, pageWidth, pageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+	else
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pageWidth, pageHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	m_pages.push_back(page);
+
+	std::cout << "Packed texture atlas page " << pageIndex << ", width:" << pageWidth << ", height:" << pageHeight << ", images:" << placements.size() << std::endl;
+}
+
+/***********************************************************
+ *  PackAndUpload()
+ *
+ *  This method is used for packing all the queued images.
+ *  Images are grouped by channel count, sorted by height and
+ *  packed with a skyline bottom-left heuristic.  Each page
+ *  starts at the smallest power of two that could hold the
+ *  remaining images and grows until they fit or the maximum
+ *  page size is reached, in which case a new page is started.
+ ***********************************************************/
+bool TextureAtlas::PackAndUpload()
+{
+	int channelGroups[2] = { 3, 4 };
+
+	for (int group = 0; group < 2; group++)
+	{
+		std::vector<int> remaining;
+		for (int i = 0; i < (int)m_pending.size(); i++)
+		{
+			if (m_pending[i].channels == channelGroups[group])
+			{
+				remaining.push_back(i);
+			}
+		}
+
+		// taller images first gives the skyline the flattest profile
+		std::sort(remaining.begin(), remaining.end(), [this](int a, int b)
+			{
+				if (m_pending[a].height != m_pending[b].height)
+					return(m_pending[a].height > m_pending[b].height);
+				return(m_pending[a].width > m_pending[b].width);
+			});
+
+		while (remaining.size() > 0)
+		{
+			// start from the smallest page that could hold all the images
+			size_t totalArea = 0;
+			int pageWidth = 1 << m_mipPadLevels;
+			int pageHeight = 1 << m_mipPadLevels;
+			for (int i = 0; i < (int)remaining.size(); i++)
+			{
+				int width = PaddedSize(m_pending[remaining[i]].width);
+				int height = PaddedSize(m_pending[remaining[i]].height);
+				totalArea += (size_t)width * height;
+				while (pageWidth < width) pageWidth *= 2;
+				while (pageHeight < height) pageHeight *= 2;
+			}
+			while (((size_t)pageWidth * pageHeight) < totalArea)
+			{
+				if ((pageWidth <= pageHeight) && (pageWidth < m_maxPageSize))
+					pageWidth *= 2;
+				else if (pageHeight < m_maxPageSize)
+					pageHeight *= 2;
+				else
+					break;
+			}
+			pageWidth = std::min(pageWidth, m_maxPageSize);
+			pageHeight = std::min(pageHeight, m_maxPageSize);
+
+			std::vector<PLACEMENT> placements;
+			PackPage(remaining, pageWidth, pageHeight, placements);
+			while ((placements.size() < remaining.size()) &&
+				((pageWidth < m_maxPageSize) || (pageHeight < m_maxPageSize)))
+			{
+				if (((pageWidth <= pageHeight) && (pageWidth < m_maxPageSize)) || (pageHeight >= m_maxPageSize))
+					pageWidth *= 2;
+				else
+					pageHeight *= 2;
+				PackPage(remaining, pageWidth, pageHeight, placements);
+			}
+
+			if (placements.size() == 0)
+			{
+				std::cout << "Could not pack texture atlas images" << std::endl;
+				return(false);
+			}
+
+			// trim the unused top of the page, keeping the cell alignment
+			int usedHeight = 0;
+			for (int i = 0; i < (int)placements.size(); i++)
+			{
+				usedHeight = std::max(usedHeight, placements[i].y + PaddedSize(m_pending[placements[i].image].height));
+			}
+			pageHeight = usedHeight;
+
+			BuildPage(placements, pageWidth, pageHeight, channelGroups[group]);
+
+			for (int i = 0; i < (int)placements.size(); i++)
+			{
+				remaining.erase(std::find(remaining.begin(), remaining.end(), placements[i].image));
+			}
+		}
+	}
+
+	// the decoded images are no longer needed once uploaded
+	m_pending.clear();
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrintRegionTable()
+ *
+ *  This method is used for writing the UV scale and offset of
+ *  every packed image, indexed by its original tag.
+ ***********************************************************/
+void TextureAtlas::PrintRegionTable(std::ostream& out) const
+{
+	for (int i = 0; i < (int)m_regions.size(); i++)
+	{
+		out << "Atlas region:" << m_regions[i].tag
+			<< ", page:" << m_regions[i].page
+			<< ", scale:" << m_regions[i].uvScale.x << "," << m_regions[i].uvScale.y
+			<< ", offset:" << m_regions[i].uvOffset.x << "," << m_regions[i].uvOffset.y << std::endl;
+	}
+}
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.h
+// ============
+// pack small texture images into shared atlas textures so that draws
+// using them no longer need a texture switch
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureAtlas
+ *
+ *  This class collects decoded texture images, packs the
+ *  compatible ones into shared atlas pages using a skyline
+ *  packer, and keeps the UV scale/offset of every packed
+ *  image so texture coordinates can be remapped.
+ ***********************************************************/
+class TextureAtlas
+{
+public:
+	// constructor
+	TextureAtlas(
+		int maxImageSize = 640,
+		int maxPageSize = 2048,
+		int mipPadLevels = 4);
+
+	// region of an atlas page that an original texture was packed into
+	struct ATLAS_REGION
+	{
+		std::string tag;
+		int page;				// index of the atlas page holding the image
+		glm::vec2 uvScale;		// scale from the original 0..1 UVs into the page
+		glm::vec2 uvOffset;		// offset of the image within the page
+	};
+
+	// a packed and uploaded atlas texture
+	struct ATLAS_PAGE
+	{
+		GLuint ID;
+		int width;
+		int height;
+		int channels;
+	};
+
+	// check whether an image is small enough to be packed
+	bool CanPackImage(int width, int height, int colorChannels) const;
+	// queue a decoded image for packing - the pixels are copied
+	bool AddImage(
+		const unsigned char* image,
+		int width,
+		int height,
+		int colorChannels,
+		std::string tag);
+	// pack all queued images into pages and upload them to OpenGL
+	bool PackAndUpload();
+
+	const std::vector<ATLAS_PAGE>& GetPages() const { return m_pages; }
+	const std::vector<ATLAS_REGION>& GetRegions() const { return m_regions; }
+
+	// write the UV scale/offset table of all packed regions
+	void PrintRegionTable(std::ostream& out) const;
+
+private:
+	// an image waiting to be packed
+	struct PENDING_IMAGE
+	{
+		std::string tag;
+		int width;
+		int height;
+		int channels;
+		std::vector<unsigned char> pixels;
+	};
+
+	// a horizontal segment of the skyline
+	struct SKYLINE_NODE
+	{
+		int x;
+		int y;
+		int width;
+	};
+
+	// placement of a padded image within a page
+	struct PLACEMENT
+	{
+		int image;
+		int x;
+		int y;
+	};
+
+	// largest width/height of an image that is still packed
+	int m_maxImageSize;
+	// largest width/height of an atlas page
+	int m_maxPageSize;
+	// number of mip levels that stay free of bleeding between images
+	int m_mipPadLevels;
+
+	std::vector<PENDING_IMAGE> m_pending;
+	std::vector<ATLAS_PAGE> m_pages;
+	std::vector<ATLAS_REGION> m_regions;
+
+	// padded and aligned size of an image inside a page
+	int PaddedSize(int size) const;
+	// gutter width around each image at mip level zero
+	int GutterSize() const;
+
+	// try to place the images into a page of the given size
+	void PackPage(
+		const std::vector<int>& images,
+		int pageWidth,
+		int pageHeight,
+		std::vector<PLACEMENT>& placements) const;
+	// find the lowest skyline position for a rectangle
+	int FindSkylinePosition(
+		const std::vector<SKYLINE_NODE>& skyline,
+		int width,
+		int height,
+		int pageWidth,
+		int pageHeight,
+		int& bestX,
+		int& bestY) const;
+	// raise the skyline over a newly placed rectangle
+	void AddSkylineLevel(
+		std::vector<SKYLINE_NODE>& skyline,
+		int index,
+		int x,
+		int y,
+		int width,
+		int height) const;
+
+	// copy the images into a page buffer and upload it
+	void BuildPage(
+		const std::vector<PLACEMENT>& placements,
+		int pageWidth,
+		int pageHeight,
+		int colorChannels);
+};
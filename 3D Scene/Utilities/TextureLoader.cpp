@@ -0,0 +1,235 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.cpp
+// ============
+// decode texture images and build their mip chains on a background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLoader.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  The constructor for the class.  Images are flipped
+ *  vertically while decoding, like every texture loaded for
+ *  the scene, so the JPEG decoder should flip them too.
+ ***********************************************************/
+TextureLoader::TextureLoader(const MipGenerator* pMipGenerator, const JpegDecoder* pJpegDecoder)
+{
+	m_pMipGenerator = pMipGenerator;
+	m_pJpegDecoder = pJpegDecoder;
+	m_inProgress = 0;
+	m_generation = 0;
+	m_bStopping = false;
+
+	stbi_set_flip_vertically_on_load(true);
+	m_worker = std::thread(&TextureLoader::WorkerLoop, this);
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  The destructor for the class.  Queued images are dropped
+ *  and the worker finishes the image it is decoding.
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+		m_requests.clear();
+	}
+	m_wakeWorker.notify_all();
+	m_worker.join();
+}
+
+/***********************************************************
+ *  Request()
+ *
+ *  Queue an image file to be decoded.  The result can be
+ *  taken with PollLoaded() once it is ready.
+ ***********************************************************/
+void TextureLoader::Request(int id, const std::string& filename, bool bColorPlanes, int maxSize)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		LOAD_REQUEST request;
+		request.id = id;
+		request.filename = filename;
+		request.bColorPlanes = bColorPlanes;
+		request.maxSize = maxSize;
+		m_requests.push_back(request);
+	}
+	m_wakeWorker.notify_one();
+}
+
+/***********************************************************
+ *  PollLoaded()
+ *
+ *  Take the oldest finished image without waiting.  Returns
+ *  false if no image is finished.
+ ***********************************************************/
+bool TextureLoader::PollLoaded(LOADED_TEXTURE& texture)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_loaded.size() == 0)
+	{
+		return(false);
+	}
+
+	texture = std::move(m_loaded.front());
+	m_loaded.pop_front();
+	return(true);
+}
+
+/***********************************************************
+ *  CancelAll()
+ *
+ *  Drop all queued and finished images.  The image being
+ *  decoded right now is dropped when it finishes.
+ ***********************************************************/
+void TextureLoader::CancelAll()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_requests.clear();
+	m_loaded.clear();
+	m_generation++;
+}
+
+/***********************************************************
+ *  IsBusy()
+ *
+ *  Check whether any requested image is still queued, being
+ *  decoded, or waiting to be polled.
+ ***********************************************************/
+bool TextureLoader::IsBusy()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return((m_requests.size() > 0) || (m_inProgress > 0) || (m_loaded.size() > 0));
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  Decode queued images one at a time until the loader is
+ *  destroyed.  Baseline JPEG files are decoded with the
+ *  SIMD decoder and everything else with stb_image.  JPEG
+ *  files requested as color planes skip the upsampling,
+ *  color conversion and mip chain, which the GPU builds.
+ *  Images larger than the requested size are reduced while
+ *  decoding by the JPEG decoder, and other files lose the
+ *  mip levels larger than the size once decoded.  The
+ *  mip generator splits each level's rows between its own
+ *  threads.
+ ***********************************************************/
+void TextureLoader::WorkerLoop()
+{
+	while (true)
+	{
+		LOAD_REQUEST request;
+		unsigned int generation = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeWorker.wait(lock, [this]() { return((m_bStopping == true) || (m_requests.size() > 0)); });
+			if (m_bStopping == true)
+			{
+				return;
+			}
+			request = m_requests.front();
+			m_requests.pop_front();
+			generation = m_generation;
+			m_inProgress++;
+		}
+
+		LOADED_TEXTURE texture;
+		texture.id = request.id;
+		texture.filename = request.filename;
+		texture.bLoaded = false;
+		texture.width = 0;
+		texture.height = 0;
+		texture.colorChannels = 0;
+		texture.bColorPlanes = false;
+
+		if ((request.bColorPlanes == true) &&
+			(m_pJpegDecoder->DecodePlanesFile(request.filename.c_str(), texture.planes, request.maxSize) == true))
+		{
+			texture.width = texture.planes.width;
+			texture.height = texture.planes.height;
+			texture.colorChannels = texture.planes.componentCount;
+			texture.bColorPlanes = true;
+			texture.bLoaded = true;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_inProgress--;
+			if (generation == m_generation)
+			{
+				m_loaded.push_back(std::move(texture));
+			}
+			continue;
+		}
+
+		JpegDecoder::JPEG_IMAGE jpegImage;
+		unsigned char* stbImage = NULL;
+		const unsigned char* image = NULL;
+		if (m_pJpegDecoder->DecodeFile(request.filename.c_str(), jpegImage, request.maxSize) == true)
+		{
+			texture.width = jpegImage.width;
+			texture.height = jpegImage.height;
+			texture.colorChannels = jpegImage.colorChannels;
+			image = jpegImage.pixels.data();
+		}
+		else
+		{
+			stbImage = stbi_load(
+				request.filename.c_str(),
+				&texture.width,
+				&texture.height,
+				&texture.colorChannels,
+				0);
+			image = stbImage;
+		}
+		if (image != NULL)
+		{
+			MipGenerator::MIP_IMAGE mipImage;
+			mipImage.pixels = image;
+			mipImage.width = texture.width;
+			mipImage.height = texture.height;
+			mipImage.colorChannels = texture.colorChannels;
+			texture.bLoaded = m_pMipGenerator->GenerateMipChain(mipImage);
+			texture.levels.swap(mipImage.levels);
+
+			// stb_image cannot decode at a reduced size, and the
+			// JPEG decoder reduces by 8 at most, so any levels
+			// still over the limit are dropped
+			if (request.maxSize > 0)
+			{
+				size_t first = 0;
+				while ((first + 1 < texture.levels.size()) &&
+					(std::max(texture.levels[first].width, texture.levels[first].height) > request.maxSize))
+				{
+					first++;
+				}
+				texture.levels.erase(texture.levels.begin(), texture.levels.begin() + first);
+				if (texture.levels.size() > 0)
+				{
+					texture.width = texture.levels[0].width;
+					texture.height = texture.levels[0].height;
+				}
+			}
+		}
+		if (stbImage != NULL)
+		{
+			stbi_image_free(stbImage);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_inProgress--;
+		if (generation == m_generation)
+		{
+			m_loaded.push_back(std::move(texture));
+		}
+	}
+}
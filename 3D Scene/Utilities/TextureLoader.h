@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.h
+// ============
+// decode texture images and build their mip chains on a background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MipGenerator.h"
+#include "JpegDecoder.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/***********************************************************
+ *  TextureLoader
+ *
+ *  This class owns a worker thread that decodes requested
+ *  image files and builds their mip chains.  It never calls
+ *  OpenGL - the render thread polls the finished images and
+ *  uploads them itself.
+ ***********************************************************/
+class TextureLoader
+{
+public:
+	// a finished load, successful or not
+	struct LOADED_TEXTURE
+	{
+		int id;
+		std::string filename;
+		bool bLoaded;
+		int width;
+		int height;
+		int colorChannels;
+		std::vector<MipGenerator::MIP_LEVEL> levels;
+		// set when the JPEG planes were kept for conversion on the GPU,
+		// in place of the mip levels
+		bool bColorPlanes;
+		JpegDecoder::JPEG_PLANES planes;
+	};
+
+	// constructor - the mip generator and JPEG decoder must outlive the loader
+	TextureLoader(const MipGenerator* pMipGenerator, const JpegDecoder* pJpegDecoder);
+	// destructor - waits for the image being decoded
+	~TextureLoader();
+
+	// queue an image file to be loaded under the given id, baseline
+	// JPEG files are left as color planes when bColorPlanes is set,
+	// and images are reduced to at most maxSize when it is positive
+	void Request(int id, const std::string& filename, bool bColorPlanes = false, int maxSize = 0);
+	// take one finished image, returns false if none is ready
+	bool PollLoaded(LOADED_TEXTURE& texture);
+	// drop every queued and finished image
+	void CancelAll();
+	// check whether any requested image is not polled yet
+	bool IsBusy();
+
+private:
+	// a queued image file
+	struct LOAD_REQUEST
+	{
+		int id;
+		std::string filename;
+		bool bColorPlanes;
+		int maxSize;
+	};
+
+	const MipGenerator* m_pMipGenerator;
+	const JpegDecoder* m_pJpegDecoder;
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeWorker;
+	std::deque<LOAD_REQUEST> m_requests;
+	std::deque<LOADED_TEXTURE> m_loaded;
+	// images the worker is decoding right now
+	int m_inProgress;
+	// bumped by CancelAll() so in flight results are dropped
+	unsigned int m_generation;
+	bool m_bStopping;
+
+	// worker thread loop
+	void WorkerLoop();
+};
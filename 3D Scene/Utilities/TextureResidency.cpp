@@ -0,0 +1,370 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.cpp
+// ============
+// keep texture mip levels resident on the GPU only while the current view
+// needs them, within a fixed video memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cmath>
+
+/***********************************************************
+ *  TextureResidency()
+ *
+ *  The constructor for the class.  Levels whose width and
+ *  height are at most tailSize always stay resident, so
+ *  every texture can be drawn without waiting on a stream.
+ ***********************************************************/
+TextureResidency::TextureResidency(
+	size_t budgetBytes,
+	size_t maxUploadBytesPerFrame,
+	int tailSize)
+{
+	m_budgetBytes = budgetBytes;
+	m_maxUploadBytesPerFrame = maxUploadBytesPerFrame;
+	m_tailSize = tailSize;
+	m_residentBytes = 0;
+	m_frame = 0;
+}
+
+/***********************************************************
+ *  ~TextureResidency()
+ *
+ *  The destructor for the class.  The textures themselves
+ *  belong to the caller that registered them.
+ ***********************************************************/
+TextureResidency::~TextureResidency()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  RegisterTexture()
+ *
+ *  Take over the streaming of a texture.  The mip chain is
+ *  moved out of the passed in vector and only the levels of
+ *  the mip tail are uploaded; finer levels are streamed in
+ *  once a draw asks for them.  Returns the index used to
+ *  request levels.
+ ***********************************************************/
+int TextureResidency::RegisterTexture(
+	GLuint textureID,
+	int colorChannels,
+	std::vector<MipGenerator::MIP_LEVEL>& levels)
+{
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		std::cout << "Texture residency cannot stream images with " << colorChannels << " channels" << std::endl;
+		return(-1);
+	}
+	if (levels.size() == 0)
+	{
+		return(-1);
+	}
+
+	RESIDENT_TEXTURE texture;
+	texture.ID = textureID;
+	texture.colorChannels = colorChannels;
+	texture.internalFormat = (colorChannels == 4) ? GL_RGBA8 : GL_RGB8;
+	texture.format = (colorChannels == 4) ? GL_RGBA : GL_RGB;
+	texture.requestedLevel = 0;
+	texture.lastUsedFrame = 0;
+	texture.levels.swap(levels);
+
+	// the mip tail starts at the first level small enough
+	texture.tailLevel = (int)texture.levels.size() - 1;
+	for (int i = 0; i < (int)texture.levels.size(); i++)
+	{
+		if ((texture.levels[i].width <= m_tailSize) && (texture.levels[i].height <= m_tailSize))
+		{
+			texture.tailLevel = i;
+			break;
+		}
+	}
+
+	for (int i = (int)texture.levels.size() - 1; i >= texture.tailLevel; i--)
+	{
+		UploadLevel(texture, i);
+		m_residentBytes += LevelBytes(texture.levels[i]);
+	}
+	texture.residentLevel = texture.tailLevel;
+
+	// remember the texture bound to the active unit, since the
+	// scene binds its textures to fixed units up front
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.tailLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	m_textures.push_back(texture);
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  LevelBytes()
+ *
+ *  Get the estimated GPU memory of a mip level.  Drivers pad
+ *  3 channel textures to 4 bytes per texel.
+ ***********************************************************/
+size_t TextureResidency::LevelBytes(const MipGenerator::MIP_LEVEL& level)
+{
+	return((size_t)level.width * level.height * 4);
+}
+
+/***********************************************************
+ *  UploadLevel()
+ *
+ *  Upload one level of a texture from its copy in memory.
+ ***********************************************************/
+void TextureResidency::UploadLevel(RESIDENT_TEXTURE& texture, int levelIndex)
+{
+	const MipGenerator::MIP_LEVEL& level = texture.levels[levelIndex];
+
+	GLint previousTexture = 0;
+	GLint previousUnpackAlignment = 4;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousUnpackAlignment);
+	glBindTexture(GL_TEXTURE_2D, texture.ID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	glTexImage2D(GL_TEXTURE_2D, levelIndex, texture.internalFormat, level.width, level.height, 0, texture.format, GL_UNSIGNED_BYTE, level.pixels.data());
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, previousUnpackAlignment);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  Forget all registered textures and their mip copies.
+ ***********************************************************/
+void TextureResidency::Clear()
+{
+	m_textures.clear();
+	m_residentBytes = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  Start a new frame.  Textures that get no request during
+ *  the frame are candidates for eviction in Update().
+ ***********************************************************/
+void TextureResidency::BeginFrame()
+{
+	m_frame++;
+}
+
+/***********************************************************
+ *  RequestLevel()
+ *
+ *  Ask for a mip level of a texture to be resident.  Several
+ *  requests in the same frame keep the finest level.
+ ***********************************************************/
+void TextureResidency::RequestLevel(int texture, int level)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()))
+	{
+		return;
+	}
+
+	RESIDENT_TEXTURE& resident = m_textures[texture];
+	level = std::max(0, std::min(level, (int)resident.levels.size() - 1));
+	if ((resident.lastUsedFrame != m_frame) || (level < resident.requestedLevel))
+	{
+		resident.requestedLevel = level;
+	}
+	resident.lastUsedFrame = m_frame;
+}
+
+/***********************************************************
+ *  LevelForScreenSize()
+ *
+ *  Get the finest mip level needed when the texture, repeated
+ *  uvRepeat times, covers screenPixels across on the screen.
+ *  That is the level where one texel maps to a pixel or more.
+ ***********************************************************/
+int TextureResidency::LevelForScreenSize(int texture, float screenPixels, float uvRepeat) const
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()) || (screenPixels <= 0.0f))
+	{
+		return(0);
+	}
+
+	const MipGenerator::MIP_LEVEL& top = m_textures[texture].levels[0];
+	float texels = (float)std::max(top.width, top.height) * uvRepeat;
+	int level = (int)std::floor(std::log2(std::max(texels / screenPixels, 1.0f)));
+
+	return(std::min(level, (int)m_textures[texture].levels.size() - 1));
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  Stream levels after all requests of the frame are known.
+ *  Textures drawn this frame get one finer level at a time
+ *  until they reach their requested level, limited by the
+ *  per frame upload size.  When a level does not fit in the
+ *  budget, the finest levels of the least recently used
+ *  textures are evicted first.  A texture whose level cannot
+ *  be made to fit keeps drawing from its coarser levels.
+ ***********************************************************/
+void TextureResidency::Update()
+{
+	// a lowered budget is enforced right away
+	if (m_residentBytes > m_budgetBytes)
+	{
+		MakeRoom(0);
+	}
+
+	size_t uploadedBytes = 0;
+	bool bProgress = true;
+	while (bProgress == true)
+	{
+		bProgress = false;
+		for (int i = 0; i < (int)m_textures.size(); i++)
+		{
+			RESIDENT_TEXTURE& texture = m_textures[i];
+			if ((texture.lastUsedFrame != m_frame) ||
+				(texture.residentLevel <= texture.requestedLevel))
+			{
+				continue;
+			}
+
+			size_t bytes = LevelBytes(texture.levels[texture.residentLevel - 1]);
+			// a level larger than the per frame limit is still
+			// streamed in once it is the only upload of the frame
+			if ((uploadedBytes > 0) && (uploadedBytes + bytes > m_maxUploadBytesPerFrame))
+			{
+				return;
+			}
+			if (MakeRoom(bytes) == false)
+			{
+				continue;
+			}
+
+			StreamIn(texture);
+			uploadedBytes += bytes;
+			bProgress = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  MakeRoom()
+ *
+ *  Evict levels until the given number of bytes fits within
+ *  the budget.  Textures not drawn this frame lose levels
+ *  first, least recently used first, then textures drawn
+ *  this frame lose levels finer than they requested.  The
+ *  mip tail is never evicted.  Returns false if the bytes
+ *  still do not fit.
+ ***********************************************************/
+bool TextureResidency::MakeRoom(size_t bytes)
+{
+	if (m_residentBytes + bytes <= m_budgetBytes)
+	{
+		return(true);
+	}
+
+	std::vector<int> order;
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+		return(m_textures[a].lastUsedFrame < m_textures[b].lastUsedFrame);
+	});
+
+	for (int i = 0; i < (int)order.size(); i++)
+	{
+		RESIDENT_TEXTURE& texture = m_textures[order[i]];
+		// textures drawn this frame only give up unneeded levels
+		int keepLevel = texture.tailLevel;
+		if (texture.lastUsedFrame == m_frame)
+		{
+			keepLevel = std::min(texture.requestedLevel, texture.tailLevel);
+		}
+
+		while ((texture.residentLevel < keepLevel) &&
+			(m_residentBytes + bytes > m_budgetBytes))
+		{
+			Evict(texture);
+		}
+
+		if (m_residentBytes + bytes <= m_budgetBytes)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  StreamIn()
+ *
+ *  Upload the next finer level of a texture and make it the
+ *  level the texture is drawn from.
+ ***********************************************************/
+void TextureResidency::StreamIn(RESIDENT_TEXTURE& texture)
+{
+	int levelIndex = texture.residentLevel - 1;
+	UploadLevel(texture, levelIndex);
+
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D, texture.ID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levelIndex);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	texture.residentLevel = levelIndex;
+	m_residentBytes += LevelBytes(texture.levels[levelIndex]);
+}
+
+/***********************************************************
+ *  Evict()
+ *
+ *  Free the finest resident level of a texture, which then
+ *  draws from the next coarser level.
+ ***********************************************************/
+void TextureResidency::Evict(RESIDENT_TEXTURE& texture)
+{
+	int levelIndex = texture.residentLevel;
+
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D, texture.ID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levelIndex + 1);
+	glTexImage2D(GL_TEXTURE_2D, levelIndex, texture.internalFormat, 0, 0, 0, texture.format, GL_UNSIGNED_BYTE, NULL);
+
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	texture.residentLevel = levelIndex + 1;
+	m_residentBytes -= LevelBytes(texture.levels[levelIndex]);
+}
+
+/***********************************************************
+ *  PrintStats()
+ *
+ *  Write the resident memory and the resident and requested
+ *  level of every texture.
+ ***********************************************************/
+void TextureResidency::PrintStats(std::ostream& out) const
+{
+	out << "Texture residency: " << (m_residentBytes / 1024) << " KB of " << (m_budgetBytes / 1024) << " KB budget" << std::endl;
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		const RESIDENT_TEXTURE& texture = m_textures[i];
+		const MipGenerator::MIP_LEVEL& level = texture.levels[texture.residentLevel];
+		out << "  texture:" << texture.ID
+			<< ", resident level:" << texture.residentLevel << " (" << level.width << "x" << level.height << ")"
+			<< ", requested level:" << texture.requestedLevel
+			<< ", last used frame:" << texture.lastUsedFrame << std::endl;
+	}
+}
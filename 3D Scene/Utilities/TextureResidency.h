@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.h
+// ============
+// keep texture mip levels resident on the GPU only while the current view
+// needs them, within a fixed video memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "MipGenerator.h"
+
+#include <iostream>
+#include <vector>
+
+/***********************************************************
+ *  TextureResidency
+ *
+ *  This class keeps the CPU mip chain of every registered
+ *  texture, while the GPU only holds the
+ *  levels from the texture's base level down to the
+ *  coarsest one.  Each frame the renderer requests the finest
+ *  level a texture needs for its on-screen size; Update()
+ *  then streams finer levels in and evicts the finest levels
+ *  of the least recently used textures to stay within the
+ *  budget.  A texture always renders from the finest level
+ *  that is already resident, so a frame never waits on a
+ *  level that has not been streamed in yet.
+ ***********************************************************/
+class TextureResidency
+{
+public:
+	// constructor
+	TextureResidency(
+		size_t budgetBytes = 256 * 1024 * 1024,
+		size_t maxUploadBytesPerFrame = 4 * 1024 * 1024,
+		int tailSize = 64);
+	// destructor
+	~TextureResidency();
+
+	// take over the mip streaming of a texture - the mip chain
+	// is moved in, and only the mip tail is uploaded until finer
+	// levels are requested
+	int RegisterTexture(
+		GLuint textureID,
+		int colorChannels,
+		std::vector<MipGenerator::MIP_LEVEL>& levels);
+	// forget all registered textures
+	void Clear();
+
+	// start counting the requests of a new frame
+	void BeginFrame();
+	// ask for the given mip level of a texture to be resident
+	void RequestLevel(int texture, int level);
+	// finest level needed to draw a texture across the given number
+	// of screen pixels, repeated uvRepeat times
+	int LevelForScreenSize(int texture, float screenPixels, float uvRepeat) const;
+	// stream levels in or out after the frame's requests are known
+	void Update();
+
+	// set the largest amount of texture memory to keep resident
+	void SetBudget(size_t budgetBytes) { m_budgetBytes = budgetBytes; }
+	size_t GetBudget() const { return m_budgetBytes; }
+	size_t GetResidentBytes() const { return m_residentBytes; }
+
+	// write the resident and requested levels of all textures
+	void PrintStats(std::ostream& out) const;
+
+private:
+	// a texture whose levels are streamed
+	struct RESIDENT_TEXTURE
+	{
+		GLuint ID;
+		GLenum internalFormat;
+		GLenum format;
+		int colorChannels;
+		std::vector<MipGenerator::MIP_LEVEL> levels;
+		int residentLevel;		// finest level currently on the GPU
+		int tailLevel;			// finest level of the mip tail that is never freed
+		int requestedLevel;		// finest level requested in the latest frame using it
+		unsigned int lastUsedFrame;
+	};
+
+	// largest amount of texture memory to keep resident
+	size_t m_budgetBytes;
+	// most data to upload in one frame, so streaming never stalls a frame
+	size_t m_maxUploadBytesPerFrame;
+	// levels this size or smaller always stay resident
+	int m_tailSize;
+
+	std::vector<RESIDENT_TEXTURE> m_textures;
+	size_t m_residentBytes;
+	unsigned int m_frame;
+
+	// estimated GPU memory of a level
+	static size_t LevelBytes(const MipGenerator::MIP_LEVEL& level);
+	// upload a level of a texture from its copy
+	void UploadLevel(RESIDENT_TEXTURE& texture, int levelIndex);
+	// upload the next finer level of a texture
+	void StreamIn(RESIDENT_TEXTURE& texture);
+	// free the finest resident level of a texture
+	void Evict(RESIDENT_TEXTURE& texture);
+	// free levels of textures not used this frame to make room
+	bool MakeRoom(size_t bytes);
+};
@@ -0,0 +1,264 @@
+///////////////////////////////////////////////////////////////////////////////
+// tiledimagefile.cpp
+// ============
+// store the mip chain of a texture as fixed size pages that can be read
+// one at a time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TiledImageFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	const char g_TiledMagic[4] = { 'V', 'T', 'E', 'X' };
+	// bumped whenever the layout changes, so old files are rebuilt
+	const uint32_t g_TiledVersion = 1;
+}
+
+/***********************************************************
+ *  TiledImageFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TiledImageFile::TiledImageFile()
+{
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+/***********************************************************
+ *  ~TiledImageFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TiledImageFile::~TiledImageFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  ComputeLevels()
+ *
+ *  Lay out the paged mip levels of an image.  The levels
+ *  halve like the mip generator's, and stop at the first one
+ *  that fits in a single page - coarser levels are sampled
+ *  from that page.
+ ***********************************************************/
+void TiledImageFile::ComputeLevels(int width, int height, int pageSize, std::vector<TILED_LEVEL>& levels)
+{
+	levels.clear();
+	int firstPage = 0;
+	while (true)
+	{
+		TILED_LEVEL level;
+		level.width = width;
+		level.height = height;
+		level.pagesX = (width + pageSize - 1) / pageSize;
+		level.pagesY = (height + pageSize - 1) / pageSize;
+		level.firstPage = firstPage;
+		levels.push_back(level);
+		firstPage += level.pagesX * level.pagesY;
+
+		if ((level.pagesX == 1) && (level.pagesY == 1))
+		{
+			break;
+		}
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  Cut the levels of a mip chain into pages and write them
+ *  after the header and page table.  The borders wrap around
+ *  the level, like the repeating textures they are sampled
+ *  as, and the pages past the right and top edges are filled
+ *  the same way.  Returns false if the chain is too short or
+ *  the file could not be written.
+ ***********************************************************/
+bool TiledImageFile::Write(
+	const char* filename,
+	const std::vector<MipGenerator::MIP_LEVEL>& mipLevels,
+	int colorChannels,
+	int pageSize,
+	int pageBorder,
+	uint64_t sourceBytes)
+{
+	if ((mipLevels.size() == 0) || ((colorChannels != 3) && (colorChannels != 4)))
+	{
+		return(false);
+	}
+
+	std::vector<TILED_LEVEL> levels;
+	ComputeLevels(mipLevels[0].width, mipLevels[0].height, pageSize, levels);
+	if (levels.size() > mipLevels.size())
+	{
+		return(false);
+	}
+
+	TILED_HEADER header;
+	memcpy(header.magic, g_TiledMagic, sizeof(header.magic));
+	header.version = g_TiledVersion;
+	header.width = mipLevels[0].width;
+	header.height = mipLevels[0].height;
+	header.pageSize = pageSize;
+	header.pageBorder = pageBorder;
+	header.levelCount = (uint32_t)levels.size();
+	header.pageCount = levels.back().firstPage + 1;
+	header.sourceBytes = sourceBytes;
+
+	int paddedSize = PaddedPageSize(pageSize, pageBorder);
+	size_t pageBytes = (size_t)paddedSize * paddedSize * 4;
+	std::vector<uint64_t> offsets(header.pageCount);
+	uint64_t offset = sizeof(header) + (offsets.size() * sizeof(uint64_t));
+	for (size_t i = 0; i < offsets.size(); i++)
+	{
+		offsets[i] = offset;
+		offset += pageBytes;
+	}
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		return(false);
+	}
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)offsets.data(), offsets.size() * sizeof(uint64_t));
+
+	std::vector<unsigned char> page(pageBytes);
+	for (size_t l = 0; l < levels.size(); l++)
+	{
+		const TILED_LEVEL& level = levels[l];
+		const unsigned char* pixels = mipLevels[l].pixels.data();
+		for (int pageY = 0; pageY < level.pagesY; pageY++)
+		{
+			for (int pageX = 0; pageX < level.pagesX; pageX++)
+			{
+				unsigned char* texel = page.data();
+				for (int y = 0; y < paddedSize; y++)
+				{
+					int sourceY = (pageY * pageSize) - pageBorder + y;
+					sourceY = ((sourceY % level.height) + level.height) % level.height;
+					const unsigned char* row = pixels + ((size_t)sourceY * level.width * colorChannels);
+					for (int x = 0; x < paddedSize; x++)
+					{
+						int sourceX = (pageX * pageSize) - pageBorder + x;
+						sourceX = ((sourceX % level.width) + level.width) % level.width;
+						const unsigned char* source = row + ((size_t)sourceX * colorChannels);
+						texel[0] = source[0];
+						texel[1] = source[1];
+						texel[2] = source[2];
+						texel[3] = (colorChannels == 4) ? source[3] : 255;
+						texel += 4;
+					}
+				}
+				file.write((const char*)page.data(), page.size());
+			}
+		}
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  Open a tiled file and read its header and page table.
+ *  Returns false if the file is missing, was written by
+ *  another version, or is cut short.
+ ***********************************************************/
+bool TiledImageFile::Open(const char* filename)
+{
+	Close();
+
+	m_file.open(filename, std::ios::binary);
+	if (m_file.is_open() == false)
+	{
+		return(false);
+	}
+
+	m_file.read((char*)&m_header, sizeof(m_header));
+	if ((m_file.good() == false) ||
+		(memcmp(m_header.magic, g_TiledMagic, sizeof(g_TiledMagic)) != 0) ||
+		(m_header.version != g_TiledVersion) ||
+		(m_header.pageSize == 0))
+	{
+		Close();
+		return(false);
+	}
+
+	ComputeLevels(m_header.width, m_header.height, m_header.pageSize, m_levels);
+	if ((m_levels.size() != m_header.levelCount) ||
+		((uint32_t)m_levels.back().firstPage + 1 != m_header.pageCount))
+	{
+		Close();
+		return(false);
+	}
+
+	m_pageOffsets.resize(m_header.pageCount);
+	m_file.read((char*)m_pageOffsets.data(), m_pageOffsets.size() * sizeof(uint64_t));
+	if (m_file.good() == false)
+	{
+		Close();
+		return(false);
+	}
+
+	// the last page must be complete
+	int paddedSize = PaddedPageSize(m_header.pageSize, m_header.pageBorder);
+	m_file.seekg(0, std::ios::end);
+	uint64_t fileBytes = (uint64_t)m_file.tellg();
+	if (m_pageOffsets.back() + ((uint64_t)paddedSize * paddedSize * 4) > fileBytes)
+	{
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  Close the file and forget its layout.
+ ***********************************************************/
+void TiledImageFile::Close()
+{
+	if (m_file.is_open() == true)
+	{
+		m_file.close();
+	}
+	m_file.clear();
+	memset(&m_header, 0, sizeof(m_header));
+	m_levels.clear();
+	m_pageOffsets.clear();
+}
+
+/***********************************************************
+ *  ReadPage()
+ *
+ *  Read the RGBA texels of one page, borders included, into
+ *  the passed in buffer.  Rows go from the bottom of the
+ *  page up, like the mip levels they were cut from.
+ ***********************************************************/
+bool TiledImageFile::ReadPage(int level, int pageX, int pageY, unsigned char* texels)
+{
+	if ((IsOpen() == false) || (level < 0) || (level >= (int)m_levels.size()))
+	{
+		return(false);
+	}
+	const TILED_LEVEL& tiledLevel = m_levels[level];
+	if ((pageX < 0) || (pageX >= tiledLevel.pagesX) || (pageY < 0) || (pageY >= tiledLevel.pagesY))
+	{
+		return(false);
+	}
+
+	int paddedSize = PaddedPageSize(m_header.pageSize, m_header.pageBorder);
+	int page = tiledLevel.firstPage + (pageY * tiledLevel.pagesX) + pageX;
+	m_file.clear();
+	m_file.seekg((std::streamoff)m_pageOffsets[page]);
+	m_file.read((char*)texels, (std::streamsize)paddedSize * paddedSize * 4);
+	return(m_file.good());
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// tiledimagefile.h
+// ============
+// store the mip chain of a texture as fixed size pages that can be read
+// one at a time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MipGenerator.h"
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+/***********************************************************
+ *  TiledImageFile
+ *
+ *  This class writes and reads the on-disk format of the
+ *  virtual textures.  Every mip level down to the first one
+ *  that fits in a single page is cut into square pages of
+ *  RGBA texels, each with a border of its wrapped neighbors
+ *  so a page can be filtered on its own.  A table of page
+ *  offsets follows the header, so any page is one seek and
+ *  one read away.
+ ***********************************************************/
+class TiledImageFile
+{
+public:
+	// one paged mip level
+	struct TILED_LEVEL
+	{
+		int width;
+		int height;
+		int pagesX;
+		int pagesY;
+		int firstPage;			// index of the level's first page in the file
+	};
+
+	// constructor
+	TiledImageFile();
+	// destructor
+	~TiledImageFile();
+
+	// lay out the paged mip levels of an image, which follow the
+	// mip generator's level sizes
+	static void ComputeLevels(int width, int height, int pageSize, std::vector<TILED_LEVEL>& levels);
+	// texels across a page including its borders
+	static int PaddedPageSize(int pageSize, int pageBorder) { return pageSize + (2 * pageBorder); }
+	// cut a mip chain into pages and write them, sourceBytes is the size
+	// of the image file the chain was decoded from
+	static bool Write(
+		const char* filename,
+		const std::vector<MipGenerator::MIP_LEVEL>& mipLevels,
+		int colorChannels,
+		int pageSize,
+		int pageBorder,
+		uint64_t sourceBytes);
+
+	// open a tiled file for reading its pages
+	bool Open(const char* filename);
+	void Close();
+	bool IsOpen() const { return m_file.is_open(); }
+	// read the RGBA texels of one page, borders included
+	bool ReadPage(int level, int pageX, int pageY, unsigned char* texels);
+
+	int GetWidth() const { return m_header.width; }
+	int GetHeight() const { return m_header.height; }
+	int GetPageSize() const { return m_header.pageSize; }
+	int GetPageBorder() const { return m_header.pageBorder; }
+	uint64_t GetSourceBytes() const { return m_header.sourceBytes; }
+	const std::vector<TILED_LEVEL>& GetLevels() const { return m_levels; }
+
+private:
+	// start of every tiled file
+	struct TILED_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t pageSize;
+		uint32_t pageBorder;
+		uint32_t levelCount;
+		uint32_t pageCount;
+		uint64_t sourceBytes;
+	};
+
+	std::ifstream m_file;
+	TILED_HEADER m_header;
+	std::vector<TILED_LEVEL> m_levels;
+	// file offset of every page
+	std::vector<uint64_t> m_pageOffsets;
+};
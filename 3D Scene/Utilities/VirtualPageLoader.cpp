@@ -0,0 +1,287 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualpageloader.cpp
+// ============
+// read the pages of virtual textures from their tiled files on a
+// background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VirtualPageLoader.h"
+
+#include "stb_image.h"
+
+/***********************************************************
+ *  VirtualPageLoader()
+ *
+ *  The constructor for the class.  Images are flipped
+ *  vertically while decoding, like every texture loaded for
+ *  the scene, so the JPEG decoder should flip them too.
+ ***********************************************************/
+VirtualPageLoader::VirtualPageLoader(
+	const MipGenerator* pMipGenerator,
+	const JpegDecoder* pJpegDecoder,
+	int pageSize,
+	int pageBorder)
+{
+	m_pMipGenerator = pMipGenerator;
+	m_pJpegDecoder = pJpegDecoder;
+	m_pageSize = pageSize;
+	m_pageBorder = pageBorder;
+	m_inProgress = 0;
+	m_generation = 0;
+	m_bStopping = false;
+
+	stbi_set_flip_vertically_on_load(true);
+	m_worker = std::thread(&VirtualPageLoader::WorkerLoop, this);
+}
+
+/***********************************************************
+ *  ~VirtualPageLoader()
+ *
+ *  The destructor for the class.  Queued pages are dropped
+ *  and the worker finishes the page it is reading.
+ ***********************************************************/
+VirtualPageLoader::~VirtualPageLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+		m_requests.clear();
+	}
+	m_wakeWorker.notify_all();
+	m_worker.join();
+
+	for (size_t i = 0; i < m_sources.size(); i++)
+	{
+		delete m_sources[i];
+	}
+	m_sources.clear();
+}
+
+/***********************************************************
+ *  TiledFilename()
+ *
+ *  Get the name of the tiled file kept next to an image.
+ ***********************************************************/
+std::string VirtualPageLoader::TiledFilename(const std::string& filename)
+{
+	return(filename + ".vtex");
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  Add the image file of a virtual texture.  Nothing is read
+ *  until the first page of the texture is requested.
+ ***********************************************************/
+int VirtualPageLoader::AddTexture(const std::string& filename)
+{
+	PAGE_SOURCE* source = new PAGE_SOURCE();
+	source->filename = filename;
+	source->bFailed = false;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_sources.push_back(source);
+	return((int)m_sources.size() - 1);
+}
+
+/***********************************************************
+ *  Request()
+ *
+ *  Queue a page to be read.  The result can be taken with
+ *  PollLoaded() once it is ready.
+ ***********************************************************/
+void VirtualPageLoader::Request(const PAGE_REQUEST& page)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_requests.push_back(page);
+	}
+	m_wakeWorker.notify_one();
+}
+
+/***********************************************************
+ *  PollLoaded()
+ *
+ *  Take the oldest finished page without waiting.  Returns
+ *  false if no page is finished.
+ ***********************************************************/
+bool VirtualPageLoader::PollLoaded(LOADED_PAGE& page)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_loaded.size() == 0)
+	{
+		return(false);
+	}
+
+	page = std::move(m_loaded.front());
+	m_loaded.pop_front();
+	return(true);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  Drop all textures and their queued and finished pages.
+ *  Waits for the page being read, which may be building a
+ *  tiled file, since its source is deleted.
+ ***********************************************************/
+void VirtualPageLoader::Clear()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_requests.clear();
+	m_loaded.clear();
+	m_generation++;
+	m_pageDone.wait(lock, [this]() { return(m_inProgress == 0); });
+
+	for (size_t i = 0; i < m_sources.size(); i++)
+	{
+		delete m_sources[i];
+	}
+	m_sources.clear();
+}
+
+/***********************************************************
+ *  IsBusy()
+ *
+ *  Check whether any requested page is still queued, being
+ *  read, or waiting to be polled.
+ ***********************************************************/
+bool VirtualPageLoader::IsBusy()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return((m_requests.size() > 0) || (m_inProgress > 0) || (m_loaded.size() > 0));
+}
+
+/***********************************************************
+ *  OpenSource()
+ *
+ *  Open the tiled file of a virtual texture.  A file that is
+ *  missing, was written for another page layout, or does not
+ *  match the size of the image file is built again from the
+ *  image, decoded with the SIMD JPEG decoder or stb_image.
+ ***********************************************************/
+bool VirtualPageLoader::OpenSource(PAGE_SOURCE& source)
+{
+	uint64_t sourceBytes = 0;
+	{
+		std::ifstream image(source.filename, std::ios::binary | std::ios::ate);
+		if (image.is_open() == false)
+		{
+			return(false);
+		}
+		sourceBytes = (uint64_t)image.tellg();
+	}
+
+	std::string tiledFilename = TiledFilename(source.filename);
+	if ((source.tiledFile.Open(tiledFilename.c_str()) == true) &&
+		(source.tiledFile.GetSourceBytes() == sourceBytes) &&
+		(source.tiledFile.GetPageSize() == m_pageSize) &&
+		(source.tiledFile.GetPageBorder() == m_pageBorder))
+	{
+		return(true);
+	}
+	source.tiledFile.Close();
+
+	MipGenerator::MIP_IMAGE mipImage;
+	JpegDecoder::JPEG_IMAGE jpegImage;
+	unsigned char* stbImage = NULL;
+	if (m_pJpegDecoder->DecodeFile(source.filename.c_str(), jpegImage) == true)
+	{
+		mipImage.pixels = jpegImage.pixels.data();
+		mipImage.width = jpegImage.width;
+		mipImage.height = jpegImage.height;
+		mipImage.colorChannels = jpegImage.colorChannels;
+	}
+	else
+	{
+		stbImage = stbi_load(
+			source.filename.c_str(),
+			&mipImage.width,
+			&mipImage.height,
+			&mipImage.colorChannels,
+			0);
+		mipImage.pixels = stbImage;
+	}
+
+	bool bWritten = false;
+	if ((mipImage.pixels != NULL) &&
+		((mipImage.colorChannels == 3) || (mipImage.colorChannels == 4)) &&
+		(m_pMipGenerator->GenerateMipChain(mipImage) == true))
+	{
+		bWritten = TiledImageFile::Write(
+			tiledFilename.c_str(),
+			mipImage.levels,
+			mipImage.colorChannels,
+			m_pageSize,
+			m_pageBorder,
+			sourceBytes);
+	}
+	if (stbImage != NULL)
+	{
+		stbi_image_free(stbImage);
+	}
+
+	return((bWritten == true) && (source.tiledFile.Open(tiledFilename.c_str()) == true));
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  Read queued pages one at a time until the loader is
+ *  destroyed.  The first page of a texture opens its tiled
+ *  file, and a texture whose file cannot be opened or built
+ *  fails every page.
+ ***********************************************************/
+void VirtualPageLoader::WorkerLoop()
+{
+	int paddedSize = TiledImageFile::PaddedPageSize(m_pageSize, m_pageBorder);
+
+	while (true)
+	{
+		PAGE_REQUEST request;
+		PAGE_SOURCE* source = NULL;
+		unsigned int generation = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeWorker.wait(lock, [this]() { return((m_bStopping == true) || (m_requests.size() > 0)); });
+			if (m_bStopping == true)
+			{
+				return;
+			}
+			request = m_requests.front();
+			m_requests.pop_front();
+			generation = m_generation;
+			if ((request.texture >= 0) && (request.texture < (int)m_sources.size()))
+			{
+				source = m_sources[request.texture];
+			}
+			m_inProgress++;
+		}
+
+		LOADED_PAGE page;
+		page.page = request;
+		page.bLoaded = false;
+		if ((source != NULL) && (source->bFailed == false))
+		{
+			if ((source->tiledFile.IsOpen() == false) && (OpenSource(*source) == false))
+			{
+				source->bFailed = true;
+			}
+			else
+			{
+				page.texels.resize((size_t)paddedSize * paddedSize * 4);
+				page.bLoaded = source->tiledFile.ReadPage(request.level, request.pageX, request.pageY, page.texels.data());
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_inProgress--;
+			if (generation == m_generation)
+			{
+				m_loaded.push_back(std::move(page));
+			}
+		}
+		m_pageDone.notify_all();
+	}
+}
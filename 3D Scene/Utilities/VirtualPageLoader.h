@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualpageloader.h
+// ============
+// read the pages of virtual textures from their tiled files on a
+// background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MipGenerator.h"
+#include "JpegDecoder.h"
+#include "TiledImageFile.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  VirtualPageLoader
+ *
+ *  This class owns a worker thread that reads requested
+ *  pages of virtual textures.  Each texture's pages live in
+ *  a tiled file next to its image, which the worker builds
+ *  the first time a page is needed if the file is missing
+ *  or was made from a different image.  It never calls
+ *  OpenGL - the render thread polls the finished pages and
+ *  copies them into its page cache.
+ ***********************************************************/
+class VirtualPageLoader
+{
+public:
+	// a page of a virtual texture
+	struct PAGE_REQUEST
+	{
+		int texture;
+		int level;
+		int pageX;
+		int pageY;
+	};
+
+	// a finished read, successful or not
+	struct LOADED_PAGE
+	{
+		PAGE_REQUEST page;
+		bool bLoaded;
+		std::vector<unsigned char> texels;	// RGBA, borders included
+	};
+
+	// constructor - the mip generator and JPEG decoder must outlive the loader
+	VirtualPageLoader(
+		const MipGenerator* pMipGenerator,
+		const JpegDecoder* pJpegDecoder,
+		int pageSize,
+		int pageBorder);
+	// destructor - waits for the page being read
+	~VirtualPageLoader();
+
+	// add the image file of a virtual texture, returns its index
+	int AddTexture(const std::string& filename);
+	// queue a page to be read
+	void Request(const PAGE_REQUEST& page);
+	// take one finished page, returns false if none is ready
+	bool PollLoaded(LOADED_PAGE& page);
+	// drop every texture and queued or finished page
+	void Clear();
+	// check whether any requested page is not polled yet
+	bool IsBusy();
+
+	// name of the tiled file kept for an image file
+	static std::string TiledFilename(const std::string& filename);
+
+private:
+	// the image file of a virtual texture and its open tiled file
+	struct PAGE_SOURCE
+	{
+		std::string filename;
+		TiledImageFile tiledFile;
+		bool bFailed;
+	};
+
+	const MipGenerator* m_pMipGenerator;
+	const JpegDecoder* m_pJpegDecoder;
+	int m_pageSize;
+	int m_pageBorder;
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeWorker;
+	// signalled when the worker finishes a page
+	std::condition_variable m_pageDone;
+	// only the worker touches a source's file once it is added
+	std::vector<PAGE_SOURCE*> m_sources;
+	std::deque<PAGE_REQUEST> m_requests;
+	std::deque<LOADED_PAGE> m_loaded;
+	// pages the worker is reading right now
+	int m_inProgress;
+	// bumped by Clear() so in flight results are dropped
+	unsigned int m_generation;
+	bool m_bStopping;
+
+	// worker thread loop
+	void WorkerLoop();
+	// open the tiled file of a source, building it first if needed
+	bool OpenSource(PAGE_SOURCE& source);
+};
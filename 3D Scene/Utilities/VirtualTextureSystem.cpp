@@ -0,0 +1,767 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexturesystem.cpp
+// ============
+// sample very large textures through a page table and a fixed size cache
+// of the pages the current view needs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VirtualTextureSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	// matches MAX_VIRTUAL_LEVELS in the fragment shader
+	const int MAX_VIRTUAL_LEVELS = 16;
+	// pages queued with the loader at once, so requests stay fresh
+	const int MAX_PENDING_PAGES = 32;
+	// pages copied into the cache per frame
+	const int MAX_UPLOADS_PER_FRAME = 16;
+}
+
+/***********************************************************
+ *  VirtualTextureSystem()
+ *
+ *  The constructor for the class.  Nothing is created until
+ *  Initialize() is called.
+ ***********************************************************/
+VirtualTextureSystem::VirtualTextureSystem(
+	const MipGenerator* pMipGenerator,
+	const JpegDecoder* pJpegDecoder,
+	int cachePagesAcross,
+	int pageSize,
+	int pageBorder,
+	int feedbackScale)
+{
+	m_pMipGenerator = pMipGenerator;
+	m_pJpegDecoder = pJpegDecoder;
+	m_pageLoader = NULL;
+	m_cachePagesAcross = std::max(1, cachePagesAcross);
+	m_pageSize = std::max(1, pageSize);
+	m_pageBorder = std::max(1, pageBorder);
+	m_feedbackScale = std::max(1, feedbackScale);
+	m_pageTableUnit = 0;
+	m_pageCacheUnit = 0;
+	m_pageCache = 0;
+	m_feedbackFramebuffer = 0;
+	m_feedbackColor = 0;
+	m_feedbackDepth = 0;
+	m_feedbackWidth = 0;
+	m_feedbackHeight = 0;
+	m_previousFramebuffer = 0;
+	m_previousReadFramebuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_previousViewport[i] = 0;
+		m_previousClearColor[i] = 0.0f;
+	}
+	m_bPreviousBlend = GL_FALSE;
+	m_frame = 0;
+	m_stats = VIRTUAL_TEXTURE_STATS();
+}
+
+/***********************************************************
+ *  ~VirtualTextureSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VirtualTextureSystem::~VirtualTextureSystem()
+{
+	Clear();
+	Destroy();
+	delete m_pageLoader;
+	m_pageLoader = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Create the physical page cache and the feedback render
+ *  target, and start the page loader.  The page tables and
+ *  the cache are bound on the given texture units whenever a
+ *  virtual texture is drawn.
+ ***********************************************************/
+bool VirtualTextureSystem::Initialize(int pageTableUnit, int pageCacheUnit)
+{
+	Clear();
+	Destroy();
+
+	m_pageTableUnit = pageTableUnit;
+	m_pageCacheUnit = pageCacheUnit;
+	if (m_pageLoader == NULL)
+	{
+		m_pageLoader = new VirtualPageLoader(m_pMipGenerator, m_pJpegDecoder, m_pageSize, m_pageBorder);
+	}
+
+	int cacheSize = m_cachePagesAcross * TiledImageFile::PaddedPageSize(m_pageSize, m_pageBorder);
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGenTextures(1, &m_pageCache);
+	glBindTexture(GL_TEXTURE_2D, m_pageCache);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheSize, cacheSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	// the page borders cover the bilinear footprint, so the cache
+	// needs no mip levels of its own
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	if (glGetError() != GL_NO_ERROR)
+	{
+		std::cout << "Could not create the virtual texture page cache" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	glGenFramebuffers(1, &m_feedbackFramebuffer);
+	glGenTextures(1, &m_feedbackColor);
+	glGenRenderbuffers(1, &m_feedbackDepth);
+
+	CACHE_SLOT freeSlot;
+	freeSlot.texture = -1;
+	freeSlot.page = -1;
+	freeSlot.bPinned = false;
+	freeSlot.lastUsedFrame = 0;
+	m_slots.assign(m_cachePagesAcross * m_cachePagesAcross, freeSlot);
+
+	m_stats.cachePages = (int)m_slots.size();
+	m_stats.cacheBytes = (size_t)cacheSize * cacheSize * 4;
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  Release the cache and the feedback render target.
+ ***********************************************************/
+void VirtualTextureSystem::Destroy()
+{
+	if (m_pageCache != 0)
+	{
+		glDeleteTextures(1, &m_pageCache);
+		m_pageCache = 0;
+	}
+	if (m_feedbackFramebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_feedbackFramebuffer);
+		m_feedbackFramebuffer = 0;
+	}
+	if (m_feedbackColor != 0)
+	{
+		glDeleteTextures(1, &m_feedbackColor);
+		m_feedbackColor = 0;
+	}
+	if (m_feedbackDepth != 0)
+	{
+		glDeleteRenderbuffers(1, &m_feedbackDepth);
+		m_feedbackDepth = 0;
+	}
+	m_feedbackWidth = 0;
+	m_feedbackHeight = 0;
+	m_slots.clear();
+	m_stats.cachePages = 0;
+	m_stats.cacheBytes = 0;
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  Add an image file as a virtual texture of the passed in
+ *  size.  Its page table starts out empty, and the coarsest
+ *  page is requested right away.  Returns the index to bind
+ *  the texture with, or -1 if the system is not initialized
+ *  or the image has more levels than the shader handles.
+ ***********************************************************/
+int VirtualTextureSystem::AddTexture(const std::string& filename, int width, int height)
+{
+	if ((IsInitialized() == false) || (width <= 0) || (height <= 0) || (m_textures.size() >= 255))
+	{
+		return(-1);
+	}
+
+	VIRTUAL_TEXTURE texture;
+	TiledImageFile::ComputeLevels(width, height, m_pageSize, texture.levels);
+	if ((int)texture.levels.size() > MAX_VIRTUAL_LEVELS)
+	{
+		return(-1);
+	}
+
+	texture.tableWidth = 0;
+	for (size_t i = 0; i < texture.levels.size(); i++)
+	{
+		texture.tableOffsets.push_back(texture.tableWidth);
+		texture.tableWidth += texture.levels[i].pagesX;
+	}
+	texture.tableHeight = texture.levels[0].pagesY;
+	texture.tableEntries.assign((size_t)texture.tableWidth * texture.tableHeight * 4, 0);
+	texture.bTableDirty = false;
+	int pageCount = texture.levels.back().firstPage + 1;
+	texture.pageStates.assign(pageCount, PAGE_ABSENT);
+	texture.pageSlots.assign(pageCount, -1);
+	texture.bFailed = false;
+
+	// integer entries are read with texelFetch and need nearest
+	// filtering to be complete
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGenTextures(1, &texture.pageTable);
+	glBindTexture(GL_TEXTURE_2D, texture.pageTable);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8UI, texture.tableWidth, texture.tableHeight, 0,
+		GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, texture.tableEntries.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	int index = m_pageLoader->AddTexture(filename);
+	m_textures.push_back(texture);
+
+	// the coarsest page is the fallback for every other page
+	VirtualPageLoader::PAGE_REQUEST request;
+	request.texture = index;
+	request.level = (int)texture.levels.size() - 1;
+	request.pageX = 0;
+	request.pageY = 0;
+	m_textures[index].pageStates[pageCount - 1] = PAGE_PENDING;
+	m_pageLoader->Request(request);
+
+	int paddedSize = TiledImageFile::PaddedPageSize(m_pageSize, m_pageBorder);
+	m_stats.textures++;
+	m_stats.pendingPages++;
+	m_stats.virtualBytes += (size_t)pageCount * paddedSize * paddedSize * 4;
+	return(index);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  Drop every virtual texture and its pages.  The cache
+ *  itself is kept for the next textures.
+ ***********************************************************/
+void VirtualTextureSystem::Clear()
+{
+	if (m_pageLoader != NULL)
+	{
+		m_pageLoader->Clear();
+	}
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		glDeleteTextures(1, &m_textures[i].pageTable);
+	}
+	m_textures.clear();
+	m_wantedPages.clear();
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		m_slots[i].texture = -1;
+		m_slots[i].page = -1;
+		m_slots[i].bPinned = false;
+		m_slots[i].lastUsedFrame = 0;
+	}
+
+	int cachePages = m_stats.cachePages;
+	size_t cacheBytes = m_stats.cacheBytes;
+	m_stats = VIRTUAL_TEXTURE_STATS();
+	m_stats.cachePages = cachePages;
+	m_stats.cacheBytes = cacheBytes;
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  Bind a virtual texture's page table and the page cache,
+ *  and pass the layout of its levels to the shader.  The
+ *  shader picks the level from the UV derivatives and the
+ *  page from the UVs, so the UV scale set for the draw tiles
+ *  virtual textures like any other.
+ ***********************************************************/
+void VirtualTextureSystem::BindTexture(int texture, const ShaderManager* pShaderManager)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()) || (pShaderManager == NULL))
+	{
+		return;
+	}
+	const VIRTUAL_TEXTURE& virtualTexture = m_textures[texture];
+
+	GLint previousActiveTexture = 0;
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
+	glActiveTexture(GL_TEXTURE0 + m_pageTableUnit);
+	glBindTexture(GL_TEXTURE_2D, virtualTexture.pageTable);
+	glActiveTexture(GL_TEXTURE0 + m_pageCacheUnit);
+	glBindTexture(GL_TEXTURE_2D, m_pageCache);
+	glActiveTexture(previousActiveTexture);
+
+	// each level's first page table entry and size in texels
+	int levels[MAX_VIRTUAL_LEVELS * 4];
+	int levelCount = (int)virtualTexture.levels.size();
+	for (int i = 0; i < levelCount; i++)
+	{
+		levels[(i * 4) + 0] = virtualTexture.tableOffsets[i];
+		levels[(i * 4) + 1] = 0;
+		levels[(i * 4) + 2] = virtualTexture.levels[i].width;
+		levels[(i * 4) + 3] = virtualTexture.levels[i].height;
+	}
+
+	int cacheSize = m_cachePagesAcross * TiledImageFile::PaddedPageSize(m_pageSize, m_pageBorder);
+	pShaderManager->setBoolValue("bUseVirtualTexture", true);
+	pShaderManager->setSampler2DValue("pageTable", m_pageTableUnit);
+	pShaderManager->setSampler2DValue("pageCache", m_pageCacheUnit);
+	// zero marks pixels without a virtual texture in the feedback
+	pShaderManager->setIntValue("virtualTextureID", texture + 1);
+	pShaderManager->setIntValue("virtualLevelCount", levelCount);
+	pShaderManager->setIVec4ArrayValue("virtualLevels", levels, levelCount);
+	pShaderManager->setIntValue("pageSize", m_pageSize);
+	pShaderManager->setIntValue("pageBorder", m_pageBorder);
+	pShaderManager->setVec2Value("pageCacheSize", (float)cacheSize, (float)cacheSize);
+}
+
+/***********************************************************
+ *  BeginFeedbackPass()
+ *
+ *  Switch rendering to the feedback target, which is the
+ *  viewport reduced by the feedback scale.  The shader then
+ *  writes the page each pixel of a virtual texture needs in
+ *  place of its color, with the level biased back to what
+ *  the full size viewport needs.
+ ***********************************************************/
+void VirtualTextureSystem::BeginFeedbackPass(const ShaderManager* pShaderManager)
+{
+	if ((IsInitialized() == false) || (pShaderManager == NULL))
+	{
+		return;
+	}
+
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &m_previousReadFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, m_previousClearColor);
+	m_bPreviousBlend = glIsEnabled(GL_BLEND);
+
+	int width = std::max(1, m_previousViewport[2] / m_feedbackScale);
+	int height = std::max(1, m_previousViewport[3] / m_feedbackScale);
+	if ((width != m_feedbackWidth) || (height != m_feedbackHeight))
+	{
+		GLint previousTexture = 0;
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+		glBindTexture(GL_TEXTURE_2D, m_feedbackColor);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glBindTexture(GL_TEXTURE_2D, previousTexture);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_feedbackDepth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_feedbackFramebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_feedbackColor, 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_feedbackDepth);
+		m_feedbackWidth = width;
+		m_feedbackHeight = height;
+		m_feedbackPixels.resize((size_t)width * height * 4);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_feedbackFramebuffer);
+	glViewport(0, 0, m_feedbackWidth, m_feedbackHeight);
+	glDisable(GL_BLEND);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	pShaderManager->setBoolValue("bWriteFeedback", true);
+	pShaderManager->setFloatValue("feedbackLodBias", -std::log2((float)m_feedbackScale));
+}
+
+/***********************************************************
+ *  EndFeedbackPass()
+ *
+ *  Read the feedback back, restore the render target and
+ *  state, and collect the pages the view needs.  The target
+ *  is small enough that a synchronous read costs less than
+ *  the draws that filled it.
+ ***********************************************************/
+void VirtualTextureSystem::EndFeedbackPass(const ShaderManager* pShaderManager)
+{
+	if ((IsInitialized() == false) || (pShaderManager == NULL))
+	{
+		return;
+	}
+
+	pShaderManager->setBoolValue("bWriteFeedback", false);
+
+	GLint previousPackAlignment = 4;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_feedbackWidth, m_feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, m_feedbackPixels.data());
+	glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_previousFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_previousReadFramebuffer);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+	glClearColor(m_previousClearColor[0], m_previousClearColor[1], m_previousClearColor[2], m_previousClearColor[3]);
+	if (m_bPreviousBlend == GL_TRUE)
+	{
+		glEnable(GL_BLEND);
+	}
+
+	ProcessFeedback();
+}
+
+/***********************************************************
+ *  ProcessFeedback()
+ *
+ *  Decode the distinct page requests of the feedback pixels.
+ *  Each pixel holds the texture index plus one in red, the
+ *  low bits of the page x and y in green and blue, and the
+ *  level with the high page bits in alpha.
+ ***********************************************************/
+void VirtualTextureSystem::ProcessFeedback()
+{
+	std::vector<unsigned int> requests;
+	requests.reserve(m_feedbackPixels.size() / 4);
+	for (size_t i = 0; i < m_feedbackPixels.size(); i += 4)
+	{
+		if (m_feedbackPixels[i] != 0)
+		{
+			requests.push_back(
+				((unsigned int)m_feedbackPixels[i] << 24) |
+				((unsigned int)m_feedbackPixels[i + 1] << 16) |
+				((unsigned int)m_feedbackPixels[i + 2] << 8) |
+				(unsigned int)m_feedbackPixels[i + 3]);
+		}
+	}
+	std::sort(requests.begin(), requests.end());
+	requests.erase(std::unique(requests.begin(), requests.end()), requests.end());
+
+	m_wantedPages.clear();
+	m_stats.missingPages = 0;
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		unsigned int request = requests[i];
+		int texture = (int)(request >> 24) - 1;
+		int pageX = (int)((request >> 16) & 0xFF) | (int)(((request >> 4) & 0x3) << 8);
+		int pageY = (int)((request >> 8) & 0xFF) | (int)(((request >> 6) & 0x3) << 8);
+		int level = (int)(request & 0xF);
+		if (TouchPage(texture, level, pageX, pageY) == false)
+		{
+			m_stats.missingPages++;
+		}
+	}
+	m_stats.requestedPages = (int)requests.size();
+
+	// coarse pages first - each one is the fallback for the finer
+	// pages still missing below it
+	std::sort(m_wantedPages.begin(), m_wantedPages.end(),
+		[](const VirtualPageLoader::PAGE_REQUEST& a, const VirtualPageLoader::PAGE_REQUEST& b)
+		{
+			if (a.level != b.level)
+				return(a.level > b.level);
+			if (a.texture != b.texture)
+				return(a.texture < b.texture);
+			if (a.pageY != b.pageY)
+				return(a.pageY < b.pageY);
+			return(a.pageX < b.pageX);
+		});
+	m_wantedPages.erase(std::unique(m_wantedPages.begin(), m_wantedPages.end(),
+		[](const VirtualPageLoader::PAGE_REQUEST& a, const VirtualPageLoader::PAGE_REQUEST& b)
+		{
+			return((a.texture == b.texture) && (a.level == b.level) && (a.pageX == b.pageX) && (a.pageY == b.pageY));
+		}), m_wantedPages.end());
+}
+
+/***********************************************************
+ *  TouchPage()
+ *
+ *  Mark a page and every coarser page covering it as used
+ *  this frame, and want the ones that are not resident.
+ *  Levels halve with rounding down, so a parent index can
+ *  land one past the edge and is clamped.  Returns whether
+ *  the page itself is resident.
+ ***********************************************************/
+bool VirtualTextureSystem::TouchPage(int texture, int level, int pageX, int pageY)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()))
+	{
+		return(false);
+	}
+	VIRTUAL_TEXTURE& virtualTexture = m_textures[texture];
+	if ((virtualTexture.bFailed == true) || (level >= (int)virtualTexture.levels.size()))
+	{
+		return(false);
+	}
+
+	bool bResident = false;
+
+	for (int l = std::max(0, level); l < (int)virtualTexture.levels.size(); l++)
+	{
+		pageX = std::min(pageX, virtualTexture.levels[l].pagesX - 1);
+		pageY = std::min(pageY, virtualTexture.levels[l].pagesY - 1);
+		int page = PageIndex(virtualTexture, l, pageX, pageY);
+		if (virtualTexture.pageStates[page] == PAGE_RESIDENT)
+		{
+			m_slots[virtualTexture.pageSlots[page]].lastUsedFrame = m_frame;
+			bResident = bResident || (l == level);
+		}
+		else if (virtualTexture.pageStates[page] == PAGE_ABSENT)
+		{
+			VirtualPageLoader::PAGE_REQUEST request;
+			request.texture = texture;
+			request.level = l;
+			request.pageX = pageX;
+			request.pageY = pageY;
+			m_wantedPages.push_back(request);
+		}
+		pageX /= 2;
+		pageY /= 2;
+	}
+	return(bResident);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  Copy the pages read since the last frame into the cache,
+ *  point the page tables at them, and queue the wanted pages
+ *  coarse first.  No more pages are queued than there are
+ *  cache pages the last feedback pass did not use, so a
+ *  cache too small for the view keeps drawing the coarser
+ *  pages instead of evicting pages still on screen.
+ ***********************************************************/
+void VirtualTextureSystem::Update()
+{
+	if ((IsInitialized() == false) || (m_pageLoader == NULL))
+	{
+		return;
+	}
+	m_frame++;
+
+	VirtualPageLoader::LOADED_PAGE loaded;
+	for (int uploads = 0; (uploads < MAX_UPLOADS_PER_FRAME) && (m_pageLoader->PollLoaded(loaded) == true); uploads++)
+	{
+		UploadPage(loaded);
+	}
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		if (m_textures[i].bTableDirty == true)
+		{
+			RebuildPageTable(m_textures[i]);
+		}
+	}
+
+	int availableSlots = 0;
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		if ((m_slots[i].texture < 0) ||
+			((m_slots[i].bPinned == false) && (m_slots[i].lastUsedFrame + 1 < m_frame)))
+		{
+			availableSlots++;
+		}
+	}
+
+	for (size_t i = 0; i < m_wantedPages.size(); i++)
+	{
+		if ((m_stats.pendingPages >= MAX_PENDING_PAGES) || (m_stats.pendingPages >= availableSlots))
+		{
+			break;
+		}
+		const VirtualPageLoader::PAGE_REQUEST& request = m_wantedPages[i];
+		VIRTUAL_TEXTURE& virtualTexture = m_textures[request.texture];
+		int page = PageIndex(virtualTexture, request.level, request.pageX, request.pageY);
+		if ((virtualTexture.bFailed == false) && (virtualTexture.pageStates[page] == PAGE_ABSENT))
+		{
+			virtualTexture.pageStates[page] = PAGE_PENDING;
+			m_pageLoader->Request(request);
+			m_stats.pendingPages++;
+		}
+	}
+	m_wantedPages.clear();
+}
+
+/***********************************************************
+ *  UploadPage()
+ *
+ *  Copy a finished page into a cache page, evicting the
+ *  least recently used page if the cache is full.  A page
+ *  that could not be read fails its whole texture, which
+ *  keeps drawing with the placeholder grey.
+ ***********************************************************/
+void VirtualTextureSystem::UploadPage(const VirtualPageLoader::LOADED_PAGE& loaded)
+{
+	const VirtualPageLoader::PAGE_REQUEST& request = loaded.page;
+	if ((request.texture < 0) || (request.texture >= (int)m_textures.size()))
+	{
+		return;
+	}
+	VIRTUAL_TEXTURE& virtualTexture = m_textures[request.texture];
+	int page = PageIndex(virtualTexture, request.level, request.pageX, request.pageY);
+	if (virtualTexture.pageStates[page] != PAGE_PENDING)
+	{
+		return;
+	}
+	m_stats.pendingPages--;
+
+	if (loaded.bLoaded == false)
+	{
+		if (virtualTexture.bFailed == false)
+		{
+			std::cout << "Could not read the pages of a virtual texture" << std::endl;
+		}
+		virtualTexture.bFailed = true;
+		virtualTexture.pageStates[page] = PAGE_ABSENT;
+		return;
+	}
+
+	int slot = AllocateSlot();
+	if (slot < 0)
+	{
+		virtualTexture.pageStates[page] = PAGE_ABSENT;
+		return;
+	}
+
+	CACHE_SLOT& cacheSlot = m_slots[slot];
+	if (cacheSlot.texture >= 0)
+	{
+		VIRTUAL_TEXTURE& evicted = m_textures[cacheSlot.texture];
+		evicted.pageStates[cacheSlot.page] = PAGE_ABSENT;
+		evicted.pageSlots[cacheSlot.page] = -1;
+		evicted.bTableDirty = true;
+		m_stats.residentPages--;
+		m_stats.evictedPages++;
+	}
+
+	int paddedSize = TiledImageFile::PaddedPageSize(m_pageSize, m_pageBorder);
+	GLint previousTexture = 0;
+	GLint previousUnpackAlignment = 4;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousUnpackAlignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, m_pageCache);
+	glTexSubImage2D(GL_TEXTURE_2D, 0,
+		(slot % m_cachePagesAcross) * paddedSize,
+		(slot / m_cachePagesAcross) * paddedSize,
+		paddedSize, paddedSize, GL_RGBA, GL_UNSIGNED_BYTE, loaded.texels.data());
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, previousUnpackAlignment);
+
+	cacheSlot.texture = request.texture;
+	cacheSlot.page = page;
+	cacheSlot.bPinned = (request.level == (int)virtualTexture.levels.size() - 1);
+	cacheSlot.lastUsedFrame = m_frame;
+	virtualTexture.pageStates[page] = PAGE_RESIDENT;
+	virtualTexture.pageSlots[page] = slot;
+	virtualTexture.bTableDirty = true;
+	m_stats.residentPages++;
+	m_stats.loadedPages++;
+}
+
+/***********************************************************
+ *  AllocateSlot()
+ *
+ *  Pick a free cache page, or else the least recently used
+ *  page that the last feedback pass did not ask for.  The
+ *  pinned coarsest pages are never picked.
+ ***********************************************************/
+int VirtualTextureSystem::AllocateSlot()
+{
+	int best = -1;
+	for (int i = 0; i < (int)m_slots.size(); i++)
+	{
+		if (m_slots[i].texture < 0)
+		{
+			return(i);
+		}
+		if ((m_slots[i].bPinned == false) && (m_slots[i].lastUsedFrame + 1 < m_frame) &&
+			((best < 0) || (m_slots[i].lastUsedFrame < m_slots[best].lastUsedFrame)))
+		{
+			best = i;
+		}
+	}
+	return(best);
+}
+
+/***********************************************************
+ *  RebuildPageTable()
+ *
+ *  Point every page table entry at its own page when it is
+ *  resident, and otherwise at the entry of the coarser page
+ *  covering it, working from the coarsest level down.  The
+ *  entries hold the cache page and the level it was cut
+ *  from, which the shader rescales the UVs to.
+ ***********************************************************/
+void VirtualTextureSystem::RebuildPageTable(VIRTUAL_TEXTURE& texture)
+{
+	for (int l = (int)texture.levels.size() - 1; l >= 0; l--)
+	{
+		const TiledImageFile::TILED_LEVEL& level = texture.levels[l];
+		for (int pageY = 0; pageY < level.pagesY; pageY++)
+		{
+			for (int pageX = 0; pageX < level.pagesX; pageX++)
+			{
+				unsigned char* entry = &texture.tableEntries[(((size_t)pageY * texture.tableWidth) + texture.tableOffsets[l] + pageX) * 4];
+				int page = PageIndex(texture, l, pageX, pageY);
+				if (texture.pageStates[page] == PAGE_RESIDENT)
+				{
+					int slot = texture.pageSlots[page];
+					entry[0] = (unsigned char)(slot % m_cachePagesAcross);
+					entry[1] = (unsigned char)(slot / m_cachePagesAcross);
+					entry[2] = (unsigned char)l;
+					entry[3] = 1;
+				}
+				else if (l + 1 < (int)texture.levels.size())
+				{
+					const TiledImageFile::TILED_LEVEL& parent = texture.levels[l + 1];
+					int parentX = std::min(pageX / 2, parent.pagesX - 1);
+					int parentY = std::min(pageY / 2, parent.pagesY - 1);
+					const unsigned char* parentEntry = &texture.tableEntries[(((size_t)parentY * texture.tableWidth) + texture.tableOffsets[l + 1] + parentX) * 4];
+					entry[0] = parentEntry[0];
+					entry[1] = parentEntry[1];
+					entry[2] = parentEntry[2];
+					entry[3] = parentEntry[3];
+				}
+				else
+				{
+					entry[0] = 0;
+					entry[1] = 0;
+					entry[2] = 0;
+					entry[3] = 0;
+				}
+			}
+		}
+	}
+
+	GLint previousTexture = 0;
+	GLint previousUnpackAlignment = 4;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousUnpackAlignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, texture.pageTable);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture.tableWidth, texture.tableHeight,
+		GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, texture.tableEntries.data());
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, previousUnpackAlignment);
+	texture.bTableDirty = false;
+}
+
+/***********************************************************
+ *  IsBusy()
+ *
+ *  Check whether any requested page is still being read or
+ *  waiting to be copied into the cache.
+ ***********************************************************/
+bool VirtualTextureSystem::IsBusy()
+{
+	return((m_stats.pendingPages > 0) || ((m_pageLoader != NULL) && (m_pageLoader->IsBusy() == true)));
+}
+
+/***********************************************************
+ *  PageIndex()
+ *
+ *  Get the index of a page in a texture's page arrays, which
+ *  follow the order of the tiled file.
+ ***********************************************************/
+int VirtualTextureSystem::PageIndex(const VIRTUAL_TEXTURE& texture, int level, int pageX, int pageY)
+{
+	const TiledImageFile::TILED_LEVEL& tiledLevel = texture.levels[level];
+	return(tiledLevel.firstPage + (pageY * tiledLevel.pagesX) + pageX);
+}
@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexturesystem.h
+// ============
+// sample very large textures through a page table and a fixed size cache
+// of the pages the current view needs
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "VirtualPageLoader.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  VirtualTextureSystem
+ *
+ *  This class draws textures from pages held in one shared
+ *  physical cache texture.  Every virtual texture has a page
+ *  table texture with an entry per page of each mip level,
+ *  naming the cache page to sample - the page itself, or the
+ *  nearest coarser page that is resident.  A low resolution
+ *  feedback pass renders the page each pixel wants, and the
+ *  missing pages are read in the background from tiled files
+ *  and evicted least recently used first.  The single page
+ *  coarsest level of every texture is kept in the cache, so
+ *  every texture can be drawn without waiting on a read.
+ *
+ *  The fragment shader looks up the page table with
+ *  texelFetch and samples the cache with bilinear filtering,
+ *  which needs nothing beyond OpenGL 3.3 and runs under
+ *  software rasterizers.
+ ***********************************************************/
+class VirtualTextureSystem
+{
+public:
+	// counters of the page traffic
+	struct VIRTUAL_TEXTURE_STATS
+	{
+		int textures;
+		int cachePages;			// pages the physical cache holds
+		int residentPages;
+		int pendingPages;		// requested and not uploaded yet
+		int requestedPages;		// distinct pages the last feedback pass asked for
+		int missingPages;		// of those, the pages drawn from a coarser page
+		int loadedPages;		// totals since the textures were added
+		int evictedPages;
+		size_t cacheBytes;		// size of the physical cache texture
+		size_t virtualBytes;	// size of every page of every texture
+	};
+
+	// constructor - the cache holds cachePagesAcross squared pages
+	VirtualTextureSystem(
+		const MipGenerator* pMipGenerator,
+		const JpegDecoder* pJpegDecoder,
+		int cachePagesAcross = 16,
+		int pageSize = 128,
+		int pageBorder = 4,
+		int feedbackScale = 8);
+	// destructor - needs the OpenGL context to still exist
+	~VirtualTextureSystem();
+
+	// create the cache and feedback target on the given texture units,
+	// needs a current OpenGL context
+	bool Initialize(int pageTableUnit, int pageCacheUnit);
+	bool IsInitialized() const { return m_pageCache != 0; }
+
+	// add an image as a virtual texture, returns its index or -1
+	int AddTexture(const std::string& filename, int width, int height);
+	// drop every virtual texture and empty the cache
+	void Clear();
+
+	// bind a virtual texture's page table and the cache for the next draws
+	void BindTexture(int texture, const ShaderManager* pShaderManager);
+
+	// render the draws between these calls as page requests into the
+	// low resolution feedback target
+	void BeginFeedbackPass(const ShaderManager* pShaderManager);
+	void EndFeedbackPass(const ShaderManager* pShaderManager);
+
+	// upload the pages read since the last call and request the missing
+	// pages the last feedback pass found, once per frame
+	void Update();
+
+	// check whether any requested page is not uploaded yet
+	bool IsBusy();
+	const VIRTUAL_TEXTURE_STATS& GetStats() const { return m_stats; }
+	int GetFeedbackScale() const { return m_feedbackScale; }
+
+private:
+	// where a page of a virtual texture is
+	enum PAGE_STATE
+	{
+		PAGE_ABSENT,
+		PAGE_PENDING,
+		PAGE_RESIDENT
+	};
+
+	// a texture drawn through the page table
+	struct VIRTUAL_TEXTURE
+	{
+		std::vector<TiledImageFile::TILED_LEVEL> levels;
+		// x of each level's first entry in the page table - the
+		// levels sit side by side, level 0 on the left
+		std::vector<int> tableOffsets;
+		int tableWidth;
+		int tableHeight;
+		GLuint pageTable;
+		// RGBA entries: cache page x and y, mapped level, valid
+		std::vector<unsigned char> tableEntries;
+		bool bTableDirty;
+		// per page of every level, in file order
+		std::vector<unsigned char> pageStates;
+		std::vector<int> pageSlots;
+		// set once a page could not be read
+		bool bFailed;
+	};
+
+	// one page of the physical cache
+	struct CACHE_SLOT
+	{
+		int texture;			// -1 if free
+		int page;
+		// the coarsest page of a texture is never evicted
+		bool bPinned;
+		unsigned int lastUsedFrame;
+	};
+
+	const MipGenerator* m_pMipGenerator;
+	const JpegDecoder* m_pJpegDecoder;
+	VirtualPageLoader* m_pageLoader;
+	int m_cachePagesAcross;
+	int m_pageSize;
+	int m_pageBorder;
+	int m_feedbackScale;
+	int m_pageTableUnit;
+	int m_pageCacheUnit;
+
+	GLuint m_pageCache;
+	std::vector<CACHE_SLOT> m_slots;
+	std::vector<VIRTUAL_TEXTURE> m_textures;
+
+	// feedback render target, sized from the viewport
+	GLuint m_feedbackFramebuffer;
+	GLuint m_feedbackColor;
+	GLuint m_feedbackDepth;
+	int m_feedbackWidth;
+	int m_feedbackHeight;
+	std::vector<unsigned char> m_feedbackPixels;
+	// state restored after the feedback pass
+	GLint m_previousFramebuffer;
+	GLint m_previousReadFramebuffer;
+	GLint m_previousViewport[4];
+	GLfloat m_previousClearColor[4];
+	GLboolean m_bPreviousBlend;
+
+	// pages the last feedback pass asked for that are not resident
+	std::vector<VirtualPageLoader::PAGE_REQUEST> m_wantedPages;
+	unsigned int m_frame;
+	VIRTUAL_TEXTURE_STATS m_stats;
+
+	// release the OpenGL objects
+	void Destroy();
+	// collect the page requests rendered by the feedback pass
+	void ProcessFeedback();
+	// mark a page and its coarser parents as used this frame, and
+	// want the ones that are not resident
+	bool TouchPage(int texture, int level, int pageX, int pageY);
+	// copy a finished page into a cache page, evicting if needed
+	void UploadPage(const VirtualPageLoader::LOADED_PAGE& loaded);
+	// pick the cache page for a new page, -1 if every page is in use
+	int AllocateSlot();
+	// point every entry of a page table at its best resident page
+	void RebuildPageTable(VIRTUAL_TEXTURE& texture);
+	// index of a page in a texture's page arrays
+	static int PageIndex(const VIRTUAL_TEXTURE& texture, int level, int pageX, int pageY);
+};
@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+// ycbcrconverter.cpp
+// ============
+// upsample and convert decoded JPEG color planes to RGB textures on the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "YCbCrConverter.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  YCbCrConverter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+YCbCrConverter::YCbCrConverter()
+{
+	m_pShaderManager = NULL;
+	m_framebuffer = 0;
+	m_vertexArray = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		m_planeTextures[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~YCbCrConverter()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+YCbCrConverter::~YCbCrConverter()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Compile the conversion program and create the render
+ *  target and plane textures.  Returns false if the shaders
+ *  could not be built.
+ ***********************************************************/
+bool YCbCrConverter::Initialize(const char* vertexShaderPath, const char* fragmentShaderPath)
+{
+	Destroy();
+
+	m_pShaderManager = new ShaderManager();
+	if (m_pShaderManager->LoadShaders(vertexShaderPath, fragmentShaderPath) == 0)
+	{
+		std::cout << "Could not build the YCbCr conversion shaders" << std::endl;
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+		return(false);
+	}
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glGenVertexArrays(1, &m_vertexArray);
+	glGenTextures(3, m_planeTextures);
+
+	// integer textures cannot be filtered, so each plane is
+	// read with texelFetch and needs nearest filtering to be
+	// complete
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	for (int i = 0; i < 3; i++)
+	{
+		glBindTexture(GL_TEXTURE_2D, m_planeTextures[i]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  Release the conversion program and OpenGL objects.
+ ***********************************************************/
+void YCbCrConverter::Destroy()
+{
+	if (m_pShaderManager != NULL)
+	{
+		glDeleteProgram(m_pShaderManager->m_programID);
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (m_vertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = 0;
+	}
+	if (m_planeTextures[0] != 0)
+	{
+		glDeleteTextures(3, m_planeTextures);
+		for (int i = 0; i < 3; i++)
+		{
+			m_planeTextures[i] = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  UploadBytes()
+ *
+ *  Get the number of bytes uploaded for the planes of an
+ *  image, without the padding to whole MCUs.
+ ***********************************************************/
+size_t YCbCrConverter::UploadBytes(const JpegDecoder::JPEG_PLANES& planes)
+{
+	size_t bytes = 0;
+	for (int i = 0; i < planes.componentCount; i++)
+	{
+		bytes += (size_t)planes.planes[i].width * planes.planes[i].height;
+	}
+	return(bytes);
+}
+
+/***********************************************************
+ *  Convert()
+ *
+ *  Upload the planes and render the converted image into
+ *  level 0 of the passed in texture, which is reallocated
+ *  as RGBA8 at the image size.  Every piece of OpenGL state
+ *  the pass changes is restored, so this can run between
+ *  the draws of a frame.
+ ***********************************************************/
+bool YCbCrConverter::Convert(const JpegDecoder::JPEG_PLANES& planes, GLuint textureID, bool bFlipVertically)
+{
+	if ((m_pShaderManager == NULL) || ((planes.componentCount != 1) && (planes.componentCount != 3)))
+	{
+		return(false);
+	}
+
+	// state the pass changes
+	GLint previousProgram = 0;
+	GLint previousFramebuffer = 0;
+	GLint previousVertexArray = 0;
+	GLint previousActiveTexture = 0;
+	GLint previousTextures[3] = { 0, 0, 0 };
+	GLint previousViewport[4] = { 0, 0, 0, 0 };
+	GLint previousUnpackAlignment = 4;
+	GLint previousUnpackRowLength = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousUnpackAlignment);
+	glGetIntegerv(GL_UNPACK_ROW_LENGTH, &previousUnpackRowLength);
+	GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean bBlend = glIsEnabled(GL_BLEND);
+	GLboolean bCullFace = glIsEnabled(GL_CULL_FACE);
+	for (int i = 0; i < 3; i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTextures[i]);
+	}
+
+	// planes at their own resolution - the rows are padded to
+	// whole MCUs, so only the covered samples are uploaded
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int i = 0; i < planes.componentCount; i++)
+	{
+		const JpegDecoder::JPEG_PLANE& plane = planes.planes[i];
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, m_planeTextures[i]);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, plane.stride);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, plane.width, plane.height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, plane.pixels.data());
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, previousUnpackRowLength);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, previousUnpackAlignment);
+
+	// the converted image replaces the texture's level 0
+	glActiveTexture(GL_TEXTURE0 + 3);
+	GLint previousTarget = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTarget);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, planes.width, planes.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindTexture(GL_TEXTURE_2D, previousTarget);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureID, 0);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	if (bComplete == true)
+	{
+		glViewport(0, 0, planes.width, planes.height);
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+		glDisable(GL_CULL_FACE);
+
+		m_pShaderManager->use();
+		m_pShaderManager->setIntValue("planeY", 0);
+		m_pShaderManager->setIntValue("planeCb", 1);
+		m_pShaderManager->setIntValue("planeCr", 2);
+		m_pShaderManager->setIntValue("componentCount", planes.componentCount);
+		m_pShaderManager->setIntValue("imageHeight", planes.height);
+		m_pShaderManager->setBoolValue("bFlipVertically", bFlipVertically);
+		m_pShaderManager->setIVec2Value("scaleY", planes.planes[0].horizontalScale, planes.planes[0].verticalScale);
+		if (planes.componentCount == 3)
+		{
+			m_pShaderManager->setIVec2Value("scaleCb", planes.planes[1].horizontalScale, planes.planes[1].verticalScale);
+			m_pShaderManager->setIVec2Value("scaleCr", planes.planes[2].horizontalScale, planes.planes[2].verticalScale);
+		}
+
+		glBindVertexArray(m_vertexArray);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	else
+	{
+		std::cout << "Could not render to the converted texture" << std::endl;
+	}
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+
+	// restore the state
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glBindVertexArray(previousVertexArray);
+	glUseProgram(previousProgram);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	if (bDepthTest == GL_TRUE)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+	if (bBlend == GL_TRUE)
+	{
+		glEnable(GL_BLEND);
+	}
+	if (bCullFace == GL_TRUE)
+	{
+		glEnable(GL_CULL_FACE);
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, previousTextures[i]);
+	}
+	glActiveTexture(previousActiveTexture);
+
+	return(bComplete);
+}
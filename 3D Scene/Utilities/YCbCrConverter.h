@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// ycbcrconverter.h
+// ============
+// upsample and convert decoded JPEG color planes to RGB textures on the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JpegDecoder.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  YCbCrConverter
+ *
+ *  This class uploads the Y, Cb and Cr planes of a decoded
+ *  JPEG at their own resolution and renders them into an
+ *  RGBA texture with a fragment pass.  The chroma is
+ *  upsampled and converted with the CPU decoder's integer
+ *  arithmetic, so the texels match a CPU decode exactly,
+ *  while a 4:2:0 image uploads half the bytes of its RGB.
+ ***********************************************************/
+class YCbCrConverter
+{
+public:
+	// constructor
+	YCbCrConverter();
+	// destructor - needs the OpenGL context to still exist
+	~YCbCrConverter();
+
+	// compile the conversion shaders, needs a current OpenGL context
+	bool Initialize(const char* vertexShaderPath, const char* fragmentShaderPath);
+	bool IsInitialized() const { return m_pShaderManager != NULL; }
+
+	// convert the planes into level 0 of an RGBA8 texture, the
+	// current OpenGL state is kept
+	bool Convert(const JpegDecoder::JPEG_PLANES& planes, GLuint textureID, bool bFlipVertically);
+
+	// bytes uploaded for the planes of an image
+	static size_t UploadBytes(const JpegDecoder::JPEG_PLANES& planes);
+
+private:
+	// conversion program
+	ShaderManager* m_pShaderManager;
+	// render target holding the converted texture
+	GLuint m_framebuffer;
+	// empty vertex array for the bufferless full screen triangle
+	GLuint m_vertexArray;
+	// one 8 bit integer texture per color plane
+	GLuint m_planeTextures[3];
+
+	// release the OpenGL objects
+	void Destroy();
+};
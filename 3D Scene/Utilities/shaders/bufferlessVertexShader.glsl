@@ -0,0 +1,343 @@
+#version 440 core
+
+// makes every vertex of the analytic shapes from gl_VertexID alone,
+// with no vertex buffers.  The shapes match the meshes ShapeGenerator
+// writes - each vertex is one corner of a triangle, in the order of
+// the mesh's indices, so the same ranges draw the caps, sides and
+// halves
+
+// the shapes, matching ShapeGenerator::PrimitiveType
+#define PRIMITIVE_BOX 0
+#define PRIMITIVE_PLANE 1
+#define PRIMITIVE_SPHERE 2
+#define PRIMITIVE_CYLINDER 3
+#define PRIMITIVE_CONE 4
+#define PRIMITIVE_TORUS 5
+
+const float PI = 3.14159265358979;
+
+// one shape of a draw of several, matching ShapeMeshes - the type
+// and tessellation, where its vertices start in the draw and in
+// the shape, its parameter and its place in the model
+struct PRIMITIVE_RECORD
+{
+   ivec4 shape;         // type, segments a, segments b, unused
+   ivec4 range;         // first vertex in the draw, first vertex of the shape
+   vec4 parameters;     // x is the cylinder top or torus tube radius
+   mat4 model;
+};
+
+layout (std430, binding = 0) readonly buffer PrimitiveRecords
+{
+   PRIMITIVE_RECORD records[];
+};
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+// with no records, the whole draw is this one shape
+uniform int primitiveCount = 0;
+uniform ivec4 primitiveShape;
+uniform float primitiveParameter;
+
+// the depth pre-pass and the shading pass both run this shader,
+// and the shading pass tests for equal depth
+invariant gl_Position;
+
+// the corner of a quad each vertex of its two triangles is
+const int QUAD_CORNERS[6] = int[6](0, 1, 2, 0, 3, 2);
+// and of a box side drawn alone, split as a fan like the side fans
+// after ShapeGenerator's box triangles
+const int FAN_CORNERS[6] = int[6](0, 1, 2, 0, 2, 3);
+const int BOX_SIDE_FIRST_VERTEX = 36;
+
+// the unit box, as ShapeGenerator's face table - the corners are
+// numbered by their sides, +x adding 1, +y adding 2 and +z adding 4,
+// and the normals are the ones the scene's lighting was set up with
+const ivec4 BOX_FACES[6] = ivec4[6](
+   ivec4(3, 1, 0, 2), ivec4(4, 0, 1, 5), ivec4(2, 0, 4, 6),
+   ivec4(7, 5, 1, 3), ivec4(2, 6, 7, 3), ivec4(6, 4, 5, 7));
+const vec3 BOX_NORMALS[6] = vec3[6](
+   vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0), vec3(-1.0, 0.0, 0.0),
+   vec3(-1.0, 0.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, -1.0));
+const vec2 BOX_UV[4] = vec2[4](vec2(0.0, 1.0), vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0));
+
+// the 2x2 plane facing up
+const vec3 PLANE_CORNERS[4] = vec3[4](
+   vec3(-1.0, 0.0, 1.0), vec3(1.0, 0.0, 1.0), vec3(1.0, 0.0, -1.0), vec3(-1.0, 0.0, -1.0));
+const vec2 PLANE_UV[4] = vec2[4](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+// the direction of rim vertex i of a round shape, from +x toward -z
+vec2 RimDirection(int segments, int i)
+{
+   float angle = (2.0 * PI * float(i % segments)) / float(segments);
+   return vec2(cos(angle), -sin(angle));
+}
+
+// a vertex of a cap fanned out from its first rim vertex
+void CapVertex(int segments, int vertex, float radius, float height, float normalY,
+   out vec3 position, out vec3 normal, out vec2 uv)
+{
+   int corner = vertex % 3;
+   int rim = (corner == 0) ? 0 : (vertex / 3) + corner;
+   vec2 direction = RimDirection(segments, rim);
+   position = vec3(radius * direction.x, height, radius * direction.y);
+   normal = vec3(0.0, normalY, 0.0);
+   uv = vec2(0.5 + (0.5 * direction.y), 0.5 + (0.5 * direction.x));
+}
+
+void BoxVertex(int vertex, out vec3 position, out vec3 normal, out vec2 uv)
+{
+   int face = (vertex % BOX_SIDE_FIRST_VERTEX) / 6;
+   int corner = (vertex < BOX_SIDE_FIRST_VERTEX) ? QUAD_CORNERS[vertex % 6] : FAN_CORNERS[vertex % 6];
+   int boxCorner = BOX_FACES[face][corner];
+   position = vec3(((boxCorner & 1) != 0) ? 0.5 : -0.5,
+      ((boxCorner & 2) != 0) ? 0.5 : -0.5,
+      ((boxCorner & 4) != 0) ? 0.5 : -0.5);
+   normal = BOX_NORMALS[face];
+   uv = BOX_UV[corner];
+}
+
+void PlaneVertex(int vertex, out vec3 position, out vec3 normal, out vec2 uv)
+{
+   int corner = QUAD_CORNERS[vertex % 6];
+   position = PLANE_CORNERS[corner];
+   normal = vec3(0.0, 1.0, 0.0);
+   uv = PLANE_UV[corner];
+}
+
+// the bottom, the top, then the sides, which narrow to the top
+// radius and repeat their first column at the end
+void CylinderVertex(int segments, float topRadius, int vertex, out vec3 position, out vec3 normal, out vec2 uv)
+{
+   int cap = (segments - 2) * 3;
+   if (vertex < cap)
+   {
+      CapVertex(segments, vertex, 1.0, 0.0, -1.0, position, normal, uv);
+      return;
+   }
+   if (vertex < cap * 2)
+   {
+      CapVertex(segments, vertex - cap, topRadius, 1.0, 1.0, position, normal, uv);
+      return;
+   }
+
+   // the quads are split as (top, bottom, next bottom) and
+   // (top, next top, next bottom)
+   const ivec2 SIDE_CORNERS[6] = ivec2[6](
+      ivec2(0, 1), ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1), ivec2(1, 0));
+   int side = vertex - (cap * 2);
+   ivec2 corner = SIDE_CORNERS[side % 6];
+   int column = (side / 6) + corner.x;
+   vec2 direction = RimDirection(segments, column);
+   float radius = (corner.y == 1) ? topRadius : 1.0;
+   float lean = 1.0 - topRadius;
+   float normalXZ = 1.0 / sqrt(1.0 + (lean * lean));
+   position = vec3(direction.x * radius, float(corner.y), direction.y * radius);
+   normal = vec3(direction.x * normalXZ, lean * normalXZ, direction.y * normalXZ);
+   uv = vec2(float(column) / float(segments), float(corner.y));
+}
+
+// the bottom, then a triangle from each rim segment to the tip
+void ConeVertex(int segments, int vertex, out vec3 position, out vec3 normal, out vec2 uv)
+{
+   int cap = (segments - 2) * 3;
+   if (vertex < cap)
+   {
+      CapVertex(segments, vertex, 1.0, 0.0, -1.0, position, normal, uv);
+      return;
+   }
+
+   // the sides lean in by 45 degrees, so their normals point
+   // halfway up
+   const float SLOPE = 0.70710678;
+   int side = vertex - cap;
+   int segment = side / 3;
+   int corner = side % 3;
+   if (corner == 1)
+   {
+      float tipAngle = (2.0 * PI * (float(segment) + 0.5)) / float(segments);
+      position = vec3(0.0, 1.0, 0.0);
+      normal = vec3(cos(tipAngle) * SLOPE, SLOPE, -sin(tipAngle) * SLOPE);
+      uv = vec2(0.5, 0.5);
+      return;
+   }
+   vec2 direction = RimDirection(segments, segment + ((corner == 2) ? 1 : 0));
+   position = vec3(direction.x, 0.0, direction.y);
+   normal = vec3(direction.x * SLOPE, SLOPE, direction.y * SLOPE);
+   uv = vec2(0.5 + (0.5 * direction.x), 0.5 - (0.5 * direction.y));
+}
+
+// a vertex of ring vertex i of the sphere, whose slices run from +z
+// through +x to -z, then repeat -z with the texture wrapped to the
+// other side and come back through -x.  Ring 0 and stacks are the
+// poles
+void SphereRingVertex(int slices, int stacks, int ring, int i, out vec3 position, out vec2 uv)
+{
+   if ((ring == 0) || (ring == stacks))
+   {
+      position = vec3(0.0, (ring == 0) ? 1.0 : -1.0, 0.0);
+      uv = vec2(0.5, (ring == 0) ? 1.0 : 0.0);
+      return;
+   }
+   int halfSlices = slices / 2;
+   float polarAngle = (PI * float(ring)) / float(stacks);
+   float radius = sin(polarAngle);
+   int slice = (i <= halfSlices) ? i : i - 1;
+   float angle = (2.0 * PI * float(slice)) / float(slices);
+   position = vec3(radius * sin(angle), cos(polarAngle), radius * cos(angle));
+   float wrapped = (i <= halfSlices) ? float(slice) : float(slice - slices);
+   uv = vec2(0.5 + ((radius * wrapped) / float(slices)), 1.0 - (float(ring) / float(stacks)));
+}
+
+// the bands from the top pole down, each walked from the seam
+// around to the slice before it
+void SphereVertex(int slices, int stacks, int vertex, out vec3 position, out vec3 normal, out vec2 uv)
+{
+   int ringVertices = slices + 1;
+   int topCap = slices * 3;
+   int band;
+   int step;
+   int corner;
+   if (vertex < topCap)
+   {
+      band = 0;
+      step = vertex / 3;
+      corner = vertex % 3;
+   }
+   else
+   {
+      int rest = vertex - topCap;
+      band = 1 + (rest / (slices * 6));
+      if (band == stacks - 1)
+      {
+         rest -= (stacks - 2) * slices * 6;
+         step = rest / 3;
+         corner = rest % 3;
+      }
+      else
+      {
+         rest = rest % (slices * 6);
+         step = rest / 6;
+         corner = rest % 6;
+      }
+   }
+
+   int i = ((slices / 2) + 1 + step) % ringVertices;
+   int next = (i + 1) % ringVertices;
+   int ring;
+   int ringVertex;
+   if (band == 0)
+   {
+      // the pole, then the ring below it
+      ring = (corner == 0) ? 0 : 1;
+      ringVertex = (corner == 2) ? next : i;
+   }
+   else if (band == stacks - 1)
+   {
+      // the ring above, the pole, then the next on the ring
+      ring = (corner == 1) ? stacks : band;
+      ringVertex = (corner == 2) ? next : i;
+   }
+   else
+   {
+      // (upper, lower, next lower) and (upper, next upper,
+      // next lower)
+      const ivec2 BAND_CORNERS[6] = ivec2[6](
+         ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 0), ivec2(0, 1), ivec2(1, 1));
+      ring = band + BAND_CORNERS[corner].x;
+      ringVertex = (BAND_CORNERS[corner].y == 1) ? next : i;
+   }
+   SphereRingVertex(slices, stacks, ring, ringVertex, position, uv);
+   normal = position;
+}
+
+// a grid around the z axis that wraps both ways, with the texture
+// coords of the mesh, which run from 0 up to the last segment
+void TorusVertex(int mainSegments, int tubeSegments, float tubeRadius, int vertex,
+   out vec3 position, out vec3 normal, out vec2 uv)
+{
+   // (here, next row and next, next) and (here, next row, next
+   // row and next)
+   const ivec2 GRID_CORNERS[6] = ivec2[6](
+      ivec2(0, 0), ivec2(1, 1), ivec2(0, 1), ivec2(0, 0), ivec2(1, 0), ivec2(1, 1));
+   int quad = vertex / 6;
+   ivec2 corner = GRID_CORNERS[vertex % 6];
+   int i = ((quad / tubeSegments) + corner.x) % mainSegments;
+   int j = ((quad % tubeSegments) + corner.y) % tubeSegments;
+
+   float mainAngle = (2.0 * PI * float(i)) / float(mainSegments);
+   float tubeAngle = (2.0 * PI * float(j)) / float(tubeSegments);
+   vec3 ring = vec3(cos(mainAngle), sin(mainAngle), 0.0);
+   normal = (ring * cos(tubeAngle)) + vec3(0.0, 0.0, sin(tubeAngle));
+   position = ring + (normal * tubeRadius);
+   uv = vec2(float(i) / float(mainSegments), float(j) / float(tubeSegments));
+}
+
+void main()
+{
+   ivec4 shape = primitiveShape;
+   float parameter = primitiveParameter;
+   int vertex = gl_VertexID;
+   mat4 primitiveModel = mat4(1.0);
+
+   // find the record whose vertices hold this one
+   if (primitiveCount > 0)
+   {
+      int low = 0;
+      int high = primitiveCount - 1;
+      while (low < high)
+      {
+         int middle = (low + high + 1) / 2;
+         if (records[middle].range.x <= gl_VertexID)
+         {
+            low = middle;
+         }
+         else
+         {
+            high = middle - 1;
+         }
+      }
+      shape = records[low].shape;
+      parameter = records[low].parameters.x;
+      vertex = (gl_VertexID - records[low].range.x) + records[low].range.y;
+      primitiveModel = records[low].model;
+   }
+
+   vec3 position = vec3(0.0);
+   vec3 normal = vec3(0.0, 1.0, 0.0);
+   vec2 uv = vec2(0.0);
+   switch (shape.x)
+   {
+   case PRIMITIVE_BOX:
+      BoxVertex(vertex, position, normal, uv);
+      break;
+   case PRIMITIVE_PLANE:
+      PlaneVertex(vertex, position, normal, uv);
+      break;
+   case PRIMITIVE_SPHERE:
+      SphereVertex(shape.y, shape.z, vertex, position, normal, uv);
+      break;
+   case PRIMITIVE_CYLINDER:
+      CylinderVertex(shape.y, parameter, vertex, position, normal, uv);
+      break;
+   case PRIMITIVE_CONE:
+      ConeVertex(shape.y, vertex, position, normal, uv);
+      break;
+   case PRIMITIVE_TORUS:
+      TorusVertex(shape.y, shape.z, parameter, vertex, position, normal, uv);
+      break;
+   }
+
+   // the normal stays in the space of the shape, as with the
+   // main vertex shader
+   mat4 world = model * primitiveModel;
+   fragmentPosition = vec3(world * vec4(position, 1.0));
+   gl_Position = projection * view * world * vec4(position, 1.0f);
+   fragmentVertexNormal = normal;
+   fragmentTextureCoordinate = uv;
+}
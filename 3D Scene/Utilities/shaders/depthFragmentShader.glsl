@@ -0,0 +1,8 @@
+#version 330 core
+
+// the depth pre-pass only writes depth - the shading pass then runs
+// the full fragment shader once for each pixel that is seen
+
+void main()
+{
+}
@@ -21,6 +21,15 @@ struct LightSource
 
 #define TOTAL_LIGHTS 4
 
+// procedural surface patterns, matching SceneManager::PROCEDURAL_PATTERN
+#define PATTERN_NONE 0
+#define PATTERN_WOOD 1
+#define PATTERN_METAL 2
+#define PATTERN_TILE 3
+
+// levels a virtual texture can have, matching VirtualTextureSystem
+#define MAX_VIRTUAL_LEVELS 16
+
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
@@ -33,14 +42,72 @@ uniform vec4 objectColor = vec4(1.0f);
 uniform sampler2D objectTexture;
 uniform vec3 viewPosition;
 uniform vec2 UVscale = vec2(1.0f, 1.0f);
+uniform bool bUseAtlas=false;
+uniform vec2 atlasScale = vec2(1.0f, 1.0f);
+uniform vec2 atlasOffset = vec2(0.0f, 0.0f);
 uniform LightSource lightSources[TOTAL_LIGHTS];
 uniform Material material;
+uniform int proceduralPattern = PATTERN_NONE;
+uniform vec3 patternColor1 = vec3(1.0f);
+uniform vec3 patternColor2 = vec3(0.0f);
+uniform float patternScale = 1.0f;
+uniform int patternOctaves = 4;
+uniform bool bUseVirtualTexture=false;
+// on their own units from the start, an integer sampler may not share
+// a unit with objectTexture
+layout(binding = 14) uniform usampler2D pageTable;
+layout(binding = 15) uniform sampler2D pageCache;
+uniform int virtualTextureID = 0;
+uniform int virtualLevelCount = 1;
+uniform ivec4 virtualLevels[MAX_VIRTUAL_LEVELS];
+uniform int pageSize = 128;
+uniform int pageBorder = 4;
+uniform vec2 pageCacheSize = vec2(1.0f, 1.0f);
+uniform bool bWriteFeedback=false;
+uniform float feedbackLodBias = 0.0f;
 
 // function prototypes
 vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec4 SampleObjectTexture(vec2 textureCoordinate);
+vec4 SurfaceTexture(vec2 textureCoordinate);
+float Hash(vec2 p);
+float ValueNoise(vec2 p);
+float FractalNoise(vec2 p);
+float DetailFade(vec2 p, float frequency);
+vec3 WoodPattern(vec2 p);
+vec3 TilePattern(vec2 p);
+float MetalPattern(vec2 p);
+int VirtualLevel(vec2 textureCoordinate, float lodBias);
+ivec2 VirtualPage(vec2 wrappedCoordinate, int level);
+vec4 SampleVirtualTexture(vec2 textureCoordinate);
+vec4 VirtualTextureFeedback(vec2 textureCoordinate);
 
 void main()
 {
+   // the feedback pass writes the virtual texture page each pixel needs -
+   // wood and tile patterns replace the texture, and see-through colors
+   // do not hide what is behind them
+   if(bWriteFeedback == true)
+   {
+      bool bVirtual = (bUseTexture == true) && (bUseVirtualTexture == true) &&
+         (proceduralPattern != PATTERN_WOOD) && (proceduralPattern != PATTERN_TILE);
+      if((bUseTexture == false) && (objectColor.w < 1.0))
+      {
+         discard;
+      }
+      outFragmentColor = (bVirtual == true) ? VirtualTextureFeedback(fragmentTextureCoordinate * UVscale) : vec4(0.0);
+      return;
+   }
+
+   // wood and tile patterns take the place of the object texture, brushed
+   // metal shades whatever texture or color the object has
+   bool bTextured = (bUseTexture == true) || (proceduralPattern == PATTERN_WOOD) || (proceduralPattern == PATTERN_TILE);
+   float metalShade = 1.0;
+   if(proceduralPattern == PATTERN_METAL)
+   {
+      metalShade = MetalPattern(fragmentTextureCoordinate * UVscale * patternScale);
+   }
+
    if(bUseLighting == true)
    {
       // properties
@@ -53,27 +120,201 @@ void main()
          phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
       }   
     
-      if(bUseTexture == true)
+      if(bTextured == true)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
-         outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
+         vec4 textureColor = SurfaceTexture(fragmentTextureCoordinate * UVscale);
+         outFragmentColor = vec4(phongResult * textureColor.xyz * metalShade, 1.0);
       }
       else
       {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+         outFragmentColor = vec4(phongResult * objectColor.xyz * metalShade, objectColor.w);
       }
    }
    else 
    {
-      if(bUseTexture == true)
+      if(bTextured == true)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = SurfaceTexture(fragmentTextureCoordinate * UVscale);
       }
       else
       {
          outFragmentColor = objectColor;
       }
+      outFragmentColor.xyz *= metalShade;
+   }
+}
+
+// samples the object texture, remapping the UVs into the atlas region
+// when the texture was packed into an atlas page
+vec4 SampleObjectTexture(vec2 textureCoordinate)
+{
+   if(bUseVirtualTexture == true)
+   {
+      return SampleVirtualTexture(textureCoordinate);
+   }
+   if(bUseAtlas == true)
+   {
+      // repeat within the region - the gradients come from the unwrapped
+      // coordinates so the wrap seam does not select a coarser mip
+      vec2 atlasCoordinate = atlasOffset + fract(textureCoordinate) * atlasScale;
+      return textureGrad(objectTexture, atlasCoordinate, dFdx(textureCoordinate) * atlasScale, dFdy(textureCoordinate) * atlasScale);
    }
+   return texture(objectTexture, textureCoordinate);
+}
+
+// mip level of the virtual texture for the pixel's footprint, picked from
+// the unwrapped coordinates so the wrap seam does not select a coarser one
+int VirtualLevel(vec2 textureCoordinate, float lodBias)
+{
+   vec2 texels = textureCoordinate * vec2(virtualLevels[0].zw);
+   vec2 dx = dFdx(texels);
+   vec2 dy = dFdy(texels);
+   float lod = (0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8))) + lodBias;
+   return clamp(int(floor(lod + 0.5)), 0, virtualLevelCount - 1);
+}
+
+// page of a virtual texture level that a wrapped coordinate falls in
+ivec2 VirtualPage(vec2 wrappedCoordinate, int level)
+{
+   ivec2 levelSize = virtualLevels[level].zw;
+   return min(ivec2(wrappedCoordinate * vec2(levelSize)) / pageSize, (levelSize - 1) / pageSize);
+}
+
+// samples a virtual texture through its page table - the entry names the
+// cache page holding the page, or the coarser page standing in for it
+vec4 SampleVirtualTexture(vec2 textureCoordinate)
+{
+   int level = VirtualLevel(textureCoordinate, 0.0);
+   vec2 wrapped = fract(textureCoordinate);
+   ivec2 page = VirtualPage(wrapped, level);
+   uvec4 entry = texelFetch(pageTable, virtualLevels[level].xy + page, 0);
+   if(entry.a == 0u)
+   {
+      // nothing resident yet, the placeholder grey of the other textures
+      return vec4(0.5, 0.5, 0.5, 1.0);
+   }
+
+   // texel within the page of the level the entry maps, which the page
+   // border keeps inside the cache page for the bilinear footprint
+   int mappedLevel = int(entry.b);
+   ivec2 mappedSize = virtualLevels[mappedLevel].zw;
+   ivec2 mappedPage = min(page >> (mappedLevel - level), (mappedSize - 1) / pageSize);
+   vec2 pageTexel = (wrapped * vec2(mappedSize)) - vec2(mappedPage * pageSize);
+   vec2 cacheTexel = (vec2(entry.xy) * float(pageSize + (2 * pageBorder))) + float(pageBorder) + pageTexel;
+   return textureLod(pageCache, cacheTexel / pageCacheSize, 0.0);
+}
+
+// the page request of a pixel for the feedback pass: the texture in red,
+// the page's low bits in green and blue, and the level and high page bits
+// in alpha
+vec4 VirtualTextureFeedback(vec2 textureCoordinate)
+{
+   int level = VirtualLevel(textureCoordinate, feedbackLodBias);
+   ivec2 page = VirtualPage(fract(textureCoordinate), level);
+   int levelBits = level | ((page.x >> 8) << 4) | ((page.y >> 8) << 6);
+   return vec4(float(virtualTextureID), float(page.x & 255), float(page.y & 255), float(levelBits)) / 255.0;
+}
+
+// gets the surface color from the object texture or the procedural pattern
+// that replaces it
+vec4 SurfaceTexture(vec2 textureCoordinate)
+{
+   if(proceduralPattern == PATTERN_WOOD)
+   {
+      return vec4(WoodPattern(textureCoordinate * patternScale), 1.0);
+   }
+   if(proceduralPattern == PATTERN_TILE)
+   {
+      return vec4(TilePattern(textureCoordinate * patternScale), 1.0);
+   }
+   return SampleObjectTexture(textureCoordinate);
+}
+
+// pseudo random value in 0..1 for a lattice point
+float Hash(vec2 p)
+{
+   p = fract(p * vec2(123.34, 456.21));
+   p += dot(p, p + 45.32);
+   return fract(p.x * p.y);
+}
+
+// smoothly interpolated lattice noise in 0..1
+float ValueNoise(vec2 p)
+{
+   vec2 cell = floor(p);
+   vec2 f = fract(p);
+   vec2 u = f * f * (3.0 - (2.0 * f));
+   float bottom = mix(Hash(cell), Hash(cell + vec2(1.0, 0.0)), u.x);
+   float top = mix(Hash(cell + vec2(0.0, 1.0)), Hash(cell + vec2(1.0, 1.0)), u.x);
+   return mix(bottom, top, u.y);
+}
+
+// sum of noise octaves in 0..1, the octave count is the quality preset
+float FractalNoise(vec2 p)
+{
+   float sum = 0.0;
+   float amplitude = 0.5;
+   float total = 0.0;
+   for(int i = 0; i < patternOctaves; i++)
+   {
+      sum += amplitude * ValueNoise(p);
+      total += amplitude;
+      // rotate the lattice a little so the octaves do not line up
+      p = (mat2(1.6, 1.2, -1.2, 1.6) * p) + vec2(17.0, 9.0);
+      amplitude *= 0.5;
+   }
+   return sum / total;
+}
+
+// weight of a detail of the given frequency, fading it out before it is
+// smaller than a pixel and would alias
+float DetailFade(vec2 p, float frequency)
+{
+   vec2 footprint = fwidth(p) * frequency;
+   return 1.0 - smoothstep(0.25, 1.0, max(footprint.x, footprint.y));
+}
+
+// planks with growth rings along V and fine fibers along U, patternColor1
+// is the early wood and patternColor2 the darker late wood
+vec3 WoodPattern(vec2 p)
+{
+   // the rings are bent by low frequency noise like a real log
+   float distortion = FractalNoise(p * vec2(1.5, 6.0));
+   float rings = fract((p.y * 7.0) + (distortion * 2.5));
+   float lateWood = smoothstep(0.55, 0.95, rings) * (1.0 - smoothstep(0.95, 1.0, rings));
+   vec3 color = mix(patternColor1, patternColor2, lateWood);
+
+   float fibers = ValueNoise(p * vec2(6.0, 180.0));
+   color *= 1.0 + (0.25 * (fibers - 0.5) * DetailFade(p, 180.0));
+   return color;
+}
+
+// square tiles with mottled faces and grout lines, patternColor1 is the
+// tile and patternColor2 the grout
+vec3 TilePattern(vec2 p)
+{
+   const float tilesPerUnit = 4.0;
+   vec2 tileCoordinate = p * tilesPerUnit;
+   vec2 cell = floor(tileCoordinate);
+   vec2 local = fract(tileCoordinate);
+
+   // grout line widened by the pixel footprint so it stays antialiased
+   float edge = min(min(local.x, 1.0 - local.x), min(local.y, 1.0 - local.y));
+   float blur = max(fwidth(tileCoordinate.x), fwidth(tileCoordinate.y));
+   float grout = 1.0 - smoothstep(0.025, 0.025 + blur, edge);
+
+   float tone = 0.85 + (0.3 * Hash(cell));
+   float mottling = mix(0.5, FractalNoise(p * 24.0), DetailFade(p, 24.0));
+   vec3 tile = patternColor1 * tone * (0.75 + (0.5 * mottling));
+   return mix(tile, patternColor2, grout);
+}
+
+// brightness of brushed metal, streaks along U that fade to the average
+// with distance
+float MetalPattern(vec2 p)
+{
+   float streaks = FractalNoise(p * vec2(3.0, 400.0));
+   return 1.0 + (0.35 * (streaks - 0.5) * DetailFade(p, 400.0));
 }
 
 // calculates the color when using a directional light.
@@ -0,0 +1,45 @@
+#version 440 core
+layout (vertices = 4) out;
+
+in vec3 controlCoordinate[];
+in vec3 controlViewPosition[];
+
+out vec3 evaluationCoordinate[];
+
+uniform mat4 projection;
+uniform float viewportHeight = 800.0f;
+// the pixels each refined edge should cover on screen
+uniform float edgePixels = 8.0f;
+
+// the tessellation of the edge between two corners, from the pixels
+// the sphere around the edge covers on screen.  It only depends on
+// the two corners, so the patches on both sides of an edge split it
+// the same way and no cracks open between them
+float EdgeLevel(vec3 p0, vec3 p1)
+{
+   float depth = 1.0;
+   // an orthographic projection has no perspective divide
+   if (projection[2][3] != 0.0)
+   {
+      depth = max(-0.5 * (p0.z + p1.z), 0.001);
+   }
+   float pixels = distance(p0, p1) * projection[1][1] * 0.5 * viewportHeight / depth;
+   return clamp(pixels / edgePixels, 1.0, float(gl_MaxTessGenLevel));
+}
+
+void main()
+{
+   evaluationCoordinate[gl_InvocationID] = controlCoordinate[gl_InvocationID];
+
+   if (gl_InvocationID == 0)
+   {
+      // the corners go (a0, b0), (a1, b0), (a1, b1), (a0, b1), and
+      // the outer levels are the edges at a0, b0, a1 and b1
+      gl_TessLevelOuter[0] = EdgeLevel(controlViewPosition[0], controlViewPosition[3]);
+      gl_TessLevelOuter[1] = EdgeLevel(controlViewPosition[0], controlViewPosition[1]);
+      gl_TessLevelOuter[2] = EdgeLevel(controlViewPosition[1], controlViewPosition[2]);
+      gl_TessLevelOuter[3] = EdgeLevel(controlViewPosition[3], controlViewPosition[2]);
+      gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+      gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+   }
+}
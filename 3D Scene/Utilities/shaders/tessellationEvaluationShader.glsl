@@ -0,0 +1,99 @@
+#version 440 core
+layout (quads, fractional_odd_spacing, ccw) in;
+
+// the shapes the patches can be on, matching ShapeMeshes
+#define SURFACE_SPHERE 0
+#define SURFACE_CYLINDER 1
+#define SURFACE_TORUS 2
+
+// the parts of a shape, matching ShapeGenerator::PatchPart
+#define PART_SIDE 0
+#define PART_BOTTOM 1
+#define PART_TOP 2
+
+const float PI = 3.14159265358979;
+
+in vec3 evaluationCoordinate[];
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform int surfaceShape = SURFACE_SPHERE;
+// the top radius of a cylinder, or the tube radius of a torus
+uniform float surfaceRadius = 1.0f;
+
+// the depth pre-pass and the shading pass both run this shader,
+// and the shading pass tests for equal depth
+invariant gl_Position;
+
+// the point, normal and texture coords of the surface at surface
+// coords a and b, laid out as ShapeGenerator lays out the meshes.
+// The angles go through fract() so the coords on both sides of a
+// seam give the same point
+void EvaluateSurface(float a, float b, int part, out vec3 position, out vec3 normal, out vec2 uv)
+{
+   if (surfaceShape == SURFACE_SPHERE)
+   {
+      // a from the top pole down, b around from -0.5 to 0.5
+      float polarAngle = PI * a;
+      float angle = 2.0 * PI * fract(b + 1.0);
+      float radius = sin(polarAngle);
+      position = vec3(radius * sin(angle), cos(polarAngle), radius * cos(angle));
+      normal = position;
+      uv = vec2(0.5 + (radius * b), 1.0 - a);
+   }
+   else if (surfaceShape == SURFACE_TORUS)
+   {
+      // a around the main ring, b around the tube
+      float mainAngle = 2.0 * PI * fract(a);
+      float tubeAngle = 2.0 * PI * fract(b);
+      vec3 ring = vec3(cos(mainAngle), sin(mainAngle), 0.0);
+      normal = (ring * cos(tubeAngle)) + vec3(0.0, 0.0, sin(tubeAngle));
+      position = ring + (normal * surfaceRadius);
+      uv = vec2(a, b);
+   }
+   else
+   {
+      // a around from +x toward -z, b out from the middle of a cap
+      // or up the sides
+      float angle = 2.0 * PI * fract(a);
+      vec2 rim = vec2(cos(angle), -sin(angle));
+      if (part == PART_SIDE)
+      {
+         float radius = mix(1.0, surfaceRadius, b);
+         position = vec3(rim.x * radius, b, rim.y * radius);
+         normal = normalize(vec3(rim.x, 1.0 - surfaceRadius, rim.y));
+         uv = vec2(a, b);
+      }
+      else
+      {
+         float radius = (part == PART_TOP) ? surfaceRadius * b : b;
+         position = vec3(rim.x * radius, (part == PART_TOP) ? 1.0 : 0.0, rim.y * radius);
+         normal = vec3(0.0, (part == PART_TOP) ? 1.0 : -1.0, 0.0);
+         uv = vec2(0.5 + (0.5 * rim.y * b), 0.5 + (0.5 * rim.x * b));
+      }
+   }
+}
+
+void main()
+{
+   // the patches are rectangles of surface coords, so an edge
+   // gets exactly the coords of its corners
+   float a = mix(evaluationCoordinate[0].x, evaluationCoordinate[1].x, gl_TessCoord.x);
+   float b = mix(evaluationCoordinate[0].y, evaluationCoordinate[3].y, gl_TessCoord.y);
+   int part = int(evaluationCoordinate[0].z + 0.5);
+
+   vec3 position;
+   vec3 normal;
+   vec2 uv;
+   EvaluateSurface(a, b, part, position, normal, uv);
+
+   fragmentPosition = vec3(model * vec4(position, 1.0));
+   gl_Position = projection * view * model * vec4(position, 1.0f);
+   fragmentVertexNormal = normal;
+   fragmentTextureCoordinate = uv;
+}
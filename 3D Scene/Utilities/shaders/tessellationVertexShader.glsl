@@ -0,0 +1,18 @@
+#version 440 core
+// a corner of a patch from ShapeGenerator - its surface coords and
+// the part of the shape in the position, its point on the surface
+// in the normal
+layout (location = 0) in vec3 inPatchCoordinate;
+layout (location = 1) in vec3 inSurfacePosition;
+
+out vec3 controlCoordinate;
+out vec3 controlViewPosition;
+
+uniform mat4 model;
+uniform mat4 view;
+
+void main()
+{
+   controlCoordinate = inPatchCoordinate;
+   controlViewPosition = vec3(view * model * vec4(inSurfacePosition, 1.0));
+}
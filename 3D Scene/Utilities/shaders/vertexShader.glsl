@@ -2,6 +2,10 @@
 layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
+// position scale and normal scale of the mesh's vertex format - the
+// packed formats store integers, and a positive normal scale means
+// the normal is octahedral encoded in x and y
+layout (location = 3) in vec4 inVertexDecode;
 
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
@@ -11,10 +15,34 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// the depth pre-pass runs this shader in a program of its own, and
+// the shading pass tests for equal depth, so both must place every
+// vertex exactly the same
+invariant gl_Position;
+
+// unfold an octahedral encoded normal, matching VertexQuantizer
+vec3 DecodeOctahedral(vec2 encoded)
+{
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   if (normal.z < 0.0)
+   {
+      vec2 signs = vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+      normal.xy = (1.0 - abs(encoded.yx)) * signs;
+   }
+   return normalize(normal);
+}
+
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
+   vec3 position = inVertexPosition * inVertexDecode.xyz;
+   vec3 normal = inVertexNormal;
+   if (inVertexDecode.w > 0.0)
+   {
+      normal = DecodeOctahedral(inVertexNormal.xy * inVertexDecode.w);
+   }
+
+   fragmentPosition = vec3(model * vec4(position, 1.0));
+   gl_Position = projection * view * model * vec4(position, 1.0f);
+   fragmentVertexNormal = normal;
    fragmentTextureCoordinate = inTextureCoordinate;
 }
\ No newline at end of file
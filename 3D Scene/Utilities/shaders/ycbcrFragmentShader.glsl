@@ -0,0 +1,105 @@
+#version 440 core
+
+// converts the Y, Cb and Cr planes of a decoded JPEG into an RGB texture
+// with the same integer upsampling and fixed point color conversion as the
+// CPU decoder, so both give identical texels
+
+out vec4 outFragmentColor;
+
+uniform usampler2D planeY;
+uniform usampler2D planeCb;
+uniform usampler2D planeCr;
+uniform int componentCount = 3;
+uniform ivec2 scaleY = ivec2(1, 1);
+uniform ivec2 scaleCb = ivec2(2, 2);
+uniform ivec2 scaleCr = ivec2(2, 2);
+uniform int imageHeight;
+uniform bool bFlipVertically = true;
+
+// function prototypes
+int FetchSample(usampler2D plane, int x, int y);
+int UpsamplePlane(usampler2D plane, ivec2 scale, ivec2 pixel);
+
+void main()
+{
+   ivec2 pixel = ivec2(gl_FragCoord.xy);
+   // flipped images store their bottom row first
+   if(bFlipVertically == true)
+   {
+      pixel.y = imageHeight - 1 - pixel.y;
+   }
+
+   int y = UpsamplePlane(planeY, scaleY, pixel);
+   if(componentCount == 1)
+   {
+      outFragmentColor = vec4(vec3(float(y) / 255.0), 1.0);
+      return;
+   }
+
+   int cb = UpsamplePlane(planeCb, scaleCb, pixel) - 128;
+   int cr = UpsamplePlane(planeCr, scaleCr, pixel) - 128;
+   int base = (y * 4096) + 2048;
+   // the green Cb term is truncated to 8 fractional bits first
+   ivec3 rgb = ivec3(
+      (base + (cr * 5743)) >> 12,
+      (base - (cr * 2925) + (((cb * -1410) >> 8) << 8)) >> 12,
+      (base + (cb * 7258)) >> 12);
+   outFragmentColor = vec4(vec3(clamp(rgb, 0, 255)) / 255.0, 1.0);
+}
+
+// reads one sample of a plane
+int FetchSample(usampler2D plane, int x, int y)
+{
+   return(int(texelFetch(plane, ivec2(x, y), 0).r));
+}
+
+// gets the sample of a plane at a full resolution pixel - even rows blend
+// with the row above and odd rows with the row below, and columns the same
+int UpsamplePlane(usampler2D plane, ivec2 scale, ivec2 pixel)
+{
+   ivec2 size = textureSize(plane, 0);
+   int x = pixel.x / scale.x;
+   int nearY = pixel.y / scale.y;
+   int farY = nearY;
+   if(scale.y == 2)
+   {
+      farY = ((pixel.y & 1) != 0) ? min(nearY + 1, size.y - 1) : max(nearY - 1, 0);
+   }
+   bool bOddColumn = ((pixel.x & 1) != 0);
+
+   if(scale.x == 1)
+   {
+      int nearValue = FetchSample(plane, x, nearY);
+      if(scale.y == 1)
+      {
+         return(nearValue);
+      }
+      return(((3 * nearValue) + FetchSample(plane, x, farY) + 2) >> 2);
+   }
+
+   if(scale.y == 2)
+   {
+      // column sums of the near and far rows, repeated at the edges
+      int sideX = bOddColumn ? min(x + 1, size.x - 1) : max(x - 1, 0);
+      int center = (3 * FetchSample(plane, x, nearY)) + FetchSample(plane, x, farY);
+      int side = (3 * FetchSample(plane, sideX, nearY)) + FetchSample(plane, sideX, farY);
+      return(((3 * center) + side + 8) >> 4);
+   }
+
+   // horizontal only, with the decoder's weighting of the end pairs
+   int value = FetchSample(plane, x, nearY);
+   if(size.x == 1)
+   {
+      return(value);
+   }
+   if(x == 0)
+   {
+      return(bOddColumn ? (((3 * value) + FetchSample(plane, 1, nearY) + 2) >> 2) : value);
+   }
+   if(x == size.x - 1)
+   {
+      return(bOddColumn ? value : (((3 * FetchSample(plane, x - 1, nearY)) + value + 2) >> 2));
+   }
+   int neighbor = FetchSample(plane, bOddColumn ? (x + 1) : (x - 1), nearY);
+   return(((3 * value) + neighbor + 2) >> 2);
+}